@@ -0,0 +1,136 @@
+// Copyright (c) 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @brief A header file with declaration for AsyncRunner Class
+ * @file async_runner.hpp
+ */
+#ifndef DYNAMIC_VINO_LIB__ENGINES__ASYNC_RUNNER_HPP_
+#define DYNAMIC_VINO_LIB__ENGINES__ASYNC_RUNNER_HPP_
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#include "dynamic_vino_lib/engines/engine.hpp"
+
+namespace Engines
+{
+/**
+ * @class AsyncRunner
+ * @brief This class runs the requests of an engine for stages written as
+ * continuations instead of against the bound request of the engine: a job
+ * fills the inputs of a request of the pool, and is continued with its
+ * outputs once the request completed. Each job gets its own request, so any
+ * number of jobs (e.g. the batches of a cascade) are in flight at once, and
+ * the jobs waiting for a request are started by the completions of the
+ * others: no thread blocks on the pool. The runner sets the completion
+ * callbacks of the engine, which must not be run by a pipeline meanwhile.
+ */
+class AsyncRunner
+{
+public:
+  /**
+   * @brief Fill the inputs of the request, e.g. through getInput() and setBatch().
+   */
+  using Fill = std::function<void(RequestBackend &)>;
+  /**
+   * @brief Read the outputs of the request, with whether it succeeded.
+   */
+  using Continuation = std::function<void(RequestBackend &, bool)>;
+
+  explicit AsyncRunner(std::shared_ptr<Engine> engine);
+  /**
+   * @brief Wait for the jobs in flight, then detach from the engine.
+   */
+  ~AsyncRunner();
+  AsyncRunner(const AsyncRunner &) = delete;
+  AsyncRunner & operator=(const AsyncRunner &) = delete;
+
+  /**
+   * @brief Run a job on a request of the pool (Thread Safe). The inputs are
+   * filled on the calling thread if a request is free, otherwise on the thread
+   * of the completion freeing one. The continuation runs on the completion
+   * thread of the request, it may submit the next jobs but must not block.
+   */
+  void submit(Fill fill, Continuation then);
+  /**
+   * @brief Run a job, its result is made by 'read' from the outputs of the
+   * request. The future holds an exception if the request failed.
+   */
+  template<typename T>
+  std::future<T> infer(Fill fill, std::function<T(RequestBackend &)> read)
+  {
+    auto promise = std::make_shared<std::promise<T>>();
+    auto future = promise->get_future();
+    submit(std::move(fill), [promise, read](RequestBackend & request, bool succeeded) {
+        if (!succeeded) {
+          promise->set_exception(
+            std::make_exception_ptr(std::runtime_error("The infer request failed")));
+          return;
+        }
+        try {
+          promise->set_value(read(request));
+        } catch (...) {
+          promise->set_exception(std::current_exception());
+        }
+      });
+    return future;
+  }
+  /**
+   * @brief Block until all the submitted jobs are continued, and their
+   * completions returned.
+   */
+  void waitIdle();
+  /**
+   * @brief Get the jobs submitted and not continued yet, waiting or running (Thread Safe).
+   */
+  size_t getActiveJobs();
+
+private:
+  struct Job
+  {
+    Fill fill;
+    Continuation then;
+  };
+
+  void start(int request_id, Job job);
+  void complete(int request_id, bool succeeded);
+  bool isIdle() const
+  {
+    return active_ == 0 && completing_ == 0;
+  }
+
+  std::shared_ptr<Engine> engine_;
+  std::mutex mutex_;
+  std::condition_variable idle_cv_;
+  /**< the jobs waiting for a free request >**/
+  std::deque<Job> pending_;
+  /**< the continuation of the job running on each request >**/
+  std::vector<Continuation> running_;
+  size_t active_ = 0;
+  /**< the completions not returned yet, their job may be continued already >**/
+  size_t completing_ = 0;
+};
+}  // namespace Engines
+
+#endif  // DYNAMIC_VINO_LIB__ENGINES__ASYNC_RUNNER_HPP_
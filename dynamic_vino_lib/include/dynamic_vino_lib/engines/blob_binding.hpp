@@ -0,0 +1,76 @@
+// Copyright (c) 2018-2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @brief A header file with declaration for the BlobBinding structs
+ * @file blob_binding.hpp
+ */
+#ifndef DYNAMIC_VINO_LIB__ENGINES__BLOB_BINDING_HPP_
+#define DYNAMIC_VINO_LIB__ENGINES__BLOB_BINDING_HPP_
+
+#pragma once
+
+#include <map>
+#include <string>
+
+#include "dynamic_vino_lib/utils/fixed_packing.hpp"
+#include "inference_engine.hpp"
+
+namespace Engines
+{
+/**
+ * @struct BlobBinding
+ * @brief A blob of a request resolved once, with its dims and strides, so that
+ * the models do not look the blob up by name nor read its tensor description
+ * for each frame. The blob stays the same until the input is replaced.
+ */
+template<typename BlobPtr>
+struct BlobBinding
+{
+  BlobBinding() = default;
+  explicit BlobBinding(const BlobPtr & blob_ptr)
+  : blob(blob_ptr)
+  {
+    if (blob != nullptr) {
+      dims = blob->getTensorDesc().getDims();
+      strides = blob->getTensorDesc().getBlockingDesc().getStrides();
+      if (dims.size() == 4) {
+        fixed_shape = findFixedShape(dims[3], dims[2], dims[1]);
+      }
+    }
+  }
+
+  BlobPtr blob = nullptr;
+  InferenceEngine::SizeVector dims;
+  /**< in elements, in the order of the dims for the planar layouts >**/
+  InferenceEngine::SizeVector strides;
+  /**< the packing kernel specialized for the NCHW dims, -1 for the generic one >**/
+  int fixed_shape = -1;
+};
+
+using InputBinding = BlobBinding<InferenceEngine::Blob::Ptr>;
+using OutputBinding = BlobBinding<InferenceEngine::Blob::CPtr>;
+
+/**
+ * @struct RequestBinding
+ * @brief The bound blobs of a request, by input and output name.
+ */
+struct RequestBinding
+{
+  std::map<std::string, InputBinding> inputs;
+  std::map<std::string, OutputBinding> outputs;
+};
+}  // namespace Engines
+
+#endif  // DYNAMIC_VINO_LIB__ENGINES__BLOB_BINDING_HPP_
@@ -0,0 +1,131 @@
+// Copyright (c) 2018-2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @brief A header file with declaration for BufferedRequest Class
+ * @file buffered_request.hpp
+ */
+#ifndef DYNAMIC_VINO_LIB__ENGINES__BUFFERED_REQUEST_HPP_
+#define DYNAMIC_VINO_LIB__ENGINES__BUFFERED_REQUEST_HPP_
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "dynamic_vino_lib/engines/request_backend.hpp"
+#include "inference_engine.hpp"
+
+namespace Engines
+{
+/**
+ * @class BufferedRequest
+ * @brief One of the blob sets of an infer request: the buffers of a request
+ * share it, each with its own user-owned input and output blobs, swapped into
+ * the request (SetBlob) when the buffer is started. So the next frame is
+ * preprocessed into a free buffer while the request runs, and the buffer is
+ * started once the request completes, its outputs read meanwhile from its own
+ * blobs. Each buffer is a request of the pool of the engine.
+ */
+class BufferedRequest : public RequestBackend
+{
+public:
+  /**
+   * @brief Split a request into buffers.
+   * @param[in] inputs, outputs The names of the inputs and outputs of the model,
+   * the blobs are allocated like the ones of the request.
+   * @throw std::logic_error If the request takes no user-owned outputs.
+   */
+  static std::vector<RequestBackend::Ptr> create(
+    const RequestBackend::Ptr & request, const std::vector<std::string> & inputs,
+    const std::vector<std::string> & outputs, int buffers);
+
+  InferenceEngine::Blob::Ptr getInput(const std::string & name) override;
+  void setInput(const std::string & name, const InferenceEngine::Blob::Ptr & blob) override;
+  void setPreprocessedInput(
+    const std::string & name, const InferenceEngine::Blob::Ptr & blob,
+    const InferenceEngine::PreProcessInfo & info) override;
+  InferenceEngine::Blob::CPtr getOutput(const std::string & name) override;
+  /**
+   * @brief Set the batch the buffer is run with, applied when it is started.
+   */
+  void setBatch(int batch) override
+  {
+    batch_ = batch;
+  }
+  /**
+   * @brief Start the buffer on the request, or once the buffers started before
+   * have completed.
+   */
+  void startAsync() override;
+  void infer() override;
+  /**
+   * @brief Abort the buffer running, or take a waiting one out of the queue.
+   */
+  void cancel() override;
+  void setCompletionCallback(const std::function<void(bool)> & callback) override;
+  /**
+   * @brief The counts of the last run of the request, maybe of another buffer.
+   */
+  std::map<std::string, InferenceEngine::InferenceEngineProfileInfo>
+  getPerformanceCounts() override;
+
+private:
+  /**
+   * @brief The request the buffers take turns on.
+   */
+  struct Shared
+  {
+    RequestBackend::Ptr request;
+    std::mutex mutex;
+    std::condition_variable idle;
+    /**< the buffer whose blobs are set on the request, nullptr when idle >**/
+    BufferedRequest * running = nullptr;
+    std::deque<BufferedRequest *> queued;
+  };
+  struct PreprocessedInput
+  {
+    InferenceEngine::Blob::Ptr blob;
+    InferenceEngine::PreProcessInfo info;
+  };
+
+  explicit BufferedRequest(const std::shared_ptr<Shared> & shared);
+  /**
+   * @brief Set the blobs and the batch of the buffer on the request.
+   */
+  void attach();
+  /**
+   * @brief Start the next buffer queued on the request once the running one is
+   * done, a buffer failing to start completes as failed.
+   */
+  static void advance(Shared * shared);
+  static void complete(Shared * shared, bool succeeded);
+
+  std::shared_ptr<Shared> shared_;
+  std::map<std::string, InferenceEngine::Blob::Ptr> inputs_;
+  std::map<std::string, PreprocessedInput> preprocessed_inputs_;
+  std::map<std::string, InferenceEngine::Blob::Ptr> outputs_;
+  /**< 0 until set, the request runs the whole batch then >**/
+  int batch_ = 0;
+  std::function<void(bool)> callback_;
+};
+}  // namespace Engines
+
+#endif  // DYNAMIC_VINO_LIB__ENGINES__BUFFERED_REQUEST_HPP_
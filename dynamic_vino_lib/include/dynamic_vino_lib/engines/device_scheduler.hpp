@@ -0,0 +1,118 @@
+// Copyright (c) 2018-2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @brief A header file with declaration for DeviceScheduler Class
+ * @file device_scheduler.hpp
+ */
+#ifndef DYNAMIC_VINO_LIB__ENGINES__DEVICE_SCHEDULER_HPP_
+#define DYNAMIC_VINO_LIB__ENGINES__DEVICE_SCHEDULER_HPP_
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <utility>
+
+namespace Engines
+{
+/**
+ * @class DeviceScheduler
+ * @brief Admission control of the infer requests the pipelines of the process
+ * start on one device. At most a given number of requests run at a time, and
+ * the waiting ones are admitted by weighted fair queuing between the clients
+ * (pipelines): while clients are backlogged, each gets admissions in
+ * proportion to its weight, so that a low-value pipeline can't starve a
+ * critical one (Thread Safe).
+ */
+class DeviceScheduler
+{
+public:
+  /**
+   * @brief Get the scheduler of a device, created with the device_requests of
+   * the common parameters.
+   */
+  static std::shared_ptr<DeviceScheduler> getInstance(const std::string & device);
+  /**
+   * @brief Set the weight of a client on all the devices, effective for its
+   * next admissions.
+   */
+  static void setClientWeight(const std::string & client, double weight);
+  /**
+   * @brief Get the seconds each device had a request running, since its
+   * scheduler was created.
+   */
+  static std::map<std::string, double> getBusyTimes();
+
+  /**
+   * @param[in] capacity The requests running on the device at most, 0 for no limit.
+   */
+  explicit DeviceScheduler(int capacity);
+  void setWeight(const std::string & client, double weight);
+  double getWeight(const std::string & client);
+  /**
+   * @brief Block until the client may start a request on the device.
+   */
+  void admit(const std::string & client);
+  /**
+   * @brief Give back the admission of a request which is done.
+   */
+  void release();
+  /**
+   * @brief Get the seconds the device had at least one request running. Its
+   * utilization is the growth of the busy time over the elapsed time.
+   */
+  double getBusySeconds();
+  /**
+   * @brief Get the number of admissions blocked until the device has room.
+   */
+  size_t getWaiting();
+  inline int getCapacity() const
+  {
+    return capacity_;
+  }
+
+private:
+  struct Client
+  {
+    double weight = 1;
+    /**< virtual time the last admission of the client finishes at >**/
+    double finish = 0;
+  };
+
+  static std::mutex instances_mutex_;
+  static std::map<std::string, std::shared_ptr<DeviceScheduler>> instances_;
+  static std::map<std::string, double> weights_;
+
+  const int capacity_;
+  int running_ = 0;
+  std::chrono::steady_clock::time_point busy_since_;
+  double busy_seconds_ = 0;
+  double virtual_time_ = 0;
+  uint64_t next_ticket_ = 0;
+  std::map<std::string, Client> clients_;
+  /**< finish tag and ticket of each waiting admission, the smallest goes first >**/
+  std::set<std::pair<double, uint64_t>> waiting_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+};
+}  // namespace Engines
+
+#endif  // DYNAMIC_VINO_LIB__ENGINES__DEVICE_SCHEDULER_HPP_
@@ -21,7 +21,20 @@
 
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "dynamic_vino_lib/engines/blob_binding.hpp"
+#include "dynamic_vino_lib/engines/device_scheduler.hpp"
+#include "dynamic_vino_lib/engines/request_backend.hpp"
 #include "dynamic_vino_lib/models/base_model.hpp"
+#include "dynamic_vino_lib/utils/preprocess_cache.hpp"
 #include "inference_engine.hpp"
 
 namespace Engines
@@ -31,6 +44,16 @@ namespace Engines
  * @brief This class manages the instance created for computing Engine hardware
  * (CPU|GPU|MARIAD|HETERO|more). Currently it mainly manages the inference request(s)
  * and callback function for the Engine instance.
+ * The engine owns a pool of infer requests created from the same network. Each
+ * request has its own input/output blobs; getRequest() returns the request bound
+ * by bindRequest(), the first one by default. The requests of an engine balanced
+ * over several devices are created from the network loaded on each of them.
+ * The requests are RequestBackends, e.g. run by a model server instead of a
+ * device (RemoteRequest); the models reach the bound one through getInput(),
+ * getOutput(), startRequest() and the like. The blobs of each request are
+ * resolved once, by bindBlobs, and kept with their dims in a RequestBinding.
+ * With input buffers the requests of the pool are the blob sets of fewer
+ * device requests (BufferedRequest), filled while their device request runs.
  */
 class Engine
 {
@@ -49,26 +72,319 @@ public:
    */
   Engine(InferenceEngine::InferRequest::Ptr &);
   /**
-   * @brief Get the inference request this instance holds.
-   * @return The inference request this instance holds.
+   * @brief Using a pool of Inference Requests to initialize the inference Engine.
+   */
+  explicit Engine(const std::vector<InferenceEngine::InferRequest::Ptr> & requests);
+  /**
+   * @brief Using a pool of requests of any backend to initialize the inference Engine.
+   */
+  explicit Engine(const std::vector<RequestBackend::Ptr> & requests);
+  /**
+   * @brief Get the inference request currently bound.
+   * @return The inference request currently bound.
+   */
+  inline const RequestBackend::Ptr & getRequest() const
+  {
+    return requests_[bound_request_];
+  }
+  /**
+   * @brief Get the inference request of the given id in the pool.
+   */
+  inline const RequestBackend::Ptr & getRequest(int id) const
+  {
+    return requests_[id];
+  }
+  inline int getRequestNum() const
+  {
+    return static_cast<int>(requests_.size());
+  }
+  /**
+   * @brief Take a free request out of the pool, on the device with the fewest
+   * requests in use (Thread Safe).
+   * @return The id of the request, -1 if all the requests are in use.
+   */
+  int acquireRequest();
+  /**
+   * @brief Give a request acquired by acquireRequest back to the pool (Thread Safe).
+   */
+  void releaseRequest(int id);
+  /**
+   * @brief Set the device each request of the pool runs on, one name for all
+   * the requests or one per request.
+   */
+  void setRequestDevices(const std::vector<std::string> & devices);
+  /**
+   * @brief Get the devices the requests run on, several for a balanced engine.
+   */
+  inline const std::vector<std::string> & getDevices() const
+  {
+    return devices_;
+  }
+  /**
+   * @brief Share the devices with the engines of other pipelines: the requests
+   * are started once admitted by the scheduler of their device.
+   * @param[in] client The name the schedulers weigh the requests by, e.g. the pipeline.
+   */
+  void setScheduler(const std::string & client);
+  /**
+   * @brief Block until the bound request may be started on the device.
+   */
+  void admitRequest();
+  /**
+   * @brief Give back the admission of a request which is done, called from
+   * its completion (Thread Safe).
+   */
+  void finishRequest(int id);
+  /**
+   * @brief Count the outcome of a finished request, failed if it completed
+   * with an error status, e.g. on a device removed or cancelled (Thread Safe).
    */
-  inline InferenceEngine::InferRequest::Ptr & getRequest()
+  void recordResult(int id, bool succeeded);
+  /**
+   * @brief Cancel the requests running for longer than the timeout, e.g. on a
+   * hung device, each counted as failed (Thread Safe).
+   * @return The number of requests cancelled.
+   */
+  int cancelStalledRequests(const std::chrono::milliseconds & timeout);
+  /**
+   * @brief Get the requests failed in a row, reset by a succeeded one.
+   */
+  inline int getConsecutiveErrors() const
+  {
+    return consecutive_errors_;
+  }
+  inline uint64_t getErrors() const
+  {
+    return errors_;
+  }
+  /**
+   * @brief Bind the request used by getRequest(), i.e. the one whose blobs are
+   * filled by enqueue and read by fetchResults.
+   */
+  inline void bindRequest(int id)
+  {
+    bound_request_ = id;
+  }
+  inline int getBoundRequest() const
   {
-    return request_;
+    return bound_request_;
   }
   /**
-   * @brief Set a callback function for the infer request.
-   * @param[in] callbackToSet A lambda function as callback function.
-   * The callback function will be called when request is finished.
+   * @brief Resolve the blobs of the inputs and outputs of every request of the
+   * pool once, when the engine is created. The blobs not bound are resolved
+   * the first time they are got.
+   */
+  void bindBlobs(const std::vector<std::string> & inputs, const std::vector<std::string> & outputs);
+  /**
+   * @brief Get an input blob of the bound request with its dims, to be filled
+   * by enqueue.
+   * @throw std::exception If the model has no input of the name.
+   */
+  const InputBinding & getInputBinding(const std::string & name);
+  /**
+   * @brief Get the input blobs of the bound request resolved so far, by name.
    */
-  template<typename T>
-  void setCompletionCallback(const T & callbackToSet)
+  inline const std::map<std::string, InputBinding> & getInputBindings() const
   {
-    request_->SetCompletionCallback(callbackToSet);
+    return bindings_[bound_request_].inputs;
   }
+  /**
+   * @brief Get an output blob of the bound request with its dims, read by
+   * fetchResults.
+   * @throw std::exception If the model has no output of the name.
+   */
+  const OutputBinding & getOutputBinding(const std::string & name);
+  /**
+   * @brief Get an input blob of the bound request, to be filled by enqueue.
+   */
+  inline InferenceEngine::Blob::Ptr getInput(const std::string & name)
+  {
+    return getInputBinding(name).blob;
+  }
+  /**
+   * @brief Replace an input blob of the bound request, its binding with it.
+   */
+  void setInput(const std::string & name, const InferenceEngine::Blob::Ptr & blob);
+  /**
+   * @brief Get an output blob of the bound request, read by fetchResults.
+   */
+  inline InferenceEngine::Blob::CPtr getOutput(const std::string & name)
+  {
+    return getOutputBinding(name).blob;
+  }
+  /**
+   * @brief Set the frames in the batch of the bound request, for dynamic batching.
+   */
+  inline void setBatch(int batch)
+  {
+    requests_[bound_request_]->setBatch(batch);
+  }
+  /**
+   * @brief Start the bound request, its completion callback is called once done.
+   */
+  inline void startRequest()
+  {
+    requests_[bound_request_]->startAsync();
+  }
+  /**
+   * @brief Run the bound request on the calling thread.
+   */
+  inline void infer()
+  {
+    requests_[bound_request_]->infer();
+  }
+  /**
+   * @brief Set the callback function of a request of the pool.
+   * @param[in] callback Called when the request is finished, with whether it
+   * succeeded.
+   */
+  inline void setCompletionCallback(int id, const std::function<void(bool)> & callback)
+  {
+    requests_[id]->setCompletionCallback(callback);
+  }
+  /**
+   * @brief Mark whether the network was loaded with dynamic batching, i.e.
+   * whether InferRequest::SetBatch can be used for partial batches.
+   */
+  inline void setDynamicBatchEnabled(bool enabled)
+  {
+    dynamic_batch_enabled_ = enabled;
+  }
+  inline bool isDynamicBatchEnabled() const
+  {
+    return dynamic_batch_enabled_;
+  }
+  /**
+   * @brief Mark whether the network was loaded with PERF_COUNT, i.e. whether
+   * the requests report per-layer performance counts.
+   */
+  inline void setPerfCountEnabled(bool enabled)
+  {
+    perf_count_enabled_ = enabled;
+  }
+  inline bool isPerfCountEnabled() const
+  {
+    return perf_count_enabled_;
+  }
+  /**
+   * @brief Mark whether the network was loaded with plugin preprocessing, i.e.
+   * the input is resized and converted by the plugin from the NHWC frame set
+   * by setInputFrame.
+   */
+  inline void setPluginPreprocessEnabled(bool enabled)
+  {
+    plugin_preprocess_enabled_ = enabled;
+  }
+  inline bool isPluginPreprocessEnabled() const
+  {
+    return plugin_preprocess_enabled_;
+  }
+  /**
+   * @brief Wrap a BGR frame as the input blob of the bound request without
+   * copying it. An ROI of a frame (e.g. a detected face) becomes an ROI blob
+   * of the parent frame, cropped by the plugin. The frame is kept alive until
+   * the next frame is set on the same request.
+   * @return Whether this operation is successful.
+   */
+  bool setInputFrame(const std::string & input_name, const cv::Mat & frame);
+  /**
+   * @brief Wrap an NV12 frame (see utils/nv12.hpp) as the input blob of the
+   * bound request, for the plugin to convert and resize it, like setInputFrame.
+   * @return False if the backend takes no NV12 input.
+   */
+  bool setInputNV12(const std::string & input_name, const cv::Mat & nv12);
+  /**
+   * @brief Set the cache of the frame being enqueued, so that the resized
+   * frame or ROI is shared with the sibling inferences. nullptr for the
+   * frames not cached, e.g. tiles.
+   */
+  inline void setPreprocessCache(PreprocessCache * cache)
+  {
+    preprocess_cache_ = cache;
+  }
+  inline PreprocessCache * getPreprocessCache() const
+  {
+    return preprocess_cache_;
+  }
+  /**
+   * @brief Keep the executable network the request is created from. It may be
+   * shared with the engines of other pipelines.
+   */
+  inline void setNetwork(const std::shared_ptr<InferenceEngine::ExecutableNetwork> & network)
+  {
+    network_ = network;
+  }
+  inline std::shared_ptr<InferenceEngine::ExecutableNetwork> getNetwork() const
+  {
+    return network_;
+  }
+  /**
+   * @brief Keep the networks of the other devices of a balanced engine, the
+   * first one is set by setNetwork.
+   */
+  inline void setDeviceNetworks(
+    const std::vector<std::shared_ptr<InferenceEngine::ExecutableNetwork>> & networks)
+  {
+    device_networks_ = networks;
+  }
+  /**
+   * @brief Set the memory the network took when loaded, 0 for a network
+   * shared with a previously loaded engine.
+   */
+  inline void setNetworkBytes(uint64_t bytes)
+  {
+    network_bytes_ = bytes;
+  }
+  inline uint64_t getNetworkBytes() const
+  {
+    return network_bytes_;
+  }
+  /**
+   * @brief Get the bytes of the input and output blobs of all the requests,
+   * measured once, before the frames are set as input blobs.
+   */
+  uint64_t getBlobBytes();
 
 private:
-  InferenceEngine::InferRequest::Ptr request_ = nullptr;
+  static InferenceEngine::Blob::Ptr wrapFrame(const cv::Mat & frame);
+
+  void initRequests();
+
+  std::vector<RequestBackend::Ptr> requests_;
+  /**< the blobs of each request, resolved by bindBlobs >**/
+  std::vector<RequestBinding> bindings_;
+  std::vector<bool> request_in_use_;
+  /**< the scheduler which admitted each request, nullptr if not admitted >**/
+  std::vector<std::shared_ptr<DeviceScheduler>> request_admitted_;
+  std::vector<std::string> devices_;
+  /**< the index in devices_ of each request >**/
+  std::vector<size_t> request_devices_;
+  std::vector<int> device_requests_in_use_;
+  /**< one per device, empty until setScheduler >**/
+  std::vector<std::shared_ptr<DeviceScheduler>> schedulers_;
+  std::string client_;
+  /**< the time each running request was started at, for the timeouts >**/
+  std::vector<std::chrono::steady_clock::time_point> request_started_;
+  std::vector<bool> request_running_;
+  /**< the requests cancelled by a timeout, already counted as failed >**/
+  std::vector<bool> request_cancelled_;
+  std::atomic<int> consecutive_errors_{0};
+  std::atomic<uint64_t> errors_{0};
+  /**< the request acquireRequest looks at first, so that equal devices take turns >**/
+  size_t next_request_ = 0;
+  std::mutex pool_mutex_;
+  int bound_request_ = 0;
+  std::shared_ptr<InferenceEngine::ExecutableNetwork> network_ = nullptr;
+  std::vector<std::shared_ptr<InferenceEngine::ExecutableNetwork>> device_networks_;
+  bool dynamic_batch_enabled_ = false;
+  bool perf_count_enabled_ = false;
+  bool plugin_preprocess_enabled_ = false;
+  uint64_t network_bytes_ = 0;
+  /**< -1 until measured >**/
+  int64_t blob_bytes_ = -1;
+  /**< frames wrapped by the input blobs, per request >**/
+  std::vector<cv::Mat> input_frames_;
+  PreprocessCache * preprocess_cache_ = nullptr;
 };
 }  // namespace Engines
 
@@ -21,8 +21,15 @@
 
 #pragma once
 
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
 #include "dynamic_vino_lib/models/base_model.hpp"
 #include "dynamic_vino_lib/engines/engine.hpp"
+#include "vino_param_lib/param_manager.hpp"
 #include "inference_engine.hpp"
 
 namespace Engines
@@ -30,16 +37,65 @@ namespace Engines
 /**
  * @class EngineManager
  * @brief This class is used to create and manage Inference engines.
+ * Executable networks are shared by all the engines created for the same
+ * model, device and config, each engine holds its own infer request.
  */
 class EngineManager
 {
 public:
   /**
    * @brief Create InferenceEngine instance by given Engine Name and Network.
+   * A list of devices without a plugin prefix (e.g. "MYRIAD.1,MYRIAD.2") loads
+   * the network on each of them, the requests going to the least busy one.
+   * @param[in] config Plugin config (e.g. CPU_THROUGHPUT_STREAMS) passed to
+   * LoadNetwork.
+   * @param[in] infer_requests Size of the request pool of the engine (per
+   * device of a list), the OPTIMAL_NUMBER_OF_INFER_REQUESTS of the loaded
+   * network if not positive.
+   * @param[in] warmup Number of dummy inferences run on each request (and at
+   * each batch size for dynamic batching) before the engine is returned, so
+   * that the first frames don't pay for the allocations inside the plugin.
+   * @param[in] plugin_preprocess Let the plugin resize the input and convert
+   * it from NHWC U8, the frames being set with Engine::setInputFrame.
+   * @param[in] timeout_ms The time an inference of a remote engine may take.
+   * @param[in] input_buffers The blob sets of each request of a local device,
+   * each one a request of the pool (BufferedRequest), 1 for the blobs of the
+   * request itself.
    * @return The shared pointer of created Engine instance.
+   * "REMOTE:<host>:<port>[/<model>]" creates an engine whose requests are run
+   * by a model server, see createRemoteEngine. "MOCK[:<latency ms>[:<directory>]]"
+   * creates an engine run by no device, see createMockEngine. "SHM:<device>[@<socket>]"
+   * creates an engine run by the engine daemon of the host, see createShmEngine.
    */
   std::shared_ptr<Engine> createEngine(
-    const std::string &, const std::shared_ptr<Models::BaseModel> &);
+    const std::string &, const std::shared_ptr<Models::BaseModel> &,
+    const std::map<std::string, std::string> & config = {}, int infer_requests = 0,
+    int warmup = 0, bool plugin_preprocess = false, int timeout_ms = 0, int input_buffers = 1);
+  /**
+   * @brief Create InferenceEngine instance with the engine options of the
+   * given inference parameters.
+   */
+  std::shared_ptr<Engine> createEngine(
+    const Params::ParamManager::InferenceRawData & infer,
+    const std::shared_ptr<Models::BaseModel> & model);
+  /**
+   * @brief Get the process-wide InferenceEngine::Core, used both to read and
+   * to load networks. The custom libraries and the network cache dir of the
+   * Common parameters are applied when it is first used.
+   * @return The shared Core instance.
+   */
+  static InferenceEngine::Core & getCore();
+  /**
+   * @brief Get the precision a model is optimized for, from the directory of
+   * its IR in the Open Model Zoo layout (e.g. FP16-INT8/<model>.xml is INT8),
+   * empty if unknown.
+   */
+  static std::string getModelPrecision(const std::string & model);
+  /**
+   * @brief Whether the device, or each device of a list, reports the precision
+   * of the model in its OPTIMIZATION_CAPABILITIES. True if either is unknown.
+   */
+  static bool supportsModel(const std::string & device, const std::string & model);
 
 private:
 #if(defined(USE_OLD_E_PLUGIN_API))
@@ -53,7 +109,84 @@ private:
 #endif
 
   std::shared_ptr<Engine> createEngine_V2019R2_plus(
-    const std::string &, const std::shared_ptr<Models::BaseModel> &);
+    const std::string &, const std::shared_ptr<Models::BaseModel> &,
+    const std::map<std::string, std::string> &, int, bool, int input_buffers = 1);
+  /**
+   * @brief Get the devices of a list balanced by the toolkit, the device itself
+   * if it is a single one or a list of a plugin (MULTI:, HETERO:).
+   */
+  static std::vector<std::string> getBalancedDevices(const std::string & device);
+  /**
+   * @brief Create an engine with the requests of the network loaded on each device.
+   */
+  std::shared_ptr<Engine> createBalancedEngine(
+    const std::vector<std::string> & devices, const std::shared_ptr<Models::BaseModel> & model,
+    const std::map<std::string, std::string> & config, int infer_requests,
+    bool plugin_preprocess, int input_buffers);
+  /**
+   * @brief Create an engine whose requests are sent to a model server speaking
+   * the KServe v2 protocol, e.g. the OpenVINO Model Server. The model is served
+   * under the name of its IR unless the endpoint names it; the inputs and
+   * outputs are those of the IR read locally.
+   */
+  std::shared_ptr<Engine> createRemoteEngine(
+    const std::string & endpoint, const std::shared_ptr<Models::BaseModel> & model,
+    int infer_requests, int timeout_ms);
+  /**
+   * @brief Create an engine whose requests are run by the engine daemon of the
+   * host (sample engine_daemon) over shared memory, see ShmRequest. The daemon
+   * loads the network once for all the worker processes using it.
+   */
+  std::shared_ptr<Engine> createShmEngine(
+    const std::string & options, const std::shared_ptr<Models::BaseModel> & model,
+    int infer_requests, int timeout_ms);
+  /**
+   * @brief Create an engine whose requests complete after a latency with
+   * recorded or synthetic outputs, see MockRequest, to benchmark a pipeline
+   * without a device. The inputs and outputs are those of the IR.
+   */
+  std::shared_ptr<Engine> createMockEngine(
+    const std::string & options, const std::shared_ptr<Models::BaseModel> & model,
+    int infer_requests);
+  /**
+   * @brief Configure resizing and layout conversion of the model input in the
+   * plugin, before the network is loaded.
+   * @return Whether the model input can be preprocessed by the plugin.
+   */
+  static bool setPluginPreprocess(const std::shared_ptr<Models::BaseModel> & model);
+  /**
+   * @brief Split each request into buffers of their own blobs, see BufferedRequest.
+   * @return The buffers, or the requests themselves if they take no user-owned blobs.
+   */
+  static std::vector<RequestBackend::Ptr> createBuffers(
+    const std::vector<RequestBackend::Ptr> & requests,
+    const std::shared_ptr<Models::BaseModel> & model, int input_buffers);
+  /**
+   * @brief Bind the blobs of the model inputs and outputs on all the requests
+   * of the engine.
+   */
+  static void bindBlobs(
+    const std::shared_ptr<Engine> & engine, const std::shared_ptr<Models::BaseModel> & model);
+  /**
+   * @brief Run dummy inferences on all the requests of the engine.
+   */
+  static void warmUp(
+    const std::shared_ptr<Engine> & engine, const std::shared_ptr<Models::BaseModel> & model,
+    int iterations);
+  /**
+   * @brief Build the key of a shared executable network.
+   */
+  static std::string getNetworkKey(
+    const std::string & device, const std::shared_ptr<Models::BaseModel> & model,
+    const std::map<std::string, std::string> & config);
+
+  /**< loaded networks, released once no engine uses them >**/
+  std::map<std::string, std::weak_ptr<InferenceEngine::ExecutableNetwork>> networks_;
+  std::map<std::string, bool> dynamic_batch_of_networks_;
+  std::map<std::string, bool> plugin_preprocess_of_networks_;
+  /**< one per network key, so that engines can be created from several threads >**/
+  std::map<std::string, std::shared_ptr<std::mutex>> load_mutexes_;
+  std::mutex networks_mutex_;
 
 };
 }  // namespace Engines
@@ -0,0 +1,67 @@
+// Copyright (c) 2018-2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @brief A header file with declaration for IERequestBackend Class
+ * @file ie_request_backend.hpp
+ */
+#ifndef DYNAMIC_VINO_LIB__ENGINES__IE_REQUEST_BACKEND_HPP_
+#define DYNAMIC_VINO_LIB__ENGINES__IE_REQUEST_BACKEND_HPP_
+
+#pragma once
+
+#include <functional>
+#include <map>
+#include <string>
+
+#include "dynamic_vino_lib/engines/request_backend.hpp"
+#include "inference_engine.hpp"
+
+namespace Engines
+{
+/**
+ * @class IERequestBackend
+ * @brief A request of a network loaded on a local device by the Inference Engine.
+ */
+class IERequestBackend : public RequestBackend
+{
+public:
+  explicit IERequestBackend(const InferenceEngine::InferRequest::Ptr & request);
+
+  InferenceEngine::Blob::Ptr getInput(const std::string & name) override;
+  void setInput(const std::string & name, const InferenceEngine::Blob::Ptr & blob) override;
+  void setPreprocessedInput(
+    const std::string & name, const InferenceEngine::Blob::Ptr & blob,
+    const InferenceEngine::PreProcessInfo & info) override;
+  void setOutput(const std::string & name, const InferenceEngine::Blob::Ptr & blob) override;
+  InferenceEngine::Blob::CPtr getOutput(const std::string & name) override;
+  void setBatch(int batch) override;
+  void startAsync() override;
+  void infer() override;
+  void cancel() override;
+  void setCompletionCallback(const std::function<void(bool)> & callback) override;
+  std::map<std::string, InferenceEngine::InferenceEngineProfileInfo>
+  getPerformanceCounts() override;
+
+  inline const InferenceEngine::InferRequest::Ptr & getInferRequest() const
+  {
+    return request_;
+  }
+
+private:
+  InferenceEngine::InferRequest::Ptr request_;
+};
+}  // namespace Engines
+
+#endif  // DYNAMIC_VINO_LIB__ENGINES__IE_REQUEST_BACKEND_HPP_
@@ -0,0 +1,117 @@
+// Copyright (c) 2018-2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @brief A header file with declaration for KServeClient Class
+ * @file kserve_client.hpp
+ */
+#ifndef DYNAMIC_VINO_LIB__ENGINES__KSERVE_CLIENT_HPP_
+#define DYNAMIC_VINO_LIB__ENGINES__KSERVE_CLIENT_HPP_
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Engines
+{
+/**
+ * @class KServeClient
+ * @brief A client of a model server speaking the KServe v2 inference protocol,
+ * e.g. the OpenVINO Model Server, over its REST binding with binary tensors.
+ * It keeps one connection open, so one request runs on it at a time; concurrent
+ * requests each use a client of their own.
+ */
+class KServeClient
+{
+public:
+  struct Tensor
+  {
+    std::string name;
+    std::string datatype;  // "FP32", "UINT8", ...
+    std::vector<size_t> shape;
+    const uint8_t * data = nullptr;
+    size_t bytes = 0;
+  };
+  struct Result
+  {
+    std::string name;
+    std::string datatype;
+    std::vector<size_t> shape;
+    std::vector<uint8_t> data;
+  };
+
+  /**
+   * @brief Split an endpoint "<host>:<port>[/<model>]", the model being empty
+   * if not given.
+   * @return False if it has no port.
+   */
+  static bool parseEndpoint(
+    const std::string & endpoint, std::string & host, std::string & port, std::string & model);
+  /**
+   * @brief Get the bytes of an element of a KServe datatype, 0 if unknown.
+   */
+  static size_t getDatatypeSize(const std::string & datatype);
+
+  KServeClient(const std::string & host, const std::string & port, const std::string & model);
+  ~KServeClient();
+  KServeClient(const KServeClient &) = delete;
+  KServeClient & operator=(const KServeClient &) = delete;
+
+  /**
+   * @brief Run an inference of the model on the server.
+   * @param[in] timeout_ms The time the connection, the sending and each receive
+   * may take at most.
+   * @return False with the error on failure, e.g. a timeout or a server error.
+   */
+  bool infer(
+    const std::vector<Tensor> & inputs, const std::vector<std::string> & outputs, int timeout_ms,
+    std::vector<Result> & results, std::string & error);
+  /**
+   * @brief Abort the inference running, from another thread: it fails at once.
+   */
+  void cancel();
+  inline const std::string & getModel() const
+  {
+    return model_;
+  }
+
+private:
+  bool connect(int timeout_ms, std::string & error);
+  void disconnect();
+  bool sendAll(const char * data, size_t size);
+  /**
+   * @param[out] closed Whether the connection was closed before any response.
+   */
+  bool receiveResponse(
+    int & status, std::string & body, size_t & header_size, bool & closed, std::string & error);
+  bool parseResults(
+    const std::string & body, size_t header_size, std::vector<Result> & results,
+    std::string & error);
+
+  const std::string host_;
+  const std::string port_;
+  const std::string model_;
+  int fd_ = -1;
+  bool cancelled_ = false;
+  /**< guards fd_ and cancelled_ between the inference and cancel >**/
+  std::mutex fd_mutex_;
+  /**< the bytes received after the last response, kept for the next one >**/
+  std::string pending_;
+};
+}  // namespace Engines
+
+#endif  // DYNAMIC_VINO_LIB__ENGINES__KSERVE_CLIENT_HPP_
@@ -0,0 +1,100 @@
+// Copyright (c) 2018-2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @brief A header file with declaration for MockRequest Class
+ * @file mock_request.hpp
+ */
+#ifndef DYNAMIC_VINO_LIB__ENGINES__MOCK_REQUEST_HPP_
+#define DYNAMIC_VINO_LIB__ENGINES__MOCK_REQUEST_HPP_
+
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "dynamic_vino_lib/engines/request_backend.hpp"
+#include "inference_engine.hpp"
+
+namespace Engines
+{
+/**
+ * @class MockRequest
+ * @brief An infer request run by no device, to measure the rest of a pipeline
+ * (capture, preprocessing, filters, cascades, outputs) alone. It completes
+ * after a fixed latency with the same outputs every time: recorded ones, read
+ * from <directory>/<output name>.bin, or synthetic ones. The synthetic outputs
+ * are zeros, but for a DetectionOutput ([..., N, 7]) which gets a few boxes, so
+ * that the inferences cascaded from a detection get ROIs.
+ */
+class MockRequest : public RequestBackend
+{
+public:
+  /**
+   * @param[in] inputs, outputs The inputs and outputs of the model, as set up
+   * by its updateLayerProperty.
+   * @param[in] latency_ms The time a run takes.
+   * @param[in] directory The directory of the recorded outputs, empty for
+   * synthetic outputs. A file holds the raw blob (e.g. numpy's tofile), or the
+   * rows of a single frame used for each frame of the batch.
+   */
+  MockRequest(
+    const InferenceEngine::InputsDataMap & inputs, const InferenceEngine::OutputsDataMap & outputs,
+    double latency_ms, const std::string & directory);
+  ~MockRequest();
+  MockRequest(const MockRequest &) = delete;
+  MockRequest & operator=(const MockRequest &) = delete;
+
+  InferenceEngine::Blob::Ptr getInput(const std::string & name) override;
+  void setInput(const std::string & name, const InferenceEngine::Blob::Ptr & blob) override;
+  InferenceEngine::Blob::CPtr getOutput(const std::string & name) override;
+  void setBatch(int) override
+  {
+  }
+  /**
+   * @brief Complete the request on its thread once the latency elapsed.
+   */
+  void startAsync() override;
+  void infer() override;
+  void cancel() override;
+  void setCompletionCallback(const std::function<void(bool)> & callback) override;
+
+private:
+  static void fillRecorded(
+    const std::string & file, const InferenceEngine::Blob::Ptr & blob);
+  static void fillSynthetic(const InferenceEngine::Blob::Ptr & blob);
+  /**
+   * @return False if the run was cancelled.
+   */
+  bool run(std::unique_lock<std::mutex> & lk);
+  void work();
+
+  const double latency_ms_;
+  std::map<std::string, InferenceEngine::Blob::Ptr> inputs_;
+  std::map<std::string, InferenceEngine::Blob::Ptr> outputs_;
+  std::function<void(bool)> callback_;
+  bool started_ = false;
+  bool cancelled_ = false;
+  bool stopping_ = false;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::thread thread_;
+};
+}  // namespace Engines
+
+#endif  // DYNAMIC_VINO_LIB__ENGINES__MOCK_REQUEST_HPP_
@@ -0,0 +1,100 @@
+// Copyright (c) 2018-2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @brief A header file with declaration for RemoteRequest Class
+ * @file remote_request.hpp
+ */
+#ifndef DYNAMIC_VINO_LIB__ENGINES__REMOTE_REQUEST_HPP_
+#define DYNAMIC_VINO_LIB__ENGINES__REMOTE_REQUEST_HPP_
+
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "dynamic_vino_lib/engines/kserve_client.hpp"
+#include "dynamic_vino_lib/engines/request_backend.hpp"
+#include "inference_engine.hpp"
+
+namespace Engines
+{
+/**
+ * @class RemoteRequest
+ * @brief An infer request run by a model server instead of a local device. It
+ * holds input and output blobs like the requests of a loaded network: the
+ * inputs filled by the models are sent to the server, which fills the outputs.
+ * Each request has its own connection and thread, so that the requests of an
+ * engine are pipelined to the server.
+ */
+class RemoteRequest : public RequestBackend
+{
+public:
+  /**
+   * @param[in] inputs, outputs The inputs and outputs of the model, as set up
+   * by its updateLayerProperty.
+   * @param[in] timeout_ms The time an inference may take on the server at most.
+   */
+  RemoteRequest(
+    const std::string & host, const std::string & port, const std::string & model,
+    const InferenceEngine::InputsDataMap & inputs, const InferenceEngine::OutputsDataMap & outputs,
+    int timeout_ms);
+  ~RemoteRequest();
+  RemoteRequest(const RemoteRequest &) = delete;
+  RemoteRequest & operator=(const RemoteRequest &) = delete;
+
+  InferenceEngine::Blob::Ptr getInput(const std::string & name) override;
+  /**
+   * @brief Replace an input by a blob of the same tensor: the server does no
+   * resizing nor layout conversion.
+   */
+  void setInput(const std::string & name, const InferenceEngine::Blob::Ptr & blob) override;
+  InferenceEngine::Blob::CPtr getOutput(const std::string & name) override;
+  /**
+   * @brief Send only the first frames of the batch of the inputs.
+   */
+  void setBatch(int batch) override;
+  /**
+   * @brief Run the inference on the thread of the request.
+   */
+  void startAsync() override;
+  void infer() override;
+  void cancel() override;
+  void setCompletionCallback(const std::function<void(bool)> & callback) override;
+
+private:
+  bool run(std::string & error);
+  void work();
+
+  KServeClient client_;
+  const int timeout_ms_;
+  std::map<std::string, InferenceEngine::Blob::Ptr> inputs_;
+  std::map<std::string, InferenceEngine::Blob::Ptr> outputs_;
+  int batch_ = 0;
+  std::function<void(bool)> callback_;
+  bool started_ = false;
+  bool stopping_ = false;
+  /**< whether the last inference failed, so that a failing server is logged once >**/
+  bool failing_ = false;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::thread thread_;
+};
+}  // namespace Engines
+
+#endif  // DYNAMIC_VINO_LIB__ENGINES__REMOTE_REQUEST_HPP_
@@ -0,0 +1,127 @@
+// Copyright (c) 2018-2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @brief A header file with declaration for RequestBackend Class
+ * @file request_backend.hpp
+ */
+#ifndef DYNAMIC_VINO_LIB__ENGINES__REQUEST_BACKEND_HPP_
+#define DYNAMIC_VINO_LIB__ENGINES__REQUEST_BACKEND_HPP_
+
+#pragma once
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include "inference_engine.hpp"
+
+namespace Engines
+{
+/**
+ * @class RequestBackend
+ * @brief The interface of an infer request the models run, whatever runs it:
+ * a request of a network loaded on a local device, a request to a model server.
+ * The inputs are filled before the request is started, the outputs are read
+ * once it completed, until it is started again.
+ */
+class RequestBackend
+{
+public:
+  using Ptr = std::shared_ptr<RequestBackend>;
+
+  virtual ~RequestBackend() = default;
+  /**
+   * @brief Get an input tensor, to be filled before the request is started.
+   * @throw std::exception If the model has no input of the name.
+   */
+  virtual InferenceEngine::Blob::Ptr getInput(const std::string & name) = 0;
+  /**
+   * @brief Replace an input tensor, e.g. by a frame wrapped without copying it.
+   */
+  virtual void setInput(const std::string & name, const InferenceEngine::Blob::Ptr & blob) = 0;
+  /**
+   * @brief Replace an input tensor by a blob the backend converts first, e.g.
+   * an NV12 frame resized and converted to the input by the plugin.
+   * @throw std::logic_error If the backend does no preprocessing.
+   */
+  virtual void setPreprocessedInput(
+    const std::string & name, const InferenceEngine::Blob::Ptr & blob,
+    const InferenceEngine::PreProcessInfo & info)
+  {
+    throw std::logic_error("No preprocessing of the input " + name + " by this backend");
+  }
+  /**
+   * @brief Replace an output tensor by a blob the request writes into instead.
+   * @throw std::logic_error If the backend holds its own outputs.
+   */
+  virtual void setOutput(const std::string & name, const InferenceEngine::Blob::Ptr & blob)
+  {
+    throw std::logic_error("No user-owned output " + name + " for this backend");
+  }
+  /**
+   * @brief Get a view of an output tensor of the last run.
+   * @throw std::exception If the model has no output of the name.
+   */
+  virtual InferenceEngine::Blob::CPtr getOutput(const std::string & name) = 0;
+  /**
+   * @brief Run only the first frames of the batch of the inputs, for the
+   * backends supporting partial batches.
+   */
+  virtual void setBatch(int batch) = 0;
+  /**
+   * @brief Start the request, the completion callback is called once it is done.
+   */
+  virtual void startAsync() = 0;
+  /**
+   * @brief Run the request on the calling thread, no completion callback is called.
+   * @throw std::exception If the request failed.
+   */
+  virtual void infer() = 0;
+  /**
+   * @brief Abort the request running, it completes as failed.
+   */
+  virtual void cancel() = 0;
+  /**
+   * @param[in] callback Called when the started request is finished, with
+   * whether it succeeded.
+   */
+  virtual void setCompletionCallback(const std::function<void(bool)> & callback) = 0;
+  /**
+   * @brief Get the per-layer performance counts of the last run, none if the
+   * backend does not report them.
+   */
+  virtual std::map<std::string, InferenceEngine::InferenceEngineProfileInfo>
+  getPerformanceCounts()
+  {
+    return {};
+  }
+  /**
+   * @brief Allocate a blob of the tensor, for the backends holding their own.
+   * @throw std::logic_error For the precisions without a blob type.
+   */
+  static InferenceEngine::Blob::Ptr allocateBlob(const InferenceEngine::TensorDesc & desc);
+  /**
+   * @brief Make a blob of the tensor over memory held by the caller, e.g. shared
+   * with another process, which must outlive it.
+   * @throw std::logic_error For the precisions without a blob type.
+   */
+  static InferenceEngine::Blob::Ptr wrapBlob(
+    const InferenceEngine::TensorDesc & desc, void * memory);
+};
+}  // namespace Engines
+
+#endif  // DYNAMIC_VINO_LIB__ENGINES__REQUEST_BACKEND_HPP_
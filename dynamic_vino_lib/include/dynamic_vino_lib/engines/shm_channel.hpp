@@ -0,0 +1,242 @@
+// Copyright (c) 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @brief A header file with the protocol between the ShmRequests of the
+ * worker processes and the engine daemon running them. It only depends on the
+ * C++ and POSIX libraries.
+ * @file shm_channel.hpp
+ */
+
+#ifndef DYNAMIC_VINO_LIB__ENGINES__SHM_CHANNEL_HPP_
+#define DYNAMIC_VINO_LIB__ENGINES__SHM_CHANNEL_HPP_
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace Engines
+{
+//
+// A request of a worker is one connection to the daemon, on a Unix socket,
+// and one shared memory segment holding its tensors. The worker creates the
+// segment, describes the tensors in it and hands its descriptor over with a
+// Hello; the daemon loads the network (once for all the workers asking for
+// the same model, device and tensors) and binds the tensors of one of its
+// requests to the segment. Then each run is a Message each way, the tensors
+// never go through the socket. A closed connection ends the request.
+//
+namespace ShmChannel
+{
+const uint32_t kMagic = 0x4f565345;  // "OVSE"
+const uint32_t kVersion = 1;
+const size_t kMaxName = 128;
+const size_t kMaxDims = 8;
+const size_t kMaxTensors = 32;
+const char * const kDefaultSocket = "/tmp/dynamic_vino_lib_engine.sock";
+
+/**
+ * @brief A tensor of the model, at 'offset' in the segment.
+ */
+struct Tensor
+{
+  char name[kMaxName];
+  uint32_t input;
+  /**< InferenceEngine::Precision::ePrecision >**/
+  uint32_t precision;
+  /**< InferenceEngine::Layout >**/
+  uint32_t layout;
+  uint32_t rank;
+  uint64_t dims[kMaxDims];
+  uint64_t offset;
+  uint64_t bytes;
+};
+
+/**
+ * @brief At the start of the segment, followed by the tensor data.
+ */
+struct SegmentHeader
+{
+  uint32_t magic;
+  uint32_t version;
+  uint32_t tensor_count;
+  uint32_t reserved;
+  Tensor tensors[kMaxTensors];
+};
+
+/**
+ * @brief The first message of a connection, along with the segment descriptor.
+ */
+struct Hello
+{
+  uint32_t magic;
+  uint32_t version;
+  /**< the IR of the model, read by the daemon from the same file system >**/
+  char model[1024];
+  char device[128];
+  uint64_t segment_bytes;
+};
+
+enum MessageType : uint32_t
+{
+  kRun = 1,
+  kDone = 2,
+  kFailed = 3,
+};
+
+struct Message
+{
+  uint32_t type;
+  /**< the frames of the batch to run, for kRun >**/
+  int32_t batch;
+};
+
+inline uint64_t getDataOffset()
+{
+  return (sizeof(SegmentHeader) + 63) / 64 * 64;
+}
+
+/**
+ * @brief Get the daemon socket and the device of a "<device>[@<socket>]" engine.
+ */
+inline void parseEngine(const std::string & engine, std::string & device, std::string & socket)
+{
+  size_t at = engine.find('@');
+  device = engine.substr(0, at);
+  socket = at == std::string::npos ? kDefaultSocket : engine.substr(at + 1);
+}
+
+inline void setName(char * target, size_t size, const std::string & name)
+{
+  std::strncpy(target, name.c_str(), size - 1);
+  target[size - 1] = '\0';
+}
+
+inline bool sendAll(int fd, const void * data, size_t size)
+{
+  auto bytes = static_cast<const uint8_t *>(data);
+  while (size > 0) {
+    ssize_t sent = ::send(fd, bytes, size, MSG_NOSIGNAL);
+    if (sent < 0 && errno == EINTR) {
+      continue;
+    }
+    if (sent <= 0) {
+      return false;
+    }
+    bytes += sent;
+    size -= sent;
+  }
+  return true;
+}
+
+/**
+ * @param[in] timeout_ms The time to wait for the data at most, -1 for no limit.
+ * @return False on a timeout, an error or a closed connection.
+ */
+inline bool receiveAll(int fd, void * data, size_t size, int timeout_ms = -1)
+{
+  auto bytes = static_cast<uint8_t *>(data);
+  while (size > 0) {
+    struct pollfd ready = {fd, POLLIN, 0};
+    int polled = ::poll(&ready, 1, timeout_ms);
+    if (polled < 0 && errno == EINTR) {
+      continue;
+    }
+    if (polled <= 0) {
+      return false;
+    }
+    ssize_t received = ::recv(fd, bytes, size, 0);
+    if (received < 0 && errno == EINTR) {
+      continue;
+    }
+    if (received <= 0) {
+      return false;
+    }
+    bytes += received;
+    size -= received;
+  }
+  return true;
+}
+
+/**
+ * @brief Send a message along with a file descriptor (SCM_RIGHTS).
+ */
+inline bool sendWithFd(int fd, const void * data, size_t size, int passed_fd)
+{
+  struct iovec io;
+  io.iov_base = const_cast<void *>(data);
+  io.iov_len = size;
+  char control[CMSG_SPACE(sizeof(int))];
+  std::memset(control, 0, sizeof(control));
+  struct msghdr message;
+  std::memset(&message, 0, sizeof(message));
+  message.msg_iov = &io;
+  message.msg_iovlen = 1;
+  message.msg_control = control;
+  message.msg_controllen = sizeof(control);
+  struct cmsghdr * header = CMSG_FIRSTHDR(&message);
+  header->cmsg_level = SOL_SOCKET;
+  header->cmsg_type = SCM_RIGHTS;
+  header->cmsg_len = CMSG_LEN(sizeof(int));
+  std::memcpy(CMSG_DATA(header), &passed_fd, sizeof(int));
+  return ::sendmsg(fd, &message, MSG_NOSIGNAL) == static_cast<ssize_t>(size);
+}
+
+/**
+ * @brief Receive a message sent by sendWithFd.
+ * @param[out] passed_fd The descriptor passed, -1 if none.
+ */
+inline bool receiveWithFd(int fd, void * data, size_t size, int & passed_fd)
+{
+  passed_fd = -1;
+  struct iovec io;
+  io.iov_base = data;
+  io.iov_len = size;
+  char control[CMSG_SPACE(sizeof(int))];
+  struct msghdr message;
+  std::memset(&message, 0, sizeof(message));
+  message.msg_iov = &io;
+  message.msg_iovlen = 1;
+  message.msg_control = control;
+  message.msg_controllen = sizeof(control);
+  ssize_t received = ::recvmsg(fd, &message, MSG_WAITALL);
+  if (received != static_cast<ssize_t>(size)) {
+    return false;
+  }
+  struct cmsghdr * header = CMSG_FIRSTHDR(&message);
+  if (header != nullptr && header->cmsg_level == SOL_SOCKET && header->cmsg_type == SCM_RIGHTS) {
+    std::memcpy(&passed_fd, CMSG_DATA(header), sizeof(int));
+  }
+  return true;
+}
+
+inline bool makeAddress(const std::string & path, struct sockaddr_un & address)
+{
+  if (path.size() >= sizeof(address.sun_path)) {
+    return false;
+  }
+  std::memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+  return true;
+}
+}  // namespace ShmChannel
+}  // namespace Engines
+
+#endif  // DYNAMIC_VINO_LIB__ENGINES__SHM_CHANNEL_HPP_
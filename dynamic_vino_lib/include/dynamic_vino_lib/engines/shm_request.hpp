@@ -0,0 +1,111 @@
+// Copyright (c) 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @brief A header file with declaration for ShmRequest Class
+ * @file shm_request.hpp
+ */
+#ifndef DYNAMIC_VINO_LIB__ENGINES__SHM_REQUEST_HPP_
+#define DYNAMIC_VINO_LIB__ENGINES__SHM_REQUEST_HPP_
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "dynamic_vino_lib/engines/request_backend.hpp"
+#include "inference_engine.hpp"
+
+namespace Engines
+{
+/**
+ * @class ShmRequest
+ * @brief An infer request run by the engine daemon of the host (see
+ * shm_channel.hpp), for the pipelines split into worker processes: the
+ * network is loaded once by the daemon for all of them. The tensors are in
+ * memory shared with the daemon, the models fill and read them in place.
+ * The connection is made by the first run, and made again by the next run
+ * once lost, e.g. when the daemon restarted.
+ */
+class ShmRequest : public RequestBackend
+{
+public:
+  /**
+   * @param[in] socket The Unix socket the daemon listens on.
+   * @param[in] device The device the daemon runs the model on.
+   * @param[in] model The IR of the model, read by the daemon.
+   * @param[in] inputs, outputs The inputs and outputs of the model, as set up
+   * by its updateLayerProperty.
+   * @param[in] timeout_ms The time a run may take on the daemon at most.
+   */
+  ShmRequest(
+    const std::string & socket, const std::string & device, const std::string & model,
+    const InferenceEngine::InputsDataMap & inputs, const InferenceEngine::OutputsDataMap & outputs,
+    int timeout_ms);
+  ~ShmRequest();
+  ShmRequest(const ShmRequest &) = delete;
+  ShmRequest & operator=(const ShmRequest &) = delete;
+
+  InferenceEngine::Blob::Ptr getInput(const std::string & name) override;
+  /**
+   * @brief Copy a blob of the same tensor into the shared input.
+   */
+  void setInput(const std::string & name, const InferenceEngine::Blob::Ptr & blob) override;
+  InferenceEngine::Blob::CPtr getOutput(const std::string & name) override;
+  void setBatch(int batch) override;
+  /**
+   * @brief Run the inference on the thread of the request.
+   */
+  void startAsync() override;
+  void infer() override;
+  void cancel() override;
+  void setCompletionCallback(const std::function<void(bool)> & callback) override;
+
+private:
+  void addTensor(
+    const std::string & name, const InferenceEngine::TensorDesc & desc, bool input,
+    uint64_t & offset);
+  bool connect(std::string & error);
+  void disconnect();
+  bool run(std::string & error);
+  void work();
+
+  const std::string socket_path_;
+  const std::string device_;
+  const std::string model_;
+  const int timeout_ms_;
+  int segment_fd_ = -1;
+  uint8_t * segment_ = nullptr;
+  size_t segment_bytes_ = 0;
+  std::atomic<int> socket_{-1};
+  std::map<std::string, InferenceEngine::Blob::Ptr> inputs_;
+  std::map<std::string, InferenceEngine::Blob::Ptr> outputs_;
+  int batch_ = 0;
+  std::function<void(bool)> callback_;
+  bool started_ = false;
+  bool stopping_ = false;
+  /**< whether the last inference failed, so that a failing daemon is logged once >**/
+  bool failing_ = false;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::thread thread_;
+};
+}  // namespace Engines
+
+#endif  // DYNAMIC_VINO_LIB__ENGINES__SHM_REQUEST_HPP_
@@ -0,0 +1,349 @@
+// Copyright (c) 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @brief a header file with declaration of FrameContext and FrameContextPool class
+ * @file frame_context.hpp
+ */
+#ifndef DYNAMIC_VINO_LIB__FRAME_CONTEXT_HPP_
+#define DYNAMIC_VINO_LIB__FRAME_CONTEXT_HPP_
+
+#include <std_msgs/msg/header.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "dynamic_vino_lib/inferences/result_view.hpp"
+#include "dynamic_vino_lib/utils/preprocess_cache.hpp"
+#include "opencv2/opencv.hpp"
+
+namespace Input
+{
+class DepthLookup;
+}  // namespace Input
+
+/**
+ * @brief The times, on the steady clock, a frame went through the pipeline at.
+ */
+struct FrameTimes
+{
+  /**< bound to a context, i.e. captured >**/
+  std::chrono::steady_clock::time_point capture;
+  /**< taken by the pipeline to be processed >**/
+  std::chrono::steady_clock::time_point dequeue;
+  /**< all its infer requests done >**/
+  std::chrono::steady_clock::time_point inference_done;
+  uint64_t frame_id = 0;
+};
+
+/**
+ * @class FrameContext
+ * @brief This class stores everything belonging to one input frame while it
+ * travels through the pipeline graph: the frame itself, its header, the ROIs
+ * handed to each downstream inference, the result locations of each
+ * inference and the number of outstanding infer requests.
+ */
+class FrameContext
+{
+public:
+  /**< the results routed to each output, in the order they were routed >**/
+  using DeferredResults =
+    std::vector<std::pair<std::shared_ptr<Outputs::BaseOutput>, dynamic_vino_lib::ResultView>>;
+
+  FrameContext() = default;
+  /**
+   * @brief Clear all per-frame data so that the context can be reused.
+   */
+  void reset();
+  /**
+   * @brief Bind a new frame to the context.
+   * @param[in] frame The frame read from the input device.
+   * @param[in] header The header of the frame.
+   * @param[in] nv12 Whether the frame is NV12 (see utils/nv12.hpp) instead of BGR.
+   */
+  void setFrame(
+    const cv::Mat & frame, const std_msgs::msg::Header & header, bool nv12 = false);
+  /**
+   * @brief Get the frame as BGR. An NV12 frame is converted the first time,
+   * only if something reads it as BGR.
+   */
+  const cv::Mat & getFrame() const;
+  /**
+   * @brief Get the NV12 frame read from the input device, empty for a BGR one.
+   */
+  const cv::Mat & getNV12Frame() const
+  {
+    return nv12_frame_;
+  }
+  bool isNV12() const
+  {
+    return !nv12_frame_.empty();
+  }
+  /**
+   * @brief Get the frame for the consumers turning it into gray anyway (motion
+   * gate, tracker): the Y plane of an NV12 frame, the BGR frame otherwise.
+   */
+  cv::Mat getGrayFrame() const;
+  const std_msgs::msg::Header & getHeader() const
+  {
+    return header_;
+  }
+  int getWidth() const
+  {
+    return size_.width;
+  }
+  int getHeight() const
+  {
+    return size_.height;
+  }
+  /**
+   * @brief Get the frame rect, used to clip ROIs into the frame.
+   */
+  cv::Rect getFrameRect() const
+  {
+    return cv::Rect(cv::Point(), size_);
+  }
+  /**
+   * @brief Get the time the frame was bound to the context, i.e. captured.
+   */
+  const std::chrono::steady_clock::time_point & getCaptureTime() const
+  {
+    return times_.capture;
+  }
+  /**
+   * @brief Get the times the frame went through the pipeline at so far.
+   */
+  const FrameTimes & getTimes() const
+  {
+    return times_;
+  }
+  void markDequeued()
+  {
+    times_.dequeue = std::chrono::steady_clock::now();
+  }
+  void markInferenceDone()
+  {
+    times_.inference_done = std::chrono::steady_clock::now();
+  }
+  /**
+   * @brief Get the time the outputs of the frame are due, only meaningful
+   * if hasDeadline().
+   */
+  const std::chrono::steady_clock::time_point & getDeadline() const
+  {
+    return deadline_;
+  }
+  bool hasDeadline() const
+  {
+    return deadline_ != std::chrono::steady_clock::time_point();
+  }
+  void setDeadline(const std::chrono::steady_clock::time_point & deadline)
+  {
+    deadline_ = deadline;
+  }
+  uint64_t getFrameId() const
+  {
+    return times_.frame_id;
+  }
+  void setFrameId(uint64_t id)
+  {
+    times_.frame_id = id;
+  }
+  /**
+   * @brief Get the index of the pipeline input the frame is read from.
+   */
+  int getInputId() const
+  {
+    return input_id_;
+  }
+  void setInputId(int id)
+  {
+    input_id_ = id;
+  }
+  /**
+   * @brief Get the region of the frame the first-stage inferences run on, the
+   * whole frame unless a region is set.
+   */
+  cv::Rect getInferenceRegion() const
+  {
+    return inference_region_.area() > 0 ? inference_region_ : getFrameRect();
+  }
+  void setInferenceRegion(const cv::Rect & region)
+  {
+    inference_region_ = region & getFrameRect();
+  }
+  /**
+   * @brief Get the factor from the pixels of the frame to those of the native
+   * frame of the input, above 1 when it was downscaled to the working width.
+   */
+  float getFrameScale() const
+  {
+    return frame_scale_;
+  }
+  void setFrameScale(float scale)
+  {
+    frame_scale_ = scale;
+  }
+  /**
+   * @brief Get the depth of the frame, nullptr if its input has none.
+   */
+  const std::shared_ptr<Input::DepthLookup> & getDepth() const
+  {
+    return depth_;
+  }
+  void setDepth(std::shared_ptr<Input::DepthLookup> depth)
+  {
+    depth_ = std::move(depth);
+  }
+  /**
+   * @brief Get the frames since an inference of the graph last ran on the
+   * input of this frame, 0 if it runs on this frame (see
+   * BaseInference::setExecutionRate).
+   * @param[in] node The index of the inference in the compiled graph.
+   */
+  int getResultAge(int node) const
+  {
+    return node < static_cast<int>(result_ages_.size()) ? result_ages_[node] : 0;
+  }
+  /**
+   * @brief Set the age of the results of an inference, by the pipeline thread
+   * before the frame is dispatched.
+   */
+  void setResultAge(int node, int age)
+  {
+    if (node >= static_cast<int>(result_ages_.size())) {
+      result_ages_.resize(node + 1, 0);
+    }
+    result_ages_[node] = age;
+  }
+  /**
+   * @brief Get the resized copies of the frame and of its ROIs shared by the
+   * inferences.
+   */
+  PreprocessCache & getPreprocessCache()
+  {
+    return preprocess_cache_;
+  }
+  /**
+   * @brief Record the ROIs dispatched from one inference to another.
+   * @param[in] parent Name of the inference which produced the ROIs.
+   * @param[in] child Name of the inference which consumes the ROIs.
+   * @param[in] rois The ROIs dispatched.
+   */
+  void setRois(
+    const std::string & parent, const std::string & child,
+    const std::vector<cv::Rect> & rois);
+  std::vector<cv::Rect> getRois(const std::string & parent, const std::string & child);
+  /**
+   * @brief Claim the ROIs about to be inferred by an inference for this frame:
+   * those overlapping a ROI already claimed for it (e.g. routed by another of
+   * its parents) above the IoU are dropped, keeping the order of the others.
+   * @param[in,out] rois The ROIs routed to the inference.
+   * @param[in,out] track_keys The track key of each ROI, left as is if missing.
+   */
+  void claimRois(
+    const std::string & child, float iou, std::vector<cv::Rect> & rois,
+    std::vector<int64_t> & track_keys);
+  /**
+   * @brief Record the result locations produced by an inference for this frame.
+   * Results of several batches of the same inference are appended.
+   */
+  void addResults(const std::string & inference, const std::vector<cv::Rect> & results);
+  std::vector<cv::Rect> getResults(const std::string & inference);
+  /**
+   * @brief Keep the results routed to an output until the frame is output,
+   * when the outputs are still busy with an earlier frame of the input.
+   * @param[in] results A view owning its results (see ResultView::share).
+   */
+  void deferResults(
+    const std::shared_ptr<Outputs::BaseOutput> & output,
+    const dynamic_vino_lib::ResultView & results);
+  /**
+   * @brief Take the results deferred for the outputs of the frame.
+   */
+  void takeDeferredResults(DeferredResults & results);
+
+  void increaseInferenceCounter();
+  void decreaseInferenceCounter();
+  int getInferenceCounter();
+  /**
+   * @brief Block until all the infer requests bound to this frame are done.
+   */
+  void waitInferenceDone();
+  /**
+   * @brief Wait for the infer requests bound to this frame for at most the timeout.
+   * @return Whether they are all done.
+   */
+  bool waitInferenceDone(const std::chrono::milliseconds & timeout);
+
+private:
+  /**< the BGR frame, converted on demand from an NV12 one >**/
+  mutable cv::Mat frame_;
+  cv::Mat nv12_frame_;
+  cv::Size size_;
+  mutable std::mutex frame_mutex_;
+  std_msgs::msg::Header header_;
+  FrameTimes times_;
+  std::chrono::steady_clock::time_point deadline_;
+  int input_id_ = 0;
+  cv::Rect inference_region_;
+  float frame_scale_ = 1;
+  std::shared_ptr<Input::DepthLookup> depth_;
+  PreprocessCache preprocess_cache_;
+  /**< by node of the graph, the frames since the inference last ran >**/
+  std::vector<int> result_ages_;
+  std::mutex data_mutex_;
+  std::map<std::string, std::vector<cv::Rect>> rois_;
+  /**< by inference, the ROIs claimed by any of its parents >**/
+  std::map<std::string, std::vector<cv::Rect>> claimed_rois_;
+  std::map<std::string, std::vector<cv::Rect>> results_;
+  DeferredResults deferred_results_;
+  /**< the outstanding infer requests, counted down without a lock >**/
+  std::atomic<int> counter_{0};
+  /**< whether a thread waits for the frame, woken once when the count reaches 0 >**/
+  std::atomic<bool> waiting_{false};
+  std::mutex counter_mutex_;
+  std::condition_variable cv_;
+};
+
+/**
+ * @class FrameContextPool
+ * @brief This class recycles FrameContext instances, so that frame buffers and
+ * containers are reused across frames instead of being allocated per frame.
+ * A context is free when the pool holds the only reference to it.
+ */
+class FrameContextPool
+{
+public:
+  /**
+   * @brief Get a free (and reset) context, a new one is allocated if all the
+   * pooled contexts are in use.
+   */
+  std::shared_ptr<FrameContext> acquire();
+  size_t size();
+
+private:
+  std::vector<std::shared_ptr<FrameContext>> contexts_;
+  std::mutex pool_mutex_;
+  uint64_t next_frame_id_ = 0;
+};
+
+#endif  // DYNAMIC_VINO_LIB__FRAME_CONTEXT_HPP_
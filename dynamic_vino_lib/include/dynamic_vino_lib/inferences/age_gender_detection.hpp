@@ -72,7 +72,7 @@ public:
  * @brief Class to load age and gender detection model and perform
    age and gender detection.
  */
-class AgeGenderDetection : public BaseInference
+class AgeGenderDetection : public SlotSelectingInference<AgeGenderResult>
 {
 public:
   using Result = dynamic_vino_lib::AgeGenderResult;
@@ -120,17 +120,23 @@ public:
    */
   const std::string getName() const override;
   /**
-   * @brief Show the observed detection result either through image window
+   * @brief Get the observed detection result, shown either through image window
    * or ROS topic.
    */
-  void observeOutput(const std::shared_ptr<Outputs::BaseOutput> & output) override;
+  ResultView getResultView() const override;
+  void loadCachedResults(
+    const std::vector<cv::Rect> & rois, const std::vector<int64_t> & track_keys,
+    std::vector<size_t> & stale, bool any_age) override;
+  ResultView getCachedResultView() const override;
+  void cacheResults(const std::vector<int64_t> & track_keys) override;
 
   const std::vector<cv::Rect> getFilteredROIs(
     const std::string filter_conditions) const override;
 
 private:
   std::shared_ptr<Models::AgeGenderDetectionModel> valid_model_;
-  std::vector<Result> results_;
+  std::vector<Result> cached_results_;
+  ResultCache<Result> cache_;
 };
 }  // namespace dynamic_vino_lib
 
@@ -19,11 +19,14 @@
 #ifndef DYNAMIC_VINO_LIB__INFERENCES__BASE_FILTER_HPP_
 #define DYNAMIC_VINO_LIB__INFERENCES__BASE_FILTER_HPP_
 
+#include <functional>
+#include <map>
 #include <string>
 #include <vector>
 #include <utility>
 #include <stack>
 #include "dynamic_vino_lib/inferences/base_inference.hpp"
+#include "dynamic_vino_lib/utils/scratch_arena.hpp"
 
 namespace dynamic_vino_lib
 {
@@ -35,6 +38,19 @@ namespace dynamic_vino_lib
 class BaseFilter
 {
 public:
+  /**
+   * @brief A compiled filter expression, evaluated against one result.
+   */
+  template<typename T>
+  using Predicate = std::function<bool(const T &)>;
+  /**
+   * @brief Build the predicate of a condition on one key (e.g. label) from its
+   * relational operator and target value.
+   */
+  template<typename T>
+  using PredicateBuilder =
+    std::function<Predicate<T>(const std::string & op, const std::string & target)>;
+
   BaseFilter();
   /**
    * @brief Initiate a result filter.
@@ -129,6 +145,63 @@ public:
    */
   static float stringToFloat(const std::string &);
 
+  /**
+   * @brief Compile the filter conditions into a predicate. The targets are
+   * converted once here, so evaluating a result neither parses nor allocates.
+   * @param[in] Filter conditions, the predicate builder of each key.
+   * @return The predicate, which accepts all results if the conditions are
+   * empty or malformed.
+   */
+  template<typename T>
+  Predicate<T> compile(
+    const std::string & filter_conditions,
+    const std::map<std::string, PredicateBuilder<T>> & builders)
+  {
+    auto accept_all = [](const T &) {return true;};
+    std::vector<std::string> suffix_conditions = toSuffix(split(strip(filter_conditions)));
+    std::vector<std::string> operands;
+    std::vector<Predicate<T>> predicates;
+    for (auto & elem : suffix_conditions) {
+      if (isRelationOperator(elem)) {
+        if (operands.size() < 2) {
+          break;
+        }
+        std::string target = operands.back();
+        operands.pop_back();
+        std::string key = operands.back();
+        operands.pop_back();
+        auto builder = builders.find(key);
+        if (builder == builders.end()) {
+          slog::err << "Unknown key " << key << " in filter conditions!" << slog::endl;
+          return accept_all;
+        }
+        predicates.push_back(builder->second(elem, target));
+      } else if (isLogicOperator(elem)) {
+        if (predicates.size() < 2) {
+          break;
+        }
+        Predicate<T> rhs = predicates.back();
+        predicates.pop_back();
+        Predicate<T> lhs = predicates.back();
+        predicates.pop_back();
+        if (!elem.compare("&&")) {
+          predicates.push_back([lhs, rhs](const T & result) {return lhs(result) && rhs(result);});
+        } else {
+          predicates.push_back([lhs, rhs](const T & result) {return lhs(result) || rhs(result);});
+        }
+      } else {
+        operands.push_back(elem);
+      }
+    }
+    if (predicates.size() != 1 || !operands.empty()) {
+      if (!suffix_conditions.empty()) {
+        slog::err << "Invalid filter conditions format: " << filter_conditions << slog::endl;
+      }
+      return accept_all;
+    }
+    return predicates.back();
+  }
+
   /**
    * @brief A macro to decide whether a given result satisfies the filter condition.
    * @param[in] A key to function mapping, a given result.
@@ -136,9 +209,10 @@ public:
    */
   #define ISVALIDRESULT(key_to_function, result) \
   { \
-    std::vector<std::string> suffix_conditons = getSuffixConditions(); \
-    std::stack<std::string> result_stack; \
-    for (auto elem : suffix_conditons) { \
+    const std::vector<std::string> & suffix_conditons = getSuffixConditions(); \
+    ScratchArena::Scope scratch; \
+    std::stack<std::string, ScratchVector<std::string>> result_stack; \
+    for (const auto & elem : suffix_conditons) { \
       if (!isRelationOperator(elem) && !isLogicOperator(elem)) { \
         result_stack.push(elem); \
       } else { \
@@ -178,6 +252,13 @@ private:
    */
   void infixToSuffix(std::vector<std::string>&infix_conditions);
 
+  /**
+   * @brief Convert the infix expression into suffix expression.
+   * @param[in] The infix form filter conditions.
+   * @return The suffix form filter conditions.
+   */
+  std::vector<std::string> toSuffix(const std::vector<std::string> & infix_conditions);
+
   /**
    * @brief Strip the extra space in a string.
    * @param[in] A string to be striped.
@@ -19,13 +19,29 @@
 #ifndef DYNAMIC_VINO_LIB__INFERENCES__BASE_INFERENCE_HPP_
 #define DYNAMIC_VINO_LIB__INFERENCES__BASE_INFERENCE_HPP_
 
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
 #include <memory>
 #include <string>
+#include <type_traits>
 #include <vector>
 
 #include "dynamic_vino_lib/engines/engine.hpp"
+#include "dynamic_vino_lib/inferences/result_cache.hpp"
+#include "dynamic_vino_lib/inferences/result_view.hpp"
+#include "dynamic_vino_lib/inferences/roi_gate.hpp"
+#include "dynamic_vino_lib/inferences/roi_merge.hpp"
 #include "dynamic_vino_lib/models/base_model.hpp"
 #include "dynamic_vino_lib/slog.hpp"
+#include "dynamic_vino_lib/utils/blob_packing.hpp"
+#include "dynamic_vino_lib/utils/fixed_packing.hpp"
+#include "dynamic_vino_lib/utils/opencl_preprocess.hpp"
+#include "dynamic_vino_lib/utils/preprocess_cache.hpp"
+#include "dynamic_vino_lib/utils/scratch_arena.hpp"
+#include "dynamic_vino_lib/utils/tensor_dump.hpp"
+#include "dynamic_vino_lib/utils/thread_pool.hpp"
 #include "inference_engine.hpp"
 #include "opencv2/opencv.hpp"
 
@@ -33,38 +49,82 @@ namespace Outputs
 {
 class BaseOutput;
 }
+namespace Input
+{
+class DepthLookup;
+}
 /**
  * @brief Load a frame into the input blob(memory).
  * @param[in] orig_image frame to be put.
- * @param[in] blob Blob that points to memory.
+ * @param[in] binding The bound input blob of the request, with its dims.
  * @param[in] scale_factor Scale factor for loading.
  * @param[in] batch_index Indicates the batch index for the frame.
+ * @param[in] cache The resized copies of orig_image shared with other
+ * inferences, if any.
  */
 template<typename T>
 void matU8ToBlob(
-  const cv::Mat & orig_image, InferenceEngine::Blob::Ptr & blob,
-  float scale_factor = 1.0, int batch_index = 0)
+  const cv::Mat & orig_image, const Engines::InputBinding & binding,
+  float scale_factor = 1.0, int batch_index = 0, PreprocessCache * cache = nullptr)
 {
-  InferenceEngine::SizeVector blob_size = blob->getTensorDesc().getDims();
-  const size_t width = blob_size[3];
-  const size_t height = blob_size[2];
-  const size_t channels = blob_size[1];
-  T * blob_data = blob->buffer().as<T *>();
-
-  cv::Mat resized_image(orig_image);
-  if (width != orig_image.size().width || height != orig_image.size().height) {
-    cv::resize(orig_image, resized_image, cv::Size(width, height));
-  }
-  int batchOffset = batch_index * width * height * channels;
-
-  for (size_t c = 0; c < channels; c++) {
-    for (size_t h = 0; h < height; h++) {
-      for (size_t w = 0; w < width; w++) {
-        blob_data[batchOffset + c * width * height + h * width + w] =
-          resized_image.at<cv::Vec3b>(h, w)[c] * scale_factor;
-      }
+  const size_t width = binding.dims[3];
+  const size_t height = binding.dims[2];
+  const size_t channels = binding.dims[1];
+  T * blob_data = binding.blob->buffer().as<T *>();
+  size_t batchOffset = batch_index * width * height * channels;
+
+  if (OpenCLPreprocess::isEnabled() && channels == 3) {
+    // the frame is uploaded once for all its inferences and ROIs
+    cv::UMat source = cache != nullptr ? cache->getUMat(orig_image) : cv::UMat();
+    if (source.empty()) {
+      source = OpenCLPreprocess::upload(orig_image);
+    }
+    if (OpenCLPreprocess::packToPlanar(source, cv::Size(width, height),
+      blob_data + batchOffset, scale_factor))
+    {
+      return;
     }
   }
+  if (cache != nullptr && std::is_same<T, uint8_t>::value && scale_factor == 1.0 &&
+    channels == 3)
+  {
+    cv::Mat planar = cache->get(orig_image, cv::Size(width, height), true);
+    if (!planar.empty()) {
+      std::memcpy(blob_data + batchOffset, planar.data, planar.total());
+      return;
+    }
+  }
+  ScratchArena::Scope scratch;
+  cv::Mat resized_image;
+  if (cache != nullptr) {
+    resized_image = cache->get(orig_image, cv::Size(width, height), false);
+  }
+  if (resized_image.empty()) {
+    resized_image = orig_image;
+    if (width != orig_image.size().width || height != orig_image.size().height) {
+      resized_image = scratch.getMat(cv::Size(width, height), orig_image.type());
+      cv::resize(orig_image, resized_image, cv::Size(width, height));
+    }
+  }
+
+  if (binding.fixed_shape >= 0 && resized_image.type() == CV_8UC(static_cast<int>(channels)) &&
+    packFixedShape(binding.fixed_shape, resized_image.data, resized_image.step,
+    blob_data + batchOffset, scale_factor))
+  {
+    return;
+  }
+  packToPlanar(resized_image, blob_data + batchOffset, scale_factor);
+}
+
+/**
+ * @brief Load a frame into an input blob not bound, its dims read first.
+ */
+template<typename T>
+void matU8ToBlob(
+  const cv::Mat & orig_image, InferenceEngine::Blob::Ptr & blob,
+  float scale_factor = 1.0, int batch_index = 0, PreprocessCache * cache = nullptr)
+{
+  matU8ToBlob<T>(orig_image, Engines::InputBinding(blob), scale_factor, batch_index, cache);
 }
 
 namespace dynamic_vino_lib
@@ -82,9 +142,31 @@ public:
   {
     return location_;
   }
+  /**
+   * @brief Move the result to another ROI, e.g. when it is reused for the
+   * current location of a tracked object.
+   */
+  inline void setLocation(const cv::Rect & location)
+  {
+    location_ = location;
+  }
+  /**
+   * @brief Get the 3D centroid of the location, in meters in the frame of the
+   * color camera. Only set if hasPosition(), i.e. the input gives depth.
+   */
+  inline const cv::Point3f & getPosition() const
+  {
+    return position_;
+  }
+  inline bool hasPosition() const
+  {
+    return has_position_;
+  }
 
 private:
   cv::Rect location_;
+  cv::Point3f position_;
+  bool has_position_ = false;
 };
 
 /**
@@ -100,7 +182,7 @@ public:
    * @brief load the Engine instance that contains the request for
    * running netwrok on target calculation device.
    */
-  void loadEngine(std::shared_ptr<Engines::Engine> engine);
+  virtual void loadEngine(std::shared_ptr<Engines::Engine> engine);
   /**
    * @brief Get the loaded Engine instance.
    * @return The loaded Engine instance.
@@ -132,6 +214,22 @@ public:
     max_batch_size_ = max;
   }
 
+  /**
+   * @brief Set the names the tracepoints of the inference carry (see tracing.hpp).
+   */
+  inline void setTraceNames(const std::string & pipeline, const std::string & node)
+  {
+    trace_pipeline_ = pipeline;
+    trace_node_ = node;
+  }
+  /**
+   * @brief Set the frame the next submitted or fetched request is traced for.
+   */
+  inline void setTraceFrame(uint64_t frame_id)
+  {
+    trace_frame_id_ = frame_id;
+  }
+
   /**
    * @brief Enqueue a frame to this class.
    * The frame will be buffered but not infered yet.
@@ -148,7 +246,11 @@ public:
   virtual bool submitRequest();
   virtual bool SynchronousRequest();
 
-  virtual void observeOutput(const std::shared_ptr<Outputs::BaseOutput> & output) = 0;
+  /**
+   * @brief Get a view of the results of the last request, handed to all the
+   * outputs of the inference.
+   */
+  virtual ResultView getResultView() const = 0;
 
   /**
    * @brief This function will fetch the results of the previous inference and
@@ -175,9 +277,303 @@ public:
 
   virtual const std::vector<cv::Rect> getFilteredROIs(
     const std::string filter_conditions) const = 0;
+  /**
+   * @brief Prepare the filter conditions of a connection once, before any
+   * frame is routed through getFilteredROIs with them.
+   */
+  virtual void compileFilterConditions(const std::string & filter_conditions) {}
+  /**
+   * @brief Get the filtered ROIs into a buffer reused by the caller, so that
+   * routing results does not allocate once the buffer has grown.
+   */
+  virtual void fillFilteredROIs(
+    const std::string & filter_conditions, std::vector<cv::Rect> & rois) const
+  {
+    rois = getFilteredROIs(filter_conditions);
+  }
+  /**
+   * @brief Whether whole frames of different inputs can be packed into one
+   * batch, with the results of each frame told apart by selectBatchSlots.
+   */
+  virtual bool isFrameBatchable() const
+  {
+    return false;
+  }
+  /**
+   * @brief Restrict the fetched results to the ones of the batch slots
+   * [first, first + count), or expose all of them again when first is -1.
+   */
+  virtual void selectBatchSlots(int first, int count) {}
+  /**
+   * @brief Whether selectBatchSlots tells apart the results of the ROIs of
+   * several frames cropped into one batch.
+   */
+  virtual bool supportsSlotSelection() const
+  {
+    return false;
+  }
+  /**
+   * @brief Hold a partial batch of ROIs for up to the given milliseconds, so
+   * that the ROIs of the other frames in flight fill it. 0 submits at once.
+   */
+  inline void setBatchWait(float batch_wait)
+  {
+    batch_wait_ = batch_wait;
+  }
+  inline float getBatchWait() const
+  {
+    return batch_wait_;
+  }
+  /**
+   * @brief Follow the fetched results of a whole frame of the given input
+   * across frames, e.g. to give them track IDs.
+   */
+  virtual void trackResults(int input_id, const cv::Mat & frame) {}
+  /**
+   * @brief Set the position of each fetched result from the depth of its location.
+   */
+  void locateResults(const Input::DepthLookup & depth);
+  /**
+   * @brief Produce the results of a frame without running the inference,
+   * by propagating the results tracked on the previous frames.
+   * @return Whether the frame is served this way, false if it has to be inferred.
+   */
+  virtual bool propagateResults(int input_id, const cv::Mat & frame)
+  {
+    return false;
+  }
+  /**
+   * @brief Produce the results of a frame without running the inference, by
+   * restoring the results of the last frame of the given input, e.g. when the
+   * frame did not change.
+   * @return Whether the results are restored, false if the frame has to be inferred.
+   */
+  virtual bool reuseResults(int input_id)
+  {
+    return false;
+  }
+  /**
+   * @brief Whether the results of a frame depend on the frames of its input
+   * inferred before, e.g. tracked across them, so that the frames of an input
+   * are inferred one after the other even with several frames in flight.
+   */
+  virtual bool dependsOnFrameOrder() const
+  {
+    return false;
+  }
+  /**
+   * @brief Whether a region of a whole frame can be enqueued by enqueueRegion,
+   * with the results located in the whole frame.
+   */
+  virtual bool supportsFrameRegions() const
+  {
+    return false;
+  }
+  /**
+   * @brief Enqueue a region of a whole frame, for first-stage inferences
+   * restricted to a part of their input.
+   */
+  virtual bool enqueueRegion(const cv::Mat & frame, const cv::Rect & region)
+  {
+    return enqueue(frame(region), region);
+  }
+  /**
+   * @brief Whether a whole NV12 frame (see utils/nv12.hpp) can be enqueued by
+   * enqueueNV12, without converting it to BGR first.
+   */
+  virtual bool supportsNV12() const
+  {
+    return false;
+  }
+  virtual bool enqueueNV12(const cv::Mat & nv12)
+  {
+    return false;
+  }
+  /**
+   * @brief Get the track ID of each ROI given by fillFilteredROIs, none if
+   * the results are not tracked.
+   */
+  virtual void fillFilteredTrackIds(
+    const std::string & filter_conditions, std::vector<int> & track_ids) const
+  {
+    track_ids.clear();
+  }
+  /**
+   * @brief Get the score of each ROI given by fillFilteredROIs, none if unknown.
+   */
+  virtual void fillFilteredRoiScores(
+    const std::string & filter_conditions, std::vector<RoiScore> & scores) const
+  {
+    scores.clear();
+  }
+  /**
+   * @brief Only infer the ROIs passing the policy, the others are dropped
+   * before they are enqueued.
+   */
+  inline void setRoiGatePolicy(const RoiGatePolicy & policy)
+  {
+    gate_policy_ = policy;
+  }
+  inline const RoiGatePolicy & getRoiGatePolicy() const
+  {
+    return gate_policy_;
+  }
+  inline bool isRoiGateEnabled() const
+  {
+    return gate_policy_.isEnabled();
+  }
+  /**
+   * @brief Fit the ROIs routed to the inference into the frame, and merge
+   * those routed by its different parents for the same region.
+   */
+  inline void setRoiMergePolicy(const RoiMergePolicy & policy)
+  {
+    merge_policy_ = policy;
+  }
+  inline const RoiMergePolicy & getRoiMergePolicy() const
+  {
+    return merge_policy_;
+  }
+  inline bool isRoiMergeEnabled() const
+  {
+    return merge_policy_.isEnabled();
+  }
+  /**
+   * @brief The ROIs of a frame are routed to the inferences of higher priority
+   * first, which matters when the frame has a deadline.
+   */
+  inline void setPriority(int priority)
+  {
+    priority_ = priority;
+  }
+  inline int getPriority() const
+  {
+    return priority_;
+  }
+  /**
+   * @brief Reuse the results of the tracked ROIs for a while instead of
+   * inferring them on every frame.
+   */
+  inline void setResultCachePolicy(const ResultCachePolicy & policy)
+  {
+    cache_policy_ = policy;
+  }
+  inline bool isResultCacheEnabled() const
+  {
+    return cache_policy_.refresh_interval > 1;
+  }
+  inline ResultCachePolicy getResultCachePolicy(bool any_age) const
+  {
+    ResultCachePolicy policy = cache_policy_;
+    policy.any_age = any_age;
+    return policy;
+  }
+  /**
+   * @brief Run the inference on a part of the frames only, the other frames
+   * reuse its last results: once every that many frames of an input, and at
+   * most max_hz times per second (0 for no limit).
+   */
+  inline void setExecutionRate(int every_n_frames, float max_hz)
+  {
+    every_n_frames_ = std::max(1, every_n_frames);
+    max_hz_ = std::max(0.0f, max_hz);
+  }
+  inline int getEveryNFrames() const
+  {
+    return every_n_frames_;
+  }
+  inline float getMaxHz() const
+  {
+    return max_hz_;
+  }
+  inline bool hasExecutionRate() const
+  {
+    return every_n_frames_ > 1 || max_hz_ > 0;
+  }
+  /**
+   * @brief Take the cached results of the ROIs routed to this inference, they
+   * are then published by getCachedResultView.
+   * @param[in] rois The ROIs routed to the inference.
+   * @param[in] track_keys The track key of each ROI (see makeTrackKey).
+   * @param[out] stale The indexes of the ROIs without fresh result, to infer.
+   * @param[in] any_age Take the cached results however old, for a frame the
+   * inference doesn't run on.
+   */
+  virtual void loadCachedResults(
+    const std::vector<cv::Rect> & rois, const std::vector<int64_t> & track_keys,
+    std::vector<size_t> & stale, bool any_age)
+  {
+    stale.resize(rois.size());
+    for (size_t i = 0; i < rois.size(); i++) {
+      stale[i] = i;
+    }
+  }
+  virtual ResultView getCachedResultView() const
+  {
+    return ResultView();
+  }
+  /**
+   * @brief Record the fetched results in the cache.
+   * @param[in] track_keys The track key of each enqueued ROI.
+   */
+  virtual void cacheResults(const std::vector<int64_t> & track_keys) {}
+  /**
+   * @brief Whether the inference reads the results of the inference its ROIs
+   * come from, through observeUpstream.
+   */
+  virtual bool observesUpstream() const
+  {
+    return false;
+  }
+  /**
+   * @brief The bytes of the gallery of the tracks recorded by the inference, if any.
+   */
+  virtual size_t getGalleryBytes()
+  {
+    return 0;
+  }
+  /**
+   * @brief Read the results of the upstream inference, before the ROIs it
+   * routes to this inference are dispatched.
+   */
+  virtual void observeUpstream(const BaseInference & upstream) {}
+  /**
+   * @brief Whether several requests of the engine can be in flight at the same
+   * time, i.e. enqueue doesn't touch the state read by fetchResults. Otherwise
+   * a request has to be fetched before the next one is enqueued.
+   */
+  virtual bool supportsConcurrentRequests() const
+  {
+    return false;
+  }
+
+  /**
+   * @brief Defer packing the enqueued frames into the input blob until
+   * packDeferred() is called, so that the batch slots are filled concurrently.
+   */
+  inline void setDeferredPacking(bool deferred)
+  {
+    deferred_packing_ = deferred;
+  }
+  /**
+   * @brief Pack the frames enqueued while packing was deferred, one task per
+   * batch slot on the given pool (serially if the pool is null). Blocks until
+   * all the slots are written.
+   */
+  void packDeferred(ThreadPool * pool);
 
   void addCandidatedModel(std::shared_ptr<Models::BaseModel> model);
 
+  /**
+   * @brief Record the input tensors of the requests under 'name' when they are
+   * submitted, e.g. to calibrate the model. Stopped by a null dump.
+   */
+  inline void setTensorDump(const std::shared_ptr<TensorDump> & dump, const std::string & name)
+  {
+    tensor_dump_ = dump;
+    tensor_dump_name_ = name;
+  }
+
 protected:
   /**
     * @brief Enqueue the fram into the input blob of the target calculation
@@ -194,12 +590,38 @@ protected:
         ") processed by inference" << slog::endl;
       return false;
     }
-    InferenceEngine::Blob::Ptr input_blob = engine_->getRequest()->GetBlob(input_name);
-    matU8ToBlob<T>(frame, input_blob, scale_factor, batch_index);
+    if (engine_->isPluginPreprocessEnabled()) {
+      // resized and converted by the plugin, batch is always 1 then
+      if (!engine_->setInputFrame(input_name, frame)) {
+        return false;
+      }
+      enqueued_frames_ += 1;
+      return true;
+    }
+    const Engines::InputBinding & binding = engine_->getInputBinding(input_name);
+    PreprocessCache * cache = engine_->getPreprocessCache();
+    if (deferred_packing_) {
+      // each job writes its own batch slot, the frame and the blob are kept by the capture
+      packing_jobs_.push_back([frame, binding, scale_factor, batch_index, cache]() {
+          matU8ToBlob<T>(frame, binding, scale_factor, batch_index, cache);
+        });
+    } else {
+      matU8ToBlob<T>(frame, binding, scale_factor, batch_index, cache);
+    }
     enqueued_frames_ += 1;
     return true;
   }
 
+  /**
+    * @brief Shrink the batch of the request to the number of enqueued frames,
+    * so that a partial last batch only computes the filled slots.
+    */
+  void setRequestBatch();
+  /**
+   * @brief Record the enqueued frames of the bound request into the tensor dump, if any.
+   */
+  void dumpInputs();
+
   std::vector<Result> results_;
 
 protected:
@@ -207,7 +629,60 @@ protected:
   std::vector<std::shared_ptr<Models::BaseModel> > candidated_models_;
   int max_batch_size_ = 1;
   int enqueued_frames_ = 0;
-  bool results_fetched_ = false;
+  /**< per request of the engine >**/
+  std::vector<bool> results_fetched_;
+  bool deferred_packing_ = false;
+  std::vector<std::function<void()>> packing_jobs_;
+  ResultCachePolicy cache_policy_;
+  RoiGatePolicy gate_policy_;
+  RoiMergePolicy merge_policy_;
+  int priority_ = 0;
+  float batch_wait_ = 0;
+  int every_n_frames_ = 1;
+  float max_hz_ = 0;
+  std::string trace_pipeline_;
+  std::string trace_node_;
+  uint64_t trace_frame_id_ = 0;
+  std::shared_ptr<TensorDump> tensor_dump_;
+  std::string tensor_dump_name_;
+};
+
+/**
+ * @class SlotSelectingInference
+ * @brief Base of the inferences with one result per enqueued ROI, in slot
+ * order: the results of the frames sharing a batch are told apart by their slots.
+ */
+template<typename T>
+class SlotSelectingInference : public BaseInference
+{
+public:
+  bool supportsSlotSelection() const override
+  {
+    return true;
+  }
+  void selectBatchSlots(int first, int count) override
+  {
+    if (first < 0) {
+      if (slots_selected_) {
+        results_.swap(batch_results_);
+        slots_selected_ = false;
+      }
+      return;
+    }
+    if (!slots_selected_) {
+      batch_results_.swap(results_);
+      slots_selected_ = true;
+    }
+    size_t begin = std::min(static_cast<size_t>(first), batch_results_.size());
+    size_t end = std::min(begin + static_cast<size_t>(std::max(count, 0)), batch_results_.size());
+    results_.assign(batch_results_.begin() + begin, batch_results_.begin() + end);
+  }
+
+protected:
+  std::vector<T> results_;
+  /**< all the fetched results while the slots of a frame are selected >**/
+  std::vector<T> batch_results_;
+  bool slots_selected_ = false;
 };
 }  // namespace dynamic_vino_lib
 
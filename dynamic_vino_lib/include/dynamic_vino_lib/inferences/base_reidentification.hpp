@@ -20,10 +20,16 @@
 #define DYNAMIC_VINO_LIB__INFERENCES__BASE_REIDENTIFICATION_HPP_
 #include <vector>
 #include <cmath>
+#include <condition_variable>
+#include <list>
+#include <memory>
 #include <string>
-#include <thread>
 #include <mutex>
+#include <thread>
 #include <unordered_map>
+#include <utility>
+#include "dynamic_vino_lib/inferences/gallery_index.hpp"
+#include "opencv2/opencv.hpp"
 
 // namespace
 namespace dynamic_vino_lib
@@ -35,65 +41,147 @@ namespace dynamic_vino_lib
 class Tracker
 {
 public:
-  explicit Tracker(int, double, double);
+  /**
+   * @param[in] index The index searched for the most similar tracks, an
+   * exact one if null.
+   */
+  Tracker(int, double, double, std::shared_ptr<GalleryIndex> index = nullptr);
+  /**
+   * @brief Get the tracker shared by all the inferences of the process asking
+   * for the same name, created with these parameters by the first of them, so
+   * that a person keeps one ID across the cameras. A shared tracker matches
+   * the tracks lock-free against a published snapshot of the recorded ones.
+   */
+  static std::shared_ptr<Tracker> getShared(
+    const std::string & name, int max_record_size, double same_track_thresh,
+    double new_track_thresh, std::shared_ptr<GalleryIndex> index = nullptr);
+  /**
+   * @brief Stop the snapshots, the tracks are saved one last time if they changed.
+   */
+  ~Tracker();
   /**
    * @brief Process the new detected track.
    * @param[in] feature The new detected track feature.
    * @return The detected track ID.
    */
   int processNewTrack(const std::vector<float> & feature);
-
-private:
   /**
-   * @brief Find the most similar track from the recorded tracks.
-   * @param[in] feature The input track's feature.
-   * @param[in] most similar track's ID to be recorded.
-   * @return similarity with the most similar track.
+   * @brief Process a batch of new detected tracks, matched against the
+   * recorded tracks all at once.
+   * @param[in] features One feature per row (CV_32F).
+   * @return The detected track ID of each row.
+   */
+  std::vector<int> processNewTracks(const cv::Mat & features);
+  /**
+   * @brief Save the recorded tracks into a binary gallery file: a versioned
+   * header, the ID and update time of each track, then the contiguous
+   * normalized features.
+   * @param[in] fp16 Whether the features are stored as float16 instead of float32.
+   * @return Whether the file is written.
+   */
+  bool saveTracksToFile(const std::string & filepath, bool fp16 = false);
+  /**
+   * @brief Replace the recorded tracks by those of a binary gallery file,
+   * which is memory-mapped and read straight into the index.
+   * @return Whether the file is loaded.
    */
-  double findMostSimilarTrack(const std::vector<float> & feature, int & most_similar_id);
+  bool loadTracksFromFile(const std::string & filepath);
+  /**
+   * @brief Load the gallery file if it exists, then save the tracks into it on
+   * a background thread every 'interval_ms' milliseconds if they changed (only
+   * when the tracker is destroyed if 'interval_ms' is 0).
+   */
+  void enableSnapshots(const std::string & filepath, int interval_ms, bool fp16 = false);
+  /**
+   * @brief The bytes allocated for the recorded tracks, their features mostly.
+   */
+  size_t getMemoryBytes();
+
+private:
   /**
    * @brief Update the matched track's feature by the new track.
    * @param[in] track_id The matched track ID.
-   * @param[in] feature The matched track's feature
+   * @param[in] feature The matched track's L2-normalized feature (one row).
    */
-  void updateMatchTrack(int track_id, const std::vector<float> & feature);
+  void updateMatchTrack(int track_id, const cv::Mat & feature);
   /**
    * @brief Remove the earlest track from the recorded tracks.
    */
   void removeEarlestTrack();
+  /**
+   * @brief Record a track as the most recently updated one.
+   */
+  void recordTrack(int track_id, int64_t update_time);
   /**
    * @brief Add a new track to the recorded tracks, remove oldest track if needed.
-   * @param[in] feature A track's feature.
+   * @param[in] feature A track's L2-normalized feature (one row).
    * @return new added track's ID.
    */
-  int addNewTrack(const std::vector<float> & feature);
+  int addNewTrack(const cv::Mat & feature);
   /**
-   * @brief Calculate the cosine similarity between two features.
-   * @return The simlarity result.
+   * @brief Match the tracks of a shared tracker: the queries are searched in the
+   * published snapshot without locking, the refreshed features of the matched
+   * tracks are written in batches, and only new tracks take the lock to be
+   * added (and republished) at once.
    */
-  double calcSimilarity(
-    const std::vector<float> & feature_a, const std::vector<float> & feature_b);
+  std::vector<int> processSharedTracks(const cv::Mat & features);
+  /**
+   * @brief Write the pending features of the matched tracks, with tracks_mtx_ held.
+   */
+  void flushUpdates();
+  /**
+   * @brief Publish a copy of the recorded features for the queries, with tracks_mtx_ held.
+   */
+  void publish();
+  /**
+   * @brief Scale each row of the features to unit L2 norm, so that the cosine
+   * similarity of two features is their dot product.
+   */
+  static cv::Mat normalizeRows(const cv::Mat & features);
   /**
    * @brief get the current millisecond count since epoch.
    * @return millisecond count since epoch.
    */
   int64_t getCurrentTime();
-
-  bool saveTracksToFile(std::string filepath);
-  bool loadTracksFromFile(std::string filepath);
-
-  struct Track
-  {
-    int64_t lastest_update_time;
-    std::vector<float> feature;
-  };
+  /**
+   * @brief Save the tracks into the snapshot file if they changed since the last snapshot.
+   */
+  void saveSnapshot();
 
   int max_record_size_ = 1000;
   int max_track_id_ = -1;
   double same_track_thresh_ = 0.9;
   double new_track_thresh_ = 0.3;
+  int feature_size_ = 0;
   std::mutex tracks_mtx_;
+  std::shared_ptr<GalleryIndex> index_;
+
+  struct Track
+  {
+    int64_t lastest_update_time;
+    std::list<int>::iterator lru_position;
+  };
   std::unordered_map<int, Track> recorded_tracks_;
+  /**< the track IDs from the least to the most recently updated >**/
+  std::list<int> lru_tracks_;
+
+  bool shared_ = false;
+  /**< the features the queries of a shared tracker are matched against,
+   * replaced (never modified) under tracks_mtx_ and read with std::atomic_load >**/
+  std::shared_ptr<const FeatureList> published_;
+  std::mutex pending_mtx_;
+  /**< the refreshed features of the matched tracks, not written yet >**/
+  std::vector<std::pair<int, cv::Mat>> pending_updates_;
+
+  /**< bumped whenever the recorded tracks change >**/
+  uint64_t version_ = 0;
+  uint64_t snapshot_version_ = 0;
+  std::string snapshot_path_;
+  bool snapshot_fp16_ = false;
+  bool stop_snapshots_ = false;
+  std::mutex snapshot_mtx_;
+  std::condition_variable snapshot_cv_;
+  std::thread snapshot_thread_;
 };
 
 }  // namespace dynamic_vino_lib
@@ -61,7 +61,7 @@ private:
  * @class EmotionDetection
  * @brief Class to load emotion detection model and perform emotion detection.
  */
-class EmotionsDetection : public BaseInference
+class EmotionsDetection : public SlotSelectingInference<EmotionsResult>
 {
 public:
   using Result = dynamic_vino_lib::EmotionsResult;
@@ -109,10 +109,15 @@ public:
    */
   const std::string getName() const override;
   /**
-   * @brief Show the observed detection result either through image window
+   * @brief Get the observed detection result, shown either through image window
    * or ROS topic.
    */
-  void observeOutput(const std::shared_ptr<Outputs::BaseOutput> & output) override;
+  ResultView getResultView() const override;
+  void loadCachedResults(
+    const std::vector<cv::Rect> & rois, const std::vector<int64_t> & track_keys,
+    std::vector<size_t> & stale, bool any_age) override;
+  ResultView getCachedResultView() const override;
+  void cacheResults(const std::vector<int64_t> & track_keys) override;
 
   std::vector<Result> getResults()
   {
@@ -123,7 +128,8 @@ public:
 
 private:
   std::shared_ptr<Models::EmotionDetectionModel> valid_model_;
-  std::vector<Result> results_;
+  std::vector<Result> cached_results_;
+  ResultCache<Result> cache_;
 };
 }  // namespace dynamic_vino_lib
 
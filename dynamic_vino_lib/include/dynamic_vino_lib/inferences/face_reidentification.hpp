@@ -19,13 +19,16 @@
 #ifndef DYNAMIC_VINO_LIB__INFERENCES__FACE_REIDENTIFICATION_HPP_
 #define DYNAMIC_VINO_LIB__INFERENCES__FACE_REIDENTIFICATION_HPP_
 #include <rclcpp/rclcpp.hpp>
+#include <deque>
 #include <memory>
+#include <utility>
 #include <vector>
 #include <string>
 #include "dynamic_vino_lib/models/face_reidentification_model.hpp"
 #include "dynamic_vino_lib/engines/engine.hpp"
 #include "dynamic_vino_lib/inferences/base_inference.hpp"
 #include "dynamic_vino_lib/inferences/base_reidentification.hpp"
+#include "dynamic_vino_lib/inferences/landmarks_detection.hpp"
 #include "inference_engine.hpp"
 #include "opencv2/opencv.hpp"
 // namespace
@@ -50,16 +53,43 @@ private:
  * @class FaceReidentification
  * @brief Class to load face reidentification model and perform face reidentification.
  */
-class FaceReidentification : public BaseInference
+class FaceReidentification : public SlotSelectingInference<FaceReidentificationResult>
 {
 public:
   using Result = dynamic_vino_lib::FaceReidentificationResult;
-  explicit FaceReidentification(double);
+  /**
+   * @param[in] match_thresh The similarity from which a face matches a track.
+   * @param[in] gallery_index The index searched for the recorded faces, exact if null.
+   * @param[in] gallery_size The maximum number of recorded faces.
+   * @param[in] shared_gallery The name of the tracker shared with the other inferences
+   * of the process, a private one if empty.
+   */
+  explicit FaceReidentification(
+    double match_thresh, std::shared_ptr<GalleryIndex> gallery_index = nullptr,
+    int gallery_size = 1000, const std::string & shared_gallery = "");
   ~FaceReidentification() override;
   /**
    * @brief Load the face reidentification model.
    */
   void loadNetwork(std::shared_ptr<Models::FaceReidentificationModel>);
+  /**
+   * @brief Get the tracker recording the faces.
+   */
+  std::shared_ptr<dynamic_vino_lib::Tracker> getTracker() const
+  {
+    return face_tracker_;
+  }
+  size_t getGalleryBytes() override
+  {
+    return face_tracker_ == nullptr ? 0 : face_tracker_->getMemoryBytes();
+  }
+  /**
+   * @brief The IDs are given by the gallery as the frames come.
+   */
+  bool dependsOnFrameOrder() const override
+  {
+    return true;
+  }
   /**
    * @brief Enqueue a frame to this class.
    * The frame will be buffered but not infered yet.
@@ -93,10 +123,10 @@ public:
    */
   const dynamic_vino_lib::Result * getLocationResult(int idx) const override;
   /**
-   * @brief Show the observed reidentification result either through image window
-     or ROS topic.
+   * @brief Get the observed reidentification result, shown either through image window
+   * or ROS topic.
    */
-  void observeOutput(const std::shared_ptr<Outputs::BaseOutput> & output);
+  ResultView getResultView() const override;
   /**
    * @brief Get the name of the Inference instance.
    * @return The name of the Inference instance.
@@ -104,11 +134,31 @@ public:
   const std::string getName() const override;
   const std::vector<cv::Rect> getFilteredROIs(
     const std::string filter_conditions) const override;
+  /**
+   * @brief The faces routed from a LandmarksDetection are aligned on their
+   * landmarks before being enqueued.
+   */
+  bool observesUpstream() const override
+  {
+    return true;
+  }
+  void observeUpstream(const BaseInference & upstream) override;
 
 private:
+  /**
+   * @brief Warp a face crop so that its eyes, nose and mouth corners are at
+   * the positions the reidentification network is trained with.
+   * @param[in] face The face crop.
+   * @param[in] roi The location of the face in the frame.
+   * @param[in] landmarks The five landmarks of the face, in the frame.
+   */
+  static cv::Mat alignFace(
+    const cv::Mat & face, const cv::Rect & roi, const std::vector<cv::Point> & landmarks);
+
   std::shared_ptr<Models::FaceReidentificationModel> valid_model_;
-  std::vector<Result> results_;
   std::shared_ptr<dynamic_vino_lib::Tracker> face_tracker_;
+  /**< landmarks of the faces routed but not enqueued yet, oldest first >**/
+  std::deque<std::pair<cv::Rect, std::vector<cv::Point>>> landmarks_;
 };
 }  // namespace dynamic_vino_lib
 #endif  // DYNAMIC_VINO_LIB__INFERENCES__FACE_REIDENTIFICATION_HPP_
@@ -0,0 +1,256 @@
+// Copyright (c) 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @brief A header file with declaration for the gallery indexes searched by Tracker
+ * @file gallery_index.hpp
+ */
+#ifndef DYNAMIC_VINO_LIB__INFERENCES__GALLERY_INDEX_HPP_
+#define DYNAMIC_VINO_LIB__INFERENCES__GALLERY_INDEX_HPP_
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "opencv2/opencv.hpp"
+
+namespace dynamic_vino_lib
+{
+/**
+ * @brief How the recorded features are stored: float32, float16 (OpenCV 4 only),
+ * or int8 scaled per feature.
+ */
+enum class FeaturePrecision {FP32, FP16, INT8};
+
+/**
+ * @class FeatureList
+ * @brief L2-normalized features stored as the rows of one matrix, so that a
+ * batch of queries is matched against all of them with one GEMM.
+ */
+class FeatureList
+{
+public:
+  explicit FeatureList(FeaturePrecision precision = FeaturePrecision::FP32);
+  /**
+   * @brief Append a feature (one CV_32F row).
+   * @return The row of the feature.
+   */
+  int add(int id, const cv::Mat & feature);
+  /**
+   * @brief Replace the feature of a row.
+   */
+  void update(int row, const cv::Mat & feature);
+  /**
+   * @brief Remove the feature of a row, the last row takes its place.
+   * @return The id of the feature moved into the row, -1 if none moved.
+   */
+  int remove(int row);
+  /**
+   * @brief Keep for each query the most similar feature of the list if it is
+   * more similar than the one already in 'ids'/'similarities'.
+   * @param[in] queries The normalized queries, one per row.
+   * @param[in] query_rows The queries to match, all of them if empty.
+   */
+  void search(
+    const cv::Mat & queries, const std::vector<int> & query_rows,
+    std::vector<int> & ids, std::vector<double> & similarities) const;
+  /**
+   * @brief Get the feature of a row as float32.
+   */
+  cv::Mat getFeature(int row) const;
+  /**
+   * @brief Get all the features as float32, converted if they are quantized.
+   */
+  cv::Mat getFeatures() const;
+
+  int getFeatureSize() const
+  {
+    return features_.cols;
+  }
+
+  const std::vector<int> & getIds() const
+  {
+    return ids_;
+  }
+
+  size_t size() const
+  {
+    return ids_.size();
+  }
+  /**
+   * @brief The bytes allocated for the features and the IDs.
+   */
+  size_t getMemoryBytes() const
+  {
+    return static_cast<size_t>(features_.datalimit - features_.datastart) +
+           ids_.capacity() * sizeof(int) + scales_.capacity() * sizeof(float);
+  }
+
+private:
+  /**
+   * @brief Convert a float32 feature to the stored precision.
+   * @param[out] scale The scale of an int8 feature, 1 otherwise.
+   */
+  cv::Mat encode(const cv::Mat & feature, float * scale) const;
+  /**
+   * @brief The similarities of the queries with the int8 features: the queries
+   * are quantized too and each feature is compared with integer dot products
+   * (see utils/simd_kernels.hpp).
+   */
+  cv::Mat scoreInt8(const cv::Mat & queries) const;
+  /**
+   * @brief The similarities of the queries with the float16 features, converted
+   * to float32 a cache-sized tile of rows at a time.
+   */
+  cv::Mat scoreFp16(const cv::Mat & queries) const;
+
+  FeaturePrecision precision_;
+  cv::Mat features_;
+  std::vector<int> ids_;
+  /**< the scale of each int8 feature >**/
+  std::vector<float> scales_;
+};
+
+/**
+ * @class GalleryIndex
+ * @brief Base class of the indexes of the recorded track features.
+ */
+class GalleryIndex
+{
+public:
+  explicit GalleryIndex(FeaturePrecision precision)
+  : precision_(precision) {}
+  virtual ~GalleryIndex() = default;
+  /**
+   * @brief Insert the feature of a track, or replace it if the track exists.
+   * @param[in] feature The L2-normalized feature (one CV_32F row).
+   */
+  virtual void upsert(int id, const cv::Mat & feature) = 0;
+  /**
+   * @brief Remove the feature of a track, if it exists.
+   */
+  virtual void remove(int id) = 0;
+  /**
+   * @brief Find the most similar track of each query.
+   * @param[in] queries The L2-normalized queries, one per row.
+   * @param[out] ids The most similar track's ID of each query, -1 if none.
+   * @param[out] similarities The cosine similarity with that track.
+   */
+  virtual void search(
+    const cv::Mat & queries, std::vector<int> & ids, std::vector<double> & similarities) = 0;
+  /**
+   * @brief Get the feature of a track, empty if it does not exist.
+   */
+  virtual cv::Mat getFeature(int id) const = 0;
+  virtual size_t size() const = 0;
+  virtual void clear() = 0;
+  /**
+   * @brief The bytes allocated for the recorded features.
+   */
+  virtual size_t getMemoryBytes() const = 0;
+
+  FeaturePrecision getPrecision() const
+  {
+    return precision_;
+  }
+
+protected:
+  FeaturePrecision precision_;
+};
+
+/**
+ * @class ExactGalleryIndex
+ * @brief Brute-force index, every query is compared with every track.
+ */
+class ExactGalleryIndex : public GalleryIndex
+{
+public:
+  explicit ExactGalleryIndex(FeaturePrecision precision = FeaturePrecision::FP32);
+
+  void upsert(int id, const cv::Mat & feature) override;
+  void remove(int id) override;
+  void search(
+    const cv::Mat & queries, std::vector<int> & ids,
+    std::vector<double> & similarities) override;
+  cv::Mat getFeature(int id) const override;
+  size_t size() const override
+  {
+    return list_.size();
+  }
+  void clear() override;
+  size_t getMemoryBytes() const override
+  {
+    return list_.getMemoryBytes();
+  }
+
+private:
+  FeatureList list_;
+  std::unordered_map<int, int> rows_;
+};
+
+/**
+ * @class IvfGalleryIndex
+ * @brief Inverted file index: the tracks are partitioned by their nearest k-means
+ * centroid and a query is only compared with the tracks of its 'probes' nearest
+ * partitions. It searches exhaustively until enough tracks are recorded to
+ * train the centroids.
+ */
+class IvfGalleryIndex : public GalleryIndex
+{
+public:
+  /**
+   * @param[in] lists The number of partitions.
+   * @param[in] probes The partitions searched per query, more for a better recall.
+   */
+  IvfGalleryIndex(
+    int lists, int probes, FeaturePrecision precision = FeaturePrecision::FP32);
+
+  void upsert(int id, const cv::Mat & feature) override;
+  void remove(int id) override;
+  void search(
+    const cv::Mat & queries, std::vector<int> & ids,
+    std::vector<double> & similarities) override;
+  cv::Mat getFeature(int id) const override;
+  size_t size() const override
+  {
+    return locations_.size();
+  }
+  void clear() override;
+  size_t getMemoryBytes() const override;
+
+private:
+  /**
+   * @brief Cluster the recorded tracks into the partitions.
+   */
+  void train();
+  int assign(const cv::Mat & feature) const;
+
+  int lists_count_;
+  int probes_;
+  size_t train_size_;
+  cv::Mat centroids_;  // empty until trained, the only list is lists_[0]
+  std::vector<FeatureList> lists_;
+  /**< the list and the row of each track >**/
+  std::unordered_map<int, std::pair<int, int>> locations_;
+};
+
+/**
+ * @brief Create a gallery index by type: "exact" or "ivf", storing the features
+ * by precision: "fp32", "fp16" or "int8".
+ */
+std::shared_ptr<GalleryIndex> createGalleryIndex(
+  const std::string & type, int lists = 64, int probes = 4,
+  const std::string & precision = "fp32");
+}  // namespace dynamic_vino_lib
+#endif  // DYNAMIC_VINO_LIB__INFERENCES__GALLERY_INDEX_HPP_
@@ -75,7 +75,7 @@ private:
  * @class HeadPoseDetection
  * @brief Class to load headpose detection model and perform headpose detection.
  */
-class HeadPoseDetection : public BaseInference
+class HeadPoseDetection : public SlotSelectingInference<HeadPoseResult>
 {
 public:
   using Result = dynamic_vino_lib::HeadPoseResult;
@@ -123,10 +123,15 @@ public:
    */
   const std::string getName() const override;
   /**
-   * @brief Show the observed detection result either through image window
-     or ROS topic.
+   * @brief Get the observed detection result, shown either through image window
+   * or ROS topic.
    */
-  void observeOutput(const std::shared_ptr<Outputs::BaseOutput> & output) override;
+  ResultView getResultView() const override;
+  void loadCachedResults(
+    const std::vector<cv::Rect> & rois, const std::vector<int64_t> & track_keys,
+    std::vector<size_t> & stale, bool any_age) override;
+  ResultView getCachedResultView() const override;
+  void cacheResults(const std::vector<int64_t> & track_keys) override;
 
   std::vector<Result> getResults()
   {
@@ -137,7 +142,8 @@ public:
 
 private:
   std::shared_ptr<Models::HeadPoseDetectionModel> valid_model_;
-  std::vector<Result> results_;
+  std::vector<Result> cached_results_;
+  ResultCache<Result> cache_;
 };
 }  // namespace dynamic_vino_lib
 #endif  // DYNAMIC_VINO_LIB__INFERENCES__HEAD_POSE_DETECTION_HPP_
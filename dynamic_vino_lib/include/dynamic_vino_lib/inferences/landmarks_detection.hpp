@@ -51,7 +51,7 @@ private:
  * @class LandmarksDetection
  * @brief Class to load landmarks detection model and perform landmarks detection.
  */
-class LandmarksDetection : public BaseInference
+class LandmarksDetection : public SlotSelectingInference<LandmarksDetectionResult>
 {
 public:
   using Result = dynamic_vino_lib::LandmarksDetectionResult;
@@ -94,10 +94,10 @@ public:
    */
   const dynamic_vino_lib::Result * getLocationResult(int idx) const override;
   /**
-   * @brief Show the observed detection result either through image window
-     or ROS topic.
+   * @brief Get the observed detection result, shown either through image window
+   * or ROS topic.
    */
-  void observeOutput(const std::shared_ptr<Outputs::BaseOutput> & output);
+  ResultView getResultView() const override;
   /**
    * @brief Get the name of the Inference instance.
    * @return The name of the Inference instance.
@@ -105,10 +105,13 @@ public:
   const std::string getName() const override;
   const std::vector<cv::Rect> getFilteredROIs(
     const std::string filter_conditions) const override;
+  const std::vector<Result> & getResults() const
+  {
+    return results_;
+  }
 
 private:
   std::shared_ptr<Models::LandmarksDetectionModel> valid_model_;
-  std::vector<Result> results_;
 };
 }  // namespace dynamic_vino_lib
 #endif  // DYNAMIC_VINO_LIB__INFERENCES__LANDMARKS_DETECTION_HPP_
@@ -51,7 +51,7 @@ private:
  * @class LicensePlateDetection
  * @brief Class to load license plate detection model and perform detection.
  */
-class LicensePlateDetection : public BaseInference
+class LicensePlateDetection : public SlotSelectingInference<LicensePlateDetectionResult>
 {
 public:
   using Result = dynamic_vino_lib::LicensePlateDetectionResult;
@@ -61,6 +61,11 @@ public:
    * @brief Load the license plate detection model.
    */
   void loadNetwork(std::shared_ptr<Models::LicensePlateDetectionModel>);
+  /**
+   * @brief Load the engine, the constant sequence input of each of its
+   * requests is filled once here.
+   */
+  void loadEngine(std::shared_ptr<Engines::Engine> engine) override;
   /**
    * @brief Enqueue a frame to this class.
    * The frame will be buffered but not infered yet.
@@ -70,10 +75,6 @@ public:
    * @return Whether this operation is successful.
    */
   bool enqueue(const cv::Mat &, const cv::Rect &) override;
-  /**
-   * @brief Set the sequence input blob
-   */
-  void fillSeqBlob();
   /**
    * @brief Start inference for all buffered frames.
    * @return Whether this operation is successful.
@@ -98,10 +99,10 @@ public:
    */
   const dynamic_vino_lib::Result * getLocationResult(int idx) const override;
   /**
-   * @brief Show the observed detection result either through image window
-     or ROS topic.
+   * @brief Get the observed detection result, shown either through image window
+   * or ROS topic.
    */
-  void observeOutput(const std::shared_ptr<Outputs::BaseOutput> & output);
+  ResultView getResultView() const override;
   /**
    * @brief Get the name of the Inference instance.
    * @return The name of the Inference instance.
@@ -111,8 +112,14 @@ public:
     const std::string filter_conditions) const override;
 
 private:
+  /**
+   * @brief Fill the sequence input blob of a request.
+   */
+  void fillSeqBlob(const InferenceEngine::Blob::Ptr & seq_blob);
+
   std::shared_ptr<Models::LicensePlateDetectionModel> valid_model_;
-  std::vector<Result> results_;
+  /**< strings the plates are decoded into, recycled from batch to batch >**/
+  std::vector<std::string> plates_;
   const std::vector<std::string> licenses_ = {
     "0", "1", "2", "3", "4", "5", "6", "7", "8", "9",
     "<Anhui>", "<Beijing>", "<Chongqing>", "<Fujian>",
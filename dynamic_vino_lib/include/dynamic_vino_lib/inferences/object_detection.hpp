@@ -23,14 +23,17 @@
 #include <object_msgs/msg/objects_in_boxes.hpp>
 #include <object_msgs/srv/detect_object.hpp>
 #include <rclcpp/rclcpp.hpp>
+#include <algorithm>
 #include <memory>
 #include <vector>
 #include <string>
 #include <map>
+#include <mutex>
 #include "dynamic_vino_lib/models/base_model.hpp"
 #include "dynamic_vino_lib/engines/engine.hpp"
 #include "dynamic_vino_lib/inferences/base_inference.hpp"
 #include "dynamic_vino_lib/inferences/base_filter.hpp"
+#include "dynamic_vino_lib/inferences/object_tracker.hpp"
 #include "inference_engine.hpp"
 #include "opencv2/opencv.hpp"
 // namespace
@@ -45,15 +48,33 @@ class ObjectDetectionResult : public Result
 public:
   friend class ObjectDetection;
   explicit ObjectDetectionResult(const cv::Rect & location);
-  std::string getLabel() const
+  const std::string & getLabel() const
   {
-    return label_;
+    return label_ != nullptr ? *label_ : own_label_;
   }
 
   void setLabel(const std::string & label)
   {
+    own_label_ = label;
+    label_ = nullptr;
+  }
+  /**
+   * @brief Refer to an entry of a label table outliving the result, instead
+   * of copying the label.
+   */
+  void setLabel(int label_id, const std::string * label)
+  {
+    label_id_ = label_id;
     label_ = label;
   }
+  /**
+   * @brief Get the id of the label in the label table of the model, -1 if
+   * the label was set as a string.
+   */
+  int getLabelId() const
+  {
+    return label_id_;
+  }
   /**
    * @brief Get the confidence that the detected area is a face.
    * @return The confidence value.
@@ -68,14 +89,151 @@ public:
     confidence_ = con;
   }
 
+  /**
+   * @brief Get the batch slot of the frame this result is detected in.
+   */
+  int getBatchIndex() const
+  {
+    return batch_index_;
+  }
+
+  void setBatchIndex(int batch_index)
+  {
+    batch_index_ = batch_index;
+  }
+  /**
+   * @brief Get the ID of the track the result belongs to, -1 if not tracked.
+   */
+  int getTrackId() const
+  {
+    return track_id_;
+  }
+
+  void setTrackId(int track_id)
+  {
+    track_id_ = track_id;
+  }
+  /**
+   * @brief Get the detection rounds the track of the result was matched in,
+   * -1 if not tracked.
+   */
+  int getTrackAge() const
+  {
+    return track_age_;
+  }
+
+  void setTrackAge(int track_age)
+  {
+    track_age_ = track_age;
+  }
+
   bool operator<(const ObjectDetectionResult & s2) const
   {
     return this->confidence_ > s2.confidence_;
   }
 
 private:
-  std::string label_ = "";
+  const std::string * label_ = nullptr;
+  std::string own_label_ = "";
+  int label_id_ = -1;
   float confidence_ = -1;
+  int batch_index_ = 0;
+  int track_id_ = -1;
+  int track_age_ = -1;
+};
+
+/**
+ * @class ObjectDetectionArena
+ * @brief Struct-of-arrays store of the detections fetched from one request.
+ * Labels are kept as ids into the label table of the model, and clear() keeps
+ * the capacity, so that decoding a steady stream of frames allocates nothing.
+ */
+class ObjectDetectionArena
+{
+public:
+  /**
+   * @brief Set the label table the label ids refer to, it must outlive the arena.
+   */
+  void setLabels(const std::vector<std::string> * labels)
+  {
+    labels_ = labels;
+  }
+
+  void clear()
+  {
+    locations_.clear();
+    confidences_.clear();
+    label_ids_.clear();
+    batch_indices_.clear();
+  }
+
+  void add(const cv::Rect & location, float confidence, int label_id, int batch_index = 0)
+  {
+    if (!hasLabel(label_id) && !unknown_labels_.count(label_id)) {
+      unknown_labels_[label_id] = "label #" + std::to_string(label_id);
+    }
+    locations_.push_back(location);
+    confidences_.push_back(confidence);
+    label_ids_.push_back(label_id);
+    batch_indices_.push_back(batch_index);
+  }
+
+  size_t size() const
+  {
+    return locations_.size();
+  }
+
+  const std::vector<cv::Rect> & getLocations() const
+  {
+    return locations_;
+  }
+
+  const std::vector<float> & getConfidences() const
+  {
+    return confidences_;
+  }
+
+  const std::vector<int> & getLabelIds() const
+  {
+    return label_ids_;
+  }
+
+  const std::vector<int> & getBatchIndices() const
+  {
+    return batch_indices_;
+  }
+  /**
+   * @brief Move a detection, e.g. from the region it is detected in to the frame.
+   */
+  void shift(size_t index, const cv::Point & offset)
+  {
+    locations_[index] += offset;
+  }
+  /**
+   * @brief Get the label of an id added to the arena, "label #<id>" for the
+   * ids missing in the label table.
+   */
+  const std::string & getLabel(int label_id) const
+  {
+    if (hasLabel(label_id)) {
+      return (*labels_)[label_id];
+    }
+    return unknown_labels_.at(label_id);
+  }
+
+private:
+  bool hasLabel(int label_id) const
+  {
+    return labels_ != nullptr && label_id >= 0 &&
+           label_id < static_cast<int>(labels_->size());
+  }
+
+  const std::vector<std::string> * labels_ = nullptr;
+  std::map<int, std::string> unknown_labels_;
+  std::vector<cv::Rect> locations_;
+  std::vector<float> confidences_;
+  std::vector<int> label_ids_;
+  std::vector<int> batch_indices_;
 };
 
 /**
@@ -94,7 +252,8 @@ public:
    */
   void init() override;
   /**
-   * @brief Set the object detection results into filter.
+   * @brief Set the object detection results into filter. The results are
+   * viewed, not copied, and must outlive the following getFilteredLocations.
    * @param[in] The object detection results.
    */
   void acceptResults(const std::vector<Result> & results);
@@ -103,6 +262,37 @@ public:
    * @return The filtered ROIs.
    */
   std::vector<cv::Rect> getFilteredLocations() override;
+  /**
+   * @brief Get the predicate of the filter conditions, compiled the first
+   * time the conditions are seen.
+   * @param[in] Filter conditions.
+   * @return The compiled predicate.
+   */
+  const Predicate<Result> & getPredicate(const std::string & filter_conditions);
+  /**
+   * @brief Get the locations of the results satisfying the filter conditions.
+   * @param[in] The results to filter, filter conditions.
+   * @param[out] The filtered locations, cleared first.
+   */
+  void getFilteredLocations(
+    const std::vector<Result> & results, const std::string & filter_conditions,
+    std::vector<cv::Rect> & locations);
+  /**
+   * @brief Get the track IDs of the results satisfying the filter conditions,
+   * in the order of getFilteredLocations.
+   * @param[out] The filtered track IDs, cleared first.
+   */
+  void getFilteredTrackIds(
+    const std::vector<Result> & results, const std::string & filter_conditions,
+    std::vector<int> & track_ids);
+  /**
+   * @brief Get the scores of the results satisfying the filter conditions,
+   * in the order of getFilteredLocations.
+   * @param[out] The filtered scores, cleared first.
+   */
+  void getFilteredScores(
+    const std::vector<Result> & results, const std::string & filter_conditions,
+    std::vector<RoiScore> & scores);
 
 private:
   /**
@@ -131,7 +321,10 @@ private:
 
   std::map<std::string, bool(*)
     (const Result &, const std::string &, const std::string &)> key_to_function_;
-  std::vector<Result> results_;
+  std::map<std::string, PredicateBuilder<Result>> key_to_builder_;
+  std::map<std::string, Predicate<Result>> predicates_;
+  std::mutex predicates_mutex_;
+  const std::vector<Result> * results_ = nullptr;
 };
 
 /**
@@ -178,10 +371,10 @@ public:
    */
   const Result * getLocationResult(int idx) const override;
   /**
-   * @brief Show the observed detection result either through image window
-     or ROS topic.
+   * @brief Get the observed detection result, shown either through image window
+   * or ROS topic.
    */
-  void observeOutput(const std::shared_ptr<Outputs::BaseOutput> & output);
+  ResultView getResultView() const override;
   /**
    * @brief Get the name of the Inference instance.
    * @return The name of the Inference instance.
@@ -190,16 +383,137 @@ public:
 
   const std::vector<cv::Rect> getFilteredROIs(
     const std::string filter_conditions) const override;
+
+  void compileFilterConditions(const std::string & filter_conditions) override;
+
+  void fillFilteredROIs(
+    const std::string & filter_conditions, std::vector<cv::Rect> & rois) const override;
+
+  bool isFrameBatchable() const override;
+  /**
+   * @brief Only expose the results detected in the given batch slots, or all
+   * of them when first is -1.
+   */
+  void selectBatchSlots(int first, int count) override;
+  /**
+   * @brief Track the detections of each input, the detector only runs every
+   * 'detect_interval' frames and the tracks are propagated in between.
+   * @param[in] iou_threshold The IoU from which a detection matches a track.
+   * @param[in] optical_flow Whether propagated tracks follow the optical flow.
+   */
+  void enableTracking(int detect_interval, float iou_threshold, bool optical_flow);
+  /**
+   * @brief Change the frames between two detections of a tracking inference,
+   * e.g. by the power governor. Called by the pipeline thread.
+   */
+  void setDetectInterval(int detect_interval)
+  {
+    detect_interval_ = std::max(1, detect_interval);
+  }
+  int getDetectInterval() const
+  {
+    return detect_interval_;
+  }
+  void trackResults(int input_id, const cv::Mat & frame) override;
+  bool propagateResults(int input_id, const cv::Mat & frame) override;
+  bool reuseResults(int input_id) override;
+  bool dependsOnFrameOrder() const override
+  {
+    return tracking_;
+  }
+  bool supportsFrameRegions() const override
+  {
+    return true;
+  }
+  /**
+   * @brief Detect in a region of a frame, the detections are moved back into
+   * the frame when fetched.
+   */
+  bool enqueueRegion(const cv::Mat & frame, const cv::Rect & region) override;
+  /**
+   * @brief With a model taking NV12 frames, and no tiling.
+   */
+  bool supportsNV12() const override;
+  bool enqueueNV12(const cv::Mat & nv12) override;
+  void fillFilteredTrackIds(
+    const std::string & filter_conditions, std::vector<int> & track_ids) const override;
+  void fillFilteredRoiScores(
+    const std::string & filter_conditions, std::vector<RoiScore> & scores) const override;
+  /**
+   * @brief Detect small objects on frames larger than the network input: a
+   * frame is enqueued as a whole plus overlapping tiles, all in the batch of
+   * one request, and the detections of the tiles are merged back.
+   * @param[in] tile_size The side of the tiles in pixels, grown if the tiles
+   * exceed the batch size.
+   * @param[in] overlap The fraction of a tile overlapping its neighbours.
+   * @param[in] nms_threshold The part of the smaller box from which two boxes
+   * of the same label detected in different tiles are merged.
+   */
+  void enableTiling(int tile_size, float overlap, float nms_threshold);
+  /**
+   * @brief Detections are only buffered at fetch time, so requests can overlap.
+   */
+  bool supportsConcurrentRequests() const override
+  {
+    return true;
+  }
   /**
    * @brief Calculate the IoU ratio for the given rectangles.
    * @return IoU Ratio of the given rectangles.
    */
   static double calcIoU(const cv::Rect & box_1, const cv::Rect & box_2);
+  /**
+   * @brief Get the detections of the last fetch (all batch slots) as arrays,
+   * for consumers which need no per-result objects.
+   */
+  const ObjectDetectionArena & getDetections() const
+  {
+    return detections_;
+  }
 
 private:
+  /**
+   * @brief Split a frame into the tiles of enableTiling.
+   * @return The tiles, none if the frame fits in one tile.
+   */
+  std::vector<cv::Rect> computeTiles(const cv::Size & frame_size) const;
+  /**
+   * @brief Enqueue a frame and its tiles into the slots of the bound request.
+   */
+  bool enqueueTiles(
+    const cv::Mat & frame, const cv::Rect & input_frame_loc, const std::vector<cv::Rect> & tiles);
+  /**
+   * @brief Move the detections of the tiles into the frame and suppress the
+   * duplicates found across tiles.
+   * @param[in] offsets The location of each batch slot in the frame.
+   */
+  void mergeTiles(const std::vector<cv::Point> & offsets);
+
   std::shared_ptr<Models::ObjectDetectionModel> valid_model_;
   std::shared_ptr<Filter> result_filter_;
+  ObjectDetectionArena detections_;
+  ObjectDetectionArena merged_detections_;
   std::vector<Result> results_;
+  std::vector<Result> batch_results_;
+  struct TrackedInput
+  {
+    ObjectTracker tracker;
+    uint64_t frames = 0;
+  };
+  bool tracking_ = false;
+  int detect_interval_ = 1;
+  float track_iou_ = 0.3;
+  bool optical_flow_ = false;
+  std::map<int, TrackedInput> tracked_inputs_;
+  /**< results of the last frame of each input >**/
+  std::map<int, std::vector<Result>> last_results_;
+  int tile_size_ = 0;
+  float tile_overlap_ = 0.2;
+  float tile_nms_threshold_ = 0.5;
+  /**< offset of each batch slot in the frame, per request, empty if not tiled >**/
+  std::vector<std::vector<cv::Point>> tile_offsets_;
+  /**< offset of the region enqueued in each batch slot, per request >**/
+  std::vector<std::vector<cv::Point>> region_offsets_;
   int width_ = 0;
   int height_ = 0;
   int max_proposal_count_;
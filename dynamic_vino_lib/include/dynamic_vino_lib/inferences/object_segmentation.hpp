@@ -22,6 +22,7 @@
 #include <object_msgs/msg/object_in_box.hpp>
 #include <object_msgs/msg/objects_in_boxes.hpp>
 #include <rclcpp/rclcpp.hpp>
+#include <map>
 #include <memory>
 #include <vector>
 #include <string>
@@ -54,15 +55,55 @@ public:
   {
     return confidence_;
   }
+  /**
+   * @brief Get the colored mask (CV_8UC3) at the resolution of the network
+   * output, empty when the inference only produces class ids. The mask is
+   * colorized on the first call.
+   */
   cv::Mat getMask() const
   {
-    return mask_;
+    return getMask(class_map_.size());
+  }
+  /**
+   * @brief Get the colored mask upsampled to the given size, e.g. the frame one.
+   */
+  cv::Mat getMask(const cv::Size & size) const;
+  /**
+   * @brief Get the class id of each pixel of the network output (CV_8UC1, or
+   * CV_16UC1 for more than 256 classes). For an instance, the crop of its box
+   * only, at the size of the box, 0 outside of the object.
+   */
+  cv::Mat getClassMap() const
+  {
+    return class_map_;
   }
+  /**
+   * @brief Whether the result is an instance of a Mask R-CNN-like model, whose
+   * class map is the crop of its box, rather than the classes of the frame.
+   */
+  bool isInstance() const
+  {
+    return instance_;
+  }
+  /**
+   * @brief Colorize a class map by a 256 entries CV_8UC3 palette, upsampled to
+   * the given size first. The pixels where 'confident' is zero are black.
+   */
+  static cv::Mat colorize(
+    const cv::Mat & class_map, const cv::Mat & confident, const cv::Mat & palette,
+    const cv::Size & size);
 
 private:
   std::string label_ = "";
   float confidence_ = -1;
-  cv::Mat mask_;
+  cv::Mat class_map_;
+  /**< non-zero where the class is confident enough to be colored, empty for all >**/
+  cv::Mat confident_;
+  /**< 256 entries CV_8UC3 lookup table, null when only class ids are produced >**/
+  std::shared_ptr<const cv::Mat> palette_;
+  /**< the last colored mask materialized >**/
+  mutable cv::Mat mask_;
+  bool instance_ = false;
 };
 /**
  * @class ObjectSegmentation
@@ -115,10 +156,10 @@ public:
    */
   const dynamic_vino_lib::Result * getLocationResult(int idx) const override;
   /**
-   * @brief Show the observed detection result either through image window
-     or ROS topic.
+   * @brief Get the observed detection result, shown either through image window
+   * or ROS topic.
    */
-  void observeOutput(const std::shared_ptr<Outputs::BaseOutput> & output);
+  ResultView getResultView() const override;
   /**
    * @brief Get the name of the Inference instance.
    * @return The name of the Inference instance.
@@ -126,12 +167,51 @@ public:
   const std::string getName() const override;
   const std::vector<cv::Rect> getFilteredROIs(
     const std::string filter_conditions) const override;
+  /**
+   * @brief Keep the fetched masks of the input, reused by reuseResults.
+   */
+  void trackResults(int input_id, const cv::Mat & frame) override;
+  bool reuseResults(int input_id) override;
+  /**
+   * @brief Whether the colored mask is produced besides the class id map,
+   * true by default.
+   */
+  void setColorizeMask(bool colorize)
+  {
+    colorize_mask_ = colorize;
+  }
+  /**
+   * @brief Compute the class of each pixel from the channel-major scores of
+   * the network output; a single channel holds the classes already.
+   * @param[in] type CV_8U, or CV_16U for more than 256 classes.
+   * @param[out] max_prob The score of the class of each pixel, empty for a single channel.
+   */
+  static void argmax(
+    const float * scores, int channels, int height, int width, int type,
+    cv::Mat & class_map, cv::Mat & max_prob);
 
 private:
+  /**
+   * @brief Add a result per instance above the threshold of a Mask R-CNN-like
+   * output, with the mask of its class resized and thresholded into its box only.
+   */
+  void fetchInstances(
+    const Engines::OutputBinding & detections, const Engines::OutputBinding & masks);
+  /**
+   * @brief Extend the colors to one per possible class id of a CV_8U map and
+   * build the lookup table colorizing it.
+   */
+  void buildPalette();
+
   std::shared_ptr<Models::ObjectSegmentationModel> valid_model_;
   std::vector<Result> results_;
+  /**< by input, the results of its last inferred frame, sharing their masks >**/
+  std::map<int, std::vector<Result>> last_results_;
   int width_ = 0;
   int height_ = 0;
+  /**< the size and location of the last enqueued frame >**/
+  cv::Size frame_size_;
+  cv::Rect frame_loc_;
   double show_output_thresh_ = 0;
 
   std::vector<cv::Vec3b> colors_ = {
@@ -141,6 +221,9 @@ private:
     {100, 60, 0}, {90, 0, 0}, {230, 0, 0}, {32, 11, 119}, {0, 74, 111},
     {81, 0, 81}
   };
+  /**< colors_ as a 256 entries CV_8UC3 lookup table >**/
+  std::shared_ptr<const cv::Mat> palette_;
+  bool colorize_mask_ = true;
 };
 }  // namespace dynamic_vino_lib
 #endif  // DYNAMIC_VINO_LIB__INFERENCES__OBJECT_SEGMENTATION_HPP_
@@ -0,0 +1,99 @@
+// Copyright (c) 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @brief A header file with declaration for ObjectTracker Class
+ * @file object_tracker.hpp
+ */
+#ifndef DYNAMIC_VINO_LIB__INFERENCES__OBJECT_TRACKER_HPP_
+#define DYNAMIC_VINO_LIB__INFERENCES__OBJECT_TRACKER_HPP_
+#include <vector>
+#include "opencv2/opencv.hpp"
+
+namespace dynamic_vino_lib
+{
+/**
+ * @class ObjectTracker
+ * @brief SORT-style multi-object tracker of the detections of one input: each
+ * track is a constant velocity Kalman filter over its box, associated with the
+ * detections by IoU. Between two detections the tracks are propagated by their
+ * filter, and optionally corrected by the optical flow inside their box.
+ */
+class ObjectTracker
+{
+public:
+  struct Track
+  {
+    int id;
+    int label_id;
+    float confidence;
+    cv::Rect box;
+    /**< detection rounds since the track was last matched >**/
+    int misses = 0;
+    /**< detection rounds the track was matched in >**/
+    int age = 1;
+    cv::KalmanFilter filter;
+  };
+
+  /**
+   * @param[in] iou_threshold The IoU from which a detection matches a track.
+   * @param[in] max_age The detection rounds a track survives unmatched.
+   * @param[in] optical_flow Whether propagated boxes follow the optical flow.
+   */
+  ObjectTracker(float iou_threshold = 0.3, int max_age = 2, bool optical_flow = false);
+  /**
+   * @brief Match the detections of a frame with the tracks, tracks are created
+   * for the detections left unmatched.
+   * @param[in] frame The BGR frame, or its gray plane, for the optical flow.
+   * @param[out] track_ages If not null, the age of the track of each detection.
+   * @return The track ID of each detection.
+   */
+  std::vector<int> update(
+    const std::vector<cv::Rect> & boxes, const std::vector<int> & label_ids,
+    const std::vector<float> & confidences, const cv::Mat & frame,
+    std::vector<int> * track_ages = nullptr);
+  /**
+   * @brief Propagate the tracks to a frame without detections.
+   */
+  void predict(const cv::Mat & frame);
+  /**
+   * @brief Get the tracks matched at the last detection round, at their
+   * current location.
+   */
+  std::vector<const Track *> getActiveTracks() const;
+
+private:
+  void initFilter(Track & track) const;
+  static cv::Rect toRect(const cv::Mat & state);
+  static cv::Mat toMeasurement(const cv::Rect & box);
+  static float calcIoU(const cv::Rect & a, const cv::Rect & b);
+  /**
+   * @brief Copy a gray frame, e.g. the Y plane of an NV12 one, convert a BGR one.
+   */
+  static void toGray(const cv::Mat & frame, cv::Mat & gray);
+  /**
+   * @brief Shift the box of each active track by the median optical flow of
+   * the corners found inside it.
+   */
+  void followFlow(const cv::Mat & gray);
+
+  float iou_threshold_;
+  int max_age_;
+  bool optical_flow_;
+  int next_id_ = 0;
+  std::vector<Track> tracks_;
+  cv::Mat prev_gray_;
+};
+}  // namespace dynamic_vino_lib
+#endif  // DYNAMIC_VINO_LIB__INFERENCES__OBJECT_TRACKER_HPP_
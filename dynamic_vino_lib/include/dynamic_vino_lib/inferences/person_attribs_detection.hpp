@@ -68,7 +68,7 @@ private:
  * @class PersonAttribsDetection
  * @brief Class to load person attributes detection model and perform person attributes detection.
  */
-class PersonAttribsDetection : public BaseInference
+class PersonAttribsDetection : public SlotSelectingInference<PersonAttribsDetectionResult>
 {
 public:
   using Result = dynamic_vino_lib::PersonAttribsDetectionResult;
@@ -111,10 +111,15 @@ public:
    */
   const dynamic_vino_lib::Result * getLocationResult(int idx) const override;
   /**
-   * @brief Show the observed detection result either through image window
-     or ROS topic.
+   * @brief Get the observed detection result, shown either through image window
+   * or ROS topic.
    */
-  void observeOutput(const std::shared_ptr<Outputs::BaseOutput> & output);
+  ResultView getResultView() const override;
+  void loadCachedResults(
+    const std::vector<cv::Rect> & rois, const std::vector<int64_t> & track_keys,
+    std::vector<size_t> & stale, bool any_age) override;
+  ResultView getCachedResultView() const override;
+  void cacheResults(const std::vector<int64_t> & track_keys) override;
   /**
    * @brief Get the name of the Inference instance.
    * @return The name of the Inference instance.
@@ -125,7 +130,8 @@ public:
 
 private:
   std::shared_ptr<Models::PersonAttribsDetectionModel> valid_model_;
-  std::vector<Result> results_;
+  std::vector<Result> cached_results_;
+  ResultCache<Result> cache_;
   double attribs_confidence_;
   const std::vector<std::string> net_attributes_ = {
     "is male", 
@@ -49,16 +49,43 @@ private:
  * @class PersonReidentification
  * @brief Class to load face detection model and perform face detection.
  */
-class PersonReidentification : public BaseInference
+class PersonReidentification : public SlotSelectingInference<PersonReidentificationResult>
 {
 public:
   using Result = dynamic_vino_lib::PersonReidentificationResult;
-  explicit PersonReidentification(double);
+  /**
+   * @param[in] match_thresh The similarity from which a person matches a track.
+   * @param[in] gallery_index The index of the recorded tracks, exact if null.
+   * @param[in] gallery_size The maximum number of recorded tracks.
+   * @param[in] shared_gallery The name of the tracker shared with the other inferences
+   * of the process, a private one if empty.
+   */
+  explicit PersonReidentification(
+    double match_thresh, std::shared_ptr<GalleryIndex> gallery_index = nullptr,
+    int gallery_size = 1000, const std::string & shared_gallery = "");
   ~PersonReidentification() override;
   /**
    * @brief Load the face detection model.
    */
   void loadNetwork(std::shared_ptr<Models::PersonReidentificationModel>);
+  /**
+   * @brief Get the tracker recording the persons.
+   */
+  std::shared_ptr<dynamic_vino_lib::Tracker> getTracker() const
+  {
+    return person_tracker_;
+  }
+  size_t getGalleryBytes() override
+  {
+    return person_tracker_ == nullptr ? 0 : person_tracker_->getMemoryBytes();
+  }
+  /**
+   * @brief The IDs are given by the gallery as the frames come.
+   */
+  bool dependsOnFrameOrder() const override
+  {
+    return true;
+  }
   /**
    * @brief Enqueue a frame to this class.
    * The frame will be buffered but not infered yet.
@@ -92,10 +119,10 @@ public:
    */
   const dynamic_vino_lib::Result * getLocationResult(int idx) const override;
   /**
-   * @brief Show the observed detection result either through image window
-     or ROS topic.
+   * @brief Get the observed detection result, shown either through image window
+   * or ROS topic.
    */
-  void observeOutput(const std::shared_ptr<Outputs::BaseOutput> & output);
+  ResultView getResultView() const override;
   /**
    * @brief Get the name of the Inference instance.
    * @return The name of the Inference instance.
@@ -106,7 +133,6 @@ public:
 
 private:
   std::shared_ptr<Models::PersonReidentificationModel> valid_model_;
-  std::vector<Result> results_;
   std::shared_ptr<dynamic_vino_lib::Tracker> person_tracker_;
 };
 }  // namespace dynamic_vino_lib
@@ -0,0 +1,153 @@
+// Copyright (c) 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @brief A header file with declaration for ResultCache Class
+ * @file result_cache.hpp
+ */
+#ifndef DYNAMIC_VINO_LIB__INFERENCES__RESULT_CACHE_HPP_
+#define DYNAMIC_VINO_LIB__INFERENCES__RESULT_CACHE_HPP_
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <unordered_map>
+#include <vector>
+#include "opencv2/opencv.hpp"
+
+namespace dynamic_vino_lib
+{
+/**
+ * @brief When the cached result of a track is inferred again.
+ */
+struct ResultCachePolicy
+{
+  /**< a track is inferred once every that many frames, the cache is off below 2 >**/
+  int refresh_interval = 0;
+  /**< refresh when the IoU of the ROI with the inferred one falls below >**/
+  float min_iou = 0.5;
+  /**< refresh the results less confident than this >**/
+  float min_confidence = 0;
+  /**< reuse the results whatever their age, e.g. on the frames the inference doesn't run >**/
+  bool any_age = false;
+};
+
+/**
+ * @brief Build the key of a track in a ResultCache, track IDs are only unique
+ * within one input.
+ * @return The key, -1 for an untracked ROI.
+ */
+inline int64_t makeTrackKey(int input_id, int track_id)
+{
+  if (track_id < 0) {
+    return -1;
+  }
+  return (static_cast<int64_t>(input_id) << 32) | static_cast<uint32_t>(track_id);
+}
+
+/**
+ * @class ResultCache
+ * @brief The last inferred result of each tracked ROI, so that second-stage
+ * inferences only run on the tracks whose result is stale.
+ */
+template<typename T>
+class ResultCache
+{
+public:
+  /**
+   * @brief Split the ROIs of a frame by whether their track has a fresh result.
+   * @param[in] rois The ROIs routed to the inference.
+   * @param[in] track_keys The track key of each ROI, -1 (or missing) if untracked.
+   * @param[out] cached The fresh results, moved to their current ROI.
+   * @param[out] stale The indexes of the ROIs to infer.
+   */
+  void load(
+    const ResultCachePolicy & policy, const std::vector<cv::Rect> & rois,
+    const std::vector<int64_t> & track_keys, std::vector<T> & cached,
+    std::vector<size_t> & stale)
+  {
+    frame_++;
+    cached.clear();
+    stale.clear();
+    for (size_t i = 0; i < rois.size(); i++) {
+      auto iter = i < track_keys.size() ? entries_.find(track_keys[i]) : entries_.end();
+      if (iter == entries_.end() || !isFresh(policy, iter->second, rois[i])) {
+        stale.push_back(i);
+        continue;
+      }
+      auto & entry = iter->second;
+      entry.reuses++;
+      entry.last_seen = frame_;
+      cached.push_back(entry.result);
+      cached.back().setLocation(rois[i]);
+    }
+    // forget the tracks which have not been seen for a while
+    int idle = std::max(policy.refresh_interval, 1) * 4;
+    if (frame_ % idle == 0) {
+      for (auto iter = entries_.begin(); iter != entries_.end(); ) {
+        iter = frame_ - iter->second.last_seen > static_cast<uint64_t>(idle) ?
+          entries_.erase(iter) : std::next(iter);
+      }
+    }
+  }
+  /**
+   * @brief Record the inferred result of a track.
+   */
+  void store(int64_t track_key, const T & result, float confidence)
+  {
+    if (track_key < 0) {
+      return;
+    }
+    Entry entry{result, result.getLocation(), confidence, 0, frame_};
+    auto iter = entries_.find(track_key);
+    if (iter == entries_.end()) {
+      entries_.emplace(track_key, entry);
+    } else {
+      iter->second = entry;
+    }
+  }
+
+  void clear()
+  {
+    entries_.clear();
+  }
+
+private:
+  struct Entry
+  {
+    T result;
+    cv::Rect roi;
+    float confidence;
+    int reuses;
+    uint64_t last_seen;
+  };
+
+  static bool isFresh(
+    const ResultCachePolicy & policy, const Entry & entry, const cv::Rect & roi)
+  {
+    if (policy.any_age) {
+      return true;
+    }
+    if (entry.reuses + 1 >= policy.refresh_interval || entry.confidence < policy.min_confidence) {
+      return false;
+    }
+    float intersection = static_cast<float>((entry.roi & roi).area());
+    float union_area = entry.roi.area() + roi.area() - intersection;
+    return union_area > 0 && intersection / union_area >= policy.min_iou;
+  }
+
+  std::unordered_map<int64_t, Entry> entries_;
+  uint64_t frame_ = 0;
+};
+}  // namespace dynamic_vino_lib
+#endif  // DYNAMIC_VINO_LIB__INFERENCES__RESULT_CACHE_HPP_
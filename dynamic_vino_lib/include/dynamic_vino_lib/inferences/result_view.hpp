@@ -0,0 +1,113 @@
+// Copyright (c) 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @brief A header file with declaration for ResultView Class
+ * @file result_view.hpp
+ */
+#ifndef DYNAMIC_VINO_LIB__INFERENCES__RESULT_VIEW_HPP_
+#define DYNAMIC_VINO_LIB__INFERENCES__RESULT_VIEW_HPP_
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace Outputs
+{
+class BaseOutput;
+}
+
+namespace dynamic_vino_lib
+{
+/**
+ * @class ResultView
+ * @brief A read-only, type-erased view of the results an inference published
+ * for a frame, handed as is to all its outputs. It borrows the results of the
+ * inference while they are routed: an output keeping them longer (e.g. for a
+ * worker) shares a snapshot of them, taken once for all such outputs.
+ */
+class ResultView
+{
+public:
+  ResultView() = default;
+  template<typename T>
+  explicit ResultView(const std::vector<T> & results)
+  : results_(&results), size_(results.size()),
+    deliver_(&deliverAs<T, Outputs::BaseOutput>), copy_(&copyAs<T>) {}
+
+  bool isValid() const
+  {
+    return deliver_ != nullptr;
+  }
+  size_t size() const
+  {
+    return size_;
+  }
+  /**
+   * @brief The frames since the results were inferred, 0 for the results of
+   * the frame, e.g. above 0 for an inference running on a part of the frames.
+   */
+  int getAge() const
+  {
+    return age_;
+  }
+  void setAge(int age)
+  {
+    age_ = age;
+  }
+  /**
+   * @brief Hand the results to an output as their type, through the accept
+   * overload of the output for it.
+   */
+  void deliver(Outputs::BaseOutput & output) const
+  {
+    if (deliver_ != nullptr) {
+      deliver_(results_, output);
+    }
+  }
+  /**
+   * @brief Get a view owning its results, valid once the inference moved on.
+   * The results are copied the first time only.
+   */
+  ResultView share() const
+  {
+    if (deliver_ != nullptr && snapshot_ == nullptr) {
+      snapshot_ = copy_(results_);
+    }
+    ResultView shared = *this;
+    shared.results_ = snapshot_.get();
+    return shared;
+  }
+
+private:
+  template<typename T, typename Output>
+  static void deliverAs(const void * results, Output & output)
+  {
+    output.accept(*static_cast<const std::vector<T> *>(results));
+  }
+  template<typename T>
+  static std::shared_ptr<const void> copyAs(const void * results)
+  {
+    return std::make_shared<const std::vector<T>>(*static_cast<const std::vector<T> *>(results));
+  }
+
+  const void * results_ = nullptr;
+  size_t size_ = 0;
+  int age_ = 0;
+  void (* deliver_)(const void *, Outputs::BaseOutput &) = nullptr;
+  std::shared_ptr<const void> (* copy_)(const void *) = nullptr;
+  /**< the results owned, once shared >**/
+  mutable std::shared_ptr<const void> snapshot_;
+};
+}  // namespace dynamic_vino_lib
+#endif  // DYNAMIC_VINO_LIB__INFERENCES__RESULT_VIEW_HPP_
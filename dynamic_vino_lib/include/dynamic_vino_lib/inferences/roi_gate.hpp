@@ -0,0 +1,124 @@
+// Copyright (c) 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @brief A header file with declaration for the ROI gate of an inference
+ * @file roi_gate.hpp
+ */
+#ifndef DYNAMIC_VINO_LIB__INFERENCES__ROI_GATE_HPP_
+#define DYNAMIC_VINO_LIB__INFERENCES__ROI_GATE_HPP_
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include "opencv2/opencv.hpp"
+
+namespace dynamic_vino_lib
+{
+/**
+ * @brief What the upstream inference knows of a ROI it routes.
+ */
+struct RoiScore
+{
+  /**< confidence of the detection, -1 if unknown >**/
+  float confidence = -1;
+  /**< detection rounds the track of the ROI was matched in, -1 if untracked >**/
+  int track_age = -1;
+};
+
+/**
+ * @brief Which of the ROIs routed to an inference are worth inferring.
+ */
+struct RoiGatePolicy
+{
+  /**< smallest ROI area in pixels >**/
+  int min_area = 0;
+  /**< bounds of the width / height ratio, 0 for no bound >**/
+  float min_aspect = 0;
+  float max_aspect = 0;
+  float min_confidence = 0;
+  int min_track_age = 0;
+  /**< ROIs inferred at most per frame, 0 for no budget >**/
+  int max_rois = 0;
+  /**< the ROIs kept within the budget are the most confident, otherwise the largest >**/
+  bool by_confidence = false;
+
+  bool isEnabled() const
+  {
+    return min_area > 0 || min_aspect > 0 || max_aspect > 0 || min_confidence > 0 ||
+           min_track_age > 0 || max_rois > 0;
+  }
+};
+
+/**
+ * @brief Drop the ROIs failing the policy, and the least valuable ones beyond
+ * the budget, keeping the order of the others.
+ * @param[in,out] rois The ROIs routed to the inference.
+ * @param[in] scores The score of each ROI, the unknown scores pass.
+ * @param[in,out] track_keys The track key of each ROI, left as is if missing.
+ */
+inline void applyRoiGate(
+  const RoiGatePolicy & policy, std::vector<cv::Rect> & rois,
+  const std::vector<RoiScore> & scores, std::vector<int64_t> & track_keys)
+{
+  std::vector<size_t> kept;
+  kept.reserve(rois.size());
+  for (size_t i = 0; i < rois.size(); i++) {
+    const cv::Rect & roi = rois[i];
+    if (roi.area() < policy.min_area || roi.height <= 0) {
+      continue;
+    }
+    float aspect = static_cast<float>(roi.width) / roi.height;
+    if ((policy.min_aspect > 0 && aspect < policy.min_aspect) ||
+      (policy.max_aspect > 0 && aspect > policy.max_aspect))
+    {
+      continue;
+    }
+    if (i < scores.size()) {
+      const RoiScore & score = scores[i];
+      if ((score.confidence >= 0 && score.confidence < policy.min_confidence) ||
+        (score.track_age >= 0 && score.track_age < policy.min_track_age))
+      {
+        continue;
+      }
+    }
+    kept.push_back(i);
+  }
+
+  if (policy.max_rois > 0 && kept.size() > static_cast<size_t>(policy.max_rois)) {
+    auto value = [&policy, &rois, &scores](size_t i) -> float {
+        if (policy.by_confidence && i < scores.size()) {
+          return scores[i].confidence;
+        }
+        return static_cast<float>(rois[i].area());
+      };
+    std::stable_sort(kept.begin(), kept.end(),
+      [&value](size_t a, size_t b) {return value(a) > value(b);});
+    kept.resize(policy.max_rois);
+    std::sort(kept.begin(), kept.end());
+  }
+
+  bool keyed = track_keys.size() == rois.size();
+  for (size_t k = 0; k < kept.size(); k++) {
+    rois[k] = rois[kept[k]];
+    if (keyed) {
+      track_keys[k] = track_keys[kept[k]];
+    }
+  }
+  rois.resize(kept.size());
+  if (keyed) {
+    track_keys.resize(kept.size());
+  }
+}
+}  // namespace dynamic_vino_lib
+#endif  // DYNAMIC_VINO_LIB__INFERENCES__ROI_GATE_HPP_
@@ -0,0 +1,75 @@
+// Copyright (c) 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @brief A header file with declaration for the ROI merging of an inference
+ * @file roi_merge.hpp
+ */
+#ifndef DYNAMIC_VINO_LIB__INFERENCES__ROI_MERGE_HPP_
+#define DYNAMIC_VINO_LIB__INFERENCES__ROI_MERGE_HPP_
+#include <algorithm>
+#include "opencv2/opencv.hpp"
+
+namespace dynamic_vino_lib
+{
+/**
+ * @brief How the ROIs routed to an inference by all its parents are fitted
+ * into the frame and merged, so that each distinct region is inferred once.
+ */
+struct RoiMergePolicy
+{
+  /**< IoU above which a ROI already routed for the frame is not inferred again, 0 for none >**/
+  float iou = 0;
+  /**< fraction of its size a ROI is enlarged by on each side >**/
+  float padding = 0;
+  /**< a ROI crossing the frame edge is shifted inside instead of being clipped >**/
+  bool shift = false;
+
+  bool isEnabled() const
+  {
+    return iou > 0 || isFitting();
+  }
+  bool isFitting() const
+  {
+    return padding > 0 || shift;
+  }
+};
+
+/**
+ * @brief Pad a ROI and fit it into the frame, shifted inside if the policy
+ * says so and it is not larger than the frame, clipped otherwise.
+ */
+inline cv::Rect fitRoi(const RoiMergePolicy & policy, const cv::Rect & roi, const cv::Rect & frame)
+{
+  cv::Rect fitted = roi;
+  if (policy.padding > 0) {
+    int dx = cvRound(roi.width * policy.padding);
+    int dy = cvRound(roi.height * policy.padding);
+    fitted = cv::Rect(roi.x - dx, roi.y - dy, roi.width + 2 * dx, roi.height + 2 * dy);
+  }
+  if (policy.shift && fitted.width <= frame.width && fitted.height <= frame.height) {
+    fitted.x = std::min(std::max(fitted.x, frame.x), frame.x + frame.width - fitted.width);
+    fitted.y = std::min(std::max(fitted.y, frame.y), frame.y + frame.height - fitted.height);
+  }
+  return fitted & frame;
+}
+
+inline float calcRoiIoU(const cv::Rect & a, const cv::Rect & b)
+{
+  int inter = (a & b).area();
+  int uni = a.area() + b.area() - inter;
+  return uni > 0 ? static_cast<float>(inter) / uni : 0;
+}
+}  // namespace dynamic_vino_lib
+#endif  // DYNAMIC_VINO_LIB__INFERENCES__ROI_MERGE_HPP_
@@ -56,7 +56,7 @@ private:
  * @class VehicleAttribsDetection
  * @brief Class to load vehicle attributes detection model and perform detection.
  */
-class VehicleAttribsDetection : public BaseInference
+class VehicleAttribsDetection : public SlotSelectingInference<VehicleAttribsDetectionResult>
 {
 public:
   using Result = dynamic_vino_lib::VehicleAttribsDetectionResult;
@@ -99,10 +99,15 @@ public:
    */
   const dynamic_vino_lib::Result * getLocationResult(int idx) const override;
   /**
-   * @brief Show the observed detection result either through image window
-     or ROS topic.
+   * @brief Get the observed detection result, shown either through image window
+   * or ROS topic.
    */
-  void observeOutput(const std::shared_ptr<Outputs::BaseOutput> & output);
+  ResultView getResultView() const override;
+  void loadCachedResults(
+    const std::vector<cv::Rect> & rois, const std::vector<int64_t> & track_keys,
+    std::vector<size_t> & stale, bool any_age) override;
+  ResultView getCachedResultView() const override;
+  void cacheResults(const std::vector<int64_t> & track_keys) override;
   /**
    * @brief Get the name of the Inference instance.
    * @return The name of the Inference instance.
@@ -113,7 +118,8 @@ public:
 
 private:
   std::shared_ptr<Models::VehicleAttribsDetectionModel> valid_model_;
-  std::vector<Result> results_;
+  std::vector<Result> cached_results_;
+  ResultCache<Result> cache_;
   const std::vector<std::string> types_ = {
     "car", "van", "truck", "bus"};
   const std::vector<std::string> colors_ = {
@@ -23,8 +23,11 @@
 #include <opencv2/opencv.hpp>
 #include <opencv2/highgui/highgui_c.h>
 #include <opencv2/videoio/videoio_c.h>
+#include <chrono>
+#include <memory>
 #include <vector>
 #include <string>
+#include <utility>
 #include "dynamic_vino_lib/inputs/ros2_handler.hpp"
 
 /**
@@ -40,6 +43,44 @@ struct Config
   std::string path;
 };
 
+/**
+ * @class DepthLookup
+ * @brief The depth of a frame, looked up in the regions of its results only.
+ */
+class DepthLookup
+{
+public:
+  virtual ~DepthLookup() = default;
+  /**
+   * @brief Get the 3D centroid of a region of the frame, in meters in the
+   * frame of the color camera.
+   * @return False if the region has no valid depth.
+   */
+  virtual bool locate(const cv::Rect & roi, cv::Point3f * position) const = 0;
+};
+
+/**
+ * @class ScaledDepthLookup
+ * @brief The depth of a frame downscaled after it was read, looked up in the
+ * regions of the native frame.
+ */
+class ScaledDepthLookup : public DepthLookup
+{
+public:
+  ScaledDepthLookup(std::shared_ptr<DepthLookup> depth, float scale)
+  : depth_(std::move(depth)), scale_(scale) {}
+  bool locate(const cv::Rect & roi, cv::Point3f * position) const override
+  {
+    cv::Rect native(cvRound(roi.x * scale_), cvRound(roi.y * scale_),
+      cvRound(roi.width * scale_), cvRound(roi.height * scale_));
+    return depth_->locate(native, position);
+  }
+
+private:
+  std::shared_ptr<DepthLookup> depth_;
+  float scale_;
+};
+
 class BaseInputDevice : public Ros2Handler
 {
 public:
@@ -60,6 +101,63 @@ public:
    * @return Whether the next frame is successfully read.
    */
   virtual bool read(cv::Mat * frame) = 0;
+  /**
+   * @brief Block until a new frame can be read, or the timeout expires.
+   * Devices whose read() already blocks on the hardware return immediately.
+   * @param[in] timeout The maximum time to wait.
+   * @return Whether a new frame is available.
+   */
+  virtual bool waitForFrame(const std::chrono::milliseconds & timeout)
+  {
+    return true;
+  }
+  /**
+   * @brief Get the number of frames the device dropped itself, e.g. the stale
+   * frames of a live stream skipped to keep up with it.
+   */
+  virtual uint64_t getDroppedFrames()
+  {
+    return 0;
+  }
+  /**
+   * @brief Get the number of frames read more than one frame interval after
+   * the device received them.
+   */
+  virtual uint64_t getLateFrames()
+  {
+    return 0;
+  }
+  /**
+   * @brief Whether a finite input (e.g. a set of files) has delivered all its
+   * frames. The pipeline stops once all its inputs are exhausted.
+   */
+  virtual bool isExhausted()
+  {
+    return false;
+  }
+  /**
+   * @brief Whether read() gives NV12 frames (see utils/nv12.hpp) instead of
+   * BGR, which the first-stage detections can take without converting them.
+   */
+  virtual bool isNV12() const
+  {
+    return false;
+  }
+  /**
+   * @brief Get the number of frames read per pipeline iteration. The pipeline
+   * reads the device as so many inputs, whose frames share the first-stage batch.
+   */
+  virtual size_t getLanes() const
+  {
+    return 1;
+  }
+  /**
+   * @brief Get the depth of the frame last read, nullptr if the device has none.
+   */
+  virtual std::shared_ptr<DepthLookup> getDepth()
+  {
+    return nullptr;
+  }
   virtual bool readService(cv::Mat * frame, std::string config_path)
   {
     return true;
@@ -0,0 +1,94 @@
+// Copyright (c) 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @brief A header file with declaration for FrameReplay class
+ * @file frame_replay.hpp
+ */
+#ifndef DYNAMIC_VINO_LIB__INPUTS__FRAME_REPLAY_HPP_
+#define DYNAMIC_VINO_LIB__INPUTS__FRAME_REPLAY_HPP_
+
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "dynamic_vino_lib/inputs/base_input.hpp"
+
+namespace Input
+{
+/**
+ * @class FrameReplay
+ * @brief Class replaying frames preloaded into memory, from a video file or
+ * a set of images, so that the measurements of a pipeline do not include
+ * decoding. The frames are delivered on a fixed schedule, optionally with a
+ * jitter drawn from a seeded generator, identical from one run to the next.
+ */
+class FrameReplay : public BaseInputDevice
+{
+public:
+  /**
+   * @param[in] meta The video file, image directory or glob pattern, optionally
+   * followed by options, e.g. "/data/video.mp4,frames=300,fps=30,jitter_ms=2,loops=4".
+   */
+  explicit FrameReplay(const std::string & meta);
+  /**
+   * @brief Decode the frames into memory.
+   * @return Whether at least one frame is decoded.
+   */
+  bool initialize() override;
+  /**
+   * @brief Decode the frames into memory, resized to the given width and height.
+   */
+  bool initialize(size_t width, size_t height) override;
+  /**
+   * @brief Copy the next frame once it is due.
+   * @return False once all the loops are replayed.
+   */
+  bool read(cv::Mat * frame) override;
+  /**
+   * @brief Block until the next frame is due.
+   */
+  bool waitForFrame(const std::chrono::milliseconds & timeout) override;
+  bool isExhausted() override;
+  /**
+   * @brief Get the number of frames read more than one frame interval after
+   * they were due.
+   */
+  uint64_t getLateFrames() override
+  {
+    return late_frames_;
+  }
+
+private:
+  bool load(const cv::Size & size);
+  std::chrono::steady_clock::time_point getDueTime(uint64_t index) const;
+
+  std::string source_;
+  size_t max_frames_ = 100;
+  double fps_ = 0;  // 0 replays as fast as the frames are read
+  double jitter_ms_ = 0;
+  size_t loops_ = 1;  // 0 replays forever
+  unsigned seed_ = 0;
+
+  std::vector<cv::Mat> frames_;
+  /**< the jitter of each frame, in microseconds >**/
+  std::vector<int64_t> jitters_;
+  std::atomic<uint64_t> next_{0};
+  std::chrono::steady_clock::time_point start_;
+  std::atomic<uint64_t> late_frames_{0};
+};
+}  // namespace Input
+
+#endif  // DYNAMIC_VINO_LIB__INPUTS__FRAME_REPLAY_HPP_
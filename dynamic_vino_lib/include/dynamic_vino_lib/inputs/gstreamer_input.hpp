@@ -0,0 +1,93 @@
+// Copyright (c) 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @brief A header file with declaration for GStreamerInput class
+ * @file gstreamer_input.hpp
+ */
+#ifndef DYNAMIC_VINO_LIB__INPUTS__GSTREAMER_INPUT_HPP_
+#define DYNAMIC_VINO_LIB__INPUTS__GSTREAMER_INPUT_HPP_
+
+#include <gst/app/gstappsink.h>
+#include <gst/gst.h>
+#include <gst/video/video.h>
+#include <opencv2/opencv.hpp>
+#include <string>
+#include "dynamic_vino_lib/inputs/base_input.hpp"
+
+namespace Input
+{
+/**
+ * @class GStreamerInput
+ * @brief Class for recieving the frames of a GStreamer pipeline, given as a
+ * launch string ending in an appsink. The frames wrap the mapped buffers of
+ * the samples without copying them, each sample is held until the last copy
+ * of its frame is released. BGR and NV12 samples are taken.
+ */
+class GStreamerInput : public BaseInputDevice
+{
+public:
+  /**
+   * @param[in] launch The launch string, e.g. "filesrc location=a.mp4 !
+   * decodebin ! vaapipostproc format=nv12 ! appsink name=sink". Without an
+   * appsink one is appended, an appsink of the string must be named "sink".
+   */
+  explicit GStreamerInput(const std::string & launch);
+  ~GStreamerInput() override;
+  /**
+   * @brief Start the pipeline, the frame size is the one of its first sample.
+   * @return Whether a first sample is received within 5 seconds.
+   */
+  bool initialize() override;
+  /**
+   * @brief The size is set by the caps of the launch string, not by the input.
+   */
+  bool initialize(size_t width, size_t height) override
+  {
+    return initialize();
+  }
+  /**
+   * @brief Take the next sample of the appsink, blocking until it arrives.
+   * @return False at the end of the stream, or on an error of the pipeline.
+   */
+  bool read(cv::Mat * frame) override;
+  bool waitForFrame(const std::chrono::milliseconds & timeout) override;
+  bool isExhausted() override;
+  bool isNV12() const override
+  {
+    return nv12_;
+  }
+
+private:
+  /**
+   * @brief Wrap the buffer of a sample into a frame, taking the reference of the sample.
+   */
+  bool wrapSample(GstSample * sample, cv::Mat * frame);
+  /**
+   * @brief Log the errors posted by the elements of the pipeline.
+   * @return Whether the pipeline failed.
+   */
+  bool checkBus();
+
+  std::string launch_;
+  GstElement * pipeline_ = nullptr;
+  GstAppSink * sink_ = nullptr;
+  /**< sample pulled ahead by initialize or waitForFrame, read next >**/
+  GstSample * pending_ = nullptr;
+  bool nv12_ = false;
+  bool failed_ = false;
+};
+}  // namespace Input
+
+#endif  // DYNAMIC_VINO_LIB__INPUTS__GSTREAMER_INPUT_HPP_
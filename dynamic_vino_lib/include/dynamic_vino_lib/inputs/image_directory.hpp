@@ -0,0 +1,103 @@
+// Copyright (c) 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @brief A header file with declaration for ImageDirectory class
+ * @file image_directory.hpp
+ */
+#ifndef DYNAMIC_VINO_LIB__INPUTS__IMAGE_DIRECTORY_HPP_
+#define DYNAMIC_VINO_LIB__INPUTS__IMAGE_DIRECTORY_HPP_
+
+#include <opencv2/opencv.hpp>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "dynamic_vino_lib/inputs/base_input.hpp"
+#include "dynamic_vino_lib/utils/thread_pool.hpp"
+
+namespace Input
+{
+/**
+ * @class ImageDirectory
+ * @brief Class for recieving the image files of a directory (or of a glob
+ * pattern) as input, in file name order. The images are decoded by a pool of
+ * workers ahead of the reads, and the input is exhausted after the last one.
+ */
+class ImageDirectory : public BaseInputDevice
+{
+public:
+  /**
+   * @param[in] meta The directory or the glob pattern, optionally followed by
+   * options, e.g. "/data/frames,threads=4,queue_size=16,lanes=4".
+   */
+  explicit ImageDirectory(const std::string & meta);
+  ~ImageDirectory() override;
+  /**
+   * @brief List the image files.
+   * @return Whether there is at least one image.
+   */
+  bool initialize() override;
+  /**
+   * @brief Initialize the input device with given width and height.
+   * No implementation for ImageDirectory class.
+   */
+  bool initialize(size_t width, size_t height) override
+  {
+    return initialize();
+  }
+  /**
+   * @brief Read the next image, the header frame id is its file path.
+   * @return False once all the images are read.
+   */
+  bool read(cv::Mat * frame) override;
+  /**
+   * @brief Block until the next image is decoded.
+   */
+  bool waitForFrame(const std::chrono::milliseconds & timeout) override;
+  bool isExhausted() override;
+  /**
+   * @brief Get the number of images read per pipeline iteration.
+   */
+  size_t getLanes() const override
+  {
+    return lanes_;
+  }
+
+private:
+  /**
+   * @brief Post the decoding of the next images, up to queue_size_ ahead of
+   * the reads. Called with mutex_ held.
+   */
+  void schedule();
+
+  std::string pattern_;
+  bool recursive_ = false;
+  size_t threads_ = 0;
+  size_t queue_size_ = 8;
+  size_t lanes_ = 1;
+  std::vector<cv::String> files_;
+  /**< decoded images by file index, an empty Mat for the files failed >**/
+  std::map<size_t, cv::Mat> decoded_;
+  size_t next_read_ = 0;
+  size_t next_decode_ = 0;
+  std::mutex mutex_;
+  std::condition_variable decoded_cv_;
+  std::unique_ptr<ThreadPool> pool_;
+};
+}  // namespace Input
+
+#endif  // DYNAMIC_VINO_LIB__INPUTS__IMAGE_DIRECTORY_HPP_
@@ -55,6 +55,10 @@ public:
   bool read(cv::Mat * frame) override;
 
   void config(const Config &) override;
+  /**
+   * @brief Serve an image already in memory instead of the image file.
+   */
+  void setImage(const cv::Mat & image);
 
 private:
   cv::Mat image_;
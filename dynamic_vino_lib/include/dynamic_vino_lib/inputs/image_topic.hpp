@@ -23,8 +23,10 @@
 #include <rclcpp/rclcpp.hpp>
 #include <opencv2/opencv.hpp>
 #include <sensor_msgs/msg/image.hpp>
+#include <condition_variable>
 #include <memory>
-#include "dynamic_vino_lib/utils/mutex_counter.hpp"
+#include <mutex>
+#include <string>
 #include "dynamic_vino_lib/inputs/base_input.hpp"
 
 namespace Input
@@ -36,18 +38,34 @@ namespace Input
 class ImageTopic : public BaseInputDevice
 {
 public:
-  ImageTopic(rclcpp::Node::SharedPtr node = nullptr);
+  /**
+   * @param[in] meta The options of the input, "format=nv12" to keep the nv12
+   * images as they are (the others are converted to NV12), BGR by default.
+   */
+  ImageTopic(rclcpp::Node::SharedPtr node = nullptr, const std::string & meta = "");
   bool initialize() override;
   bool initialize(size_t width, size_t height) override;
   bool read(cv::Mat * frame) override;
+  /**
+   * @brief Sleep until a new image message arrives (or timeout).
+   */
+  bool waitForFrame(const std::chrono::milliseconds & timeout) override;
+  bool isNV12() const override
+  {
+    return nv12_;
+  }
 
 private:
   rclcpp::Subscription<sensor_msgs::msg::Image>::SharedPtr sub_;
+  rclcpp::CallbackGroup::SharedPtr callback_group_;
   cv::Mat image_;
-  MutexCounter image_count_;
+  bool has_new_image_ = false;
+  std::mutex image_mutex_;
+  std::condition_variable image_cv_;
   rclcpp::Node::SharedPtr node_ = nullptr;
+  bool nv12_ = false;
 
-  void cb(const sensor_msgs::msg::Image::SharedPtr image_msg);
+  void cb(sensor_msgs::msg::Image::ConstSharedPtr image_msg);
 };
 }  // namespace Input
 
@@ -0,0 +1,70 @@
+// Copyright (c) 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @brief A header file with the parsing of the meta string of input devices
+ * @file input_meta.hpp
+ */
+
+#ifndef DYNAMIC_VINO_LIB__INPUTS__INPUT_META_HPP_
+#define DYNAMIC_VINO_LIB__INPUTS__INPUT_META_HPP_
+
+#include <map>
+#include <sstream>
+#include <string>
+
+namespace Input
+{
+/**
+ * @brief Whether 'text' starts with a "key=" of lower case letters and underscores.
+ */
+inline bool startsWithMetaKey(const std::string & text)
+{
+  auto pos = text.find_first_not_of("abcdefghijklmnopqrstuvwxyz_");
+  return pos != std::string::npos && pos > 0 && text[pos] == '=';
+}
+
+/**
+ * @brief Split a meta string of comma separated key=value pairs, e.g.
+ * "/data/video.mp4,hw_decode=any,pacing=realtime". A leading path or uri,
+ * which is not a key=value pair, is stored under 'default_key'.
+ */
+inline std::map<std::string, std::string> parseInputMeta(
+  const std::string & meta, const std::string & default_key = "path")
+{
+  std::map<std::string, std::string> values;
+  std::string options = meta;
+  if (!startsWithMetaKey(meta)) {
+    // the path ends at the first ",key=", it may contain commas itself
+    size_t end = meta.find(',');
+    while (end != std::string::npos && !startsWithMetaKey(meta.substr(end + 1))) {
+      end = meta.find(',', end + 1);
+    }
+    values[default_key] = meta.substr(0, end);
+    options = end == std::string::npos ? "" : meta.substr(end + 1);
+  }
+
+  std::stringstream ss(options);
+  std::string item;
+  while (std::getline(ss, item, ',')) {
+    auto pos = item.find('=');
+    if (pos != std::string::npos) {
+      values[item.substr(0, pos)] = item.substr(pos + 1);
+    }
+  }
+  return values;
+}
+}  // namespace Input
+
+#endif  // DYNAMIC_VINO_LIB__INPUTS__INPUT_META_HPP_
@@ -22,18 +22,26 @@
 
 #include <opencv2/opencv.hpp>
 #include <opencv2/imgproc.hpp>
+#include <memory>
 #include "dynamic_vino_lib/inputs/base_input.hpp"
+#include "dynamic_vino_lib/inputs/video_decoder.hpp"
 
 namespace Input
 {
 /**
  * @class IpCamera
- * @brief Class for recieving a ip camera as input.
+ * @brief Class for recieving a ip camera as input. The stream is ingested on
+ * a background thread which always keeps the newest frame only, so that a slow
+ * pipeline does not lag behind the camera, and reconnects when it drops.
  */
 class IpCamera : public BaseInputDevice
 {
 public:
-  explicit IpCamera(const std::string & ip_uri) : ip_uri_(ip_uri) {}
+  /**
+   * @param[in] meta The uri of the camera, optionally followed by options,
+   * e.g. "rtsp://192.168.1.10/stream,hw_decode=vaapi,max_backoff_ms=10000".
+   */
+  explicit IpCamera(const std::string & meta);
   /**
    * @brief Initialize the input device,
    * for cameras, it will turn the camera on and get ready to read frames,
@@ -51,9 +59,18 @@ public:
    * @return Whether the next frame is successfully read.
    */
   bool read(cv::Mat * frame) override;
+  bool waitForFrame(const std::chrono::milliseconds & timeout) override;
+  uint64_t getDroppedFrames() override
+  {
+    return decoder_->getDroppedFrames();
+  }
+  uint64_t getLateFrames() override
+  {
+    return decoder_->getLateFrames();
+  }
 
 private:
-  cv::VideoCapture cap;
+  std::unique_ptr<VideoDecoder> decoder_;
   std::string ip_uri_;
 };
 }  // namespace Input
@@ -22,17 +22,34 @@
 
 #include <librealsense2/rs.hpp>
 #include <opencv2/opencv.hpp>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
 #include "dynamic_vino_lib/inputs/base_input.hpp"
 
 namespace Input
 {
 /**
  * @class RealSenseCamera
- * @brief Class for recieving a realsense camera as input.
+ * @brief Class for recieving a realsense camera as input. Optionally the
+ * depth frame is kept alongside the color one, for the positions of the results.
  */
 class RealSenseCamera : public BaseInputDevice
 {
 public:
+  /**
+   * @brief The camera can be configured by a meta string of comma separated
+   * key=value pairs, e.g. "serial=012345678901,width=1280,height=720,fps=30,format=BGR8".
+   * Without a serial the first connected camera not used by another input is taken.
+   * With "depth=true" the depth stream is captured too, with "align=true" it
+   * is aligned to the color stream on the capture thread.
+   */
+  explicit RealSenseCamera(const std::string & meta = "");
+  ~RealSenseCamera() override;
   /**
    * @brief Initialize the input device, turn the
    * camera on and get ready to read frames.
@@ -49,15 +66,59 @@ public:
    * @return Whether the next frame is successfully read.
    */
   bool read(cv::Mat * frame) override;
+  /**
+   * @brief Block until the capture thread has queued a color frame.
+   */
+  bool waitForFrame(const std::chrono::milliseconds & timeout) override;
+  /**
+   * @brief Get the depth captured with the color frame last read.
+   */
+  std::shared_ptr<DepthLookup> getDepth() override
+  {
+    return depth_frame_;
+  }
 
 private:
   void bypassFewFramesOnceInited();
-  std::string getCameraSN();
+  /**
+   * @brief Reserve the configured camera, or the first free one when no
+   * serial is given, so that each device is opened by one input only.
+   * @return The serial number of the camera, empty if none is available.
+   */
+  std::string claimCamera();
+  void releaseCamera();
+  /**
+   * @brief Wait for the frames of the camera and queue the color ones.
+   */
+  void capture();
 
   rs2::config cfg_;
   rs2::pipeline pipe_;
+  /**< color frames captured, only the latest ones are kept >**/
+  rs2::frame_queue queue_{2};
+  rs2::frame pending_;
+  std::thread capture_thread_;
+  std::atomic<bool> capturing_{false};
   bool first_read_ = true;
-  static int rscamera_count;
+  std::string serial_;
+  size_t width_ = 640;
+  size_t height_ = 480;
+  int fps_ = 30;
+  rs2_format format_ = RS2_FORMAT_BGR8;
+  bool claimed_ = false;
+  bool depth_ = false;
+  bool align_ = false;
+  std::unique_ptr<rs2::align> aligner_;
+  /**< the calibration of the streams, to map color pixels to depth ones >**/
+  rs2_intrinsics color_intrinsics_;
+  rs2_intrinsics depth_intrinsics_;
+  rs2_extrinsics color_to_depth_;
+  rs2_extrinsics depth_to_color_;
+  float depth_scale_ = 0.001f;
+  std::shared_ptr<DepthLookup> depth_frame_;
+  /**< serial numbers of the cameras opened by the process >**/
+  static std::set<std::string> claimed_serials_;
+  static std::mutex claimed_mutex_;
 };
 }  // namespace Input
 
@@ -21,7 +21,14 @@
 #define DYNAMIC_VINO_LIB__INPUTS__STANDARD_CAMERA_HPP_
 
 #include <opencv2/opencv.hpp>
-
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 
 #include "dynamic_vino_lib/inputs/base_input.hpp"
 #include <stdio.h>
@@ -35,11 +42,21 @@ namespace Input
 {
 /**
  * @class StandardCamera
- * @brief Class for recieving a standard camera as input.
+ * @brief Class for recieving a standard camera as input. By default the
+ * camera is read through cv::VideoCapture. With an explicit format it is
+ * captured through V4L2 mmap buffers by a background thread, which decodes
+ * (MJPEG) or converts (YUYV) the newest filled buffer only and keeps the
+ * newest frame for read().
  */
 class StandardCamera : public BaseInputDevice
 {
 public:
+  /**
+   * @param[in] meta Optionally the device, followed by the V4L2 options,
+   * e.g. "/dev/video2,format=mjpeg,fps=30,queue_size=4".
+   */
+  explicit StandardCamera(const std::string & meta = "");
+  ~StandardCamera() override;
   /**
    * @brief Initialize the input device,
    * for cameras, it will turn the camera on and get ready to read frames,
@@ -57,11 +74,61 @@ public:
    * @return Whether the next frame is successfully read.
    */
   bool read(cv::Mat * frame) override;
+  /**
+   * @brief Block until the capture thread has a new frame (V4L2 capture).
+   */
+  bool waitForFrame(const std::chrono::milliseconds & timeout) override;
+  uint64_t getDroppedFrames() override
+  {
+    return dropped_frames_;
+  }
+  uint64_t getLateFrames() override
+  {
+    return late_frames_;
+  }
 
 private:
   int getCameraId();
+  /**
+   * @brief Set the format, the frame rate and the mmap buffers of the device
+   * and start streaming.
+   * @return Whether the device streams in the requested format.
+   */
+  bool openV4L2(size_t width, size_t height);
+  void closeV4L2();
+  /**
+   * @brief The capture thread, dequeues the newest filled buffer, decodes it
+   * and gives the buffers back to the driver.
+   */
+  void capture();
+  /**
+   * @brief Decode or convert a filled buffer to a BGR frame.
+   */
+  cv::Mat decode(const void * data, size_t bytes);
+
   cv::VideoCapture cap;
   int camera_id_ = -1;
+
+  /**< V4L2 pixel format, 0 to read the camera through cv::VideoCapture >**/
+  uint32_t pixel_format_ = 0;
+  std::string device_;
+  int fps_ = 0;
+  /**< number of mmap buffers queued to the driver >**/
+  size_t queue_size_ = 4;
+  int fd_ = -1;
+  size_t bytes_per_line_ = 0;
+  std::chrono::microseconds frame_interval_{0};
+  std::vector<std::pair<void *, size_t>> buffers_;
+
+  /**< newest frame, with the time it was captured >**/
+  cv::Mat latest_;
+  std::chrono::steady_clock::time_point latest_time_;
+  std::mutex mutex_;
+  std::condition_variable has_frame_;
+  std::atomic<bool> capturing_{false};
+  std::atomic<uint64_t> dropped_frames_{0};
+  std::atomic<uint64_t> late_frames_{0};
+  std::thread capture_thread_;
 };
 }  // namespace Input
 #endif  // DYNAMIC_VINO_LIB__INPUTS__STANDARD_CAMERA_HPP_
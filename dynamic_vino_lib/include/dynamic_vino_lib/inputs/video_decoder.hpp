@@ -0,0 +1,181 @@
+// Copyright (c) 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @brief A header file with declaration for VideoDecoder class
+ * @file video_decoder.hpp
+ */
+
+#ifndef DYNAMIC_VINO_LIB__INPUTS__VIDEO_DECODER_HPP_
+#define DYNAMIC_VINO_LIB__INPUTS__VIDEO_DECODER_HPP_
+
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+
+namespace Input
+{
+/**
+ * @class VideoDecoder
+ * @brief Decodes a cv::VideoCapture source on a background thread into a
+ * bounded queue of frames, so that decoding overlaps with the inferences.
+ */
+class VideoDecoder
+{
+public:
+  struct Options
+  {
+    /**< number of decoded frames kept ahead of the reader >**/
+    size_t queue_size = 4;
+    /**< when the queue is full, drop its oldest frame instead of waiting >**/
+    bool drop_oldest = false;
+    /**< deliver the frames at the rate of the source instead of as fast as possible >**/
+    bool realtime = false;
+    /**< hardware decode: none, any, vaapi, mfx or d3d11 >**/
+    std::string hw_decode = "none";
+    /**< with hw_decode, convert the decoded surfaces on the GPU through the OpenCL
+         interop of VA-API and D3D11, instead of copying them to convert them >**/
+    bool hw_opencl = false;
+    /**< reopen the source when it fails, e.g. a dropped network stream >**/
+    bool reconnect = false;
+    /**< the delay between two reconnections doubles up to this value >**/
+    int max_backoff_ms = 5000;
+    /**< first frame decoded, e.g. the start of a segment of a video file >**/
+    uint64_t start_frame = 0;
+    /**< frames decoded from start_frame, 0 for all the remaining ones >**/
+    uint64_t frame_count = 0;
+  };
+
+  /**
+   * @brief Read the options from the key=value pairs of an input meta:
+   * queue_size, hw_decode, hw_opencl (true or false), pacing (realtime or
+   * fast), reconnect (true or false) and max_backoff_ms. The missing ones keep the given defaults.
+   */
+  static Options parseOptions(
+    const std::map<std::string, std::string> & meta, const Options & defaults = Options());
+
+  /**
+   * @brief Get the number of frames of a video file, 0 if it is unknown.
+   */
+  static uint64_t countFrames(const std::string & source);
+
+  explicit VideoDecoder(const Options & options);
+  ~VideoDecoder();
+  /**
+   * @brief Open the source and start decoding it. A width and height other
+   * than 0 are requested from the source before decoding starts.
+   * @return Whether the source is opened.
+   */
+  bool open(const std::string & source, size_t width = 0, size_t height = 0);
+  /**
+   * @brief Stop decoding and release the source.
+   */
+  void close();
+  /**
+   * @brief Take the next decoded frame, blocking until it is decoded.
+   * @return False once the source is exhausted.
+   */
+  bool read(cv::Mat * frame);
+  /**
+   * @brief Block until a decoded frame is queued, or the source is exhausted.
+   */
+  bool waitForFrame(const std::chrono::milliseconds & timeout);
+  /**
+   * @brief Whether the source is exhausted and all its decoded frames are read.
+   */
+  bool isExhausted();
+  /**
+   * @brief Get the position in the source of the frame last read.
+   */
+  uint64_t getReadPosition() const
+  {
+    return read_position_;
+  }
+  cv::Size getFrameSize() const
+  {
+    return frame_size_;
+  }
+  /**
+   * @brief Get the number of decoded frames dropped because the reader is too slow.
+   */
+  uint64_t getDroppedFrames() const
+  {
+    return dropped_frames_;
+  }
+  /**
+   * @brief Get the number of frames read more than one frame interval after
+   * they were decoded. Only counted when the oldest frames are dropped (live sources).
+   */
+  uint64_t getLateFrames() const
+  {
+    return late_frames_;
+  }
+  /**
+   * @brief Get the number of times the source was reopened after a failure.
+   */
+  uint64_t getReconnects() const
+  {
+    return reconnects_;
+  }
+
+private:
+  bool openCapture(const std::string & source);
+  void configureCapture();
+  /**
+   * @brief Reopen the source with an exponential backoff.
+   * @return False if the decoder is closed meanwhile.
+   */
+  bool reconnect();
+  void decode();
+  /**
+   * @brief Sleep until the frame at the source position is due (realtime pacing).
+   */
+  void pace(uint64_t index);
+
+  Options options_;
+  cv::VideoCapture cap_;
+  std::string source_;
+  cv::Size requested_size_;
+  cv::Size frame_size_;
+  double fps_ = 0;
+  std::chrono::steady_clock::time_point start_time_;
+  double start_msec_ = -1;
+
+  /**< decoded frames with the time they were decoded >**/
+  std::deque<std::pair<cv::Mat, std::chrono::steady_clock::time_point>> queue_;
+  /**< the surface retrieved on the GPU with hw_opencl >**/
+  cv::UMat surface_;
+  bool opencl_retrieve_ = false;
+  bool end_of_stream_ = false;
+  uint64_t read_position_ = 0;
+  uint64_t next_position_ = 0;
+  std::mutex mutex_;
+  std::condition_variable not_empty_;
+  std::condition_variable not_full_;
+  std::atomic<uint64_t> dropped_frames_{0};
+  std::atomic<uint64_t> late_frames_{0};
+  std::atomic<uint64_t> reconnects_{0};
+  std::atomic<bool> decoding_{false};
+  std::thread decode_thread_;
+};
+}  // namespace Input
+
+#endif  // DYNAMIC_VINO_LIB__INPUTS__VIDEO_DECODER_HPP_
@@ -20,19 +20,29 @@
 #define DYNAMIC_VINO_LIB__INPUTS__VIDEO_INPUT_HPP_
 
 #include <opencv2/opencv.hpp>
+#include <memory>
 #include <string>
+#include <vector>
 #include "dynamic_vino_lib/inputs/base_input.hpp"
+#include "dynamic_vino_lib/inputs/video_decoder.hpp"
 
 namespace Input
 {
 /**
  * @class Video
- * @brief Class for recieving a video file as input.
+ * @brief Class for recieving a video file as input. The file is decoded
+ * ahead of the reads on a background thread. For offline processing the file
+ * can be split into segments decoded in parallel, each read as a lane.
  */
 class Video : public BaseInputDevice
 {
 public:
-  explicit Video(const std::string &);
+  /**
+   * @param[in] meta The video file path, optionally followed by decode options,
+   * e.g. "/data/video.mp4,hw_decode=vaapi,pacing=realtime,queue_size=4", or
+   * "/data/video.mp4,segments=8" to decode 8 segments of the file in parallel.
+   */
+  explicit Video(const std::string & meta);
   /**
    * @brief Read a video file from the file path.
    * @param[in] An video file path.
@@ -50,9 +60,34 @@ public:
    * @return Whether the next frame is successfully read.
    */
   bool read(cv::Mat * frame) override;
+  /**
+   * @brief Block until the decoder thread has queued a frame.
+   */
+  bool waitForFrame(const std::chrono::milliseconds & timeout) override;
+  /**
+   * @brief Whether all the frames of the video file are read.
+   */
+  bool isExhausted() override;
+  /**
+   * @brief Get the number of segments, read in turn by the lanes of the pipeline.
+   */
+  size_t getLanes() const override
+  {
+    return decoders_.empty() ? segments_ : decoders_.size();
+  }
 
 private:
-  cv::VideoCapture cap;
+  /**
+   * @brief Open a decoder per segment, a single one if the number of frames
+   * of the file is unknown.
+   */
+  bool open(size_t width, size_t height);
+
+  VideoDecoder::Options options_;
+  std::vector<std::unique_ptr<VideoDecoder>> decoders_;
+  size_t segments_ = 1;
+  /**< segment served by the next read >**/
+  size_t next_segment_ = 0;
   std::string video_;
 };
 }  // namespace Input
@@ -123,6 +123,16 @@ public:
     return it->second;
   }
 
+  inline int getInputHeight() const
+  {
+    return attr_.input_height;
+  }
+
+  inline int getInputWidth() const
+  {
+    return attr_.input_width;
+  }
+
   inline int getMaxProposalCount() const
   {
     return attr_.max_proposal_count;
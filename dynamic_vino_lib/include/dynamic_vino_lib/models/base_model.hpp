@@ -32,6 +32,7 @@
 #include "inference_engine.hpp"
 #include "dynamic_vino_lib/slog.hpp"
 #include "dynamic_vino_lib/models/attributes/base_attribute.hpp"
+#include "dynamic_vino_lib/models/model_registry.hpp"
 
 namespace Engines
 {
@@ -41,6 +42,7 @@ namespace Engines
 namespace dynamic_vino_lib
 {
   class ObjectDetectionResult;
+  class ObjectDetectionArena;
 }
 
 namespace Models
@@ -77,6 +79,13 @@ namespace Models
     {
       max_batch_size_ = max_batch_size;
     }
+  /**
+   * @brief Get the location of the model's .xml file.
+   */
+    inline const std::string & getModelLocation() const
+    {
+      return model_loc_;
+    }
 
     virtual bool enqueue(
         const std::shared_ptr<Engines::Engine> &engine,
@@ -85,7 +94,7 @@ namespace Models
   /**
    * @brief Initialize the model. During the process the class will check
    * the network input, output size, check layer property and
-   * set layer property.
+   * set layer property. The files are read through the ModelRegistry.
    */
     void modelInit();
   /**
@@ -99,6 +108,11 @@ namespace Models
     {
       return net_reader_;
     }
+    /**
+     * @brief Whether the enqueue of the model can hand the frame over to the
+     * plugin (see Engine::setInputFrame) instead of filling the input blob.
+     */
+    virtual bool supportsPluginPreprocess() const { return true; }
 
   protected:
     /**
@@ -109,36 +123,93 @@ namespace Models
     virtual bool updateLayerProperty(InferenceEngine::CNNNetwork& network_reader) = 0;
 
     ///InferenceEngine::CNNNetReader::Ptr net_reader_;
-    InferenceEngine::Core engine;
-    InferenceEngine::CNNNetwork net_reader_; // = engine.ReadNetwork(model->getModelFileName());
-    void setFrameSize(const int &w, const int &h)
+    InferenceEngine::CNNNetwork net_reader_; // read by the shared Core of EngineManager
+    /**< the network and labels as read, shared with the models of the same files >**/
+    std::shared_ptr<const ModelRegistry::Entry> parsed_;
+    void setFrameSize(const int &w, const int &h, int batch_index = 0)
     {
       frame_size_.width = w;
       frame_size_.height = h;
+      if (batch_index >= static_cast<int>(batch_frame_sizes_.size())) {
+        batch_frame_sizes_.resize(batch_index + 1);
+      }
+      batch_frame_sizes_[batch_index] = frame_size_;
     }
     cv::Size getFrameSize()
     {
       return frame_size_;
     }
+    /**
+     * @brief Get the size of the frame enqueued into the given batch slot.
+     */
+    cv::Size getFrameSize(int batch_index)
+    {
+      if (batch_index < 0 || batch_index >= static_cast<int>(batch_frame_sizes_.size())) {
+        return frame_size_;
+      }
+      return batch_frame_sizes_[batch_index];
+    }
 
   private:
     int max_batch_size_;
     std::string model_loc_;
     cv::Size frame_size_;
+    std::vector<cv::Size> batch_frame_sizes_;
   };
 
   class ObjectDetectionModel : public BaseModel
   {
   public:
     ObjectDetectionModel(const std::string &model_loc, int batch_size = 1);
+    using BaseModel::enqueue;
+    /**
+     * @brief Enqueue a whole frame into the given batch slot of the input blob.
+     * Models that can't tell the results of different slots apart only accept
+     * slot 0.
+     */
+    virtual bool enqueue(
+        const std::shared_ptr<Engines::Engine> &engine,
+        const cv::Mat &frame,
+        const cv::Rect &input_frame_loc,
+        int batch_index)
+    {
+      return batch_index == 0 && enqueue(engine, frame, input_frame_loc);
+    }
+    /**
+     * @brief Whether the frames of several inputs can be batched into one request.
+     */
+    virtual bool supportsFrameBatching() const { return false; }
+    /**
+     * @brief Whether whole NV12 frames (see utils/nv12.hpp) can be enqueued.
+     */
+    virtual bool supportsNV12() const { return false; }
+    virtual bool enqueueNV12(
+        const std::shared_ptr<Engines::Engine> &engine, const cv::Mat &nv12, int batch_index)
+    {
+      return false;
+    }
     virtual bool fetchResults(
         const std::shared_ptr<Engines::Engine> &engine,
-        std::vector<dynamic_vino_lib::ObjectDetectionResult> &result,
+        dynamic_vino_lib::ObjectDetectionArena &detections,
         const float &confidence_thresh = 0.3,
         const bool &enable_roi_constraint = false) = 0;
     virtual bool matToBlob(
         const cv::Mat &orig_image, const cv::Rect &, float scale_factor,
         int batch_index, const std::shared_ptr<Engines::Engine> &engine) = 0;
+    /**
+     * @brief Set the suppression of the models decoding raw boxes: the IoU
+     * threshold of the per-class NMS and the maximum number of detections
+     * kept (0 for no limit).
+     */
+    void setNms(float iou_threshold, int top_k)
+    {
+      nms_threshold_ = iou_threshold;
+      top_k_ = top_k;
+    }
+
+  protected:
+    float nms_threshold_ = 0.45;
+    int top_k_ = 0;
   };
 
 } // namespace Models
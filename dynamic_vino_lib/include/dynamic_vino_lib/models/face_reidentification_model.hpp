@@ -39,6 +39,7 @@ public:
   const std::string getModelCategory() const override;
 
 protected:
+  bool updateLayerProperty(InferenceEngine::CNNNetwork&) override;
   //void checkLayerProperty(const InferenceEngine::CNNNetReader::Ptr &) override;
   //void setLayerProperty(InferenceEngine::CNNNetReader::Ptr) override;
   std::string input_;
@@ -0,0 +1,88 @@
+// Copyright (c) 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @brief A header file with declaration for ModelRegistry Class
+ * @file model_registry.hpp
+ */
+
+#ifndef DYNAMIC_VINO_LIB__MODELS__MODEL_REGISTRY_HPP_
+#define DYNAMIC_VINO_LIB__MODELS__MODEL_REGISTRY_HPP_
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "inference_engine.hpp"
+
+namespace Models
+{
+/**
+ * @class ModelRegistry
+ * @brief The networks and labels read from the model files, shared by all the
+ * models of the process using the same files, e.g. a face detection of two
+ * pipelines. The files are read once while any model uses them; each model
+ * gets a copy of the network sharing its weights, to set its own batch size,
+ * layouts and precisions on.
+ */
+class ModelRegistry
+{
+public:
+  struct Entry
+  {
+    /**< the network as read, never changed >**/
+    InferenceEngine::CNNNetwork network;
+    /**< the lines of the .labels file next to the .xml, if any >**/
+    std::vector<std::string> labels;
+  };
+
+  static ModelRegistry & getInstance();
+  /**
+   * @brief Get the network and labels of a model, read unless a model of
+   * the process holds them already. A model whose files changed on disk since
+   * is read again.
+   */
+  std::shared_ptr<const Entry> get(const std::string & model_loc);
+  /**
+   * @brief Whether the network of an entry can be copied: not without nGraph,
+   * nor for the legacy IR representation without an nGraph function. The
+   * models then read the network files on their own.
+   */
+  static bool canCloneNetwork(const Entry & entry);
+  /**
+   * @brief Copy the network of an entry, the weights being shared.
+   */
+  static InferenceEngine::CNNNetwork cloneNetwork(const Entry & entry);
+
+private:
+  ModelRegistry() = default;
+  ModelRegistry(const ModelRegistry &) = delete;
+  ModelRegistry & operator=(const ModelRegistry &) = delete;
+  /**
+   * @brief Build the key of a model from the location and modification times
+   * of its files.
+   */
+  static std::string getKey(const std::string & model_loc);
+
+  /**< read entries, released once no model uses them >**/
+  std::map<std::string, std::weak_ptr<const Entry>> entries_;
+  /**< one per key, so that other models are read concurrently >**/
+  std::map<std::string, std::shared_ptr<std::mutex>> read_mutexes_;
+  std::mutex mutex_;
+};
+}  // namespace Models
+
+#endif  // DYNAMIC_VINO_LIB__MODELS__MODEL_REGISTRY_HPP_
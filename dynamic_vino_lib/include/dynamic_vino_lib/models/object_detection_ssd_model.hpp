@@ -36,7 +36,7 @@ public:
 
   bool fetchResults(
     const std::shared_ptr<Engines::Engine> & engine,
-    std::vector<dynamic_vino_lib::ObjectDetectionResult> & results,
+    dynamic_vino_lib::ObjectDetectionArena & detections,
     const float & confidence_thresh = 0.3,
     const bool & enable_roi_constraint = false) override;
 
@@ -45,6 +45,30 @@ public:
     const cv::Mat & frame,
     const cv::Rect & input_frame_loc) override;
 
+  bool enqueue(
+    const std::shared_ptr<Engines::Engine> & engine,
+    const cv::Mat & frame,
+    const cv::Rect & input_frame_loc,
+    int batch_index) override;
+
+  bool supportsFrameBatching() const override
+  {
+    return true;
+  }
+
+  bool supportsNV12() const override
+  {
+    return true;
+  }
+  /**
+   * @brief Take an NV12 frame: with plugin preprocessing the plugin converts
+   * it, otherwise its planes are resized before only the resized pixels are
+   * converted to BGR.
+   */
+  bool enqueueNV12(
+    const std::shared_ptr<Engines::Engine> & engine, const cv::Mat & nv12,
+    int batch_index) override;
+
   bool matToBlob(
     const cv::Mat & orig_image, const cv::Rect &, float scale_factor,
     int batch_index, const std::shared_ptr<Engines::Engine> & engine) override;
@@ -57,6 +81,39 @@ public:
 
   bool updateLayerProperty(InferenceEngine::CNNNetwork&) override;
 
+  /**
+   * @brief Set the input size the network is reshaped to by updateLayerProperty:
+   * "WxH", or an aspect ratio "W:H" for about as many pixels as the IR's input.
+   * Empty keeps the input of the IR.
+   */
+  void setInputShape(const std::string & shape)
+  {
+    input_shape_ = shape;
+  }
+
+  /**
+   * @brief Get the input size for a shape of setInputShape, given the input
+   * size of the IR. The sizes for an aspect ratio are multiples of 32, the stride
+   * of the usual SSD backbones.
+   * @return The IR's size for an empty or malformed shape.
+   */
+  static cv::Size getReshapeSize(const cv::Size & native, const std::string & shape);
+
+  /**
+   * @brief Decode the DetectionOutput blob: rows of 'object_size' floats
+   * (image_id, label, confidence, xmin, ymin, xmax, ymax), up to the first
+   * negative image_id. The normalized boxes are scaled to the frame of their
+   * batch slot, 'frame_sizes[image_id]'.
+   */
+  static void decodeDetections(
+    const float * detections, int max_proposal_count, int object_size,
+    const std::vector<cv::Size> & frame_sizes, float confidence_thresh,
+    bool enable_roi_constraint, dynamic_vino_lib::ObjectDetectionArena & detections_arena);
+
+private:
+  /**< the frame size of each batch slot of the request fetched >**/
+  std::vector<cv::Size> frame_sizes_;
+  std::string input_shape_;
 };
 }  // namespace Models
 #endif  // DYNAMIC_VINO_LIB__MODELS__OBJECT_DETECTION_SSD_MODEL_HPP_
@@ -20,7 +20,10 @@
 #include <string>
 #include <memory>
 #include <vector>
+#include "dynamic_vino_lib/engines/blob_binding.hpp"
 #include "dynamic_vino_lib/models/base_model.hpp"
+#include "dynamic_vino_lib/utils/preprocess_cache.hpp"
+#include "dynamic_vino_lib/utils/scratch_arena.hpp"
 namespace Models
 {
 /**
@@ -36,7 +39,7 @@ public:
 
   bool fetchResults(
     const std::shared_ptr<Engines::Engine> & engine,
-    std::vector<dynamic_vino_lib::ObjectDetectionResult> & results,
+    dynamic_vino_lib::ObjectDetectionArena & detections,
     const float & confidence_thresh = 0.3,
     const bool & enable_roi_constraint = false) override;
 
@@ -55,10 +58,94 @@ public:
    */
   const std::string getModelCategory() const override;
   bool updateLayerProperty(InferenceEngine::CNNNetwork&) override;
+  bool supportsPluginPreprocess() const override
+  {
+    return false;
+  }
+
+  /**
+   * @brief How a frame is fitted into the network input: scaled by 'scale'
+   * and shifted by (dx, dy) of gray padding.
+   */
+  struct Letterbox
+  {
+    float scale = 1.0;
+    int dx = 0;
+    int dy = 0;
+  };
+
+  /**
+   * @brief Parameters of the RegionYolo output, read once from the network.
+   */
+  struct Region
+  {
+    int num = 5;
+    int coords = 4;
+    int classes = 20;
+    int side = 13;
+    /**< width and height of each anchor, in grid cells >**/
+    std::vector<float> anchors = {
+      0.572730, 0.677385,
+      1.874460, 2.062530,
+      3.338430, 5.474340,
+      7.882820, 3.527780,
+      9.770520, 9.168280
+    };
+  };
+
+  /**
+   * @brief Fit the frame into the given batch slot of the U8 NCHW blob,
+   * keeping its aspect ratio and padding it with gray, as RGB. The plugin
+   * normalizes it to [0, 1]. With OpenCL preprocessing the frame is fitted
+   * on the device, uploaded once through the cache if any.
+   * @return How the frame is fitted, to map the detected boxes back.
+   */
+  static Letterbox letterboxToBlob(
+    const cv::Mat & orig_image, int batch_index, const Engines::InputBinding & binding,
+    PreprocessCache * cache = nullptr);
+  /**
+   * @brief Decode the RegionYolo output of a frame into its detections after
+   * a per-class NMS, the boxes mapped back to the frame by its letterbox.
+   * @param[in] top_k The detections kept at most, 0 for no limit.
+   */
+  static void decodeRegion(
+    const float * detections, const Region & region, const cv::Size & input_size,
+    const Letterbox & letterbox, float confidence_thresh, float nms_threshold, int top_k,
+    dynamic_vino_lib::ObjectDetectionArena & detections_arena);
 
 protected:
-  int getEntryIndex(int side, int lcoords, int lclasses, int location, int entry);
+  /**
+   * @brief A box decoded from an output, before the NMS.
+   */
+  struct Candidate
+  {
+    cv::Rect2f box;
+    float confidence;
+    int class_id;
+  };
+  /**
+   * @brief Run the per-class NMS over the candidates of a frame and add the
+   * kept ones to its detections, the most confident first.
+   * @param[in] candidates Taken from the scratch arena of the calling thread.
+   * @param[in] top_k The detections kept at most, 0 for no limit.
+   */
+  static void suppressCandidates(
+    ScratchVector<Candidate> & candidates, float nms_threshold, int top_k,
+    dynamic_vino_lib::ObjectDetectionArena & detections_arena);
+
+  /**
+   * @brief Set the single input to U8 NCHW, normalized to [0, 1] by the plugin.
+   */
+  bool updateInputProperty(InferenceEngine::CNNNetwork & network);
+  /**
+   * @brief Read the region parameters from the RegionYolo operation of the
+   * network, the defaults (YOLOv2 VOC) are kept if there is none.
+   */
+  void readRegion(InferenceEngine::CNNNetwork & network);
   InferenceEngine::InputInfo::Ptr input_info_ = nullptr;
+  Region region_;
+  /**< per batch slot of each request, read by fetchResults >**/
+  std::vector<Letterbox> letterboxes_;
 };
 }  // namespace Models
 #endif  // DYNAMIC_VINO_LIB__MODELS__OBJECT_DETECTION_YOLOV2_MODEL_HPP_
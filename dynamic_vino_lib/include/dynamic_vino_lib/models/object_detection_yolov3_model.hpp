@@ -0,0 +1,84 @@
+// Copyright (c) 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @brief A header file with declaration for ObjectDetectionYolov3Model Class
+ * @file object_detection_yolov3_model.hpp
+ */
+#ifndef DYNAMIC_VINO_LIB__MODELS__OBJECT_DETECTION_YOLOV3_MODEL_HPP_
+#define DYNAMIC_VINO_LIB__MODELS__OBJECT_DETECTION_YOLOV3_MODEL_HPP_
+#include <string>
+#include <memory>
+#include <vector>
+#include "dynamic_vino_lib/models/object_detection_yolov2_model.hpp"
+namespace Models
+{
+/**
+ * @class ObjectDetectionYolov3Model
+ * @brief This class generates the YOLOv3/v4-like detection models, whose
+ * outputs are heads at several scales, each with its own anchors. The frames
+ * are letterboxed as for YOLOv2.
+ */
+class ObjectDetectionYolov3Model : public ObjectDetectionYolov2Model
+{
+public:
+  ObjectDetectionYolov3Model(const std::string & model_loc, int batch_size = 1);
+
+  /**
+   * @brief Decode the heads of a frame in parallel, one task per head, then
+   * run the NMS over the candidates of all of them.
+   */
+  bool fetchResults(
+    const std::shared_ptr<Engines::Engine> & engine,
+    dynamic_vino_lib::ObjectDetectionArena & detections,
+    const float & confidence_thresh = 0.3,
+    const bool & enable_roi_constraint = false) override;
+
+  const std::string getModelCategory() const override;
+  bool updateLayerProperty(InferenceEngine::CNNNetwork&) override;
+
+  /**
+   * @brief An output head, [N, num * (coords + 1 + classes), height, width].
+   */
+  struct Head
+  {
+    std::string output;
+    int num = 3;
+    int coords = 4;
+    int classes = 80;
+    int width = 0;
+    int height = 0;
+    /**< width and height of each anchor, in pixels of the network input >**/
+    std::vector<float> anchors;
+    /**< logits straight from a convolution, without a RegionYolo applying the sigmoids >**/
+    bool raw = false;
+  };
+
+protected:
+  /**
+   * @brief Read the heads from the outputs and their RegionYolo operations.
+   * The heads without one get the YOLOv3 COCO anchors by their scale.
+   */
+  bool readHeads(InferenceEngine::CNNNetwork & network);
+  /**
+   * @brief Decode the cells of a head whose objectness passes the threshold.
+   */
+  static void decodeHead(
+    const float * data, const Head & head, const cv::Size & input_size,
+    const Letterbox & letterbox, float confidence_thresh, std::vector<Candidate> & candidates);
+
+  std::vector<Head> heads_;
+};
+}  // namespace Models
+#endif  // DYNAMIC_VINO_LIB__MODELS__OBJECT_DETECTION_YOLOV3_MODEL_HPP_
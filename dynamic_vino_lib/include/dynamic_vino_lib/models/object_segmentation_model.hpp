@@ -51,8 +51,27 @@ public:
    */
   const std::string getModelCategory() const override;
   bool updateLayerProperty(InferenceEngine::CNNNetwork&) override;
+  bool supportsPluginPreprocess() const override
+  {
+    return false;
+  }
+  /**
+   * @brief Whether the model segments instances (Mask R-CNN-like: boxes and
+   * a low resolution mask per box and class), rather than the classes of
+   * each pixel.
+   */
+  bool isInstanceSegmentation() const
+  {
+    return instance_;
+  }
 
 private:
+  /**
+   * @brief Set the detection and masks outputs of a Mask R-CNN-like model.
+   */
+  bool updateInstanceOutputs(InferenceEngine::OutputsDataMap & outputs);
+
+  bool instance_ = false;
   int max_proposal_count_;
   int object_size_;
 
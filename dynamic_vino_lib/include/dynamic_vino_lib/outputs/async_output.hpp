@@ -0,0 +1,114 @@
+// Copyright (c) 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @brief A header file with declaration for AsyncOutput Class
+ * @file async_output.hpp
+ */
+
+#ifndef DYNAMIC_VINO_LIB__OUTPUTS__ASYNC_OUTPUT_HPP_
+#define DYNAMIC_VINO_LIB__OUTPUTS__ASYNC_OUTPUT_HPP_
+
+#include <std_msgs/msg/header.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "dynamic_vino_lib/outputs/base_output.hpp"
+
+namespace Outputs
+{
+/**
+ * @class AsyncOutput
+ * @brief This class hands the frames of an output over to a worker thread, so
+ * that a slow display or publisher does not hold the pipeline. The results
+ * accepted for a frame are recorded and replayed on the wrapped output by the
+ * worker. At most 'capacity' frames wait for the worker, the oldest waiting
+ * frame is dropped to make room for a new one.
+ */
+class AsyncOutput : public BaseOutput
+{
+public:
+  AsyncOutput(
+    const std::string & output_name, std::shared_ptr<BaseOutput> output, size_t capacity);
+  ~AsyncOutput() override;
+
+  void feedFrame(const cv::Mat &) override;
+  bool needsFrame() const override
+  {
+    return output_->needsFrame();
+  }
+  /**
+   * @brief Queue the frame and its recorded results for the worker.
+   */
+  void handleOutput() override;
+  void clearData() override;
+
+  /**
+   * @brief Record the results for the worker, sharing them with the other outputs.
+   */
+  void acceptView(const dynamic_vino_lib::ResultView & view) override;
+
+  /**
+   * @brief Get the number of frames dropped because the worker was behind.
+   */
+  uint64_t getDroppedFrames() const
+  {
+    return dropped_frames_;
+  }
+  size_t getQueueDepth() override
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    return queue_.size();
+  }
+  size_t getQueueBytes() override
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    size_t bytes = 0;
+    for (auto & job : queue_) {
+      bytes += job.frame.total() * job.frame.elemSize();
+    }
+    return bytes;
+  }
+
+private:
+  struct Job
+  {
+    cv::Mat frame;
+    std_msgs::msg::Header header;
+    FrameTimes times;
+    float scale = 1;
+    std::vector<dynamic_vino_lib::ResultView> results;
+  };
+
+  void run();
+
+  std::shared_ptr<BaseOutput> output_;
+  size_t capacity_;
+  Job pending_;
+  std::deque<Job> queue_;
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  bool stopped_ = false;
+  std::atomic<uint64_t> dropped_frames_;
+  std::thread worker_;
+};
+}  // namespace Outputs
+#endif  // DYNAMIC_VINO_LIB__OUTPUTS__ASYNC_OUTPUT_HPP_
@@ -33,11 +33,14 @@
 #include <people_msgs/srv/people.hpp>
 #include <people_msgs/srv/head_pose_srv.hpp>
 #include <object_msgs/srv/detect_object.hpp>
+#include <rclcpp/rclcpp.hpp>
+#include <std_msgs/msg/header.hpp>
 #include <string>
 #include <vector>
 #include <memory>
 
 #include "dynamic_vino_lib/inferences/age_gender_detection.hpp"
+#include "dynamic_vino_lib/frame_context.hpp"
 #include "dynamic_vino_lib/inferences/base_inference.hpp"
 #include "dynamic_vino_lib/inferences/emotions_detection.hpp"
 #include "dynamic_vino_lib/inferences/face_detection.hpp"
@@ -47,11 +50,19 @@
 #include "dynamic_vino_lib/inferences/person_reidentification.hpp"
 #include "dynamic_vino_lib/inferences/person_attribs_detection.hpp"
 #include "dynamic_vino_lib/inferences/landmarks_detection.hpp"
+#include "dynamic_vino_lib/inferences/result_view.hpp"
 #include "dynamic_vino_lib/inferences/face_reidentification.hpp"
 #include "dynamic_vino_lib/inferences/vehicle_attribs_detection.hpp"
 #include "dynamic_vino_lib/inferences/license_plate_detection.hpp"
+#include "dynamic_vino_lib/outputs/output_rate.hpp"
 #include "opencv2/opencv.hpp"
 
+#if defined(__has_include)
+#if __has_include(<rclcpp/loaned_message.hpp>)
+#define DYNAMIC_VINO_LIB_LOANED_MESSAGES
+#endif
+#endif
+
 class Pipeline;
 namespace Outputs
 {
@@ -66,6 +77,7 @@ class BaseOutput
 public:
   explicit BaseOutput(std::string output_name)
   : output_name_(output_name) {}
+  virtual ~BaseOutput() = default;
   /**
    * @brief Generate output content according to the license plate detection result.
    */
@@ -139,13 +151,41 @@ public:
   virtual void accept(const std::vector<dynamic_vino_lib::HeadPoseResult> &)
   {
   }
+  /**
+   * @brief Take the results an inference published for the frame, accepted
+   * as their type by default. The view is only valid during the call, an
+   * output keeping the results shares them instead (see ResultView::share).
+   */
+  virtual void acceptView(const dynamic_vino_lib::ResultView & view)
+  {
+    result_age_ = view.getAge();
+    view.deliver(*this);
+  }
+  /**
+   * @brief Get the age of the results being accepted (see ResultView::getAge),
+   * e.g. to mark the results reused from an earlier frame.
+   */
+  int getResultAge() const
+  {
+    return result_age_;
+  }
   /**
    * @brief Calculate the camera matrix of a frame for image window output, no
          implementation for ros topic output.
+   * The frame is a refcounted handle shared with the pipeline and the other
+   * outputs, it must not be written: an output drawing on it copies it first.
    */
   virtual void feedFrame(const cv::Mat &)
   {
   }
+  /**
+   * @brief Whether the output reads the pixels of the frames it is fed, which
+   * the pipeline then converts from NV12 for it. Otherwise it is fed an empty Mat.
+   */
+  virtual bool needsFrame() const
+  {
+    return true;
+  }
   /**
    * @brief Show all the contents generated by the accept functions.
    */
@@ -166,12 +206,114 @@ public:
     std::shared_ptr<people_msgs::srv::People::Response> response) {}
   Pipeline * getPipeline() const;
   cv::Mat getFrame() const;
+  /**
+   * @brief Set the header of the frame being output, for an output handled
+   * after the pipeline moved on to the next frame.
+   */
+  void setFrameHeader(const std_msgs::msg::Header & header);
+  /**
+   * @brief Get the header of the frame being output, the one of the current
+   * frame of the pipeline unless set.
+   */
+  std_msgs::msg::Header getFrameHeader() const;
+  /**
+   * @brief Set the times of the frame being output, along with its header.
+   */
+  void setFrameTimes(const FrameTimes & times);
+  /**
+   * @brief Get the times the frame being output went through the pipeline at,
+   * the ones of the current frame of the pipeline unless set.
+   */
+  FrameTimes getFrameTimes() const;
+  /**
+   * @brief Set the factor from the pixels of the frame being output to those
+   * of the native frame of its input, along with its header.
+   */
+  void setFrameScale(float scale);
+  /**
+   * @brief Get the factor from the pixels of the frame being output to those of
+   * the native frame (see FrameContext::getFrameScale), the one of the current
+   * frame of the pipeline unless set.
+   */
+  float getFrameScale() const;
   virtual void clearData() {}
+  /**
+   * @brief Set which of the frames the output handles, independently of the
+   * rate of the inferences.
+   */
+  void setRate(const OutputRate & rate);
+  /**
+   * @brief Tell whether the output handles the frame being fed, called once per
+   * frame by the pipeline. A skipped frame is neither fed, nor accepted nor
+   * handled by the output.
+   */
+  bool admitFrame();
+  bool isSkippingFrame() const
+  {
+    return skipping_;
+  }
+  /**
+   * @brief Get the number of frames waiting to be output, for the outputs
+   * handing them over to a worker (Thread Safe).
+   */
+  virtual size_t getQueueDepth()
+  {
+    return 0;
+  }
+  /**
+   * @brief Get the bytes of the frames waiting to be output (Thread Safe).
+   */
+  virtual size_t getQueueBytes()
+  {
+    return 0;
+  }
 
 protected:
+  /**
+   * @brief Trace a message of the frame being output, e.g. on a topic, for
+   * the critical path of the frame (see tracing.hpp).
+   */
+  void tracePublish(const std::string & topic) const;
+  /**
+   * @brief Map a region of the frame being output to the native frame of its
+   * input, for the outputs publishing coordinates.
+   */
+  cv::Rect toNative(const cv::Rect & rect) const;
+  cv::Point toNative(const cv::Point & point) const;
+  /**
+   * @brief Publish a message by handing it over: intra-process subscriptions
+   * (e.g. a composable node in the same container, with use_intra_process_comms)
+   * get it without a copy, and a middleware which can loan messages gets it
+   * in its own memory.
+   */
+  template<typename T>
+  static void publishMessage(
+    const std::shared_ptr<rclcpp::Publisher<T>> & publisher, std::unique_ptr<T> message)
+  {
+#ifdef DYNAMIC_VINO_LIB_LOANED_MESSAGES
+    if (publisher->can_loan_messages()) {
+      auto loaned = publisher->borrow_loaned_message();
+      loaned.get() = std::move(*message);
+      publisher->publish(std::move(loaned));
+      return;
+    }
+#endif
+    publisher->publish(std::move(message));
+  }
+
+  /**< the fed frame, shared and read only >**/
   cv::Mat frame_;
   Pipeline * pipeline_;
+  std_msgs::msg::Header header_;
+  bool has_header_ = false;
+  FrameTimes times_;
+  bool has_times_ = false;
+  float scale_ = 1;
+  bool has_scale_ = false;
   std::string output_name_;
+  OutputRateGate rate_gate_;
+  bool skipping_ = false;
+  int result_age_ = 0;
 };
 }  // namespace Outputs
 #endif  // DYNAMIC_VINO_LIB__OUTPUTS__BASE_OUTPUT_HPP_
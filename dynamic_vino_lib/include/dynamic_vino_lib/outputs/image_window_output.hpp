@@ -20,15 +20,18 @@
 #ifndef DYNAMIC_VINO_LIB__OUTPUTS__IMAGE_WINDOW_OUTPUT_HPP_
 #define DYNAMIC_VINO_LIB__OUTPUTS__IMAGE_WINDOW_OUTPUT_HPP_
 
-#include <vector>
+#include <memory>
 #include <string>
+#include <vector>
 #include "dynamic_vino_lib/outputs/base_output.hpp"
+#include "dynamic_vino_lib/outputs/overlay_renderer.hpp"
 
 namespace Outputs
 {
 /**
  * @class ImageWindowOutput
- * @brief This class handles and shows the detection result with image window.
+ * @brief This class shows the frames decorated by an OverlayRenderer in a
+ * HighGUI window.
  */
 class ImageWindowOutput : public BaseOutput
 {
@@ -36,141 +39,85 @@ public:
   explicit ImageWindowOutput(const std::string & output_name, int focal_length = 950);
 
   /**
-   * @brief Calculate the camera matrix of a frame for image
-   * window output.
+   * @brief Set the frame the results are drawn on.
    * @param[in] A frame.
    */
   void feedFrame(const cv::Mat &) override;
-
   /**
-   * @brief Decorate frame according to detection result
+   * @brief Drop the contents generated for the current frame without drawing them.
    */
-  void decorateFrame();
+  void clearData() override;
   /**
    * @brief Show the decorated frame with image window
    */
   void handleOutput() override;
   /**
-   * @brief Generate image window output content according to
-   * the license plate detection result.
-   * @param[in] A license plate detection result objetc.
+   * @brief Show the frames resized by this factor, the results drawn on the resized frames.
    */
+  void setPreviewScale(float scale)
+  {
+    renderer_.setScale(scale);
+  }
+
   void accept(
-    const std::vector<dynamic_vino_lib::LicensePlateDetectionResult> &) override;
-  /**
-   * @brief Generate image window output content according to
-   * the vehicle attributes detection result.
-   * @param[in] A vehicle attributes detection result objetc.
-   */
+    const std::vector<dynamic_vino_lib::LicensePlateDetectionResult> & results) override
+  {
+    renderer_.accept(results);
+  }
   void accept(
-    const std::vector<dynamic_vino_lib::VehicleAttribsDetectionResult> &) override;
-  /**
-   * @brief Generate image window output content according to
-   * the face reidentification result.
-   * @param[in] A face reidentification result objetc.
-   */
+    const std::vector<dynamic_vino_lib::VehicleAttribsDetectionResult> & results) override
+  {
+    renderer_.accept(results);
+  }
   void accept(
-    const std::vector<dynamic_vino_lib::FaceReidentificationResult> &) override;
-  /**
-   * @brief Generate image window output content according to
-   * the landmarks detection result.
-   * @param[in] A landmarks detection result objetc.
-   */
+    const std::vector<dynamic_vino_lib::FaceReidentificationResult> & results) override
+  {
+    renderer_.accept(results);
+  }
   void accept(
-    const std::vector<dynamic_vino_lib::LandmarksDetectionResult> &) override;
-  /**
-   * @brief Generate image window output content according to
-   * the person attributes detection result.
-   * @param[in] A person attributes detection result objetc.
-   */
+    const std::vector<dynamic_vino_lib::LandmarksDetectionResult> & results) override
+  {
+    renderer_.accept(results);
+  }
   void accept(
-    const std::vector<dynamic_vino_lib::PersonAttribsDetectionResult> &) override;
-  /**
-   * @brief Generate image window output content according to
-   * the person reidentification result.
-   * @param[in] A person reidentification result objetc.
-   */
+    const std::vector<dynamic_vino_lib::PersonAttribsDetectionResult> & results) override
+  {
+    renderer_.accept(results);
+  }
   void accept(
-    const std::vector<dynamic_vino_lib::PersonReidentificationResult> &) override;
-  /**
-   * @brief Generate image window output content according to
-   * the object segmentation result.
-   * @param[in] An obejct segmentation result objetc.
-   */
-  void accept(const std::vector<dynamic_vino_lib::ObjectSegmentationResult> &) override;
-  /**
-   * @brief Generate image window output content according to
-   * the face detection result.
-   * @param[in] A face detection result objetc.
-   */
-  void accept(const std::vector<dynamic_vino_lib::FaceDetectionResult> &) override;
-  /**
-   * @brief Generate image window output content according to
-   * the object detection result.
-   * @param[in] results A bundle of object detection results.
-   */
-  void accept(const std::vector<dynamic_vino_lib::ObjectDetectionResult> &) override;
-  /**
-   * @brief Generate image window output content according to
-   * the emotion detection result.
-   * @param[in] A emotion detection result objetc.
-   */
-  void accept(const std::vector<dynamic_vino_lib::EmotionsResult> &) override;
-  /**
-   * @brief Generate image window output content according to
-   * the age and gender detection result.
-   * @param[in] A head pose detection result objetc.
-   */
-  void accept(const std::vector<dynamic_vino_lib::HeadPoseResult> &) override;
-  /**
-   * @brief Generate image window output content according to
-   * the headpose detection result.
-   * @param[in] An age gender detection result objetc.
-   */
-  void accept(const std::vector<dynamic_vino_lib::AgeGenderResult> &) override;
-
-private:
-  unsigned findOutput(const cv::Rect &);
-  /**
-   * @brief Calculate the axises of the coordinates for showing
-   * the image window.
-   */
-  cv::Point calcAxis(cv::Mat r, double cx, double cy, double cz, cv::Point cp);
-  /**
-   * @brief Calculte the rotation transform from the rotation pose.
-   * @param[in] yaw Yaw rotation value.
-   * @param[in] pitch Pitch rotation value.
-   * @param[in] roll Roll rotation value.
-   */
-  cv::Mat getRotationTransform(double yaw, double pitch, double roll);
-
-  void mergeMask(const std::vector<dynamic_vino_lib::ObjectSegmentationResult> &);
-
-  struct OutputData
+    const std::vector<dynamic_vino_lib::PersonReidentificationResult> & results) override
+  {
+    renderer_.accept(results);
+  }
+  void accept(
+    const std::vector<dynamic_vino_lib::ObjectSegmentationResult> & results) override
   {
-    std::string desc;
-    cv::Rect rect;
-    cv::Scalar scalar;
-    cv::Point hp_cp;  // for headpose, center point
-    cv::Point hp_x;   // for headpose, end point of xAxis
-    cv::Point hp_y;   // for headpose, end point of yAxis
-    cv::Point hp_zs;  // for headpose, start point of zAxis
-    cv::Point hp_ze;  // for headpose, end point of zAxis
-    cv::Point pa_top; // for person attributes, top position
-    cv::Point pa_bottom; //for person attributes, bottom position
-    std::vector<cv::Point> landmarks;
-  };
+    renderer_.accept(results);
+  }
+  void accept(const std::vector<dynamic_vino_lib::FaceDetectionResult> & results) override
+  {
+    renderer_.accept(results);
+  }
+  void accept(const std::vector<dynamic_vino_lib::ObjectDetectionResult> & results) override
+  {
+    renderer_.accept(results);
+  }
+  void accept(const std::vector<dynamic_vino_lib::EmotionsResult> & results) override
+  {
+    renderer_.accept(results);
+  }
+  void accept(const std::vector<dynamic_vino_lib::HeadPoseResult> & results) override
+  {
+    renderer_.accept(results);
+  }
+  void accept(const std::vector<dynamic_vino_lib::AgeGenderResult> & results) override
+  {
+    renderer_.accept(results);
+  }
 
-  std::vector<OutputData> outputs_;
-  float focal_length_;
-  cv::Mat camera_matrix_;
-  std::vector<std::vector<int>> colors_ = {
-    {128, 64, 128}, {232, 35, 244}, {70, 70, 70}, {156, 102, 102}, {153, 153, 190},
-    {153, 153, 153}, {30, 170, 250}, {0, 220, 220}, {35, 142, 107}, {152, 251, 152},
-    {180, 130, 70}, {60, 20, 220}, {0, 0, 255}, {142, 0, 0}, {70, 0, 0},
-    {100, 60, 0}, {90, 0, 0}, {230, 0, 0}, {32, 11, 119}, {0, 74, 111},
-    {81, 0, 81}
-  };
+private:
+  OverlayRenderer renderer_;
+  bool window_created_ = false;
 };
 }  // namespace Outputs
 #endif  // DYNAMIC_VINO_LIB__OUTPUTS__IMAGE_WINDOW_OUTPUT_HPP_
@@ -0,0 +1,115 @@
+// Copyright (c) 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @brief A header file with declaration for the rate limit of an output
+ * @file output_rate.hpp
+ */
+#ifndef DYNAMIC_VINO_LIB__OUTPUTS__OUTPUT_RATE_HPP_
+#define DYNAMIC_VINO_LIB__OUTPUTS__OUTPUT_RATE_HPP_
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+
+namespace Outputs
+{
+/**
+ * @brief Which of the frames an output (or a topic of it) handles.
+ */
+struct OutputRate
+{
+  /**< frames handled per second at most, 0 for no bound >**/
+  float max_hz = 0;
+  /**< one of every that many frames is handled >**/
+  int every_n = 1;
+  /**< for result topics, only publish the results differing from the last published ones >**/
+  bool on_change = false;
+
+  bool isLimited() const
+  {
+    return max_hz > 0 || every_n > 1 || on_change;
+  }
+
+  /**
+   * @brief Parse a rate from comma separated terms: "<hz>hz" (e.g. "5hz"),
+   * "1/<n>" (e.g. "1/3") and "on_change", as in "1/2,10hz".
+   */
+  static OutputRate parse(const std::string & spec)
+  {
+    OutputRate rate;
+    std::stringstream terms(spec);
+    std::string term;
+    while (std::getline(terms, term, ',')) {
+      term.erase(0, term.find_first_not_of(' '));
+      term.erase(term.find_last_not_of(' ') + 1);
+      if (term == "on_change") {
+        rate.on_change = true;
+      } else if (term.compare(0, 2, "1/") == 0) {
+        rate.every_n = std::max(1, std::atoi(term.c_str() + 2));
+      } else if (term.size() > 2 && term.compare(term.size() - 2, 2, "hz") == 0) {
+        rate.max_hz = std::max(0.0f, static_cast<float>(std::atof(term.c_str())));
+      }
+    }
+    return rate;
+  }
+};
+
+/**
+ * @class OutputRateGate
+ * @brief Tells, frame after frame, the ones handled under an OutputRate.
+ */
+class OutputRateGate
+{
+public:
+  using Clock = std::chrono::steady_clock;
+
+  void setRate(const OutputRate & rate)
+  {
+    rate_ = rate;
+    frames_ = 0;
+    handled_ = false;
+  }
+  const OutputRate & getRate() const
+  {
+    return rate_;
+  }
+  /**
+   * @brief Whether the next frame is handled, counting it.
+   */
+  bool isDue(Clock::time_point now = Clock::now())
+  {
+    if (rate_.every_n > 1 && frames_++ % rate_.every_n != 0) {
+      return false;
+    }
+    if (rate_.max_hz > 0 && handled_ &&
+      now - last_handled_ < std::chrono::duration<double>(1.0 / rate_.max_hz))
+    {
+      return false;
+    }
+    handled_ = true;
+    last_handled_ = now;
+    return true;
+  }
+
+private:
+  OutputRate rate_;
+  uint64_t frames_ = 0;
+  bool handled_ = false;
+  Clock::time_point last_handled_;
+};
+}  // namespace Outputs
+#endif  // DYNAMIC_VINO_LIB__OUTPUTS__OUTPUT_RATE_HPP_
@@ -0,0 +1,193 @@
+// Copyright (c) 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+* @brief A header file with declaration for OverlayRenderer Class
+* @file overlay_renderer.hpp
+*/
+
+#ifndef DYNAMIC_VINO_LIB__OUTPUTS__OVERLAY_RENDERER_HPP_
+#define DYNAMIC_VINO_LIB__OUTPUTS__OVERLAY_RENDERER_HPP_
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "dynamic_vino_lib/inferences/age_gender_detection.hpp"
+#include "dynamic_vino_lib/inferences/emotions_detection.hpp"
+#include "dynamic_vino_lib/inferences/face_detection.hpp"
+#include "dynamic_vino_lib/inferences/face_reidentification.hpp"
+#include "dynamic_vino_lib/inferences/head_pose_detection.hpp"
+#include "dynamic_vino_lib/inferences/landmarks_detection.hpp"
+#include "dynamic_vino_lib/inferences/license_plate_detection.hpp"
+#include "dynamic_vino_lib/inferences/object_detection.hpp"
+#include "dynamic_vino_lib/inferences/object_segmentation.hpp"
+#include "dynamic_vino_lib/inferences/person_attribs_detection.hpp"
+#include "dynamic_vino_lib/inferences/person_reidentification.hpp"
+#include "dynamic_vino_lib/inferences/vehicle_attribs_detection.hpp"
+#include "opencv2/opencv.hpp"
+
+class Pipeline;
+
+namespace Outputs
+{
+/**
+ * @class OverlayRenderer
+ * @brief This class draws the detection results of a frame on a copy of it,
+ * optionally downscaled, for the outputs showing, publishing or recording the
+ * decorated frames. It has no display of its own.
+ */
+class OverlayRenderer
+{
+public:
+  explicit OverlayRenderer(int focal_length = 950);
+
+  /**
+   * @brief Set the frame the results are drawn on.
+   */
+  void feedFrame(const cv::Mat &);
+  /**
+   * @brief Draw on the frame resized by this factor, so that a downscaled
+   * image is drawn directly instead of being drawn then resized.
+   */
+  void setScale(float scale)
+  {
+    scale_ = scale > 0 ? scale : 1;
+  }
+  /**
+   * @brief Draw the results accepted since the frame was fed.
+   * @param[in] pipeline The pipeline whose FPS is drawn, if it asks for it.
+   */
+  void render(Pipeline * pipeline);
+  /**
+   * @brief Get the frame drawn on. The fed frame is copied (or resized) the
+   * first time it is drawn on after being fed, so that it is only copied when rendered.
+   */
+  cv::Mat & getCanvas();
+  /**
+   * @brief Drop the contents generated for the current frame without drawing them.
+   */
+  void clearData();
+
+  void accept(const std::vector<dynamic_vino_lib::LicensePlateDetectionResult> &);
+  void accept(const std::vector<dynamic_vino_lib::VehicleAttribsDetectionResult> &);
+  void accept(const std::vector<dynamic_vino_lib::FaceReidentificationResult> &);
+  void accept(const std::vector<dynamic_vino_lib::LandmarksDetectionResult> &);
+  void accept(const std::vector<dynamic_vino_lib::PersonAttribsDetectionResult> &);
+  void accept(const std::vector<dynamic_vino_lib::PersonReidentificationResult> &);
+  void accept(const std::vector<dynamic_vino_lib::ObjectSegmentationResult> &);
+  void accept(const std::vector<dynamic_vino_lib::FaceDetectionResult> &);
+  void accept(const std::vector<dynamic_vino_lib::ObjectDetectionResult> &);
+  void accept(const std::vector<dynamic_vino_lib::EmotionsResult> &);
+  void accept(const std::vector<dynamic_vino_lib::HeadPoseResult> &);
+  void accept(const std::vector<dynamic_vino_lib::AgeGenderResult> &);
+
+private:
+  /**
+   * @brief Get the index of the overlay entry of a ROI, the results of all the
+   * inferences on the same ROI are drawn together.
+   */
+  unsigned findOutput(const cv::Rect &);
+  /**
+   * @brief Calculate the axises of the coordinates for showing
+   * the image window.
+   */
+  cv::Point calcAxis(cv::Mat r, double cx, double cy, double cz, cv::Point cp);
+  /**
+   * @brief Calculte the rotation transform from the rotation pose.
+   * @param[in] yaw Yaw rotation value.
+   * @param[in] pitch Pitch rotation value.
+   * @param[in] roll Roll rotation value.
+   */
+  cv::Mat getRotationTransform(double yaw, double pitch, double roll);
+
+  /**
+   * @brief Blend the segmentation mask of the frame over the canvas.
+   */
+  void mergeMask(cv::Mat & canvas);
+  /**
+   * @brief Blend the mask of each instance over its box on the canvas.
+   */
+  void mergeInstanceMasks(cv::Mat & canvas);
+  /**
+   * @brief Map a point of the frame to the canvas.
+   */
+  cv::Point toCanvas(const cv::Point & point) const
+  {
+    return cv::Point(cvRound(point.x * scale_), cvRound(point.y * scale_));
+  }
+
+  /**
+   * @brief A piece of the description of a ROI, formatted when drawn.
+   */
+  struct DescTag
+  {
+    enum Kind {Text, Confidence, Age, TrackId};
+    Kind kind;
+    float value;
+    std::string text;
+  };
+
+  struct OutputData
+  {
+    std::vector<DescTag> tags;
+    cv::Rect rect;
+    cv::Scalar scalar;
+    cv::Point hp_cp;  // for headpose, center point
+    cv::Point hp_x;   // for headpose, end point of xAxis
+    cv::Point hp_y;   // for headpose, end point of yAxis
+    cv::Point hp_zs;  // for headpose, start point of zAxis
+    cv::Point hp_ze;  // for headpose, end point of zAxis
+    cv::Point pa_top; // for person attributes, top position
+    cv::Point pa_bottom; //for person attributes, bottom position
+    std::vector<cv::Point> landmarks;
+  };
+
+  static std::string describe(const OutputData &);
+
+  struct RectHash
+  {
+    size_t operator()(const cv::Rect & rect) const
+    {
+      uint64_t key = (static_cast<uint64_t>(static_cast<uint16_t>(rect.x)) << 48) |
+        (static_cast<uint64_t>(static_cast<uint16_t>(rect.y)) << 32) |
+        (static_cast<uint64_t>(static_cast<uint16_t>(rect.width)) << 16) |
+        static_cast<uint16_t>(rect.height);
+      return std::hash<uint64_t>()(key);
+    }
+  };
+
+  std::vector<OutputData> outputs_;
+  std::unordered_map<cv::Rect, unsigned, RectHash> output_index_;
+  float focal_length_;
+  float scale_ = 1;
+  cv::Mat camera_matrix_;
+  cv::Mat frame_;
+  cv::Mat canvas_;
+  /**< the segmentation mask of the frame, at the resolution of the network output >**/
+  cv::Mat colored_mask_;
+  /**< the segmentation mask upscaled to the canvas, reused across frames >**/
+  cv::Mat mask_;
+  struct InstanceMask
+  {
+    cv::Rect rect;
+    /**< the colored crop of the box, and where the object is in it >**/
+    cv::Mat colored;
+    cv::Mat object;
+  };
+  std::vector<InstanceMask> instance_masks_;
+};
+}  // namespace Outputs
+#endif  // DYNAMIC_VINO_LIB__OUTPUTS__OVERLAY_RENDERER_HPP_
@@ -0,0 +1,258 @@
+// Copyright (c) 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @brief A header file with the layout of the columnar result log files, and a
+ * reader mapping them for the offline analysis tools. It only depends on the
+ * C++ and POSIX libraries, so that a tool includes it alone.
+ * @file result_log.hpp
+ */
+
+#ifndef DYNAMIC_VINO_LIB__OUTPUTS__RESULT_LOG_HPP_
+#define DYNAMIC_VINO_LIB__OUTPUTS__RESULT_LOG_HPP_
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cstdint>
+#include <string>
+
+namespace Outputs
+{
+namespace ResultLog
+{
+const uint32_t kMagic = 0x4c52564f;  // "OVRL"
+const uint32_t kBatchMagic = 0x4252564f;  // "OVRB"
+const uint32_t kVersion = 1;
+
+/**
+ * @brief The result a row comes from.
+ */
+enum RowKind : uint32_t
+{
+  kKindObject = 0,
+  kKindFace = 1,
+  kKindAgeGender = 2,
+  kKindEmotion = 3,
+  kKindHeadPose = 4,
+  kKindLandmarks = 5,
+  kKindFaceReidentification = 6,
+  kKindPersonReidentification = 7,
+  kKindPersonAttributes = 8,
+  kKindVehicleAttributes = 9,
+  kKindLicensePlate = 10,
+  kKindSegmentation = 11,
+};
+
+/**
+ * @brief At the start of the file, followed by the batches.
+ */
+struct FileHeader
+{
+  uint32_t magic;
+  uint32_t version;
+  uint64_t reserved;
+};
+
+/**
+ * @brief At the start of each batch, followed by its columns of 'rows'
+ * values, in the order of Batch, each one starting on 8 bytes.
+ */
+struct BatchHeader
+{
+  uint32_t magic;
+  uint32_t rows;
+  /**< the frames handled while the batch was filled, with or without results >**/
+  uint64_t frames;
+  /**< the bytes of the batch after this header >**/
+  uint64_t bytes;
+  /**< the bytes of the attribute texts >**/
+  uint64_t text_bytes;
+};
+
+inline uint64_t align(uint64_t bytes)
+{
+  return (bytes + 7) / 8 * 8;
+}
+
+/**
+ * @brief Get the bytes of the columns of a batch after its header.
+ */
+inline uint64_t getBatchBytes(uint64_t rows, uint64_t text_bytes)
+{
+  return align(rows * 8) * 2 +  // frame, stamp_ns
+         align(rows * 4) * 8 +  // kind, x, y, width, height, label_id, confidence, track_id
+         align((rows + 1) * 4) +  // text_offsets
+         align(text_bytes);
+}
+
+/**
+ * @brief The columns of a batch, pointing into the mapped file. Row i of the
+ * batch is made of the i-th value of every column.
+ */
+struct Batch
+{
+  uint32_t rows = 0;
+  uint64_t frames = 0;
+  /**< the index of the frame in the log, counted from 0 >**/
+  const uint64_t * frame = nullptr;
+  /**< the stamp of the frame, in nanoseconds >**/
+  const int64_t * stamp_ns = nullptr;
+  const uint32_t * kind = nullptr;
+  /**< the box, in pixels of the native frame of the input >**/
+  const float * x = nullptr;
+  const float * y = nullptr;
+  const float * width = nullptr;
+  const float * height = nullptr;
+  /**< the id of the label in the label file of the model, -1 if none >**/
+  const int32_t * label_id = nullptr;
+  /**< 1 for the results without a confidence >**/
+  const float * confidence = nullptr;
+  /**< -1 if not tracked >**/
+  const int32_t * track_id = nullptr;
+  /**< the text of row i is text[text_offsets[i]] to text[text_offsets[i + 1]] >**/
+  const uint32_t * text_offsets = nullptr;
+  const char * text = nullptr;
+
+  /**
+   * @brief Get the attributes of a row as text, e.g. the label of a detection,
+   * "age=31.5;male=0.92" or the plate number.
+   */
+  std::string getText(uint32_t row) const
+  {
+    return std::string(text + text_offsets[row], text_offsets[row + 1] - text_offsets[row]);
+  }
+};
+
+/**
+ * @class Reader
+ * @brief Maps a result log file and walks its batches without copying them.
+ * A batch cut short by a writer which did not finish it ends the log.
+ */
+class Reader
+{
+public:
+  Reader() = default;
+  Reader(const Reader &) = delete;
+  Reader & operator=(const Reader &) = delete;
+  ~Reader()
+  {
+    close();
+  }
+
+  /**
+   * @return False if the file can't be mapped or is not a result log.
+   */
+  bool open(const std::string & path)
+  {
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || static_cast<uint64_t>(info.st_size) < sizeof(FileHeader)) {
+      ::close(fd);
+      return false;
+    }
+    void * base = mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (base == MAP_FAILED) {
+      return false;
+    }
+    base_ = static_cast<const uint8_t *>(base);
+    size_ = info.st_size;
+    auto header = reinterpret_cast<const FileHeader *>(base_);
+    if (header->magic != kMagic || header->version != kVersion) {
+      close();
+      return false;
+    }
+    rewind();
+    return true;
+  }
+
+  void close()
+  {
+    if (base_ != nullptr) {
+      munmap(const_cast<uint8_t *>(base_), size_);
+      base_ = nullptr;
+    }
+  }
+
+  bool isOpened() const
+  {
+    return base_ != nullptr;
+  }
+
+  /**
+   * @brief Go back to the first batch.
+   */
+  void rewind()
+  {
+    offset_ = sizeof(FileHeader);
+  }
+
+  /**
+   * @brief Get the next batch of the log.
+   * @return False at the end of the log.
+   */
+  bool next(Batch & batch)
+  {
+    if (base_ == nullptr || offset_ + sizeof(BatchHeader) > size_) {
+      return false;
+    }
+    auto header = reinterpret_cast<const BatchHeader *>(base_ + offset_);
+    if (header->magic != kBatchMagic ||
+      header->bytes != getBatchBytes(header->rows, header->text_bytes) ||
+      offset_ + sizeof(BatchHeader) + header->bytes > size_)
+    {
+      return false;
+    }
+    const uint8_t * column = base_ + offset_ + sizeof(BatchHeader);
+    const uint64_t rows = header->rows;
+    batch.rows = header->rows;
+    batch.frames = header->frames;
+    batch.frame = take<uint64_t>(column, rows);
+    batch.stamp_ns = take<int64_t>(column, rows);
+    batch.kind = take<uint32_t>(column, rows);
+    batch.x = take<float>(column, rows);
+    batch.y = take<float>(column, rows);
+    batch.width = take<float>(column, rows);
+    batch.height = take<float>(column, rows);
+    batch.label_id = take<int32_t>(column, rows);
+    batch.confidence = take<float>(column, rows);
+    batch.track_id = take<int32_t>(column, rows);
+    batch.text_offsets = take<uint32_t>(column, rows + 1);
+    batch.text = reinterpret_cast<const char *>(column);
+    offset_ += sizeof(BatchHeader) + header->bytes;
+    return true;
+  }
+
+private:
+  template<typename T>
+  static const T * take(const uint8_t * & column, uint64_t count)
+  {
+    auto values = reinterpret_cast<const T *>(column);
+    column += align(count * sizeof(T));
+    return values;
+  }
+
+  const uint8_t * base_ = nullptr;
+  uint64_t size_ = 0;
+  uint64_t offset_ = 0;
+};
+}  // namespace ResultLog
+}  // namespace Outputs
+#endif  // DYNAMIC_VINO_LIB__OUTPUTS__RESULT_LOG_HPP_
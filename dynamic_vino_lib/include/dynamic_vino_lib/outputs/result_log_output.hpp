@@ -0,0 +1,157 @@
+// Copyright (c) 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @brief A header file with declaration for ResultLogOutput Class
+ * @file result_log_output.hpp
+ */
+
+#ifndef DYNAMIC_VINO_LIB__OUTPUTS__RESULT_LOG_OUTPUT_HPP_
+#define DYNAMIC_VINO_LIB__OUTPUTS__RESULT_LOG_OUTPUT_HPP_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "dynamic_vino_lib/outputs/base_output.hpp"
+#include "dynamic_vino_lib/outputs/result_log.hpp"
+
+namespace Outputs
+{
+/**
+ * @class ResultLogOutput
+ * @brief This class appends the results of each frame, one row per result,
+ * to a columnar binary log file (see result_log.hpp) for the offline analysis.
+ * The rows are gathered into batches, written by a worker thread.
+ */
+class ResultLogOutput : public BaseOutput
+{
+public:
+  explicit ResultLogOutput(const std::string & output_name);
+  ~ResultLogOutput() override;
+
+  /**
+   * @brief Set where and how often the batches are written.
+   * @param[in] directory The directory the log file is written to.
+   * @param[in] batch_rows The rows of a batch, written once reached.
+   * @param[in] flush The seconds a batch is written after at most, 0 for no bound.
+   */
+  void setLogging(const std::string & directory, int batch_rows, float flush);
+
+  bool needsFrame() const override
+  {
+    return false;
+  }
+  /**
+   * @brief Stamp the rows of the frame, and hand the batch over to the worker
+   * once full.
+   */
+  void handleOutput() override;
+  void clearData() override;
+
+  void accept(const std::vector<dynamic_vino_lib::LicensePlateDetectionResult> &) override;
+  void accept(const std::vector<dynamic_vino_lib::VehicleAttribsDetectionResult> &) override;
+  void accept(const std::vector<dynamic_vino_lib::FaceReidentificationResult> &) override;
+  void accept(const std::vector<dynamic_vino_lib::LandmarksDetectionResult> &) override;
+  void accept(const std::vector<dynamic_vino_lib::PersonAttribsDetectionResult> &) override;
+  void accept(const std::vector<dynamic_vino_lib::PersonReidentificationResult> &) override;
+  void accept(const std::vector<dynamic_vino_lib::ObjectSegmentationResult> &) override;
+  void accept(const std::vector<dynamic_vino_lib::ObjectDetectionResult> &) override;
+  void accept(const std::vector<dynamic_vino_lib::FaceDetectionResult> &) override;
+  void accept(const std::vector<dynamic_vino_lib::EmotionsResult> &) override;
+  void accept(const std::vector<dynamic_vino_lib::AgeGenderResult> &) override;
+  void accept(const std::vector<dynamic_vino_lib::HeadPoseResult> &) override;
+
+  size_t getQueueDepth() override
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    return queue_.size();
+  }
+
+private:
+  using Clock = std::chrono::steady_clock;
+  /**
+   * @brief The columns of a batch being filled, see ResultLog::Batch.
+   */
+  struct Columns
+  {
+    uint64_t frames = 0;
+    std::vector<uint64_t> frame;
+    std::vector<int64_t> stamp_ns;
+    std::vector<uint32_t> kind;
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> width;
+    std::vector<float> height;
+    std::vector<int32_t> label_id;
+    std::vector<float> confidence;
+    std::vector<int32_t> track_id;
+    std::vector<uint32_t> text_offsets{0};
+    std::string text;
+
+    size_t size() const
+    {
+      return kind.size();
+    }
+    void reserve(size_t rows);
+    /**
+     * @brief Drop the rows from 'rows' on.
+     */
+    void truncate(size_t rows);
+  };
+
+  void addRow(
+    ResultLog::RowKind kind, const cv::Rect & location, int label_id, float confidence,
+    int track_id, const std::string & text);
+  template<typename T>
+  void addDetections(const std::vector<T> & results, ResultLog::RowKind kind)
+  {
+    for (auto & r : results) {
+      addRow(kind, r.getLocation(), r.getLabelId(), r.getConfidence(), r.getTrackId(),
+        r.getLabel());
+    }
+  }
+  void push();
+  void run();
+  bool openFile();
+  bool writeBatch(const Columns & columns);
+
+  std::string directory_ = ".";
+  size_t batch_rows_ = 4096;
+  Clock::duration flush_{std::chrono::seconds(1)};
+  Clock::time_point batch_start_;
+  Columns columns_;
+  /**< the rows of the current frame start here in columns_ >**/
+  size_t frame_rows_ = 0;
+  uint64_t frame_index_ = 0;
+
+  // owned by the worker
+  FILE * file_ = nullptr;
+  bool failed_ = false;
+
+  std::deque<Columns> queue_;
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  bool stopped_ = false;
+  std::thread worker_;
+};
+}  // namespace Outputs
+#endif  // DYNAMIC_VINO_LIB__OUTPUTS__RESULT_LOG_OUTPUT_HPP_
@@ -0,0 +1,140 @@
+// Copyright (c) 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @brief A header file with declaration for RosAggregateOutput Class
+ * @file ros_aggregate_output.hpp
+ */
+
+#ifndef DYNAMIC_VINO_LIB__OUTPUTS__ROS_AGGREGATE_OUTPUT_HPP_
+#define DYNAMIC_VINO_LIB__OUTPUTS__ROS_AGGREGATE_OUTPUT_HPP_
+
+#include <people_msgs/msg/frame_results.hpp>
+#include <people_msgs/msg/frame_results_array.hpp>
+#include <people_msgs/msg/roi_results.hpp>
+#include <rclcpp/rclcpp.hpp>
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "dynamic_vino_lib/outputs/ros_topic_output.hpp"
+
+namespace Outputs
+{
+/**
+ * @class FrameResultsMerge
+ * @brief Puts the frame results of the lanes of a segmented video (see
+ * Input::Video) back into the order of the video. The position of a frame is
+ * the suffix of its frame id, "<file>#<position>".
+ */
+class FrameResultsMerge
+{
+public:
+  using FrameResultsPtr = std::unique_ptr<people_msgs::msg::FrameResults>;
+  /**
+   * @brief Hold the results of a frame, and give back the held ones which
+   * follow the last given, in order.
+   */
+  void add(FrameResultsPtr frame_results, std::vector<FrameResultsPtr> & ready);
+  /**
+   * @brief Give back all the held results in order, e.g. once the video is
+   * processed and the segments left gaps (skipped or failed frames).
+   */
+  void flush(std::vector<FrameResultsPtr> & ready);
+
+private:
+  std::mutex mutex_;
+  std::map<uint64_t, FrameResultsPtr> held_;
+  uint64_t next_ = 0;
+};
+
+/**
+ * @class RosAggregateOutput
+ * @brief This class publishes all the results of a frame in one message, joined
+ * by region of interest, on /openvino_toolkit/<name>/frame_results. Optionally
+ * the messages of several frames are batched together, for offline processing,
+ * on /openvino_toolkit/<name>/frame_results_array.
+ */
+class RosAggregateOutput : public RosTopicOutput
+{
+public:
+  /**
+   * @param[in] batch_frames The frames per message, 1 for a message per frame.
+   */
+  RosAggregateOutput(
+    std::string output_name, const rclcpp::Node::SharedPtr node = nullptr,
+    int batch_frames = 1);
+  ~RosAggregateOutput() override;
+  /**
+   * @brief Publish the frames in the order given by a merge shared with the
+   * outputs of the other lanes of the input.
+   */
+  void setMerge(std::shared_ptr<FrameResultsMerge> merge)
+  {
+    merge_ = merge;
+  }
+
+  using RosTopicOutput::accept;
+  /**
+   * @brief Build the detections, and keep the positions of their regions.
+   */
+  void accept(const std::vector<dynamic_vino_lib::ObjectDetectionResult> &) override;
+  void accept(const std::vector<dynamic_vino_lib::FaceDetectionResult> &) override;
+  /**
+   * @brief Publish the results of the frame joined together.
+   */
+  void handleOutput() override;
+
+protected:
+  /**
+   * @brief The results are published together, not on their own topics.
+   */
+  bool publishesTopics() const override
+  {
+    return false;
+  }
+
+private:
+  using RoiKey = std::tuple<uint32_t, uint32_t, uint32_t, uint32_t>;
+  people_msgs::msg::RoiResults & getRoiResults(
+    const sensor_msgs::msg::RegionOfInterest & roi);
+  void publishFrame(std::unique_ptr<people_msgs::msg::FrameResults> frame_results);
+  void publishBatch();
+  template<typename T>
+  void keepPositions(const std::vector<T> & results)
+  {
+    for (auto & result : results) {
+      if (result.hasPosition()) {
+        positions_.emplace_back(toNative(result.getLocation()), result.getPosition());
+      }
+    }
+  }
+
+  size_t batch_frames_;
+  rclcpp::Publisher<people_msgs::msg::FrameResults>::SharedPtr pub_frame_results_;
+  rclcpp::Publisher<people_msgs::msg::FrameResultsArray>::SharedPtr pub_frame_results_array_;
+  std::unique_ptr<people_msgs::msg::FrameResults> frame_results_;
+  std::map<RoiKey, size_t> roi_index_;
+  /**< the positions of the detections of the frame, by their regions >**/
+  std::vector<std::pair<cv::Rect, cv::Point3f>> positions_;
+  std::unique_ptr<people_msgs::msg::FrameResultsArray> batch_;
+  std::shared_ptr<FrameResultsMerge> merge_;
+};
+}  // namespace Outputs
+#endif  // DYNAMIC_VINO_LIB__OUTPUTS__ROS_AGGREGATE_OUTPUT_HPP_
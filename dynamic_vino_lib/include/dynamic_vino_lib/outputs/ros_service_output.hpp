@@ -65,6 +65,15 @@ public:
   void setServiceResponse(std::shared_ptr<people_msgs::srv::HeadPoseSrv::Response> response);
   void setServiceResponse(std::shared_ptr<people_msgs::srv::People::Response> response);
 
+protected:
+  /**
+   * @brief The messages answer the service calls, they are always built.
+   */
+  bool publishesTopics() const override
+  {
+    return false;
+  }
+
 private:
   const std::string service_name_;
 };
@@ -41,9 +41,11 @@
 #include <people_msgs/msg/vehicle_attribs_stamped.hpp>
 #include <people_msgs/msg/license_plate.hpp>
 #include <people_msgs/msg/license_plate_stamped.hpp>
+#include <people_msgs/msg/frame_latency.hpp>
 #include <rclcpp/rclcpp.hpp>
 #include <std_msgs/msg/header.hpp>
 
+#include <map>
 #include <memory>
 #include <string>
 #include <vector>
@@ -67,11 +69,39 @@ public:
    * @param[in] A frame.
    */
   void feedFrame(const cv::Mat &) override;
+  /**
+   * @brief The results are published without the frame.
+   */
+  bool needsFrame() const override
+  {
+    return false;
+  }
   /**
    * @brief Publish all the detected infomations generated by the accept
    * functions with ros topic.
    */
   void handleOutput() override;
+  /**
+   * @brief Set which of the frames are published on a topic of the output,
+   * e.g. "faces", on top of the rate of the output itself.
+   */
+  void setTopicRate(const std::string & topic, const OutputRate & rate);
+  /**
+   * @brief Set how the segmentation masks are published.
+   * @param[in] encoding "raw" for mask_array, or "rle" for run-length encoded
+   * class ids, as changes from the previous masks in between keyframes.
+   * @param[in] keyframe_interval The messages from a keyframe to the next one,
+   * 1 for keyframes only.
+   */
+  void setMaskEncoding(const std::string & encoding, int keyframe_interval);
+  /**
+   * @brief Set whether the times each frame went through the pipeline at are
+   * published, on /openvino_toolkit/<name>/latency, after its results.
+   */
+  void setLatencyTopic(bool enabled)
+  {
+    latency_topic_ = enabled;
+  }
   /**
    * @brief Generate ros topic infomation according to
    * the license plate detection result.
@@ -146,32 +176,119 @@ public:
   void accept(const std::vector<dynamic_vino_lib::HeadPoseResult> &) override;
 
 protected:
+  /**
+   * @brief Whether the messages of a result type are to be built, creating
+   * their publisher with the first results of the type, so that only the
+   * topics of the inferences connected to the output are advertised.
+   * @return False when nobody subscribes to the topic.
+   */
+  template<typename T>
+  bool isWanted(
+    std::shared_ptr<rclcpp::Publisher<T>> & publisher, const std::string & topic)
+  {
+    if (!publishesTopics()) {
+      return true;
+    }
+    if (publisher == nullptr) {
+      publisher = node_->create_publisher<T>(
+        "/openvino_toolkit/" + output_name_ + "/" + topic, 16);
+    }
+    auto state = topic_states_.find(topic);
+    if (state != topic_states_.end() && !isTopicDue(state->second)) {
+      return false;
+    }
+    return publisher->get_subscription_count() > 0;
+  }
+  /**
+   * @brief Publish the message built for a topic, unless it repeats the last
+   * published one on a topic limited to the changes.
+   */
+  template<typename T>
+  void publishTopic(
+    const std::shared_ptr<rclcpp::Publisher<T>> & publisher, std::unique_ptr<T> & message,
+    const std::string & topic, const std_msgs::msg::Header & header)
+  {
+    if (message == nullptr) {
+      return;
+    }
+    auto state = topic_states_.find(topic);
+    if (state != topic_states_.end() && state->second.gate.getRate().on_change) {
+      // compared before stamping, the header changes with every frame
+      auto last = std::static_pointer_cast<T>(state->second.last_message);
+      if (last != nullptr && *last == *message) {
+        message.reset();
+        return;
+      }
+      state->second.last_message = std::make_shared<T>(*message);
+    }
+    message->header = header;
+    publishMessage(publisher, std::move(message));
+    tracePublish(topic);
+  }
+  /**
+   * @brief Publish the times of the frame, once its results are published.
+   */
+  void publishLatency();
+  /**
+   * @brief Whether the messages are published, rather than kept for a caller.
+   */
+  virtual bool publishesTopics() const
+  {
+    return true;
+  }
+
+  struct TopicState
+  {
+    OutputRateGate gate;
+    /**< whether the current frame is published, decided once per frame >**/
+    bool decided = false;
+    bool due = false;
+    /**< the last published message, for the topics limited to the changes >**/
+    std::shared_ptr<void> last_message;
+  };
+  static bool isTopicDue(TopicState & state)
+  {
+    if (!state.decided) {
+      state.due = state.gate.isDue();
+      state.decided = true;
+    }
+    return state.due;
+  }
+
   const std::string topic_name_;
   std::shared_ptr<rclcpp::Node> node_;
+  std::map<std::string, TopicState> topic_states_;
+  bool latency_topic_ = false;
+  rclcpp::Publisher<people_msgs::msg::FrameLatency>::SharedPtr pub_latency_;
+  bool rle_masks_ = false;
+  int mask_keyframe_interval_ = 30;
+  int masks_since_keyframe_ = 0;
+  /**< the class maps last published, the references of the deltas >**/
+  std::vector<cv::Mat> last_masks_;
   rclcpp::Publisher<people_msgs::msg::LicensePlateStamped>::SharedPtr pub_license_plate_;
-  std::shared_ptr<people_msgs::msg::LicensePlateStamped> license_plate_topic_;
+  std::unique_ptr<people_msgs::msg::LicensePlateStamped> license_plate_topic_;
   rclcpp::Publisher<people_msgs::msg::VehicleAttribsStamped>::SharedPtr pub_vehicle_attribs_;
-  std::shared_ptr<people_msgs::msg::VehicleAttribsStamped> vehicle_attribs_topic_;
+  std::unique_ptr<people_msgs::msg::VehicleAttribsStamped> vehicle_attribs_topic_;
   rclcpp::Publisher<people_msgs::msg::LandmarkStamped>::SharedPtr pub_landmarks_;
-  std::shared_ptr<people_msgs::msg::LandmarkStamped> landmarks_topic_;
+  std::unique_ptr<people_msgs::msg::LandmarkStamped> landmarks_topic_;
   rclcpp::Publisher<people_msgs::msg::ReidentificationStamped>::SharedPtr pub_face_reid_;
-  std::shared_ptr<people_msgs::msg::ReidentificationStamped> face_reid_topic_;
+  std::unique_ptr<people_msgs::msg::ReidentificationStamped> face_reid_topic_;
   rclcpp::Publisher<people_msgs::msg::PersonAttributeStamped>::SharedPtr pub_person_attribs_;
-  std::shared_ptr<people_msgs::msg::PersonAttributeStamped> person_attribs_topic_;
+  std::unique_ptr<people_msgs::msg::PersonAttributeStamped> person_attribs_topic_;
   rclcpp::Publisher<people_msgs::msg::ReidentificationStamped>::SharedPtr pub_person_reid_;
-  std::shared_ptr<people_msgs::msg::ReidentificationStamped> person_reid_topic_;
+  std::unique_ptr<people_msgs::msg::ReidentificationStamped> person_reid_topic_;
   rclcpp::Publisher<people_msgs::msg::ObjectsInMasks>::SharedPtr pub_segmented_object_;
-  std::shared_ptr<people_msgs::msg::ObjectsInMasks> segmented_objects_topic_;
+  std::unique_ptr<people_msgs::msg::ObjectsInMasks> segmented_objects_topic_;
   rclcpp::Publisher<object_msgs::msg::ObjectsInBoxes>::SharedPtr pub_detected_object_;
-  std::shared_ptr<object_msgs::msg::ObjectsInBoxes> detected_objects_topic_;
+  std::unique_ptr<object_msgs::msg::ObjectsInBoxes> detected_objects_topic_;
   rclcpp::Publisher<object_msgs::msg::ObjectsInBoxes>::SharedPtr pub_face_;
-  std::shared_ptr<object_msgs::msg::ObjectsInBoxes> faces_topic_;
+  std::unique_ptr<object_msgs::msg::ObjectsInBoxes> faces_topic_;
   rclcpp::Publisher<people_msgs::msg::EmotionsStamped>::SharedPtr pub_emotion_;
-  std::shared_ptr<people_msgs::msg::EmotionsStamped> emotions_topic_;
+  std::unique_ptr<people_msgs::msg::EmotionsStamped> emotions_topic_;
   rclcpp::Publisher<people_msgs::msg::AgeGenderStamped>::SharedPtr pub_age_gender_;
-  std::shared_ptr<people_msgs::msg::AgeGenderStamped> age_gender_topic_;
+  std::unique_ptr<people_msgs::msg::AgeGenderStamped> age_gender_topic_;
   rclcpp::Publisher<people_msgs::msg::HeadPoseStamped>::SharedPtr pub_headpose_;
-  std::shared_ptr<people_msgs::msg::HeadPoseStamped> headpose_topic_;
+  std::unique_ptr<people_msgs::msg::HeadPoseStamped> headpose_topic_;
 };
 }  // namespace Outputs
 #endif  // DYNAMIC_VINO_LIB__OUTPUTS__ROS_TOPIC_OUTPUT_HPP_
@@ -22,18 +22,22 @@
 
 #include <rclcpp/rclcpp.hpp>
 #include <std_msgs/msg/header.hpp>
+#include <sensor_msgs/msg/compressed_image.hpp>
+#include <sensor_msgs/msg/image.hpp>
+#include <chrono>
 #include <vector>
 #include <string>
 #include <memory>
 
 #include "dynamic_vino_lib/outputs/base_output.hpp"
-#include "dynamic_vino_lib/outputs/image_window_output.hpp"
+#include "dynamic_vino_lib/outputs/overlay_renderer.hpp"
 
 namespace Outputs
 {
 /**
  * @class RvizOutput
- * @brief This class handles and shows the detection result with rviz.
+ * @brief This class publishes the frames decorated with the detection results,
+ * for rviz. The frames are drawn by an OverlayRenderer, without any display.
  */
 class RvizOutput : public BaseOutput
 {
@@ -49,6 +53,16 @@ public:
    * functions with rviz.
    */
   void handleOutput() override;
+  /**
+   * @brief Set how the images are published.
+   * @param[in] transport "raw" for sensor_msgs/Image on .../images, or
+   * "compressed" for JPEG sensor_msgs/CompressedImage on .../images/compressed.
+   * @param[in] quality The JPEG quality, from 0 to 100.
+   * @param[in] scale The factor the images are resized by before publishing.
+   * @param[in] max_rate The images published per second at most, 0 for all.
+   */
+  void setImageEncoding(
+    const std::string & transport, int quality, float scale, float max_rate);
   /**
    * @brief Generate rviz output content according to
    * the face reidentification result.
@@ -113,8 +127,11 @@ public:
 private:
   std::shared_ptr<rclcpp::Node> node_;
   rclcpp::Publisher<sensor_msgs::msg::Image>::SharedPtr pub_image_;
-  std::shared_ptr<sensor_msgs::msg::Image> image_topic_;
-  std::shared_ptr<Outputs::ImageWindowOutput> image_window_output_;
+  rclcpp::Publisher<sensor_msgs::msg::CompressedImage>::SharedPtr pub_compressed_image_;
+  int jpeg_quality_ = 90;
+  std::chrono::steady_clock::duration min_interval_{0};
+  std::chrono::steady_clock::time_point last_published_;
+  OverlayRenderer renderer_;
 };
 }  // namespace Outputs
 #endif  // DYNAMIC_VINO_LIB__OUTPUTS__RVIZ_OUTPUT_HPP_
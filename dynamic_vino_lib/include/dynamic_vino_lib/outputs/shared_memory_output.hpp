@@ -0,0 +1,93 @@
+// Copyright (c) 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @brief A header file with declaration for SharedMemoryOutput Class
+ * @file shared_memory_output.hpp
+ */
+
+#ifndef DYNAMIC_VINO_LIB__OUTPUTS__SHARED_MEMORY_OUTPUT_HPP_
+#define DYNAMIC_VINO_LIB__OUTPUTS__SHARED_MEMORY_OUTPUT_HPP_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "dynamic_vino_lib/outputs/base_output.hpp"
+#include "dynamic_vino_lib/outputs/shm_ring.hpp"
+
+namespace Outputs
+{
+/**
+ * @class SharedMemoryOutput
+ * @brief This class writes the detection results of each frame, and optionally
+ * the frame, as a fixed layout record into a ring in POSIX shared memory, for
+ * the processes on the same host reading them with ShmRing::Reader.
+ */
+class SharedMemoryOutput : public BaseOutput
+{
+public:
+  /**
+   * @param[in] slots The records kept in the ring.
+   * @param[in] max_objects The objects per record at most, the others are dropped.
+   * @param[in] frames Whether the frames are written with their results.
+   */
+  SharedMemoryOutput(
+    const std::string & output_name, int slots, int max_objects, bool frames);
+  ~SharedMemoryOutput() override;
+
+  void feedFrame(const cv::Mat &) override;
+  /**
+   * @brief Write the record of the frame into the next slot of the ring.
+   */
+  void handleOutput() override;
+  void clearData() override;
+
+  void accept(const std::vector<dynamic_vino_lib::ObjectDetectionResult> &) override;
+  void accept(const std::vector<dynamic_vino_lib::FaceDetectionResult> &) override;
+
+private:
+  template<typename T>
+  void addObjects(const std::vector<T> & results, ShmRing::ObjectKind kind)
+  {
+    for (auto & r : results) {
+      auto loc = r.getLocation();
+      ShmRing::Object object;
+      object.x = static_cast<float>(loc.x);
+      object.y = static_cast<float>(loc.y);
+      object.width = static_cast<float>(loc.width);
+      object.height = static_cast<float>(loc.height);
+      object.label_id = r.getLabelId();
+      object.confidence = r.getConfidence();
+      object.track_id = r.getTrackId();
+      object.kind = kind;
+      objects_.push_back(object);
+    }
+  }
+  /**
+   * @brief Create the ring, sized for frames like the first one.
+   */
+  bool createRing(const cv::Mat & frame);
+
+  std::string shm_name_;
+  uint32_t slot_count_;
+  uint32_t max_objects_;
+  bool frames_;
+  uint8_t * base_ = nullptr;
+  size_t size_ = 0;
+  bool failed_ = false;
+  std::vector<ShmRing::Object> objects_;
+};
+}  // namespace Outputs
+#endif  // DYNAMIC_VINO_LIB__OUTPUTS__SHARED_MEMORY_OUTPUT_HPP_
@@ -0,0 +1,281 @@
+// Copyright (c) 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @brief A header file with the layout of the shared memory result ring, and a
+ * reader for the processes consuming it. It only depends on the C++ and POSIX
+ * libraries, so that a consumer includes it alone.
+ * @file shm_ring.hpp
+ */
+
+#ifndef DYNAMIC_VINO_LIB__OUTPUTS__SHM_RING_HPP_
+#define DYNAMIC_VINO_LIB__OUTPUTS__SHM_RING_HPP_
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace Outputs
+{
+namespace ShmRing
+{
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "the ring needs address free 64 bit atomics");
+
+const uint32_t kMagic = 0x4f565252;  // "OVRR"
+const uint32_t kVersion = 1;
+
+enum ObjectKind : uint32_t
+{
+  kKindObject = 0,
+  kKindFace = 1,
+};
+
+/**
+ * @brief A detected object, in pixels of the frame.
+ */
+struct Object
+{
+  float x;
+  float y;
+  float width;
+  float height;
+  /**< the id of the label in the label file of the model, -1 if unknown >**/
+  int32_t label_id;
+  float confidence;
+  /**< -1 if not tracked >**/
+  int32_t track_id;
+  uint32_t kind;
+};
+
+/**
+ * @brief At the start of the shared memory, followed by 'slot_count' slots of
+ * 'slot_size' bytes.
+ */
+struct RingHeader
+{
+  uint32_t magic;
+  uint32_t version;
+  uint32_t slot_count;
+  uint32_t max_objects;
+  uint64_t slot_size;
+  /**< the frame bytes per slot at most, 0 without frames >**/
+  uint64_t frame_bytes;
+  /**< the records written so far, the last one is in slot (written - 1) % slot_count >**/
+  std::atomic<uint64_t> written;
+};
+
+/**
+ * @brief At the start of each slot, followed by 'max_objects' objects and the
+ * frame bytes. The sequence is odd while the slot is written.
+ */
+struct SlotHeader
+{
+  std::atomic<uint64_t> sequence;
+  /**< the index of the record, counted from 0 >**/
+  uint64_t index;
+  /**< the stamp of the frame, in nanoseconds >**/
+  int64_t stamp_ns;
+  uint32_t object_count;
+  /**< 0 without a frame, the frame rows are 'frame_step' bytes apart >**/
+  uint32_t frame_width;
+  uint32_t frame_height;
+  /**< the OpenCV type of the frame, e.g. 16 for CV_8UC3 (BGR) >**/
+  uint32_t frame_type;
+  uint32_t frame_step;
+  uint32_t reserved;
+};
+
+inline uint64_t getSlotSize(uint32_t max_objects, uint64_t frame_bytes)
+{
+  uint64_t size = sizeof(SlotHeader) + max_objects * sizeof(Object) + frame_bytes;
+  // slots on separate cache lines
+  return (size + 63) / 64 * 64;
+}
+
+inline uint64_t getHeaderSize()
+{
+  return (sizeof(RingHeader) + 63) / 64 * 64;
+}
+
+inline std::string getShmName(const std::string & ring_name)
+{
+  return "/openvino_toolkit_" + ring_name;
+}
+
+/**
+ * @brief A record copied out of the ring.
+ */
+struct Record
+{
+  uint64_t index = 0;
+  int64_t stamp_ns = 0;
+  std::vector<Object> objects;
+  uint32_t frame_width = 0;
+  uint32_t frame_height = 0;
+  uint32_t frame_type = 0;
+  uint32_t frame_step = 0;
+  std::vector<uint8_t> frame;
+};
+
+/**
+ * @class Reader
+ * @brief Reads the records of a ring written by a SharedMemory output, without
+ * locking: a record overwritten while being copied is read again.
+ */
+class Reader
+{
+public:
+  Reader() = default;
+  Reader(const Reader &) = delete;
+  Reader & operator=(const Reader &) = delete;
+  ~Reader()
+  {
+    close();
+  }
+
+  /**
+   * @brief Map the ring of the output named 'ring_name' (the name of the pipeline).
+   * @return False if the ring does not exist (yet) or is not a result ring.
+   */
+  bool open(const std::string & ring_name)
+  {
+    close();
+    int fd = shm_open(getShmName(ring_name).c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+      return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || static_cast<uint64_t>(info.st_size) < getHeaderSize()) {
+      ::close(fd);
+      return false;
+    }
+    void * base = mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (base == MAP_FAILED) {
+      return false;
+    }
+    base_ = static_cast<const uint8_t *>(base);
+    size_ = info.st_size;
+    if (!isValid(*getHeader(), size_)) {
+      close();
+      return false;
+    }
+    return true;
+  }
+
+  void close()
+  {
+    if (base_ != nullptr) {
+      munmap(const_cast<uint8_t *>(base_), size_);
+      base_ = nullptr;
+    }
+  }
+
+  bool isOpened() const
+  {
+    return base_ != nullptr;
+  }
+
+  /**
+   * @brief Get the number of records written so far.
+   */
+  uint64_t getWritten() const
+  {
+    return getHeader()->written.load(std::memory_order_acquire);
+  }
+
+  /**
+   * @brief Copy the last written record.
+   * @return False if no record was written yet.
+   */
+  bool readLatest(Record & record) const
+  {
+    uint64_t written = getWritten();
+    return written > 0 && read(written - 1, record);
+  }
+
+  /**
+   * @brief Copy the record of the given index.
+   * @return False if it is not written yet, or already overwritten.
+   */
+  bool read(uint64_t index, Record & record) const
+  {
+    const RingHeader * header = getHeader();
+    const uint8_t * slot =
+      base_ + getHeaderSize() + (index % header->slot_count) * header->slot_size;
+    auto slot_header = reinterpret_cast<const SlotHeader *>(slot);
+    while (true) {
+      uint64_t sequence = slot_header->sequence.load(std::memory_order_acquire);
+      if (sequence & 1) {
+        continue;
+      }
+      if (slot_header->index != index || index >= getWritten()) {
+        return false;
+      }
+      record.index = index;
+      record.stamp_ns = slot_header->stamp_ns;
+      uint32_t count = std::min(slot_header->object_count, header->max_objects);
+      record.objects.resize(count);
+      std::memcpy(record.objects.data(), slot + sizeof(SlotHeader), count * sizeof(Object));
+      record.frame_width = slot_header->frame_width;
+      record.frame_height = slot_header->frame_height;
+      record.frame_type = slot_header->frame_type;
+      record.frame_step = slot_header->frame_step;
+      uint64_t frame_bytes = std::min<uint64_t>(
+        static_cast<uint64_t>(record.frame_step) * record.frame_height, header->frame_bytes);
+      record.frame.resize(frame_bytes);
+      std::memcpy(record.frame.data(),
+        slot + sizeof(SlotHeader) + header->max_objects * sizeof(Object), frame_bytes);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (slot_header->sequence.load(std::memory_order_relaxed) == sequence) {
+        return true;
+      }
+    }
+  }
+
+private:
+  /**
+   * @brief Whether the header describes slots laid out by the writer, all
+   * within the 'size' bytes mapped.
+   */
+  static bool isValid(const RingHeader & header, uint64_t size)
+  {
+    if (header.magic != kMagic || header.version != kVersion || header.slot_count == 0 ||
+      header.frame_bytes >= header.slot_size ||
+      header.slot_size != getSlotSize(header.max_objects, header.frame_bytes))
+    {
+      return false;
+    }
+    // checked by division, the product may overflow
+    return (size - getHeaderSize()) / header.slot_size >= header.slot_count;
+  }
+
+  const RingHeader * getHeader() const
+  {
+    return reinterpret_cast<const RingHeader *>(base_);
+  }
+
+  const uint8_t * base_ = nullptr;
+  size_t size_ = 0;
+};
+}  // namespace ShmRing
+}  // namespace Outputs
+#endif  // DYNAMIC_VINO_LIB__OUTPUTS__SHM_RING_HPP_
@@ -0,0 +1,161 @@
+// Copyright (c) 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @brief A header file with declaration for VideoWriterOutput Class
+ * @file video_writer_output.hpp
+ */
+
+#ifndef DYNAMIC_VINO_LIB__OUTPUTS__VIDEO_WRITER_OUTPUT_HPP_
+#define DYNAMIC_VINO_LIB__OUTPUTS__VIDEO_WRITER_OUTPUT_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "dynamic_vino_lib/outputs/base_output.hpp"
+#include "dynamic_vino_lib/outputs/overlay_renderer.hpp"
+
+namespace Outputs
+{
+/**
+ * @class VideoWriterOutput
+ * @brief This class records the frames, decorated with the detection results or
+ * raw, into video files. The frames are encoded on a worker thread, with the
+ * hardware encoder (VAAPI or QSV through the FFmpeg backend of OpenCV) when
+ * available, into segments of a bounded duration.
+ */
+class VideoWriterOutput : public BaseOutput
+{
+public:
+  explicit VideoWriterOutput(const std::string & output_name);
+  ~VideoWriterOutput() override;
+
+  /**
+   * @brief Set where and how the frames are recorded.
+   * @param[in] directory The directory the video files are written to.
+   * @param[in] fps The frame rate of the video files.
+   * @param[in] segment The seconds of frames per file at most, 0 for no bound.
+   * @param[in] annotated Whether the frames are decorated with the results.
+   * @param[in] trigger "always", or "detections" to record only the frames with
+   * results, and those within 'hold' seconds after the last ones.
+   * @param[in] hold The seconds recorded after the last detections.
+   */
+  void setRecording(
+    const std::string & directory, float fps, float segment, bool annotated,
+    const std::string & trigger, float hold);
+
+  /**
+   * @brief Record the annotated frames resized by this factor, the results
+   * drawn on the resized frames. The raw frames are recorded as they are.
+   */
+  void setPreviewScale(float scale)
+  {
+    renderer_.setScale(scale);
+  }
+  void feedFrame(const cv::Mat &) override;
+  /**
+   * @brief Queue the frame for the encoder, unless not triggered.
+   */
+  void handleOutput() override;
+  void clearData() override;
+
+  void accept(const std::vector<dynamic_vino_lib::LicensePlateDetectionResult> &) override;
+  void accept(const std::vector<dynamic_vino_lib::VehicleAttribsDetectionResult> &) override;
+  void accept(const std::vector<dynamic_vino_lib::FaceReidentificationResult> &) override;
+  void accept(const std::vector<dynamic_vino_lib::LandmarksDetectionResult> &) override;
+  void accept(const std::vector<dynamic_vino_lib::PersonAttribsDetectionResult> &) override;
+  void accept(const std::vector<dynamic_vino_lib::PersonReidentificationResult> &) override;
+  void accept(const std::vector<dynamic_vino_lib::ObjectSegmentationResult> &) override;
+  void accept(const std::vector<dynamic_vino_lib::ObjectDetectionResult> &) override;
+  void accept(const std::vector<dynamic_vino_lib::FaceDetectionResult> &) override;
+  void accept(const std::vector<dynamic_vino_lib::EmotionsResult> &) override;
+  void accept(const std::vector<dynamic_vino_lib::AgeGenderResult> &) override;
+  void accept(const std::vector<dynamic_vino_lib::HeadPoseResult> &) override;
+
+  /**
+   * @brief Get the number of frames dropped because the encoder was behind.
+   */
+  uint64_t getDroppedFrames() const
+  {
+    return dropped_frames_;
+  }
+  size_t getQueueDepth() override
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    return queue_.size();
+  }
+  size_t getQueueBytes() override
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    size_t bytes = 0;
+    for (auto & job : queue_) {
+      bytes += job.frame.total() * job.frame.elemSize();
+    }
+    return bytes;
+  }
+
+private:
+  using Clock = std::chrono::steady_clock;
+  struct Job
+  {
+    /**< empty to close the current file >**/
+    cv::Mat frame;
+    Clock::time_point time;
+  };
+
+  template<typename T>
+  void record(const std::vector<T> & results)
+  {
+    detected_ = detected_ || !results.empty();
+    if (annotated_) {
+      renderer_.accept(results);
+    }
+  }
+  void push(Job job);
+  void run();
+  bool openWriter(const cv::Size & size);
+
+  OverlayRenderer renderer_;
+  std::string directory_ = ".";
+  double fps_ = 30;
+  Clock::duration segment_{0};
+  bool annotated_ = true;
+  bool on_detections_ = false;
+  Clock::duration hold_{0};
+  bool detected_ = false;
+  bool recording_ = false;
+  Clock::time_point last_detected_;
+
+  // owned by the worker
+  cv::VideoWriter writer_;
+  Clock::time_point segment_start_;
+  int file_index_ = 0;
+
+  std::deque<Job> queue_;
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  bool stopped_ = false;
+  std::atomic<uint64_t> dropped_frames_;
+  std::thread worker_;
+};
+}  // namespace Outputs
+#endif  // DYNAMIC_VINO_LIB__OUTPUTS__VIDEO_WRITER_OUTPUT_HPP_
@@ -20,30 +20,45 @@
 #define DYNAMIC_VINO_LIB__PIPELINE_HPP_
 
 #include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
 #include <future>
 #include <map>
 #include <memory>
 #include <mutex>
 #include <set>
 #include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 
+#include "dynamic_vino_lib/frame_context.hpp"
 #include "dynamic_vino_lib/inferences/base_inference.hpp"
 #include "dynamic_vino_lib/inputs/standard_camera.hpp"
 #include "dynamic_vino_lib/outputs/base_output.hpp"
 #include "dynamic_vino_lib/pipeline_params.hpp"
+#include "dynamic_vino_lib/utils/frame_pool.hpp"
+#include "dynamic_vino_lib/utils/latency_stats.hpp"
+#include "dynamic_vino_lib/utils/motion_gate.hpp"
+#include "dynamic_vino_lib/utils/perf_counters.hpp"
+#include "dynamic_vino_lib/utils/thread_pool.hpp"
 // #include "dynamic_vino_lib/pipeline_filters.hpp"
 #include "opencv2/opencv.hpp"
 
 /**
  * @class Pipeline
  * @brief This class is a pipeline class that stores the topology of
- * the input device, output device and networks and make inference. One pipeline
- * should have only one input device.
+ * the input device, output device and networks and make inference. A pipeline
+ * may have several input devices: their frames are read in lock-step, batched
+ * into one request by the first-stage inferences supporting it, and the
+ * results of each frame are routed to the outputs of its own input.
  */
 class Pipeline
 {
 public:
   explicit Pipeline(const std::string & name = "pipeline");
+  ~Pipeline();
   /**
    * @brief Add input device to the pipeline.
    * @param[in] name name of the current input device.
@@ -73,12 +88,44 @@ public:
     std::shared_ptr<Outputs::BaseOutput> output);
 
   bool add(const std::string & name, std::shared_ptr<Outputs::BaseOutput> output);
+  /**
+   * @brief Add the instance of an output device which serves the frames of the
+   * given input device, for pipelines with more than one input. The instance
+   * added by add(name, output) serves the first input.
+   * @param[in] input_name name of the input device served.
+   * @param[in] name name of the output device, as used in the connections.
+   * @param[in] output the output instance to be added.
+   * @return whether the add operation is successful
+   */
+  bool addOutputForInput(
+    const std::string & input_name, const std::string & name,
+    std::shared_ptr<Outputs::BaseOutput> output);
   void addConnect(const std::string & parent, const std::string & name);
   // inline void addFilters(const std::vector<Params::ParamManager::FilterRawData>& filters)
   // {
   //   filters_.add(filters);
   // }
   bool add(const std::string & name, std::shared_ptr<dynamic_vino_lib::BaseInference> inference);
+  /**
+   * @brief Replace an inference of the running pipeline, e.g. by one with a
+   * new model. The replacement is queued and applied by the next runOnce,
+   * before its frames are read, once the requests of the previous frames are
+   * done, so that every frame is inferred by either the old or the new one.
+   * @return False if the pipeline has no inference of this name.
+   */
+  bool replaceInference(
+    const std::string & name, std::shared_ptr<dynamic_vino_lib::BaseInference> inference);
+  /**
+   * @brief Add an inference to the running pipeline, e.g. a cascade loaded
+   * after the pipeline started, along with its connections to and from the
+   * rest of the graph. Queued and applied by the next runOnce as
+   * replaceInference, a connection to an inference not joined yet is made
+   * once it joins.
+   * @param[in] connects the (parent, child) connections of the inference.
+   */
+  void joinInference(
+    const std::string & name, std::shared_ptr<dynamic_vino_lib::BaseInference> inference,
+    const std::vector<std::pair<std::string, std::string>> & connects);
   /**
    * @brief Add inference network-output device edge to the pipeline.
    * @param[in] parent name of the parent inference.
@@ -89,14 +136,56 @@ public:
   /**
    * @brief Do the inference once.
    * Data flow from input device to inference network, then to output device.
+   * When frames_in_flight is larger than 1, the frames read are dispatched
+   * without waiting for their inference, up to frames_in_flight of them at
+   * once, and each call outputs those done in capture order. A single input
+   * is then captured by a dedicated thread. The frames of a pipeline whose
+   * results depend on the frames before (see isOrderSensitive) are still
+   * inferred one after the other, only their outputs overlap.
    */
   void runOnce();
+  /**
+   * @brief Stop capturing frames while the pipeline is paused, the frames
+   * dispatched are output first.
+   */
+  void pause();
+  /**
+   * @brief Capture frames again after a pause. The frames captured before
+   * the pause are dropped, not processed late.
+   */
+  void resume();
+  /**
+   * @brief Stop capturing frames, then process the frames already captured,
+   * so that their results are output before the pipeline stops.
+   */
+  void drain();
+  /**
+   * @brief Wait for the inference of all the frames dispatched, and output them.
+   */
+  void flush();
+  /**
+   * @brief Block until a frame is ready to be processed, or the timeout
+   * expires, so that the pipeline thread sleeps instead of polling.
+   * @return Whether a frame is ready, or frames dispatched are left to output.
+   */
+  bool waitForFrame(const std::chrono::milliseconds & timeout);
+  /**
+   * @brief Whether all the inputs are exhausted and no captured or dispatched
+   * frame is left to process.
+   */
+  bool isExhausted();
 
+  /**
+   * @brief Handle the results of a finished inference: notify its outputs and
+   * dispatch the filtered ROIs to its downstream inferences.
+   * It runs on the dispatcher threads of the pipeline.
+   */
   void callback(const std::string & detection_name);
   /**
    * @brief Set the inference network to call the callback function as soon as
    * each inference is
-   * finished.
+   * finished. The completion callback of the plugin only queues the
+   * callback to the dispatcher threads.
    */
   void setCallback();
   void printPipeline();
@@ -112,10 +201,21 @@ public:
   {
     return params_;
   }
+  std::string getName() const
+  {
+    return params_ == nullptr ? "" : params_->getName();
+  }
+  /**
+  * @brief Get the (first) input device of the pipeline.
+  */
   std::shared_ptr<Input::BaseInputDevice> getInputDevice()
   {
     return input_device_;
   }
+  const std::vector<std::shared_ptr<Input::BaseInputDevice>> & getInputDevices() const
+  {
+    return input_devices_;
+  }
   const std::multimap<std::string, std::string> getPipelineDetail()
   {
     return next_;
@@ -127,6 +227,193 @@ public:
   {
     return fps_;
   }
+  /**
+  * @brief Get the total number of input frames dropped by the frame policy
+  * and by the input devices.
+  */
+  uint64_t getDroppedFrames() const
+  {
+    uint64_t dropped = dropped_frames_;
+    for (auto & device : input_devices_) {
+      dropped += device->getDroppedFrames();
+    }
+    return dropped;
+  }
+  /**
+  * @brief Get the total number of frames the input devices delivered late.
+  */
+  uint64_t getLateFrames() const
+  {
+    uint64_t late = 0;
+    for (auto & device : input_devices_) {
+      late += device->getLateFrames();
+    }
+    return late;
+  }
+  /**
+  * @brief Get the number of frames whose outputs were handled after their
+  * deadline (see frame_deadline).
+  */
+  uint64_t getDeadlineMisses() const
+  {
+    return deadline_misses_;
+  }
+  /**
+  * @brief Get the number of inferences of a frame skipped because they would
+  * not finish before its deadline.
+  */
+  uint64_t getDeadlineSkips() const
+  {
+    return deadline_skips_;
+  }
+  /**
+  * @brief Get the number of infer requests failed, or not started, on their device.
+  */
+  uint64_t getRequestFailures() const
+  {
+    return request_failures_;
+  }
+  /**
+   * @brief Get an inference of the pipeline, nullptr if there is none of this
+   * name. Called by the pipeline thread, which applies the replacements.
+   */
+  std::shared_ptr<dynamic_vino_lib::BaseInference> getInference(const std::string & name) const
+  {
+    auto it = name_to_detection_map_.find(name);
+    return it == name_to_detection_map_.end() ? nullptr : it->second;
+  }
+  /**
+   * @brief Limit the rate the frames are processed at, on top of the frame
+   * policy, e.g. while an inference runs degraded on a slower device.
+   * @param[in] fps The frames per second at most, 0 for no limit (Thread Safe).
+   */
+  void setRateLimit(float fps)
+  {
+    rate_limit_ = fps;
+  }
+  /**
+   * @brief Limit the rate the frames are processed at while saving energy, on
+   * top of the other limits (Thread Safe).
+   * @param[in] fps The frames per second at most, 0 for no limit.
+   * @param[in] reasons The signals energy is saved for, see PowerGovernor.
+   */
+  void setPowerSaving(float fps, const std::vector<std::string> & reasons)
+  {
+    power_limit_ = fps;
+    std::lock_guard<std::mutex> lock(replacements_mutex_);
+    power_reasons_ = reasons;
+  }
+  /**
+   * @brief Get the signals the pipeline saves energy for, empty at full rate.
+   */
+  std::vector<std::string> getPowerReasons()
+  {
+    std::lock_guard<std::mutex> lock(replacements_mutex_);
+    return power_reasons_;
+  }
+  /**
+   * @brief Get the frames checked by the motion gate, and those of them found
+   * still, since the pipeline was created.
+   */
+  uint64_t getGatedFrames() const
+  {
+    return gated_frames_;
+  }
+  uint64_t getStillFrames() const
+  {
+    return still_frames_;
+  }
+  /**
+   * @brief Get the average milliseconds a request of an inference runs for,
+   * 0 before the first one finishes.
+   */
+  double getRequestMs(const std::string & name);
+  /**
+   * @brief Mark an inference as running on its fallback device (Thread Safe).
+   */
+  void setFallback(const std::string & name)
+  {
+    std::lock_guard<std::mutex> lock(replacements_mutex_);
+    fallbacks_.insert(name);
+  }
+  std::set<std::string> getFallbacks()
+  {
+    std::lock_guard<std::mutex> lock(replacements_mutex_);
+    return fallbacks_;
+  }
+  /**
+  * @brief Get the number of input frames dropped during the last second.
+  */
+  int getDroppedFPS() const
+  {
+    return dropped_fps_;
+  }
+  /**
+  * @brief Get the rolling latency percentiles of each stage: "capture", "scale",
+  * "<inference>/preprocess", "<inference>/inference", "<inference>/postprocess",
+  * "<inference>/filter", "output" and the end-to-end "frame" latency.
+  */
+  std::vector<LatencyStats::Summary> getLatencyStats()
+  {
+    return stats_.summarize();
+  }
+  /**
+  * @brief Get the per-layer performance counts of the inferences whose
+  * networks are loaded with PERF_COUNT (see enable_performance_count).
+  */
+  std::vector<PerfCounters::Summary> getPerfCounts()
+  {
+    return perf_counters_.summarize();
+  }
+  /**
+  * @brief Get the current depth of each queue of the pipeline: the "frames" in
+  * flight, the batches "<inference>/pending" and "<inference>/running", and the
+  * frames waiting for the worker of each "<output>/output".
+  */
+  std::vector<std::pair<std::string, size_t>> getQueueDepths();
+  /**
+  * @brief Get the bytes held by each part of the pipeline: the "<inference>/network"
+  * loaded (0 if shared with a network loaded before), its "<inference>/blobs",
+  * its "<inference>/gallery" of tracks and the frames queued by each "<output>/queue".
+  */
+  std::vector<std::pair<std::string, uint64_t>> getMemoryUsage();
+  /**
+  * @brief Dump the per-layer performance counts to a CSV file.
+  * @return Whether the file is written.
+  */
+  bool dumpPerfCounts(const std::string & path)
+  {
+    return perf_counters_.writeCsv(path);
+  }
+  /**
+  * @brief Get the header of the frame currently being processed.
+  */
+  std_msgs::msg::Header getFrameHeader() const
+  {
+    return current_context_ == nullptr ? std_msgs::msg::Header() : current_context_->getHeader();
+  }
+  /**
+  * @brief Get the times the frame currently being processed went through the pipeline at.
+  */
+  FrameTimes getFrameTimes() const
+  {
+    return current_context_ == nullptr ? FrameTimes() : current_context_->getTimes();
+  }
+  /**
+  * @brief Get the factor from the pixels of the frame currently being processed
+  * to those of the native frame of its input (see FrameContext::getFrameScale).
+  */
+  float getFrameScale() const
+  {
+    return current_context_ == nullptr ? 1 : current_context_->getFrameScale();
+  }
+  /**
+  * @brief Get the context of the frame currently being processed.
+  */
+  std::shared_ptr<FrameContext> getFrameContext() const
+  {
+    return current_context_;
+  }
 
   std::string findFilterConditions(const std::string & input, const std::string & output)
   {
@@ -134,9 +421,293 @@ public:
   }
 
 private:
-  void initInferenceCounter();
-  void increaseInferenceCounter();
-  void decreaseInferenceCounter();
+  std::shared_ptr<FrameContext> readFrame();
+  /**
+   * @brief Read one frame from every input device.
+   * @return The contexts of the frames read, empty if no frame is ready.
+   */
+  std::vector<std::shared_ptr<FrameContext>> readFrames();
+  /**
+   * @brief Set a frame read from an input device to a context, downscaled to
+   * the working width of the pipeline if it is wider.
+   */
+  void setFrame(
+    const std::shared_ptr<FrameContext> & context, cv::Mat & frame,
+    Input::BaseInputDevice & device);
+  /**
+   * @brief Get the output instances serving the given input.
+   */
+  std::vector<std::shared_ptr<Outputs::BaseOutput>> getOutputs(int input_id) const;
+  int getFramesInFlight() const;
+  /**
+   * @brief Get the id of the frame the request of an inference is running for,
+   * for the tracepoint of its completion.
+   */
+  uint64_t getRequestFrameId(int node_id, int request_id);
+  /**
+   * @brief Whether frames are read by the capture thread (multi-frame
+   * pipelining, or the latest-frame policy).
+   */
+  bool useCaptureThread() const;
+  /**
+   * @brief The frames read together, dispatched and not output yet.
+   */
+  struct DispatchedFrames
+  {
+    std::vector<std::shared_ptr<FrameContext>> contexts;
+    /**< all their infer requests done, and their input regions updated >**/
+    bool inferred = false;
+  };
+  /**
+   * @brief Whether several frames are dispatched at once (frames_in_flight
+   * above 1), their results are then deferred until they are output.
+   */
+  bool overlapsFrames() const;
+  /**
+   * @brief Whether the frames of an input go on from the results of the frames
+   * before them (tracking, reused results, motion gate, dynamic input
+   * region), so that a frame is dispatched once the frames before are inferred.
+   */
+  bool isOrderSensitive() const;
+  /**
+   * @brief Whether a frame can be read without waiting for the capture thread.
+   */
+  bool isFrameReady();
+  /**
+   * @brief Feed the frames to the outputs admitting them.
+   */
+  void feedOutputs(const std::vector<std::shared_ptr<FrameContext>> & contexts);
+  /**
+   * @brief Finish the inference of dispatched frames.
+   * @param[in] block Whether to wait for their infer requests, or to only
+   * check whether they are done.
+   * @return Whether the frames are inferred.
+   */
+  bool waitFramesInferred(DispatchedFrames & frames, bool block);
+  /**
+   * @brief Output the dispatched frames in capture order: those already
+   * inferred, and the oldest ones until no more than max_dispatched are left.
+   */
+  void outputDispatchedFrames(size_t max_dispatched);
+  /**
+   * @brief Hand the deferred results of inferred frames to their outputs, and
+   * handle the outputs.
+   */
+  void outputFrames(const std::vector<std::shared_ptr<FrameContext>> & contexts);
+  /**
+   * @brief Apply the decimation/target-fps policy to a newly read frame.
+   * @return Whether the frame should be dropped.
+   */
+  bool dropFrame();
+  void startCapture();
+  void stopCapture();
+  void threadCapture();
+  /**
+   * @brief A chunk of ROIs (at most one batch) waiting to be enqueued into an
+   * inference. contexts[i] is the frame rois[i] belongs to; the uncropped
+   * batches of frame-batchable inferences mix the frames of several inputs,
+   * the cropped ones of inferences with a batch wait the ROIs of several frames.
+   */
+  struct PendingBatch
+  {
+    std::vector<std::shared_ptr<FrameContext>> contexts;
+    std::vector<cv::Rect> rois;
+    /**< track key of each ROI for the result cache, empty if untracked >**/
+    std::vector<int64_t> track_keys;
+    bool crop = false;
+    LatencyStats::Clock::time_point queued_time;
+  };
+  /**
+   * @brief The batch running on one infer request of an inference.
+   */
+  struct RequestState
+  {
+    /**< contexts of the running batch, one per ROI >**/
+    std::vector<std::shared_ptr<FrameContext>> contexts;
+    /**< context of each enqueued batch slot >**/
+    std::vector<std::shared_ptr<FrameContext>> slots;
+    /**< track key of each enqueued batch slot, empty if untracked >**/
+    std::vector<int64_t> slot_track_keys;
+    LatencyStats::Clock::time_point submit_time;
+  };
+  /**
+   * @brief Scheduling state of an inference. Each request of its engine serves
+   * one batch at a time, the other batches wait in the pending queue.
+   */
+  struct InferenceState
+  {
+    std::mutex mtx;
+    /**< serializes enqueue/submit/fetch, which share the inference instance >**/
+    std::mutex inference_mtx;
+    int running = 0;
+    /**< requests allowed in flight at the same time >**/
+    int max_running = 1;
+    std::vector<RequestState> requests;
+    std::deque<PendingBatch> pending;
+    /**< buffers reused while results are routed, guarded by inference_mtx >**/
+    std::vector<cv::Rect> result_locations;
+    std::vector<cv::Rect> rois;
+    std::vector<int> track_ids;
+    std::vector<int64_t> track_keys;
+    std::vector<dynamic_vino_lib::RoiScore> roi_scores;
+    /**< moving average of the milliseconds a request takes, guarded by mtx >**/
+    double request_ms = 0;
+    /**< by input, the frames since the inference last ran and when, for its execution rate,
+     updated by the pipeline thread >**/
+    std::map<int, std::pair<int, LatencyStats::Clock::time_point>> last_runs;
+  };
+  /**
+   * @brief An edge of the compiled graph, with its filter conditions resolved.
+   */
+  struct GraphEdge
+  {
+    int to;
+    std::string filter_conditions;
+  };
+  /**
+   * @brief A node (input, inference or output) of the compiled graph.
+   */
+  struct GraphNode
+  {
+    std::string name;
+    int category;
+    std::shared_ptr<dynamic_vino_lib::BaseInference> inference;
+    /**< output instance of each input, null if the input has none >**/
+    std::vector<std::shared_ptr<Outputs::BaseOutput>> outputs;
+    std::shared_ptr<InferenceState> state;
+    std::vector<GraphEdge> inference_edges;
+    std::vector<GraphEdge> output_edges;
+    /**< whether its partial batches of ROIs are held for the ROIs of other frames >**/
+    bool coalesce = false;
+    /**< inferences upstream of a coalescing one, which may still route it ROIs >**/
+    std::vector<int> ancestors;
+    /**< coalescing inferences downstream, whose held batches it may release >**/
+    std::vector<int> coalescing_descendants;
+  };
+  /**
+   * @brief The region of the frames of an input the first-stage inferences run on.
+   */
+  struct InputRegion
+  {
+    /**< fixed region, empty for the whole frame >**/
+    cv::Rect fixed;
+    /**< follow the extent of the detections of the previous frame >**/
+    bool dynamic = false;
+    cv::Rect extent;
+    uint64_t frames = 0;
+  };
+  /**
+   * @brief Compile the string-keyed connections into an indexed graph, so that
+   * no name lookup is needed while frames are processed.
+   */
+  void compileGraph();
+  /**
+   * @brief Swap the queued replacements and joining inferences into the
+   * pipeline, between two frames.
+   */
+  void applyReplacements();
+  /**
+   * @brief Parse the input roi of each input.
+   */
+  void compileInputRegions();
+  /**
+   * @brief Select the region of a frame the first-stage inferences run on.
+   * @return The region, empty for the whole frame.
+   */
+  cv::Rect selectInputRegion(const FrameContext & context);
+  /**
+   * @brief Let the dynamic region of an input follow the extent of the
+   * first-stage results of its last frame.
+   */
+  void updateInputRegion(FrameContext & context);
+  /**
+   * @param[in] failed Whether the request completed with an error, its frames
+   * then go on without the results of the inference.
+   */
+  void callback(int node_id, int request_id, bool failed = false);
+  /**
+   * @brief Notify the outputs and the downstream inferences of the results of
+   * one frame.
+   */
+  void routeResults(int node_id, std::shared_ptr<FrameContext> context,
+    std::vector<int> & next_stages);
+  /**
+   * @brief Split the ROIs into batches and queue them to the given inference.
+   * Call submitPending (or submitConcurrently) to start them.
+   * @param[in] node_id Graph node id of the inference.
+   * @param[in] context Context of the frame the ROIs belong to.
+   * @param[in] rois ROIs to be inferred.
+   * @param[in] crop Whether the ROIs are cropped out of the frame (or the whole
+   * frame is enqueued, for first-stage inferences).
+   * @return Whether any batch is queued.
+   */
+  bool dispatch(
+    int node_id, std::shared_ptr<FrameContext> context,
+    const std::vector<cv::Rect> & rois, bool crop,
+    const std::vector<int64_t> & track_keys = std::vector<int64_t>());
+  /**
+   * @brief Observe the cached results of the tracked ROIs routed to an
+   * inference, and drop those ROIs so that only the stale ones are inferred.
+   * @param[in,out] rois The ROIs routed to the inference.
+   * @param[in,out] track_keys The track key of each ROI.
+   * @param[in] age The frames since the inference last ran, above 0 to take
+   * the cached results however old.
+   */
+  void serveCachedResults(
+    int node_id, std::shared_ptr<FrameContext> context,
+    std::vector<cv::Rect> & rois, std::vector<int64_t> & track_keys, int age = 0);
+  /**
+   * @brief Queue whole frames to a first-stage inference. Frames of different
+   * inputs share a batch if the inference is frame-batchable.
+   * @return Whether any batch is queued.
+   */
+  bool dispatchFrames(int node_id, const std::vector<std::shared_ptr<FrameContext>> & contexts);
+  /**
+   * @brief Route the tracked results of a frame the inference skips, if any,
+   * or the results of the previous frame if they may be reused.
+   * @param[in] reuse Whether the frame did not change from the last inferred
+   * one, or the inference doesn't run on it.
+   * @return Whether the frame is served without inference.
+   */
+  bool propagateFrame(
+    int node_id, std::shared_ptr<FrameContext> context, bool reuse,
+    std::vector<int> & next_stages);
+  /**
+   * @brief Whether a frame is gated out by the motion threshold of the pipeline.
+   */
+  bool isStillFrame(const std::shared_ptr<FrameContext> & context);
+  /**
+   * @brief Decide whether an inference with an execution rate runs on the
+   * next frame of an input, called once per frame.
+   * @return The frames since the inference last ran, 0 if it runs on the frame.
+   */
+  int updateResultAge(int node_id, int input_id, LatencyStats::Clock::time_point now);
+  /**
+   * @brief Release the contexts bound to the batch slots of an inference.
+   */
+  void releaseContexts(const std::vector<std::shared_ptr<FrameContext>> & contexts);
+  /**
+   * @brief Submit the pending batches of sibling inferences in parallel.
+   */
+  void submitConcurrently(const std::vector<int> & node_ids);
+  /**
+   * @brief Enqueue and submit pending batches while the inference has free
+   * requests.
+   */
+  void submitPending(int node_id);
+  /**
+   * @brief Whether an inference upstream of the given one has batches pending
+   * or running, i.e. may still route it ROIs.
+   */
+  bool isUpstreamBusy(int node_id);
+  /**
+   * @brief Submit the batches of the coalescing inferences held past their wait.
+   */
+  void flushHeldBatches();
+  /**
+   * @brief Estimate how long the given ROIs take to be inferred.
+   */
+  LatencyStats::Clock::duration estimateInferenceTime(int node_id, size_t rois);
   bool isLegalConnect(const std::string parent, const std::string child);
   int getCatagoryOrder(const std::string name);
   void countFPS();
@@ -155,21 +726,78 @@ private:
 
   std::shared_ptr<Input::BaseInputDevice> input_device_;
   std::string input_device_name_;
+  std::vector<std::shared_ptr<Input::BaseInputDevice>> input_devices_;
+  std::vector<std::string> input_device_names_;
+  std::map<std::string, std::map<std::string, std::shared_ptr<Outputs::BaseOutput>>>
+  input_to_outputs_;
   std::multimap<std::string, std::string> next_;
   std::map<std::string, std::shared_ptr<dynamic_vino_lib::BaseInference>> name_to_detection_map_;
   std::map<std::string, std::shared_ptr<Outputs::BaseOutput>> name_to_output_map_;
   int total_inference_ = 0;
   std::set<std::string> output_names_;
-  int width_ = 0;
-  int height_ = 0;
-  cv::Mat frame_;
-  // for multi threads
-  std::atomic<int> counter_;
-  std::mutex counter_mutex_;
-  std::condition_variable cv_;
+  // per-frame data
+  FrameContextPool context_pool_;
+  std::shared_ptr<FrameContext> current_context_;
+  std::mutex outputs_mutex_;
+  // compiled graph
+  std::vector<GraphNode> graph_nodes_;
+  std::map<std::string, int> graph_node_ids_;
+  std::vector<int> graph_input_ids_;
+  std::vector<InputRegion> input_regions_;
+  bool graph_dirty_ = true;
+  std::vector<int> coalescing_nodes_;
+  /**< shortest batch wait of the coalescing inferences, in ms >**/
+  float batch_wait_ = 0;
+  // inferences swapped in by the next runOnce
+  std::map<std::string, std::shared_ptr<dynamic_vino_lib::BaseInference>> replacements_;
+  struct JoiningInference
+  {
+    std::string name;
+    std::shared_ptr<dynamic_vino_lib::BaseInference> inference;
+    std::vector<std::pair<std::string, std::string>> connects;
+  };
+  // inferences added by the next runOnce, guarded by replacements_mutex_ too
+  std::vector<JoiningInference> joins_;
+  std::mutex replacements_mutex_;
+  // connections of the joined inferences to those not joined yet
+  std::vector<std::pair<std::string, std::string>> pending_connects_;
+  std::set<std::string> fallbacks_;
+  std::vector<std::string> power_reasons_;
+  // for multi-frame pipelining
+  std::deque<std::shared_ptr<FrameContext>> inflight_frames_;
+  std::mutex inflight_mutex_;
+  std::condition_variable inflight_cv_;
+  std::shared_ptr<std::thread> capture_thread_;
+  std::atomic<bool> capture_running_;
+  std::atomic<bool> capture_paused_;
+  std::atomic<bool> draining_;
+  /**< in capture order, touched by the pipeline thread only >**/
+  std::deque<DispatchedFrames> dispatched_frames_;
   int fps_ = 0;
   int frame_cnt_ = 0;
+  // for the frame policy
+  std::atomic<uint64_t> dropped_frames_;
+  // for the frame deadline
+  std::atomic<uint64_t> deadline_misses_;
+  std::atomic<uint64_t> deadline_skips_;
+  std::atomic<uint64_t> request_failures_;
+  std::atomic<float> rate_limit_;
+  std::atomic<float> power_limit_;
+  // for the power governor
+  std::atomic<uint64_t> gated_frames_;
+  std::atomic<uint64_t> still_frames_;
+  uint64_t dropped_frames_last_second_ = 0;
+  int dropped_fps_ = 0;
+  uint64_t read_frame_cnt_ = 0;
+  LatencyStats stats_;
+  PerfCounters perf_counters_;
+  std::chrono::time_point<std::chrono::steady_clock> last_accepted_frame_;
+  MotionGate motion_gate_;
   std::chrono::time_point<std::chrono::high_resolution_clock> t_start_;
+  // packs the ROIs of a batch concurrently, used by the dispatcher threads
+  std::shared_ptr<ThreadPool> preprocess_pool_;
+  // declared last so that the dispatcher threads are joined first
+  std::shared_ptr<ThreadPool> dispatcher_;
 };
 
 #endif  // DYNAMIC_VINO_LIB__PIPELINE_HPP_
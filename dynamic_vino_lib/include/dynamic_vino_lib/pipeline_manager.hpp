@@ -20,7 +20,10 @@
 #define DYNAMIC_VINO_LIB__PIPELINE_MANAGER_HPP_
 
 #include <vino_param_lib/param_manager.hpp>
+#include <sensor_msgs/msg/battery_state.hpp>
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <future>
 #include <map>
 #include <memory>
@@ -29,7 +32,9 @@
 #include <string>
 #include <vector>
 #include "dynamic_vino_lib/pipeline.hpp"
+#include "dynamic_vino_lib/power_governor.hpp"
 #include "dynamic_vino_lib/engines/engine_manager.hpp"
+#include "dynamic_vino_lib/outputs/ros_aggregate_output.hpp"
 
 /**
  * @class PipelineManager
@@ -52,14 +57,54 @@ public:
   std::shared_ptr<Pipeline> createPipeline(
     const Params::ParamManager::PipelineRawData & params,
     rclcpp::Node::SharedPtr node = nullptr);
+  /**
+  * @brief Create several pipelines. The networks of all the pipelines are
+  * loaded concurrently, and the pipelines are wired once all of them are ready,
+  * but the cascades of the staged_startup pipelines, which join them later.
+  * @return The created pipelines, in the order of the given parameters
+  * (nullptr for the ones failed, and the lazy ones, only registered).
+  */
+  std::vector<std::shared_ptr<Pipeline>> createPipelines(
+    const std::vector<Params::ParamManager::PipelineRawData> & params,
+    rclcpp::Node::SharedPtr node = nullptr);
 
+  /**
+  * @brief Spin the given nodes and the nodes of the pipeline inputs on a
+  * multi-threaded executor, until no pipeline is running or ROS shuts down.
+  * The input subscriptions and the pipeline service have callback groups of
+  * their own, so that they are served concurrently.
+  * @param[in] threads The executor threads, the number of cores if 0.
+  */
+  void spinAll(const std::vector<rclcpp::Node::SharedPtr> & nodes, size_t threads = 0);
+
+  /**
+   * @brief Stop a pipeline, join its threads and release it with its
+   * inferences (their networks are unloaded once no other pipeline shares them).
+   */
   void removePipeline(const std::string & name);
+  /**
+   * @brief Load the model of an inference of a running pipeline again, or a
+   * new model, in the background, warm it up and swap it into the pipeline
+   * between two frames. The frames keep being processed by the old network
+   * meanwhile. On failure the old network keeps running.
+   * @param[in] model Path of the new model, empty to load the current one again
+   * (e.g. once its files are replaced).
+   * @return Whether the load is started.
+   */
+  bool reloadInference(
+    const std::string & pipeline, const std::string & inference,
+    const std::string & model = "");
   PipelineManager & updatePipeline(
     const std::string & name,
     const Params::ParamManager::PipelineRawData & params);
 
   void runAll();
   void stopAll();
+  /**
+   * @brief Whether a pipeline is still running or paused, the others are
+   * stopped (e.g. by a service call, or once all their input frames are processed).
+   */
+  bool isAnyRunning();
   void joinAll();
   void runService();
 
@@ -71,6 +116,36 @@ public:
     PipelineState_ThreadPasued = 3,
     PipelineState_Error = 4
   };
+  /**
+   * @brief The state of a pipeline, read by its thread while the service
+   * changes it. It is changed under state_mutex_ so that the waits on
+   * state_cv_ see every change.
+   */
+  class AtomicPipelineState
+  {
+  public:
+    AtomicPipelineState(PipelineState state = PipelineState_ThreadNotCreated)  // NOLINT
+    : state_(state) {}
+    AtomicPipelineState(const AtomicPipelineState & other)
+    : state_(other.state_.load()) {}
+    AtomicPipelineState & operator=(const AtomicPipelineState & other)
+    {
+      state_ = other.state_.load();
+      return *this;
+    }
+    AtomicPipelineState & operator=(PipelineState state)
+    {
+      state_ = state;
+      return *this;
+    }
+    operator PipelineState() const  // NOLINT
+    {
+      return state_.load();
+    }
+
+  private:
+    std::atomic<PipelineState> state_;
+  };
   struct PipelineData
   {
     Params::ParamManager::PipelineRawData params;
@@ -79,7 +154,29 @@ public:
     std::vector<std::shared_ptr<rclcpp::Node>> spin_nodes;
     std::shared_ptr<std::thread> thread;
     std::shared_ptr<std::thread> thread_spin_nodes;
-    PipelineState state;
+    AtomicPipelineState state;
+    /**< the model loaded by reloadInference, if any >**/
+    std::shared_future<void> reload;
+    /**< the cascades of a staged_startup pipeline loading in the background >**/
+    std::vector<std::shared_future<void>> joining;
+    /**< when the pipeline was last paused or stopped >**/
+    std::chrono::steady_clock::time_point idle_since;
+    /**< the inferences whose engine failed, fallen back once at most >**/
+    std::set<std::string> failed_inferences;
+    /**< the variants the device of each inference supports, by inference >**/
+    std::map<std::string, std::vector<std::string>> variants;
+    /**< when the variant of each inference was last switched >**/
+    std::map<std::string, std::chrono::steady_clock::time_point> variant_switched;
+    /**< the inferences of input_shape "auto" reshaped to the input frames >**/
+    std::set<std::string> reshaped_inferences;
+    PowerGovernor governor;
+    /**< when the governor last sampled the signals >**/
+    std::chrono::steady_clock::time_point governed_at;
+    /**< the motion gate counts of the pipeline when last sampled >**/
+    uint64_t gated_frames = 0;
+    uint64_t still_frames = 0;
+    /**< the models the lightest variants were loaded in place of while saving, by inference >**/
+    std::map<std::string, std::string> saved_models;
   };
 
   struct ServiceData
@@ -89,6 +186,13 @@ public:
     PipelineState state;
   };
 
+  /**
+   * @brief Change the state of the given pipeline and wake up its thread.
+   * @param[in] name Name of the pipeline.
+   * @param[in] state The new state.
+   */
+  void setPipelineState(const std::string & name, PipelineState state);
+
   std::map<std::string, PipelineData> getPipelines()
   {
     return pipelines_;
@@ -106,13 +210,106 @@ private:
   PipelineManager(PipelineManager const &);
   void operator=(PipelineManager const &);
   void threadPipeline(const char * name);
+  /**
+   * @brief Log the memory held by the parts of a pipeline, once created.
+   */
+  void logMemoryUsage(const std::string & name, Pipeline & pipeline);
+  /**
+   * @brief Create a lazy or unloaded pipeline from its parameters and run it.
+   * @return Whether the pipeline is loaded.
+   */
+  bool loadPipeline(const std::string & name);
+  /**
+   * @brief Stop a pipeline and release it, its parameters stay registered.
+   */
+  void unloadPipeline(const std::string & name);
+  /**
+   * @brief Unload the pipelines paused or stopped for longer than their idle_unload.
+   */
+  void unloadIdlePipelines();
   void threadSpinNodes(const char * name);
   std::map<std::string, std::shared_ptr<Input::BaseInputDevice>>
   parseInputDevice(const PipelineData & params);
+  /**
+   * @brief Create the output devices of a pipeline.
+   * @param[in] output_name Name given to the output instances (used for the
+   * window and topic names), the pipeline name if empty.
+   * @param[in] merge Merge the aggregated results are published through, for
+   * the lanes of a segmented video, none otherwise.
+   */
   std::map<std::string, std::shared_ptr<Outputs::BaseOutput>>
-  parseOutput(const PipelineData & pdata);
+  parseOutput(
+    const PipelineData & pdata, const std::string & output_name = "",
+    std::shared_ptr<Outputs::FrameResultsMerge> merge = nullptr);
+  std::shared_ptr<Pipeline> createPipeline(
+    const Params::ParamManager::PipelineRawData & params,
+    rclcpp::Node::SharedPtr node,
+    const std::map<std::string, std::shared_ptr<dynamic_vino_lib::BaseInference>> & infers);
+  /**
+   * @brief Create the inferences of a pipeline, each one loading its network
+   * in its own task.
+   * @param[in] skipped The inferences not created, e.g. the cascades joining later.
+   */
   std::map<std::string, std::shared_ptr<dynamic_vino_lib::BaseInference>>
-  parseInference(const Params::ParamManager::PipelineRawData & params);
+  parseInference(
+    const Params::ParamManager::PipelineRawData & params,
+    const std::set<std::string> & skipped = {});
+  /**
+   * @brief Get the inferences of a staged_startup pipeline not connected from
+   * any input, which join the running pipeline once loaded. None otherwise.
+   */
+  static std::set<std::string> getCascades(const Params::ParamManager::PipelineRawData & params);
+  /**
+   * @brief Load the given cascades of a created pipeline in the background,
+   * each one joining the pipeline with its connections as soon as it is loaded.
+   */
+  void joinCascades(
+    const std::string & name, std::shared_ptr<Pipeline> pipeline,
+    const std::set<std::string> & cascades);
+  /**
+   * @brief Load an inference of a running pipeline in the background and swap
+   * it in, see reloadInference.
+   * @param[in] fallback Whether it replaces a failed engine, the pipeline is
+   * then limited to the fallback_fps of the inference.
+   */
+  bool loadInference(
+    const std::string & name, Params::ParamManager::InferenceRawData params, bool fallback);
+  /**
+   * @brief Set the model of an inference to the first of its variants the
+   * device supports, the model is kept if none is.
+   */
+  static void selectVariant(Params::ParamManager::InferenceRawData & infer);
+  /**
+   * @brief Cancel the requests of the pipeline over their timeout, load the
+   * inferences failing in a row on their fallback device, and switch the
+   * variants of the inferences over or well under their budget. The inferences
+   * of input_shape "auto" are reshaped once the input knows its frame size. Called by the
+   * pipeline thread between two frames.
+   */
+  void checkInferences(const std::string & name, PipelineData & data);
+  /**
+   * @brief Get the variants of an inference its device supports, from the most
+   * accurate to the lightest.
+   */
+  static const std::vector<std::string> & getSupportedVariants(
+    PipelineData & data, const Params::ParamManager::InferenceRawData & infer);
+  /**
+   * @brief Sample the signals of the power governor of the pipeline, once a
+   * second, and apply its mode: the saving_fps rate limit, the
+   * saving_detect_interval of the tracking detections and, with
+   * saving_variants, the lightest variant of the inferences. Called by the
+   * pipeline thread between two frames.
+   */
+  void governPower(const std::string & name, PipelineData & data);
+  /**
+   * @brief Add the thread binding of the pipeline CPUs to the plugin config of
+   * a CPU inference, the keys set in its config are kept.
+   */
+  static void addAffinityHints(
+    const Params::ParamManager::PipelineRawData & params, const std::vector<int> & cpus,
+    Params::ParamManager::InferenceRawData & infer);
+  std::shared_ptr<dynamic_vino_lib::BaseInference>
+  createInference(const Params::ParamManager::InferenceRawData & infer);
   std::shared_ptr<dynamic_vino_lib::BaseInference>
   createFaceDetection(const Params::ParamManager::InferenceRawData & infer);
   std::shared_ptr<dynamic_vino_lib::BaseInference>
@@ -140,6 +337,15 @@ private:
   std::map<std::string, PipelineData> pipelines_;
   ServiceData service_;
   Engines::EngineManager engine_manager_;
+  std::mutex state_mutex_;
+  std::condition_variable state_cv_;
+  /**< serializes the loading and unloading of the pipelines >**/
+  std::mutex lifecycle_mutex_;
+  /**< the executor of spinAll while it spins >**/
+  rclcpp::Executor * executor_ = nullptr;
+  rclcpp::Subscription<sensor_msgs::msg::BatteryState>::SharedPtr battery_sub_;
+  /**< the battery fraction of the battery_topic, -1 until received >**/
+  std::atomic<float> battery_level_{-1};
 };
 
 #endif  // DYNAMIC_VINO_LIB__PIPELINE_MANAGER_HPP_
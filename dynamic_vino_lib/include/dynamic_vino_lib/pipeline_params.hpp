@@ -27,6 +27,7 @@
 #include <mutex>
 #include <set>
 #include <string>
+#include <vector>
 
 #include "dynamic_vino_lib/inferences/base_inference.hpp"
 #include "dynamic_vino_lib/inputs/standard_camera.hpp"
@@ -41,11 +42,23 @@ const char kInputType_CameraTopic[] = "RealSenseCameraTopic";
 const char kInputType_ImageTopic[] = "ImageTopic";
 const char kInputType_RealSenseCamera[] = "RealSenseCamera";
 const char kInputType_ServiceImage[] = "ServiceImage";
+const char kInputType_ImageDirectory[] = "ImageDirectory";
+const char kInputType_FrameReplay[] = "FrameReplay";
+const char kInputType_GStreamer[] = "GStreamer";
 
 const char kOutputTpye_RViz[] = "RViz";
 const char kOutputTpye_ImageWindow[] = "ImageWindow";
 const char kOutputTpye_RosTopic[] = "RosTopic";
 const char kOutputTpye_RosService[] = "RosService";
+const char kOutputTpye_VideoWriter[] = "VideoWriter";
+const char kOutputTpye_SharedMemory[] = "SharedMemory";
+const char kOutputTpye_RosAggregate[] = "RosAggregate";
+const char kOutputTpye_ResultLog[] = "ResultLog";
+
+const char kFramePolicy_All[] = "all";
+const char kFramePolicy_Latest[] = "latest";
+const char kFramePolicy_Decimation[] = "decimation";
+const char kFramePolicy_TargetFps[] = "target_fps";
 
 const char kInferTpye_FaceDetection[] = "FaceDetection";
 const char kInferTpye_AgeGenderRecognition[] = "AgeGenderRecognition";
@@ -55,6 +68,7 @@ const char kInferTpye_ObjectDetection[] = "ObjectDetection";
 const char kInferTpye_ObjectSegmentation[] = "ObjectSegmentation";
 const char kInferTpye_ObjectDetectionTypeSSD[] = "SSD";
 const char kInferTpye_ObjectDetectionTypeYolov2[] = "yolov2";
+const char kInferTpye_ObjectDetectionTypeYolov3[] = "yolov3";
 const char kInferTpye_PersonReidentification[] = "PersonReidentification";
 const char kInferTpye_PersonAttribsDetection[] = "PersonAttribsDetection";
 const char kInferTpye_LandmarksDetection[] = "LandmarksDetection";
@@ -77,8 +91,111 @@ public:
   void update();
   void update(const Params::ParamManager::PipelineRawData & params);
   bool isOutputTo(std::string & name);
+  const std::string & getName() const
+  {
+    return params_.name;
+  }
   bool isGetFps();
+  /**
+   * @brief Get the device type of an input. Several inputs of the same type are
+   * told apart by a tag, e.g. "RealSenseCamera_front" is a RealSenseCamera.
+   */
+  static std::string getInputType(const std::string & input);
+  /**
+   * @brief Get the meta (path, uri or device parameters) of an input, the
+   * per-input value of "input_meta" if any, otherwise the shared "input_path".
+   */
+  const std::string & getInputMeta(const std::string & input) const;
+  /**
+   * @brief Get the region the first-stage inferences of an input run on:
+   * "x,y,width,height", "auto" to follow the previous detections, or empty
+   * for the whole frame.
+   */
+  const std::string & getInputRoi(const std::string & input) const;
   std::string findFilterConditions(const std::string & input, const std::string & output);
+  /**
+   * @brief Get the number of frames allowed to be in flight at the same time.
+   * The value 1 keeps the lock-step behavior (read, infer, output, read ...).
+   */
+  int getFramesInFlight() const
+  {
+    return params_.frames_in_flight;
+  }
+  /**
+   * @brief Get the rate-control policy applied to input frames, one of
+   * kFramePolicy_All (default), kFramePolicy_Latest, kFramePolicy_Decimation
+   * and kFramePolicy_TargetFps.
+   */
+  const std::string & getFramePolicy() const
+  {
+    return params_.frame_policy;
+  }
+  /**
+   * @brief Only one of every N frames is processed with kFramePolicy_Decimation.
+   */
+  int getFrameDecimation() const
+  {
+    return params_.frame_decimation;
+  }
+  /**
+   * @brief The maximum processing rate with kFramePolicy_TargetFps.
+   */
+  float getTargetFps() const
+  {
+    return params_.target_fps;
+  }
+  /**
+   * @brief Number of workers packing the ROIs of a batch into the input blob
+   * concurrently, 0 to pack them on the thread submitting the batch.
+   */
+  int getPreprocessThreads() const
+  {
+    return params_.preprocess_threads;
+  }
+  /**
+   * @brief The width the frames wider than it are downscaled to when read,
+   * keeping their aspect, for all the stages. 0 keeps the native frames.
+   */
+  int getWorkingWidth() const
+  {
+    return params_.working_width;
+  }
+  /**
+   * @brief The fraction of a frame thumbnail which has to change for the frame
+   * to be inferred, the still frames reuse the previous results. 0 infers all.
+   */
+  float getMotionThreshold() const
+  {
+    return params_.motion_threshold;
+  }
+  /**
+   * @brief The consecutive still frames at most served by reused results.
+   */
+  int getMotionMaxSkip() const
+  {
+    return params_.motion_max_skip;
+  }
+  /**
+   * @brief With an "auto" input roi, the frames between two inferences of the
+   * whole region, so that new objects are found outside the tracked extent.
+   */
+  int getRoiRefreshInterval() const
+  {
+    return params_.roi_refresh_interval;
+  }
+  /**
+   * @brief The milliseconds from the capture of a frame to its outputs, the
+   * inferences which would not finish in time are skipped. 0 for no deadline.
+   */
+  float getFrameDeadline() const
+  {
+    return params_.frame_deadline;
+  }
+  /**
+   * @brief Get the CPUs the threads of the pipeline are pinned onto: those of
+   * "cpu_set" on the NUMA node "numa_node", empty for no pinning.
+   */
+  std::vector<int> getAffinityCpus() const;
 
 private:
   Params::ParamManager::PipelineRawData params_;
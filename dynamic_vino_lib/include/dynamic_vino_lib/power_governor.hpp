@@ -0,0 +1,99 @@
+// Copyright (c) 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @brief a header file with declaration of PowerGovernor class
+ * @file power_governor.hpp
+ */
+#ifndef DYNAMIC_VINO_LIB__POWER_GOVERNOR_HPP_
+#define DYNAMIC_VINO_LIB__POWER_GOVERNOR_HPP_
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+/**
+ * @class PowerGovernor
+ * @brief Decides whether a pipeline runs at full rate or saves energy, from
+ * the activity of its scene, the battery level and the device temperature.
+ * A pipeline enters saving as soon as a signal crosses its threshold, and
+ * leaves it once every signal is back past a margin and the mode was held
+ * for a while, so that a signal near its threshold doesn't flip the mode.
+ * Not thread safe, updated by the pipeline thread.
+ */
+class PowerGovernor
+{
+public:
+  using Clock = std::chrono::steady_clock;
+
+  struct Policy
+  {
+    /**< fraction of the frames changed under which the scene is idle, 0 for none >**/
+    float idle_activity = 0;
+    /**< battery fraction under which energy is saved, 0 for none >**/
+    float battery_low = 0;
+    /**< degrees Celsius over which energy is saved, 0 for none >**/
+    float temperature_high = 0;
+
+    bool isEnabled() const
+    {
+      return idle_activity > 0 || battery_low > 0 || temperature_high > 0;
+    }
+  };
+
+  /**
+   * @brief The latest signals, -1 when unknown.
+   */
+  struct Signals
+  {
+    /**< fraction of the frames changed by the motion gate >**/
+    float activity = -1;
+    /**< battery fraction, from 0 to 1 >**/
+    float battery = -1;
+    /**< degrees Celsius >**/
+    float temperature = -1;
+  };
+
+  /**
+   * @brief Decide the mode from the latest signals.
+   * @return Whether the mode changed.
+   */
+  bool update(const Policy & policy, const Signals & signals, Clock::time_point now);
+  bool isSaving() const
+  {
+    return saving_;
+  }
+  /**
+   * @brief Get the signals energy is saved for: "idle", "battery" and "temperature".
+   */
+  const std::vector<std::string> & getReasons() const
+  {
+    return reasons_;
+  }
+  /**
+   * @brief Read a temperature file, in degrees or in millidegrees as the
+   * thermal zones of sysfs (e.g. /sys/class/thermal/thermal_zone0/temp).
+   * @return The degrees Celsius, -1 if the file can't be read.
+   */
+  static float readTemperature(const std::string & path);
+
+private:
+  bool hasReason(const std::string & reason) const;
+
+  bool saving_ = false;
+  std::vector<std::string> reasons_;
+  Clock::time_point changed_;
+};
+
+#endif  // DYNAMIC_VINO_LIB__POWER_GOVERNOR_HPP_
@@ -0,0 +1,144 @@
+// Copyright (c) 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @brief A header file with declaration for DetectionClient Class
+ * @file detection_client.hpp
+ */
+#ifndef DYNAMIC_VINO_LIB__SERVICES__DETECTION_CLIENT_HPP_
+#define DYNAMIC_VINO_LIB__SERVICES__DETECTION_CLIENT_HPP_
+
+#include <object_msgs/srv/detect_object.hpp>
+#include <people_msgs/srv/people.hpp>
+#include <rclcpp/rclcpp.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace vino_service
+{
+/**
+ * @class DetectionClient
+ * @brief A client of the detection services (see FrameProcessingServer),
+ * keeping several requests in flight instead of waiting for each response,
+ * so that the pipeline instances of the server are all busy. The responses
+ * are delivered through futures and callbacks, from the executor spinning the
+ * node. A request whose response doesn't come in time is sent again.
+ */
+template<typename T>
+class DetectionClient
+{
+public:
+  using Request = typename T::Request;
+  using Response = typename T::Response;
+  using ResponseFuture = std::shared_future<std::shared_ptr<Response>>;
+  /**
+   * @brief Called with a request and its response, or a null response once
+   * all its attempts timed out.
+   */
+  using Callback =
+    std::function<void (const std::shared_ptr<Request> &, const std::shared_ptr<Response> &)>;
+
+  /**
+   * @param[in] max_in_flight The requests waiting for their response at most,
+   * the others are queued. About the pipeline instances of the server.
+   * @param[in] timeout The time a response is waited for before the request
+   * is sent again.
+   * @param[in] retries The times a request is sent again at most, its future
+   * then gets an error.
+   */
+  DetectionClient(
+    const rclcpp::Node::SharedPtr & node, const std::string & service_name,
+    size_t max_in_flight = 8, std::chrono::milliseconds timeout = std::chrono::seconds(10),
+    int retries = 2);
+  /**
+   * @brief The requests not answered yet fail. The node should not be spun
+   * meanwhile.
+   */
+  ~DetectionClient();
+
+  bool waitForService(std::chrono::nanoseconds timeout);
+  /**
+   * @brief Send a request once fewer than max_in_flight are waiting for their
+   * response (Thread Safe).
+   */
+  ResponseFuture send(const std::shared_ptr<Request> & request, Callback callback = nullptr);
+  /**
+   * @brief Send the requests of a batch of images, in order. The services
+   * take one image per request, so a batch is sent as its requests, kept in
+   * flight together.
+   */
+  std::vector<ResponseFuture> sendBatch(
+    const std::vector<std::shared_ptr<Request>> & requests, Callback callback = nullptr);
+
+  /**
+   * @brief Get the requests waiting for their response, and those queued.
+   */
+  size_t getInFlight();
+  size_t getQueued();
+  /**
+   * @brief Get the times requests were sent again after a timeout.
+   */
+  uint64_t getRetries();
+
+private:
+  struct Call
+  {
+    std::shared_ptr<Request> request;
+    Callback callback;
+    std::promise<std::shared_ptr<Response>> promise;
+    int attempts = 0;
+    std::chrono::steady_clock::time_point sent;
+  };
+
+  /**
+   * @brief Send the queued calls while fewer than max_in_flight are in
+   * flight, called with the mutex held.
+   */
+  void dispatch();
+  /**
+   * @brief Send an attempt of a call, called with the mutex held. The
+   * response of an earlier attempt is ignored.
+   */
+  void sendAttempt(const std::shared_ptr<Call> & call);
+  void onResponse(uint64_t attempt, std::shared_ptr<Response> response);
+  /**
+   * @brief Send again the calls without response in time, or fail them.
+   */
+  void checkTimeouts();
+
+  rclcpp::Node::SharedPtr node_;
+  typename rclcpp::Client<T>::SharedPtr client_;
+  rclcpp::TimerBase::SharedPtr timer_;
+  size_t max_in_flight_;
+  std::chrono::milliseconds timeout_;
+  int retries_;
+
+  std::mutex mutex_;
+  std::deque<std::shared_ptr<Call>> queue_;
+  /**< by attempt, the calls waiting for their response >**/
+  std::map<uint64_t, std::shared_ptr<Call>> in_flight_;
+  uint64_t next_attempt_ = 0;
+  uint64_t retried_ = 0;
+};
+}  // namespace vino_service
+#endif  // DYNAMIC_VINO_LIB__SERVICES__DETECTION_CLIENT_HPP_
@@ -30,9 +30,16 @@
 #include <object_msgs/srv/detect_object.hpp>
 
 #include <rclcpp/rclcpp.hpp>
+#include <condition_variable>
+#include <deque>
 #include <memory>
+#include <mutex>
 #include <iostream>
 #include <string>
+#include <vector>
+
+#include "dynamic_vino_lib/pipeline.hpp"
+#include "dynamic_vino_lib/utils/lru_cache.hpp"
 
 namespace vino_service
 {
@@ -50,8 +57,23 @@ private:
     const std::shared_ptr<typename T::Request> request,
     std::shared_ptr<typename T::Response> response);
 
+  /**
+   * @brief Take a pipeline instance of the pool, waiting for one to be free.
+   */
+  std::shared_ptr<Pipeline> acquirePipeline();
+  void releasePipeline(std::shared_ptr<Pipeline> pipeline);
+
   // rclcpp::Service<T::template>::SharedPtr service_;
   std::shared_ptr<rclcpp::Service<T>> service_;
+  rclcpp::CallbackGroup::SharedPtr callback_group_;
+  /**< the instances of the pipeline not serving a request >**/
+  std::deque<std::shared_ptr<Pipeline>> free_pipelines_;
+  std::mutex pool_mutex_;
+  std::condition_variable pool_cv_;
+  /**< the responses to the images already served, null without response_cache >**/
+  std::unique_ptr<LruCache<std::string, typename T::Response>> response_cache_;
+  /**< hash of the configuration file, part of the keys of the responses >**/
+  std::string config_key_;
   std::string service_name_;
   std::string config_path_;
 };
@@ -17,9 +17,14 @@
 #include <pipeline_srv_msgs/msg/connection.hpp>
 #include <pipeline_srv_msgs/msg/pipeline_request.hpp>
 #include <pipeline_srv_msgs/msg/pipeline.hpp>
+#include <pipeline_srv_msgs/msg/stage_stats.hpp>
+#include <pipeline_srv_msgs/msg/layer_perf.hpp>
+#include <pipeline_srv_msgs/msg/memory_usage.hpp>
+#include <pipeline_srv_msgs/msg/pipelines_stats.hpp>
 #include <pipeline_srv_msgs/srv/pipeline_srv.hpp>
 #include <dynamic_vino_lib/pipeline_manager.hpp>
 #include <rclcpp/rclcpp.hpp>
+#include <chrono>
 #include <memory>
 #include <iostream>
 #include <string>
@@ -36,18 +41,53 @@ public:
 
 private:
   void initPipelineService();
+  /**
+   * @brief Publish the stats of all pipelines on /openvino_toolkit/pipelines/stats
+   * every 'period' seconds (see the common stats_period).
+   */
+  void initStatsTopic(double period);
+  void publishStats();
 
   // bool cbService(ros::ServiceEvent<typename T::Request,typename T::Response>& event);
   void cbService(
     const std::shared_ptr<typename T::Request> request,
     std::shared_ptr<typename T::Response> response);
 
+  /**
+   * @brief Fill the status of all pipelines into the response.
+   * @param[in] with_stats Whether to fill the stage latencies as well.
+   * @param[in] stats_pipeline Only fill the latencies of this pipeline, all if empty.
+   */
   void setResponse(
-    std::shared_ptr<typename T::Response> response);
+    std::shared_ptr<typename T::Response> response,
+    bool with_stats = false, const std::string & detail_pipeline = "",
+    bool with_perf_counts = false);
+  /**
+   * @brief Dump the performance counts of a pipeline to a CSV file, the
+   * request value is "<pipeline>[:<csv path>]".
+   */
+  void dumpPerfCounts(const std::string & value);
+  /**
+   * @brief Change the share of the shared devices given to a pipeline, the
+   * request value is "<pipeline>:<weight>".
+   */
+  void setPriority(const std::string & value);
+  /**
+   * @brief Load the model of an inference again (RELOAD_INFERENCE, the request
+   * value is "<pipeline>:<inference>") or a new one (SET_MODEL, the value is
+   * "<pipeline>:<inference>:<model path>"), and swap it into the running pipeline.
+   */
+  void reloadInference(const std::string & value, bool with_model);
 
   void setPipelineByRequest(std::string pipeline_name, PipelineManager::PipelineState state);
 
   std::shared_ptr<rclcpp::Service<T>> service_;
+  rclcpp::Publisher<pipeline_srv_msgs::msg::PipelinesStats>::SharedPtr stats_pub_;
+  rclcpp::TimerBase::SharedPtr stats_timer_;
+  /**< busy seconds of each device when the last stats were published >**/
+  std::map<std::string, double> last_busy_times_;
+  std::chrono::steady_clock::time_point last_stats_time_;
+  rclcpp::CallbackGroup::SharedPtr callback_group_;
   std::map<std::string, PipelineManager::PipelineData> * pipelines_;
   std::string service_name_;
 };
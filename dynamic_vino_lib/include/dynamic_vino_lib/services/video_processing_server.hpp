@@ -0,0 +1,87 @@
+// Copyright (c) 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @brief A header file with declaration for VideoProcessingServer Class
+ * @file video_processing_server.hpp
+ */
+#ifndef DYNAMIC_VINO_LIB__SERVICES__VIDEO_PROCESSING_SERVER_HPP_
+#define DYNAMIC_VINO_LIB__SERVICES__VIDEO_PROCESSING_SERVER_HPP_
+
+#include <pipeline_srv_msgs/action/process_video.hpp>
+#include <vino_param_lib/param_manager.hpp>
+#include <rclcpp/rclcpp.hpp>
+#include <rclcpp_action/rclcpp_action.hpp>
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace vino_service
+{
+/**
+ * @class VideoProcessingServer
+ * @brief Serves the ProcessVideo action: a goal runs a configured pipeline
+ * over a video file or stream as fast as it is decoded, not at its frame rate,
+ * on a copy of the pipeline of its own. The progress and the results are sent
+ * as feedback while the job runs, and a goal can be canceled between frames.
+ */
+class VideoProcessingServer : public rclcpp::Node
+{
+public:
+  using ProcessVideo = pipeline_srv_msgs::action::ProcessVideo;
+  using GoalHandle = rclcpp_action::ServerGoalHandle<ProcessVideo>;
+
+  explicit VideoProcessingServer(const std::string & config_path);
+  /**
+   * @brief Cancel the running jobs and join their threads.
+   */
+  ~VideoProcessingServer() override;
+
+private:
+  rclcpp_action::GoalResponse handleGoal(
+    const rclcpp_action::GoalUUID & uuid, std::shared_ptr<const ProcessVideo::Goal> goal);
+  rclcpp_action::CancelResponse handleCancel(const std::shared_ptr<GoalHandle> goal_handle);
+  void handleAccepted(const std::shared_ptr<GoalHandle> goal_handle);
+  /**
+   * @brief Run a job to its end, on its own thread.
+   */
+  void execute(const std::shared_ptr<GoalHandle> goal_handle);
+  /**
+   * @brief Get the parameters of the copy of a pipeline reading the video of a
+   * goal: its outputs are replaced by the feedback of the action, its inputs by
+   * the video, unpaced.
+   */
+  Params::ParamManager::PipelineRawData getJobParams(
+    const Params::ParamManager::PipelineRawData & params, const ProcessVideo::Goal & goal);
+
+  rclcpp_action::Server<ProcessVideo>::SharedPtr server_;
+  /**< the configured pipelines, by name >**/
+  std::map<std::string, Params::ParamManager::PipelineRawData> pipelines_;
+  /**< seconds between two feedbacks of a job >**/
+  double feedback_period_ = 0.5;
+
+  std::mutex mutex_;
+  /**< the pipelines are created and removed one at a time >**/
+  std::mutex lifecycle_mutex_;
+  std::vector<std::thread> jobs_;
+  uint64_t next_job_ = 0;
+  bool stopping_ = false;
+};
+}  // namespace vino_service
+#endif  // DYNAMIC_VINO_LIB__SERVICES__VIDEO_PROCESSING_SERVER_HPP_
@@ -21,6 +21,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <iostream>
 #include <string>
 
@@ -56,6 +57,55 @@ namespace slog
 #define BOLDWHITE   "\033[1m\033[37m"      /* Bold White */
 #endif
 
+/**
+ * @brief The levels of the log streams, the messages below the runtime level
+ * are dropped.
+ */
+enum LogLevel {
+  LEVEL_DEBUG = 0,
+  LEVEL_INFO = 1,
+  LEVEL_WARN = 2,
+  LEVEL_ERROR = 3,
+};
+
+inline std::atomic<int> & runtimeLevel()
+{
+  static std::atomic<int> level(LEVEL_INFO);
+  return level;
+}
+
+/**
+ * @brief Tell whether the messages of a level are logged (Thread Safe).
+ */
+inline bool isEnabled(int level)
+{
+  return level >= runtimeLevel().load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Set the lowest level logged, LEVEL_INFO by default.
+ */
+inline void setLevel(int level)
+{
+  runtimeLevel().store(level, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Set the lowest level logged by name: "debug", "info", "warn" or "error".
+ * @return False if the name is unknown, the level is left unchanged then.
+ */
+inline bool setLevel(const std::string & name)
+{
+  static const char * names[] = {"debug", "info", "warn", "error"};
+  for (int level = LEVEL_DEBUG; level <= LEVEL_ERROR; level++) {
+    if (name == names[level]) {
+      setLevel(level);
+      return true;
+    }
+  }
+  return false;
+}
+
 /**
  * @class LogStreamEndLine
  * @brief The LogStreamEndLine class implements an end line marker for a log
@@ -77,6 +127,7 @@ class LogStream
   std::ostream * _log_stream;
   bool _new_line;
   int _color_id;
+  int _level;
 
 public:
   /**
@@ -84,8 +135,8 @@ public:
    * @param prefix The prefix to print
    */
   LogStream(const std::string & prefix, std::ostream & log_stream,
-    const int color_id = -1)
-  : _prefix(prefix), _new_line(true), _color_id(color_id)
+    const int color_id = -1, const int level = LEVEL_INFO)
+  : _prefix(prefix), _new_line(true), _color_id(color_id), _level(level)
   {
     _log_stream = &log_stream;
   }
@@ -97,6 +148,9 @@ public:
   template<class T>
   LogStream & operator<<(const T & arg)
   {
+    if (!isEnabled(_level)) {
+      return *this;
+    }
     if (_new_line) {
       setLineColor();
       (*_log_stream)  << "[ " << _prefix << " ] ";
@@ -110,6 +164,9 @@ public:
   // Specializing for LogStreamEndLine to support slog::endl
   LogStream & operator<<(const LogStreamEndLine & arg)
   {
+    if (!isEnabled(_level)) {
+      return *this;
+    }
     _new_line = true;
     resetLineColor();
     (*_log_stream) << std::endl;
@@ -163,13 +220,25 @@ public:
 };
 
 #ifdef LOG_LEVEL_DEBUG
-  static LogStream debug("DEBUG", std::cout, GREEN);
+  static LogStream debug("DEBUG", std::cout, GREEN, LEVEL_DEBUG);
 #else
   static NullStream debug;
 #endif
-static LogStream info("INFO", std::cout, BLUE);
-static LogStream warn("WARNING", std::cout, YELLOW);
-static LogStream err("ERROR", std::cerr, RED);
+static LogStream info("INFO", std::cout, BLUE, LEVEL_INFO);
+static LogStream warn("WARNING", std::cout, YELLOW, LEVEL_WARN);
+static LogStream err("ERROR", std::cerr, RED, LEVEL_ERROR);
 
 }  // namespace slog
+
+/**
+ * @brief Log a debug message, e.g. SLOG_DEBUG << "fetched " << n << slog::endl.
+ * The message is not even formatted unless the runtime level is debug, and
+ * compiled out without LOG_LEVEL_DEBUG (release builds). Use it on hot paths
+ * rather than slog::debug, whose arguments are always evaluated.
+ */
+#ifdef LOG_LEVEL_DEBUG
+#define SLOG_DEBUG if (!slog::isEnabled(slog::LEVEL_DEBUG)) {} else slog::debug
+#else
+#define SLOG_DEBUG if (true) {} else slog::debug
+#endif
 #endif  // DYNAMIC_VINO_LIB__SLOG_HPP_
@@ -0,0 +1,80 @@
+// Copyright (c) 2018-2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// @brief the LTTng-UST tracepoint provider of the pipelines, only built with
+// DYNAMIC_VINO_LIB_TRACING. Include dynamic_vino_lib/tracing.hpp instead.
+// @file tracepoints.hpp
+//
+
+#undef TRACEPOINT_PROVIDER
+#define TRACEPOINT_PROVIDER dynamic_vino_lib
+
+#undef TRACEPOINT_INCLUDE
+#define TRACEPOINT_INCLUDE "dynamic_vino_lib/tracepoints.hpp"
+
+#if !defined(DYNAMIC_VINO_LIB__TRACEPOINTS_HPP_) || defined(TRACEPOINT_HEADER_MULTI_READ)
+#define DYNAMIC_VINO_LIB__TRACEPOINTS_HPP_
+
+#include <lttng/tracepoint.h>
+#include <stdint.h>
+
+// every event of a frame carries the pipeline, the node (input, inference or
+// output) and the id of the frame, plus a value depending on the event
+TRACEPOINT_EVENT_CLASS(
+  dynamic_vino_lib,
+  frame_event,
+  TP_ARGS(
+    const char *, pipeline_name,
+    const char *, node_name,
+    uint64_t, frame_id,
+    int64_t, value),
+  TP_FIELDS(
+    ctf_string(pipeline_name, pipeline_name)
+    ctf_string(node_name, node_name)
+    ctf_integer(uint64_t, frame_id, frame_id)
+    ctf_integer(int64_t, value, value)
+  )
+)
+
+#undef DYNAMIC_VINO_LIB_FRAME_EVENT
+#define DYNAMIC_VINO_LIB_FRAME_EVENT(event) \
+  TRACEPOINT_EVENT_INSTANCE( \
+    dynamic_vino_lib, frame_event, event, \
+    TP_ARGS( \
+      const char *, pipeline_name, \
+      const char *, node_name, \
+      uint64_t, frame_id, \
+      int64_t, value))
+
+// the frame is read from the input, value: the input index
+DYNAMIC_VINO_LIB_FRAME_EVENT(read)
+// a region of the frame is enqueued into the batch of the inference, value: the batch slot
+DYNAMIC_VINO_LIB_FRAME_EVENT(enqueue)
+// the request holding the frame is admitted and started, value: the request id
+DYNAMIC_VINO_LIB_FRAME_EVENT(submit)
+// the request is completed by the plugin, value: the request id
+DYNAMIC_VINO_LIB_FRAME_EVENT(completion)
+// the results of the request are fetched, value: the request id
+DYNAMIC_VINO_LIB_FRAME_EVENT(fetch_results)
+// the results are filtered into the regions of the next inference, value: the regions
+DYNAMIC_VINO_LIB_FRAME_EVENT(filter)
+// the results are accepted by the output, value: the results
+DYNAMIC_VINO_LIB_FRAME_EVENT(accept)
+// a message of the frame is published by the output (node: the topic), value: 0
+DYNAMIC_VINO_LIB_FRAME_EVENT(publish)
+
+#endif  // DYNAMIC_VINO_LIB__TRACEPOINTS_HPP_
+
+#include <lttng/tracepoint-event.h>
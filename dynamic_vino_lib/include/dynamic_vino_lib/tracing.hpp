@@ -0,0 +1,43 @@
+// Copyright (c) 2018-2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// @brief the tracing hooks of the pipelines. Built with DYNAMIC_VINO_LIB_TRACING
+// they are LTTng-UST tracepoints of the provider dynamic_vino_lib, captured e.g.
+// by "ros2 trace -u 'dynamic_vino_lib:*'" along with the ROS 2 ones, otherwise
+// they compile to nothing. The arguments are only evaluated while the event is
+// enabled in a tracing session.
+// @file tracing.hpp
+//
+
+#ifndef DYNAMIC_VINO_LIB__TRACING_HPP_
+#define DYNAMIC_VINO_LIB__TRACING_HPP_
+
+#ifdef DYNAMIC_VINO_LIB_TRACING
+#include "dynamic_vino_lib/tracepoints.hpp"
+
+/**
+ * @brief Trace an event of a frame (see tracepoints.hpp for the events).
+ * @param[in] pipeline The name of the pipeline (std::string).
+ * @param[in] node The name of the node (std::string).
+ */
+#define DYNAMIC_VINO_LIB_TRACE(event, pipeline, node, frame_id, value) \
+  tracepoint( \
+    dynamic_vino_lib, event, (pipeline).c_str(), (node).c_str(), \
+    static_cast<uint64_t>(frame_id), static_cast<int64_t>(value))
+#else
+#define DYNAMIC_VINO_LIB_TRACE(event, pipeline, node, frame_id, value) ((void)0)
+#endif
+
+#endif  // DYNAMIC_VINO_LIB__TRACING_HPP_
@@ -0,0 +1,114 @@
+// Copyright (c) 2018-2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// @brief utility functions to pack interleaved (HWC) images into planar (CHW) blob memory.
+// @file blob_packing.hpp
+//
+
+#ifndef DYNAMIC_VINO_LIB__UTILS__BLOB_PACKING_HPP_
+#define DYNAMIC_VINO_LIB__UTILS__BLOB_PACKING_HPP_
+
+#include <cstdint>
+#include <vector>
+
+#include "inference_engine.hpp"
+#include "opencv2/opencv.hpp"
+
+//
+// The kernels below go through cv::split/convertTo, which OpenCV implements
+// with its universal intrinsics (SSE/AVX2/NEON picked at build or run time),
+// instead of reading the image pixel by pixel.
+//
+
+/**
+ * @brief Wrap each channel plane of dst as a Mat of the given type.
+ */
+inline std::vector<cv::Mat> planarViews(const cv::Mat & image, void * dst, int type)
+{
+  std::vector<cv::Mat> planes;
+  const size_t plane_size = image.total() * CV_ELEM_SIZE(type);
+  for (int c = 0; c < image.channels(); c++) {
+    planes.emplace_back(image.size(), type, static_cast<uint8_t *>(dst) + c * plane_size);
+  }
+  return planes;
+}
+
+/**
+ * @brief Pack a U8 image into U8 planes, scaled unless scale is 1.
+ */
+inline void packToPlanar(const cv::Mat & image, uint8_t * dst, float scale = 1.0)
+{
+  auto planes = planarViews(image, dst, CV_8UC1);
+  if (scale == 1.0) {
+    cv::split(image, planes);
+    return;
+  }
+  std::vector<cv::Mat> channels;
+  cv::split(image, channels);
+  for (size_t c = 0; c < channels.size(); c++) {
+    channels[c].convertTo(planes[c], CV_8U, scale);
+  }
+}
+
+/**
+ * @brief Pack a U8 image into FP32 planes, scaled by scale.
+ */
+inline void packToPlanar(const cv::Mat & image, float * dst, float scale = 1.0)
+{
+  auto planes = planarViews(image, dst, CV_32FC1);
+  std::vector<cv::Mat> channels;
+  cv::split(image, channels);
+  for (size_t c = 0; c < channels.size(); c++) {
+    channels[c].convertTo(planes[c], CV_32F, scale);
+  }
+}
+
+#if CV_VERSION_MAJOR >= 4
+/**
+ * @brief Pack a U8 image into FP16 planes, scaled by scale.
+ */
+inline void packToPlanar(const cv::Mat & image, InferenceEngine::ie_fp16 * dst, float scale = 1.0)
+{
+  auto planes = planarViews(image, dst, CV_16FC1);
+  std::vector<cv::Mat> channels;
+  cv::split(image, channels);
+  cv::Mat scaled;
+  for (size_t c = 0; c < channels.size(); c++) {
+    channels[c].convertTo(scaled, CV_32F, scale);
+    scaled.convertTo(planes[c], CV_16F);
+  }
+}
+#endif
+
+/**
+ * @brief Generic fallback for the other blob types.
+ */
+template<typename T>
+void packToPlanar(const cv::Mat & image, T * dst, float scale = 1.0)
+{
+  const int width = image.cols;
+  const int height = image.rows;
+  const int channels = image.channels();
+  for (int h = 0; h < height; h++) {
+    const uint8_t * row = image.ptr<uint8_t>(h);
+    for (int w = 0; w < width; w++) {
+      for (int c = 0; c < channels; c++) {
+        dst[c * width * height + h * width + w] = row[w * channels + c] * scale;
+      }
+    }
+  }
+}
+
+#endif  // DYNAMIC_VINO_LIB__UTILS__BLOB_PACKING_HPP_
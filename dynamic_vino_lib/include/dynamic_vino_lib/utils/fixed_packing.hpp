@@ -0,0 +1,162 @@
+// Copyright (c) 2018-2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// @brief the blob packing kernels specialized for the fixed input shapes of
+// the attribute and reidentification models.
+// @file fixed_packing.hpp
+//
+
+#ifndef DYNAMIC_VINO_LIB__UTILS__FIXED_PACKING_HPP_
+#define DYNAMIC_VINO_LIB__UTILS__FIXED_PACKING_HPP_
+
+#include <cstddef>
+#include <cstdint>
+
+//
+// The inputs of these models are packed once per ROI, where the generic
+// kernels spend more time splitting into temporary planes than copying the
+// few pixels. With the sizes known at compile time, the loops below are
+// unrolled and vectorized by the compiler and write the planes directly.
+//
+
+struct FixedShape
+{
+  size_t width;
+  size_t height;
+  size_t channels;
+};
+
+/**
+ * @brief The shapes with a specialized kernel, as X(width, height, channels):
+ * both the table of the shapes and the kernels of dispatchFixedShape are
+ * generated from this list, so that their indexes match.
+ */
+#define DYNAMIC_VINO_LIB_FIXED_SHAPES(X) \
+  X(62, 62, 3)  /* age-gender */ \
+  X(64, 64, 3)  /* emotions */ \
+  X(60, 60, 3)  /* head pose */ \
+  X(48, 48, 3)  /* facial landmarks */ \
+  X(72, 72, 3)  /* vehicle attributes */ \
+  X(128, 128, 3)  /* face reidentification */ \
+  X(48, 96, 3)  /* person reidentification */ \
+  X(128, 256, 3)  /* person reidentification */ \
+  X(80, 160, 3)  /* person attributes */
+
+#define DYNAMIC_VINO_LIB_FIXED_SHAPE_ENTRY(W, H, C) {W, H, C},
+const FixedShape kFixedShapes[] = {
+  DYNAMIC_VINO_LIB_FIXED_SHAPES(DYNAMIC_VINO_LIB_FIXED_SHAPE_ENTRY)
+};
+#undef DYNAMIC_VINO_LIB_FIXED_SHAPE_ENTRY
+
+/**
+ * @brief Get the specialized kernel of a blob shape, -1 if none. Looked up
+ * once when the blob is bound.
+ */
+inline int findFixedShape(size_t width, size_t height, size_t channels)
+{
+  for (size_t i = 0; i < sizeof(kFixedShapes) / sizeof(kFixedShapes[0]); i++) {
+    const FixedShape & shape = kFixedShapes[i];
+    if (shape.width == width && shape.height == height && shape.channels == channels) {
+      return static_cast<int>(i);
+    }
+  }
+  return -1;
+}
+
+/**
+ * @brief Pack an interleaved U8 image of W x H pixels of C channels into
+ * planes, scaled if Scaled.
+ */
+template<size_t W, size_t H, size_t C, bool Scaled, typename T>
+void packFixedPlanes(const uint8_t * src, size_t step, T * dst, float scale)
+{
+  for (size_t h = 0; h < H; h++) {
+    const uint8_t * row = src + h * step;
+    T * out = dst + h * W;
+    for (size_t w = 0; w < W; w++) {
+      for (size_t c = 0; c < C; c++) {
+        out[c * W * H + w] = Scaled ?
+          static_cast<T>(row[w * C + c] * scale) : static_cast<T>(row[w * C + c]);
+      }
+    }
+  }
+}
+
+template<size_t W, size_t H, size_t C, typename T>
+void packFixed(const uint8_t * src, size_t step, T * dst, float scale)
+{
+  if (scale == 1.0f) {
+    packFixedPlanes<W, H, C, false>(src, step, dst, scale);
+  } else {
+    packFixedPlanes<W, H, C, true>(src, step, dst, scale);
+  }
+}
+
+/**
+ * @brief The kernels of the shapes, in the order of kFixedShapes.
+ */
+template<typename T>
+struct FixedKernels
+{
+  using Kernel = void (*)(const uint8_t *, size_t, T *, float);
+
+#define DYNAMIC_VINO_LIB_FIXED_KERNEL_ENTRY(W, H, C) &packFixed<W, H, C, T>,
+  static constexpr Kernel kernels[] = {
+    DYNAMIC_VINO_LIB_FIXED_SHAPES(DYNAMIC_VINO_LIB_FIXED_KERNEL_ENTRY)
+  };
+#undef DYNAMIC_VINO_LIB_FIXED_KERNEL_ENTRY
+
+  static_assert(sizeof(kernels) / sizeof(kernels[0]) ==
+    sizeof(kFixedShapes) / sizeof(kFixedShapes[0]),
+    "a fixed shape without its kernel");
+};
+
+template<typename T>
+constexpr typename FixedKernels<T>::Kernel FixedKernels<T>::kernels[];
+
+template<typename T>
+bool dispatchFixedShape(int shape, const uint8_t * src, size_t step, T * dst, float scale)
+{
+  const int count = static_cast<int>(sizeof(kFixedShapes) / sizeof(kFixedShapes[0]));
+  if (shape < 0 || shape >= count) {
+    return false;
+  }
+  FixedKernels<T>::kernels[shape](src, step, dst, scale);
+  return true;
+}
+
+/**
+ * @brief Pack an image of a fixed shape (see findFixedShape) into U8 or FP32
+ * planes. The image must have the size and channels of the shape.
+ * @return False for the other shapes and blob types, and the scaled U8 blobs
+ * (saturated by the generic kernels), left to the generic kernels.
+ */
+template<typename T>
+bool packFixedShape(int, const uint8_t *, size_t, T *, float)
+{
+  return false;
+}
+
+inline bool packFixedShape(int shape, const uint8_t * src, size_t step, uint8_t * dst, float scale)
+{
+  return scale == 1.0f && dispatchFixedShape(shape, src, step, dst, scale);
+}
+
+inline bool packFixedShape(int shape, const uint8_t * src, size_t step, float * dst, float scale)
+{
+  return dispatchFixedShape(shape, src, step, dst, scale);
+}
+
+#endif  // DYNAMIC_VINO_LIB__UTILS__FIXED_PACKING_HPP_
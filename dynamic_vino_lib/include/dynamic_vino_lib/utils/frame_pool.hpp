@@ -0,0 +1,240 @@
+// Copyright (c) 2018-2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// @brief a utility class recycling the pixel buffers of frames (Thread Safe).
+// @file frame_pool.hpp
+//
+
+#ifndef DYNAMIC_VINO_LIB__UTILS__FRAME_POOL_HPP_
+#define DYNAMIC_VINO_LIB__UTILS__FRAME_POOL_HPP_
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "opencv2/opencv.hpp"
+
+/**
+ * A cv::MatAllocator keeping the buffers of released Mats in per-size free
+ * lists. cv::Mat already refcounts its buffer, so Mats created with the pool
+ * are handed around as usual (shallow copies are borrowed handles) and their
+ * buffer goes back to the pool once the last handle is released. In steady
+ * state frames of the same size reuse the same slabs and nothing is allocated.
+ */
+class FramePool : public cv::MatAllocator
+{
+public:
+#if CV_VERSION_MAJOR >= 4
+  using AccessFlags = cv::AccessFlag;
+#else
+  using AccessFlags = int;
+#endif
+
+  /**
+   * @brief Get the process-wide pool. It is never destroyed, as pooled Mats
+   * may outlive any static owner.
+   */
+  static FramePool & getInstance()
+  {
+    static FramePool * pool = new FramePool();
+    return *pool;
+  }
+
+  /**
+   * @brief Let the buffer of 'mat' be allocated from the pool the next time
+   * it is (re)created, e.g. by copyTo, resize or a device read.
+   */
+  static void attach(cv::Mat & mat)
+  {
+    mat.allocator = &getInstance();
+  }
+
+  /**
+   * @brief Get a Mat of the given size and type backed by a pooled buffer.
+   */
+  static cv::Mat create(const cv::Size & size, int type)
+  {
+    cv::Mat mat;
+    attach(mat);
+    mat.create(size, type);
+    return mat;
+  }
+
+  /**
+   * @brief Deep copy 'src' into a pooled Mat.
+   */
+  static cv::Mat clone(const cv::Mat & src)
+  {
+    cv::Mat mat;
+    attach(mat);
+    src.copyTo(mat);
+    return mat;
+  }
+
+  /**
+   * @brief Wrap pixels owned by something else (e.g. a ROS message or a
+   * camera frame) into a Mat without copying them. 'owner' is kept alive
+   * until the last copy of the returned Mat is released.
+   */
+  static cv::Mat wrap(const cv::Mat & pixels, std::shared_ptr<void> owner)
+  {
+    static ExternalAllocator allocator;
+    cv::Mat mat(pixels.rows, pixels.cols, pixels.type(), pixels.data, pixels.step);
+    cv::UMatData * u = new cv::UMatData(&allocator);
+    u->data = u->origdata = pixels.data;
+    u->size = pixels.step[0] * pixels.rows;
+    u->flags |= cv::UMatData::USER_ALLOCATED;
+    u->userdata = new std::shared_ptr<void>(std::move(owner));
+    u->refcount = 1;
+    mat.u = u;  // released through u->currAllocator
+    return mat;
+  }
+
+  cv::UMatData * allocate(
+    int dims, const int * sizes, int type, void * data0, size_t * step,
+    AccessFlags, cv::UMatUsageFlags) const override
+  {
+    size_t total = CV_ELEM_SIZE(type);
+    for (int i = dims - 1; i >= 0; i--) {
+      if (step) {
+        if (data0 && step[i] != CV_AUTOSTEP) {
+          total = step[i];
+        } else {
+          step[i] = total;
+        }
+      }
+      total *= sizes[i];
+    }
+
+    cv::UMatData * u = new cv::UMatData(this);
+    u->data = u->origdata = data0 ? static_cast<uchar *>(data0) : take(total);
+    u->size = total;
+    if (data0) {
+      u->flags |= cv::UMatData::USER_ALLOCATED;
+    }
+    return u;
+  }
+
+  bool allocate(cv::UMatData * u, AccessFlags, cv::UMatUsageFlags) const override
+  {
+    return u != nullptr;
+  }
+
+  void deallocate(cv::UMatData * u) const override
+  {
+    if (u == nullptr) {
+      return;
+    }
+    if (!(u->flags & cv::UMatData::USER_ALLOCATED)) {
+      giveBack(u->origdata, u->size);
+    }
+    delete u;
+  }
+
+  /**
+   * @brief The number of free buffers kept per size, the others are freed.
+   */
+  void setMaxFreeBuffers(size_t max)
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    max_free_ = max;
+  }
+  /**
+   * @brief The bytes of the buffers allocated by the pool, in use or free.
+   */
+  size_t getAllocatedBytes() const
+  {
+    return allocated_bytes_;
+  }
+  /**
+   * @brief The bytes of the free buffers kept for reuse.
+   */
+  size_t getFreeBytes() const
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    return free_bytes_;
+  }
+
+private:
+  /**
+   * Releases the owner of wrapped pixels, allocations go to the default one.
+   */
+  class ExternalAllocator : public cv::MatAllocator
+  {
+  public:
+    cv::UMatData * allocate(
+      int dims, const int * sizes, int type, void * data, size_t * step,
+      AccessFlags flags, cv::UMatUsageFlags usage) const override
+    {
+      return cv::Mat::getStdAllocator()->allocate(dims, sizes, type, data, step, flags, usage);
+    }
+    bool allocate(cv::UMatData * u, AccessFlags flags, cv::UMatUsageFlags usage) const override
+    {
+      return cv::Mat::getStdAllocator()->allocate(u, flags, usage);
+    }
+    void deallocate(cv::UMatData * u) const override
+    {
+      if (u == nullptr) {
+        return;
+      }
+      delete static_cast<std::shared_ptr<void> *>(u->userdata);
+      delete u;
+    }
+  };
+
+  FramePool()
+  : allocated_bytes_(0) {}
+
+  uchar * take(size_t size) const
+  {
+    {
+      std::lock_guard<std::mutex> lk(mutex_);
+      auto it = free_.find(size);
+      if (it != free_.end() && !it->second.empty()) {
+        uchar * data = it->second.back();
+        it->second.pop_back();
+        free_bytes_ -= size;
+        return data;
+      }
+    }
+    allocated_bytes_ += size;
+    return static_cast<uchar *>(cv::fastMalloc(size));
+  }
+
+  void giveBack(uchar * data, size_t size) const
+  {
+    {
+      std::lock_guard<std::mutex> lk(mutex_);
+      auto & buffers = free_[size];
+      if (buffers.size() < max_free_) {
+        buffers.push_back(data);
+        free_bytes_ += size;
+        return;
+      }
+    }
+    allocated_bytes_ -= size;
+    cv::fastFree(data);
+  }
+
+  mutable std::map<size_t, std::vector<uchar *>> free_;
+  mutable std::mutex mutex_;
+  size_t max_free_ = 32;
+  mutable std::atomic<size_t> allocated_bytes_;
+  mutable size_t free_bytes_ = 0;
+};
+
+#endif  // DYNAMIC_VINO_LIB__UTILS__FRAME_POOL_HPP_
@@ -0,0 +1,131 @@
+// Copyright (c) 2018-2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// @brief a utility class to collect rolling latency percentiles per stage (Thread Safe).
+// @file latency_stats.hpp
+//
+
+#ifndef DYNAMIC_VINO_LIB__UTILS__LATENCY_STATS_HPP_
+#define DYNAMIC_VINO_LIB__UTILS__LATENCY_STATS_HPP_
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class LatencyStats
+{
+public:
+  using Clock = std::chrono::steady_clock;
+
+  struct Summary
+  {
+    std::string stage;
+    uint64_t count = 0;
+    double mean = 0;
+    double p50 = 0;
+    double p95 = 0;
+    double p99 = 0;
+  };
+
+  /**
+   * @brief The percentiles are computed over the last 'window' samples of each stage.
+   */
+  explicit LatencyStats(size_t window = 300)
+  : window_(std::max<size_t>(1, window)) {}
+
+  /**
+   * @brief Record one latency sample (in milliseconds) of the given stage.
+   */
+  void add(const std::string & stage, double ms)
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    auto & samples = samples_[stage];
+    samples.values.push_back(ms);
+    if (samples.values.size() > window_) {
+      samples.values.pop_front();
+    }
+    samples.count++;
+  }
+
+  /**
+   * @brief Record the time elapsed since 'start' for the given stage.
+   */
+  void add(const std::string & stage, const Clock::time_point & start)
+  {
+    add(stage, elapsed(start));
+  }
+
+  static double elapsed(const Clock::time_point & start)
+  {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+  }
+
+  std::vector<Summary> summarize()
+  {
+    std::vector<Summary> summaries;
+    std::lock_guard<std::mutex> lk(mutex_);
+    for (auto & pair : samples_) {
+      std::vector<double> values(pair.second.values.begin(), pair.second.values.end());
+      if (values.empty()) {
+        continue;
+      }
+      std::sort(values.begin(), values.end());
+      Summary summary;
+      summary.stage = pair.first;
+      summary.count = pair.second.count;
+      double sum = 0;
+      for (auto value : values) {
+        sum += value;
+      }
+      summary.mean = sum / values.size();
+      summary.p50 = percentile(values, 0.50);
+      summary.p95 = percentile(values, 0.95);
+      summary.p99 = percentile(values, 0.99);
+      summaries.push_back(summary);
+    }
+    return summaries;
+  }
+
+  void clear()
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    samples_.clear();
+  }
+
+private:
+  struct Samples
+  {
+    std::deque<double> values;
+    uint64_t count = 0;
+  };
+
+  // nearest-rank percentile of sorted values
+  static double percentile(const std::vector<double> & sorted, double p)
+  {
+    size_t rank = static_cast<size_t>(std::ceil(p * sorted.size()));
+    return sorted[std::min(sorted.size(), std::max<size_t>(1, rank)) - 1];
+  }
+
+  size_t window_;
+  std::map<std::string, Samples> samples_;
+  std::mutex mutex_;
+};
+
+#endif  // DYNAMIC_VINO_LIB__UTILS__LATENCY_STATS_HPP_
@@ -0,0 +1,129 @@
+// Copyright (c) 2018-2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// @brief utility class memoizing values by key, the least recently used ones
+// dropped first and each one for a time to live at most.
+// @file lru_cache.hpp
+//
+
+#ifndef DYNAMIC_VINO_LIB__UTILS__LRU_CACHE_HPP_
+#define DYNAMIC_VINO_LIB__UTILS__LRU_CACHE_HPP_
+
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+/**
+ * @brief Hash bytes with 64-bit FNV-1a, e.g. the content of an image, chained
+ * from a previous hash to cover several buffers.
+ */
+inline uint64_t hashBytes(const void * data, size_t size, uint64_t hash = 14695981039346656037ULL)
+{
+  auto bytes = static_cast<const uint8_t *>(data);
+  for (size_t i = 0; i < size; i++) {
+    hash = (hash ^ bytes[i]) * 1099511628211ULL;
+  }
+  return hash;
+}
+
+/**
+ * @class LruCache
+ * @brief A thread-safe cache of at most 'capacity' values. With a time to live
+ * the values older than it are not served anymore.
+ */
+template<typename Key, typename Value>
+class LruCache
+{
+public:
+  using Clock = std::chrono::steady_clock;
+
+  /**
+   * @param[in] ttl Time a value is served for, 0 for as long as it is cached.
+   */
+  LruCache(size_t capacity, Clock::duration ttl)
+  : capacity_(capacity), ttl_(ttl) {}
+
+  /**
+   * @brief Copy the value of the key, which becomes the most recently used.
+   * @return False if the key is not cached, or its value expired.
+   */
+  bool get(const Key & key, Value & value)
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    auto found = index_.find(key);
+    if (found == index_.end()) {
+      return false;
+    }
+    auto entry = found->second;
+    if (ttl_ > Clock::duration::zero() && Clock::now() - entry->stored > ttl_) {
+      index_.erase(found);
+      entries_.erase(entry);
+      return false;
+    }
+    entries_.splice(entries_.begin(), entries_, entry);
+    value = entry->value;
+    return true;
+  }
+
+  /**
+   * @brief Cache the value of the key, dropping the least recently used value
+   * if the cache is full.
+   */
+  void put(const Key & key, const Value & value)
+  {
+    if (capacity_ == 0) {
+      return;
+    }
+    std::lock_guard<std::mutex> lk(mutex_);
+    auto found = index_.find(key);
+    if (found != index_.end()) {
+      entries_.erase(found->second);
+      index_.erase(found);
+    }
+    entries_.push_front(Entry{key, value, Clock::now()});
+    index_[key] = entries_.begin();
+    while (entries_.size() > capacity_) {
+      index_.erase(entries_.back().key);
+      entries_.pop_back();
+    }
+  }
+
+  size_t size()
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    return entries_.size();
+  }
+
+private:
+  struct Entry
+  {
+    Key key;
+    Value value;
+    Clock::time_point stored;
+  };
+
+  size_t capacity_;
+  Clock::duration ttl_;
+  /**< most recently used first >**/
+  std::list<Entry> entries_;
+  std::unordered_map<Key, typename std::list<Entry>::iterator> index_;
+  std::mutex mutex_;
+};
+
+#endif  // DYNAMIC_VINO_LIB__UTILS__LRU_CACHE_HPP_
@@ -0,0 +1,113 @@
+// Copyright (c) 2018-2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// @brief utility functions to run-length encode the class maps of segmentation
+// results, whole (keyframes) or as the changes from the previous map (deltas).
+// @file mask_codec.hpp
+//
+
+#ifndef DYNAMIC_VINO_LIB__UTILS__MASK_CODEC_HPP_
+#define DYNAMIC_VINO_LIB__UTILS__MASK_CODEC_HPP_
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "opencv2/opencv.hpp"
+
+// the values of the encodings in people_msgs/ObjectInMask.mask_encoding
+const char kMaskEncoding_Rle[] = "rle";
+const char kMaskEncoding_RleDelta[] = "rle_delta";
+
+// the run value of the pixels a delta leaves as in the previous map
+const uint32_t kMaskUnchanged = 0xffffffff;
+
+/**
+ * @brief Encode a class map (CV_8UC1 or CV_16UC1) as (value, length) runs in
+ * row major order. With a previous map of the same size the runs are a delta:
+ * the pixels unchanged from it are kMaskUnchanged.
+ */
+inline void encodeMaskRuns(
+  const cv::Mat & class_map, const cv::Mat & previous, std::vector<uint32_t> & runs)
+{
+  runs.clear();
+  cv::Mat map, last;
+  class_map.convertTo(map, CV_16U);
+  bool delta = !previous.empty() && previous.size() == class_map.size();
+  if (delta) {
+    previous.convertTo(last, CV_16U);
+  }
+  uint32_t value = 0;
+  uint32_t length = 0;
+  for (int row = 0; row < map.rows; row++) {
+    const uint16_t * pixels = map.ptr<uint16_t>(row);
+    const uint16_t * last_pixels = delta ? last.ptr<uint16_t>(row) : nullptr;
+    for (int col = 0; col < map.cols; col++) {
+      uint32_t pixel = (delta && pixels[col] == last_pixels[col]) ? kMaskUnchanged : pixels[col];
+      if (length > 0 && pixel == value) {
+        length++;
+        continue;
+      }
+      if (length > 0) {
+        runs.push_back(value);
+        runs.push_back(length);
+      }
+      value = pixel;
+      length = 1;
+    }
+  }
+  if (length > 0) {
+    runs.push_back(value);
+    runs.push_back(length);
+  }
+}
+
+/**
+ * @brief Decode the runs into a CV_16UC1 class map. A delta is applied onto
+ * 'class_map', which holds the previous map.
+ * @return False if the runs do not cover the map, or a delta has no previous map.
+ */
+inline bool decodeMaskRuns(
+  const std::string & encoding, int width, int height, const std::vector<uint32_t> & runs,
+  cv::Mat & class_map)
+{
+  bool delta = encoding == kMaskEncoding_RleDelta;
+  if (delta) {
+    if (class_map.size() != cv::Size(width, height) || class_map.type() != CV_16UC1) {
+      return false;
+    }
+  } else {
+    class_map.create(height, width, CV_16UC1);
+  }
+  if (!class_map.isContinuous()) {
+    class_map = class_map.clone();
+  }
+  uint16_t * pixels = class_map.ptr<uint16_t>();
+  size_t total = class_map.total();
+  size_t offset = 0;
+  for (size_t i = 0; i + 1 < runs.size(); i += 2) {
+    size_t length = runs[i + 1];
+    if (offset + length > total) {
+      return false;
+    }
+    if (runs[i] != kMaskUnchanged) {
+      std::fill(pixels + offset, pixels + offset + length, static_cast<uint16_t>(runs[i]));
+    }
+    offset += length;
+  }
+  return offset == total;
+}
+#endif  // DYNAMIC_VINO_LIB__UTILS__MASK_CODEC_HPP_
@@ -0,0 +1,83 @@
+// Copyright (c) 2018-2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// @brief a utility class telling the frames which did not change from the inferred ones.
+// @file motion_gate.hpp
+//
+
+#ifndef DYNAMIC_VINO_LIB__UTILS__MOTION_GATE_HPP_
+#define DYNAMIC_VINO_LIB__UTILS__MOTION_GATE_HPP_
+
+#include <map>
+
+#include "opencv2/opencv.hpp"
+
+/**
+ * Compares a gray thumbnail of each frame with the thumbnail of the last
+ * frame inferred on the same input. Comparing with the inferred frame rather
+ * than the previous one keeps a slow change from going unnoticed.
+ * Not thread safe, frames are gated by the pipeline thread.
+ */
+class MotionGate
+{
+public:
+  /**
+   * @brief Whether a frame is close enough to the last inferred frame of its
+   * input to reuse its results. Otherwise the frame becomes the reference.
+   * @param[in] threshold The fraction of the thumbnail pixels which have to
+   * change for the frame to be inferred.
+   * @param[in] max_skipped The consecutive frames reused at most, so that the
+   * results are refreshed even on a still scene.
+   */
+  bool isStill(int input_id, const cv::Mat & frame, float threshold, int max_skipped)
+  {
+    auto & input = inputs_[input_id];
+    cv::resize(frame, resized_, cv::Size(kThumbnailSide, kThumbnailSide), 0, 0, cv::INTER_AREA);
+    if (resized_.channels() == 3) {
+      cv::cvtColor(resized_, thumbnail_, cv::COLOR_BGR2GRAY);
+    } else {
+      resized_.copyTo(thumbnail_);
+    }
+    if (!input.reference.empty() && input.skipped < max_skipped) {
+      cv::absdiff(thumbnail_, input.reference, diff_);
+      int changed = cv::countNonZero(diff_ > kPixelThreshold);
+      if (changed < threshold * diff_.total()) {
+        input.skipped++;
+        return true;
+      }
+    }
+    thumbnail_.copyTo(input.reference);
+    input.skipped = 0;
+    return false;
+  }
+
+private:
+  /**< side of the thumbnails, small enough for the gate to cost no more than a resize >**/
+  static constexpr int kThumbnailSide = 64;
+  /**< gray level difference from which a pixel is changed, above the sensor noise >**/
+  static constexpr int kPixelThreshold = 16;
+
+  struct InputState
+  {
+    cv::Mat reference;
+    int skipped = 0;
+  };
+  std::map<int, InputState> inputs_;
+  cv::Mat resized_;
+  cv::Mat thumbnail_;
+  cv::Mat diff_;
+};
+
+#endif  // DYNAMIC_VINO_LIB__UTILS__MOTION_GATE_HPP_
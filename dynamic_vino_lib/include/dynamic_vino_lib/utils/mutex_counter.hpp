@@ -13,45 +13,38 @@
 // limitations under the License.
 
 //
-// @brief a utility class for mutex counter (Thread Safe).
+// @brief a utility class for a lock-free counter (Thread Safe).
 // @file mutex_counter.hpp
 //
 
 #ifndef DYNAMIC_VINO_LIB__UTILS__MUTEX_COUNTER_HPP_
 #define DYNAMIC_VINO_LIB__UTILS__MUTEX_COUNTER_HPP_
 
-#include <mutex>
+#include <atomic>
 
 class MutexCounter
 {
 public:
   explicit MutexCounter(int init_counter = 0)
-  {
-    std::lock_guard<std::mutex> lk(counter_mutex_);
-    counter_ = init_counter;
-  }
+  : counter_(init_counter) {}
 
   void increaseCounter()
   {
-    std::lock_guard<std::mutex> lk(counter_mutex_);
-    ++counter_;
+    counter_.fetch_add(1, std::memory_order_relaxed);
   }
 
   void decreaseCounter()
   {
-    std::lock_guard<std::mutex> lk(counter_mutex_);
-    --counter_;
+    counter_.fetch_sub(1, std::memory_order_acq_rel);
   }
 
   int get()
   {
-    return counter_;
+    return counter_.load(std::memory_order_acquire);
   }
 
 private:
   std::atomic<int> counter_;
-  std::mutex counter_mutex_;
-  std::condition_variable cv_;
 };
 
 #endif  // DYNAMIC_VINO_LIB__UTILS__MUTEX_COUNTER_HPP_
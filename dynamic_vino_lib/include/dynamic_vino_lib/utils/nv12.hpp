@@ -0,0 +1,100 @@
+// Copyright (c) 2018-2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// @brief utility functions for NV12 frames: a CV_8UC1 Mat of 3/2 x height
+// rows, the Y plane over the interleaved UV plane at half resolution, as
+// cv::COLOR_YUV2BGR_NV12 takes it.
+// @file nv12.hpp
+//
+
+#ifndef DYNAMIC_VINO_LIB__UTILS__NV12_HPP_
+#define DYNAMIC_VINO_LIB__UTILS__NV12_HPP_
+
+#include <vector>
+
+#include "opencv2/opencv.hpp"
+
+/**
+ * @brief Get the size of the image an NV12 frame holds.
+ */
+inline cv::Size getNV12Size(const cv::Mat & nv12)
+{
+  return cv::Size(nv12.cols, nv12.rows * 2 / 3);
+}
+
+/**
+ * @brief Get the Y plane of an NV12 frame, a gray image without copying it.
+ */
+inline cv::Mat getNV12Luma(const cv::Mat & nv12)
+{
+  return nv12.rowRange(0, getNV12Size(nv12).height);
+}
+
+/**
+ * @brief Get the UV plane of an NV12 frame as a CV_8UC2 Mat at half resolution.
+ */
+inline cv::Mat getNV12Chroma(const cv::Mat & nv12)
+{
+  cv::Size size = getNV12Size(nv12);
+  return cv::Mat(size.height / 2, size.width / 2, CV_8UC2,
+           const_cast<uchar *>(nv12.ptr(size.height)), nv12.step[0]);
+}
+
+/**
+ * @brief Convert a BGR image of even width and height to NV12.
+ */
+inline void convertBGRToNV12(const cv::Mat & bgr, cv::Mat & nv12)
+{
+  cv::Mat i420;
+  cv::cvtColor(bgr, i420, cv::COLOR_BGR2YUV_I420);
+  nv12.create(bgr.rows * 3 / 2, bgr.cols, CV_8UC1);
+  i420.rowRange(0, bgr.rows).copyTo(getNV12Luma(nv12));
+  // I420 has the U plane then the V plane, each a quarter of the Y plane
+  size_t quarter = static_cast<size_t>(bgr.rows / 2) * (bgr.cols / 2);
+  cv::Mat u(bgr.rows / 2, bgr.cols / 2, CV_8UC1, i420.ptr(bgr.rows));
+  cv::Mat v(bgr.rows / 2, bgr.cols / 2, CV_8UC1, i420.ptr(bgr.rows) + quarter);
+  cv::Mat chroma = getNV12Chroma(nv12);
+  cv::merge(std::vector<cv::Mat>{u, v}, chroma);
+}
+
+/**
+ * @brief Resize a region of an NV12 frame to a BGR image of the given size.
+ * The planes are resized first, so that only the pixels of the result are
+ * converted, not those of the whole frame.
+ */
+inline void resizeNV12ToBGR(
+  const cv::Mat & nv12, const cv::Rect & roi, const cv::Size & size, cv::Mat & bgr)
+{
+  // the chroma of a 2x2 block is shared, the region and the result are made even
+  cv::Rect region(roi.x & ~1, roi.y & ~1, roi.width & ~1, roi.height & ~1);
+  region &= cv::Rect(cv::Point(), getNV12Size(nv12));
+  cv::Size even((size.width + 1) & ~1, (size.height + 1) & ~1);
+  if (region.area() <= 0 || even.area() <= 0) {
+    bgr.release();
+    return;
+  }
+  cv::Mat resized(even.height * 3 / 2, even.width, CV_8UC1);
+  cv::Rect half(region.x / 2, region.y / 2, region.width / 2, region.height / 2);
+  cv::Mat luma = getNV12Luma(resized);
+  cv::Mat chroma = getNV12Chroma(resized);
+  cv::resize(getNV12Luma(nv12)(region), luma, even);
+  cv::resize(getNV12Chroma(nv12)(half), chroma, cv::Size(even.width / 2, even.height / 2));
+  cv::cvtColor(resized, bgr, cv::COLOR_YUV2BGR_NV12);
+  if (even != size) {
+    bgr = bgr(cv::Rect(cv::Point(), size));
+  }
+}
+
+#endif  // DYNAMIC_VINO_LIB__UTILS__NV12_HPP_
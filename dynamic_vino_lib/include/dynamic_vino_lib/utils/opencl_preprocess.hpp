@@ -0,0 +1,160 @@
+// Copyright (c) 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// @brief utility functions to preprocess frames on an OpenCL device (e.g. the
+// iGPU) through the transparent API of OpenCV, cv::UMat, instead of the CPU.
+// @file opencl_preprocess.hpp
+//
+
+#ifndef DYNAMIC_VINO_LIB__UTILS__OPENCL_PREPROCESS_HPP_
+#define DYNAMIC_VINO_LIB__UTILS__OPENCL_PREPROCESS_HPP_
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "opencv2/core/ocl.hpp"
+#include "opencv2/opencv.hpp"
+
+/**
+ * The frame is uploaded to the device once, then each input of a network is
+ * resized, split into planes and converted there. Only the planes of the
+ * network input are read back, straight into the blob memory. The OpenCL
+ * queue of OpenCV is per thread, the functions may be called concurrently.
+ */
+class OpenCLPreprocess
+{
+public:
+  /**
+   * @brief Preprocess on the default OpenCL device of OpenCV from now on.
+   * @return False if the process has no OpenCL device, the CPU is used then.
+   */
+  static bool enable()
+  {
+    cv::ocl::setUseOpenCL(true);
+    if (!cv::ocl::haveOpenCL() || !cv::ocl::useOpenCL()) {
+      return false;
+    }
+    enabled() = true;
+    return true;
+  }
+  static bool isEnabled()
+  {
+    return enabled();
+  }
+  static std::string getDeviceName()
+  {
+    return cv::ocl::Device::getDefault().name();
+  }
+
+  /**
+   * @brief Copy an image, e.g. a whole frame, to the device.
+   */
+  static cv::UMat upload(const cv::Mat & image)
+  {
+    cv::UMat device;
+    image.copyTo(device);
+    return device;
+  }
+
+  /**
+   * @brief Resize an interleaved U8 image on the device and read it back as
+   * planes (CHW), scaled unless scale is 1.
+   * @return False for the blob types converted on the CPU only.
+   */
+  static bool packToPlanar(
+    const cv::UMat & image, const cv::Size & size, uint8_t * dst, float scale = 1.0)
+  {
+    return resizeToPlanar(image, size, dst, CV_8U, scale);
+  }
+  static bool packToPlanar(
+    const cv::UMat & image, const cv::Size & size, float * dst, float scale = 1.0)
+  {
+    return resizeToPlanar(image, size, dst, CV_32F, scale);
+  }
+  template<typename T>
+  static bool packToPlanar(const cv::UMat &, const cv::Size &, T *, float = 1.0)
+  {
+    return false;
+  }
+
+  /**
+   * @brief Letterbox an interleaved BGR U8 image on the device: resized into
+   * the region of a canvas of the given size padded with gray, converted to
+   * RGB and read back as U8 planes (CHW).
+   */
+  static void letterboxToPlanar(
+    const cv::UMat & image, const cv::Size & size, const cv::Rect & region,
+    uint8_t gray, uint8_t * dst)
+  {
+    cv::UMat resized;
+    cv::resize(image, resized, region.size());
+    cv::UMat canvas;
+    cv::copyMakeBorder(resized, canvas, region.y, size.height - region.y - region.height,
+      region.x, size.width - region.x - region.width, cv::BORDER_CONSTANT,
+      cv::Scalar::all(gray));
+    cv::UMat rgb;
+    cv::cvtColor(canvas, rgb, cv::COLOR_BGR2RGB);
+    readPlanes(rgb, dst, CV_8U, 1.0);
+  }
+
+private:
+  static std::atomic<bool> & enabled()
+  {
+    static std::atomic<bool> flag{false};
+    return flag;
+  }
+
+  static bool resizeToPlanar(
+    const cv::UMat & image, const cv::Size & size, void * dst, int depth, float scale)
+  {
+    if (image.empty() || image.depth() != CV_8U) {
+      return false;
+    }
+    if (image.size() == size) {
+      readPlanes(image, dst, depth, scale);
+      return true;
+    }
+    cv::UMat resized;
+    cv::resize(image, resized, size);
+    readPlanes(resized, dst, depth, scale);
+    return true;
+  }
+
+  /**
+   * @brief Split and convert an image on the device, then read each plane
+   * back into its place in dst.
+   */
+  static void readPlanes(const cv::UMat & image, void * dst, int depth, float scale)
+  {
+    std::vector<cv::UMat> planes;
+    cv::split(image, planes);
+    const size_t plane_size = image.total() * CV_ELEM_SIZE(depth);
+    cv::UMat converted;
+    for (size_t c = 0; c < planes.size(); c++) {
+      // a header on the blob memory, which the read-back fills in place
+      cv::Mat view(image.size(), depth, static_cast<uint8_t *>(dst) + c * plane_size);
+      if (depth == CV_8U && scale == 1.0) {
+        planes[c].copyTo(view);
+      } else {
+        planes[c].convertTo(converted, depth, scale);
+        converted.copyTo(view);
+      }
+    }
+  }
+};
+
+#endif  // DYNAMIC_VINO_LIB__UTILS__OPENCL_PREPROCESS_HPP_
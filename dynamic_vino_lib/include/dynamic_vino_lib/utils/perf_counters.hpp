@@ -0,0 +1,153 @@
+// Copyright (c) 2018-2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// @brief a utility class to aggregate per-layer performance counts of infer requests (Thread Safe).
+// @file perf_counters.hpp
+//
+
+#ifndef DYNAMIC_VINO_LIB__UTILS__PERF_COUNTERS_HPP_
+#define DYNAMIC_VINO_LIB__UTILS__PERF_COUNTERS_HPP_
+
+#include <algorithm>
+#include <deque>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "inference_engine.hpp"
+
+class PerfCounters
+{
+public:
+  struct Summary
+  {
+    std::string inference;
+    std::string layer;
+    std::string layer_type;
+    std::string exec_type;
+    uint64_t count = 0;
+    double real_time_us = 0;  // means over the recent samples
+    double cpu_time_us = 0;
+  };
+
+  /**
+   * @brief The means are computed over the last 'window' samples of each layer.
+   */
+  explicit PerfCounters(size_t window = 300)
+  : window_(std::max<size_t>(1, window)) {}
+
+  /**
+   * @brief Record the counts reported by InferRequest::GetPerformanceCounts()
+   * for one inference. Layers not executed are skipped.
+   */
+  void add(
+    const std::string & inference,
+    const std::map<std::string, InferenceEngine::InferenceEngineProfileInfo> & counts)
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    for (auto & pair : counts) {
+      auto & info = pair.second;
+      if (info.status != InferenceEngine::InferenceEngineProfileInfo::EXECUTED) {
+        continue;
+      }
+      auto & layer = layers_[std::make_pair(inference, pair.first)];
+      layer.layer_type = info.layer_type;
+      layer.exec_type = info.exec_type;
+      layer.values.emplace_back(info.realTime_uSec, info.cpu_uSec);
+      if (layer.values.size() > window_) {
+        layer.values.pop_front();
+      }
+      layer.count++;
+    }
+  }
+
+  /**
+   * @brief Get the summaries of all the layers, the slowest first.
+   */
+  std::vector<Summary> summarize()
+  {
+    std::vector<Summary> summaries;
+    {
+      std::lock_guard<std::mutex> lk(mutex_);
+      for (auto & pair : layers_) {
+        auto & layer = pair.second;
+        if (layer.values.empty()) {
+          continue;
+        }
+        Summary summary;
+        summary.inference = pair.first.first;
+        summary.layer = pair.first.second;
+        summary.layer_type = layer.layer_type;
+        summary.exec_type = layer.exec_type;
+        summary.count = layer.count;
+        for (auto & value : layer.values) {
+          summary.real_time_us += value.first;
+          summary.cpu_time_us += value.second;
+        }
+        summary.real_time_us /= layer.values.size();
+        summary.cpu_time_us /= layer.values.size();
+        summaries.push_back(summary);
+      }
+    }
+    std::sort(summaries.begin(), summaries.end(),
+      [](const Summary & a, const Summary & b) {
+        return a.real_time_us > b.real_time_us;
+      });
+    return summaries;
+  }
+
+  /**
+   * @brief Write the summaries to a CSV file.
+   * @return Whether the file is written.
+   */
+  bool writeCsv(const std::string & path)
+  {
+    std::ofstream file(path);
+    if (!file.is_open()) {
+      return false;
+    }
+    file << "inference,layer,layer_type,exec_type,count,real_time_us,cpu_time_us\n";
+    for (auto & summary : summarize()) {
+      file << summary.inference << "," << summary.layer << "," << summary.layer_type << "," <<
+        summary.exec_type << "," << summary.count << "," << summary.real_time_us << "," <<
+        summary.cpu_time_us << "\n";
+    }
+    return file.good();
+  }
+
+  void clear()
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    layers_.clear();
+  }
+
+private:
+  struct Samples
+  {
+    std::string layer_type;
+    std::string exec_type;
+    std::deque<std::pair<double, double>> values;
+    uint64_t count = 0;
+  };
+
+  size_t window_;
+  std::map<std::pair<std::string, std::string>, Samples> layers_;
+  std::mutex mutex_;
+};
+
+#endif  // DYNAMIC_VINO_LIB__UTILS__PERF_COUNTERS_HPP_
@@ -0,0 +1,164 @@
+// Copyright (c) 2018-2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// @brief a utility class to share the resized copies of one frame, and of its
+// ROIs, between inferences (Thread Safe).
+// @file preprocess_cache.hpp
+//
+
+#ifndef DYNAMIC_VINO_LIB__UTILS__PREPROCESS_CACHE_HPP_
+#define DYNAMIC_VINO_LIB__UTILS__PREPROCESS_CACHE_HPP_
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <vector>
+
+#include "dynamic_vino_lib/utils/blob_packing.hpp"
+#include "dynamic_vino_lib/utils/opencl_preprocess.hpp"
+#include "opencv2/opencv.hpp"
+
+class PreprocessCache
+{
+public:
+  /**
+   * @brief Get the frame, or an ROI of it, resized to the given size, either
+   * as interleaved BGR (HWC) or as one U8 plane per channel (CHW, returned as
+   * a single row Mat). Each distinct ROI, size and layout is computed once per
+   * frame, e.g. a face cropped for the sibling inferences of the same input
+   * size. The ROIs of different keys are computed concurrently.
+   * @param[in] frame The frame, or a view of it (frame(roi)).
+   * @return An empty Mat if 'frame' is not of the frame the cache belongs to.
+   */
+  cv::Mat get(const cv::Mat & frame, const cv::Size & size, bool planar)
+  {
+    if (frame.empty() || frame.type() != CV_8UC3) {
+      return cv::Mat();
+    }
+    cv::Size whole_size;
+    cv::Point offset;
+    frame.locateROI(whole_size, offset);
+    std::shared_ptr<Entry> entry;
+    {
+      std::lock_guard<std::mutex> lk(mutex_);
+      if (frame.datastart != source_data_ || whole_size != source_size_) {
+        // bound to the first frame seen since the last clear
+        if (source_data_ != nullptr) {
+          return cv::Mat();
+        }
+        source_data_ = frame.datastart;
+        source_size_ = whole_size;
+      }
+      auto key = std::make_tuple(offset.x, offset.y, frame.cols, frame.rows, size.width,
+          size.height, planar);
+      auto & slot = entries_[key];
+      if (slot == nullptr) {
+        slot = std::make_shared<Entry>();
+      }
+      entry = slot;
+    }
+    // computed by the first caller, the others wait for it
+    std::call_once(entry->computed, [&]() {
+        entry->mat = compute(frame, size, planar);
+      });
+    return entry->mat;
+  }
+
+  /**
+   * @brief Get the frame, or an ROI of it, on the OpenCL device (see
+   * opencl_preprocess.hpp). The whole frame is uploaded once, by the first
+   * caller, the ROIs are views of it.
+   * @return An empty UMat if 'frame' is not of the frame the cache belongs to.
+   */
+  cv::UMat getUMat(const cv::Mat & frame)
+  {
+    if (frame.empty()) {
+      return cv::UMat();
+    }
+    cv::Size whole_size;
+    cv::Point offset;
+    frame.locateROI(whole_size, offset);
+    {
+      std::lock_guard<std::mutex> lk(mutex_);
+      if (frame.datastart != source_data_ || whole_size != source_size_) {
+        if (source_data_ != nullptr) {
+          return cv::UMat();
+        }
+        source_data_ = frame.datastart;
+        source_size_ = whole_size;
+      }
+      if (upload_ == nullptr) {
+        upload_ = std::make_shared<Upload>();
+      }
+    }
+    auto upload = upload_;
+    std::call_once(upload->done, [&]() {
+        cv::Mat whole = frame;
+        whole.adjustROI(offset.y, whole_size.height - offset.y - frame.rows,
+          offset.x, whole_size.width - offset.x - frame.cols);
+        upload->umat = OpenCLPreprocess::upload(whole);
+      });
+    return upload->umat(cv::Rect(offset, frame.size()));
+  }
+
+  void clear()
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    entries_.clear();
+    upload_ = nullptr;
+    source_data_ = nullptr;
+    source_size_ = cv::Size();
+  }
+
+private:
+  struct Entry
+  {
+    std::once_flag computed;
+    cv::Mat mat;
+  };
+  struct Upload
+  {
+    std::once_flag done;
+    cv::UMat umat;
+  };
+
+  cv::Mat compute(const cv::Mat & frame, const cv::Size & size, bool planar)
+  {
+    cv::Mat result;
+    if (!planar) {
+      if (size == frame.size()) {
+        result = frame;
+      } else {
+        cv::resize(frame, result, size);
+      }
+    } else {
+      cv::Mat resized = get(frame, size, false);
+      result.create(1, size.area() * resized.channels(), CV_8UC1);
+      packToPlanar(resized, result.data);
+    }
+    return result;
+  }
+
+  /**< by ROI (x, y, width, height), size and layout >**/
+  std::map<std::tuple<int, int, int, int, int, int, bool>, std::shared_ptr<Entry>> entries_;
+  /**< the whole frame on the OpenCL device, guarded by mutex_ >**/
+  std::shared_ptr<Upload> upload_;
+  const uchar * source_data_ = nullptr;
+  cv::Size source_size_;
+  std::mutex mutex_;
+};
+
+#endif  // DYNAMIC_VINO_LIB__UTILS__PREPROCESS_CACHE_HPP_
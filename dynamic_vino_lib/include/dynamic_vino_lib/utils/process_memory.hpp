@@ -0,0 +1,67 @@
+// Copyright (c) 2018-2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// @brief utility functions reading the memory of the process.
+// @file process_memory.hpp
+//
+
+#ifndef DYNAMIC_VINO_LIB__UTILS__PROCESS_MEMORY_HPP_
+#define DYNAMIC_VINO_LIB__UTILS__PROCESS_MEMORY_HPP_
+
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+/**
+ * @brief Read a memory field (in kB) of /proc/self/status, e.g. "VmRSS" for
+ * the resident memory or "VmHWM" for its peak.
+ * @return The memory in bytes, 0 if the field can't be read.
+ */
+inline uint64_t readProcessMemory(const std::string & field)
+{
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line)) {
+    if (line.compare(0, field.size(), field) == 0 && line.size() > field.size() &&
+      line[field.size()] == ':')
+    {
+      std::istringstream value(line.substr(field.size() + 1));
+      uint64_t kb = 0;
+      value >> kb;
+      return kb * 1024;
+    }
+  }
+  return 0;
+}
+
+/**
+ * @brief Format a number of bytes for the logs, e.g. "12.5 MB".
+ */
+inline std::string formatBytes(uint64_t bytes)
+{
+  std::ostringstream text;
+  text.precision(1);
+  text << std::fixed;
+  if (bytes >= (1ULL << 30)) {
+    text << bytes / static_cast<double>(1ULL << 30) << " GB";
+  } else if (bytes >= (1ULL << 20)) {
+    text << bytes / static_cast<double>(1ULL << 20) << " MB";
+  } else {
+    text << bytes / 1024.0 << " kB";
+  }
+  return text.str();
+}
+#endif  // DYNAMIC_VINO_LIB__UTILS__PROCESS_MEMORY_HPP_
@@ -0,0 +1,233 @@
+// Copyright (c) 2018-2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// @brief a per-thread bump arena for the temporaries of a frame.
+// @file scratch_arena.hpp
+//
+
+#ifndef DYNAMIC_VINO_LIB__UTILS__SCRATCH_ARENA_HPP_
+#define DYNAMIC_VINO_LIB__UTILS__SCRATCH_ARENA_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "opencv2/opencv.hpp"
+
+/**
+ * Each thread has its own arena, so nothing is locked. The temporaries of a
+ * function are taken from it within a Scope, given back all at once when the
+ * scope ends, and the pipeline thread resets its arena between frames. Once
+ * the arena has grown to the temporaries of the largest frame, processing a
+ * frame allocates nothing from the heap.
+ *
+ * The memory taken within a scope must not be used after the scope ends, and
+ * a scratch container must not grow within a scope opened after it.
+ */
+class ScratchArena
+{
+public:
+  /**
+   * @brief Where the arena was at, rewound to by Scope.
+   */
+  struct Mark
+  {
+    size_t block;
+    size_t offset;
+  };
+
+  /**
+   * @class Scope
+   * @brief Gives back the memory taken from the arena since it was opened.
+   */
+  class Scope
+  {
+  public:
+    explicit Scope(ScratchArena & arena = ScratchArena::getThreadArena())
+    : arena_(arena), mark_(arena.getMark())
+    {
+    }
+    Scope(const Scope &) = delete;
+    Scope & operator=(const Scope &) = delete;
+    ~Scope()
+    {
+      arena_.rewind(mark_);
+    }
+
+    ScratchArena & getArena() const
+    {
+      return arena_;
+    }
+    /**
+     * @brief Get a continuous Mat backed by the arena, for the output of the
+     * OpenCV functions (created with the same size and type, they write it
+     * in place).
+     */
+    cv::Mat getMat(const cv::Size & size, int type)
+    {
+      return arena_.getMat(size, type);
+    }
+
+  private:
+    ScratchArena & arena_;
+    Mark mark_;
+  };
+
+  /**
+   * @brief Get the arena of the calling thread.
+   */
+  static ScratchArena & getThreadArena()
+  {
+    thread_local ScratchArena arena;
+    return arena;
+  }
+
+  ScratchArena() = default;
+  ScratchArena(const ScratchArena &) = delete;
+  ScratchArena & operator=(const ScratchArena &) = delete;
+
+  void * allocate(size_t bytes, size_t alignment = alignof(std::max_align_t))
+  {
+    for (; current_ < blocks_.size(); current_++, offset_ = 0) {
+      Block & block = blocks_[current_];
+      uintptr_t base = reinterpret_cast<uintptr_t>(block.data.get());
+      size_t start = ((base + offset_ + alignment - 1) / alignment) * alignment - base;
+      if (start + bytes <= block.size) {
+        offset_ = start + bytes;
+        return block.data.get() + start;
+      }
+    }
+    // the blocks double, and are merged into one by the next reset
+    size_t size = std::max(bytes + alignment,
+        blocks_.empty() ? kFirstBlockBytes : blocks_.back().size * 2);
+    blocks_.push_back(Block{std::unique_ptr<uint8_t[]>(new uint8_t[size]), size});
+    current_ = blocks_.size() - 1;
+    offset_ = 0;
+    return allocate(bytes, alignment);
+  }
+
+  cv::Mat getMat(const cv::Size & size, int type)
+  {
+    size_t bytes = static_cast<size_t>(size.area()) * CV_ELEM_SIZE(type);
+    return cv::Mat(size, type, allocate(std::max<size_t>(bytes, 1), 64));
+  }
+
+  Mark getMark() const
+  {
+    return Mark{current_, offset_};
+  }
+
+  void rewind(const Mark & mark)
+  {
+    current_ = mark.block;
+    offset_ = mark.offset;
+  }
+
+  /**
+   * @brief Give back all the memory, at a frame boundary, outside of any scope.
+   * The blocks are merged into one, so that the next frame fits in it.
+   */
+  void reset()
+  {
+    if (blocks_.size() > 1) {
+      size_t size = getCapacity();
+      blocks_.clear();
+      blocks_.push_back(Block{std::unique_ptr<uint8_t[]>(new uint8_t[size]), size});
+    }
+    current_ = 0;
+    offset_ = 0;
+  }
+
+  /**
+   * @brief Get the bytes of the blocks of the arena.
+   */
+  size_t getCapacity() const
+  {
+    size_t size = 0;
+    for (auto & block : blocks_) {
+      size += block.size;
+    }
+    return size;
+  }
+
+private:
+  enum : size_t {kFirstBlockBytes = 64 * 1024};
+
+  struct Block
+  {
+    std::unique_ptr<uint8_t[]> data;
+    size_t size;
+  };
+
+  std::vector<Block> blocks_;
+  size_t current_ = 0;
+  size_t offset_ = 0;
+};
+
+/**
+ * @brief A std allocator taking from a scratch arena, the thread's one by
+ * default. Deallocating is a no-op, the memory goes back with the scope.
+ */
+template<typename T>
+struct ScratchAllocator
+{
+  using value_type = T;
+
+  ScratchAllocator()
+  : arena(&ScratchArena::getThreadArena())
+  {
+  }
+  explicit ScratchAllocator(ScratchArena & scratch)
+  : arena(&scratch)
+  {
+  }
+  template<typename U>
+  ScratchAllocator(const ScratchAllocator<U> & other)  // NOLINT
+  : arena(other.arena)
+  {
+  }
+
+  T * allocate(size_t n)
+  {
+    return static_cast<T *>(arena->allocate(n * sizeof(T), alignof(T)));
+  }
+  void deallocate(T *, size_t)
+  {
+  }
+
+  ScratchArena * arena;
+};
+
+template<typename T, typename U>
+bool operator==(const ScratchAllocator<T> & a, const ScratchAllocator<U> & b)
+{
+  return a.arena == b.arena;
+}
+
+template<typename T, typename U>
+bool operator!=(const ScratchAllocator<T> & a, const ScratchAllocator<U> & b)
+{
+  return a.arena != b.arena;
+}
+
+/**
+ * @brief A vector of temporaries, taken from the arena of the thread.
+ */
+template<typename T>
+using ScratchVector = std::vector<T, ScratchAllocator<T>>;
+
+#endif  // DYNAMIC_VINO_LIB__UTILS__SCRATCH_ARENA_HPP_
@@ -0,0 +1,49 @@
+// Copyright (c) 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// @brief the hand-written SIMD kernels, dispatched at run time by the CPU.
+// @file simd_kernels.hpp
+//
+
+#ifndef DYNAMIC_VINO_LIB__UTILS__SIMD_KERNELS_HPP_
+#define DYNAMIC_VINO_LIB__UTILS__SIMD_KERNELS_HPP_
+
+#include <cstdint>
+
+//
+// Each kernel is built for every instruction set of the target architecture
+// (SSE4.2, AVX2 and AVX-512 on x86, NEON on ARM64) in the same binary, and
+// the widest one the CPU supports is picked the first time it is called. The
+// blob packing, the segmentation argmax and the fp32 similarities go through
+// OpenCV instead, which dispatches its own kernels the same way.
+//
+
+enum class CpuIsa {Generic, SSE42, AVX2, AVX512, NEON};
+
+/**
+ * @brief Get the instruction set the kernels run with: the widest one of the
+ * CPU (by CPUID), lowered by the DYNAMIC_VINO_LIB_ISA environment variable
+ * ("generic", "sse4.2", "avx2", "avx512") if set. Logged once when selected.
+ */
+CpuIsa getCpuIsa();
+
+const char * getCpuIsaName(CpuIsa isa);
+
+/**
+ * @brief The dot product of two int8 vectors, accumulated in int32.
+ */
+int32_t dotProductInt8(const int8_t * a, const int8_t * b, int size);
+
+#endif  // DYNAMIC_VINO_LIB__UTILS__SIMD_KERNELS_HPP_
@@ -0,0 +1,172 @@
+// Copyright (c) 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// @brief a header file with declaration of TensorDump class
+// @file tensor_dump.hpp
+//
+
+#ifndef DYNAMIC_VINO_LIB__UTILS__TENSOR_DUMP_HPP_
+#define DYNAMIC_VINO_LIB__UTILS__TENSOR_DUMP_HPP_
+
+#include <sys/stat.h>
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "dynamic_vino_lib/slog.hpp"
+#include "inference_engine.hpp"
+#include "opencv2/opencv.hpp"
+
+/**
+ * @class TensorDump
+ * @brief Records the input tensors of the requests of the inferences as the
+ * networks see them once preprocessed (the crops of the cascades included),
+ * to calibrate their INT8 models. Each batch slot is one sample in the
+ * directory of its inference: the U8 image inputs (1 or 3 planar channels)
+ * as lossless PNG images at the network resolution, the other inputs as raw
+ * .bin files of their elements.
+ */
+class TensorDump
+{
+public:
+  /**
+   * @param[in] max_samples The samples recorded per inference at most, 0 for no limit.
+   */
+  explicit TensorDump(const std::string & directory, size_t max_samples = 0)
+  : directory_(directory), max_samples_(max_samples) {}
+
+  /**
+   * @brief Record the first 'batch' slots of an input blob of an inference,
+   * called once the blob is filled and before the request starts.
+   */
+  void record(
+    const std::string & inference, const std::string & input,
+    const InferenceEngine::Blob::Ptr & blob, int batch)
+  {
+    if (blob == nullptr || blob->getTensorDesc().getDims().empty()) {
+      return;
+    }
+    auto & dims = blob->getTensorDesc().getDims();
+    std::lock_guard<std::mutex> lk(mtx_);
+    size_t & samples = samples_[inference][input];
+    std::string directory = getDirectory(inference);
+    if (samples == 0 && !makeDirectories(directory)) {
+      slog::err << "Failed to create the tensor dump directory " << directory << slog::endl;
+      return;
+    }
+    size_t slot_bytes = blob->byteSize() / dims[0];
+    const uint8_t * data = blob->cbuffer().as<const uint8_t *>();
+    bool image = dims.size() == 4 && (dims[1] == 1 || dims[1] == 3) &&
+      blob->getTensorDesc().getPrecision() == InferenceEngine::Precision::U8;
+    for (int slot = 0; slot < batch && slot < static_cast<int>(dims[0]); slot++) {
+      if (max_samples_ > 0 && samples >= max_samples_) {
+        return;
+      }
+      char index[16];
+      std::snprintf(index, sizeof(index), "%06zu", samples);
+      std::string path = directory + "/" + index + "_" + sanitize(input);
+      const uint8_t * slot_data = data + slot * slot_bytes;
+      bool written = image ? writeImage(path + ".png", slot_data, dims) :
+        writeRaw(path + ".bin", slot_data, slot_bytes);
+      if (!written) {
+        slog::err << "Failed to write the tensor " << path << slog::endl;
+        return;
+      }
+      samples++;
+    }
+  }
+
+  /**
+   * @brief The samples recorded for an inference, those of its most recorded input.
+   */
+  size_t getSamples(const std::string & inference)
+  {
+    std::lock_guard<std::mutex> lk(mtx_);
+    size_t samples = 0;
+    for (auto & input : samples_[inference]) {
+      samples = std::max(samples, input.second);
+    }
+    return samples;
+  }
+
+  std::string getDirectory(const std::string & inference) const
+  {
+    return directory_ + "/" + sanitize(inference);
+  }
+
+private:
+  /**
+   * @brief Keep the names of the pipelines, inferences and inputs usable in
+   * paths, e.g. "data" or "pipeline/inference" but no "..".
+   */
+  static std::string sanitize(const std::string & name)
+  {
+    std::string path = name;
+    for (auto & c : path) {
+      if (!std::isalnum(static_cast<unsigned char>(c)) && c != '/' && c != '_' && c != '-') {
+        c = '_';
+      }
+    }
+    return path;
+  }
+
+  static bool makeDirectories(const std::string & directory)
+  {
+    for (size_t end = directory.find('/', 1); ; end = directory.find('/', end + 1)) {
+      std::string parent = directory.substr(0, end);
+      if (mkdir(parent.c_str(), 0755) != 0 && errno != EEXIST) {
+        return false;
+      }
+      if (end == std::string::npos) {
+        return true;
+      }
+    }
+  }
+
+  static bool writeImage(
+    const std::string & path, const uint8_t * data, const InferenceEngine::SizeVector & dims)
+  {
+    int height = static_cast<int>(dims[2]);
+    int width = static_cast<int>(dims[3]);
+    std::vector<cv::Mat> planes;
+    for (size_t c = 0; c < dims[1]; c++) {
+      planes.emplace_back(height, width, CV_8UC1,
+        const_cast<uint8_t *>(data) + c * height * width);
+    }
+    cv::Mat image;
+    cv::merge(planes, image);
+    return cv::imwrite(path, image);
+  }
+
+  static bool writeRaw(const std::string & path, const uint8_t * data, size_t bytes)
+  {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char *>(data), bytes);
+    return static_cast<bool>(file);
+  }
+
+  std::string directory_;
+  size_t max_samples_;
+  std::mutex mtx_;
+  /**< by inference, then by input >**/
+  std::map<std::string, std::map<std::string, size_t>> samples_;
+};
+#endif  // DYNAMIC_VINO_LIB__UTILS__TENSOR_DUMP_HPP_
@@ -0,0 +1,140 @@
+// Copyright (c) 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// @brief utility functions to pin threads onto a set of CPUs, given as a list
+// ("0-7,16-23") or as the CPUs of a NUMA node. The threads created by a pinned
+// thread inherit its CPUs.
+// @file thread_affinity.hpp
+//
+
+#ifndef DYNAMIC_VINO_LIB__UTILS__THREAD_AFFINITY_HPP_
+#define DYNAMIC_VINO_LIB__UTILS__THREAD_AFFINITY_HPP_
+
+#include <pthread.h>
+#include <sched.h>
+
+#include <algorithm>
+#include <cctype>
+#include <exception>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Parse a CPU list in the format of /sys and taskset, e.g. "0-3,8,10-11".
+ * @return The sorted CPUs, empty for an empty or malformed list.
+ */
+inline std::vector<int> parseCpuList(const std::string & list)
+{
+  std::vector<int> cpus;
+  std::stringstream ss(list);
+  std::string range;
+  while (std::getline(ss, range, ',')) {
+    range.erase(std::remove_if(range.begin(), range.end(), ::isspace), range.end());
+    if (range.empty()) {
+      continue;
+    }
+    int first = 0;
+    int last = 0;
+    try {
+      auto dash = range.find('-');
+      first = std::stoi(range.substr(0, dash));
+      last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+    } catch (const std::exception &) {
+      return {};
+    }
+    if (first < 0 || last < first || last >= CPU_SETSIZE) {
+      return {};
+    }
+    for (int cpu = first; cpu <= last; cpu++) {
+      cpus.push_back(cpu);
+    }
+  }
+  std::sort(cpus.begin(), cpus.end());
+  cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+  return cpus;
+}
+
+/**
+ * @brief Get the CPUs of a NUMA node, empty if the node does not exist.
+ */
+inline std::vector<int> getNumaNodeCpus(int node)
+{
+  std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+  std::string list;
+  if (!file || !std::getline(file, list)) {
+    return {};
+  }
+  return parseCpuList(list);
+}
+
+/**
+ * @brief Pin the calling thread onto the CPUs, nothing is done for no CPUs.
+ * @return False if the CPUs are not available to the process.
+ */
+inline bool setThreadAffinity(const std::vector<int> & cpus)
+{
+  if (cpus.empty()) {
+    return true;
+  }
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (int cpu : cpus) {
+    CPU_SET(cpu, &set);
+  }
+  return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+/**
+ * @class ScopedThreadAffinity
+ * @brief Pin the calling thread for the lifetime of the object, e.g. while it
+ * creates the threads of a pipeline, and give it back its CPUs afterwards.
+ */
+class ScopedThreadAffinity
+{
+public:
+  explicit ScopedThreadAffinity(const std::vector<int> & cpus)
+  {
+    if (cpus.empty()) {
+      return;
+    }
+    CPU_ZERO(&saved_);
+    saved_valid_ = pthread_getaffinity_np(pthread_self(), sizeof(saved_), &saved_) == 0;
+    applied_ = setThreadAffinity(cpus);
+  }
+
+  ~ScopedThreadAffinity()
+  {
+    if (saved_valid_) {
+      pthread_setaffinity_np(pthread_self(), sizeof(saved_), &saved_);
+    }
+  }
+
+  ScopedThreadAffinity(const ScopedThreadAffinity &) = delete;
+  ScopedThreadAffinity & operator=(const ScopedThreadAffinity &) = delete;
+
+  bool isApplied() const
+  {
+    return applied_;
+  }
+
+private:
+  cpu_set_t saved_;
+  bool saved_valid_ = false;
+  bool applied_ = true;
+};
+
+#endif  // DYNAMIC_VINO_LIB__UTILS__THREAD_AFFINITY_HPP_
@@ -0,0 +1,118 @@
+// Copyright (c) 2018-2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// @brief a utility class for a fixed-size thread pool (Thread Safe).
+// @file thread_pool.hpp
+//
+
+#ifndef DYNAMIC_VINO_LIB__UTILS__THREAD_POOL_HPP_
+#define DYNAMIC_VINO_LIB__UTILS__THREAD_POOL_HPP_
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ThreadPool
+{
+public:
+  explicit ThreadPool(size_t threads = 1)
+  {
+    if (threads == 0) {
+      threads = 1;
+    }
+    for (size_t i = 0; i < threads; i++) {
+      workers_.emplace_back(&ThreadPool::run, this);
+    }
+  }
+
+  ~ThreadPool()
+  {
+    {
+      std::lock_guard<std::mutex> lk(tasks_mutex_);
+      stop_ = true;
+    }
+    cv_.notify_all();
+    for (auto & worker : workers_) {
+      if (worker.joinable()) {
+        worker.join();
+      }
+    }
+  }
+
+  /**
+   * @brief Queue a task, which is run by the first idle worker.
+   */
+  void post(std::function<void()> task)
+  {
+    {
+      std::lock_guard<std::mutex> lk(tasks_mutex_);
+      tasks_.push_back(std::move(task));
+    }
+    cv_.notify_one();
+  }
+
+  /**
+   * @brief Block until all the queued tasks are run and no worker is busy.
+   */
+  void waitIdle()
+  {
+    std::unique_lock<std::mutex> lock(tasks_mutex_);
+    idle_cv_.wait(lock, [this]() {return tasks_.empty() && active_ == 0;});
+  }
+
+  size_t size() const
+  {
+    return workers_.size();
+  }
+
+private:
+  void run()
+  {
+    while (true) {
+      std::function<void()> task;
+      {
+        std::unique_lock<std::mutex> lock(tasks_mutex_);
+        cv_.wait(lock, [this]() {return stop_ || !tasks_.empty();});
+        if (stop_ && tasks_.empty()) {
+          return;
+        }
+        task = std::move(tasks_.front());
+        tasks_.pop_front();
+        active_++;
+      }
+      task();
+      {
+        std::lock_guard<std::mutex> lk(tasks_mutex_);
+        active_--;
+        if (tasks_.empty() && active_ == 0) {
+          idle_cv_.notify_all();
+        }
+      }
+    }
+  }
+
+  std::vector<std::thread> workers_;
+  std::deque<std::function<void()>> tasks_;
+  std::mutex tasks_mutex_;
+  std::condition_variable cv_;
+  std::condition_variable idle_cv_;
+  size_t active_ = 0;
+  bool stop_ = false;
+};
+
+#endif  // DYNAMIC_VINO_LIB__UTILS__THREAD_POOL_HPP_
@@ -0,0 +1,135 @@
+// Copyright (c) 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @brief An implementation file with implementation for AsyncRunner Class
+ * @file async_runner.cpp
+ */
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include "dynamic_vino_lib/engines/async_runner.hpp"
+#include "dynamic_vino_lib/slog.hpp"
+
+Engines::AsyncRunner::AsyncRunner(std::shared_ptr<Engine> engine)
+: engine_(engine), running_(engine->getRequestNum())
+{
+  for (int request_id = 0; request_id < engine_->getRequestNum(); request_id++) {
+    engine_->setCompletionCallback(request_id, [this, request_id](bool succeeded) {
+        complete(request_id, succeeded);
+      });
+  }
+}
+
+Engines::AsyncRunner::~AsyncRunner()
+{
+  // no completion callback runs once idle, so they can be replaced
+  waitIdle();
+  for (int request_id = 0; request_id < engine_->getRequestNum(); request_id++) {
+    engine_->setCompletionCallback(request_id, [](bool) {});
+  }
+}
+
+void Engines::AsyncRunner::submit(Fill fill, Continuation then)
+{
+  int request_id = -1;
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    active_++;
+    // the jobs already waiting go first
+    if (pending_.empty()) {
+      request_id = engine_->acquireRequest();
+    }
+    if (request_id < 0) {
+      pending_.push_back(Job{std::move(fill), std::move(then)});
+      return;
+    }
+  }
+  start(request_id, Job{std::move(fill), std::move(then)});
+}
+
+void Engines::AsyncRunner::start(int request_id, Job job)
+{
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    running_[request_id] = std::move(job.then);
+  }
+  auto & request = engine_->getRequest(request_id);
+  try {
+    if (job.fill) {
+      job.fill(*request);
+    }
+    request->startAsync();
+  } catch (const std::exception & e) {
+    slog::warn << "Failed to start an infer request: " << e.what() << slog::endl;
+    complete(request_id, false);
+  }
+}
+
+void Engines::AsyncRunner::complete(int request_id, bool succeeded)
+{
+  Continuation then;
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    then = std::move(running_[request_id]);
+    running_[request_id] = nullptr;
+    completing_++;
+  }
+  engine_->recordResult(request_id, succeeded);
+  if (then) {
+    try {
+      then(*engine_->getRequest(request_id), succeeded);
+    } catch (const std::exception & e) {
+      slog::err << "Failed to continue an infer request: " << e.what() << slog::endl;
+    }
+  }
+
+  // the request goes on with the next waiting job, without going back to the pool
+  Job next;
+  bool has_next = false;
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    active_--;
+    if (!pending_.empty()) {
+      next = std::move(pending_.front());
+      pending_.pop_front();
+      has_next = true;
+    } else {
+      engine_->releaseRequest(request_id);
+    }
+  }
+  if (has_next) {
+    start(request_id, std::move(next));
+  }
+
+  // notified under the lock: the runner may be destroyed as soon as it is idle
+  std::lock_guard<std::mutex> lk(mutex_);
+  completing_--;
+  if (isIdle()) {
+    idle_cv_.notify_all();
+  }
+}
+
+void Engines::AsyncRunner::waitIdle()
+{
+  std::unique_lock<std::mutex> lk(mutex_);
+  idle_cv_.wait(lk, [this] {return isIdle();});
+}
+
+size_t Engines::AsyncRunner::getActiveJobs()
+{
+  std::lock_guard<std::mutex> lk(mutex_);
+  return active_;
+}
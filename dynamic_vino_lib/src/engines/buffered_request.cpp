@@ -0,0 +1,224 @@
+// Copyright (c) 2018-2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @brief An implementation file with implementation for BufferedRequest Class
+ * @file buffered_request.cpp
+ */
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "dynamic_vino_lib/engines/buffered_request.hpp"
+#include "dynamic_vino_lib/slog.hpp"
+
+std::vector<Engines::RequestBackend::Ptr> Engines::BufferedRequest::create(
+  const RequestBackend::Ptr & request, const std::vector<std::string> & inputs,
+  const std::vector<std::string> & outputs, int buffers)
+{
+  auto shared = std::make_shared<Shared>();
+  shared->request = request;
+  std::vector<RequestBackend::Ptr> requests;
+  for (int i = 0; i < std::max(buffers, 1); i++) {
+    std::shared_ptr<BufferedRequest> buffer(new BufferedRequest(shared));
+    for (auto & name : inputs) {
+      buffer->inputs_[name] = allocateBlob(request->getInput(name)->getTensorDesc());
+    }
+    for (auto & name : outputs) {
+      buffer->outputs_[name] = allocateBlob(request->getOutput(name)->getTensorDesc());
+    }
+    requests.push_back(buffer);
+  }
+  // the blobs of the first buffer, which also tells whether the request takes them
+  std::static_pointer_cast<BufferedRequest>(requests.front())->attach();
+  shared->request->setCompletionCallback([raw = shared.get()](bool succeeded) {
+      complete(raw, succeeded);
+    });
+  return requests;
+}
+
+Engines::BufferedRequest::BufferedRequest(const std::shared_ptr<Shared> & shared)
+: shared_(shared)
+{
+}
+
+InferenceEngine::Blob::Ptr Engines::BufferedRequest::getInput(const std::string & name)
+{
+  auto input = inputs_.find(name);
+  if (input == inputs_.end()) {
+    throw std::logic_error("No input " + name + " in the buffer of the request");
+  }
+  return input->second;
+}
+
+void Engines::BufferedRequest::setInput(
+  const std::string & name, const InferenceEngine::Blob::Ptr & blob)
+{
+  if (inputs_.find(name) == inputs_.end()) {
+    throw std::logic_error("No input " + name + " in the buffer of the request");
+  }
+  inputs_[name] = blob;
+  preprocessed_inputs_.erase(name);
+}
+
+void Engines::BufferedRequest::setPreprocessedInput(
+  const std::string & name, const InferenceEngine::Blob::Ptr & blob,
+  const InferenceEngine::PreProcessInfo & info)
+{
+  if (inputs_.find(name) == inputs_.end()) {
+    throw std::logic_error("No input " + name + " in the buffer of the request");
+  }
+  preprocessed_inputs_[name] = {blob, info};
+}
+
+InferenceEngine::Blob::CPtr Engines::BufferedRequest::getOutput(const std::string & name)
+{
+  auto output = outputs_.find(name);
+  if (output == outputs_.end()) {
+    throw std::logic_error("No output " + name + " in the buffer of the request");
+  }
+  return output->second;
+}
+
+void Engines::BufferedRequest::attach()
+{
+  auto & request = shared_->request;
+  for (auto & input : inputs_) {
+    auto preprocessed = preprocessed_inputs_.find(input.first);
+    if (preprocessed != preprocessed_inputs_.end()) {
+      request->setPreprocessedInput(input.first, preprocessed->second.blob,
+        preprocessed->second.info);
+    } else {
+      request->setInput(input.first, input.second);
+    }
+  }
+  for (auto & output : outputs_) {
+    request->setOutput(output.first, output.second);
+  }
+  if (batch_ > 0) {
+    request->setBatch(batch_);
+  }
+}
+
+void Engines::BufferedRequest::startAsync()
+{
+  {
+    std::lock_guard<std::mutex> lk(shared_->mutex);
+    if (shared_->running != nullptr) {
+      // started by the completion of the buffers before it
+      shared_->queued.push_back(this);
+      return;
+    }
+    shared_->running = this;
+  }
+  try {
+    attach();
+    shared_->request->startAsync();
+  } catch (...) {
+    advance(shared_.get());
+    throw;
+  }
+}
+
+void Engines::BufferedRequest::infer()
+{
+  {
+    std::unique_lock<std::mutex> lk(shared_->mutex);
+    shared_->idle.wait(lk, [this]() {return shared_->running == nullptr;});
+    shared_->running = this;
+  }
+  try {
+    attach();
+    shared_->request->infer();
+  } catch (...) {
+    advance(shared_.get());
+    throw;
+  }
+  advance(shared_.get());
+}
+
+void Engines::BufferedRequest::cancel()
+{
+  {
+    std::unique_lock<std::mutex> lk(shared_->mutex);
+    if (shared_->running == this) {
+      lk.unlock();
+      shared_->request->cancel();
+      return;
+    }
+    auto queued = std::find(shared_->queued.begin(), shared_->queued.end(), this);
+    if (queued == shared_->queued.end()) {
+      return;
+    }
+    shared_->queued.erase(queued);
+  }
+  if (callback_) {
+    callback_(false);
+  }
+}
+
+void Engines::BufferedRequest::setCompletionCallback(const std::function<void(bool)> & callback)
+{
+  callback_ = callback;
+}
+
+std::map<std::string, InferenceEngine::InferenceEngineProfileInfo>
+Engines::BufferedRequest::getPerformanceCounts()
+{
+  return shared_->request->getPerformanceCounts();
+}
+
+void Engines::BufferedRequest::advance(Shared * shared)
+{
+  BufferedRequest * next = nullptr;
+  {
+    std::lock_guard<std::mutex> lk(shared->mutex);
+    if (!shared->queued.empty()) {
+      next = shared->queued.front();
+      shared->queued.pop_front();
+    }
+    shared->running = next;
+  }
+  if (next == nullptr) {
+    shared->idle.notify_all();
+    return;
+  }
+  try {
+    next->attach();
+    shared->request->startAsync();
+  } catch (const std::exception & e) {
+    slog::warn << "Failed to start a buffer of the request: " << e.what() << slog::endl;
+    advance(shared);
+    if (next->callback_) {
+      next->callback_(false);
+    }
+  }
+}
+
+void Engines::BufferedRequest::complete(Shared * shared, bool succeeded)
+{
+  BufferedRequest * finished = nullptr;
+  {
+    std::lock_guard<std::mutex> lk(shared->mutex);
+    finished = shared->running;
+  }
+  // the next buffer is started first, the outputs of this one are its own
+  advance(shared);
+  if (finished != nullptr && finished->callback_) {
+    finished->callback_(succeeded);
+  }
+}
@@ -0,0 +1,145 @@
+// Copyright (c) 2018-2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @brief An implementation file with implementation for DeviceScheduler Class
+ * @file device_scheduler.cpp
+ */
+#include <vino_param_lib/param_manager.hpp>
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include "dynamic_vino_lib/engines/device_scheduler.hpp"
+#include "dynamic_vino_lib/slog.hpp"
+
+std::mutex Engines::DeviceScheduler::instances_mutex_;
+std::map<std::string, std::shared_ptr<Engines::DeviceScheduler>>
+Engines::DeviceScheduler::instances_;
+std::map<std::string, double> Engines::DeviceScheduler::weights_;
+
+std::shared_ptr<Engines::DeviceScheduler> Engines::DeviceScheduler::getInstance(
+  const std::string & device)
+{
+  std::lock_guard<std::mutex> lk(instances_mutex_);
+  auto & scheduler = instances_[device];
+  if (scheduler == nullptr) {
+    int capacity = Params::ParamManager::getInstance().getCommon().device_requests;
+    scheduler = std::make_shared<DeviceScheduler>(capacity);
+    for (auto & weight : weights_) {
+      scheduler->setWeight(weight.first, weight.second);
+    }
+    if (capacity > 0) {
+      slog::info << "Admitting " << capacity << " infer requests at a time on " << device <<
+        slog::endl;
+    }
+  }
+  return scheduler;
+}
+
+void Engines::DeviceScheduler::setClientWeight(const std::string & client, double weight)
+{
+  std::lock_guard<std::mutex> lk(instances_mutex_);
+  weights_[client] = weight;
+  for (auto & instance : instances_) {
+    instance.second->setWeight(client, weight);
+  }
+}
+
+std::map<std::string, double> Engines::DeviceScheduler::getBusyTimes()
+{
+  std::lock_guard<std::mutex> lk(instances_mutex_);
+  std::map<std::string, double> busy_times;
+  for (auto & instance : instances_) {
+    busy_times[instance.first] = instance.second->getBusySeconds();
+  }
+  return busy_times;
+}
+
+Engines::DeviceScheduler::DeviceScheduler(int capacity)
+: capacity_(std::max(0, capacity)) {}
+
+void Engines::DeviceScheduler::setWeight(const std::string & client, double weight)
+{
+  std::lock_guard<std::mutex> lk(mutex_);
+  clients_[client].weight = std::max(weight, 1e-3);
+}
+
+double Engines::DeviceScheduler::getWeight(const std::string & client)
+{
+  std::lock_guard<std::mutex> lk(mutex_);
+  return clients_[client].weight;
+}
+
+void Engines::DeviceScheduler::admit(const std::string & client)
+{
+  std::unique_lock<std::mutex> lk(mutex_);
+  if (capacity_ == 0) {
+    // no admission control, only the busy time is kept
+    if (running_++ == 0) {
+      busy_since_ = std::chrono::steady_clock::now();
+    }
+    return;
+  }
+  // an idle client starts at the current virtual time, it can't claim the
+  // share it didn't use
+  auto & state = clients_[client];
+  double start = std::max(virtual_time_, state.finish);
+  state.finish = start + 1.0 / state.weight;
+  auto tag = std::make_pair(state.finish, next_ticket_++);
+  waiting_.insert(tag);
+  cv_.wait(lk, [this, &tag]() {
+      return running_ < capacity_ && *waiting_.begin() == tag;
+    });
+  waiting_.erase(waiting_.begin());
+  virtual_time_ = std::max(virtual_time_, start);
+  if (running_++ == 0) {
+    busy_since_ = std::chrono::steady_clock::now();
+  }
+  // the next waiting admission may fit too
+  cv_.notify_all();
+}
+
+void Engines::DeviceScheduler::release()
+{
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    if (running_ > 0 && --running_ == 0) {
+      busy_seconds_ += std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - busy_since_).count();
+    }
+  }
+  if (capacity_ > 0) {
+    cv_.notify_all();
+  }
+}
+
+double Engines::DeviceScheduler::getBusySeconds()
+{
+  std::lock_guard<std::mutex> lk(mutex_);
+  double busy = busy_seconds_;
+  if (running_ > 0) {
+    busy += std::chrono::duration<double>(std::chrono::steady_clock::now() - busy_since_).count();
+  }
+  return busy;
+}
+
+size_t Engines::DeviceScheduler::getWaiting()
+{
+  std::lock_guard<std::mutex> lk(mutex_);
+  return waiting_.size();
+}
@@ -16,20 +16,356 @@
  * @brief a header file with definition of Engine class
  * @file engine.cpp
  */
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
 #include "dynamic_vino_lib/engines/engine.hpp"
+#include "dynamic_vino_lib/engines/ie_request_backend.hpp"
 #include "dynamic_vino_lib/slog.hpp"
+#include "dynamic_vino_lib/utils/frame_pool.hpp"
+#include "dynamic_vino_lib/utils/nv12.hpp"
 
 #if(defined(USE_OLD_E_PLUGIN_API))
 Engines::Engine::Engine(
   InferenceEngine::InferencePlugin plg,
   const Models::BaseModel::Ptr base_model)
 {
-  request_ = (plg.LoadNetwork(base_model->getNetReader()->getNetwork(), {})).CreateInferRequestPtr();
+  requests_.push_back(std::make_shared<IERequestBackend>(
+      (plg.LoadNetwork(base_model->getNetReader()->getNetwork(), {})).CreateInferRequestPtr()));
+  initRequests();
 }
 #endif
 
 Engines::Engine::Engine(
   InferenceEngine::InferRequest::Ptr & request)
 {
-  request_ = request;
+  requests_.push_back(std::make_shared<IERequestBackend>(request));
+  initRequests();
+}
+
+Engines::Engine::Engine(
+  const std::vector<InferenceEngine::InferRequest::Ptr> & requests)
+{
+  for (auto & request : requests) {
+    requests_.push_back(std::make_shared<IERequestBackend>(request));
+  }
+  initRequests();
+}
+
+Engines::Engine::Engine(
+  const std::vector<RequestBackend::Ptr> & requests)
+: requests_(requests)
+{
+  initRequests();
+}
+
+void Engines::Engine::initRequests()
+{
+  if (requests_.empty()) {
+    throw std::logic_error("An Engine needs at least one infer request!");
+  }
+  request_in_use_.assign(requests_.size(), false);
+  request_admitted_.assign(requests_.size(), nullptr);
+  request_started_.resize(requests_.size());
+  request_running_.assign(requests_.size(), false);
+  request_cancelled_.assign(requests_.size(), false);
+  input_frames_.resize(requests_.size());
+  bindings_.resize(requests_.size());
+  setRequestDevices({""});
+}
+
+void Engines::Engine::bindBlobs(
+  const std::vector<std::string> & inputs, const std::vector<std::string> & outputs)
+{
+  for (size_t id = 0; id < requests_.size(); id++) {
+    auto & binding = bindings_[id];
+    for (auto & name : inputs) {
+      binding.inputs[name] = InputBinding(requests_[id]->getInput(name));
+    }
+    for (auto & name : outputs) {
+      binding.outputs[name] = OutputBinding(requests_[id]->getOutput(name));
+    }
+  }
+}
+
+const Engines::InputBinding & Engines::Engine::getInputBinding(const std::string & name)
+{
+  auto & inputs = bindings_[bound_request_].inputs;
+  auto found = inputs.find(name);
+  if (found == inputs.end()) {
+    found = inputs.emplace(name, InputBinding(requests_[bound_request_]->getInput(name))).first;
+  }
+  return found->second;
+}
+
+const Engines::OutputBinding & Engines::Engine::getOutputBinding(const std::string & name)
+{
+  auto & outputs = bindings_[bound_request_].outputs;
+  auto found = outputs.find(name);
+  if (found == outputs.end()) {
+    found = outputs.emplace(name,
+        OutputBinding(requests_[bound_request_]->getOutput(name))).first;
+  }
+  return found->second;
+}
+
+void Engines::Engine::setInput(const std::string & name, const InferenceEngine::Blob::Ptr & blob)
+{
+  requests_[bound_request_]->setInput(name, blob);
+  bindings_[bound_request_].inputs[name] = InputBinding(blob);
+}
+
+void Engines::Engine::setRequestDevices(const std::vector<std::string> & devices)
+{
+  if (devices.size() != 1 && devices.size() != requests_.size()) {
+    throw std::logic_error("One device for all the requests, or one per request!");
+  }
+  std::lock_guard<std::mutex> lk(pool_mutex_);
+  devices_.clear();
+  request_devices_.clear();
+  for (size_t i = 0; i < requests_.size(); i++) {
+    auto & device = devices[devices.size() == 1 ? 0 : i];
+    auto found = std::find(devices_.begin(), devices_.end(), device);
+    request_devices_.push_back(found - devices_.begin());
+    if (found == devices_.end()) {
+      devices_.push_back(device);
+    }
+  }
+  device_requests_in_use_.assign(devices_.size(), 0);
+  for (size_t i = 0; i < requests_.size(); i++) {
+    if (request_in_use_[i]) {
+      device_requests_in_use_[request_devices_[i]]++;
+    }
+  }
+  schedulers_.clear();
+}
+
+void Engines::Engine::setScheduler(const std::string & client)
+{
+  std::lock_guard<std::mutex> lk(pool_mutex_);
+  client_ = client;
+  schedulers_.clear();
+  for (auto & device : devices_) {
+    schedulers_.push_back(DeviceScheduler::getInstance(device));
+  }
+}
+
+int Engines::Engine::acquireRequest()
+{
+  std::lock_guard<std::mutex> lk(pool_mutex_);
+  int best = -1;
+  for (size_t k = 0; k < request_in_use_.size(); k++) {
+    size_t i = (next_request_ + k) % request_in_use_.size();
+    if (request_in_use_[i]) {
+      continue;
+    }
+    if (best < 0 || device_requests_in_use_[request_devices_[i]] <
+      device_requests_in_use_[request_devices_[best]])
+    {
+      best = static_cast<int>(i);
+    }
+  }
+  if (best < 0) {
+    return -1;
+  }
+  request_in_use_[best] = true;
+  device_requests_in_use_[request_devices_[best]]++;
+  next_request_ = (best + 1) % request_in_use_.size();
+  return best;
+}
+
+void Engines::Engine::releaseRequest(int id)
+{
+  finishRequest(id);
+  std::lock_guard<std::mutex> lk(pool_mutex_);
+  if (id >= 0 && id < static_cast<int>(request_in_use_.size()) && request_in_use_[id]) {
+    request_in_use_[id] = false;
+    device_requests_in_use_[request_devices_[id]]--;
+  }
+}
+
+uint64_t Engines::Engine::getBlobBytes()
+{
+  std::lock_guard<std::mutex> lk(pool_mutex_);
+  if (blob_bytes_ >= 0) {
+    return static_cast<uint64_t>(blob_bytes_);
+  }
+  blob_bytes_ = 0;
+  if (network_ == nullptr) {
+    return 0;
+  }
+  try {
+    auto inputs = network_->GetInputsInfo();
+    auto outputs = network_->GetOutputsInfo();
+    for (auto & request : requests_) {
+      for (auto & input : inputs) {
+        blob_bytes_ += request->getInput(input.first)->byteSize();
+      }
+      for (auto & output : outputs) {
+        blob_bytes_ += request->getOutput(output.first)->byteSize();
+      }
+    }
+  } catch (const std::exception & e) {
+    slog::warn << "Failed to measure the blobs: " << e.what() << slog::endl;
+  }
+  return static_cast<uint64_t>(blob_bytes_);
+}
+
+void Engines::Engine::admitRequest()
+{
+  // admitted without a capacity too, the scheduler keeps the busy time of the device
+  std::shared_ptr<DeviceScheduler> scheduler;
+  std::string client;
+  int id = bound_request_;
+  {
+    std::lock_guard<std::mutex> lk(pool_mutex_);
+    if (schedulers_.empty()) {
+      request_started_[id] = std::chrono::steady_clock::now();
+      request_running_[id] = true;
+      return;
+    }
+    scheduler = schedulers_[request_devices_[id]];
+    client = client_;
+  }
+  scheduler->admit(client);
+  std::lock_guard<std::mutex> lk(pool_mutex_);
+  request_admitted_[id] = scheduler;
+  request_started_[id] = std::chrono::steady_clock::now();
+  request_running_[id] = true;
+}
+
+void Engines::Engine::finishRequest(int id)
+{
+  std::shared_ptr<DeviceScheduler> scheduler;
+  {
+    std::lock_guard<std::mutex> lk(pool_mutex_);
+    if (id < 0 || id >= static_cast<int>(request_admitted_.size()) ||
+      request_admitted_[id] == nullptr)
+    {
+      return;
+    }
+    scheduler = request_admitted_[id];
+    request_admitted_[id] = nullptr;
+  }
+  scheduler->release();
+}
+
+void Engines::Engine::recordResult(int id, bool succeeded)
+{
+  bool counted = false;
+  {
+    std::lock_guard<std::mutex> lk(pool_mutex_);
+    if (id >= 0 && id < static_cast<int>(request_running_.size())) {
+      request_running_[id] = false;
+      counted = request_cancelled_[id];
+      request_cancelled_[id] = false;
+    }
+  }
+  if (succeeded) {
+    consecutive_errors_ = 0;
+  } else if (!counted) {
+    consecutive_errors_++;
+    errors_++;
+  }
+}
+
+int Engines::Engine::cancelStalledRequests(const std::chrono::milliseconds & timeout)
+{
+  std::vector<int> stalled;
+  {
+    std::lock_guard<std::mutex> lk(pool_mutex_);
+    auto now = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < requests_.size(); i++) {
+      if (request_running_[i] && !request_cancelled_[i] && now - request_started_[i] > timeout) {
+        request_cancelled_[i] = true;
+        stalled.push_back(static_cast<int>(i));
+      }
+    }
+  }
+  for (int id : stalled) {
+    // counted now, the completion of a hung device may never come
+    consecutive_errors_++;
+    errors_++;
+    try {
+      requests_[id]->cancel();
+    } catch (const std::exception & e) {
+      slog::warn << "Failed to cancel a stalled request: " << e.what() << slog::endl;
+    }
+  }
+  return static_cast<int>(stalled.size());
+}
+
+bool Engines::Engine::setInputFrame(const std::string & input_name, const cv::Mat & frame)
+{
+  if (frame.empty() || frame.type() != CV_8UC3) {
+    slog::warn << "Only BGR frames can be set as the input blob." << slog::endl;
+    return false;
+  }
+  if (frame.isContinuous()) {
+    setInput(input_name, wrapFrame(frame));
+    input_frames_[bound_request_] = frame;
+    return true;
+  }
+
+  // an ROI of a frame: reference the parent frame and let the plugin crop it
+  cv::Size whole_size;
+  cv::Point offset;
+  frame.locateROI(whole_size, offset);
+  cv::Mat parent = frame;
+  parent.adjustROI(offset.y, whole_size.height - offset.y - frame.rows,
+    offset.x, whole_size.width - offset.x - frame.cols);
+  if (!parent.isContinuous()) {
+    cv::Mat pixels = FramePool::clone(frame);
+    setInput(input_name, wrapFrame(pixels));
+    input_frames_[bound_request_] = pixels;
+    return true;
+  }
+  InferenceEngine::ROI roi(0, offset.x, offset.y, frame.cols, frame.rows);
+  setInput(input_name, InferenceEngine::make_shared_blob(wrapFrame(parent), roi));
+  input_frames_[bound_request_] = parent;
+  return true;
+}
+
+bool Engines::Engine::setInputNV12(const std::string & input_name, const cv::Mat & nv12)
+{
+  cv::Size size = getNV12Size(nv12);
+  if (nv12.empty() || nv12.type() != CV_8UC1 || size.width % 2 != 0 || size.height % 2 != 0) {
+    slog::warn << "Only NV12 frames of even width and height can be set as the input blob." <<
+      slog::endl;
+    return false;
+  }
+  // the planes are wrapped with the row stride of the frame
+  cv::Mat pixels = nv12.isContinuous() ? nv12 : FramePool::clone(nv12);
+  InferenceEngine::TensorDesc y_desc(InferenceEngine::Precision::U8,
+    {1, 1, static_cast<size_t>(size.height), static_cast<size_t>(size.width)},
+    InferenceEngine::Layout::NHWC);
+  InferenceEngine::TensorDesc uv_desc(InferenceEngine::Precision::U8,
+    {1, 2, static_cast<size_t>(size.height / 2), static_cast<size_t>(size.width / 2)},
+    InferenceEngine::Layout::NHWC);
+  auto y = InferenceEngine::make_shared_blob<uint8_t>(y_desc, pixels.data);
+  auto uv = InferenceEngine::make_shared_blob<uint8_t>(uv_desc, pixels.ptr(size.height));
+  InferenceEngine::PreProcessInfo info;
+  info.setResizeAlgorithm(InferenceEngine::RESIZE_BILINEAR);
+  info.setColorFormat(InferenceEngine::ColorFormat::NV12);
+  try {
+    requests_[bound_request_]->setPreprocessedInput(input_name,
+      InferenceEngine::make_shared_blob<InferenceEngine::NV12Blob>(y, uv), info);
+    // the request holds the converted input now, resolved again when got
+    bindings_[bound_request_].inputs.erase(input_name);
+  } catch (const std::exception & e) {
+    slog::warn << "Failed to set an NV12 input blob: " << e.what() << slog::endl;
+    return false;
+  }
+  input_frames_[bound_request_] = pixels;
+  return true;
+}
+
+InferenceEngine::Blob::Ptr Engines::Engine::wrapFrame(const cv::Mat & frame)
+{
+  InferenceEngine::TensorDesc desc(InferenceEngine::Precision::U8,
+    {1, static_cast<size_t>(frame.channels()), static_cast<size_t>(frame.rows),
+      static_cast<size_t>(frame.cols)}, InferenceEngine::Layout::NHWC);
+  return InferenceEngine::make_shared_blob<uint8_t>(desc, frame.data);
 }
@@ -17,40 +17,619 @@
  * @file engine.cpp
  */
 #include "dynamic_vino_lib/engines/engine_manager.hpp"
+#include "dynamic_vino_lib/engines/buffered_request.hpp"
 #include "dynamic_vino_lib/engines/engine.hpp"
+#include "dynamic_vino_lib/engines/ie_request_backend.hpp"
+#include "dynamic_vino_lib/engines/mock_request.hpp"
+#include "dynamic_vino_lib/engines/remote_request.hpp"
+#include "dynamic_vino_lib/engines/shm_channel.hpp"
+#include "dynamic_vino_lib/engines/shm_request.hpp"
 #include "dynamic_vino_lib/slog.hpp"
 #include "dynamic_vino_lib/models/base_model.hpp"
+#include "dynamic_vino_lib/utils/process_memory.hpp"
 #include "dynamic_vino_lib/utils/version_info.hpp"
 #include <vino_param_lib/param_manager.hpp>
 #include <inference_engine.hpp>
+#include <sys/stat.h>
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
 #if(defined(USE_OLD_E_PLUGIN_API))
 #include <extension/ext_list.hpp>
 #endif
 
+namespace
+{
+// the engine of the inferences run by a model server, REMOTE:<host>:<port>[/<model>]
+const std::string kRemotePrefix = "REMOTE:";
+// the time a remote inference takes at most without a request_timeout
+const int kRemoteTimeoutMs = 10000;
+// the engine of the inferences run by no device, MOCK[:<latency ms>[:<directory>]]
+const std::string kMockEngine = "MOCK";
+// the engine of the inferences run by the engine daemon of the host, SHM:<device>[@<socket>]
+const std::string kShmPrefix = "SHM:";
+
+void getBlobNames(
+  const std::shared_ptr<Models::BaseModel> & model, std::vector<std::string> & inputs,
+  std::vector<std::string> & outputs)
+{
+  auto network = model->getNetReader();
+  for (auto & input : network.getInputsInfo()) {
+    inputs.push_back(input.first);
+  }
+  for (auto & output : network.getOutputsInfo()) {
+    outputs.push_back(output.first);
+  }
+}
+}  // namespace
+
 std::shared_ptr<Engines::Engine> Engines::EngineManager::createEngine(
-  const std::string & device, const std::shared_ptr<Models::BaseModel> & model)
+  const std::string & device, const std::shared_ptr<Models::BaseModel> & model,
+  const std::map<std::string, std::string> & config, int infer_requests, int warmup,
+  bool plugin_preprocess, int timeout_ms, int input_buffers)
 {
 #if(defined(USE_OLD_E_PLUGIN_API))
-  return createEngine_beforeV2019R2(device, model);
+  if (!config.empty() || plugin_preprocess) {
+    slog::warn << "Plugin config and preprocessing are ignored by the old plugin API." <<
+      slog::endl;
+  }
+  auto engine = createEngine_beforeV2019R2(device, model);
+  engine->setRequestDevices({device});
 #else
-  return createEngine_V2019R2_plus(device, model);
+  auto devices = getBalancedDevices(device);
+  std::shared_ptr<Engines::Engine> engine;
+  if (device.compare(0, kRemotePrefix.size(), kRemotePrefix) == 0) {
+    engine = createRemoteEngine(device.substr(kRemotePrefix.size()), model, infer_requests,
+        timeout_ms);
+  } else if (device.compare(0, kShmPrefix.size(), kShmPrefix) == 0) {
+    engine = createShmEngine(device.substr(kShmPrefix.size()), model, infer_requests, timeout_ms);
+  } else if (device.compare(0, kMockEngine.size(), kMockEngine) == 0 &&
+    (device.size() == kMockEngine.size() || device[kMockEngine.size()] == ':'))
+  {
+    engine = createMockEngine(device.substr(std::min(device.size(), kMockEngine.size() + 1)),
+        model, infer_requests);
+  } else if (devices.size() > 1) {
+    engine = createBalancedEngine(devices, model, config, infer_requests, plugin_preprocess,
+        input_buffers);
+  } else {
+    engine = createEngine_V2019R2_plus(device, model, config, infer_requests, plugin_preprocess,
+        input_buffers);
+  }
 #endif
+  bindBlobs(engine, model);
+  if (warmup > 0) {
+    warmUp(engine, model, warmup);
+  }
+  return engine;
+}
+
+std::shared_ptr<Engines::Engine> Engines::EngineManager::createEngine(
+  const Params::ParamManager::InferenceRawData & infer,
+  const std::shared_ptr<Models::BaseModel> & model)
+{
+  return createEngine(infer.engine, model, infer.config, infer.infer_requests, infer.warmup,
+           infer.preprocess == "plugin", static_cast<int>(infer.request_timeout),
+           infer.input_buffers);
+}
+
+InferenceEngine::Core & Engines::EngineManager::getCore()
+{
+  static InferenceEngine::Core core;
+  static std::once_flag configured;
+  std::call_once(configured, []() {
+      auto pcommon = Params::ParamManager::getInstance().getCommon();
+      if (!pcommon.custom_cpu_library.empty()) {
+        slog::info << "custom cpu library is not empty, tyring to use this extension:" <<
+          pcommon.custom_cpu_library << slog::endl;
+        try {
+          core.AddExtension(
+            std::make_shared<InferenceEngine::Extension>(pcommon.custom_cpu_library), "CPU");
+        } catch (const std::exception & e) {
+          slog::err << "Failed to load the custom cpu library: " << e.what() << slog::endl;
+        }
+      }
+      if (!pcommon.custom_cldnn_library.empty()) {
+        slog::info << "custom cldnn library is not empty, tyring to use this extension:" <<
+          pcommon.custom_cldnn_library << slog::endl;
+        try {
+          core.SetConfig(
+            {{InferenceEngine::PluginConfigParams::KEY_CONFIG_FILE,
+              pcommon.custom_cldnn_library}}, "GPU");
+        } catch (const std::exception & e) {
+          slog::err << "Failed to load the custom cldnn library: " << e.what() << slog::endl;
+        }
+      }
+      if (!pcommon.network_cache_dir.empty()) {
+        // compiled networks are exported to the cache dir by the plugins supporting it,
+        // keyed by the IR, device and config, and imported instead of compiled next time
+        slog::info << "Caching compiled networks in " << pcommon.network_cache_dir << slog::endl;
+        core.SetConfig(
+          {{InferenceEngine::PluginConfigParams::KEY_CACHE_DIR, pcommon.network_cache_dir}});
+      }
+    });
+  return core;
+}
+
+std::string Engines::EngineManager::getModelPrecision(const std::string & model)
+{
+  auto slash = model.find_last_of('/');
+  if (slash == std::string::npos || slash == 0) {
+    return "";
+  }
+  auto parent = model.substr(0, slash);
+  std::string directory = parent.substr(parent.find_last_of('/') + 1);
+  std::transform(directory.begin(), directory.end(), directory.begin(), ::toupper);
+  // the quantized variants of the zoo are in FP16-INT8 and FP32-INT8
+  for (auto precision : {"INT8", "FP16", "FP32"}) {
+    if (directory.find(precision) != std::string::npos) {
+      return precision;
+    }
+  }
+  return "";
+}
+
+bool Engines::EngineManager::supportsModel(const std::string & device, const std::string & model)
+{
+  auto precision = getModelPrecision(model);
+  if (precision.empty()) {
+    return true;
+  }
+  for (auto & name : getBalancedDevices(device)) {
+    // the plugin lists (MULTI:, HETERO:) and the mock engine report no capabilities
+    if (name.find(':') != std::string::npos || name == kMockEngine) {
+      continue;
+    }
+    try {
+      auto capabilities = getCore().GetMetric(name, METRIC_KEY(OPTIMIZATION_CAPABILITIES)).
+        as<std::vector<std::string>>();
+      if (std::find(capabilities.begin(), capabilities.end(), precision) == capabilities.end()) {
+        return false;
+      }
+    } catch (const std::exception & e) {
+      slog::warn << "Failed to get the capabilities of " << name << ": " << e.what() <<
+        slog::endl;
+    }
+  }
+  return true;
+}
+
+namespace
+{
+std::string getModifiedTime(const std::string & path)
+{
+  struct stat info;
+  return stat(path.c_str(), &info) == 0 ? std::to_string(info.st_mtime) : "";
+}
+}  // namespace
+
+std::string Engines::EngineManager::getNetworkKey(
+  const std::string & device, const std::shared_ptr<Models::BaseModel> & model,
+  const std::map<std::string, std::string> & config)
+{
+  // the model category is part of the key, as it decides the layer properties
+  std::string location = model->getModelLocation();
+  std::string key = location + "|" + model->getModelCategory() + "|" +
+    device + "|" + std::to_string(model->getMaxBatchSize()) + "|" +
+    std::to_string(model->getInputWidth()) + "x" + std::to_string(model->getInputHeight());
+  // a model replaced on disk is loaded again instead of sharing the running network
+  std::string weights = location.substr(0, location.rfind('.')) + ".bin";
+  key += "|" + getModifiedTime(location) + "|" + getModifiedTime(weights);
+  for (auto & pair : config) {
+    key += "|" + pair.first + "=" + pair.second;
+  }
+  return key;
+}
+
+namespace
+{
+/**
+ * @brief Get the memory held on a device: the total of the memory statistics
+ * of the GPU plugin where it reports them, the resident memory of the process
+ * otherwise (the networks of the host plugins live there).
+ */
+uint64_t getDeviceMemory(InferenceEngine::Core & core, const std::string & device)
+{
+  if (device.find("GPU") != std::string::npos) {
+    try {
+      auto statistics = core.GetMetric(device, "GPU_MEMORY_STATISTICS").
+        as<std::map<std::string, uint64_t>>();
+      uint64_t total = 0;
+      for (auto & statistic : statistics) {
+        total += statistic.second;
+      }
+      return total;
+    } catch (const std::exception &) {
+      // not reported by this version of the plugin
+    }
+  }
+  return readProcessMemory("VmRSS");
 }
+}  // namespace
 
 std::shared_ptr<Engines::Engine> Engines::EngineManager::createEngine_V2019R2_plus(
-  const std::string & device, const std::shared_ptr<Models::BaseModel> & model)
+  const std::string & device, const std::shared_ptr<Models::BaseModel> & model,
+  const std::map<std::string, std::string> & infer_config, int infer_requests,
+  bool plugin_preprocess, int input_buffers)
 {
-  InferenceEngine::Core core;
-  auto executable_network = core.LoadNetwork(model->getNetReader(), device);
-  auto request = executable_network.CreateInferRequestPtr();
+  std::map<std::string, std::string> config = infer_config;
+  if (Params::ParamManager::getInstance().getCommon().enable_performance_count &&
+    config.find(InferenceEngine::PluginConfigParams::KEY_PERF_COUNT) == config.end())
+  {
+    config[InferenceEngine::PluginConfigParams::KEY_PERF_COUNT] =
+      InferenceEngine::PluginConfigParams::YES;
+  }
+  auto perf_count_config = config.find(InferenceEngine::PluginConfigParams::KEY_PERF_COUNT);
+  bool perf_count = perf_count_config != config.end() &&
+    perf_count_config->second == InferenceEngine::PluginConfigParams::YES;
+  bool dynamic_batch = false;
+  auto dyn_batch_config = config.find(InferenceEngine::PluginConfigParams::KEY_DYN_BATCH_ENABLED);
+  if (dyn_batch_config != config.end()) {
+    // explicitly set in the config of the inference
+    dynamic_batch = dyn_batch_config->second == InferenceEngine::PluginConfigParams::YES;
+  } else if (model->getMaxBatchSize() > 1 && (device == "CPU" || device == "GPU")) {
+    /**< partial batches are only supported by CPU and GPU plugins >**/
+    dynamic_batch = true;
+    config[InferenceEngine::PluginConfigParams::KEY_DYN_BATCH_ENABLED] =
+      InferenceEngine::PluginConfigParams::YES;
+  }
 
-  return std::make_shared<Engines::Engine>(request);
+  std::string key = getNetworkKey(device, model, config);
+  if (plugin_preprocess) {
+    key += "|preprocess=plugin";
+  }
+  std::shared_ptr<std::mutex> load_mutex;
+  {
+    std::lock_guard<std::mutex> lock(networks_mutex_);
+    auto & mtx = load_mutexes_[key];
+    if (mtx == nullptr) {
+      mtx = std::make_shared<std::mutex>();
+    }
+    load_mutex = mtx;
+  }
+  // different networks are loaded concurrently, the same one only once
+  std::lock_guard<std::mutex> load_lock(*load_mutex);
+  std::shared_ptr<InferenceEngine::ExecutableNetwork> executable_network;
+  uint64_t network_bytes = 0;
+  {
+    std::lock_guard<std::mutex> lock(networks_mutex_);
+    executable_network = networks_[key].lock();
+    if (executable_network != nullptr) {
+      dynamic_batch = dynamic_batch_of_networks_[key];
+      plugin_preprocess = plugin_preprocess_of_networks_[key];
+    }
+  }
+  if (executable_network != nullptr) {
+    slog::info << "Sharing the loaded network of " << model->getModelCategory() <<
+      " on " << device << slog::endl;
+  } else {
+    if (plugin_preprocess && !setPluginPreprocess(model)) {
+      plugin_preprocess = false;
+    }
+    auto & core = getCore();
+    // approximate while other networks are loaded concurrently
+    uint64_t memory_before = getDeviceMemory(core, device);
+    executable_network = std::make_shared<InferenceEngine::ExecutableNetwork>();
+    try {
+      *executable_network = core.LoadNetwork(model->getNetReader(), device, config);
+    } catch (const std::exception & e) {
+      if (!dynamic_batch) {
+        throw;
+      }
+      slog::warn << "Dynamic batch is not supported by " << model->getModelCategory() <<
+        " on " << device << ", full batches will be inferred: " << e.what() << slog::endl;
+      dynamic_batch = false;
+      config.erase(InferenceEngine::PluginConfigParams::KEY_DYN_BATCH_ENABLED);
+      *executable_network = core.LoadNetwork(model->getNetReader(), device, config);
+    }
+    uint64_t memory_after = getDeviceMemory(core, device);
+    network_bytes = memory_after > memory_before ? memory_after - memory_before : 0;
+    std::lock_guard<std::mutex> lock(networks_mutex_);
+    networks_[key] = executable_network;
+    dynamic_batch_of_networks_[key] = dynamic_batch;
+    plugin_preprocess_of_networks_[key] = plugin_preprocess;
+  }
+  if (infer_requests <= 0) {
+    try {
+      infer_requests = executable_network->GetMetric(
+        METRIC_KEY(OPTIMAL_NUMBER_OF_INFER_REQUESTS)).as<unsigned int>();
+    } catch (const std::exception & e) {
+      slog::warn << "Failed to get the optimal number of infer requests: " << e.what() <<
+        slog::endl;
+    }
+    infer_requests = std::max(1, infer_requests);
+  }
+  std::vector<RequestBackend::Ptr> requests;
+  for (int i = 0; i < infer_requests; i++) {
+    requests.push_back(std::make_shared<IERequestBackend>(
+        executable_network->CreateInferRequestPtr()));
+  }
+  slog::info << "Created " << infer_requests << " infer requests for " <<
+    model->getModelCategory() << " on " << device << slog::endl;
+  if (input_buffers > 1) {
+    requests = createBuffers(requests, model, input_buffers);
+  }
+
+  auto engine = std::make_shared<Engines::Engine>(requests);
+  engine->setDynamicBatchEnabled(dynamic_batch);
+  engine->setPerfCountEnabled(perf_count);
+  engine->setPluginPreprocessEnabled(plugin_preprocess);
+  engine->setNetwork(executable_network);
+  engine->setNetworkBytes(network_bytes);
+  engine->setRequestDevices({device});
+  return engine;
+}
+
+std::shared_ptr<Engines::Engine> Engines::EngineManager::createRemoteEngine(
+  const std::string & endpoint, const std::shared_ptr<Models::BaseModel> & model,
+  int infer_requests, int timeout_ms)
+{
+  std::string host, port, name;
+  if (!KServeClient::parseEndpoint(endpoint, host, port, name)) {
+    throw std::logic_error("The endpoint of a remote engine is <host>:<port>[/<model>], not " +
+            endpoint);
+  }
+  if (name.empty()) {
+    // served under the name of its IR by default
+    auto location = model->getModelLocation();
+    name = location.substr(location.find_last_of('/') + 1);
+    name = name.substr(0, name.rfind('.'));
+  }
+  // the server runs the requests of all the clients, a few in flight hide the network latency
+  infer_requests = infer_requests > 0 ? infer_requests : 4;
+  timeout_ms = timeout_ms > 0 ? timeout_ms : kRemoteTimeoutMs;
+  auto network = model->getNetReader();
+  std::vector<RequestBackend::Ptr> requests;
+  for (int i = 0; i < infer_requests; i++) {
+    requests.push_back(std::make_shared<RemoteRequest>(host, port, name,
+      network.getInputsInfo(), network.getOutputsInfo(), timeout_ms));
+  }
+  slog::info << "Created " << infer_requests << " remote requests for " <<
+    model->getModelCategory() << " on " << host << ":" << port << "/" << name << slog::endl;
+
+  auto engine = std::make_shared<Engines::Engine>(requests);
+  // the frames of a partial batch are sent alone
+  engine->setDynamicBatchEnabled(model->getMaxBatchSize() > 1);
+  engine->setRequestDevices({kRemotePrefix + endpoint});
+  return engine;
+}
+
+std::shared_ptr<Engines::Engine> Engines::EngineManager::createShmEngine(
+  const std::string & options, const std::shared_ptr<Models::BaseModel> & model,
+  int infer_requests, int timeout_ms)
+{
+  std::string device, socket;
+  ShmChannel::parseEngine(options, device, socket);
+  if (device.empty()) {
+    throw std::logic_error("The engine run by the daemon is SHM:<device>[@<socket>], not SHM:" +
+            options);
+  }
+  // the daemon runs the requests of all the workers, a few in flight keep its streams busy
+  infer_requests = infer_requests > 0 ? infer_requests : 4;
+  timeout_ms = timeout_ms > 0 ? timeout_ms : kRemoteTimeoutMs;
+  auto network = model->getNetReader();
+  std::vector<RequestBackend::Ptr> requests;
+  for (int i = 0; i < infer_requests; i++) {
+    requests.push_back(std::make_shared<ShmRequest>(socket, device, model->getModelLocation(),
+      network.getInputsInfo(), network.getOutputsInfo(), timeout_ms));
+  }
+  slog::info << "Created " << infer_requests << " requests for " <<
+    model->getModelCategory() << " run on " << device << " by the daemon on " << socket <<
+    slog::endl;
+
+  auto engine = std::make_shared<Engines::Engine>(requests);
+  // the daemon runs the whole batch of the network
+  engine->setDynamicBatchEnabled(false);
+  engine->setRequestDevices({kShmPrefix + options});
+  return engine;
+}
+
+std::shared_ptr<Engines::Engine> Engines::EngineManager::createMockEngine(
+  const std::string & options, const std::shared_ptr<Models::BaseModel> & model,
+  int infer_requests)
+{
+  double latency_ms = 0;
+  std::string directory;
+  if (!options.empty()) {
+    auto colon = options.find(':');
+    try {
+      latency_ms = std::stod(options.substr(0, colon));
+    } catch (const std::exception &) {
+      throw std::logic_error("The mock engine is MOCK[:<latency ms>[:<directory>]], not MOCK:" +
+              options);
+    }
+    if (colon != std::string::npos) {
+      directory = options.substr(colon + 1);
+    }
+  }
+  infer_requests = std::max(1, infer_requests);
+  auto network = model->getNetReader();
+  std::vector<RequestBackend::Ptr> requests;
+  for (int i = 0; i < infer_requests; i++) {
+    requests.push_back(std::make_shared<MockRequest>(
+      network.getInputsInfo(), network.getOutputsInfo(), latency_ms, directory));
+  }
+  auto outputs = directory.empty() ? std::string("synthetic outputs") :
+    "the outputs recorded in " + directory;
+  slog::info << "Created " << infer_requests << " mock requests of " << latency_ms <<
+    " ms for " << model->getModelCategory() << " with " << outputs << slog::endl;
+
+  auto engine = std::make_shared<Engines::Engine>(requests);
+  engine->setDynamicBatchEnabled(model->getMaxBatchSize() > 1);
+  engine->setRequestDevices({kMockEngine});
+  return engine;
+}
+
+std::vector<std::string> Engines::EngineManager::getBalancedDevices(const std::string & device)
+{
+  // the device lists of the plugins (MULTI:, HETERO:) are passed to them as is
+  if (device.find(':') != std::string::npos) {
+    return {device};
+  }
+  std::vector<std::string> devices;
+  std::stringstream ss(device);
+  std::string name;
+  while (std::getline(ss, name, ',')) {
+    name.erase(std::remove_if(name.begin(), name.end(), ::isspace), name.end());
+    if (!name.empty() && std::find(devices.begin(), devices.end(), name) == devices.end()) {
+      devices.push_back(name);
+    }
+  }
+  return devices.empty() ? std::vector<std::string>{device} : devices;
+}
+
+std::shared_ptr<Engines::Engine> Engines::EngineManager::createBalancedEngine(
+  const std::vector<std::string> & devices, const std::shared_ptr<Models::BaseModel> & model,
+  const std::map<std::string, std::string> & config, int infer_requests,
+  bool plugin_preprocess, int input_buffers)
+{
+  std::vector<Engines::RequestBackend::Ptr> requests;
+  std::vector<std::string> request_devices;
+  std::vector<std::shared_ptr<InferenceEngine::ExecutableNetwork>> networks;
+  bool dynamic_batch = true;
+  bool perf_count = true;
+  uint64_t network_bytes = 0;
+  for (auto & device : devices) {
+    auto part = createEngine_V2019R2_plus(device, model, config, infer_requests,
+        plugin_preprocess, input_buffers);
+    for (int id = 0; id < part->getRequestNum(); id++) {
+      requests.push_back(part->getRequest(id));
+      request_devices.push_back(device);
+    }
+    networks.push_back(part->getNetwork());
+    // partial batches only if all the devices support them
+    dynamic_batch = dynamic_batch && part->isDynamicBatchEnabled();
+    perf_count = perf_count && part->isPerfCountEnabled();
+    plugin_preprocess = part->isPluginPreprocessEnabled();
+    network_bytes += part->getNetworkBytes();
+  }
+  slog::info << "Balancing " << requests.size() << " infer requests of " <<
+    model->getModelCategory() << " over " << devices.size() << " devices" << slog::endl;
+
+  auto engine = std::make_shared<Engines::Engine>(requests);
+  engine->setDynamicBatchEnabled(dynamic_batch);
+  engine->setPerfCountEnabled(perf_count);
+  engine->setPluginPreprocessEnabled(plugin_preprocess);
+  engine->setNetwork(networks.front());
+  engine->setDeviceNetworks(networks);
+  engine->setNetworkBytes(network_bytes);
+  engine->setRequestDevices(request_devices);
+  return engine;
+}
+
+bool Engines::EngineManager::setPluginPreprocess(
+  const std::shared_ptr<Models::BaseModel> & model)
+{
+  // a wrapped frame fills the whole input blob, so only batch 1 is supported
+  if (!model->supportsPluginPreprocess() || model->getMaxBatchSize() != 1) {
+    slog::warn << "Plugin preprocessing is not supported by " << model->getModelCategory() <<
+      " (batch " << model->getMaxBatchSize() << "), resizing in OpenCV." << slog::endl;
+    return false;
+  }
+  auto inputs = model->getNetReader().getInputsInfo();
+  auto input = inputs.find(model->getInputName());
+  if (input == inputs.end()) {
+    slog::warn << "No input " << model->getInputName() << " in " << model->getModelCategory() <<
+      ", resizing in OpenCV." << slog::endl;
+    return false;
+  }
+  input->second->setPrecision(InferenceEngine::Precision::U8);
+  input->second->setLayout(InferenceEngine::Layout::NHWC);
+  input->second->getPreProcess().setResizeAlgorithm(InferenceEngine::RESIZE_BILINEAR);
+  slog::info << "Preprocessing the input of " << model->getModelCategory() << " in the plugin" <<
+    slog::endl;
+  return true;
+}
+
+std::vector<Engines::RequestBackend::Ptr> Engines::EngineManager::createBuffers(
+  const std::vector<RequestBackend::Ptr> & requests,
+  const std::shared_ptr<Models::BaseModel> & model, int input_buffers)
+{
+  std::vector<std::string> inputs;
+  std::vector<std::string> outputs;
+  getBlobNames(model, inputs, outputs);
+  std::vector<RequestBackend::Ptr> buffers;
+  try {
+    for (auto & request : requests) {
+      auto request_buffers = BufferedRequest::create(request, inputs, outputs, input_buffers);
+      buffers.insert(buffers.end(), request_buffers.begin(), request_buffers.end());
+    }
+  } catch (const std::exception & e) {
+    slog::warn << "Failed to buffer the requests of " << model->getModelCategory() <<
+      ", their own blobs are used: " << e.what() << slog::endl;
+    return requests;
+  }
+  slog::info << "Buffered each request of " << model->getModelCategory() << " with " <<
+    input_buffers << " blob sets" << slog::endl;
+  return buffers;
+}
+
+void Engines::EngineManager::bindBlobs(
+  const std::shared_ptr<Engines::Engine> & engine,
+  const std::shared_ptr<Models::BaseModel> & model)
+{
+  std::vector<std::string> inputs;
+  std::vector<std::string> outputs;
+  getBlobNames(model, inputs, outputs);
+  try {
+    engine->bindBlobs(inputs, outputs);
+  } catch (const std::exception & e) {
+    // resolved when first got instead
+    slog::warn << "Failed to bind the blobs of " << model->getModelCategory() << ": " <<
+      e.what() << slog::endl;
+  }
+}
+
+void Engines::EngineManager::warmUp(
+  const std::shared_ptr<Engines::Engine> & engine,
+  const std::shared_ptr<Models::BaseModel> & model, int iterations)
+{
+  // the partial batches of dynamic batching are warmed up as well
+  std::vector<int> batches = {model->getMaxBatchSize()};
+  if (engine->isDynamicBatchEnabled()) {
+    for (int batch = 1; batch < model->getMaxBatchSize(); batch++) {
+      batches.push_back(batch);
+    }
+  }
+  auto start = std::chrono::steady_clock::now();
+  try {
+    for (int id = 0; id < engine->getRequestNum(); id++) {
+      engine->bindRequest(id);
+      for (auto batch : batches) {
+        if (engine->isDynamicBatchEnabled()) {
+          engine->setBatch(batch);
+        }
+        for (int i = 0; i < iterations; i++) {
+          engine->infer();
+        }
+      }
+      if (engine->isDynamicBatchEnabled()) {
+        engine->setBatch(model->getMaxBatchSize());
+      }
+    }
+    engine->bindRequest(0);
+  } catch (const std::exception & e) {
+    engine->bindRequest(0);
+    slog::warn << "Failed to warm up " << model->getModelCategory() << ": " << e.what() <<
+      slog::endl;
+    return;
+  }
+  slog::info << "Warmed up " << model->getModelCategory() << " in " <<
+    std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() <<
+    " ms" << slog::endl;
 }
 
 #if(defined(USE_OLD_E_PLUGIN_API))
 std::shared_ptr<Engines::Engine> Engines::EngineManager::createEngine_beforeV2019R2(
   const std::string & device, const std::shared_ptr<Models::BaseModel> & model)
 {
+  std::lock_guard<std::mutex> lock(networks_mutex_);
   if(plugins_for_devices_.find(device) == plugins_for_devices_.end()) {
       auto pcommon = Params::ParamManager::getInstance().getCommon();
       plugins_for_devices_[device] = *makePluginByName(device, pcommon.custom_cpu_library,
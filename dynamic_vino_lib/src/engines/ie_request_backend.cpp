@@ -0,0 +1,90 @@
+// Copyright (c) 2018-2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @brief An implementation file with implementation for IERequestBackend Class
+ * @file ie_request_backend.cpp
+ */
+#include <functional>
+#include <map>
+#include <string>
+#include "dynamic_vino_lib/engines/ie_request_backend.hpp"
+
+Engines::IERequestBackend::IERequestBackend(const InferenceEngine::InferRequest::Ptr & request)
+: request_(request)
+{
+}
+
+InferenceEngine::Blob::Ptr Engines::IERequestBackend::getInput(const std::string & name)
+{
+  return request_->GetBlob(name);
+}
+
+void Engines::IERequestBackend::setInput(
+  const std::string & name, const InferenceEngine::Blob::Ptr & blob)
+{
+  request_->SetBlob(name, blob);
+}
+
+void Engines::IERequestBackend::setPreprocessedInput(
+  const std::string & name, const InferenceEngine::Blob::Ptr & blob,
+  const InferenceEngine::PreProcessInfo & info)
+{
+  request_->SetBlob(name, blob, info);
+}
+
+void Engines::IERequestBackend::setOutput(
+  const std::string & name, const InferenceEngine::Blob::Ptr & blob)
+{
+  request_->SetBlob(name, blob);
+}
+
+InferenceEngine::Blob::CPtr Engines::IERequestBackend::getOutput(const std::string & name)
+{
+  return request_->GetBlob(name);
+}
+
+void Engines::IERequestBackend::setBatch(int batch)
+{
+  request_->SetBatch(batch);
+}
+
+void Engines::IERequestBackend::startAsync()
+{
+  request_->StartAsync();
+}
+
+void Engines::IERequestBackend::infer()
+{
+  request_->Infer();
+}
+
+void Engines::IERequestBackend::cancel()
+{
+  request_->Cancel();
+}
+
+void Engines::IERequestBackend::setCompletionCallback(const std::function<void(bool)> & callback)
+{
+  request_->SetCompletionCallback(
+    [callback](InferenceEngine::InferRequest, InferenceEngine::StatusCode status) {
+      callback(status == InferenceEngine::StatusCode::OK);
+    });
+}
+
+std::map<std::string, InferenceEngine::InferenceEngineProfileInfo>
+Engines::IERequestBackend::getPerformanceCounts()
+{
+  return request_->GetPerformanceCounts();
+}
@@ -0,0 +1,395 @@
+// Copyright (c) 2018-2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @brief An implementation file with implementation for KServeClient Class
+ * @file kserve_client.cpp
+ */
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <yaml-cpp/yaml.h>
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "dynamic_vino_lib/engines/kserve_client.hpp"
+
+namespace
+{
+/**
+ * @brief Append the values of a JSON "data" array, flat or nested by the shape.
+ */
+template<typename T, typename Parsed = T>
+void appendValues(const YAML::Node & values, std::vector<uint8_t> & data)
+{
+  for (const auto & value : values) {
+    if (value.IsSequence()) {
+      appendValues<T, Parsed>(value, data);
+      continue;
+    }
+    T typed = static_cast<T>(value.as<Parsed>());
+    auto bytes = reinterpret_cast<const uint8_t *>(&typed);
+    data.insert(data.end(), bytes, bytes + sizeof(T));
+  }
+}
+
+bool appendValues(
+  const YAML::Node & values, const std::string & datatype, std::vector<uint8_t> & data)
+{
+  if (datatype == "FP32") {
+    appendValues<float>(values, data);
+  } else if (datatype == "FP64") {
+    appendValues<double>(values, data);
+  } else if (datatype == "INT32") {
+    appendValues<int32_t>(values, data);
+  } else if (datatype == "INT64") {
+    appendValues<int64_t>(values, data);
+  } else if (datatype == "UINT8") {
+    // parsed as numbers, a uint8_t is read as a character
+    appendValues<uint8_t, int>(values, data);
+  } else {
+    return false;
+  }
+  return true;
+}
+
+std::string toLower(std::string text)
+{
+  std::transform(text.begin(), text.end(), text.begin(), ::tolower);
+  return text;
+}
+}  // namespace
+
+bool Engines::KServeClient::parseEndpoint(
+  const std::string & endpoint, std::string & host, std::string & port, std::string & model)
+{
+  auto slash = endpoint.find('/');
+  std::string address = endpoint.substr(0, slash);
+  model = slash == std::string::npos ? "" : endpoint.substr(slash + 1);
+  auto colon = address.rfind(':');
+  if (colon == std::string::npos || colon == 0 || colon + 1 == address.size()) {
+    return false;
+  }
+  host = address.substr(0, colon);
+  port = address.substr(colon + 1);
+  // an IPv6 address is bracketed, [::1]:9000
+  if (host.size() > 2 && host.front() == '[' && host.back() == ']') {
+    host = host.substr(1, host.size() - 2);
+  }
+  return true;
+}
+
+size_t Engines::KServeClient::getDatatypeSize(const std::string & datatype)
+{
+  static const std::map<std::string, size_t> sizes = {
+    {"BOOL", 1}, {"UINT8", 1}, {"INT8", 1}, {"UINT16", 2}, {"INT16", 2}, {"FP16", 2},
+    {"UINT32", 4}, {"INT32", 4}, {"FP32", 4}, {"UINT64", 8}, {"INT64", 8}, {"FP64", 8}};
+  auto found = sizes.find(datatype);
+  return found == sizes.end() ? 0 : found->second;
+}
+
+Engines::KServeClient::KServeClient(
+  const std::string & host, const std::string & port, const std::string & model)
+: host_(host), port_(port), model_(model)
+{
+}
+
+Engines::KServeClient::~KServeClient()
+{
+  disconnect();
+}
+
+bool Engines::KServeClient::connect(int timeout_ms, std::string & error)
+{
+  addrinfo hints;
+  std::memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  addrinfo * addresses = nullptr;
+  int status = getaddrinfo(host_.c_str(), port_.c_str(), &hints, &addresses);
+  if (status != 0) {
+    error = "failed to resolve " + host_ + ": " + gai_strerror(status);
+    return false;
+  }
+  timeval timeout;
+  timeout.tv_sec = timeout_ms / 1000;
+  timeout.tv_usec = (timeout_ms % 1000) * 1000;
+  int fd = -1;
+  int connect_errno = 0;
+  for (auto address = addresses; address != nullptr; address = address->ai_next) {
+    fd = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+    if (fd < 0) {
+      connect_errno = errno;
+      continue;
+    }
+    // the send timeout bounds the connection as well
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    if (::connect(fd, address->ai_addr, address->ai_addrlen) == 0) {
+      break;
+    }
+    connect_errno = errno;
+    ::close(fd);
+    fd = -1;
+  }
+  freeaddrinfo(addresses);
+  if (fd < 0) {
+    error = "failed to connect to " + host_ + ":" + port_ + ": " + std::strerror(connect_errno);
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(fd_mutex_);
+  fd_ = fd;
+  pending_.clear();
+  return true;
+}
+
+void Engines::KServeClient::disconnect()
+{
+  std::lock_guard<std::mutex> lock(fd_mutex_);
+  if (fd_ >= 0) {
+    ::close(fd_);
+    fd_ = -1;
+  }
+  pending_.clear();
+}
+
+void Engines::KServeClient::cancel()
+{
+  std::lock_guard<std::mutex> lock(fd_mutex_);
+  cancelled_ = true;
+  if (fd_ >= 0) {
+    // the blocked send or receive returns, the connection is closed by infer
+    shutdown(fd_, SHUT_RDWR);
+  }
+}
+
+bool Engines::KServeClient::sendAll(const char * data, size_t size)
+{
+  while (size > 0) {
+    ssize_t sent = send(fd_, data, size, MSG_NOSIGNAL);
+    if (sent < 0 && errno == EINTR) {
+      continue;
+    }
+    if (sent <= 0) {
+      return false;
+    }
+    data += sent;
+    size -= sent;
+  }
+  return true;
+}
+
+bool Engines::KServeClient::receiveResponse(
+  int & status, std::string & body, size_t & header_size, bool & closed, std::string & error)
+{
+  std::string & buffer = pending_;
+  closed = false;
+  char chunk[64 * 1024];
+  auto receive = [&]() {
+      ssize_t received = recv(fd_, chunk, sizeof(chunk), 0);
+      while (received < 0 && errno == EINTR) {
+        received = recv(fd_, chunk, sizeof(chunk), 0);
+      }
+      if (received > 0) {
+        buffer.append(chunk, received);
+        return true;
+      }
+      if (received == 0) {
+        closed = buffer.empty();
+        error = "the server closed the connection";
+      } else {
+        error = (errno == EAGAIN || errno == EWOULDBLOCK) ? "timed out" : std::strerror(errno);
+      }
+      return false;
+    };
+
+  size_t end;
+  while ((end = buffer.find("\r\n\r\n")) == std::string::npos) {
+    if (!receive()) {
+      return false;
+    }
+  }
+  std::istringstream head(buffer.substr(0, end));
+  std::string line;
+  std::getline(head, line);
+  auto space = line.find(' ');
+  status = space == std::string::npos ? 0 : std::atoi(line.c_str() + space + 1);
+  size_t content_length = 0;
+  bool has_length = false;
+  bool keep_alive = true;
+  header_size = std::string::npos;
+  while (std::getline(head, line)) {
+    auto colon = line.find(':');
+    if (colon == std::string::npos) {
+      continue;
+    }
+    std::string name = toLower(line.substr(0, colon));
+    std::string value = line.substr(colon + 1);
+    value.erase(0, value.find_first_not_of(" \t"));
+    value.erase(value.find_last_not_of(" \t\r") + 1);
+    if (name == "content-length") {
+      content_length = std::strtoull(value.c_str(), nullptr, 10);
+      has_length = true;
+    } else if (name == "inference-header-content-length") {
+      header_size = std::strtoull(value.c_str(), nullptr, 10);
+    } else if (name == "connection") {
+      keep_alive = toLower(value) != "close";
+    } else if (name == "transfer-encoding" && toLower(value) != "identity") {
+      error = "unsupported transfer encoding " + value;
+      return false;
+    }
+  }
+  if (!has_length) {
+    error = "no content length in the response";
+    return false;
+  }
+  size_t start = end + 4;
+  while (buffer.size() < start + content_length) {
+    if (!receive()) {
+      return false;
+    }
+  }
+  body = buffer.substr(start, content_length);
+  buffer.erase(0, start + content_length);
+  header_size = std::min(header_size, body.size());
+  if (!keep_alive) {
+    disconnect();
+  }
+  return true;
+}
+
+bool Engines::KServeClient::parseResults(
+  const std::string & body, size_t header_size, std::vector<Result> & results,
+  std::string & error)
+{
+  results.clear();
+  size_t offset = header_size;
+  try {
+    YAML::Node root = YAML::Load(body.substr(0, header_size));
+    for (const auto & output : root["outputs"]) {
+      Result result;
+      result.name = output["name"].as<std::string>();
+      result.datatype = output["datatype"].as<std::string>();
+      size_t count = 1;
+      for (const auto & dim : output["shape"]) {
+        result.shape.push_back(dim.as<size_t>());
+        count *= result.shape.back();
+      }
+      auto parameters = output["parameters"];
+      if (parameters && parameters["binary_data_size"]) {
+        size_t size = parameters["binary_data_size"].as<size_t>();
+        if (offset + size > body.size()) {
+          error = "the output " + result.name + " is truncated";
+          return false;
+        }
+        result.data.assign(body.begin() + offset, body.begin() + offset + size);
+        offset += size;
+      } else if (!appendValues(output["data"], result.datatype, result.data)) {
+        error = "the output " + result.name + " is " + result.datatype + " in JSON";
+        return false;
+      }
+      if (result.data.size() != count * getDatatypeSize(result.datatype)) {
+        error = "the output " + result.name + " has " + std::to_string(result.data.size()) +
+          " bytes for its shape";
+        return false;
+      }
+      results.push_back(std::move(result));
+    }
+  } catch (const YAML::Exception & e) {
+    error = std::string("malformed response: ") + e.what();
+    return false;
+  }
+  return true;
+}
+
+bool Engines::KServeClient::infer(
+  const std::vector<Tensor> & inputs, const std::vector<std::string> & outputs, int timeout_ms,
+  std::vector<Result> & results, std::string & error)
+{
+  // the JSON header of the request, the tensors follow it in binary
+  std::ostringstream json;
+  size_t data_bytes = 0;
+  json << "{\"inputs\":[";
+  for (size_t i = 0; i < inputs.size(); i++) {
+    json << (i > 0 ? "," : "") << "{\"name\":\"" << inputs[i].name << "\",\"datatype\":\"" <<
+      inputs[i].datatype << "\",\"shape\":[";
+    for (size_t d = 0; d < inputs[i].shape.size(); d++) {
+      json << (d > 0 ? "," : "") << inputs[i].shape[d];
+    }
+    json << "],\"parameters\":{\"binary_data_size\":" << inputs[i].bytes << "}}";
+    data_bytes += inputs[i].bytes;
+  }
+  json << "],\"outputs\":[";
+  for (size_t i = 0; i < outputs.size(); i++) {
+    json << (i > 0 ? "," : "") << "{\"name\":\"" << outputs[i] <<
+      "\",\"parameters\":{\"binary_data\":true}}";
+  }
+  json << "]}";
+  std::string header = json.str();
+  std::ostringstream http;
+  http << "POST /v2/models/" << model_ << "/infer HTTP/1.1\r\n" <<
+    "Host: " << host_ << ":" << port_ << "\r\n" <<
+    "Content-Type: application/octet-stream\r\n" <<
+    "Inference-Header-Content-Length: " << header.size() << "\r\n" <<
+    "Content-Length: " << header.size() + data_bytes << "\r\n\r\n" << header;
+  std::string request = http.str();
+
+  {
+    std::lock_guard<std::mutex> lock(fd_mutex_);
+    cancelled_ = false;
+  }
+  for (int attempt = 0; attempt < 2; attempt++) {
+    bool reused = fd_ >= 0;
+    if (!reused && !connect(timeout_ms, error)) {
+      return false;
+    }
+    bool sent = sendAll(request.data(), request.size());
+    for (size_t i = 0; sent && i < inputs.size(); i++) {
+      sent = sendAll(reinterpret_cast<const char *>(inputs[i].data), inputs[i].bytes);
+    }
+    int status = 0;
+    std::string body;
+    size_t header_size = 0;
+    bool closed = !sent;
+    if (!sent) {
+      error = std::string("failed to send the request: ") + std::strerror(errno);
+    } else if (receiveResponse(status, body, header_size, closed, error)) {
+      if (status != 200) {
+        error = "the server replied " + std::to_string(status) + ": " +
+          body.substr(0, std::min<size_t>(body.size(), 256));
+        return false;
+      }
+      return parseResults(body, header_size, results, error);
+    }
+    disconnect();
+    // a kept connection may have been closed by the server meanwhile, retried on a new one
+    std::lock_guard<std::mutex> lock(fd_mutex_);
+    if (!reused || !closed || cancelled_) {
+      return false;
+    }
+  }
+  return false;
+}
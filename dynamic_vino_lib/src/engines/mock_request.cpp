@@ -0,0 +1,216 @@
+// Copyright (c) 2018-2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @brief An implementation file with implementation for MockRequest Class
+ * @file mock_request.cpp
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "dynamic_vino_lib/engines/mock_request.hpp"
+
+namespace
+{
+// the synthetic boxes of a DetectionOutput
+const int kMockDetections = 4;
+}  // namespace
+
+Engines::MockRequest::MockRequest(
+  const InferenceEngine::InputsDataMap & inputs, const InferenceEngine::OutputsDataMap & outputs,
+  double latency_ms, const std::string & directory)
+: latency_ms_(std::max(latency_ms, 0.0))
+{
+  for (auto & input : inputs) {
+    inputs_[input.first] = allocateBlob(input.second->getTensorDesc());
+  }
+  for (auto & output : outputs) {
+    auto blob = allocateBlob(output.second->getTensorDesc());
+    if (directory.empty()) {
+      fillSynthetic(blob);
+    } else {
+      // the names of the layers may hold slashes
+      auto file = output.first;
+      std::replace(file.begin(), file.end(), '/', '_');
+      fillRecorded(directory + "/" + file + ".bin", blob);
+    }
+    outputs_[output.first] = blob;
+  }
+  thread_ = std::thread(&MockRequest::work, this);
+}
+
+Engines::MockRequest::~MockRequest()
+{
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    stopping_ = true;
+  }
+  cv_.notify_all();
+  thread_.join();
+}
+
+void Engines::MockRequest::fillRecorded(
+  const std::string & file, const InferenceEngine::Blob::Ptr & blob)
+{
+  std::ifstream stream(file, std::ios::binary);
+  if (!stream) {
+    throw std::logic_error("No recorded output " + file);
+  }
+  std::vector<char> data((std::istreambuf_iterator<char>(stream)),
+    std::istreambuf_iterator<char>());
+  auto memory = blob->buffer().as<uint8_t *>();
+  size_t size = blob->byteSize();
+  auto & dims = blob->getTensorDesc().getDims();
+  size_t frames = dims.empty() ? 1 : dims[0];
+  if (data.size() == size) {
+    std::memcpy(memory, data.data(), size);
+  } else if (frames > 1 && data.size() * frames == size) {
+    for (size_t frame = 0; frame < frames; frame++) {
+      std::memcpy(memory + frame * data.size(), data.data(), data.size());
+    }
+  } else {
+    throw std::logic_error("The recorded output " + file + " has " +
+            std::to_string(data.size()) + " bytes instead of " + std::to_string(size));
+  }
+}
+
+void Engines::MockRequest::fillSynthetic(const InferenceEngine::Blob::Ptr & blob)
+{
+  std::memset(blob->buffer().as<uint8_t *>(), 0, blob->byteSize());
+  auto & desc = blob->getTensorDesc();
+  auto & dims = desc.getDims();
+  if (desc.getPrecision() != InferenceEngine::Precision::FP32 || dims.size() < 2 ||
+    dims.back() != 7)
+  {
+    return;
+  }
+  // [image_id, label, confidence, x_min, y_min, x_max, y_max], in a row over the frame
+  auto rows = blob->buffer().as<float *>();
+  int max_rows = static_cast<int>(blob->size() / 7);
+  int count = std::min(kMockDetections, max_rows);
+  for (int i = 0; i < count; i++) {
+    float * row = rows + i * 7;
+    row[1] = 1.0f;
+    row[2] = 0.99f;
+    row[3] = (i + 0.1f) / count;
+    row[4] = 0.2f;
+    row[5] = (i + 0.9f) / count;
+    row[6] = 0.8f;
+  }
+  if (count < max_rows) {
+    rows[count * 7] = -1.0f;
+  }
+}
+
+InferenceEngine::Blob::Ptr Engines::MockRequest::getInput(const std::string & name)
+{
+  auto input = inputs_.find(name);
+  if (input == inputs_.end()) {
+    throw std::logic_error("No input " + name + " in the mock model");
+  }
+  return input->second;
+}
+
+void Engines::MockRequest::setInput(
+  const std::string & name, const InferenceEngine::Blob::Ptr & blob)
+{
+  if (inputs_.find(name) == inputs_.end()) {
+    throw std::logic_error("No input " + name + " in the mock model");
+  }
+  inputs_[name] = blob;
+}
+
+InferenceEngine::Blob::CPtr Engines::MockRequest::getOutput(const std::string & name)
+{
+  auto output = outputs_.find(name);
+  if (output == outputs_.end()) {
+    throw std::logic_error("No output " + name + " in the mock model");
+  }
+  return output->second;
+}
+
+void Engines::MockRequest::setCompletionCallback(const std::function<void(bool)> & callback)
+{
+  std::lock_guard<std::mutex> lk(mutex_);
+  callback_ = callback;
+}
+
+void Engines::MockRequest::startAsync()
+{
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    started_ = true;
+    cancelled_ = false;
+  }
+  cv_.notify_all();
+}
+
+void Engines::MockRequest::infer()
+{
+  std::unique_lock<std::mutex> lk(mutex_);
+  cancelled_ = false;
+  if (!run(lk)) {
+    throw std::runtime_error("Mock inference cancelled");
+  }
+}
+
+void Engines::MockRequest::cancel()
+{
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    cancelled_ = true;
+  }
+  cv_.notify_all();
+}
+
+bool Engines::MockRequest::run(std::unique_lock<std::mutex> & lk)
+{
+  if (latency_ms_ > 0) {
+    auto deadline = std::chrono::steady_clock::now() +
+      std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+      std::chrono::duration<double, std::milli>(latency_ms_));
+    cv_.wait_until(lk, deadline, [this]() {return cancelled_ || stopping_;});
+  }
+  return !cancelled_ && !stopping_;
+}
+
+void Engines::MockRequest::work()
+{
+  std::unique_lock<std::mutex> lk(mutex_);
+  while (true) {
+    cv_.wait(lk, [this]() {return started_ || stopping_;});
+    if (stopping_) {
+      return;
+    }
+    bool succeeded = run(lk);
+    started_ = false;
+    if (stopping_) {
+      return;
+    }
+    auto callback = callback_;
+    lk.unlock();
+    // the request may be started again by the callback
+    if (callback) {
+      callback(succeeded);
+    }
+    lk.lock();
+  }
+}
@@ -0,0 +1,218 @@
+// Copyright (c) 2018-2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @brief An implementation file with implementation for RemoteRequest Class
+ * @file remote_request.cpp
+ */
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "dynamic_vino_lib/engines/remote_request.hpp"
+#include "dynamic_vino_lib/slog.hpp"
+
+namespace
+{
+std::string getDatatype(const InferenceEngine::Precision & precision)
+{
+  switch (precision) {
+    case InferenceEngine::Precision::FP32: return "FP32";
+    case InferenceEngine::Precision::FP16: return "FP16";
+    case InferenceEngine::Precision::U8: return "UINT8";
+    case InferenceEngine::Precision::I8: return "INT8";
+    case InferenceEngine::Precision::U16: return "UINT16";
+    case InferenceEngine::Precision::I16: return "INT16";
+    case InferenceEngine::Precision::I32: return "INT32";
+    case InferenceEngine::Precision::I64: return "INT64";
+    default: return "";
+  }
+}
+}  // namespace
+
+Engines::RemoteRequest::RemoteRequest(
+  const std::string & host, const std::string & port, const std::string & model,
+  const InferenceEngine::InputsDataMap & inputs, const InferenceEngine::OutputsDataMap & outputs,
+  int timeout_ms)
+: client_(host, port, model), timeout_ms_(timeout_ms)
+{
+  for (auto & input : inputs) {
+    inputs_[input.first] = allocateBlob(input.second->getTensorDesc());
+    auto & dims = input.second->getTensorDesc().getDims();
+    batch_ = dims.empty() ? 1 : static_cast<int>(dims[0]);
+  }
+  for (auto & output : outputs) {
+    outputs_[output.first] = allocateBlob(output.second->getTensorDesc());
+  }
+  thread_ = std::thread(&RemoteRequest::work, this);
+}
+
+Engines::RemoteRequest::~RemoteRequest()
+{
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    stopping_ = true;
+  }
+  client_.cancel();
+  cv_.notify_all();
+  thread_.join();
+}
+
+InferenceEngine::Blob::Ptr Engines::RemoteRequest::getInput(const std::string & name)
+{
+  auto input = inputs_.find(name);
+  if (input == inputs_.end()) {
+    throw std::logic_error("No input " + name + " in the model " + client_.getModel());
+  }
+  return input->second;
+}
+
+InferenceEngine::Blob::CPtr Engines::RemoteRequest::getOutput(const std::string & name)
+{
+  auto output = outputs_.find(name);
+  if (output == outputs_.end()) {
+    throw std::logic_error("No output " + name + " in the model " + client_.getModel());
+  }
+  return output->second;
+}
+
+void Engines::RemoteRequest::setInput(
+  const std::string & name, const InferenceEngine::Blob::Ptr & blob)
+{
+  auto input = inputs_.find(name);
+  if (input == inputs_.end()) {
+    throw std::logic_error("No input " + name + " in the model " + client_.getModel());
+  }
+  // the server gets the tensor of the model, it does no resizing nor layout conversion
+  if (blob->getTensorDesc() != input->second->getTensorDesc()) {
+    throw std::logic_error("The input " + name + " of a remote model can't be replaced by " +
+            "a blob of another size or layout");
+  }
+  inputs_[name] = blob;
+}
+
+void Engines::RemoteRequest::setBatch(int batch)
+{
+  batch_ = std::max(batch, 1);
+}
+
+void Engines::RemoteRequest::setCompletionCallback(const std::function<void(bool)> & callback)
+{
+  std::lock_guard<std::mutex> lk(mutex_);
+  callback_ = callback;
+}
+
+void Engines::RemoteRequest::startAsync()
+{
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    started_ = true;
+  }
+  cv_.notify_all();
+}
+
+void Engines::RemoteRequest::infer()
+{
+  std::string error;
+  if (!run(error)) {
+    throw std::runtime_error("Remote inference of " + client_.getModel() + " failed: " + error);
+  }
+}
+
+void Engines::RemoteRequest::cancel()
+{
+  client_.cancel();
+}
+
+bool Engines::RemoteRequest::run(std::string & error)
+{
+  std::vector<KServeClient::Tensor> tensors;
+  for (auto & input : inputs_) {
+    auto & desc = input.second->getTensorDesc();
+    KServeClient::Tensor tensor;
+    tensor.name = input.first;
+    tensor.datatype = getDatatype(desc.getPrecision());
+    tensor.shape = desc.getDims();
+    tensor.bytes = input.second->byteSize();
+    // the frames of a partial batch only
+    if (!tensor.shape.empty() && tensor.shape[0] > static_cast<size_t>(batch_)) {
+      tensor.bytes = tensor.bytes / tensor.shape[0] * batch_;
+      tensor.shape[0] = batch_;
+    }
+    tensor.data = input.second->cbuffer().as<const uint8_t *>();
+    tensors.push_back(tensor);
+  }
+  std::vector<std::string> names;
+  for (auto & output : outputs_) {
+    names.push_back(output.first);
+  }
+  std::vector<KServeClient::Result> results;
+  if (!client_.infer(tensors, names, timeout_ms_, results, error)) {
+    return false;
+  }
+  for (auto & result : results) {
+    auto output = outputs_.find(result.name);
+    if (output == outputs_.end()) {
+      continue;
+    }
+    auto datatype = getDatatype(output->second->getTensorDesc().getPrecision());
+    if (result.datatype != datatype) {
+      error = "the output " + result.name + " is " + result.datatype + " instead of " + datatype;
+      return false;
+    }
+    // the rows of a partial batch, the others are zeroed
+    auto memory = output->second->buffer().as<uint8_t *>();
+    size_t size = output->second->byteSize();
+    size_t copied = std::min(size, result.data.size());
+    std::memcpy(memory, result.data.data(), copied);
+    std::memset(memory + copied, 0, size - copied);
+  }
+  return true;
+}
+
+void Engines::RemoteRequest::work()
+{
+  std::unique_lock<std::mutex> lk(mutex_);
+  while (true) {
+    cv_.wait(lk, [this]() {return started_ || stopping_;});
+    if (stopping_) {
+      return;
+    }
+    lk.unlock();
+    std::string error;
+    bool succeeded = run(error);
+    if (!succeeded && !failing_) {
+      slog::warn << "Remote inference of " << client_.getModel() << " failed: " << error <<
+        slog::endl;
+    } else if (succeeded && failing_) {
+      slog::info << "Remote inference of " << client_.getModel() << " recovered" << slog::endl;
+    }
+    failing_ = !succeeded;
+    lk.lock();
+    started_ = false;
+    if (stopping_) {
+      return;
+    }
+    auto callback = callback_;
+    lk.unlock();
+    // the request may be started again by the callback
+    if (callback) {
+      callback(succeeded);
+    }
+    lk.lock();
+  }
+}
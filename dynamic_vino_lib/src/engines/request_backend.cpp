@@ -0,0 +1,72 @@
+// Copyright (c) 2018-2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @brief An implementation file with implementation for RequestBackend Class
+ * @file request_backend.cpp
+ */
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include "dynamic_vino_lib/engines/request_backend.hpp"
+
+namespace
+{
+template<typename T>
+InferenceEngine::Blob::Ptr makeBlob(const InferenceEngine::TensorDesc & desc, void * memory)
+{
+  if (memory == nullptr) {
+    return InferenceEngine::make_shared_blob<T>(desc);
+  }
+  return InferenceEngine::make_shared_blob<T>(desc, static_cast<T *>(memory));
+}
+
+InferenceEngine::Blob::Ptr makeBlob(const InferenceEngine::TensorDesc & desc, void * memory)
+{
+  switch (desc.getPrecision()) {
+    case InferenceEngine::Precision::FP32:
+      return makeBlob<float>(desc, memory);
+    case InferenceEngine::Precision::FP16:
+    case InferenceEngine::Precision::I16:
+      return makeBlob<int16_t>(desc, memory);
+    case InferenceEngine::Precision::U16:
+      return makeBlob<uint16_t>(desc, memory);
+    case InferenceEngine::Precision::U8:
+      return makeBlob<uint8_t>(desc, memory);
+    case InferenceEngine::Precision::I8:
+      return makeBlob<int8_t>(desc, memory);
+    case InferenceEngine::Precision::I32:
+      return makeBlob<int32_t>(desc, memory);
+    case InferenceEngine::Precision::I64:
+      return makeBlob<int64_t>(desc, memory);
+    default:
+      throw std::logic_error(std::string("No blobs of precision ") +
+              desc.getPrecision().name());
+  }
+}
+}  // namespace
+
+InferenceEngine::Blob::Ptr Engines::RequestBackend::allocateBlob(
+  const InferenceEngine::TensorDesc & desc)
+{
+  auto blob = makeBlob(desc, nullptr);
+  blob->allocate();
+  return blob;
+}
+
+InferenceEngine::Blob::Ptr Engines::RequestBackend::wrapBlob(
+  const InferenceEngine::TensorDesc & desc, void * memory)
+{
+  return makeBlob(desc, memory);
+}
@@ -0,0 +1,326 @@
+// Copyright (c) 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @brief An implementation file with implementation for ShmRequest Class
+ * @file shm_request.cpp
+ */
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include "dynamic_vino_lib/engines/shm_channel.hpp"
+#include "dynamic_vino_lib/engines/shm_request.hpp"
+#include "dynamic_vino_lib/slog.hpp"
+
+namespace
+{
+// the daemon loads the network for the first worker asking for it
+const int kLoadTimeoutMs = 120000;
+std::atomic<int> segment_count(0);
+
+uint64_t getTensorBytes(const InferenceEngine::TensorDesc & desc)
+{
+  uint64_t bytes = desc.getPrecision().size();
+  for (auto dim : desc.getDims()) {
+    bytes *= dim;
+  }
+  return bytes;
+}
+}  // namespace
+
+Engines::ShmRequest::ShmRequest(
+  const std::string & socket, const std::string & device, const std::string & model,
+  const InferenceEngine::InputsDataMap & inputs, const InferenceEngine::OutputsDataMap & outputs,
+  int timeout_ms)
+: socket_path_(socket), device_(device), model_(model), timeout_ms_(timeout_ms)
+{
+  if (inputs.size() + outputs.size() > ShmChannel::kMaxTensors) {
+    throw std::logic_error("The model " + model + " has too many tensors to be run by the daemon");
+  }
+  uint64_t offset = ShmChannel::getDataOffset();
+  for (auto & input : inputs) {
+    segment_bytes_ += (getTensorBytes(input.second->getTensorDesc()) + 63) / 64 * 64;
+  }
+  for (auto & output : outputs) {
+    segment_bytes_ += (getTensorBytes(output.second->getTensorDesc()) + 63) / 64 * 64;
+  }
+  segment_bytes_ += offset;
+
+  // the segment has no name once created, it goes away with the last process mapping it
+  auto name = "/dynamic_vino_lib_" + std::to_string(::getpid()) + "_" +
+    std::to_string(segment_count++);
+  segment_fd_ = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (segment_fd_ < 0) {
+    throw std::runtime_error("Failed to create the shared memory " + name + ": " +
+            std::strerror(errno));
+  }
+  ::shm_unlink(name.c_str());
+  if (::ftruncate(segment_fd_, segment_bytes_) != 0) {
+    ::close(segment_fd_);
+    throw std::runtime_error("Failed to size the shared memory " + name + ": " +
+            std::strerror(errno));
+  }
+  void * memory = ::mmap(nullptr, segment_bytes_, PROT_READ | PROT_WRITE, MAP_SHARED,
+      segment_fd_, 0);
+  if (memory == MAP_FAILED) {
+    ::close(segment_fd_);
+    throw std::runtime_error("Failed to map the shared memory " + name + ": " +
+            std::strerror(errno));
+  }
+  segment_ = static_cast<uint8_t *>(memory);
+  auto header = reinterpret_cast<ShmChannel::SegmentHeader *>(segment_);
+  header->magic = ShmChannel::kMagic;
+  header->version = ShmChannel::kVersion;
+  header->tensor_count = 0;
+
+  for (auto & input : inputs) {
+    addTensor(input.first, input.second->getTensorDesc(), true, offset);
+    auto & dims = input.second->getTensorDesc().getDims();
+    batch_ = dims.empty() ? 1 : static_cast<int>(dims[0]);
+  }
+  for (auto & output : outputs) {
+    addTensor(output.first, output.second->getTensorDesc(), false, offset);
+  }
+  thread_ = std::thread(&ShmRequest::work, this);
+}
+
+Engines::ShmRequest::~ShmRequest()
+{
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    stopping_ = true;
+  }
+  cancel();
+  cv_.notify_all();
+  thread_.join();
+  disconnect();
+  inputs_.clear();
+  outputs_.clear();
+  ::munmap(segment_, segment_bytes_);
+  ::close(segment_fd_);
+}
+
+void Engines::ShmRequest::addTensor(
+  const std::string & name, const InferenceEngine::TensorDesc & desc, bool input,
+  uint64_t & offset)
+{
+  auto & dims = desc.getDims();
+  if (name.size() >= ShmChannel::kMaxName || dims.size() > ShmChannel::kMaxDims) {
+    throw std::logic_error("The tensor " + name + " of the model " + model_ +
+            " can't be run by the daemon");
+  }
+  auto header = reinterpret_cast<ShmChannel::SegmentHeader *>(segment_);
+  auto & tensor = header->tensors[header->tensor_count++];
+  ShmChannel::setName(tensor.name, sizeof(tensor.name), name);
+  tensor.input = input ? 1 : 0;
+  tensor.precision = static_cast<uint32_t>(static_cast<InferenceEngine::Precision::ePrecision>(
+      desc.getPrecision()));
+  tensor.layout = static_cast<uint32_t>(desc.getLayout());
+  tensor.rank = static_cast<uint32_t>(dims.size());
+  std::copy(dims.begin(), dims.end(), tensor.dims);
+  tensor.offset = offset;
+  tensor.bytes = getTensorBytes(desc);
+  auto blob = wrapBlob(desc, segment_ + offset);
+  if (input) {
+    inputs_[name] = blob;
+  } else {
+    outputs_[name] = blob;
+  }
+  offset += (tensor.bytes + 63) / 64 * 64;
+}
+
+InferenceEngine::Blob::Ptr Engines::ShmRequest::getInput(const std::string & name)
+{
+  auto input = inputs_.find(name);
+  if (input == inputs_.end()) {
+    throw std::logic_error("No input " + name + " in the model " + model_);
+  }
+  return input->second;
+}
+
+InferenceEngine::Blob::CPtr Engines::ShmRequest::getOutput(const std::string & name)
+{
+  auto output = outputs_.find(name);
+  if (output == outputs_.end()) {
+    throw std::logic_error("No output " + name + " in the model " + model_);
+  }
+  return output->second;
+}
+
+void Engines::ShmRequest::setInput(
+  const std::string & name, const InferenceEngine::Blob::Ptr & blob)
+{
+  auto input = inputs_.find(name);
+  if (input == inputs_.end()) {
+    throw std::logic_error("No input " + name + " in the model " + model_);
+  }
+  // the daemon reads the tensor of the model in place, it does no resizing nor layout conversion
+  if (blob->getTensorDesc() != input->second->getTensorDesc()) {
+    throw std::logic_error("The input " + name + " of a model run by the daemon can't be " +
+            "replaced by a blob of another size or layout");
+  }
+  if (blob != input->second) {
+    std::memcpy(input->second->buffer().as<uint8_t *>(), blob->cbuffer().as<const uint8_t *>(),
+      input->second->byteSize());
+  }
+}
+
+void Engines::ShmRequest::setBatch(int batch)
+{
+  batch_ = std::max(batch, 1);
+}
+
+void Engines::ShmRequest::setCompletionCallback(const std::function<void(bool)> & callback)
+{
+  std::lock_guard<std::mutex> lk(mutex_);
+  callback_ = callback;
+}
+
+void Engines::ShmRequest::startAsync()
+{
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    started_ = true;
+  }
+  cv_.notify_all();
+}
+
+void Engines::ShmRequest::infer()
+{
+  std::string error;
+  if (!run(error)) {
+    throw std::runtime_error("Inference of " + model_ + " by the daemon failed: " + error);
+  }
+}
+
+void Engines::ShmRequest::cancel()
+{
+  int fd = socket_.load();
+  if (fd >= 0) {
+    // the run waiting for the daemon fails, the next one connects again
+    ::shutdown(fd, SHUT_RDWR);
+  }
+}
+
+bool Engines::ShmRequest::connect(std::string & error)
+{
+  struct sockaddr_un address;
+  if (!ShmChannel::makeAddress(socket_path_, address)) {
+    error = "the socket path " + socket_path_ + " is too long";
+    return false;
+  }
+  int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) {
+    error = std::string("no socket: ") + std::strerror(errno);
+    return false;
+  }
+  if (::connect(fd, reinterpret_cast<struct sockaddr *>(&address), sizeof(address)) != 0) {
+    error = "no daemon on " + socket_path_ + ": " + std::strerror(errno);
+    ::close(fd);
+    return false;
+  }
+  ShmChannel::Hello hello;
+  std::memset(&hello, 0, sizeof(hello));
+  hello.magic = ShmChannel::kMagic;
+  hello.version = ShmChannel::kVersion;
+  ShmChannel::setName(hello.model, sizeof(hello.model), model_);
+  ShmChannel::setName(hello.device, sizeof(hello.device), device_);
+  hello.segment_bytes = segment_bytes_;
+  ShmChannel::Message reply;
+  if (!ShmChannel::sendWithFd(fd, &hello, sizeof(hello), segment_fd_) ||
+    !ShmChannel::receiveAll(fd, &reply, sizeof(reply), std::max(timeout_ms_, kLoadTimeoutMs)))
+  {
+    error = "the daemon on " + socket_path_ + " closed the connection";
+    ::close(fd);
+    return false;
+  }
+  if (reply.type != ShmChannel::kDone) {
+    error = "the daemon failed to load the model on " + device_;
+    ::close(fd);
+    return false;
+  }
+  socket_ = fd;
+  return true;
+}
+
+void Engines::ShmRequest::disconnect()
+{
+  int fd = socket_.exchange(-1);
+  if (fd >= 0) {
+    ::close(fd);
+  }
+}
+
+bool Engines::ShmRequest::run(std::string & error)
+{
+  if (socket_.load() < 0 && !connect(error)) {
+    return false;
+  }
+  ShmChannel::Message message = {ShmChannel::kRun, batch_};
+  ShmChannel::Message reply;
+  if (!ShmChannel::sendAll(socket_.load(), &message, sizeof(message)) ||
+    !ShmChannel::receiveAll(socket_.load(), &reply, sizeof(reply), timeout_ms_))
+  {
+    // a late reply would be taken for the next run, the connection is made again
+    error = "no reply from the daemon on " + socket_path_;
+    disconnect();
+    return false;
+  }
+  if (reply.type != ShmChannel::kDone) {
+    error = "the daemon failed to run the model on " + device_;
+    return false;
+  }
+  return true;
+}
+
+void Engines::ShmRequest::work()
+{
+  std::unique_lock<std::mutex> lk(mutex_);
+  while (true) {
+    cv_.wait(lk, [this]() {return started_ || stopping_;});
+    if (stopping_) {
+      return;
+    }
+    lk.unlock();
+    std::string error;
+    bool succeeded = run(error);
+    if (!succeeded && !failing_) {
+      slog::warn << "Inference of " << model_ << " by the daemon failed: " << error <<
+        slog::endl;
+    } else if (succeeded && failing_) {
+      slog::info << "Inference of " << model_ << " by the daemon recovered" << slog::endl;
+    }
+    failing_ = !succeeded;
+    lk.lock();
+    started_ = false;
+    if (stopping_) {
+      return;
+    }
+    auto callback = callback_;
+    lk.unlock();
+    // the request may be started again by the callback
+    if (callback) {
+      callback(succeeded);
+    }
+    lk.lock();
+  }
+}
@@ -0,0 +1,240 @@
+// Copyright (c) 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @brief a header file with declaration of FrameContext and FrameContextPool class
+ * @file frame_context.cpp
+ */
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "dynamic_vino_lib/frame_context.hpp"
+#include "dynamic_vino_lib/inferences/roi_merge.hpp"
+#include "dynamic_vino_lib/utils/frame_pool.hpp"
+#include "dynamic_vino_lib/utils/nv12.hpp"
+
+void FrameContext::reset()
+{
+  input_id_ = 0;
+  inference_region_ = cv::Rect();
+  frame_scale_ = 1;
+  depth_ = nullptr;
+  deadline_ = std::chrono::steady_clock::time_point();
+  preprocess_cache_.clear();
+  std::fill(result_ages_.begin(), result_ages_.end(), 0);
+  {
+    std::lock_guard<std::mutex> lk(data_mutex_);
+    for (auto & pair : rois_) {
+      pair.second.clear();
+    }
+    for (auto & pair : claimed_rois_) {
+      pair.second.clear();
+    }
+    for (auto & pair : results_) {
+      pair.second.clear();
+    }
+    deferred_results_.clear();
+  }
+  counter_ = 0;
+  waiting_ = false;
+}
+
+void FrameContext::setFrame(
+  const cv::Mat & frame, const std_msgs::msg::Header & header, bool nv12)
+{
+  {
+    std::lock_guard<std::mutex> lk(frame_mutex_);
+    if (nv12) {
+      nv12_frame_ = frame;
+      frame_ = cv::Mat();
+      size_ = getNV12Size(frame);
+    } else {
+      nv12_frame_ = cv::Mat();
+      frame_ = frame;
+      size_ = frame.size();
+    }
+  }
+  header_ = header;
+  preprocess_cache_.clear();
+  times_.capture = std::chrono::steady_clock::now();
+  times_.dequeue = times_.capture;
+  times_.inference_done = times_.capture;
+}
+
+const cv::Mat & FrameContext::getFrame() const
+{
+  std::lock_guard<std::mutex> lk(frame_mutex_);
+  if (frame_.empty() && !nv12_frame_.empty()) {
+    cv::Mat bgr = FramePool::create(size_, CV_8UC3);
+    cv::cvtColor(nv12_frame_, bgr, cv::COLOR_YUV2BGR_NV12);
+    frame_ = bgr;
+  }
+  return frame_;
+}
+
+cv::Mat FrameContext::getGrayFrame() const
+{
+  if (isNV12()) {
+    return getNV12Luma(nv12_frame_);
+  }
+  return getFrame();
+}
+
+void FrameContext::setRois(
+  const std::string & parent, const std::string & child,
+  const std::vector<cv::Rect> & rois)
+{
+  std::lock_guard<std::mutex> lk(data_mutex_);
+  rois_[parent + "->" + child] = rois;
+}
+
+std::vector<cv::Rect> FrameContext::getRois(const std::string & parent, const std::string & child)
+{
+  std::lock_guard<std::mutex> lk(data_mutex_);
+  auto it = rois_.find(parent + "->" + child);
+  if (it == rois_.end()) {
+    return {};
+  }
+  return it->second;
+}
+
+void FrameContext::claimRois(
+  const std::string & child, float iou, std::vector<cv::Rect> & rois,
+  std::vector<int64_t> & track_keys)
+{
+  std::lock_guard<std::mutex> lk(data_mutex_);
+  auto & claimed = claimed_rois_[child];
+  bool keyed = track_keys.size() == rois.size();
+  size_t kept = 0;
+  for (size_t i = 0; i < rois.size(); i++) {
+    bool merged = std::any_of(claimed.begin(), claimed.end(),
+        [&rois, i, iou](const cv::Rect & other) {
+          return dynamic_vino_lib::calcRoiIoU(rois[i], other) > iou;
+        });
+    if (merged) {
+      continue;
+    }
+    claimed.push_back(rois[i]);
+    rois[kept] = rois[i];
+    if (keyed) {
+      track_keys[kept] = track_keys[i];
+    }
+    kept++;
+  }
+  rois.resize(kept);
+  if (keyed) {
+    track_keys.resize(kept);
+  }
+}
+
+void FrameContext::addResults(
+  const std::string & inference, const std::vector<cv::Rect> & results)
+{
+  std::lock_guard<std::mutex> lk(data_mutex_);
+  auto & stored = results_[inference];
+  stored.insert(stored.end(), results.begin(), results.end());
+}
+
+std::vector<cv::Rect> FrameContext::getResults(const std::string & inference)
+{
+  std::lock_guard<std::mutex> lk(data_mutex_);
+  auto it = results_.find(inference);
+  if (it == results_.end()) {
+    return {};
+  }
+  return it->second;
+}
+
+void FrameContext::deferResults(
+  const std::shared_ptr<Outputs::BaseOutput> & output,
+  const dynamic_vino_lib::ResultView & results)
+{
+  std::lock_guard<std::mutex> lk(data_mutex_);
+  deferred_results_.emplace_back(output, results);
+}
+
+void FrameContext::takeDeferredResults(DeferredResults & results)
+{
+  std::lock_guard<std::mutex> lk(data_mutex_);
+  results.clear();
+  std::swap(results, deferred_results_);
+}
+
+void FrameContext::increaseInferenceCounter()
+{
+  counter_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void FrameContext::decreaseInferenceCounter()
+{
+  // only the request completing the frame wakes its waiter up, the lock
+  // orders the wakeup after the waiter checked the count
+  if (counter_.fetch_sub(1) == 1 && waiting_) {
+    { std::lock_guard<std::mutex> lk(counter_mutex_); }
+    cv_.notify_all();
+  }
+}
+
+int FrameContext::getInferenceCounter()
+{
+  return counter_;
+}
+
+void FrameContext::waitInferenceDone()
+{
+  if (counter_ <= 0) {
+    return;
+  }
+  std::unique_lock<std::mutex> lock(counter_mutex_);
+  waiting_ = true;
+  cv_.wait(lock, [self = this]() {return self->counter_ <= 0;});
+}
+
+bool FrameContext::waitInferenceDone(const std::chrono::milliseconds & timeout)
+{
+  if (counter_ <= 0) {
+    return true;
+  }
+  std::unique_lock<std::mutex> lock(counter_mutex_);
+  waiting_ = true;
+  return cv_.wait_for(lock, timeout, [self = this]() {return self->counter_ <= 0;});
+}
+
+std::shared_ptr<FrameContext> FrameContextPool::acquire()
+{
+  std::lock_guard<std::mutex> lk(pool_mutex_);
+  std::shared_ptr<FrameContext> context = nullptr;
+  for (auto & c : contexts_) {
+    if (c.use_count() == 1) {
+      context = c;
+      break;
+    }
+  }
+  if (context == nullptr) {
+    context = std::make_shared<FrameContext>();
+    contexts_.push_back(context);
+  }
+  context->reset();
+  context->setFrameId(next_frame_id_++);
+  return context;
+}
+
+size_t FrameContextPool::size()
+{
+  std::lock_guard<std::mutex> lk(pool_mutex_);
+  return contexts_.size();
+}
@@ -17,6 +17,7 @@
  * @file age_gender_detection.cpp
  */
 
+#include <algorithm>
 #include <string>
 #include <memory>
 #include <vector>
@@ -31,7 +32,7 @@ dynamic_vino_lib::AgeGenderResult::AgeGenderResult(const cv::Rect & location)
 
 // AgeGender Detection
 dynamic_vino_lib::AgeGenderDetection::AgeGenderDetection()
-: dynamic_vino_lib::BaseInference()
+: SlotSelectingInference()
 {
 }
 
@@ -51,8 +52,8 @@ bool dynamic_vino_lib::AgeGenderDetection::enqueue(
   if (getEnqueuedNum() == 0) {
     results_.clear();
   }
-  bool succeed = dynamic_vino_lib::BaseInference::enqueue<float>(
-    frame, input_frame_loc, 1, getResultsLength(), valid_model_->getInputName());
+  bool succeed = dynamic_vino_lib::BaseInference::enqueue<u_int8_t>(
+    frame, input_frame_loc, 1, getEnqueuedNum(), valid_model_->getInputName());
   if (!succeed) {
     return false;
   }
@@ -72,13 +73,13 @@ bool dynamic_vino_lib::AgeGenderDetection::fetchResults()
   if (!can_fetch) {
     return false;
   }
-  auto request = getEngine()->getRequest();
-  InferenceEngine::Blob::Ptr genderBlob = request->GetBlob(valid_model_->getOutputGenderName());
-  InferenceEngine::Blob::Ptr ageBlob = request->GetBlob(valid_model_->getOutputAgeName());
+  auto engine = getEngine();
+  InferenceEngine::Blob::CPtr genderBlob = engine->getOutput(valid_model_->getOutputGenderName());
+  InferenceEngine::Blob::CPtr ageBlob = engine->getOutput(valid_model_->getOutputAgeName());
 
   for (int i = 0; i < results_.size(); ++i) {
-    results_[i].age_ = ageBlob->buffer().as<float *>()[i] * 100;
-    results_[i].male_prob_ = genderBlob->buffer().as<float *>()[i * 2 + 1];
+    results_[i].age_ = ageBlob->cbuffer().as<const float *>()[i] * 100;
+    results_[i].male_prob_ = genderBlob->cbuffer().as<const float *>()[i * 2 + 1];
   }
   return true;
 }
@@ -99,11 +100,27 @@ const std::string dynamic_vino_lib::AgeGenderDetection::getName() const
   return valid_model_->getModelCategory();
 }
 
-void dynamic_vino_lib::AgeGenderDetection::observeOutput(
-  const std::shared_ptr<Outputs::BaseOutput> & output)
+dynamic_vino_lib::ResultView dynamic_vino_lib::AgeGenderDetection::getResultView() const
 {
-  if (output != nullptr) {
-    output->accept(results_);
+  return ResultView(results_);
+}
+
+void dynamic_vino_lib::AgeGenderDetection::loadCachedResults(
+  const std::vector<cv::Rect> & rois, const std::vector<int64_t> & track_keys,
+  std::vector<size_t> & stale, bool any_age)
+{
+  cache_.load(getResultCachePolicy(any_age), rois, track_keys, cached_results_, stale);
+}
+
+dynamic_vino_lib::ResultView dynamic_vino_lib::AgeGenderDetection::getCachedResultView() const
+{
+  return cached_results_.empty() ? ResultView() : ResultView(cached_results_);
+}
+
+void dynamic_vino_lib::AgeGenderDetection::cacheResults(const std::vector<int64_t> & track_keys)
+{
+  for (size_t i = 0; i < results_.size() && i < track_keys.size(); i++) {
+    cache_.store(track_keys[i], results_[i], std::max(results_[i].male_prob_, 1 - results_[i].male_prob_));
   }
 }
 
@@ -115,7 +132,8 @@ const std::vector<cv::Rect> dynamic_vino_lib::AgeGenderDetection::getFilteredROI
       "Filter conditions: " << filter_conditions << slog::endl;
   }
   std::vector<cv::Rect> filtered_rois;
-  for (auto res : results_) {
+  filtered_rois.reserve(results_.size());
+  for (auto & res : results_) {
     filtered_rois.push_back(res.getLocation());
   }
   return filtered_rois;
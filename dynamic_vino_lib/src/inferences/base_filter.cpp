@@ -177,33 +177,42 @@ std::vector<std::string> dynamic_vino_lib::BaseFilter::split(
 void dynamic_vino_lib::BaseFilter::infixToSuffix(
   std::vector<std::string> & infix_conditions)
 {
+  suffix_conditons_ = toSuffix(infix_conditions);
+}
+
+std::vector<std::string> dynamic_vino_lib::BaseFilter::toSuffix(
+  const std::vector<std::string> & infix_conditions)
+{
+  std::vector<std::string> suffix_conditons;
   std::stack<std::string> operator_stack;
   for (auto elem : infix_conditions) {
     if (!elem.compare("(")) {
       operator_stack.push(elem);
     } else if (!elem.compare(")")) {
       while (!operator_stack.empty() && operator_stack.top().compare("(")) {
-        suffix_conditons_.push_back(operator_stack.top());
+        suffix_conditons.push_back(operator_stack.top());
         operator_stack.pop();
       }
       if (operator_stack.empty()) {
         slog::err << "Brackets mismatch in filter_conditions!" << slog::endl;
+        continue;
       }
       operator_stack.pop();
     } else if (isRelationOperator(elem) || isLogicOperator(elem)) {
       while (!operator_stack.empty() && isPriorTo(operator_stack.top(), elem)) {
-        suffix_conditons_.push_back(operator_stack.top());
+        suffix_conditons.push_back(operator_stack.top());
         operator_stack.pop();
       }
       operator_stack.push(elem);
     } else {
-      suffix_conditons_.push_back(elem);
+      suffix_conditons.push_back(elem);
     }
   }
   while (!operator_stack.empty()) {
-    suffix_conditons_.push_back(operator_stack.top());
+    suffix_conditons.push_back(operator_stack.top());
     operator_stack.pop();
   }
+  return suffix_conditons;
 }
 
 std::string dynamic_vino_lib::BaseFilter::strip(const std::string & str)
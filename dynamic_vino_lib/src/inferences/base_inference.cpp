@@ -17,10 +17,15 @@
  * @file base_inference.cpp
  */
 
+#include <condition_variable>
+#include <functional>
 #include <memory>
+#include <mutex>
 
 #include "dynamic_vino_lib/inferences/base_inference.hpp"
+#include "dynamic_vino_lib/inputs/base_input.hpp"
 #include "dynamic_vino_lib/models/base_model.hpp"
+#include "dynamic_vino_lib/tracing.hpp"
 
  // Result
 dynamic_vino_lib::Result::Result(const cv::Rect & location)
@@ -33,49 +38,122 @@ dynamic_vino_lib::BaseInference::BaseInference() = default;
 
 dynamic_vino_lib::BaseInference::~BaseInference() = default;
 
+void dynamic_vino_lib::BaseInference::locateResults(const Input::DepthLookup & depth)
+{
+  for (int i = 0; i < getResultsLength(); i++) {
+    // the results are owned by the inference, only handed out as const
+    auto result = const_cast<Result *>(getLocationResult(i));
+    result->has_position_ = depth.locate(result->location_, &result->position_);
+  }
+}
+
 void dynamic_vino_lib::BaseInference::loadEngine(const std::shared_ptr<Engines::Engine> engine)
 {
   engine_ = engine;
+  results_fetched_.assign(engine_ == nullptr ? 1 : engine_->getRequestNum(), false);
 }
 
 bool dynamic_vino_lib::BaseInference::submitRequest()
 {
-  if (engine_->getRequest() == nullptr) {
+  if (engine_ == nullptr) {
     return false;
   }
   if (!enqueued_frames_) {
     return false;
   }
+  setRequestBatch();
+  dumpInputs();
   enqueued_frames_ = 0;
-  results_fetched_ = false;
-  engine_->getRequest()->StartAsync();
-  slog::debug << "Async Inference started!" << slog::endl;
+  results_fetched_[engine_->getBoundRequest()] = false;
+  engine_->admitRequest();
+  DYNAMIC_VINO_LIB_TRACE(submit, trace_pipeline_, trace_node_, trace_frame_id_,
+    engine_->getBoundRequest());
+  engine_->startRequest();
+  SLOG_DEBUG << "Async Inference started!" << slog::endl;
   return true;
 }
 
 bool dynamic_vino_lib::BaseInference::SynchronousRequest()
 {
-  if (engine_->getRequest() == nullptr) {
+  if (engine_ == nullptr) {
     return false;
   }
   if (!enqueued_frames_) {
     return false;
   }
+  setRequestBatch();
+  dumpInputs();
   enqueued_frames_ = 0;
-  results_fetched_ = false;
-  engine_->getRequest()->Infer();
+  results_fetched_[engine_->getBoundRequest()] = false;
+  engine_->infer();
   return true;
 }
 
+void dynamic_vino_lib::BaseInference::setRequestBatch()
+{
+  if (!engine_->isDynamicBatchEnabled()) {
+    return;
+  }
+  try {
+    engine_->setBatch(enqueued_frames_);
+  } catch (const std::exception & e) {
+    slog::warn << "Failed to set batch " << enqueued_frames_ << " for " << getName() <<
+      ": " << e.what() << slog::endl;
+  }
+}
+
+void dynamic_vino_lib::BaseInference::dumpInputs()
+{
+  if (tensor_dump_ == nullptr) {
+    return;
+  }
+  for (auto & input : engine_->getInputBindings()) {
+    tensor_dump_->record(tensor_dump_name_, input.first, input.second.blob, enqueued_frames_);
+  }
+}
+
 bool dynamic_vino_lib::BaseInference::fetchResults()
 {
-  if (results_fetched_) {
+  if (engine_ == nullptr || results_fetched_[engine_->getBoundRequest()]) {
     return false;
   }
-  results_fetched_ = true;
+  results_fetched_[engine_->getBoundRequest()] = true;
+  DYNAMIC_VINO_LIB_TRACE(fetch_results, trace_pipeline_, trace_node_, trace_frame_id_,
+    engine_->getBoundRequest());
   return true;
 }
 
+void dynamic_vino_lib::BaseInference::packDeferred(ThreadPool * pool)
+{
+  std::vector<std::function<void()>> jobs;
+  jobs.swap(packing_jobs_);
+  if (pool == nullptr || jobs.size() < 2) {
+    for (auto & job : jobs) {
+      job();
+    }
+    return;
+  }
+
+  std::mutex mtx;
+  std::condition_variable cv;
+  size_t remaining = jobs.size();
+  for (auto & job : jobs) {
+    pool->post([&job, &mtx, &cv, &remaining]() {
+        try {
+          job();
+        } catch (const std::exception & e) {
+          slog::err << "Failed to pack a frame into the input blob: " << e.what() << slog::endl;
+        }
+        std::lock_guard<std::mutex> lk(mtx);
+        if (--remaining == 0) {
+          cv.notify_one();
+        }
+      });
+  }
+  std::unique_lock<std::mutex> lk(mtx);
+  cv.wait(lk, [&remaining]() {return remaining == 0;});
+}
+
 void dynamic_vino_lib::BaseInference::addCandidatedModel(std::shared_ptr<Models::BaseModel> model)
 {
   slog::info << "TESTING in addCandidatedModel()" << slog::endl;
@@ -16,112 +16,300 @@
  * @brief a header file with declaration of BaseReidentification class
  * @file base_reidentification.cpp
  */
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include <vector>
 #include <utility>
-#include <climits>
+#include <algorithm>
 #include <chrono>
+#include <cstdio>
+#include <cstring>
 #include <fstream>
+#include <iterator>
 #include <string>
-#include <functional>
 #include "dynamic_vino_lib/inferences/base_reidentification.hpp"
 #include "dynamic_vino_lib/slog.hpp"
 
+namespace
+{
+const char kGalleryMagic[8] = {'V', 'I', 'N', 'O', 'G', 'A', 'L', '\0'};
+const uint32_t kGalleryVersion = 1;
+enum GalleryDataType : uint32_t
+{
+  kGalleryFloat32 = 0,
+  kGalleryFloat16 = 1,
+};
+
+struct GalleryHeader
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t data_type;
+  uint32_t feature_size;
+  uint32_t reserved;
+  uint64_t count;
+  int64_t max_track_id;
+};
+
+struct GalleryRecord
+{
+  int32_t track_id;
+  int32_t reserved;
+  int64_t lastest_update_time;
+};
+
+/**< the matched features buffered by a shared tracker before they are written >**/
+const size_t kSharedUpdateBatch = 32;
+}  // namespace
+
 // Tracker
 dynamic_vino_lib::Tracker::Tracker(
-  int max_record_size, double same_track_thresh, double new_track_thresh)
+  int max_record_size, double same_track_thresh, double new_track_thresh,
+  std::shared_ptr<GalleryIndex> index)
 : max_record_size_(max_record_size),
   same_track_thresh_(same_track_thresh),
-  new_track_thresh_(new_track_thresh) {}
+  new_track_thresh_(new_track_thresh),
+  index_(index != nullptr ? index : std::make_shared<ExactGalleryIndex>()),
+  published_(std::make_shared<FeatureList>()) {}
 
-int dynamic_vino_lib::Tracker::processNewTrack(const std::vector<float> & feature)
+std::shared_ptr<dynamic_vino_lib::Tracker> dynamic_vino_lib::Tracker::getShared(
+  const std::string & name, int max_record_size, double same_track_thresh,
+  double new_track_thresh, std::shared_ptr<GalleryIndex> index)
 {
-  int most_similar_id;
-  double similarity = findMostSimilarTrack(feature, most_similar_id);
-  if (similarity > same_track_thresh_) {
-    updateMatchTrack(most_similar_id, feature);
-  } else if (similarity < new_track_thresh_) {
-    most_similar_id = addNewTrack(feature);
+  static std::mutex registry_mtx;
+  static std::unordered_map<std::string, std::weak_ptr<Tracker>> registry;
+  std::lock_guard<std::mutex> lk(registry_mtx);
+  auto tracker = registry[name].lock();
+  if (tracker == nullptr) {
+    tracker = std::make_shared<Tracker>(
+      max_record_size, same_track_thresh, new_track_thresh, index);
+    tracker->shared_ = true;
+    registry[name] = tracker;
+    slog::info << "Created shared reid gallery: " << name << slog::endl;
   }
-  return most_similar_id;
+  return tracker;
 }
 
-double dynamic_vino_lib::Tracker::findMostSimilarTrack(
-  const std::vector<float> & feature, int & most_similar_id)
+dynamic_vino_lib::Tracker::~Tracker()
 {
-  double max_similarity = 0;
-  most_similar_id = -1;
-  for (auto iter = recorded_tracks_.begin(); iter != recorded_tracks_.end(); iter++) {
-    double sim = calcSimilarity(feature, iter->second.feature);
-    if (sim > max_similarity) {
-      max_similarity = sim;
-      most_similar_id = iter->first;
+  if (snapshot_thread_.joinable()) {
+    {
+      std::lock_guard<std::mutex> lk(snapshot_mtx_);
+      stop_snapshots_ = true;
     }
+    snapshot_cv_.notify_all();
+    snapshot_thread_.join();
   }
-  return max_similarity;
+  if (!snapshot_path_.empty()) {
+    saveSnapshot();
+  }
+}
+
+size_t dynamic_vino_lib::Tracker::getMemoryBytes()
+{
+  std::lock_guard<std::mutex> lk(tracks_mtx_);
+  return index_->getMemoryBytes() + std::atomic_load(&published_)->getMemoryBytes() +
+         recorded_tracks_.size() * (sizeof(std::pair<const int, Track>) + sizeof(int));
+}
+
+int dynamic_vino_lib::Tracker::processNewTrack(const std::vector<float> & feature)
+{
+  cv::Mat row(1, static_cast<int>(feature.size()), CV_32F, const_cast<float *>(feature.data()));
+  return processNewTracks(row)[0];
 }
 
-double dynamic_vino_lib::Tracker::calcSimilarity(
-  const std::vector<float> & feature_a, const std::vector<float> & feature_b)
+std::vector<int> dynamic_vino_lib::Tracker::processNewTracks(const cv::Mat & features)
 {
-  if (feature_a.size() != feature_b.size()) {
+  std::vector<int> track_ids(features.rows, -1);
+  if (features.empty()) {
+    return track_ids;
+  }
+  if (shared_) {
+    return processSharedTracks(features);
+  }
+  std::lock_guard<std::mutex> lk(tracks_mtx_);
+  if (feature_size_ == 0) {
+    feature_size_ = features.cols;
+  } else if (features.cols != feature_size_) {
     slog::err << "cosine similarity can't be called for vectors of different lengths: " <<
-      "feature_a size = " << std::to_string(feature_a.size()) <<
-      "feature_b size = " << std::to_string(feature_b.size()) << slog::endl;
+      "feature size = " << std::to_string(features.cols) <<
+      ", recorded feature size = " << std::to_string(feature_size_) << slog::endl;
+    return track_ids;
   }
-  float mul_sum, denom_a, denom_b, value_a, value_b;
-  mul_sum = denom_a = denom_b = value_a = value_b = 0;
-  for (auto i = 0; i < feature_a.size(); i++) {
-    value_a = feature_a[i];
-    value_b = feature_b[i];
-    mul_sum += value_a * value_b;
-    denom_a += value_a * value_a;
-    denom_b += value_b * value_b;
+  cv::Mat queries = normalizeRows(features);
+  std::vector<int> most_similar_ids;
+  std::vector<double> similarities;
+  index_->search(queries, most_similar_ids, similarities);
+  // update the matched tracks first, so that adding new tracks never evicts them
+  for (int i = 0; i < queries.rows; i++) {
+    if (similarities[i] > same_track_thresh_) {
+      updateMatchTrack(most_similar_ids[i], queries.row(i));
+      track_ids[i] = most_similar_ids[i];
+    } else if (similarities[i] >= new_track_thresh_) {
+      track_ids[i] = most_similar_ids[i];
+    }
   }
-  if (denom_a == 0 || denom_b == 0) {
-    slog::err << "cosine similarity is not defined whenever one or both "
-      "input vectors are zero-vectors." << slog::endl;
+  for (int i = 0; i < queries.rows; i++) {
+    if (similarities[i] < new_track_thresh_) {
+      track_ids[i] = addNewTrack(queries.row(i));
+    }
   }
-  return mul_sum / (sqrt(denom_a) * sqrt(denom_b));
+  return track_ids;
 }
 
-void dynamic_vino_lib::Tracker::updateMatchTrack(
-  int track_id, const std::vector<float> & feature)
+std::vector<int> dynamic_vino_lib::Tracker::processSharedTracks(const cv::Mat & features)
 {
-  if (recorded_tracks_.find(track_id) != recorded_tracks_.end()) {
-    recorded_tracks_[track_id].feature.assign(feature.begin(), feature.end());
-    recorded_tracks_[track_id].lastest_update_time = getCurrentTime();
-  } else {
-    slog::err << "updating a non-existing track." << slog::endl;
+  std::vector<int> track_ids(features.rows, -1);
+  cv::Mat queries = normalizeRows(features);
+  std::vector<int> most_similar_ids(queries.rows, -1);
+  std::vector<double> similarities(queries.rows, 0);
+  auto published = std::atomic_load(&published_);
+  if (published->size() > 0 && published->getFeatureSize() != queries.cols) {
+    slog::err << "cosine similarity can't be called for vectors of different lengths: " <<
+      "feature size = " << std::to_string(queries.cols) <<
+      ", recorded feature size = " << std::to_string(published->getFeatureSize()) <<
+      slog::endl;
+    return track_ids;
+  }
+  published->search(queries, std::vector<int>(), most_similar_ids, similarities);
+
+  std::vector<int> new_rows;
+  std::vector<std::pair<int, cv::Mat>> updates;
+  for (int i = 0; i < queries.rows; i++) {
+    if (similarities[i] > same_track_thresh_) {
+      updates.emplace_back(most_similar_ids[i], queries.row(i).clone());
+      track_ids[i] = most_similar_ids[i];
+    } else if (similarities[i] >= new_track_thresh_) {
+      track_ids[i] = most_similar_ids[i];
+    } else {
+      new_rows.push_back(i);
+    }
+  }
+  bool flush;
+  {
+    std::lock_guard<std::mutex> lk(pending_mtx_);
+    std::move(updates.begin(), updates.end(), std::back_inserter(pending_updates_));
+    flush = pending_updates_.size() >= kSharedUpdateBatch;
+  }
+
+  if (!new_rows.empty()) {
+    // added at once, so that the person matches the track on the next frame
+    std::lock_guard<std::mutex> lk(tracks_mtx_);
+    if (feature_size_ == 0) {
+      feature_size_ = queries.cols;
+    } else if (queries.cols != feature_size_) {
+      slog::err << "cosine similarity can't be called for vectors of different lengths: " <<
+        "feature size = " << std::to_string(queries.cols) <<
+        ", recorded feature size = " << std::to_string(feature_size_) << slog::endl;
+      return track_ids;
+    }
+    flushUpdates();
+    // another pipeline may have added the same person since the snapshot was published
+    cv::Mat new_queries;
+    for (auto row : new_rows) {
+      new_queries.push_back(queries.row(row));
+    }
+    index_->search(new_queries, most_similar_ids, similarities);
+    for (size_t i = 0; i < new_rows.size(); i++) {
+      track_ids[new_rows[i]] = similarities[i] < new_track_thresh_ ?
+        addNewTrack(new_queries.row(static_cast<int>(i))) : most_similar_ids[i];
+    }
+    publish();
+  } else if (flush) {
+    // a pipeline already writing will publish the updates, queries never wait for it
+    std::unique_lock<std::mutex> lk(tracks_mtx_, std::try_to_lock);
+    if (lk.owns_lock()) {
+      flushUpdates();
+      publish();
+    }
   }
+  return track_ids;
 }
 
-void dynamic_vino_lib::Tracker::removeEarlestTrack()
+void dynamic_vino_lib::Tracker::flushUpdates()
 {
-  std::lock_guard<std::mutex> lk(tracks_mtx_);
-  int64_t earlest_time = LONG_MAX;
-  auto remove_iter = recorded_tracks_.begin();
-  for (auto iter = recorded_tracks_.begin(); iter != recorded_tracks_.end(); iter++) {
-    if (iter->second.lastest_update_time < earlest_time) {
-      earlest_time = iter->second.lastest_update_time;
-      remove_iter = iter;
+  std::vector<std::pair<int, cv::Mat>> updates;
+  {
+    std::lock_guard<std::mutex> lk(pending_mtx_);
+    updates.swap(pending_updates_);
+  }
+  for (auto & update : updates) {
+    // the track may have been removed since it was matched
+    if (recorded_tracks_.count(update.first)) {
+      updateMatchTrack(update.first, update.second);
     }
   }
-  recorded_tracks_.erase(remove_iter);
 }
 
+void dynamic_vino_lib::Tracker::publish()
+{
+  auto published = std::make_shared<FeatureList>(index_->getPrecision());
+  for (auto track_id : lru_tracks_) {
+    published->add(track_id, index_->getFeature(track_id));
+  }
+  std::atomic_store(&published_, std::shared_ptr<const FeatureList>(published));
+}
 
-int dynamic_vino_lib::Tracker::addNewTrack(const std::vector<float> & feature)
+cv::Mat dynamic_vino_lib::Tracker::normalizeRows(const cv::Mat & features)
 {
-  if (recorded_tracks_.size() >= max_record_size_) {
-    std::thread remove_thread(std::bind(&Tracker::removeEarlestTrack, this));
-    remove_thread.detach();
+  cv::Mat normalized;
+  features.convertTo(normalized, CV_32F);
+  for (int i = 0; i < normalized.rows; i++) {
+    cv::Mat row = normalized.row(i);
+    double norm = cv::norm(row, cv::NORM_L2);
+    if (norm == 0) {
+      slog::err << "cosine similarity is not defined whenever one or both "
+        "input vectors are zero-vectors." << slog::endl;
+      continue;
+    }
+    row.convertTo(row, -1, 1.0 / norm);
   }
-  std::lock_guard<std::mutex> lk(tracks_mtx_);
+  return normalized;
+}
+
+void dynamic_vino_lib::Tracker::updateMatchTrack(int track_id, const cv::Mat & feature)
+{
+  auto iter = recorded_tracks_.find(track_id);
+  if (iter == recorded_tracks_.end()) {
+    slog::err << "updating a non-existing track." << slog::endl;
+    return;
+  }
+  index_->upsert(track_id, feature);
+  iter->second.lastest_update_time = getCurrentTime();
+  version_++;
+  lru_tracks_.splice(lru_tracks_.end(), lru_tracks_, iter->second.lru_position);
+}
+
+void dynamic_vino_lib::Tracker::removeEarlestTrack()
+{
+  if (lru_tracks_.empty()) {
+    return;
+  }
+  int track_id = lru_tracks_.front();
+  lru_tracks_.pop_front();
+  recorded_tracks_.erase(track_id);
+  index_->remove(track_id);
+}
+
+void dynamic_vino_lib::Tracker::recordTrack(int track_id, int64_t update_time)
+{
   Track track;
-  track.lastest_update_time = getCurrentTime();
-  track.feature.assign(feature.begin(), feature.end());
+  track.lastest_update_time = update_time;
+  track.lru_position = lru_tracks_.insert(lru_tracks_.end(), track_id);
+  recorded_tracks_[track_id] = track;
+}
+
+int dynamic_vino_lib::Tracker::addNewTrack(const cv::Mat & feature)
+{
+  if (static_cast<int>(recorded_tracks_.size()) >= max_record_size_) {
+    removeEarlestTrack();
+  }
   max_track_id_ += 1;
-  recorded_tracks_.insert(std::pair<int, Track>(max_track_id_, track));
+  index_->upsert(max_track_id_, feature);
+  recordTrack(max_track_id_, getCurrentTime());
+  version_++;
   return max_track_id_;
 }
 
@@ -132,50 +320,185 @@ int64_t dynamic_vino_lib::Tracker::getCurrentTime()
   return static_cast<int64_t>(tp.time_since_epoch().count());
 }
 
-bool dynamic_vino_lib::Tracker::saveTracksToFile(std::string filepath)
+bool dynamic_vino_lib::Tracker::saveTracksToFile(const std::string & filepath, bool fp16)
 {
-  std::ofstream outfile(filepath);
+#if CV_VERSION_MAJOR < 4
+  fp16 = false;  // CV_16F needs OpenCV 4
+#endif
+  GalleryHeader header;
+  std::memcpy(header.magic, kGalleryMagic, sizeof(header.magic));
+  header.version = kGalleryVersion;
+  header.data_type = fp16 ? kGalleryFloat16 : kGalleryFloat32;
+  header.reserved = 0;
+  std::vector<GalleryRecord> records;
+  cv::Mat features;
+  {
+    // only copy under the lock, the file is written without blocking the inference
+    std::lock_guard<std::mutex> lk(tracks_mtx_);
+    header.feature_size = static_cast<uint32_t>(feature_size_);
+    header.count = lru_tracks_.size();
+    header.max_track_id = max_track_id_;
+    features.create(static_cast<int>(lru_tracks_.size()), feature_size_, CV_32F);
+    int row = 0;
+    // oldest first, so that loading the file restores the eviction order
+    for (auto track_id : lru_tracks_) {
+      GalleryRecord record;
+      record.track_id = track_id;
+      record.reserved = 0;
+      record.lastest_update_time = recorded_tracks_[track_id].lastest_update_time;
+      records.push_back(record);
+      index_->getFeature(track_id).copyTo(features.row(row++));
+    }
+  }
+#if CV_VERSION_MAJOR >= 4
+  if (fp16) {
+    features.convertTo(features, CV_16F);
+  }
+#endif
+
+  std::string temp_path = filepath + ".tmp";
+  std::ofstream outfile(temp_path, std::ios::binary | std::ios::trunc);
   if (!outfile.is_open()) {
-    slog::err << "file not exists in file path: " << filepath << slog::endl;
+    slog::err << "Failed to open gallery file: " << temp_path << slog::endl;
     return false;
   }
-  for (auto record : recorded_tracks_) {
-    outfile << record.first << " " <<
-      record.second.lastest_update_time << " ";
-    for (auto elem : record.second.feature) {
-      outfile << elem << " ";
-    }
-    outfile << "\n";
-  }
+  outfile.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  outfile.write(reinterpret_cast<const char *>(records.data()),
+    records.size() * sizeof(GalleryRecord));
+  outfile.write(reinterpret_cast<const char *>(features.data),
+    features.total() * features.elemSize());
   outfile.close();
-  slog::info << "sucessfully save tracks into file: " << filepath << slog::endl;
+  // readers never see a partially written gallery
+  if (!outfile || std::rename(temp_path.c_str(), filepath.c_str()) != 0) {
+    slog::err << "Failed to write gallery file: " << filepath << slog::endl;
+    std::remove(temp_path.c_str());
+    return false;
+  }
+  slog::info << "sucessfully save " << header.count << " tracks into file: " << filepath <<
+    slog::endl;
   return true;
 }
 
-bool dynamic_vino_lib::Tracker::loadTracksFromFile(std::string filepath)
+bool dynamic_vino_lib::Tracker::loadTracksFromFile(const std::string & filepath)
 {
-  std::ifstream infile(filepath);
-  if (!infile.is_open()) {
+  int fd = open(filepath.c_str(), O_RDONLY);
+  if (fd < 0) {
     slog::err << "file not exists in file path: " << filepath << slog::endl;
     return false;
   }
-  recorded_tracks_.clear();
-  while (!infile.eof()) {
-    int track_id;
-    int64_t lastest_update_time;
-    std::vector<float> feature;
-    infile >> track_id >> lastest_update_time;
-    for (int num = 0; num < 256; num++) {
-      float elem;
-      infile >> elem;
-      feature.push_back(elem);
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0 || file_stat.st_size < static_cast<off_t>(sizeof(GalleryHeader))) {
+    slog::err << "Invalid gallery file: " << filepath << slog::endl;
+    close(fd);
+    return false;
+  }
+  size_t file_size = static_cast<size_t>(file_stat.st_size);
+  void * data = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED) {
+    slog::err << "Failed to map gallery file: " << filepath << slog::endl;
+    return false;
+  }
+
+  const char * base = static_cast<const char *>(data);
+  GalleryHeader header;
+  std::memcpy(&header, base, sizeof(header));
+  size_t element_size = header.data_type == kGalleryFloat16 ? 2 : 4;
+  size_t expected_size = sizeof(GalleryHeader) + header.count * sizeof(GalleryRecord) +
+    header.count * header.feature_size * element_size;
+  bool valid = std::memcmp(header.magic, kGalleryMagic, sizeof(kGalleryMagic)) == 0 &&
+    header.version == kGalleryVersion && header.feature_size > 0 && file_size == expected_size;
+#if CV_VERSION_MAJOR < 4
+  valid = valid && header.data_type == kGalleryFloat32;
+#endif
+  if (!valid) {
+    slog::err << "Invalid or unsupported gallery file: " << filepath << slog::endl;
+    munmap(data, file_size);
+    return false;
+  }
+
+  auto records = reinterpret_cast<const GalleryRecord *>(base + sizeof(GalleryHeader));
+  void * feature_data = const_cast<char *>(base) + sizeof(GalleryHeader) +
+    header.count * sizeof(GalleryRecord);
+  cv::Mat features;
+#if CV_VERSION_MAJOR >= 4
+  if (header.data_type == kGalleryFloat16) {
+    cv::Mat(static_cast<int>(header.count), static_cast<int>(header.feature_size), CV_16F,
+      feature_data).convertTo(features, CV_32F);
+  }
+#endif
+  if (features.empty()) {
+    // used in place, each row is copied once into the index
+    features = cv::Mat(static_cast<int>(header.count), static_cast<int>(header.feature_size),
+        CV_32F, feature_data);
+  }
+
+  {
+    std::lock_guard<std::mutex> lk(tracks_mtx_);
+    index_->clear();
+    recorded_tracks_.clear();
+    lru_tracks_.clear();
+    feature_size_ = static_cast<int>(header.feature_size);
+    max_track_id_ = static_cast<int>(header.max_track_id);
+    for (uint64_t i = 0; i < header.count; i++) {
+      int track_id = records[i].track_id;
+      if (recorded_tracks_.count(track_id)) {
+        continue;
+      }
+      index_->upsert(track_id, features.row(static_cast<int>(i)));
+      recordTrack(track_id, records[i].lastest_update_time);
+      max_track_id_ = std::max(max_track_id_, track_id);
+    }
+    version_++;
+    snapshot_version_ = version_;
+    if (shared_) {
+      publish();
     }
-    Track track;
-    track.lastest_update_time = lastest_update_time;
-    track.feature = feature;
-    recorded_tracks_[track_id] = track;
   }
-  infile.close();
-  slog::info << "sucessfully load tracks from file: " << filepath << slog::endl;
+  munmap(data, file_size);
+  slog::info << "sucessfully load " << header.count << " tracks from file: " << filepath <<
+    slog::endl;
   return true;
 }
+
+void dynamic_vino_lib::Tracker::enableSnapshots(
+  const std::string & filepath, int interval_ms, bool fp16)
+{
+  if (filepath.empty() || !snapshot_path_.empty()) {
+    return;
+  }
+  if (access(filepath.c_str(), F_OK) == 0) {
+    loadTracksFromFile(filepath);
+  }
+  snapshot_path_ = filepath;
+  snapshot_fp16_ = fp16;
+  if (interval_ms <= 0) {
+    return;
+  }
+  snapshot_thread_ = std::thread([this, interval_ms]() {
+        std::unique_lock<std::mutex> lk(snapshot_mtx_);
+        while (!snapshot_cv_.wait_for(lk, std::chrono::milliseconds(interval_ms),
+          [this]() {return stop_snapshots_;}))
+        {
+          lk.unlock();
+          saveSnapshot();
+          lk.lock();
+        }
+      });
+}
+
+void dynamic_vino_lib::Tracker::saveSnapshot()
+{
+  uint64_t version;
+  {
+    std::lock_guard<std::mutex> lk(tracks_mtx_);
+    if (version_ == snapshot_version_) {
+      return;
+    }
+    version = version_;
+  }
+  if (saveTracksToFile(snapshot_path_, snapshot_fp16_)) {
+    std::lock_guard<std::mutex> lk(tracks_mtx_);
+    snapshot_version_ = version;
+  }
+}
@@ -33,7 +33,7 @@ dynamic_vino_lib::EmotionsResult::EmotionsResult(const cv::Rect & location)
 
 // Emotions Detection
 dynamic_vino_lib::EmotionsDetection::EmotionsDetection()
-: dynamic_vino_lib::BaseInference()
+: SlotSelectingInference()
 {
 }
 
@@ -53,8 +53,8 @@ bool dynamic_vino_lib::EmotionsDetection::enqueue(
   if (getEnqueuedNum() == 0) {
     results_.clear();
   }
-  bool succeed = dynamic_vino_lib::BaseInference::enqueue<float>(
-    frame, input_frame_loc, 1, getResultsLength(), valid_model_->getInputName());
+  bool succeed = dynamic_vino_lib::BaseInference::enqueue<u_int8_t>(
+    frame, input_frame_loc, 1, getEnqueuedNum(), valid_model_->getInputName());
   if (!succeed) {
     slog::err << "Failed enqueue Emotion frame." << slog::endl;
     // TODO(weizhi): throw an error here
@@ -78,11 +78,11 @@ bool dynamic_vino_lib::EmotionsDetection::fetchResults()
   }
   int label_length = static_cast<int>(valid_model_->getLabels().size());
   std::string output_name = valid_model_->getOutputName();
-  InferenceEngine::Blob::Ptr emotions_blob = getEngine()->getRequest()->GetBlob(output_name);
+  const Engines::OutputBinding & emotions = getEngine()->getOutputBinding(output_name);
   /** emotions vector must have the same size as number of channels
       in model output. Default output format is NCHW so we check index 1 */
 
-  int64 num_of_channels = emotions_blob->getTensorDesc().getDims().at(1);
+  int64 num_of_channels = emotions.dims.at(1);
   if (num_of_channels != label_length) {
     slog::err << "Output size (" << num_of_channels <<
       ") of the Emotions Recognition network is not equal " <<
@@ -95,12 +95,13 @@ bool dynamic_vino_lib::EmotionsDetection::fetchResults()
 
   /** we identify an index of the most probable emotion in output array
       for idx image to return appropriate emotion name */
-  auto emotions_values = emotions_blob->buffer().as<float *>();
+  auto emotions_values = emotions.blob->cbuffer().as<const float *>();
   for (int idx = 0; idx < results_.size(); ++idx) {
     auto output_idx_pos = emotions_values + label_length * idx;
     int64 max_prob_emotion_idx =
       std::max_element(output_idx_pos, output_idx_pos + label_length) - output_idx_pos;
     results_[idx].label_ = valid_model_->getLabels()[max_prob_emotion_idx];
+    results_[idx].confidence_ = output_idx_pos[max_prob_emotion_idx];
   }
 
   return true;
@@ -122,11 +123,27 @@ const std::string dynamic_vino_lib::EmotionsDetection::getName() const
   return valid_model_->getModelCategory();
 }
 
-void dynamic_vino_lib::EmotionsDetection::observeOutput(
-  const std::shared_ptr<Outputs::BaseOutput> & output)
+dynamic_vino_lib::ResultView dynamic_vino_lib::EmotionsDetection::getResultView() const
 {
-  if (output != nullptr) {
-    output->accept(results_);
+  return ResultView(results_);
+}
+
+void dynamic_vino_lib::EmotionsDetection::loadCachedResults(
+  const std::vector<cv::Rect> & rois, const std::vector<int64_t> & track_keys,
+  std::vector<size_t> & stale, bool any_age)
+{
+  cache_.load(getResultCachePolicy(any_age), rois, track_keys, cached_results_, stale);
+}
+
+dynamic_vino_lib::ResultView dynamic_vino_lib::EmotionsDetection::getCachedResultView() const
+{
+  return cached_results_.empty() ? ResultView() : ResultView(cached_results_);
+}
+
+void dynamic_vino_lib::EmotionsDetection::cacheResults(const std::vector<int64_t> & track_keys)
+{
+  for (size_t i = 0; i < results_.size() && i < track_keys.size(); i++) {
+    cache_.store(track_keys[i], results_[i], results_[i].confidence_);
   }
 }
 
@@ -138,7 +155,8 @@ const std::vector<cv::Rect> dynamic_vino_lib::EmotionsDetection::getFilteredROIs
       "Filter conditions: " << filter_conditions << slog::endl;
   }
   std::vector<cv::Rect> filtered_rois;
-  for (auto res : results_) {
+  filtered_rois.reserve(results_.size());
+  for (auto & res : results_) {
     filtered_rois.push_back(res.getLocation());
   }
   return filtered_rois;
@@ -17,6 +17,7 @@
  * FaceReidentificationResult class
  * @file face_reidentification.cpp
  */
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <vector>
@@ -30,10 +31,18 @@ dynamic_vino_lib::FaceReidentificationResult::FaceReidentificationResult(
 : Result(location) {}
 
 // FaceReidentification
-dynamic_vino_lib::FaceReidentification::FaceReidentification(double match_thresh)
-: dynamic_vino_lib::BaseInference()
+dynamic_vino_lib::FaceReidentification::FaceReidentification(
+  double match_thresh, std::shared_ptr<GalleryIndex> gallery_index, int gallery_size,
+  const std::string & shared_gallery)
+: SlotSelectingInference()
 {
-  face_tracker_ = std::make_shared<dynamic_vino_lib::Tracker>(1000, match_thresh, 0.3);
+  if (!shared_gallery.empty()) {
+    face_tracker_ = dynamic_vino_lib::Tracker::getShared(
+      shared_gallery, gallery_size, match_thresh, 0.3, gallery_index);
+  } else {
+    face_tracker_ = std::make_shared<dynamic_vino_lib::Tracker>(
+      gallery_size, match_thresh, 0.3, gallery_index);
+  }
 }
 
 dynamic_vino_lib::FaceReidentification::~FaceReidentification() = default;
@@ -50,8 +59,17 @@ bool dynamic_vino_lib::FaceReidentification::enqueue(
   if (getEnqueuedNum() == 0) {
     results_.clear();
   }
+  cv::Mat face = frame;
+  auto iter = std::find_if(landmarks_.begin(), landmarks_.end(),
+      [&input_frame_loc](const std::pair<cv::Rect, std::vector<cv::Point>> & landmarks) {
+        return landmarks.first == input_frame_loc;
+      });
+  if (iter != landmarks_.end()) {
+    face = alignFace(frame, input_frame_loc, iter->second);
+    landmarks_.erase(iter);
+  }
   if (!dynamic_vino_lib::BaseInference::enqueue<u_int8_t>(
-      frame, input_frame_loc, 1, 0, valid_model_->getInputName()))
+      face, input_frame_loc, 1, getEnqueuedNum(), valid_model_->getInputName()))
   {
     return false;
   }
@@ -70,14 +88,16 @@ bool dynamic_vino_lib::FaceReidentification::fetchResults()
   bool can_fetch = dynamic_vino_lib::BaseInference::fetchResults();
   if (!can_fetch) {return false;}
   bool found_result = false;
-  InferenceEngine::InferRequest::Ptr request = getEngine()->getRequest();
+  auto engine = getEngine();
   std::string output = valid_model_->getOutputName();
-  const float * output_values = request->GetBlob(output)->buffer().as<float *>();
-  int result_length = request->GetBlob(output)->getTensorDesc().getDims()[1];
+  const Engines::OutputBinding & binding = engine->getOutputBinding(output);
+  const float * output_values = binding.blob->cbuffer().as<const float *>();
+  int result_length = static_cast<int>(binding.dims[1]);
+  cv::Mat new_faces(
+    getResultsLength(), result_length, CV_32F, const_cast<float *>(output_values));
+  std::vector<int> face_ids = face_tracker_->processNewTracks(new_faces);
   for (int i = 0; i < getResultsLength(); i++) {
-    std::vector<float> new_face = std::vector<float>(
-      output_values + result_length * i, output_values + result_length * (i + 1));
-    std::string face_id = "No." + std::to_string(face_tracker_->processNewTrack(new_face));
+    std::string face_id = "No." + std::to_string(face_ids[i]);
     results_[i].face_id_ = face_id;
     found_result = true;
   }
@@ -101,12 +121,9 @@ const std::string dynamic_vino_lib::FaceReidentification::getName() const
   return valid_model_->getModelCategory();
 }
 
-void dynamic_vino_lib::FaceReidentification::observeOutput(
-  const std::shared_ptr<Outputs::BaseOutput> & output)
+dynamic_vino_lib::ResultView dynamic_vino_lib::FaceReidentification::getResultView() const
 {
-  if (output != nullptr) {
-    output->accept(results_);
-  }
+  return ResultView(results_);
 }
 
 const std::vector<cv::Rect> dynamic_vino_lib::FaceReidentification::getFilteredROIs(
@@ -117,8 +134,52 @@ const std::vector<cv::Rect> dynamic_vino_lib::FaceReidentification::getFilteredR
       "Filter conditions: " << filter_conditions << slog::endl;
   }
   std::vector<cv::Rect> filtered_rois;
-  for (auto res : results_) {
+  filtered_rois.reserve(results_.size());
+  for (auto & res : results_) {
     filtered_rois.push_back(res.getLocation());
   }
   return filtered_rois;
 }
+
+void dynamic_vino_lib::FaceReidentification::observeUpstream(const BaseInference & upstream)
+{
+  auto landmarks_detection = dynamic_cast<const LandmarksDetection *>(&upstream);
+  if (landmarks_detection == nullptr) {
+    return;
+  }
+  for (auto & result : landmarks_detection->getResults()) {
+    landmarks_.emplace_back(result.getLocation(), result.getLandmarks());
+  }
+  // the landmarks of faces which are never enqueued (e.g. out of the frame) expire
+  while (landmarks_.size() > 256) {
+    landmarks_.pop_front();
+  }
+}
+
+cv::Mat dynamic_vino_lib::FaceReidentification::alignFace(
+  const cv::Mat & face, const cv::Rect & roi, const std::vector<cv::Point> & landmarks)
+{
+  // eyes, nose tip and mouth corners of face-reidentification-retail-0095,
+  // relative to the face size
+  static const float reference[5][2] = {
+    {0.31556875f, 0.4615741f}, {0.68262291f, 0.4615741f}, {0.50026249f, 0.64094713f},
+    {0.34947187f, 0.8244664f}, {0.65343645f, 0.8246919f}};
+  if (landmarks.size() != 5 || face.empty()) {
+    return face;
+  }
+  // the crop starts at the ROI clipped into the frame
+  cv::Point origin(std::max(roi.x, 0), std::max(roi.y, 0));
+  std::vector<cv::Point2f> src;
+  std::vector<cv::Point2f> dst;
+  for (size_t i = 0; i < landmarks.size(); i++) {
+    src.emplace_back(landmarks[i] - origin);
+    dst.emplace_back(reference[i][0] * face.cols, reference[i][1] * face.rows);
+  }
+  cv::Mat transform = cv::estimateAffinePartial2D(src, dst);
+  if (transform.empty()) {
+    return face;
+  }
+  cv::Mat aligned;
+  cv::warpAffine(face, aligned, transform, face.size());
+  return aligned;
+}
@@ -0,0 +1,392 @@
+// Copyright (c) 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @brief An implementation file with implementation for the gallery indexes
+ * @file gallery_index.cpp
+ */
+#include <algorithm>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <utility>
+#include <vector>
+#include "dynamic_vino_lib/inferences/gallery_index.hpp"
+#include "dynamic_vino_lib/slog.hpp"
+#include "dynamic_vino_lib/utils/simd_kernels.hpp"
+
+namespace
+{
+/**< the float16 rows converted at once, 64KB of float32 features of 256 values >**/
+const int kFp16TileRows = 64;
+}  // namespace
+
+// FeatureList
+dynamic_vino_lib::FeatureList::FeatureList(FeaturePrecision precision)
+: precision_(precision) {}
+
+int dynamic_vino_lib::FeatureList::add(int id, const cv::Mat & feature)
+{
+  float scale;
+  features_.push_back(encode(feature, &scale));
+  scales_.push_back(scale);
+  ids_.push_back(id);
+  return static_cast<int>(ids_.size()) - 1;
+}
+
+void dynamic_vino_lib::FeatureList::update(int row, const cv::Mat & feature)
+{
+  encode(feature, &scales_[row]).copyTo(features_.row(row));
+}
+
+int dynamic_vino_lib::FeatureList::remove(int row)
+{
+  int last = static_cast<int>(ids_.size()) - 1;
+  int moved = -1;
+  if (row != last) {
+    features_.row(last).copyTo(features_.row(row));
+    ids_[row] = ids_[last];
+    scales_[row] = scales_[last];
+    moved = ids_[row];
+  }
+  features_.pop_back();
+  ids_.pop_back();
+  scales_.pop_back();
+  return moved;
+}
+
+cv::Mat dynamic_vino_lib::FeatureList::getFeature(int row) const
+{
+  cv::Mat feature;
+  features_.row(row).convertTo(feature, CV_32F, scales_[row]);
+  return feature;
+}
+
+cv::Mat dynamic_vino_lib::FeatureList::getFeatures() const
+{
+  if (precision_ == FeaturePrecision::FP32) {
+    return features_;
+  }
+  cv::Mat features;
+  features_.convertTo(features, CV_32F);
+  if (precision_ == FeaturePrecision::INT8) {
+    for (int i = 0; i < features.rows; i++) {
+      cv::Mat row = features.row(i);
+      row.convertTo(row, -1, scales_[i]);
+    }
+  }
+  return features;
+}
+
+cv::Mat dynamic_vino_lib::FeatureList::encode(const cv::Mat & feature, float * scale) const
+{
+  *scale = 1;
+  cv::Mat encoded;
+  switch (precision_) {
+    case FeaturePrecision::INT8:
+      {
+        // symmetric quantization, the largest value of the feature maps to 127
+        double max_value = cv::norm(feature, cv::NORM_INF);
+        if (max_value > 0) {
+          *scale = static_cast<float>(max_value / 127);
+        }
+        feature.convertTo(encoded, CV_8S, 1.0 / *scale);
+        return encoded;
+      }
+#if CV_VERSION_MAJOR >= 4
+    case FeaturePrecision::FP16:
+      feature.convertTo(encoded, CV_16F);
+      return encoded;
+#endif
+    default:
+      return feature;
+  }
+}
+
+cv::Mat dynamic_vino_lib::FeatureList::scoreInt8(const cv::Mat & queries) const
+{
+  std::vector<float> query_scales(queries.rows);
+  cv::Mat quantized;
+  for (int i = 0; i < queries.rows; i++) {
+    quantized.push_back(encode(queries.row(i), &query_scales[i]));
+  }
+  cv::Mat scores(queries.rows, features_.rows, CV_32F);
+  int size = features_.cols;
+  // the features are streamed once, each one is compared with all the queries
+  for (int r = 0; r < features_.rows; r++) {
+    const int8_t * feature = features_.ptr<int8_t>(r);
+    for (int q = 0; q < quantized.rows; q++) {
+      int32_t dot = dotProductInt8(feature, quantized.ptr<int8_t>(q), size);
+      scores.at<float>(q, r) = dot * scales_[r] * query_scales[q];
+    }
+  }
+  return scores;
+}
+
+cv::Mat dynamic_vino_lib::FeatureList::scoreFp16(const cv::Mat & queries) const
+{
+  cv::Mat scores(queries.rows, features_.rows, CV_32F);
+  cv::Mat tile;
+  cv::Mat tile_scores;
+  for (int begin = 0; begin < features_.rows; begin += kFp16TileRows) {
+    int end = std::min(begin + kFp16TileRows, features_.rows);
+    features_.rowRange(begin, end).convertTo(tile, CV_32F);
+    cv::gemm(queries, tile, 1.0, cv::noArray(), 0.0, tile_scores, cv::GEMM_2_T);
+    tile_scores.copyTo(scores.colRange(begin, end));
+  }
+  return scores;
+}
+
+void dynamic_vino_lib::FeatureList::search(
+  const cv::Mat & queries, const std::vector<int> & query_rows,
+  std::vector<int> & ids, std::vector<double> & similarities) const
+{
+  if (ids_.empty()) {
+    return;
+  }
+  cv::Mat matched = queries;
+  if (!query_rows.empty()) {
+    matched = cv::Mat();
+    for (auto row : query_rows) {
+      matched.push_back(queries.row(row));
+    }
+  }
+  cv::Mat scores;
+  if (precision_ == FeaturePrecision::INT8) {
+    scores = scoreInt8(matched);
+  } else if (precision_ == FeaturePrecision::FP16) {
+    scores = scoreFp16(matched);
+  } else {
+    // one GEMM of the queries against all the features (vectorized by OpenCV)
+    cv::gemm(matched, features_, 1.0, cv::noArray(), 0.0, scores, cv::GEMM_2_T);
+  }
+  for (int i = 0; i < scores.rows; i++) {
+    double max_similarity;
+    cv::Point max_loc;
+    cv::minMaxLoc(scores.row(i), nullptr, &max_similarity, nullptr, &max_loc);
+    int query = query_rows.empty() ? i : query_rows[i];
+    if (max_similarity > similarities[query]) {
+      similarities[query] = max_similarity;
+      ids[query] = ids_[max_loc.x];
+    }
+  }
+}
+
+// ExactGalleryIndex
+dynamic_vino_lib::ExactGalleryIndex::ExactGalleryIndex(FeaturePrecision precision)
+: GalleryIndex(precision),
+  list_(precision) {}
+
+void dynamic_vino_lib::ExactGalleryIndex::upsert(int id, const cv::Mat & feature)
+{
+  auto iter = rows_.find(id);
+  if (iter != rows_.end()) {
+    list_.update(iter->second, feature);
+    return;
+  }
+  rows_[id] = list_.add(id, feature);
+}
+
+void dynamic_vino_lib::ExactGalleryIndex::remove(int id)
+{
+  auto iter = rows_.find(id);
+  if (iter == rows_.end()) {
+    return;
+  }
+  int row = iter->second;
+  rows_.erase(iter);
+  int moved = list_.remove(row);
+  if (moved >= 0) {
+    rows_[moved] = row;
+  }
+}
+
+void dynamic_vino_lib::ExactGalleryIndex::search(
+  const cv::Mat & queries, std::vector<int> & ids, std::vector<double> & similarities)
+{
+  ids.assign(queries.rows, -1);
+  similarities.assign(queries.rows, 0);
+  list_.search(queries, std::vector<int>(), ids, similarities);
+}
+
+cv::Mat dynamic_vino_lib::ExactGalleryIndex::getFeature(int id) const
+{
+  auto iter = rows_.find(id);
+  if (iter == rows_.end()) {
+    return cv::Mat();
+  }
+  return list_.getFeature(iter->second);
+}
+
+void dynamic_vino_lib::ExactGalleryIndex::clear()
+{
+  list_ = FeatureList(precision_);
+  rows_.clear();
+}
+
+// IvfGalleryIndex
+dynamic_vino_lib::IvfGalleryIndex::IvfGalleryIndex(
+  int lists, int probes, FeaturePrecision precision)
+: GalleryIndex(precision),
+  lists_count_(std::max(1, lists)),
+  probes_(std::min(std::max(1, probes), std::max(1, lists))),
+  train_size_(static_cast<size_t>(std::max(1, lists)) * 16),
+  lists_(1, FeatureList(precision)) {}
+
+void dynamic_vino_lib::IvfGalleryIndex::upsert(int id, const cv::Mat & feature)
+{
+  remove(id);
+  int list = assign(feature);
+  int row = lists_[list].add(id, feature);
+  locations_[id] = std::make_pair(list, row);
+  if (centroids_.empty() && locations_.size() >= train_size_) {
+    train();
+  }
+}
+
+void dynamic_vino_lib::IvfGalleryIndex::remove(int id)
+{
+  auto iter = locations_.find(id);
+  if (iter == locations_.end()) {
+    return;
+  }
+  auto location = iter->second;
+  locations_.erase(iter);
+  int moved = lists_[location.first].remove(location.second);
+  if (moved >= 0) {
+    locations_[moved].second = location.second;
+  }
+}
+
+void dynamic_vino_lib::IvfGalleryIndex::search(
+  const cv::Mat & queries, std::vector<int> & ids, std::vector<double> & similarities)
+{
+  ids.assign(queries.rows, -1);
+  similarities.assign(queries.rows, 0);
+  if (centroids_.empty()) {
+    lists_[0].search(queries, std::vector<int>(), ids, similarities);
+    return;
+  }
+
+  // group the queries by the lists they probe, then search each list once
+  cv::Mat scores;
+  cv::gemm(queries, centroids_, 1.0, cv::noArray(), 0.0, scores, cv::GEMM_2_T);
+  std::vector<std::vector<int>> probed(lists_count_);
+  std::vector<int> order(lists_count_);
+  for (int i = 0; i < queries.rows; i++) {
+    const float * score = scores.ptr<float>(i);
+    std::iota(order.begin(), order.end(), 0);
+    std::partial_sort(order.begin(), order.begin() + probes_, order.end(),
+      [score](int a, int b) {return score[a] > score[b];});
+    for (int k = 0; k < probes_; k++) {
+      probed[order[k]].push_back(i);
+    }
+  }
+  for (int list = 0; list < lists_count_; list++) {
+    if (!probed[list].empty()) {
+      lists_[list].search(queries, probed[list], ids, similarities);
+    }
+  }
+}
+
+cv::Mat dynamic_vino_lib::IvfGalleryIndex::getFeature(int id) const
+{
+  auto iter = locations_.find(id);
+  if (iter == locations_.end()) {
+    return cv::Mat();
+  }
+  return lists_[iter->second.first].getFeature(iter->second.second);
+}
+
+void dynamic_vino_lib::IvfGalleryIndex::clear()
+{
+  centroids_.release();
+  lists_.assign(1, FeatureList(precision_));
+  locations_.clear();
+}
+
+size_t dynamic_vino_lib::IvfGalleryIndex::getMemoryBytes() const
+{
+  size_t bytes = centroids_.total() * centroids_.elemSize();
+  for (auto & list : lists_) {
+    bytes += list.getMemoryBytes();
+  }
+  return bytes + locations_.size() * sizeof(std::pair<const int, std::pair<int, int>>);
+}
+
+void dynamic_vino_lib::IvfGalleryIndex::train()
+{
+  FeatureList all = lists_[0];
+  cv::Mat features = all.getFeatures();
+  cv::Mat labels;
+  cv::kmeans(features, lists_count_, labels,
+    cv::TermCriteria(cv::TermCriteria::COUNT + cv::TermCriteria::EPS, 20, 1e-4),
+    1, cv::KMEANS_PP_CENTERS, centroids_);
+  // the features are compared by dot product, so are the centroids
+  for (int i = 0; i < centroids_.rows; i++) {
+    cv::Mat centroid = centroids_.row(i);
+    double norm = cv::norm(centroid, cv::NORM_L2);
+    if (norm > 0) {
+      centroid.convertTo(centroid, -1, 1.0 / norm);
+    }
+  }
+
+  lists_.assign(lists_count_, FeatureList(precision_));
+  locations_.clear();
+  for (size_t row = 0; row < all.size(); row++) {
+    cv::Mat feature = features.row(static_cast<int>(row));
+    int list = assign(feature);
+    int id = all.getIds()[row];
+    locations_[id] = std::make_pair(list, lists_[list].add(id, feature));
+  }
+  slog::info << "Gallery index trained with " << lists_count_ << " lists over " <<
+    all.size() << " tracks" << slog::endl;
+}
+
+int dynamic_vino_lib::IvfGalleryIndex::assign(const cv::Mat & feature) const
+{
+  if (centroids_.empty()) {
+    return 0;
+  }
+  cv::Mat scores;
+  cv::gemm(feature, centroids_, 1.0, cv::noArray(), 0.0, scores, cv::GEMM_2_T);
+  cv::Point max_loc;
+  cv::minMaxLoc(scores, nullptr, nullptr, nullptr, &max_loc);
+  return max_loc.x;
+}
+
+std::shared_ptr<dynamic_vino_lib::GalleryIndex> dynamic_vino_lib::createGalleryIndex(
+  const std::string & type, int lists, int probes, const std::string & precision)
+{
+  FeaturePrecision feature_precision = FeaturePrecision::FP32;
+  if (precision == "int8") {
+    feature_precision = FeaturePrecision::INT8;
+  } else if (precision == "fp16") {
+#if CV_VERSION_MAJOR >= 4
+    feature_precision = FeaturePrecision::FP16;
+#else
+    slog::warn << "fp16 gallery features need OpenCV 4, use fp32 instead." << slog::endl;
+#endif
+  } else if (precision != "fp32") {
+    slog::warn << "Unknown gallery precision " << precision << ", use fp32 instead." <<
+      slog::endl;
+  }
+  if (type == "ivf") {
+    return std::make_shared<IvfGalleryIndex>(lists, probes, feature_precision);
+  }
+  if (type != "exact") {
+    slog::warn << "Unknown gallery index " << type << ", use exact instead." << slog::endl;
+  }
+  return std::make_shared<ExactGalleryIndex>(feature_precision);
+}
@@ -32,7 +32,7 @@ dynamic_vino_lib::HeadPoseResult::HeadPoseResult(const cv::Rect & location)
 
 // Head Pose Detection
 dynamic_vino_lib::HeadPoseDetection::HeadPoseDetection()
-: dynamic_vino_lib::BaseInference()
+: SlotSelectingInference()
 {
 }
 
@@ -53,7 +53,7 @@ bool dynamic_vino_lib::HeadPoseDetection::enqueue(
     results_.clear();
   }
   bool succeed = dynamic_vino_lib::BaseInference::enqueue<uint8_t>(
-    frame, input_frame_loc, 1, getResultsLength(), valid_model_->getInputName());
+    frame, input_frame_loc, 1, getEnqueuedNum(), valid_model_->getInputName());
   if (!succeed) {
     return false;
   }
@@ -73,15 +73,15 @@ bool dynamic_vino_lib::HeadPoseDetection::fetchResults()
   if (!can_fetch) {
     return false;
   }
-  auto request = getEngine()->getRequest();
-  InferenceEngine::Blob::Ptr angle_r = request->GetBlob(valid_model_->getOutputOutputAngleR());
-  InferenceEngine::Blob::Ptr angle_p = request->GetBlob(valid_model_->getOutputOutputAngleP());
-  InferenceEngine::Blob::Ptr angle_y = request->GetBlob(valid_model_->getOutputOutputAngleY());
+  auto engine = getEngine();
+  InferenceEngine::Blob::CPtr angle_r = engine->getOutput(valid_model_->getOutputOutputAngleR());
+  InferenceEngine::Blob::CPtr angle_p = engine->getOutput(valid_model_->getOutputOutputAngleP());
+  InferenceEngine::Blob::CPtr angle_y = engine->getOutput(valid_model_->getOutputOutputAngleY());
 
   for (int i = 0; i < getResultsLength(); ++i) {
-    results_[i].angle_r_ = angle_r->buffer().as<float *>()[i];
-    results_[i].angle_p_ = angle_p->buffer().as<float *>()[i];
-    results_[i].angle_y_ = angle_y->buffer().as<float *>()[i];
+    results_[i].angle_r_ = angle_r->cbuffer().as<const float *>()[i];
+    results_[i].angle_p_ = angle_p->cbuffer().as<const float *>()[i];
+    results_[i].angle_y_ = angle_y->cbuffer().as<const float *>()[i];
   }
   return true;
 }
@@ -102,11 +102,27 @@ const std::string dynamic_vino_lib::HeadPoseDetection::getName() const
   return valid_model_->getModelCategory();
 }
 
-void dynamic_vino_lib::HeadPoseDetection::observeOutput(
-  const std::shared_ptr<Outputs::BaseOutput> & output)
+dynamic_vino_lib::ResultView dynamic_vino_lib::HeadPoseDetection::getResultView() const
 {
-  if (output != nullptr) {
-    output->accept(results_);
+  return ResultView(results_);
+}
+
+void dynamic_vino_lib::HeadPoseDetection::loadCachedResults(
+  const std::vector<cv::Rect> & rois, const std::vector<int64_t> & track_keys,
+  std::vector<size_t> & stale, bool any_age)
+{
+  cache_.load(getResultCachePolicy(any_age), rois, track_keys, cached_results_, stale);
+}
+
+dynamic_vino_lib::ResultView dynamic_vino_lib::HeadPoseDetection::getCachedResultView() const
+{
+  return cached_results_.empty() ? ResultView() : ResultView(cached_results_);
+}
+
+void dynamic_vino_lib::HeadPoseDetection::cacheResults(const std::vector<int64_t> & track_keys)
+{
+  for (size_t i = 0; i < results_.size() && i < track_keys.size(); i++) {
+    cache_.store(track_keys[i], results_[i], 1.0f);
   }
 }
 
@@ -118,7 +134,8 @@ const std::vector<cv::Rect> dynamic_vino_lib::HeadPoseDetection::getFilteredROIs
       "Filter conditions: " << filter_conditions << slog::endl;
   }
   std::vector<cv::Rect> filtered_rois;
-  for (auto res : results_) {
+  filtered_rois.reserve(results_.size());
+  for (auto & res : results_) {
     filtered_rois.push_back(res.getLocation());
   }
   return filtered_rois;
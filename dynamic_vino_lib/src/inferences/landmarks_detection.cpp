@@ -31,7 +31,7 @@ dynamic_vino_lib::LandmarksDetectionResult::LandmarksDetectionResult(
 
 // LandmarksDetection
 dynamic_vino_lib::LandmarksDetection::LandmarksDetection()
-: dynamic_vino_lib::BaseInference() {}
+: SlotSelectingInference() {}
 
 dynamic_vino_lib::LandmarksDetection::~LandmarksDetection() = default;
 void dynamic_vino_lib::LandmarksDetection::loadNetwork(
@@ -48,7 +48,7 @@ bool dynamic_vino_lib::LandmarksDetection::enqueue(
     results_.clear();
   }
   if (!dynamic_vino_lib::BaseInference::enqueue<u_int8_t>(
-      frame, input_frame_loc, 1, 0, valid_model_->getInputName()))
+      frame, input_frame_loc, 1, getEnqueuedNum(), valid_model_->getInputName()))
   {
     return false;
   }
@@ -67,10 +67,11 @@ bool dynamic_vino_lib::LandmarksDetection::fetchResults()
   bool can_fetch = dynamic_vino_lib::BaseInference::fetchResults();
   if (!can_fetch) {return false;}
   bool found_result = false;
-  InferenceEngine::InferRequest::Ptr request = getEngine()->getRequest();
+  auto engine = getEngine();
   std::string output = valid_model_->getOutputName();
-  const float * output_values = request->GetBlob(output)->buffer().as<float *>();
-  int result_length = request->GetBlob(output)->getTensorDesc().getDims()[1];
+  const Engines::OutputBinding & binding = engine->getOutputBinding(output);
+  const float * output_values = binding.blob->cbuffer().as<const float *>();
+  int result_length = static_cast<int>(binding.dims[1]);
   for (int i = 0; i < getResultsLength(); i++) {
     std::vector<float> coordinates = std::vector<float>(
       output_values + result_length * i, output_values + result_length * (i + 1));
@@ -103,12 +104,9 @@ const std::string dynamic_vino_lib::LandmarksDetection::getName() const
   return valid_model_->getModelCategory();
 }
 
-void dynamic_vino_lib::LandmarksDetection::observeOutput(
-  const std::shared_ptr<Outputs::BaseOutput> & output)
+dynamic_vino_lib::ResultView dynamic_vino_lib::LandmarksDetection::getResultView() const
 {
-  if (output != nullptr) {
-    output->accept(results_);
-  }
+  return ResultView(results_);
 }
 
 const std::vector<cv::Rect> dynamic_vino_lib::LandmarksDetection::getFilteredROIs(
@@ -119,7 +117,8 @@ const std::vector<cv::Rect> dynamic_vino_lib::LandmarksDetection::getFilteredROI
       "Filter conditions: " << filter_conditions << slog::endl;
   }
   std::vector<cv::Rect> filtered_rois;
-  for (auto res : results_) {
+  filtered_rois.reserve(results_.size());
+  for (auto & res : results_) {
     filtered_rois.push_back(res.getLocation());
   }
   return filtered_rois;
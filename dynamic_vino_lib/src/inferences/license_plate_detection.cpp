@@ -17,6 +17,7 @@
  * LicensePlateDetectionResult class
  * @file license_plate_detection.cpp
  */
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <vector>
@@ -31,7 +32,7 @@ dynamic_vino_lib::LicensePlateDetectionResult::LicensePlateDetectionResult(
 
 // LicensePlateDetection
 dynamic_vino_lib::LicensePlateDetection::LicensePlateDetection()
-: dynamic_vino_lib::BaseInference() {}
+: SlotSelectingInference() {}
 
 dynamic_vino_lib::LicensePlateDetection::~LicensePlateDetection() = default;
 void dynamic_vino_lib::LicensePlateDetection::loadNetwork(
@@ -39,32 +40,54 @@ void dynamic_vino_lib::LicensePlateDetection::loadNetwork(
 {
   valid_model_ = network;
   setMaxBatchSize(network->getMaxBatchSize());
+  // room for a province name and the characters of a plate
+  plates_.resize(network->getMaxBatchSize());
+  for (auto & plate : plates_) {
+    plate.reserve(32);
+  }
+}
+
+void dynamic_vino_lib::LicensePlateDetection::loadEngine(
+  std::shared_ptr<Engines::Engine> engine)
+{
+  dynamic_vino_lib::BaseInference::loadEngine(engine);
+  if (engine == nullptr) {
+    return;
+  }
+  for (int i = 0; i < engine->getRequestNum(); i++) {
+    engine->bindRequest(i);
+    fillSeqBlob(engine->getInput(valid_model_->getSeqInputName()));
+  }
+  engine->bindRequest(0);
 }
 
-void dynamic_vino_lib::LicensePlateDetection::fillSeqBlob()
+void dynamic_vino_lib::LicensePlateDetection::fillSeqBlob(
+  const InferenceEngine::Blob::Ptr & seq_blob)
 {
-  InferenceEngine::Blob::Ptr seq_blob = getEngine()->getRequest()->GetBlob(
-    valid_model_->getSeqInputName());
-  int max_sequence_size = seq_blob->getTensorDesc().getDims()[0];
+  size_t max_sequence_size = seq_blob->getTensorDesc().getDims()[0];
   // second input is sequence, which is some relic from the training
-  // it should have the leading 0.0f and rest 1.0f
+  // it should have the leading 0.0f and rest 1.0f, for each batch slot (T x N layout)
   float * blob_data = seq_blob->buffer().as<float *>();
-  blob_data[0] = 0.0f;
-  std::fill(blob_data + 1, blob_data + max_sequence_size, 1.0f);
+  size_t slots = std::max<size_t>(1, seq_blob->size() / max_sequence_size);
+  std::fill(blob_data, blob_data + slots, 0.0f);
+  std::fill(blob_data + slots, blob_data + seq_blob->size(), 1.0f);
 }
 
 bool dynamic_vino_lib::LicensePlateDetection::enqueue(
   const cv::Mat & frame, const cv::Rect & input_frame_loc)
 {
   if (getEnqueuedNum() == 0) {
+    // take back the strings of the previous batch, they keep their capacity
+    for (size_t i = 0; i < results_.size() && i < plates_.size(); i++) {
+      plates_[i].swap(results_[i].license_);
+    }
     results_.clear();
   }
   if (!dynamic_vino_lib::BaseInference::enqueue<u_int8_t>(
-      frame, input_frame_loc, 1, 0, valid_model_->getInputName()))
+      frame, input_frame_loc, 1, getEnqueuedNum(), valid_model_->getInputName()))
   {
     return false;
   }
-  fillSeqBlob();
   Result r(input_frame_loc);
   results_.emplace_back(r);
   return true;
@@ -79,23 +102,30 @@ bool dynamic_vino_lib::LicensePlateDetection::fetchResults()
 {
   bool can_fetch = dynamic_vino_lib::BaseInference::fetchResults();
   if (!can_fetch) {return false;}
-  bool found_result = false;
-  InferenceEngine::InferRequest::Ptr request = getEngine()->getRequest();
+  auto engine = getEngine();
   std::string output = valid_model_->getOutputName();
-  const float * output_values = request->GetBlob(output)->buffer().as<float *>();
-  for (int i = 0; i < getResultsLength(); i++) {
-    std::string license = "";
-    int max_size = valid_model_->getMaxSequenceSize();
+  const float * output_values = engine->getOutput(output)->cbuffer().as<const float *>();
+  const int max_size = valid_model_->getMaxSequenceSize();
+  const int labels = static_cast<int>(licenses_.size());
+  if (plates_.size() < results_.size()) {
+    plates_.resize(results_.size());
+  }
+  // the output holds the label indexes of each plate, -1 ends a plate
+  for (size_t i = 0; i < results_.size(); i++) {
+    const float * sequence = output_values + i * max_size;
+    auto & plate = plates_[i];
+    plate.clear();
     for (int j = 0; j < max_size; j++) {
-      if (output_values[i * max_size + j] == -1) {
+      int label = static_cast<int>(sequence[j]);
+      if (label < 0) {
         break;
       }
-      license += licenses_[output_values[i * max_size + j]];
+      if (label < labels) {
+        plate.append(licenses_[label]);
+      }
     }
-    results_[i].license_ = license;
-    found_result = true;
+    results_[i].license_.swap(plate);
   }
-  if (!found_result) {results_.clear();}
   return true;
 }
 
@@ -115,12 +145,9 @@ const std::string dynamic_vino_lib::LicensePlateDetection::getName() const
   return valid_model_->getModelCategory();
 }
 
-void dynamic_vino_lib::LicensePlateDetection::observeOutput(
-  const std::shared_ptr<Outputs::BaseOutput> & output)
+dynamic_vino_lib::ResultView dynamic_vino_lib::LicensePlateDetection::getResultView() const
 {
-  if (output != nullptr) {
-    output->accept(results_);
-  }
+  return ResultView(results_);
 }
 
 const std::vector<cv::Rect> dynamic_vino_lib::LicensePlateDetection::getFilteredROIs(
@@ -131,7 +158,8 @@ const std::vector<cv::Rect> dynamic_vino_lib::LicensePlateDetection::getFiltered
       "Filter conditions: " << filter_conditions << slog::endl;
   }
   std::vector<cv::Rect> filtered_rois;
-  for (auto res : results_) {
+  filtered_rois.reserve(results_.size());
+  for (auto & res : results_) {
     filtered_rois.push_back(res.getLocation());
   }
   return filtered_rois;
@@ -17,7 +17,9 @@
  * ObjectDetectionResult class
  * @file object_detection.cpp
  */
+#include <algorithm>
 #include <memory>
+#include <numeric>
 #include <string>
 #include <vector>
 #include <utility>
@@ -25,6 +27,7 @@
 #include "dynamic_vino_lib/inferences/object_detection.hpp"
 #include "dynamic_vino_lib/outputs/base_output.hpp"
 #include "dynamic_vino_lib/slog.hpp"
+#include "dynamic_vino_lib/utils/scratch_arena.hpp"
 
 // ObjectDetectionResult
 dynamic_vino_lib::ObjectDetectionResult::ObjectDetectionResult(const cv::Rect & location)
@@ -49,6 +52,8 @@ void dynamic_vino_lib::ObjectDetection::loadNetwork(
   std::shared_ptr<Models::ObjectDetectionModel> network)
 {
   valid_model_ = network;
+  detections_.setLabels(&network->getLabels());
+  merged_detections_.setLabels(&network->getLabels());
 
   setMaxBatchSize(network->getMaxBatchSize());
 }
@@ -66,7 +71,22 @@ bool dynamic_vino_lib::ObjectDetection::enqueue(
     return false;
   }
 
-  if (!valid_model_->enqueue(getEngine(), frame, input_frame_loc)) {
+  size_t request = static_cast<size_t>(getEngine()->getBoundRequest());
+  if (enqueued_frames_ == 0 && request < region_offsets_.size()) {
+    region_offsets_[request].clear();
+  }
+  if (tile_size_ > 0 && enqueued_frames_ == 0) {
+    if (tile_offsets_.size() <= request) {
+      tile_offsets_.resize(request + 1);
+    }
+    tile_offsets_[request].clear();
+    auto tiles = computeTiles(frame.size());
+    if (!tiles.empty() && !getEngine()->isPluginPreprocessEnabled()) {
+      return enqueueTiles(frame, input_frame_loc, tiles);
+    }
+  }
+
+  if (!valid_model_->enqueue(getEngine(), frame, input_frame_loc, enqueued_frames_)) {
     return false;
   }
 
@@ -85,10 +105,295 @@ bool dynamic_vino_lib::ObjectDetection::fetchResults()
     return false;
   }
 
+  detections_.clear();
+  bool fetched = (valid_model_ != nullptr) && valid_model_->fetchResults(
+    getEngine(), detections_, show_output_thresh_, enable_roi_constraint_);
+  size_t request = static_cast<size_t>(getEngine()->getBoundRequest());
+  if (request < tile_offsets_.size() && !tile_offsets_[request].empty()) {
+    mergeTiles(tile_offsets_[request]);
+  }
+  if (request < region_offsets_.size() && !region_offsets_[request].empty()) {
+    auto & offsets = region_offsets_[request];
+    for (size_t i = 0; i < detections_.size(); i++) {
+      size_t slot = static_cast<size_t>(detections_.getBatchIndices()[i]);
+      if (slot < offsets.size()) {
+        detections_.shift(i, offsets[slot]);
+      }
+    }
+  }
+
+  // the results refer to the labels of the arena, so no label is copied
+  batch_results_.clear();
+  for (size_t i = 0; i < detections_.size(); i++) {
+    int label_id = detections_.getLabelIds()[i];
+    batch_results_.emplace_back(detections_.getLocations()[i]);
+    auto & result = batch_results_.back();
+    result.setLabel(label_id, &detections_.getLabel(label_id));
+    result.setConfidence(detections_.getConfidences()[i]);
+    result.setBatchIndex(detections_.getBatchIndices()[i]);
+  }
+  results_ = batch_results_;
+  return fetched;
+}
+
+bool dynamic_vino_lib::ObjectDetection::isFrameBatchable() const
+{
+  // the slots of a tiled request hold the tiles of a single frame
+  return valid_model_ != nullptr && valid_model_->supportsFrameBatching() && tile_size_ == 0;
+}
+
+void dynamic_vino_lib::ObjectDetection::selectBatchSlots(int first, int count)
+{
+  if (first < 0) {
+    results_ = batch_results_;
+    return;
+  }
+  results_.clear();
+  for (auto & result : batch_results_) {
+    if (result.getBatchIndex() >= first && result.getBatchIndex() < first + count) {
+      results_.push_back(result);
+    }
+  }
+}
+
+bool dynamic_vino_lib::ObjectDetection::enqueueRegion(
+  const cv::Mat & frame, const cv::Rect & region)
+{
+  cv::Rect clipped = region & cv::Rect(0, 0, frame.cols, frame.rows);
+  if (clipped.area() <= 0 || getEngine() == nullptr) {
+    return false;
+  }
+  int slot = enqueued_frames_;
+  if (!enqueue(frame(clipped), clipped)) {
+    return false;
+  }
+  size_t request = static_cast<size_t>(getEngine()->getBoundRequest());
+  if (region_offsets_.size() <= request) {
+    region_offsets_.resize(request + 1);
+  }
+  // the slots of a whole frame keep a null offset
+  auto & offsets = region_offsets_[request];
+  offsets.resize(slot + 1);
+  offsets[slot] = clipped.tl();
+  return true;
+}
+
+bool dynamic_vino_lib::ObjectDetection::supportsNV12() const
+{
+  return valid_model_ != nullptr && valid_model_->supportsNV12() && tile_size_ == 0;
+}
+
+bool dynamic_vino_lib::ObjectDetection::enqueueNV12(const cv::Mat & nv12)
+{
+  if (valid_model_ == nullptr || getEngine() == nullptr) {
+    return false;
+  }
+  if (enqueued_frames_ >= valid_model_->getMaxBatchSize()) {
+    slog::warn << "Number of " << getName() << "input more than maximum(" <<
+      max_batch_size_ << ") processed by inference" << slog::endl;
+    return false;
+  }
+  size_t request = static_cast<size_t>(getEngine()->getBoundRequest());
+  if (enqueued_frames_ == 0 && request < region_offsets_.size()) {
+    region_offsets_[request].clear();
+  }
+  if (!valid_model_->enqueueNV12(getEngine(), nv12, enqueued_frames_)) {
+    return false;
+  }
+  enqueued_frames_ += 1;
+  return true;
+}
+
+void dynamic_vino_lib::ObjectDetection::enableTiling(
+  int tile_size, float overlap, float nms_threshold)
+{
+  if (valid_model_ == nullptr || !valid_model_->supportsFrameBatching() ||
+    getMaxBatchSize() < 2)
+  {
+    slog::warn << "Tiling needs a model taking several frames per batch, " <<
+      "frames are detected as a whole." << slog::endl;
+    return;
+  }
+  tile_size_ = std::max(32, tile_size);
+  tile_overlap_ = std::min(std::max(overlap, 0.0f), 0.9f);
+  tile_nms_threshold_ = nms_threshold;
+}
+
+std::vector<cv::Rect> dynamic_vino_lib::ObjectDetection::computeTiles(
+  const cv::Size & frame_size) const
+{
+  std::vector<cv::Rect> tiles;
+  // the first slot holds the whole frame, for the objects larger than a tile
+  int slots = getMaxBatchSize() - 1;
+  int tile = tile_size_;
+  int cols = 1;
+  int rows = 1;
+  int stride = tile;
+  while (tile < frame_size.width || tile < frame_size.height) {
+    stride = std::max(1, static_cast<int>(tile * (1 - tile_overlap_)));
+    cols = frame_size.width <= tile ? 1 : (frame_size.width - tile + stride - 1) / stride + 1;
+    rows = frame_size.height <= tile ? 1 : (frame_size.height - tile + stride - 1) / stride + 1;
+    if (cols * rows <= slots) {
+      break;
+    }
+    tile = tile * 5 / 4 + 1;
+  }
+  if (tile >= frame_size.width && tile >= frame_size.height) {
+    return tiles;
+  }
+  int width = std::min(tile, frame_size.width);
+  int height = std::min(tile, frame_size.height);
+  for (int row = 0; row < rows; row++) {
+    for (int col = 0; col < cols; col++) {
+      // the last row and column are aligned on the frame border
+      int x = std::min(col * stride, frame_size.width - width);
+      int y = std::min(row * stride, frame_size.height - height);
+      tiles.emplace_back(x, y, width, height);
+    }
+  }
+  return tiles;
+}
+
+bool dynamic_vino_lib::ObjectDetection::enqueueTiles(
+  const cv::Mat & frame, const cv::Rect & input_frame_loc, const std::vector<cv::Rect> & tiles)
+{
+  auto engine = getEngine();
+  auto & offsets = tile_offsets_[engine->getBoundRequest()];
+  if (!valid_model_->enqueue(engine, frame, input_frame_loc, 0)) {
+    return false;
+  }
+  offsets.emplace_back(0, 0);
+  // the tiles are inferred once per frame, not worth caching
+  auto cache = engine->getPreprocessCache();
+  engine->setPreprocessCache(nullptr);
+  for (auto & tile : tiles) {
+    if (!valid_model_->enqueue(engine, frame(tile), tile, static_cast<int>(offsets.size()))) {
+      break;
+    }
+    offsets.push_back(tile.tl());
+  }
+  engine->setPreprocessCache(cache);
+  enqueued_frames_ = static_cast<int>(offsets.size());
+  return true;
+}
+
+void dynamic_vino_lib::ObjectDetection::mergeTiles(const std::vector<cv::Point> & offsets)
+{
+  const size_t count = detections_.size();
+  auto & confidences = detections_.getConfidences();
+  auto & label_ids = detections_.getLabelIds();
+  ScratchArena::Scope scratch;
+  ScratchVector<cv::Rect> boxes(count);
+  for (size_t i = 0; i < count; i++) {
+    size_t slot = static_cast<size_t>(detections_.getBatchIndices()[i]);
+    boxes[i] = detections_.getLocations()[i];
+    if (slot < offsets.size()) {
+      boxes[i] += offsets[slot];
+    }
+  }
+  ScratchVector<size_t> order(count);
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(),
+    [&confidences](size_t a, size_t b) {return confidences[a] > confidences[b];});
+
+  // a box cut by a tile border is mostly inside the complete one, so the overlap
+  // is measured on the smaller box rather than by IoU
+  ScratchVector<bool> suppressed(count, false);
+  merged_detections_.clear();
+  for (size_t k = 0; k < count; k++) {
+    size_t i = order[k];
+    if (suppressed[i]) {
+      continue;
+    }
+    merged_detections_.add(boxes[i], confidences[i], label_ids[i], 0);
+    for (size_t m = k + 1; m < count; m++) {
+      size_t j = order[m];
+      if (suppressed[j] || label_ids[j] != label_ids[i]) {
+        continue;
+      }
+      float smaller = static_cast<float>(std::min(boxes[i].area(), boxes[j].area()));
+      if (smaller > 0 && (boxes[i] & boxes[j]).area() / smaller > tile_nms_threshold_) {
+        suppressed[j] = true;
+      }
+    }
+  }
+  std::swap(detections_, merged_detections_);
+}
+
+void dynamic_vino_lib::ObjectDetection::enableTracking(
+  int detect_interval, float iou_threshold, bool optical_flow)
+{
+  tracking_ = true;
+  detect_interval_ = std::max(1, detect_interval);
+  track_iou_ = iou_threshold;
+  optical_flow_ = optical_flow;
+}
+
+void dynamic_vino_lib::ObjectDetection::trackResults(int input_id, const cv::Mat & frame)
+{
+  if (!tracking_) {
+    last_results_[input_id] = results_;
+    return;
+  }
+  auto iter = tracked_inputs_.find(input_id);
+  if (iter == tracked_inputs_.end()) {
+    TrackedInput input{ObjectTracker(track_iou_, 2, optical_flow_)};
+    iter = tracked_inputs_.emplace(input_id, input).first;
+  }
+  std::vector<cv::Rect> boxes;
+  std::vector<int> label_ids;
+  std::vector<float> confidences;
+  for (auto & result : results_) {
+    boxes.push_back(result.getLocation());
+    label_ids.push_back(result.getLabelId());
+    confidences.push_back(result.getConfidence());
+  }
+  std::vector<int> track_ages;
+  auto track_ids = iter->second.tracker.update(
+    boxes, label_ids, confidences, frame, &track_ages);
+  for (size_t i = 0; i < results_.size(); i++) {
+    results_[i].setTrackId(track_ids[i]);
+    results_[i].setTrackAge(track_ages[i]);
+  }
+  last_results_[input_id] = results_;
+}
+
+bool dynamic_vino_lib::ObjectDetection::propagateResults(int input_id, const cv::Mat & frame)
+{
+  if (!tracking_) {
+    return false;
+  }
+  auto iter = tracked_inputs_.find(input_id);
+  if (iter == tracked_inputs_.end()) {
+    // the first frame of an input is always detected
+    TrackedInput input{ObjectTracker(track_iou_, 2, optical_flow_)};
+    iter = tracked_inputs_.emplace(input_id, input).first;
+  }
+  if (iter->second.frames++ % detect_interval_ == 0) {
+    return false;
+  }
+  iter->second.tracker.predict(frame);
   results_.clear();
+  for (auto track : iter->second.tracker.getActiveTracks()) {
+    Result result(track->box);
+    result.setLabel(track->label_id, &detections_.getLabel(track->label_id));
+    result.setConfidence(track->confidence);
+    result.setTrackId(track->id);
+    result.setTrackAge(track->age);
+    results_.push_back(result);
+  }
+  last_results_[input_id] = results_;
+  return true;
+}
 
-  return (valid_model_ != nullptr) && valid_model_->fetchResults(
-    getEngine(), results_, show_output_thresh_, enable_roi_constraint_);
+bool dynamic_vino_lib::ObjectDetection::reuseResults(int input_id)
+{
+  auto iter = last_results_.find(input_id);
+  if (iter == last_results_.end()) {
+    return false;
+  }
+  results_ = iter->second;
+  return true;
 }
 
 int dynamic_vino_lib::ObjectDetection::getResultsLength() const
@@ -107,27 +412,47 @@ const std::string dynamic_vino_lib::ObjectDetection::getName() const
   return valid_model_->getModelCategory();
 }
 
-void dynamic_vino_lib::ObjectDetection::observeOutput(
-  const std::shared_ptr<Outputs::BaseOutput> & output)
+dynamic_vino_lib::ResultView dynamic_vino_lib::ObjectDetection::getResultView() const
 {
-  if (output != nullptr) {
-    output->accept(results_);
-  }
+  return ResultView(results_);
 }
 
 const std::vector<cv::Rect> dynamic_vino_lib::ObjectDetection::getFilteredROIs(
   const std::string filter_conditions) const
 {
-  if (!result_filter_->isValidFilterConditions(filter_conditions)) {
-    std::vector<cv::Rect> filtered_rois;
-    for (auto result : results_) {
-      filtered_rois.push_back(result.getLocation());
-    }
-    return filtered_rois;
+  std::vector<cv::Rect> filtered_rois;
+  fillFilteredROIs(filter_conditions, filtered_rois);
+  return filtered_rois;
+}
+
+void dynamic_vino_lib::ObjectDetection::fillFilteredROIs(
+  const std::string & filter_conditions, std::vector<cv::Rect> & rois) const
+{
+  result_filter_->getFilteredLocations(results_, filter_conditions, rois);
+}
+
+void dynamic_vino_lib::ObjectDetection::fillFilteredTrackIds(
+  const std::string & filter_conditions, std::vector<int> & track_ids) const
+{
+  if (!tracking_) {
+    track_ids.clear();
+    return;
+  }
+  result_filter_->getFilteredTrackIds(results_, filter_conditions, track_ids);
+}
+
+void dynamic_vino_lib::ObjectDetection::fillFilteredRoiScores(
+  const std::string & filter_conditions, std::vector<RoiScore> & scores) const
+{
+  result_filter_->getFilteredScores(results_, filter_conditions, scores);
+}
+
+void dynamic_vino_lib::ObjectDetection::compileFilterConditions(
+  const std::string & filter_conditions)
+{
+  if (result_filter_->isValidFilterConditions(filter_conditions)) {
+    result_filter_->getPredicate(filter_conditions);
   }
-  result_filter_->acceptResults(results_);
-  result_filter_->acceptFilterConditions(filter_conditions);
-  return result_filter_->getFilteredLocations();
 }
 
 
@@ -138,19 +463,61 @@ void dynamic_vino_lib::ObjectDetectionResultFilter::init()
 {
   key_to_function_.insert(std::make_pair("label", isValidLabel));
   key_to_function_.insert(std::make_pair("confidence", isValidConfidence));
+
+  key_to_builder_["label"] =
+    [](const std::string & op, const std::string & target) -> Predicate<Result> {
+      if (!op.compare("==")) {
+        return [target](const Result & result) {return result.getLabel() == target;};
+      } else if (!op.compare("!=")) {
+        return [target](const Result & result) {return result.getLabel() != target;};
+      }
+      slog::err << "Invalid operator " << op << " for label comparsion" << slog::endl;
+      return [](const Result &) {return false;};
+    };
+  key_to_builder_["confidence"] =
+    [](const std::string & op, const std::string & target) -> Predicate<Result> {
+      float value = stringToFloat(target);
+      if (!op.compare("<=")) {
+        return [value](const Result & result) {return result.getConfidence() <= value;};
+      } else if (!op.compare(">=")) {
+        return [value](const Result & result) {return result.getConfidence() >= value;};
+      } else if (!op.compare("<")) {
+        return [value](const Result & result) {return result.getConfidence() < value;};
+      } else if (!op.compare(">")) {
+        return [value](const Result & result) {return result.getConfidence() > value;};
+      }
+      slog::err << "Invalid operator " << op << " for confidence comparsion" << slog::endl;
+      return [](const Result &) {return false;};
+    };
+}
+
+const dynamic_vino_lib::BaseFilter::Predicate<dynamic_vino_lib::ObjectDetectionResult> &
+dynamic_vino_lib::ObjectDetectionResultFilter::getPredicate(
+  const std::string & filter_conditions)
+{
+  std::lock_guard<std::mutex> lk(predicates_mutex_);
+  auto it = predicates_.find(filter_conditions);
+  if (it == predicates_.end()) {
+    it = predicates_.emplace(
+      filter_conditions, compile<Result>(filter_conditions, key_to_builder_)).first;
+  }
+  return it->second;
 }
 
 void dynamic_vino_lib::ObjectDetectionResultFilter::acceptResults(
   const std::vector<Result> & results)
 {
-  results_ = results;
+  results_ = &results;
 }
 
 std::vector<cv::Rect>
 dynamic_vino_lib::ObjectDetectionResultFilter::getFilteredLocations()
 {
   std::vector<cv::Rect> locations;
-  for (auto result : results_) {
+  if (results_ == nullptr) {
+    return locations;
+  }
+  for (auto & result : *results_) {
     if (isValidResult(result)) {
       locations.push_back(result.getLocation());
     }
@@ -158,6 +525,69 @@ dynamic_vino_lib::ObjectDetectionResultFilter::getFilteredLocations()
   return locations;
 }
 
+void dynamic_vino_lib::ObjectDetectionResultFilter::getFilteredLocations(
+  const std::vector<Result> & results, const std::string & filter_conditions,
+  std::vector<cv::Rect> & locations)
+{
+  locations.clear();
+  if (filter_conditions.empty()) {
+    for (auto & result : results) {
+      locations.push_back(result.getLocation());
+    }
+    return;
+  }
+  auto & predicate = getPredicate(filter_conditions);
+  for (auto & result : results) {
+    if (predicate(result)) {
+      locations.push_back(result.getLocation());
+    }
+  }
+}
+
+void dynamic_vino_lib::ObjectDetectionResultFilter::getFilteredTrackIds(
+  const std::vector<Result> & results, const std::string & filter_conditions,
+  std::vector<int> & track_ids)
+{
+  track_ids.clear();
+  if (filter_conditions.empty()) {
+    for (auto & result : results) {
+      track_ids.push_back(result.getTrackId());
+    }
+    return;
+  }
+  auto & predicate = getPredicate(filter_conditions);
+  for (auto & result : results) {
+    if (predicate(result)) {
+      track_ids.push_back(result.getTrackId());
+    }
+  }
+}
+
+void dynamic_vino_lib::ObjectDetectionResultFilter::getFilteredScores(
+  const std::vector<Result> & results, const std::string & filter_conditions,
+  std::vector<RoiScore> & scores)
+{
+  scores.clear();
+  auto score = [](const Result & result) {
+      RoiScore roi_score;
+      roi_score.confidence = result.getConfidence();
+      roi_score.track_age = result.getTrackAge();
+      return roi_score;
+    };
+  if (filter_conditions.empty()) {
+    for (auto & result : results) {
+      scores.push_back(score(result));
+    }
+    return;
+  }
+  auto & predicate = getPredicate(filter_conditions);
+  for (auto & result : results) {
+    if (predicate(result)) {
+      scores.push_back(score(result));
+    }
+  }
+}
+
 bool dynamic_vino_lib::ObjectDetectionResultFilter::isValidLabel(
   const Result & result, const std::string & op, const std::string & target)
 {
@@ -26,6 +26,7 @@
 #include "dynamic_vino_lib/inferences/object_segmentation.hpp"
 #include "dynamic_vino_lib/outputs/base_output.hpp"
 #include "dynamic_vino_lib/slog.hpp"
+#include "dynamic_vino_lib/utils/scratch_arena.hpp"
 
 // ObjectSegmentationResult
 dynamic_vino_lib::ObjectSegmentationResult::ObjectSegmentationResult(const cv::Rect &location)
@@ -33,10 +34,75 @@ dynamic_vino_lib::ObjectSegmentationResult::ObjectSegmentationResult(const cv::R
 {
 }
 
+cv::Mat dynamic_vino_lib::ObjectSegmentationResult::getMask(const cv::Size & size) const
+{
+  if (palette_ == nullptr || class_map_.empty() || size.area() == 0) {
+    return cv::Mat();
+  }
+  if (!mask_.empty() && mask_.size() == size) {
+    return mask_;
+  }
+  mask_ = colorize(class_map_, confident_, *palette_, size);
+  return mask_;
+}
+
+cv::Mat dynamic_vino_lib::ObjectSegmentationResult::colorize(
+  const cv::Mat & class_map, const cv::Mat & confident_map, const cv::Mat & palette,
+  const cv::Size & size)
+{
+  // upsample the class ids rather than the colors, and only then colorize
+  ScratchArena::Scope scratch;
+  cv::Mat ids = class_map;
+  cv::Mat confident = confident_map;
+  if (size != class_map.size()) {
+    ids = scratch.getMat(size, class_map.type());
+    cv::resize(class_map, ids, size, 0, 0, cv::INTER_NEAREST);
+    if (!confident_map.empty()) {
+      confident = scratch.getMat(size, confident_map.type());
+      cv::resize(confident_map, confident, size, 0, 0, cv::INTER_NEAREST);
+    }
+  }
+  // the mask is kept by the result, only the temporaries come from the arena
+  cv::Mat colored_mask;
+  if (ids.depth() == CV_8U) {
+    cv::Mat ids_3c = scratch.getMat(size, CV_8UC3);
+    const cv::Mat planes[] = {ids, ids, ids};
+    cv::merge(planes, 3, ids_3c);
+    cv::LUT(ids_3c, palette, colored_mask);
+  } else {
+    colored_mask.create(size, CV_8UC3);
+    const cv::Vec3b * colors = palette.ptr<cv::Vec3b>(0);
+    for (int rowId = 0; rowId < size.height; ++rowId) {
+      const uint16_t * row_ids = ids.ptr<uint16_t>(rowId);
+      cv::Vec3b * row_colors = colored_mask.ptr<cv::Vec3b>(rowId);
+      for (int colId = 0; colId < size.width; ++colId) {
+        row_colors[colId] = colors[row_ids[colId] % 256];
+      }
+    }
+  }
+  if (!confident.empty()) {
+    cv::Mat unconfident = scratch.getMat(size, CV_8U);
+    cv::compare(confident, 0, unconfident, cv::CMP_EQ);
+    colored_mask.setTo(cv::Scalar(0, 0, 0), unconfident);
+  }
+  return colored_mask;
+}
+
 // ObjectSegmentation
 dynamic_vino_lib::ObjectSegmentation::ObjectSegmentation(double show_output_thresh)
     : show_output_thresh_(show_output_thresh), dynamic_vino_lib::BaseInference()
 {
+  buildPalette();
+}
+
+void dynamic_vino_lib::ObjectSegmentation::buildPalette()
+{
+  std::mt19937 rng(static_cast<unsigned>(colors_.size()));
+  std::uniform_int_distribution<int> distr(0, 255);
+  while (colors_.size() < 256) {
+    colors_.emplace_back(distr(rng), distr(rng), distr(rng));
+  }
+  palette_ = std::make_shared<const cv::Mat>(cv::Mat(1, 256, CV_8UC3, colors_.data()).clone());
 }
 
 dynamic_vino_lib::ObjectSegmentation::~ObjectSegmentation() = default;
@@ -100,6 +166,9 @@ bool dynamic_vino_lib::ObjectSegmentation::enqueue(
   {
     return false;
   }
+  // the boxes of the instances are relative to the enqueued frame
+  frame_size_ = frame.size();
+  frame_loc_ = input_frame_loc;
 
   enqueued_frames_ += 1;
   return true;
@@ -119,79 +188,155 @@ bool dynamic_vino_lib::ObjectSegmentation::fetchResults()
   }
   bool found_result = false;
   results_.clear();
-  InferenceEngine::InferRequest::Ptr request = getEngine()->getRequest();
-  slog::debug << "Analyzing Detection results..." << slog::endl;
+  auto engine = getEngine();
+  SLOG_DEBUG << "Analyzing Detection results..." << slog::endl;
   std::string detection_output = valid_model_->getOutputName("detection");
   std::string mask_output = valid_model_->getOutputName("masks");
+  if (valid_model_->isInstanceSegmentation()) {
+    fetchInstances(engine->getOutputBinding(detection_output),
+      engine->getOutputBinding(mask_output));
+    return true;
+  }
+
+  const Engines::OutputBinding & masks = engine->getOutputBinding(mask_output);
+  const auto masks_data = masks.blob->cbuffer().as<const float *>();
+  const size_t output_w = masks.dims.at(3);
+  const size_t output_h = masks.dims.at(2);
+  const size_t output_des = masks.dims.at(1);
+  const size_t output_extra = masks.dims.at(0);
 
-  const InferenceEngine::Blob::Ptr do_blob = request->GetBlob(detection_output.c_str());
-  const auto do_data = do_blob->buffer().as<float *>();
-  const auto masks_blob = request->GetBlob(mask_output.c_str());
-  const auto masks_data = masks_blob->buffer().as<float *>();
-  const size_t output_w = masks_blob->getTensorDesc().getDims().at(3);
-  const size_t output_h = masks_blob->getTensorDesc().getDims().at(2);
-  const size_t output_des = masks_blob-> getTensorDesc().getDims().at(1);
-  const size_t output_extra = masks_blob-> getTensorDesc().getDims().at(0);
-
-  slog::debug << "output w " << output_w<< slog::endl;
-  slog::debug << "output h " << output_h << slog::endl;
-  slog::debug << "output description " << output_des << slog::endl;
-  slog::debug << "output extra " << output_extra << slog::endl;
-
-  const float * detections = request->GetBlob(detection_output)->buffer().as<float *>();
+  SLOG_DEBUG << "output w " << output_w<< slog::endl;
+  SLOG_DEBUG << "output h " << output_h << slog::endl;
+  SLOG_DEBUG << "output description " << output_des << slog::endl;
+  SLOG_DEBUG << "output extra " << output_extra << slog::endl;
+
+  const float * detections =
+    engine->getOutputBinding(detection_output).blob->cbuffer().as<const float *>();
   std::vector<std::string> &labels = valid_model_->getLabels();
-  slog::debug << "label size " <<labels.size() << slog::endl;
+  SLOG_DEBUG << "label size " <<labels.size() << slog::endl;
+
+  const int type = output_des > 256 ? CV_16U : CV_8U;
+  cv::Mat class_map;
+  cv::Mat max_prob;
+  argmax(detections, static_cast<int>(output_des), static_cast<int>(output_h),
+    static_cast<int>(output_w), type, class_map, max_prob);
 
-  cv::Mat inImg, resImg, maskImg(output_h, output_w, CV_8UC3);
-  cv::Mat colored_mask(output_h, output_w, CV_8UC3);
   cv::Rect roi = cv::Rect(0, 0, output_w, output_h);
 
-  for (int rowId = 0; rowId < output_h; ++rowId)
-  {
-    for (int colId = 0; colId < output_w; ++colId)
-    {
-      std::size_t classId = 0;
-      float maxProb = -1.0f;
-      if (output_des < 2) {  // assume the output is already ArgMax'ed
-        classId = static_cast<std::size_t>(detections[rowId * output_w + colId]);
-        for (int ch = 0; ch < colored_mask.channels();++ch){
-          colored_mask.at<cv::Vec3b>(rowId, colId)[ch] = colors_[classId][ch];
-        }
-        //classId = static_cast<std::size_t>(predictions[rowId * output_w + colId]);
-      } else {
-        for (int chId = 0; chId < output_des; ++chId)
-        {
-          float prob = detections[chId * output_h * output_w + rowId * output_w+ colId];
-          //float prob = predictions[chId * output_h * output_w + rowId * output_w+ colId];
-          if (prob > maxProb)
-          {
-            classId = chId;
-            maxProb = prob;
-          }
-        }
-        while (classId >= colors_.size())
-        {
-          static std::mt19937 rng(classId);
-          std::uniform_int_distribution<int> distr(0, 255);
-          cv::Vec3b color(distr(rng), distr(rng), distr(rng));
-          colors_.push_back(color);
-        }
-        if(maxProb > 0.5){
-        for (int ch = 0; ch < colored_mask.channels();++ch){
-          colored_mask.at<cv::Vec3b>(rowId, colId)[ch] = colors_[classId][ch];
-        }
-       }
-      }
-    }
-  }
   const float alpha = 0.7f;
   Result result(roi);
-  result.mask_ = colored_mask;
+  // the colored mask is only materialized when an output asks for it
+  result.class_map_ = class_map;
+  if (!max_prob.empty()) {
+    result.confident_ = max_prob > 0.5;
+  }
+  if (colorize_mask_) {
+    result.palette_ = palette_;
+  }
   found_result = true;
   results_.emplace_back(result);
   return true;
 }
 
+void dynamic_vino_lib::ObjectSegmentation::fetchInstances(
+  const Engines::OutputBinding & detections, const Engines::OutputBinding & masks)
+{
+  const float * boxes = detections.blob->cbuffer().as<const float *>();
+  const float * masks_data = masks.blob->cbuffer().as<const float *>();
+  const size_t boxes_count = detections.blob->size() / 7;
+  const int mask_classes = static_cast<int>(masks.dims.at(1));
+  const int mask_h = static_cast<int>(masks.dims.at(2));
+  const int mask_w = static_cast<int>(masks.dims.at(3));
+  const size_t mask_count = masks.dims.at(0);
+  std::vector<std::string> & labels = valid_model_->getLabels();
+  const cv::Rect frame(cv::Point(), frame_size_);
+  ScratchArena::Scope scratch;
+  cv::Mat resized;
+  cv::Mat passed;
+  for (size_t i = 0; i < boxes_count && i < mask_count; i++) {
+    // [image_id, label, confidence, x_min, y_min, x_max, y_max], normalized
+    const float * box = boxes + i * 7;
+    if (box[0] < 0) {
+      break;
+    }
+    const float confidence = box[2];
+    if (confidence <= show_output_thresh_) {
+      continue;
+    }
+    const int class_id = static_cast<int>(box[1]);
+    cv::Rect location(
+      cv::Point(static_cast<int>(box[3] * frame_size_.width),
+      static_cast<int>(box[4] * frame_size_.height)),
+      cv::Point(static_cast<int>(box[5] * frame_size_.width),
+      static_cast<int>(box[6] * frame_size_.height)));
+    location &= frame;
+    if (location.area() == 0) {
+      continue;
+    }
+    // only the mask of the class of the box is resized, into the box
+    const int plane = mask_classes > 1 ? std::min(class_id, mask_classes - 1) : 0;
+    const float * mask = masks_data + (i * mask_classes + plane) * mask_h * mask_w;
+    // the temporaries of each box are taken anew, given back together
+    resized = scratch.getMat(location.size(), CV_32F);
+    cv::resize(cv::Mat(mask_h, mask_w, CV_32F, const_cast<float *>(mask)), resized,
+      location.size());
+    passed = scratch.getMat(location.size(), CV_8U);
+    cv::compare(resized, 0.5, passed, cv::CMP_GT);
+    const int type = class_id > 255 ? CV_16U : CV_8U;
+    Result result(location + frame_loc_.tl());
+    result.class_map_ = cv::Mat::zeros(location.size(), type);
+    result.class_map_.setTo(cv::Scalar(class_id), passed);
+    result.label_ = class_id >= 0 && class_id < static_cast<int>(labels.size()) ?
+      labels[class_id] : std::to_string(class_id);
+    result.confidence_ = confidence;
+    result.instance_ = true;
+    if (colorize_mask_) {
+      result.palette_ = palette_;
+    }
+    results_.emplace_back(result);
+  }
+}
+
+void dynamic_vino_lib::ObjectSegmentation::argmax(
+  const float * scores, int channels, int height, int width, int type,
+  cv::Mat & class_map, cv::Mat & max_prob)
+{
+  const int plane_size = height * width;
+  class_map.create(height, width, type);
+  class_map.setTo(cv::Scalar(0));
+  max_prob.release();
+  if (channels < 2) {  // assume the output is already ArgMax'ed
+    cv::Mat(height, width, CV_32F, const_cast<float *>(scores)).convertTo(class_map, type);
+    return;
+  }
+  // channel-major argmax: compare each plane with the running maximum at once
+  cv::Mat(height, width, CV_32F, const_cast<float *>(scores)).copyTo(max_prob);
+  ScratchArena::Scope scratch;
+  cv::Mat greater = scratch.getMat(cv::Size(width, height), CV_8U);
+  for (int chId = 1; chId < channels; ++chId) {
+    cv::Mat plane(height, width, CV_32F, const_cast<float *>(scores + chId * plane_size));
+    cv::compare(plane, max_prob, greater, cv::CMP_GT);
+    plane.copyTo(max_prob, greater);
+    class_map.setTo(cv::Scalar(static_cast<double>(chId)), greater);
+  }
+}
+
+void dynamic_vino_lib::ObjectSegmentation::trackResults(int input_id, const cv::Mat &)
+{
+  // the masks of each fetch are allocated anew, the copy shares them
+  last_results_[input_id] = results_;
+}
+
+bool dynamic_vino_lib::ObjectSegmentation::reuseResults(int input_id)
+{
+  auto iter = last_results_.find(input_id);
+  if (iter == last_results_.end()) {
+    return false;
+  }
+  results_ = iter->second;
+  return true;
+}
+
 int dynamic_vino_lib::ObjectSegmentation::getResultsLength() const
 {
   return static_cast<int>(results_.size());
@@ -208,13 +353,9 @@ const std::string dynamic_vino_lib::ObjectSegmentation::getName() const
   return valid_model_->getModelCategory();
 }
 
-void dynamic_vino_lib::ObjectSegmentation::observeOutput(
-    const std::shared_ptr<Outputs::BaseOutput> &output)
+dynamic_vino_lib::ResultView dynamic_vino_lib::ObjectSegmentation::getResultView() const
 {
-  if (output != nullptr)
-  {
-    output->accept(results_);
-  }
+  return ResultView(results_);
 }
 
 const std::vector<cv::Rect> dynamic_vino_lib::ObjectSegmentation::getFilteredROIs(
@@ -226,7 +367,8 @@ const std::vector<cv::Rect> dynamic_vino_lib::ObjectSegmentation::getFilteredROI
               << "Filter conditions: " << filter_conditions << slog::endl;
   }
   std::vector<cv::Rect> filtered_rois;
-  for (auto res : results_)
+  filtered_rois.reserve(results_.size());
+  for (auto & res : results_)
   {
     filtered_rois.push_back(res.getLocation());
   }
@@ -0,0 +1,233 @@
+// Copyright (c) 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @brief An implementation file with implementation for ObjectTracker Class
+ * @file object_tracker.cpp
+ */
+#include <algorithm>
+#include <tuple>
+#include <vector>
+#include "dynamic_vino_lib/inferences/object_tracker.hpp"
+
+dynamic_vino_lib::ObjectTracker::ObjectTracker(
+  float iou_threshold, int max_age, bool optical_flow)
+: iou_threshold_(iou_threshold), max_age_(std::max(0, max_age)), optical_flow_(optical_flow) {}
+
+std::vector<int> dynamic_vino_lib::ObjectTracker::update(
+  const std::vector<cv::Rect> & boxes, const std::vector<int> & label_ids,
+  const std::vector<float> & confidences, const cv::Mat & frame,
+  std::vector<int> * track_ages)
+{
+  for (auto & track : tracks_) {
+    track.box = toRect(track.filter.predict());
+  }
+
+  // greedy association, the pairs with the highest IoU first
+  std::vector<std::tuple<float, int, int>> pairs;
+  for (size_t d = 0; d < boxes.size(); d++) {
+    for (size_t t = 0; t < tracks_.size(); t++) {
+      if (tracks_[t].label_id != label_ids[d]) {
+        continue;
+      }
+      float iou = calcIoU(boxes[d], tracks_[t].box);
+      if (iou >= iou_threshold_) {
+        pairs.emplace_back(iou, static_cast<int>(d), static_cast<int>(t));
+      }
+    }
+  }
+  std::sort(pairs.begin(), pairs.end(),
+    [](const std::tuple<float, int, int> & a, const std::tuple<float, int, int> & b) {
+      return std::get<0>(a) > std::get<0>(b);
+    });
+  std::vector<int> track_ids(boxes.size(), -1);
+  if (track_ages != nullptr) {
+    track_ages->assign(boxes.size(), 1);
+  }
+  std::vector<bool> matched(tracks_.size(), false);
+  for (auto & pair : pairs) {
+    int d = std::get<1>(pair);
+    int t = std::get<2>(pair);
+    if (track_ids[d] >= 0 || matched[t]) {
+      continue;
+    }
+    auto & track = tracks_[t];
+    track.filter.correct(toMeasurement(boxes[d]));
+    track.box = boxes[d];
+    track.confidence = confidences[d];
+    track.misses = 0;
+    track.age++;
+    matched[t] = true;
+    track_ids[d] = track.id;
+    if (track_ages != nullptr) {
+      (*track_ages)[d] = track.age;
+    }
+  }
+
+  for (size_t t = 0; t < tracks_.size(); t++) {
+    if (!matched[t]) {
+      tracks_[t].misses++;
+    }
+  }
+  tracks_.erase(std::remove_if(tracks_.begin(), tracks_.end(),
+    [this](const Track & track) {return track.misses > max_age_;}), tracks_.end());
+
+  for (size_t d = 0; d < boxes.size(); d++) {
+    if (track_ids[d] >= 0) {
+      continue;
+    }
+    Track track;
+    track.id = next_id_++;
+    track.label_id = label_ids[d];
+    track.confidence = confidences[d];
+    track.box = boxes[d];
+    initFilter(track);
+    tracks_.push_back(track);
+    track_ids[d] = track.id;
+  }
+
+  if (optical_flow_ && !frame.empty()) {
+    toGray(frame, prev_gray_);
+  }
+  return track_ids;
+}
+
+void dynamic_vino_lib::ObjectTracker::predict(const cv::Mat & frame)
+{
+  for (auto & track : tracks_) {
+    track.box = toRect(track.filter.predict());
+  }
+  if (!optical_flow_ || frame.empty()) {
+    return;
+  }
+  cv::Mat gray;
+  toGray(frame, gray);
+  if (!prev_gray_.empty() && prev_gray_.size() == gray.size()) {
+    followFlow(gray);
+  }
+  prev_gray_ = gray;
+}
+
+std::vector<const dynamic_vino_lib::ObjectTracker::Track *>
+dynamic_vino_lib::ObjectTracker::getActiveTracks() const
+{
+  std::vector<const Track *> tracks;
+  for (auto & track : tracks_) {
+    if (track.misses == 0 && track.box.area() > 0) {
+      tracks.push_back(&track);
+    }
+  }
+  return tracks;
+}
+
+void dynamic_vino_lib::ObjectTracker::toGray(const cv::Mat & frame, cv::Mat & gray)
+{
+  if (frame.channels() == 1) {
+    frame.copyTo(gray);
+  } else {
+    cv::cvtColor(frame, gray, cv::COLOR_BGR2GRAY);
+  }
+}
+
+void dynamic_vino_lib::ObjectTracker::followFlow(const cv::Mat & gray)
+{
+  const cv::Rect frame_rect(0, 0, gray.cols, gray.rows);
+  for (auto & track : tracks_) {
+    if (track.misses != 0) {
+      continue;
+    }
+    cv::Rect box = track.box & frame_rect;
+    if (box.area() <= 0) {
+      continue;
+    }
+    std::vector<cv::Point2f> points;
+    cv::goodFeaturesToTrack(prev_gray_(box), points, 20, 0.01, 3);
+    if (points.empty()) {
+      continue;
+    }
+    for (auto & point : points) {
+      point += cv::Point2f(static_cast<float>(box.x), static_cast<float>(box.y));
+    }
+    std::vector<cv::Point2f> moved;
+    std::vector<uchar> status;
+    std::vector<float> errors;
+    cv::calcOpticalFlowPyrLK(prev_gray_, gray, points, moved, status, errors);
+    std::vector<float> dx, dy;
+    for (size_t i = 0; i < points.size(); i++) {
+      if (status[i]) {
+        dx.push_back(moved[i].x - points[i].x);
+        dy.push_back(moved[i].y - points[i].y);
+      }
+    }
+    if (dx.empty()) {
+      continue;
+    }
+    std::nth_element(dx.begin(), dx.begin() + dx.size() / 2, dx.end());
+    std::nth_element(dy.begin(), dy.begin() + dy.size() / 2, dy.end());
+    cv::Rect shifted = track.box + cv::Point(
+      cvRound(dx[dx.size() / 2]), cvRound(dy[dy.size() / 2]));
+    // the flow is a measurement of the box, the filter keeps the velocity consistent
+    track.filter.correct(toMeasurement(shifted));
+    track.box = shifted;
+  }
+}
+
+void dynamic_vino_lib::ObjectTracker::initFilter(Track & track) const
+{
+  // state: center x, center y, width, height and their velocities per frame
+  track.filter.init(8, 4, 0, CV_32F);
+  cv::setIdentity(track.filter.transitionMatrix);
+  for (int i = 0; i < 4; i++) {
+    track.filter.transitionMatrix.at<float>(i, i + 4) = 1;
+  }
+  cv::setIdentity(track.filter.measurementMatrix);
+  cv::setIdentity(track.filter.processNoiseCov, cv::Scalar::all(1e-2));
+  for (int i = 4; i < 8; i++) {
+    track.filter.processNoiseCov.at<float>(i, i) = 1e-4;
+  }
+  cv::setIdentity(track.filter.measurementNoiseCov, cv::Scalar::all(1e-1));
+  cv::setIdentity(track.filter.errorCovPost, cv::Scalar::all(1));
+  for (int i = 4; i < 8; i++) {
+    track.filter.errorCovPost.at<float>(i, i) = 10;
+  }
+  cv::Mat measurement = toMeasurement(track.box);
+  track.filter.statePost = cv::Mat::zeros(8, 1, CV_32F);
+  measurement.copyTo(track.filter.statePost.rowRange(0, 4));
+}
+
+cv::Rect dynamic_vino_lib::ObjectTracker::toRect(const cv::Mat & state)
+{
+  float width = std::max(0.0f, state.at<float>(2));
+  float height = std::max(0.0f, state.at<float>(3));
+  return cv::Rect(
+    cvRound(state.at<float>(0) - width / 2), cvRound(state.at<float>(1) - height / 2),
+    cvRound(width), cvRound(height));
+}
+
+cv::Mat dynamic_vino_lib::ObjectTracker::toMeasurement(const cv::Rect & box)
+{
+  cv::Mat measurement(4, 1, CV_32F);
+  measurement.at<float>(0) = box.x + box.width / 2.0f;
+  measurement.at<float>(1) = box.y + box.height / 2.0f;
+  measurement.at<float>(2) = static_cast<float>(box.width);
+  measurement.at<float>(3) = static_cast<float>(box.height);
+  return measurement;
+}
+
+float dynamic_vino_lib::ObjectTracker::calcIoU(const cv::Rect & a, const cv::Rect & b)
+{
+  float intersection = static_cast<float>((a & b).area());
+  float union_area = a.area() + b.area() - intersection;
+  return union_area > 0 ? intersection / union_area : 0;
+}
@@ -17,6 +17,7 @@
  * PersonAttribsDetectionResult class
  * @file person_attribs_detection.cpp
  */
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <vector>
@@ -31,7 +32,7 @@ dynamic_vino_lib::PersonAttribsDetectionResult::PersonAttribsDetectionResult(
 
 // PersonAttribsDetection
 dynamic_vino_lib::PersonAttribsDetection::PersonAttribsDetection(double attribs_confidence)
-: attribs_confidence_(attribs_confidence), dynamic_vino_lib::BaseInference() {}
+: attribs_confidence_(attribs_confidence), SlotSelectingInference() {}
 
 dynamic_vino_lib::PersonAttribsDetection::~PersonAttribsDetection() = default;
 void dynamic_vino_lib::PersonAttribsDetection::loadNetwork(
@@ -48,7 +49,7 @@ bool dynamic_vino_lib::PersonAttribsDetection::enqueue(
     results_.clear();
   }
   if (!dynamic_vino_lib::BaseInference::enqueue<u_int8_t>(
-      frame, input_frame_loc, 1, 0, valid_model_->getInputName()))
+      frame, input_frame_loc, 1, getEnqueuedNum(), valid_model_->getInputName()))
   {
     return false;
   }
@@ -67,30 +68,30 @@ bool dynamic_vino_lib::PersonAttribsDetection::fetchResults()
   bool can_fetch = dynamic_vino_lib::BaseInference::fetchResults();
   if (!can_fetch) {return false;}
   bool found_result = false;
-  InferenceEngine::InferRequest::Ptr request = getEngine()->getRequest();
-  slog::debug << "Analyzing Attributes Detection results..." << slog::endl;
+  auto engine = getEngine();
+  SLOG_DEBUG << "Analyzing Attributes Detection results..." << slog::endl;
   std::string attribute_output = valid_model_->getOutputName("attributes_output_");
   std::string top_output = valid_model_->getOutputName("top_output_");
   std::string bottom_output = valid_model_->getOutputName("bottom_output_");
 
-  /*auto attri_values = request->GetBlob(attribute_output)->buffer().as<float*>();
-  auto top_values = request->GetBlob(top_output)->buffer().as<float*>();
-  auto bottom_values = request->GetBlob(bottom_output)->buffer().as<float*>();*/
-  InferenceEngine::Blob::Ptr attribBlob = request->GetBlob(attribute_output);
-  InferenceEngine::Blob::Ptr topBlob = request->GetBlob(top_output);
-  InferenceEngine::Blob::Ptr bottomBlob = request->GetBlob(bottom_output);
+  /*auto attri_values = engine->getOutput(attribute_output)->buffer().as<float*>();
+  auto top_values = engine->getOutput(top_output)->buffer().as<float*>();
+  auto bottom_values = engine->getOutput(bottom_output)->buffer().as<float*>();*/
+  InferenceEngine::Blob::CPtr attribBlob = engine->getOutput(attribute_output);
+  InferenceEngine::Blob::CPtr topBlob = engine->getOutput(top_output);
+  InferenceEngine::Blob::CPtr bottomBlob = engine->getOutput(bottom_output);
 
-  auto attri_values = attribBlob->buffer().as<float*>();
-  auto top_values = topBlob->buffer().as<float*>();
-  auto bottom_values = bottomBlob->buffer().as<float*>();
+  auto attri_values = attribBlob->cbuffer().as<const float *>();
+  auto top_values = topBlob->cbuffer().as<const float *>();
+  auto bottom_values = bottomBlob->cbuffer().as<const float *>();
 
   int net_attrib_length = net_attributes_.size();
   for (int i = 0; i < getResultsLength(); i++) {
     results_[i].male_probability_ = attri_values[i * net_attrib_length];
-    results_[i].top_point_.x = top_values[i];
-    results_[i].top_point_.y = top_values[i+1];
-    results_[i].bottom_point_.x = bottom_values[i];
-    results_[i].bottom_point_.y = bottom_values[i+1];
+    results_[i].top_point_.x = top_values[i * 2];
+    results_[i].top_point_.y = top_values[i * 2 + 1];
+    results_[i].bottom_point_.x = bottom_values[i * 2];
+    results_[i].bottom_point_.y = bottom_values[i * 2 + 1];
     std::string attrib = "";
     for (int j = 1; j < net_attrib_length; j++) {
       attrib += (attri_values[i * net_attrib_length + j] > attribs_confidence_) ?
@@ -120,11 +121,27 @@ const std::string dynamic_vino_lib::PersonAttribsDetection::getName() const
   return valid_model_->getModelCategory();
 }
 
-void dynamic_vino_lib::PersonAttribsDetection::observeOutput(
-  const std::shared_ptr<Outputs::BaseOutput> & output)
+dynamic_vino_lib::ResultView dynamic_vino_lib::PersonAttribsDetection::getResultView() const
 {
-  if (output != nullptr) {
-    output->accept(results_);
+  return ResultView(results_);
+}
+
+void dynamic_vino_lib::PersonAttribsDetection::loadCachedResults(
+  const std::vector<cv::Rect> & rois, const std::vector<int64_t> & track_keys,
+  std::vector<size_t> & stale, bool any_age)
+{
+  cache_.load(getResultCachePolicy(any_age), rois, track_keys, cached_results_, stale);
+}
+
+dynamic_vino_lib::ResultView dynamic_vino_lib::PersonAttribsDetection::getCachedResultView() const
+{
+  return cached_results_.empty() ? ResultView() : ResultView(cached_results_);
+}
+
+void dynamic_vino_lib::PersonAttribsDetection::cacheResults(const std::vector<int64_t> & track_keys)
+{
+  for (size_t i = 0; i < results_.size() && i < track_keys.size(); i++) {
+    cache_.store(track_keys[i], results_[i], std::max(results_[i].male_probability_, 1 - results_[i].male_probability_));
   }
 }
 
@@ -136,7 +153,8 @@ const std::vector<cv::Rect> dynamic_vino_lib::PersonAttribsDetection::getFiltere
       "Filter conditions: " << filter_conditions << slog::endl;
   }
   std::vector<cv::Rect> filtered_rois;
-  for (auto res : results_) {
+  filtered_rois.reserve(results_.size());
+  for (auto & res : results_) {
     filtered_rois.push_back(res.getLocation());
   }
   return filtered_rois;
@@ -30,10 +30,18 @@ dynamic_vino_lib::PersonReidentificationResult::PersonReidentificationResult(
 : Result(location) {}
 
 // PersonReidentification
-dynamic_vino_lib::PersonReidentification::PersonReidentification(double match_thresh)
-: dynamic_vino_lib::BaseInference()
+dynamic_vino_lib::PersonReidentification::PersonReidentification(
+  double match_thresh, std::shared_ptr<GalleryIndex> gallery_index, int gallery_size,
+  const std::string & shared_gallery)
+: SlotSelectingInference()
 {
-  person_tracker_ = std::make_shared<dynamic_vino_lib::Tracker>(1000, match_thresh, 0.3);
+  if (!shared_gallery.empty()) {
+    person_tracker_ = dynamic_vino_lib::Tracker::getShared(
+      shared_gallery, gallery_size, match_thresh, 0.3, gallery_index);
+  } else {
+    person_tracker_ = std::make_shared<dynamic_vino_lib::Tracker>(
+      gallery_size, match_thresh, 0.3, gallery_index);
+  }
 }
 
 dynamic_vino_lib::PersonReidentification::~PersonReidentification() = default;
@@ -51,7 +59,7 @@ bool dynamic_vino_lib::PersonReidentification::enqueue(
     results_.clear();
   }
   if (!dynamic_vino_lib::BaseInference::enqueue<u_int8_t>(
-      frame, input_frame_loc, 1, 0, valid_model_->getInputName()))
+      frame, input_frame_loc, 1, getEnqueuedNum(), valid_model_->getInputName()))
   {
     return false;
   }
@@ -70,14 +78,13 @@ bool dynamic_vino_lib::PersonReidentification::fetchResults()
   bool can_fetch = dynamic_vino_lib::BaseInference::fetchResults();
   if (!can_fetch) {return false;}
   bool found_result = false;
-  InferenceEngine::InferRequest::Ptr request = getEngine()->getRequest();
+  auto engine = getEngine();
   std::string output = valid_model_->getOutputName();
-  const float * output_values = request->GetBlob(output)->buffer().as<float *>();
+  const float * output_values = engine->getOutput(output)->cbuffer().as<const float *>();
+  cv::Mat new_persons(getResultsLength(), 256, CV_32F, const_cast<float *>(output_values));
+  std::vector<int> person_ids = person_tracker_->processNewTracks(new_persons);
   for (int i = 0; i < getResultsLength(); i++) {
-    std::vector<float> new_person = std::vector<float>(
-      output_values + 256 * i, output_values + 256 * i + 256);
-    std::string person_id = "No." + std::to_string(
-      person_tracker_->processNewTrack(new_person));
+    std::string person_id = "No." + std::to_string(person_ids[i]);
     results_[i].person_id_ = person_id;
     found_result = true;
   }
@@ -101,12 +108,9 @@ const std::string dynamic_vino_lib::PersonReidentification::getName() const
   return valid_model_->getModelCategory();
 }
 
-void dynamic_vino_lib::PersonReidentification::observeOutput(
-  const std::shared_ptr<Outputs::BaseOutput> & output)
+dynamic_vino_lib::ResultView dynamic_vino_lib::PersonReidentification::getResultView() const
 {
-  if (output != nullptr) {
-    output->accept(results_);
-  }
+  return ResultView(results_);
 }
 
 const std::vector<cv::Rect> dynamic_vino_lib::PersonReidentification::getFilteredROIs(
@@ -117,7 +121,8 @@ const std::vector<cv::Rect> dynamic_vino_lib::PersonReidentification::getFiltere
       "Filter conditions: " << filter_conditions << slog::endl;
   }
   std::vector<cv::Rect> filtered_rois;
-  for (auto res : results_) {
+  filtered_rois.reserve(results_.size());
+  for (auto & res : results_) {
     filtered_rois.push_back(res.getLocation());
   }
   return filtered_rois;
@@ -31,7 +31,7 @@ dynamic_vino_lib::VehicleAttribsDetectionResult::VehicleAttribsDetectionResult(
 
 // VehicleAttribsDetection
 dynamic_vino_lib::VehicleAttribsDetection::VehicleAttribsDetection()
-: dynamic_vino_lib::BaseInference() {}
+: SlotSelectingInference() {}
 
 dynamic_vino_lib::VehicleAttribsDetection::~VehicleAttribsDetection() = default;
 void dynamic_vino_lib::VehicleAttribsDetection::loadNetwork(
@@ -48,7 +48,7 @@ bool dynamic_vino_lib::VehicleAttribsDetection::enqueue(
     results_.clear();
   }
   if (!dynamic_vino_lib::BaseInference::enqueue<u_int8_t>(
-      frame, input_frame_loc, 1, 0, valid_model_->getInputName()))
+      frame, input_frame_loc, 1, getEnqueuedNum(), valid_model_->getInputName()))
   {
     return false;
   }
@@ -67,13 +67,13 @@ bool dynamic_vino_lib::VehicleAttribsDetection::fetchResults()
   bool can_fetch = dynamic_vino_lib::BaseInference::fetchResults();
   if (!can_fetch) {return false;}
   bool found_result = false;
-  InferenceEngine::InferRequest::Ptr request = getEngine()->getRequest();
+  auto engine = getEngine();
   //std::string color_name = valid_model_->getColorOutputName();
   //std::string type_name = valid_model_->getTypeOutputName();
   std::string color_name = valid_model_->getOutputName("color_output_");
   std::string type_name = valid_model_->getOutputName("type_output_");
-  const float * color_values = request->GetBlob(color_name)->buffer().as<float *>();
-  const float * type_values = request->GetBlob(type_name)->buffer().as<float *>();
+  const float * color_values = engine->getOutput(color_name)->cbuffer().as<const float *>();
+  const float * type_values = engine->getOutput(type_name)->cbuffer().as<const float *>();
   for (int i = 0; i < getResultsLength(); i++) {
     auto color_id = std::max_element(color_values, color_values + 7) - color_values;
     auto type_id = std::max_element(type_values, type_values + 4) - type_values;
@@ -103,11 +103,27 @@ const std::string dynamic_vino_lib::VehicleAttribsDetection::getName() const
   return valid_model_->getModelCategory();
 }
 
-void dynamic_vino_lib::VehicleAttribsDetection::observeOutput(
-  const std::shared_ptr<Outputs::BaseOutput> & output)
+dynamic_vino_lib::ResultView dynamic_vino_lib::VehicleAttribsDetection::getResultView() const
 {
-  if (output != nullptr) {
-    output->accept(results_);
+  return ResultView(results_);
+}
+
+void dynamic_vino_lib::VehicleAttribsDetection::loadCachedResults(
+  const std::vector<cv::Rect> & rois, const std::vector<int64_t> & track_keys,
+  std::vector<size_t> & stale, bool any_age)
+{
+  cache_.load(getResultCachePolicy(any_age), rois, track_keys, cached_results_, stale);
+}
+
+dynamic_vino_lib::ResultView dynamic_vino_lib::VehicleAttribsDetection::getCachedResultView() const
+{
+  return cached_results_.empty() ? ResultView() : ResultView(cached_results_);
+}
+
+void dynamic_vino_lib::VehicleAttribsDetection::cacheResults(const std::vector<int64_t> & track_keys)
+{
+  for (size_t i = 0; i < results_.size() && i < track_keys.size(); i++) {
+    cache_.store(track_keys[i], results_[i], 1.0f);
   }
 }
 
@@ -119,7 +135,8 @@ const std::vector<cv::Rect> dynamic_vino_lib::VehicleAttribsDetection::getFilter
       "Filter conditions: " << filter_conditions << slog::endl;
   }
   std::vector<cv::Rect> filtered_rois;
-  for (auto res : results_) {
+  filtered_rois.reserve(results_.size());
+  for (auto & res : results_) {
     filtered_rois.push_back(res.getLocation());
   }
   return filtered_rois;
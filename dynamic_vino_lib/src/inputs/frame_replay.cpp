@@ -0,0 +1,174 @@
+// Copyright (c) 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @brief a header file with declaration of FrameReplay class
+ * @file frame_replay.cpp
+ */
+
+#include <sys/stat.h>
+#include <algorithm>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "dynamic_vino_lib/inputs/frame_replay.hpp"
+#include "dynamic_vino_lib/inputs/input_meta.hpp"
+#include "dynamic_vino_lib/slog.hpp"
+
+Input::FrameReplay::FrameReplay(const std::string & meta)
+{
+  auto values = parseInputMeta(meta, "path");
+  source_ = values["path"];
+  try {
+    if (!values["frames"].empty()) {
+      max_frames_ = std::max<size_t>(1, std::stoul(values["frames"]));
+    }
+    if (!values["fps"].empty()) {
+      fps_ = std::max(0.0, std::stod(values["fps"]));
+    }
+    if (!values["jitter_ms"].empty()) {
+      jitter_ms_ = std::max(0.0, std::stod(values["jitter_ms"]));
+    }
+    if (!values["loops"].empty()) {
+      loops_ = std::stoul(values["loops"]);
+    }
+    if (!values["seed"].empty()) {
+      seed_ = static_cast<unsigned>(std::stoul(values["seed"]));
+    }
+  } catch (const std::exception &) {
+    slog::warn << "Invalid FrameReplay parameters: " << meta << slog::endl;
+  }
+}
+
+bool Input::FrameReplay::initialize()
+{
+  return initialize(0, 0);
+}
+
+bool Input::FrameReplay::initialize(size_t width, size_t height)
+{
+  if (isInit()) {
+    return true;
+  }
+  setInitStatus(load(cv::Size(width, height)));
+  if (isInit()) {
+    setWidth((size_t)frames_.front().cols);
+    setHeight((size_t)frames_.front().rows);
+  }
+  return isInit();
+}
+
+bool Input::FrameReplay::load(const cv::Size & size)
+{
+  struct stat info;
+  bool directory = stat(source_.c_str(), &info) == 0 && S_ISDIR(info.st_mode);
+  if (directory || source_.find_first_of("*?") != std::string::npos) {
+    std::vector<cv::String> files;
+    try {
+      cv::glob(source_, files, false);
+    } catch (const cv::Exception & e) {
+      slog::err << "Failed to list the images of " << source_ << ": " << e.what() << slog::endl;
+    }
+    std::sort(files.begin(), files.end());
+    for (auto & file : files) {
+      if (frames_.size() >= max_frames_) {
+        break;
+      }
+      cv::Mat image = cv::imread(file);
+      if (!image.empty()) {
+        frames_.push_back(image);
+      }
+    }
+  } else {
+    cv::VideoCapture capture(source_);
+    cv::Mat frame;
+    while (frames_.size() < max_frames_ && capture.read(frame) && !frame.empty()) {
+      frames_.push_back(frame.clone());
+    }
+  }
+  if (frames_.empty()) {
+    slog::err << "No frame to replay in " << source_ << slog::endl;
+    return false;
+  }
+  size_t bytes = 0;
+  for (auto & frame : frames_) {
+    if (size.area() > 0 && frame.size() != size) {
+      cv::resize(frame, frame, size);
+    }
+    bytes += frame.total() * frame.elemSize();
+  }
+
+  // drawn once, every run replays the frames with the same jitters
+  std::mt19937 rng(seed_);
+  std::uniform_real_distribution<double> jitter(-jitter_ms_, jitter_ms_);
+  jitters_.resize(frames_.size());
+  for (auto & value : jitters_) {
+    value = jitter_ms_ > 0 ? static_cast<int64_t>(jitter(rng) * 1000) : 0;
+  }
+  slog::info << "Replaying " << frames_.size() << " frames of " << source_ << " (" <<
+    bytes / (1024 * 1024) << " MB)" << (fps_ > 0 ? " at " + std::to_string(fps_) + " fps" :
+    " as fast as possible") << slog::endl;
+  return true;
+}
+
+std::chrono::steady_clock::time_point Input::FrameReplay::getDueTime(uint64_t index) const
+{
+  auto offset = std::chrono::microseconds(
+    static_cast<int64_t>(index * 1e6 / fps_) + jitters_[index % jitters_.size()]);
+  return start_ + std::max(std::chrono::microseconds(0), offset);
+}
+
+bool Input::FrameReplay::read(cv::Mat * frame)
+{
+  if (!isInit() || isExhausted()) {
+    return false;
+  }
+  if (next_ == 0) {
+    start_ = std::chrono::steady_clock::now();
+  }
+  if (fps_ > 0) {
+    auto due = getDueTime(next_);
+    auto now = std::chrono::steady_clock::now();
+    if (now < due) {
+      std::this_thread::sleep_until(due);
+    } else if (now - due > std::chrono::microseconds(static_cast<int64_t>(1e6 / fps_))) {
+      ++late_frames_;
+    }
+  }
+  // copied, the outputs may draw on the frame
+  frames_[next_ % frames_.size()].copyTo(*frame);
+  next_++;
+  setHeader("replay_frame");
+  return true;
+}
+
+bool Input::FrameReplay::waitForFrame(const std::chrono::milliseconds & timeout)
+{
+  if (!isInit() || isExhausted()) {
+    return false;
+  }
+  if (fps_ <= 0 || next_ == 0) {
+    return true;
+  }
+  auto due = getDueTime(next_);
+  auto deadline = std::chrono::steady_clock::now() + timeout;
+  std::this_thread::sleep_until(std::min(due, deadline));
+  return std::chrono::steady_clock::now() >= due;
+}
+
+bool Input::FrameReplay::isExhausted()
+{
+  return isInit() && loops_ > 0 && next_ >= frames_.size() * loops_;
+}
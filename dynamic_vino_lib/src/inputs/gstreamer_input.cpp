@@ -0,0 +1,224 @@
+// Copyright (c) 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @brief a header file with declaration of GStreamerInput class
+ * @file gstreamer_input.cpp
+ */
+
+#include <memory>
+#include <string>
+#include "dynamic_vino_lib/inputs/gstreamer_input.hpp"
+#include "dynamic_vino_lib/slog.hpp"
+#include "dynamic_vino_lib/utils/frame_pool.hpp"
+
+namespace
+{
+/**
+ * The mapping of the buffer of a sample, unmapped and unreferenced once the
+ * last frame wrapping it is released.
+ */
+struct MappedSample
+{
+  GstSample * sample = nullptr;
+  GstVideoFrame frame;
+  ~MappedSample()
+  {
+    gst_video_frame_unmap(&frame);
+    gst_sample_unref(sample);
+  }
+};
+}  // namespace
+
+Input::GStreamerInput::GStreamerInput(const std::string & launch)
+: launch_(launch)
+{
+  if (!gst_is_initialized()) {
+    gst_init(nullptr, nullptr);
+  }
+  if (launch_.find("appsink") == std::string::npos) {
+    launch_ += " ! appsink name=sink";
+  }
+}
+
+Input::GStreamerInput::~GStreamerInput()
+{
+  if (pending_ != nullptr) {
+    gst_sample_unref(pending_);
+  }
+  if (pipeline_ != nullptr) {
+    gst_element_set_state(pipeline_, GST_STATE_NULL);
+    gst_object_unref(sink_);
+    gst_object_unref(pipeline_);
+  }
+}
+
+bool Input::GStreamerInput::initialize()
+{
+  GError * error = nullptr;
+  pipeline_ = gst_parse_launch(launch_.c_str(), &error);
+  if (error != nullptr) {
+    slog::err << "Invalid GStreamer launch string " << launch_ << ": " << error->message <<
+      slog::endl;
+    g_error_free(error);
+    if (pipeline_ != nullptr) {
+      gst_object_unref(pipeline_);
+      pipeline_ = nullptr;
+    }
+    return false;
+  }
+  GstElement * sink = gst_bin_get_by_name(GST_BIN(pipeline_), "sink");
+  if (sink == nullptr || !GST_IS_APP_SINK(sink)) {
+    slog::err << "No appsink named sink in " << launch_ << slog::endl;
+    if (sink != nullptr) {
+      gst_object_unref(sink);
+    }
+    gst_object_unref(pipeline_);
+    pipeline_ = nullptr;
+    return false;
+  }
+  sink_ = GST_APP_SINK(sink);
+  // without caps of its own the appsink negotiates one of the formats a frame can wrap
+  GstCaps * caps = gst_app_sink_get_caps(sink_);
+  if (caps == nullptr) {
+    caps = gst_caps_from_string("video/x-raw,format={BGR,NV12}");
+    gst_app_sink_set_caps(sink_, caps);
+  }
+  gst_caps_unref(caps);
+
+  gst_element_set_state(pipeline_, GST_STATE_PLAYING);
+  setInitStatus(waitForFrame(std::chrono::milliseconds(5000)));
+  if (!isInit()) {
+    slog::err << "No sample received from " << launch_ << slog::endl;
+    return false;
+  }
+  GstVideoInfo info;
+  if (!gst_video_info_from_caps(&info, gst_sample_get_caps(pending_))) {
+    setInitStatus(false);
+    return false;
+  }
+  nv12_ = GST_VIDEO_INFO_FORMAT(&info) == GST_VIDEO_FORMAT_NV12;
+  setWidth(GST_VIDEO_INFO_WIDTH(&info));
+  setHeight(GST_VIDEO_INFO_HEIGHT(&info));
+  return true;
+}
+
+bool Input::GStreamerInput::read(cv::Mat * frame)
+{
+  if (!isInit() || failed_) {
+    return false;
+  }
+  GstSample * sample = pending_;
+  pending_ = nullptr;
+  if (sample == nullptr) {
+    sample = gst_app_sink_pull_sample(sink_);
+  }
+  if (sample == nullptr) {
+    failed_ = checkBus();
+    return false;
+  }
+  setHeader("gstreamer_frame");
+  return wrapSample(sample, frame);
+}
+
+bool Input::GStreamerInput::waitForFrame(const std::chrono::milliseconds & timeout)
+{
+  if (pipeline_ == nullptr || failed_) {
+    return false;
+  }
+  if (pending_ == nullptr) {
+    pending_ = gst_app_sink_try_pull_sample(sink_, timeout.count() * GST_MSECOND);
+  }
+  if (pending_ == nullptr) {
+    failed_ = checkBus();
+  }
+  return pending_ != nullptr;
+}
+
+bool Input::GStreamerInput::isExhausted()
+{
+  if (!isInit()) {
+    return false;
+  }
+  return failed_ || (pending_ == nullptr && gst_app_sink_is_eos(sink_));
+}
+
+bool Input::GStreamerInput::wrapSample(GstSample * sample, cv::Mat * frame)
+{
+  GstVideoInfo info;
+  GstVideoFrame mapping;
+  if (!gst_video_info_from_caps(&info, gst_sample_get_caps(sample)) ||
+    !gst_video_frame_map(&mapping, &info, gst_sample_get_buffer(sample), GST_MAP_READ))
+  {
+    slog::err << "Failed to map a sample of " << launch_ << slog::endl;
+    gst_sample_unref(sample);
+    return false;
+  }
+  auto mapped = std::make_shared<MappedSample>();
+  mapped->sample = sample;
+  mapped->frame = mapping;
+
+  GstVideoFrame * vf = &mapped->frame;
+  int width = GST_VIDEO_FRAME_WIDTH(vf);
+  int height = GST_VIDEO_FRAME_HEIGHT(vf);
+  auto plane = [vf](int i) {
+      return static_cast<uchar *>(GST_VIDEO_FRAME_PLANE_DATA(vf, i));
+    };
+  size_t stride = GST_VIDEO_FRAME_PLANE_STRIDE(vf, 0);
+  switch (GST_VIDEO_FRAME_FORMAT(vf)) {
+    case GST_VIDEO_FORMAT_BGR:
+      *frame = FramePool::wrap(cv::Mat(height, width, CV_8UC3, plane(0), stride), mapped);
+      return true;
+    case GST_VIDEO_FORMAT_NV12:
+      // a frame holds the planes one over the other, padded planes are copied
+      if (plane(1) == plane(0) + stride * height &&
+        static_cast<size_t>(GST_VIDEO_FRAME_PLANE_STRIDE(vf, 1)) == stride)
+      {
+        *frame = FramePool::wrap(
+          cv::Mat(height * 3 / 2, width, CV_8UC1, plane(0), stride), mapped);
+      } else {
+        *frame = FramePool::create(cv::Size(width, height * 3 / 2), CV_8UC1);
+        cv::Mat(height, width, CV_8UC1, plane(0), stride).copyTo(frame->rowRange(0, height));
+        cv::Mat(height / 2, width, CV_8UC1, plane(1), GST_VIDEO_FRAME_PLANE_STRIDE(vf, 1)).copyTo(
+          frame->rowRange(height, height * 3 / 2));
+      }
+      return true;
+    default:
+      slog::err << "Unsupported sample format " <<
+        gst_video_format_to_string(GST_VIDEO_FRAME_FORMAT(vf)) << ", the appsink should take " <<
+        "BGR or NV12" << slog::endl;
+      failed_ = true;
+      return false;
+  }
+}
+
+bool Input::GStreamerInput::checkBus()
+{
+  GstBus * bus = gst_element_get_bus(pipeline_);
+  bool failed = false;
+  GstMessage * message;
+  while ((message = gst_bus_pop_filtered(bus, GST_MESSAGE_ERROR)) != nullptr) {
+    GError * error = nullptr;
+    gchar * debug = nullptr;
+    gst_message_parse_error(message, &error, &debug);
+    slog::err << "GStreamer error from " << GST_OBJECT_NAME(message->src) << ": " <<
+      error->message << (debug != nullptr ? std::string(", ") + debug : "") << slog::endl;
+    g_error_free(error);
+    g_free(debug);
+    gst_message_unref(message);
+    failed = true;
+  }
+  gst_object_unref(bus);
+  return failed;
+}
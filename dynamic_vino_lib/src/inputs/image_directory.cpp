@@ -0,0 +1,152 @@
+// Copyright (c) 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @brief a header file with declaration of ImageDirectory class
+ * @file image_directory.cpp
+ */
+
+#include <algorithm>
+#include <string>
+#include <thread>
+#include "dynamic_vino_lib/inputs/image_directory.hpp"
+#include "dynamic_vino_lib/inputs/input_meta.hpp"
+#include "dynamic_vino_lib/slog.hpp"
+
+Input::ImageDirectory::ImageDirectory(const std::string & meta)
+{
+  auto values = parseInputMeta(meta, "path");
+  pattern_ = values["path"];
+  recursive_ = values["recursive"] == "true";
+  try {
+    if (!values["threads"].empty()) {
+      threads_ = std::stoul(values["threads"]);
+    }
+    if (!values["queue_size"].empty()) {
+      queue_size_ = std::max<size_t>(1, std::stoul(values["queue_size"]));
+    }
+    if (!values["lanes"].empty()) {
+      lanes_ = std::max<size_t>(1, std::stoul(values["lanes"]));
+    }
+  } catch (const std::exception &) {
+    slog::warn << "Invalid ImageDirectory parameters: " << meta << slog::endl;
+  }
+  if (threads_ == 0) {
+    threads_ = std::max(1u, std::thread::hardware_concurrency());
+  }
+  // lock-step reads of all the lanes should not wait for the decoding
+  queue_size_ = std::max(queue_size_, 2 * lanes_);
+}
+
+Input::ImageDirectory::~ImageDirectory()
+{
+  // the pending decoding jobs refer to this device
+  pool_ = nullptr;
+}
+
+bool Input::ImageDirectory::initialize()
+{
+  std::lock_guard<std::mutex> lk(mutex_);
+  if (pool_ != nullptr) {
+    return isInit();
+  }
+
+  std::vector<cv::String> files;
+  try {
+    cv::glob(pattern_, files, recursive_);
+  } catch (const cv::Exception & e) {
+    slog::err << "Failed to list the images of " << pattern_ << ": " << e.what() << slog::endl;
+  }
+  static const std::vector<std::string> extensions = {
+    ".jpg", ".jpeg", ".png", ".bmp", ".tif", ".tiff", ".ppm", ".pgm", ".webp"};
+  for (auto & file : files) {
+    std::string name = file;
+    auto dot = name.find_last_of('.');
+    if (dot == std::string::npos) {
+      continue;
+    }
+    std::string extension = name.substr(dot);
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+    if (std::find(extensions.begin(), extensions.end(), extension) != extensions.end()) {
+      files_.push_back(file);
+    }
+  }
+  std::sort(files_.begin(), files_.end());
+  slog::info << "Find " << files_.size() << " images in " << pattern_ << slog::endl;
+
+  setInitStatus(!files_.empty());
+  if (isInit()) {
+    // the frame size is the one of the first image, the others may differ
+    cv::Mat first = cv::imread(files_.front());
+    setWidth((size_t)first.cols);
+    setHeight((size_t)first.rows);
+    pool_ = std::make_unique<ThreadPool>(threads_);
+    schedule();
+  }
+  return isInit();
+}
+
+void Input::ImageDirectory::schedule()
+{
+  while (next_decode_ < files_.size() && next_decode_ < next_read_ + queue_size_) {
+    size_t index = next_decode_++;
+    pool_->post([this, index]() {
+        cv::Mat image = cv::imread(files_[index]);
+        std::lock_guard<std::mutex> lk(mutex_);
+        decoded_[index] = image;
+        decoded_cv_.notify_all();
+      });
+  }
+}
+
+bool Input::ImageDirectory::read(cv::Mat * frame)
+{
+  if (!isInit()) {
+    return false;
+  }
+  std::unique_lock<std::mutex> lk(mutex_);
+  while (next_read_ < files_.size()) {
+    decoded_cv_.wait(lk, [this] {return decoded_.count(next_read_) > 0;});
+    size_t index = next_read_++;
+    cv::Mat image = decoded_[index];
+    decoded_.erase(index);
+    schedule();
+    if (image.empty()) {
+      slog::warn << "Failed to decode " << files_[index] << ", skip it" << slog::endl;
+      continue;
+    }
+    *frame = image;
+    setHeader(files_[index]);
+    lockHeader();
+    return true;
+  }
+  return false;
+}
+
+bool Input::ImageDirectory::waitForFrame(const std::chrono::milliseconds & timeout)
+{
+  if (!isInit()) {
+    return false;
+  }
+  std::unique_lock<std::mutex> lk(mutex_);
+  return decoded_cv_.wait_for(lk, timeout, [this] {
+             return next_read_ >= files_.size() || decoded_.count(next_read_) > 0;
+           });
+}
+
+bool Input::ImageDirectory::isExhausted()
+{
+  std::lock_guard<std::mutex> lk(mutex_);
+  return isInit() && next_read_ >= files_.size();
+}
@@ -49,6 +49,14 @@ bool Input::Image::read(cv::Mat * frame)
   return true;
 }
 
+void Input::Image::setImage(const cv::Mat & image)
+{
+  image_ = image;
+  setInitStatus(!image_.empty());
+  setWidth((size_t)image_.cols);
+  setHeight((size_t)image_.rows);
+}
+
 void Input::Image::config(const Input::Config & config)
 {
   if (config.path != "") {
@@ -19,29 +19,46 @@
 
 #include <cv_bridge/cv_bridge.h>
 #include <memory>
+#include <string>
 #include "dynamic_vino_lib/inputs/image_topic.hpp"
+#include "dynamic_vino_lib/inputs/input_meta.hpp"
 #include "dynamic_vino_lib/slog.hpp"
+#include "dynamic_vino_lib/utils/frame_pool.hpp"
+#include "dynamic_vino_lib/utils/nv12.hpp"
 
 #define INPUT_TOPIC "/openvino_toolkit/image_raw"
 
 
-Input::ImageTopic::ImageTopic(rclcpp::Node::SharedPtr node)
+Input::ImageTopic::ImageTopic(rclcpp::Node::SharedPtr node, const std::string & meta)
 : node_(node)
 {
+  auto values = parseInputMeta(meta);
+  auto format = values.find("format");
+  if (format != values.end() && !format->second.empty()) {
+    nv12_ = format->second == "nv12";
+    if (!nv12_ && format->second != "bgr8") {
+      slog::warn << "Unknown image topic format " << format->second << ", using bgr8" <<
+        slog::endl;
+    }
+  }
 }
 
 bool Input::ImageTopic::initialize()
 {
-  slog::debug << "before Image Topic init" << slog::endl;
+  SLOG_DEBUG << "before Image Topic init" << slog::endl;
 
   if(node_ == nullptr){
     throw std::runtime_error("Image Topic is not instancialized because of no parent node.");
     return false;
   }
   auto qos = rclcpp::QoS(rclcpp::KeepLast(1)).best_effort();
+  // on a multi-threaded executor, the images are not held by the other callbacks
+  callback_group_ = node_->create_callback_group(rclcpp::CallbackGroupType::MutuallyExclusive);
+  rclcpp::SubscriptionOptions options;
+  options.callback_group = callback_group_;
   sub_ = node_->create_subscription<sensor_msgs::msg::Image>(
     INPUT_TOPIC, qos,
-    std::bind(&ImageTopic::cb, this, std::placeholders::_1));
+    std::bind(&ImageTopic::cb, this, std::placeholders::_1), options);
 
   return true;
 }
@@ -53,28 +70,59 @@ bool Input::ImageTopic::initialize()
     return initialize();
   }
 
-void Input::ImageTopic::cb(const sensor_msgs::msg::Image::SharedPtr image_msg)
+// taken as const, an intra-process message is shared with the other subscriptions
+void Input::ImageTopic::cb(sensor_msgs::msg::Image::ConstSharedPtr image_msg)
 {
-  slog::debug << "Receiving a new image from Camera topic." << slog::endl;
-  setHeader(image_msg->header);
-
-  image_ = cv_bridge::toCvCopy(image_msg, "bgr8")->image;
-  //Suppose Image Topic is sent within BGR order, so the below line would work.
-  //image_ = cv::Mat(image_msg->height, image_msg->width, CV_8UC3,
-  //  const_cast<uchar *>(&image_msg->data[0]), image_msg->step);
+  SLOG_DEBUG << "Receiving a new image from Camera topic." << slog::endl;
+  cv::Mat image;
+  try {
+    if (nv12_ && (image_msg->encoding == "nv12" || image_msg->encoding == "NV12")) {
+      // the Y plane over the UV plane, shared with the message
+      cv::Mat pixels(image_msg->height * 3 / 2, image_msg->width, CV_8UC1,
+        const_cast<uint8_t *>(image_msg->data.data()), image_msg->step);
+      image = FramePool::wrap(pixels,
+          std::const_pointer_cast<sensor_msgs::msg::Image>(image_msg));
+    } else {
+      // shares the message buffer when it is already bgr8, converts otherwise
+      cv_bridge::CvImageConstPtr shared = cv_bridge::toCvShare(image_msg, "bgr8");
+      image = FramePool::wrap(shared->image, shared);
+      if (nv12_) {
+        cv::Mat nv12;
+        FramePool::attach(nv12);
+        convertBGRToNV12(image(cv::Rect(0, 0, image.cols & ~1, image.rows & ~1)), nv12);
+        image = nv12;
+      }
+    }
+  } catch (const cv_bridge::Exception & e) {
+    slog::err << "Failed to convert the image message: " << e.what() << slog::endl;
+    return;
+  }
 
-  image_count_.increaseCounter();
+  {
+    std::lock_guard<std::mutex> lk(image_mutex_);
+    setHeader(image_msg->header);
+    image_ = image;
+    has_new_image_ = true;
+  }
+  image_cv_.notify_all();
 }
 
 bool Input::ImageTopic::read(cv::Mat * frame)
 {
-  if (image_count_.get() < 0 || image_.empty()) {
-    slog::debug << "No data received in CameraTopic instance" << slog::endl;
+  std::lock_guard<std::mutex> lk(image_mutex_);
+  if (!has_new_image_ || image_.empty()) {
+    SLOG_DEBUG << "No data received in CameraTopic instance" << slog::endl;
     return false;
   }
 
   *frame = image_;
   lockHeader();
-  image_count_.decreaseCounter();
+  has_new_image_ = false;
   return true;
 }
+
+bool Input::ImageTopic::waitForFrame(const std::chrono::milliseconds & timeout)
+{
+  std::unique_lock<std::mutex> lock(image_mutex_);
+  return image_cv_.wait_for(lock, timeout, [this]() {return has_new_image_;});
+}
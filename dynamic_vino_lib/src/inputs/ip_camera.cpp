@@ -17,7 +17,21 @@
  * @file ip_camera.cpp
  */
 #include "dynamic_vino_lib/inputs/ip_camera.hpp"
+#include "dynamic_vino_lib/inputs/input_meta.hpp"
+#include "dynamic_vino_lib/utils/frame_pool.hpp"
 
+Input::IpCamera::IpCamera(const std::string & meta)
+{
+  auto values = parseInputMeta(meta, "uri");
+  ip_uri_ = values["uri"];
+  VideoDecoder::Options defaults;
+  defaults.queue_size = 1;
+  defaults.drop_oldest = true;
+  defaults.reconnect = true;
+  auto options = VideoDecoder::parseOptions(values, defaults);
+  options.drop_oldest = true;
+  decoder_ = std::make_unique<VideoDecoder>(options);
+}
 
 bool Input::IpCamera::initialize()
 {
@@ -27,7 +41,7 @@ bool Input::IpCamera::initialize()
 
 bool Input::IpCamera::initialize(size_t width, size_t height)
 {
-  setInitStatus(cap.open(ip_uri_));
+  setInitStatus(decoder_->open(ip_uri_));
   if (isInit()) {
     setWidth(width);
     setHeight(height);
@@ -40,11 +54,20 @@ bool Input::IpCamera::read(cv::Mat * frame)
   if (!isInit()) {
     return false;
   }
-  cap.grab();
   setHeader("ip_camera_frame");
-  bool retrieved = cap.retrieve(*frame);
-  if (retrieved) {
-    cv::resize(*frame, *frame, cv::Size(getWidth(), getHeight()), 0, 0, CV_INTER_AREA);
+  cv::Mat decoded;
+  if (!decoder_->read(&decoded)) {
+    return false;
+  }
+  *frame = FramePool::create(cv::Size(getWidth(), getHeight()), decoded.type());
+  cv::resize(decoded, *frame, frame->size(), 0, 0, CV_INTER_AREA);
+  return true;
+}
+
+bool Input::IpCamera::waitForFrame(const std::chrono::milliseconds & timeout)
+{
+  if (!isInit()) {
+    return false;
   }
-  return retrieved;
+  return decoder_->waitForFrame(timeout);
 }
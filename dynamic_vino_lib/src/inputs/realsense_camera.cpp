@@ -17,53 +17,283 @@
  * @file realsense_camera.cpp
  */
 #include "dynamic_vino_lib/inputs/realsense_camera.hpp"
+#include <librealsense2/rsutil.h>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+#include "dynamic_vino_lib/inputs/input_meta.hpp"
 #include "dynamic_vino_lib/slog.hpp"
+#include "dynamic_vino_lib/utils/frame_pool.hpp"
+
+namespace
+{
+/**
+ * The depth frame captured with a color frame, looked up in the regions of
+ * the results: the median of the valid depths of a subsampled central part of
+ * the region, so that its borders on the background and the holes of the
+ * depth are ignored.
+ */
+class RealSenseDepth : public Input::DepthLookup
+{
+public:
+  RealSenseDepth(
+    const rs2::depth_frame & frame, bool aligned, const rs2_intrinsics & color_intrinsics,
+    const rs2_intrinsics & depth_intrinsics, const rs2_extrinsics & color_to_depth,
+    const rs2_extrinsics & depth_to_color, float depth_scale)
+  : frame_(frame), aligned_(aligned), color_intrinsics_(color_intrinsics),
+    depth_intrinsics_(depth_intrinsics), color_to_depth_(color_to_depth),
+    depth_to_color_(depth_to_color), depth_scale_(depth_scale) {}
+
+  bool locate(const cv::Rect & roi, cv::Point3f * position) const override
+  {
+    auto data = static_cast<const uint16_t *>(frame_.get_data());
+    int width = frame_.get_width();
+    int height = frame_.get_height();
+    cv::Rect central(roi.x + roi.width / 4, roi.y + roi.height / 4,
+      std::max(1, roi.width / 2), std::max(1, roi.height / 2));
+    cv::Rect box = central;
+    if (!aligned_) {
+      // the corners of the region in the depth image, searched along their epipolar lines
+      cv::Rect2f mapped;
+      for (int corner = 0; corner < 4; corner++) {
+        float from[2] = {
+          static_cast<float>(corner % 2 ? central.br().x : central.x),
+          static_cast<float>(corner / 2 ? central.br().y : central.y)};
+        float to[2];
+        rs2_project_color_pixel_to_depth_pixel(to, data, depth_scale_, kMinDepth, kMaxDepth,
+          &depth_intrinsics_, &color_intrinsics_, &color_to_depth_, &depth_to_color_, from);
+        cv::Rect2f point(to[0], to[1], 0, 0);
+        mapped = corner == 0 ? point : (mapped | point);
+      }
+      box = cv::Rect(cv::Point(mapped.tl()), cv::Point(mapped.br()) + cv::Point(1, 1));
+    }
+    box &= cv::Rect(0, 0, width, height);
+    if (box.area() <= 0) {
+      return false;
+    }
+
+    // at most kSamples x kSamples depths, enough for a stable median
+    int step_x = std::max(1, box.width / kSamples);
+    int step_y = std::max(1, box.height / kSamples);
+    size_t stride = frame_.get_stride_in_bytes() / sizeof(uint16_t);
+    thread_local std::vector<uint16_t> samples;
+    samples.clear();
+    for (int y = box.y; y < box.br().y; y += step_y) {
+      const uint16_t * row = data + y * stride;
+      for (int x = box.x; x < box.br().x; x += step_x) {
+        if (row[x] != 0) {
+          samples.push_back(row[x]);
+        }
+      }
+    }
+    if (samples.empty()) {
+      return false;
+    }
+    auto median = samples.begin() + samples.size() / 2;
+    std::nth_element(samples.begin(), median, samples.end());
+
+    float pixel[2] = {roi.x + roi.width / 2.0f, roi.y + roi.height / 2.0f};
+    float point[3];
+    rs2_deproject_pixel_to_point(point, &color_intrinsics_, pixel, *median * depth_scale_);
+    *position = cv::Point3f(point[0], point[1], point[2]);
+    return true;
+  }
+
+private:
+  static constexpr int kSamples = 32;
+  static constexpr float kMinDepth = 0.1f;
+  static constexpr float kMaxDepth = 10.0f;
+
+  rs2::depth_frame frame_;
+  bool aligned_;
+  rs2_intrinsics color_intrinsics_;
+  rs2_intrinsics depth_intrinsics_;
+  rs2_extrinsics color_to_depth_;
+  rs2_extrinsics depth_to_color_;
+  float depth_scale_;
+};
+}  // namespace
+
+std::set<std::string> Input::RealSenseCamera::claimed_serials_;
+std::mutex Input::RealSenseCamera::claimed_mutex_;
 
 // RealSenseCamera
+Input::RealSenseCamera::RealSenseCamera(const std::string & meta)
+{
+  for (auto & item : parseInputMeta(meta, "serial")) {
+    auto & key = item.first;
+    auto & value = item.second;
+    try {
+      if (key == "serial") {
+        serial_ = value;
+      } else if (key == "width") {
+        width_ = std::stoul(value);
+      } else if (key == "height") {
+        height_ = std::stoul(value);
+      } else if (key == "fps") {
+        fps_ = std::stoi(value);
+      } else if (key == "depth") {
+        depth_ = value == "true" || value == "1";
+      } else if (key == "align") {
+        align_ = value == "true" || value == "1";
+        depth_ = depth_ || align_;
+      } else if (key == "format") {
+        if (value == "RGB8") {
+          format_ = RS2_FORMAT_RGB8;
+        } else if (value != "BGR8") {
+          slog::warn << "Unsupported RealSense color format " << value <<
+            ", using BGR8" << slog::endl;
+        }
+      } else {
+        slog::warn << "Unknown RealSense camera parameter: " << key << slog::endl;
+      }
+    } catch (const std::exception &) {
+      slog::warn << "Invalid RealSense camera parameter: " << key << "=" << value << slog::endl;
+    }
+  }
+}
+
 bool Input::RealSenseCamera::initialize()
 {
-  return initialize(640, 480);
+  return initialize(width_, height_);
 }
 
 bool Input::RealSenseCamera::initialize(size_t width, size_t height)
 {
-  if (3 * width != 4 * height) {
-    slog::err << "The aspect ratio must be 4:3 when using RealSense camera" << slog::endl;
-    throw std::runtime_error("The aspect ratio must be 4:3 when using RealSense camera!");
-    return false;
+  if (isInit()) {
+    return true;
   }
 
-  auto devSerialNumber = getCameraSN();
-  slog::info << "RealSense Serial number : " << devSerialNumber << slog::endl;
+  auto devSerialNumber = claimCamera();
+  if (devSerialNumber.empty()) {
+    setInitStatus(false);
+    return false;
+  }
+  slog::info << "RealSense Serial number : " << devSerialNumber << ", " << width << "x" <<
+    height << "@" << fps_ << slog::endl;
 
   cfg_.enable_device(devSerialNumber);
   cfg_.enable_stream(RS2_STREAM_COLOR, static_cast<int>(width), static_cast<int>(height),
-    RS2_FORMAT_BGR8, 30);
+    format_, fps_);
+  if (depth_) {
+    // the default resolution of the camera, the depths are mapped to the color pixels
+    cfg_.enable_stream(RS2_STREAM_DEPTH, RS2_FORMAT_Z16, fps_);
+  }
 
-  setInitStatus(pipe_.start(cfg_));
+  try {
+    auto profile = pipe_.start(cfg_);
+    if (depth_) {
+      auto color = profile.get_stream(RS2_STREAM_COLOR).as<rs2::video_stream_profile>();
+      auto depth = profile.get_stream(RS2_STREAM_DEPTH).as<rs2::video_stream_profile>();
+      color_intrinsics_ = color.get_intrinsics();
+      depth_intrinsics_ = align_ ? color_intrinsics_ : depth.get_intrinsics();
+      color_to_depth_ = color.get_extrinsics_to(depth);
+      depth_to_color_ = depth.get_extrinsics_to(color);
+      depth_scale_ = profile.get_device().first<rs2::depth_sensor>().get_depth_scale();
+      if (align_) {
+        aligner_ = std::make_unique<rs2::align>(RS2_STREAM_COLOR);
+      }
+    }
+    setInitStatus(true);
+  } catch (const rs2::error & e) {
+    // e.g. the resolution or the frame rate is not supported by the camera
+    slog::err << "Failed to start the RealSense camera " << devSerialNumber << ": " <<
+      e.what() << slog::endl;
+    releaseCamera();
+    setInitStatus(false);
+    return false;
+  }
   setWidth(width);
   setHeight(height);
 
   //bypass RealSense's bug: several captured frames after HW is inited are with wrong data.
   bypassFewFramesOnceInited();
 
+  if (isInit() && !capturing_) {
+    capturing_ = true;
+    capture_thread_ = std::thread(&RealSenseCamera::capture, this);
+  }
   return isInit();
 }
 
+Input::RealSenseCamera::~RealSenseCamera()
+{
+  capturing_ = false;
+  if (capture_thread_.joinable()) {
+    capture_thread_.join();
+  }
+  if (isInit()) {
+    pipe_.stop();
+  }
+  releaseCamera();
+}
+
+void Input::RealSenseCamera::capture()
+{
+  while (capturing_) {
+    rs2::frameset data;
+    try {
+      if (!pipe_.try_wait_for_frames(&data, 100)) {
+        continue;
+      }
+    } catch (const rs2::error & e) {
+      slog::err << "Failed to capture from the RealSense camera: " << e.what() << slog::endl;
+      break;
+    }
+    if (depth_) {
+      // the whole frameset is queued, so that the depth goes with its color frame
+      if (aligner_ != nullptr) {
+        data = aligner_->process(data);
+      }
+      if (data.get_color_frame() && data.get_depth_frame()) {
+        queue_.enqueue(data);
+      }
+      continue;
+    }
+    rs2::frame color_frame = data.get_color_frame();
+    if (color_frame) {
+      queue_.enqueue(color_frame);
+    }
+  }
+}
+
+bool Input::RealSenseCamera::waitForFrame(const std::chrono::milliseconds & timeout)
+{
+  if (!isInit()) {
+    return false;
+  }
+  if (!pending_) {
+    queue_.try_wait_for_frame(&pending_, static_cast<unsigned int>(timeout.count()));
+  }
+  return static_cast<bool>(pending_);
+}
+
 bool Input::RealSenseCamera::read(cv::Mat * frame)
 {
   if (!isInit()) {
     return false;
   }
 
- try {
-    rs2::frameset data = pipe_.wait_for_frames();  // Wait for next set of frames from the camera
-    rs2::frame color_frame;
-    color_frame = data.get_color_frame();
+  try {
+    rs2::frame color_frame = pending_ ? pending_ : queue_.wait_for_frame();
+    pending_ = rs2::frame();
+    if (auto frameset = color_frame.as<rs2::frameset>()) {
+      depth_frame_ = std::make_shared<RealSenseDepth>(frameset.get_depth_frame(), align_,
+          color_intrinsics_, depth_intrinsics_, color_to_depth_, depth_to_color_, depth_scale_);
+      color_frame = frameset.get_color_frame();
+    }
 
-    cv::Mat(cv::Size(static_cast<int>(getWidth()), static_cast<int>(getHeight())), CV_8UC3,
-      const_cast<void *>(color_frame.get_data()), cv::Mat::AUTO_STEP)
-      .copyTo(*frame);
+    // the pixels stay in the librealsense frame, which is kept by the Mat
+    cv::Mat pixels(cv::Size(static_cast<int>(getWidth()), static_cast<int>(getHeight())), CV_8UC3,
+      const_cast<void *>(color_frame.get_data()), cv::Mat::AUTO_STEP);
+    if (format_ == RS2_FORMAT_BGR8) {
+      *frame = FramePool::wrap(pixels, std::make_shared<rs2::frame>(color_frame));
+    } else {
+      // the inferences expect BGR frames
+      *frame = FramePool::create(pixels.size(), CV_8UC3);
+      cv::cvtColor(pixels, *frame, cv::COLOR_RGB2BGR);
+    }
   } catch (...) {
     return false;
   }
@@ -72,18 +302,50 @@ bool Input::RealSenseCamera::read(cv::Mat * frame)
   return true;
 }
 
-std::string Input::RealSenseCamera::getCameraSN()
+std::string Input::RealSenseCamera::claimCamera()
 {
-  static int rscamera_count = 0;
+  std::lock_guard<std::mutex> lk(claimed_mutex_);
+  if (claimed_) {
+    return serial_;
+  }
   // Get all devices connected
   rs2::context cxt;
-  auto device = cxt.query_devices();
-  size_t device_count = device.size();
-  slog::info << "Find RealSense num:" << device_count << slog::endl;
-  auto hardware = device[rscamera_count];
-  auto devSerialNumber = hardware.get_info(RS2_CAMERA_INFO_SERIAL_NUMBER);
-  rscamera_count++;
-  return devSerialNumber;
+  auto devices = cxt.query_devices();
+  slog::info << "Find RealSense num:" << devices.size() << slog::endl;
+  std::string found;
+  for (auto && device : devices) {
+    std::string serial = device.get_info(RS2_CAMERA_INFO_SERIAL_NUMBER);
+    if (claimed_serials_.count(serial) > 0) {
+      continue;
+    }
+    if (serial_.empty() || serial == serial_) {
+      found = serial;
+      break;
+    }
+  }
+
+  if (found.empty()) {
+    if (serial_.empty()) {
+      slog::err << "No free RealSense camera is connected" << slog::endl;
+    } else {
+      slog::err << "RealSense camera " << serial_ << " is not connected or already in use" <<
+        slog::endl;
+    }
+    return found;
+  }
+  claimed_serials_.insert(found);
+  serial_ = found;
+  claimed_ = true;
+  return found;
+}
+
+void Input::RealSenseCamera::releaseCamera()
+{
+  std::lock_guard<std::mutex> lk(claimed_mutex_);
+  if (claimed_) {
+    claimed_serials_.erase(serial_);
+    claimed_ = false;
+  }
 }
 
 void Input::RealSenseCamera::bypassFewFramesOnceInited()
@@ -16,7 +16,65 @@
  * @brief a header file with declaration of StandardCamera class
  * @file standard_camera.cpp
  */
+#include <poll.h>
+#include <sys/mman.h>
+#include <algorithm>
+#include <cerrno>
+#include <map>
+#include <string>
+
+#include "dynamic_vino_lib/inputs/input_meta.hpp"
 #include "dynamic_vino_lib/inputs/standard_camera.hpp"
+#include "dynamic_vino_lib/slog.hpp"
+#include "dynamic_vino_lib/utils/frame_pool.hpp"
+
+namespace
+{
+int xioctl(int fd, unsigned long request, void * arg)  // NOLINT(runtime/int)
+{
+  int r;
+  do {
+    r = ioctl(fd, request, arg);
+  } while (r == -1 && errno == EINTR);
+  return r;
+}
+}  // namespace
+
+Input::StandardCamera::StandardCamera(const std::string & meta)
+{
+  auto values = parseInputMeta(meta, "device");
+  // the meta may be the input_path of other inputs of the pipeline
+  if (values["device"].compare(0, 10, "/dev/video") == 0) {
+    device_ = values["device"];
+  }
+  static const std::map<std::string, uint32_t> formats = {
+    {"mjpeg", V4L2_PIX_FMT_MJPEG}, {"yuyv", V4L2_PIX_FMT_YUYV}};
+  auto format = values.find("format");
+  if (format != values.end()) {
+    auto it = formats.find(format->second);
+    if (it != formats.end()) {
+      pixel_format_ = it->second;
+    } else {
+      slog::warn << "Unknown StandardCamera format " << format->second <<
+        ", using cv::VideoCapture" << slog::endl;
+    }
+  }
+  try {
+    if (!values["fps"].empty()) {
+      fps_ = std::max(0, std::stoi(values["fps"]));
+    }
+    if (!values["queue_size"].empty()) {
+      queue_size_ = std::max(2, std::stoi(values["queue_size"]));
+    }
+  } catch (const std::exception &) {
+    slog::warn << "Invalid StandardCamera options: " << meta << slog::endl;
+  }
+}
+
+Input::StandardCamera::~StandardCamera()
+{
+  closeV4L2();
+}
 
 bool Input::StandardCamera::initialize()
 {
@@ -25,10 +83,18 @@ bool Input::StandardCamera::initialize()
 
 bool Input::StandardCamera::initialize(size_t width, size_t height)
 {
+  if (pixel_format_ != 0) {
+    closeV4L2();
+    setInitStatus(openV4L2(width, height));
+    return isInit();
+  }
   auto id = getCameraId();
   setInitStatus(cap.open(id));
   cap.set(cv::CAP_PROP_FRAME_WIDTH, width);
   cap.set(cv::CAP_PROP_FRAME_HEIGHT, height);
+  if (fps_ > 0) {
+    cap.set(cv::CAP_PROP_FPS, fps_);
+  }
   setWidth(width);
   setHeight(height);
 
@@ -40,9 +106,195 @@ bool Input::StandardCamera::read(cv::Mat * frame)
   if (!isInit()) {
     return false;
   }
-  cap.grab();
+  if (pixel_format_ == 0) {
+    cap.grab();
+    setHeader("standard_camera_frame");
+    return cap.retrieve(*frame);
+  }
+  std::unique_lock<std::mutex> lk(mutex_);
+  has_frame_.wait(lk, [this] {return !latest_.empty() || !capturing_;});
+  if (latest_.empty()) {
+    return false;
+  }
+  *frame = latest_;
+  latest_.release();
+  if (std::chrono::steady_clock::now() - latest_time_ > frame_interval_) {
+    late_frames_++;
+  }
   setHeader("standard_camera_frame");
-  return cap.retrieve(*frame);
+  return true;
+}
+
+bool Input::StandardCamera::waitForFrame(const std::chrono::milliseconds & timeout)
+{
+  if (!isInit()) {
+    return false;
+  }
+  if (pixel_format_ == 0) {
+    return true;
+  }
+  std::unique_lock<std::mutex> lk(mutex_);
+  return has_frame_.wait_for(lk, timeout, [this] {return !latest_.empty() || !capturing_;}) &&
+         !latest_.empty();
+}
+
+bool Input::StandardCamera::openV4L2(size_t width, size_t height)
+{
+  if (device_.empty()) {
+    device_ = "/dev/video" + std::to_string(getCameraId());
+  }
+  fd_ = open(device_.c_str(), O_RDWR | O_NONBLOCK);
+  if (fd_ < 0) {
+    slog::err << "Failed to open " << device_ << slog::endl;
+    return false;
+  }
+
+  struct v4l2_format fmt = {};
+  fmt.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+  fmt.fmt.pix.width = width;
+  fmt.fmt.pix.height = height;
+  fmt.fmt.pix.pixelformat = pixel_format_;
+  fmt.fmt.pix.field = V4L2_FIELD_NONE;
+  if (xioctl(fd_, VIDIOC_S_FMT, &fmt) < 0 || fmt.fmt.pix.pixelformat != pixel_format_) {
+    slog::err << device_ << " does not capture the requested format" << slog::endl;
+    closeV4L2();
+    return false;
+  }
+  // the driver picks the nearest size it supports
+  setWidth(fmt.fmt.pix.width);
+  setHeight(fmt.fmt.pix.height);
+  bytes_per_line_ = fmt.fmt.pix.bytesperline;
+
+  struct v4l2_streamparm parm = {};
+  parm.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+  if (fps_ > 0) {
+    parm.parm.capture.timeperframe.numerator = 1;
+    parm.parm.capture.timeperframe.denominator = fps_;
+    xioctl(fd_, VIDIOC_S_PARM, &parm);
+  }
+  if (xioctl(fd_, VIDIOC_G_PARM, &parm) == 0 &&
+    parm.parm.capture.timeperframe.denominator > 0)
+  {
+    frame_interval_ = std::chrono::microseconds(
+      1000000LL * parm.parm.capture.timeperframe.numerator /
+      parm.parm.capture.timeperframe.denominator);
+  }
+
+  struct v4l2_requestbuffers req = {};
+  req.count = queue_size_;
+  req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+  req.memory = V4L2_MEMORY_MMAP;
+  if (xioctl(fd_, VIDIOC_REQBUFS, &req) < 0 || req.count < 2) {
+    slog::err << "Failed to request the mmap buffers of " << device_ << slog::endl;
+    closeV4L2();
+    return false;
+  }
+  for (uint32_t i = 0; i < req.count; i++) {
+    struct v4l2_buffer buf = {};
+    buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    buf.memory = V4L2_MEMORY_MMAP;
+    buf.index = i;
+    if (xioctl(fd_, VIDIOC_QUERYBUF, &buf) < 0) {
+      closeV4L2();
+      return false;
+    }
+    void * start = mmap(nullptr, buf.length, PROT_READ | PROT_WRITE, MAP_SHARED, fd_,
+        buf.m.offset);
+    if (start == MAP_FAILED || xioctl(fd_, VIDIOC_QBUF, &buf) < 0) {
+      if (start != MAP_FAILED) {
+        munmap(start, buf.length);
+      }
+      closeV4L2();
+      return false;
+    }
+    buffers_.emplace_back(start, buf.length);
+  }
+  v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+  if (xioctl(fd_, VIDIOC_STREAMON, &type) < 0) {
+    slog::err << "Failed to start streaming " << device_ << slog::endl;
+    closeV4L2();
+    return false;
+  }
+  slog::info << "Capturing " << device_ << " at " << getWidth() << "x" << getHeight() <<
+    " with " << buffers_.size() << " buffers" << slog::endl;
+  capturing_ = true;
+  capture_thread_ = std::thread(&StandardCamera::capture, this);
+  return true;
+}
+
+void Input::StandardCamera::closeV4L2()
+{
+  capturing_ = false;
+  if (capture_thread_.joinable()) {
+    capture_thread_.join();
+  }
+  if (fd_ < 0) {
+    return;
+  }
+  v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+  xioctl(fd_, VIDIOC_STREAMOFF, &type);
+  for (auto & buffer : buffers_) {
+    munmap(buffer.first, buffer.second);
+  }
+  buffers_.clear();
+  close(fd_);
+  fd_ = -1;
+}
+
+void Input::StandardCamera::capture()
+{
+  while (capturing_) {
+    struct pollfd pfd = {fd_, POLLIN, 0};
+    int ready = poll(&pfd, 1, 100);
+    if (ready < 0 && errno != EINTR) {
+      slog::err << "Failed to poll " << device_ << slog::endl;
+      break;
+    }
+    struct v4l2_buffer buf = {};
+    buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    buf.memory = V4L2_MEMORY_MMAP;
+    if (ready <= 0 || xioctl(fd_, VIDIOC_DQBUF, &buf) < 0) {
+      continue;
+    }
+    // skip to the newest buffer filled meanwhile, the older ones are stale
+    struct v4l2_buffer next = buf;
+    while (xioctl(fd_, VIDIOC_DQBUF, &next) == 0) {
+      xioctl(fd_, VIDIOC_QBUF, &buf);
+      dropped_frames_++;
+      buf = next;
+    }
+    cv::Mat frame = decode(buffers_[buf.index].first, buf.bytesused);
+    xioctl(fd_, VIDIOC_QBUF, &buf);
+    if (frame.empty()) {
+      continue;
+    }
+    {
+      std::lock_guard<std::mutex> lk(mutex_);
+      if (!latest_.empty()) {
+        dropped_frames_++;
+      }
+      latest_ = frame;
+      latest_time_ = std::chrono::steady_clock::now();
+    }
+    has_frame_.notify_all();
+  }
+  capturing_ = false;
+  has_frame_.notify_all();
+}
+
+cv::Mat Input::StandardCamera::decode(const void * data, size_t bytes)
+{
+  cv::Mat frame;
+  FramePool::attach(frame);
+  void * pixels = const_cast<void *>(data);
+  if (pixel_format_ == V4L2_PIX_FMT_MJPEG) {
+    // decoded by the libjpeg(-turbo) of OpenCV, corrupt frames give an empty Mat
+    cv::imdecode(cv::Mat(1, static_cast<int>(bytes), CV_8UC1, pixels), cv::IMREAD_COLOR, &frame);
+  } else {
+    cv::Mat yuyv(getHeight(), getWidth(), CV_8UC2, pixels, bytes_per_line_);
+    cv::cvtColor(yuyv, frame, cv::COLOR_YUV2BGR_YUYV);
+  }
+  return frame;
 }
 
 int Input::StandardCamera::getCameraId()
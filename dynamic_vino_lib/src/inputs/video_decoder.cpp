@@ -0,0 +1,336 @@
+// Copyright (c) 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @brief a header file with declaration of VideoDecoder class
+ * @file video_decoder.cpp
+ */
+
+#include <opencv2/core/ocl.hpp>
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "dynamic_vino_lib/inputs/video_decoder.hpp"
+#include "dynamic_vino_lib/slog.hpp"
+#include "dynamic_vino_lib/utils/frame_pool.hpp"
+
+// CAP_PROP_HW_ACCELERATION is available since OpenCV 4.5.2
+#if CV_VERSION_MAJOR > 4 || (CV_VERSION_MAJOR == 4 && (CV_VERSION_MINOR > 5 || \
+  (CV_VERSION_MINOR == 5 && CV_VERSION_REVISION >= 2)))
+#define VIDEO_DECODER_HAS_HW_ACCELERATION
+#endif
+// CAP_PROP_HW_ACCELERATION_USE_OPENCL since OpenCV 4.5.3
+#if CV_VERSION_MAJOR > 4 || (CV_VERSION_MAJOR == 4 && (CV_VERSION_MINOR > 5 || \
+  (CV_VERSION_MINOR == 5 && CV_VERSION_REVISION >= 3)))
+#define VIDEO_DECODER_HAS_HW_OPENCL
+#endif
+
+Input::VideoDecoder::Options
+Input::VideoDecoder::parseOptions(
+  const std::map<std::string, std::string> & meta, const Options & defaults)
+{
+  Options options = defaults;
+  auto it = meta.find("queue_size");
+  if (it != meta.end()) {
+    try {
+      options.queue_size = std::max(1, std::stoi(it->second));
+    } catch (const std::exception &) {
+      slog::warn << "Invalid queue_size: " << it->second << slog::endl;
+    }
+  }
+  it = meta.find("hw_decode");
+  if (it != meta.end()) {
+    options.hw_decode = it->second;
+  }
+  it = meta.find("hw_opencl");
+  if (it != meta.end()) {
+    options.hw_opencl = it->second == "true" || it->second == "1";
+  }
+  it = meta.find("pacing");
+  if (it != meta.end()) {
+    if (it->second == "realtime") {
+      options.realtime = true;
+    } else if (it->second != "fast") {
+      slog::warn << "Unknown pacing " << it->second << ", using fast" << slog::endl;
+    }
+  }
+  it = meta.find("reconnect");
+  if (it != meta.end()) {
+    options.reconnect = it->second == "true" || it->second == "1";
+  }
+  it = meta.find("max_backoff_ms");
+  if (it != meta.end()) {
+    try {
+      options.max_backoff_ms = std::max(100, std::stoi(it->second));
+    } catch (const std::exception &) {
+      slog::warn << "Invalid max_backoff_ms: " << it->second << slog::endl;
+    }
+  }
+  return options;
+}
+
+uint64_t Input::VideoDecoder::countFrames(const std::string & source)
+{
+  cv::VideoCapture cap(source);
+  double frames = cap.isOpened() ? cap.get(cv::CAP_PROP_FRAME_COUNT) : 0;
+  return frames > 0 ? static_cast<uint64_t>(frames) : 0;
+}
+
+Input::VideoDecoder::VideoDecoder(const Options & options)
+: options_(options)
+{
+  options_.queue_size = std::max<size_t>(1, options_.queue_size);
+}
+
+Input::VideoDecoder::~VideoDecoder()
+{
+  close();
+}
+
+bool Input::VideoDecoder::openCapture(const std::string & source)
+{
+  opencl_retrieve_ = false;
+  if (options_.hw_decode == "none") {
+    return cap_.open(source);
+  }
+#ifdef VIDEO_DECODER_HAS_HW_ACCELERATION
+  static const std::map<std::string, int> accelerations = {
+    {"any", cv::VIDEO_ACCELERATION_ANY},
+    {"vaapi", cv::VIDEO_ACCELERATION_VAAPI},
+    {"mfx", cv::VIDEO_ACCELERATION_MFX},
+    {"d3d11", cv::VIDEO_ACCELERATION_D3D11},
+  };
+  auto it = accelerations.find(options_.hw_decode);
+  if (it == accelerations.end()) {
+    slog::warn << "Unknown hw_decode " << options_.hw_decode << ", using software decode" <<
+      slog::endl;
+    return cap_.open(source);
+  }
+  std::vector<int> params = {cv::CAP_PROP_HW_ACCELERATION, it->second};
+#ifdef VIDEO_DECODER_HAS_HW_OPENCL
+  if (options_.hw_opencl && cv::ocl::haveOpenCL()) {
+    params.push_back(cv::CAP_PROP_HW_ACCELERATION_USE_OPENCL);
+    params.push_back(1);
+  }
+#endif
+  if (cap_.open(source, cv::CAP_ANY, params)) {
+#ifdef VIDEO_DECODER_HAS_HW_OPENCL
+    opencl_retrieve_ = options_.hw_opencl &&
+      cap_.get(cv::CAP_PROP_HW_ACCELERATION_USE_OPENCL) > 0;
+#endif
+    slog::info << "Hardware decode of " << source << ": " <<
+      cap_.get(cv::CAP_PROP_HW_ACCELERATION) <<
+      (opencl_retrieve_ ? ", converted through OpenCL" : "") << slog::endl;
+    if (options_.hw_opencl && !opencl_retrieve_) {
+      slog::warn << "No OpenCL interop for the decode of " << source <<
+        ", the surfaces are converted on the CPU" << slog::endl;
+    }
+    return true;
+  }
+  slog::warn << "Failed to open " << source << " with hardware decode, " <<
+    "falling back to software decode" << slog::endl;
+#else
+  slog::warn << "Hardware decode needs OpenCV 4.5.2 or later, using software decode" <<
+    slog::endl;
+#endif
+  return cap_.open(source);
+}
+
+bool Input::VideoDecoder::open(const std::string & source, size_t width, size_t height)
+{
+  close();
+  source_ = source;
+  requested_size_ = cv::Size(static_cast<int>(width), static_cast<int>(height));
+  if (!openCapture(source)) {
+    return false;
+  }
+  configureCapture();
+  // the backend seeks to the keyframe before the frame, and decodes up to it
+  if (options_.start_frame > 0 &&
+    !cap_.set(cv::CAP_PROP_POS_FRAMES, static_cast<double>(options_.start_frame)))
+  {
+    slog::err << "Failed to seek " << source << " to frame " << options_.start_frame <<
+      slog::endl;
+    cap_.release();
+    return false;
+  }
+  next_position_ = options_.start_frame;
+  end_of_stream_ = false;
+
+  decoding_ = true;
+  decode_thread_ = std::thread(&VideoDecoder::decode, this);
+  return true;
+}
+
+void Input::VideoDecoder::configureCapture()
+{
+  if (requested_size_.area() > 0) {
+    cap_.set(cv::CAP_PROP_FRAME_WIDTH, requested_size_.width);
+    cap_.set(cv::CAP_PROP_FRAME_HEIGHT, requested_size_.height);
+  }
+  if (options_.drop_oldest) {
+    // keep the backend from buffering, where supported, the queue drains to the newest frame
+    cap_.set(cv::CAP_PROP_BUFFERSIZE, 1);
+  }
+  frame_size_ = cv::Size(static_cast<int>(cap_.get(cv::CAP_PROP_FRAME_WIDTH)),
+      static_cast<int>(cap_.get(cv::CAP_PROP_FRAME_HEIGHT)));
+  fps_ = cap_.get(cv::CAP_PROP_FPS);
+  start_msec_ = -1;
+}
+
+bool Input::VideoDecoder::reconnect()
+{
+  int backoff_ms = 100;
+  while (decoding_) {
+    slog::warn << "Lost " << source_ << ", reconnecting in " << backoff_ms << " ms" << slog::endl;
+    {
+      std::unique_lock<std::mutex> lk(mutex_);
+      not_full_.wait_for(lk, std::chrono::milliseconds(backoff_ms), [this] {return !decoding_;});
+    }
+    if (!decoding_) {
+      break;
+    }
+    cap_.release();
+    if (openCapture(source_) && cap_.isOpened()) {
+      configureCapture();
+      ++reconnects_;
+      slog::info << "Reconnected to " << source_ << slog::endl;
+      return true;
+    }
+    backoff_ms = std::min(backoff_ms * 2, options_.max_backoff_ms);
+  }
+  return false;
+}
+
+void Input::VideoDecoder::close()
+{
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    decoding_ = false;
+  }
+  not_full_.notify_all();
+  if (decode_thread_.joinable()) {
+    decode_thread_.join();
+  }
+  std::lock_guard<std::mutex> lk(mutex_);
+  queue_.clear();
+  end_of_stream_ = true;
+  not_empty_.notify_all();
+  if (cap_.isOpened()) {
+    cap_.release();
+  }
+}
+
+void Input::VideoDecoder::pace(uint64_t index)
+{
+  double msec = cap_.get(cv::CAP_PROP_POS_MSEC);
+  if (msec <= 0 && fps_ > 0) {
+    msec = index * 1000.0 / fps_;
+  }
+  if (start_msec_ < 0) {
+    start_msec_ = msec;
+    start_time_ = std::chrono::steady_clock::now();
+    return;
+  }
+  auto due = start_time_ + std::chrono::microseconds(
+    static_cast<int64_t>((msec - start_msec_) * 1000));
+  std::this_thread::sleep_until(due);
+}
+
+void Input::VideoDecoder::decode()
+{
+  uint64_t index = 0;
+  while (decoding_ && (options_.frame_count == 0 || index < options_.frame_count)) {
+    cv::Mat frame;
+    FramePool::attach(frame);
+    bool retrieved = cap_.grab();
+    if (retrieved && opencl_retrieve_) {
+      // the surface is converted to BGR on the GPU, only the BGR frame is copied back
+      retrieved = cap_.retrieve(surface_) && !surface_.empty();
+      if (retrieved) {
+        surface_.copyTo(frame);
+      }
+    } else if (retrieved) {
+      retrieved = cap_.retrieve(frame);
+    }
+    if (!retrieved || frame.empty()) {
+      if (options_.reconnect && reconnect()) {
+        continue;
+      }
+      break;
+    }
+    if (options_.realtime) {
+      pace(index);
+    }
+    index++;
+
+    std::unique_lock<std::mutex> lk(mutex_);
+    if (options_.drop_oldest) {
+      while (queue_.size() >= options_.queue_size) {
+        queue_.pop_front();
+        ++dropped_frames_;
+      }
+    } else {
+      not_full_.wait(lk, [this] {return !decoding_ || queue_.size() < options_.queue_size;});
+      if (!decoding_) {
+        break;
+      }
+    }
+    queue_.emplace_back(frame, std::chrono::steady_clock::now());
+    lk.unlock();
+    not_empty_.notify_one();
+  }
+
+  std::lock_guard<std::mutex> lk(mutex_);
+  end_of_stream_ = true;
+  not_empty_.notify_all();
+}
+
+bool Input::VideoDecoder::read(cv::Mat * frame)
+{
+  std::unique_lock<std::mutex> lk(mutex_);
+  not_empty_.wait(lk, [this] {return !queue_.empty() || end_of_stream_;});
+  if (queue_.empty()) {
+    return false;
+  }
+  auto decoded = queue_.front();
+  queue_.pop_front();
+  lk.unlock();
+  *frame = decoded.first;
+  read_position_ = next_position_++;
+  if (options_.drop_oldest && fps_ > 0) {
+    auto age = std::chrono::steady_clock::now() - decoded.second;
+    if (age > std::chrono::microseconds(static_cast<int64_t>(1e6 / fps_))) {
+      ++late_frames_;
+    }
+  }
+  not_full_.notify_one();
+  return true;
+}
+
+bool Input::VideoDecoder::waitForFrame(const std::chrono::milliseconds & timeout)
+{
+  std::unique_lock<std::mutex> lk(mutex_);
+  not_empty_.wait_for(lk, timeout, [this] {return !queue_.empty() || end_of_stream_;});
+  // at the end of the stream read() returns immediately
+  return !queue_.empty() || end_of_stream_;
+}
+
+bool Input::VideoDecoder::isExhausted()
+{
+  std::lock_guard<std::mutex> lk(mutex_);
+  return end_of_stream_ && queue_.empty();
+}
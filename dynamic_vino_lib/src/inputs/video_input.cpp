@@ -17,21 +17,65 @@
  * @file video_input.cpp
  */
 
+#include <algorithm>
 #include <string>
 
+#include "dynamic_vino_lib/inputs/input_meta.hpp"
 #include "dynamic_vino_lib/inputs/video_input.hpp"
+#include "dynamic_vino_lib/slog.hpp"
 
 // Video
-Input::Video::Video(const std::string & video)
+Input::Video::Video(const std::string & meta)
 {
-  video_.assign(video);
+  auto values = parseInputMeta(meta, "path");
+  video_.assign(values["path"]);
+  options_ = VideoDecoder::parseOptions(values);
+  try {
+    if (!values["segments"].empty()) {
+      segments_ = std::max<size_t>(1, std::stoul(values["segments"]));
+    }
+  } catch (const std::exception &) {
+    slog::warn << "Invalid Video segments: " << meta << slog::endl;
+  }
+}
+
+bool Input::Video::open(size_t width, size_t height)
+{
+  decoders_.clear();
+  next_segment_ = 0;
+  size_t segments = segments_;
+  uint64_t frames = segments > 1 ? VideoDecoder::countFrames(video_) : 0;
+  if (segments > 1 && frames < segments) {
+    slog::warn << "Unknown number of frames in " << video_ << ", decoding it as one segment" <<
+      slog::endl;
+    segments = 1;
+  }
+  for (size_t segment = 0; segment < segments; segment++) {
+    auto options = options_;
+    if (segments > 1) {
+      options.start_frame = frames * segment / segments;
+      options.frame_count = frames * (segment + 1) / segments - options.start_frame;
+    }
+    decoders_.push_back(std::make_unique<VideoDecoder>(options));
+    if (!decoders_.back()->open(video_, width, height)) {
+      decoders_.clear();
+      return false;
+    }
+  }
+  if (segments > 1) {
+    slog::info << "Decoding " << video_ << " as " << segments << " segments of " <<
+      frames / segments << " frames" << slog::endl;
+  }
+  return true;
 }
 
 bool Input::Video::initialize()
 {
-  setInitStatus(cap.open(video_));
-  setWidth((size_t)cap.get(cv::CAP_PROP_FRAME_WIDTH));
-  setHeight((size_t)cap.get(cv::CAP_PROP_FRAME_HEIGHT));
+  setInitStatus(open(0, 0));
+  if (isInit()) {
+    setWidth((size_t)decoders_.front()->getFrameSize().width);
+    setHeight((size_t)decoders_.front()->getFrameSize().height);
+  }
   return isInit();
 }
 
@@ -39,11 +83,7 @@ bool Input::Video::initialize(size_t width, size_t height)
 {
   setWidth(width);
   setHeight(height);
-  setInitStatus(cap.open(video_));
-  if (isInit()) {
-    cap.set(cv::CAP_PROP_FRAME_WIDTH, width);
-    cap.set(cv::CAP_PROP_FRAME_HEIGHT, height);
-  }
+  setInitStatus(open(width, height));
   return isInit();
 }
 
@@ -52,7 +92,39 @@ bool Input::Video::read(cv::Mat * frame)
   if (!isInit()) {
     return false;
   }
-  cap.grab();
-  setHeader("video_frame");
-  return cap.retrieve(*frame);
+  if (decoders_.size() == 1) {
+    setHeader("video_frame");
+    return decoders_.front()->read(frame);
+  }
+  // the lanes read the segments in turn, each lane reads one segment
+  auto & decoder = decoders_[next_segment_];
+  next_segment_ = (next_segment_ + 1) % decoders_.size();
+  if (!decoder->read(frame)) {
+    return false;
+  }
+  // the position of the frame in the file, by which the results are merged back
+  setHeader(video_ + "#" + std::to_string(decoder->getReadPosition()));
+  lockHeader();
+  return true;
+}
+
+bool Input::Video::waitForFrame(const std::chrono::milliseconds & timeout)
+{
+  if (!isInit()) {
+    return false;
+  }
+  return decoders_[next_segment_]->waitForFrame(timeout);
+}
+
+bool Input::Video::isExhausted()
+{
+  if (!isInit()) {
+    return false;
+  }
+  for (auto & decoder : decoders_) {
+    if (!decoder->isExhausted()) {
+      return false;
+    }
+  }
+  return true;
 }
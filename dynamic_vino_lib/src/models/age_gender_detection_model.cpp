@@ -42,7 +42,8 @@ bool Models::AgeGenderDetectionModel::updateLayerProperty(
     return false;
   }
   InferenceEngine::InputInfo::Ptr input_info = input_info_map.begin()->second;
-  input_info->setPrecision(InferenceEngine::Precision::FP32);
+  // the frame is packed as is, converted to FP32 by the plugin
+  input_info->setPrecision(InferenceEngine::Precision::U8);
   input_info->setLayout(InferenceEngine::Layout::NCHW);
   addInputInfo("input", input_info_map.begin()->first);
   // set output property
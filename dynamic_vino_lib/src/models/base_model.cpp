@@ -24,6 +24,8 @@
 #include <iostream>
 #include <unistd.h>
 #include "dynamic_vino_lib/models/base_model.hpp"
+#include "dynamic_vino_lib/engines/engine_manager.hpp"
+#include "dynamic_vino_lib/models/model_registry.hpp"
 #include "dynamic_vino_lib/slog.hpp"
 #include "dynamic_vino_lib/models/attributes/base_attribute.hpp"
 
@@ -43,19 +45,16 @@ Models::BaseModel::BaseModel(
 
 void Models::BaseModel::modelInit()
 {
-  slog::info << "Loading network files" << slog::endl;
-  // Read network model
-  ///net_reader_->ReadNetwork(model_loc_);
-  net_reader_ = engine.ReadNetwork(model_loc_);
-  // Extract model name and load it's weights
-  // remove extension
-  size_t last_index = model_loc_.find_last_of(".");
-  std::string raw_name = model_loc_.substr(0, last_index);
-  ///std::string bin_file_name = raw_name + ".bin";
-  ///net_reader_->ReadWeights(bin_file_name);
+  // the files are read once for all the models of the process using them
+  parsed_ = ModelRegistry::getInstance().get(model_loc_);
+  if (ModelRegistry::canCloneNetwork(*parsed_)) {
+    net_reader_ = ModelRegistry::cloneNetwork(*parsed_);
+  } else {
+    ///net_reader_->ReadNetwork(model_loc_);
+    net_reader_ = Engines::EngineManager::getCore().ReadNetwork(model_loc_);
+  }
   // Read labels (if any)
-  std::string label_file_name = raw_name + ".labels";
-  loadLabelsFromFile(label_file_name);
+  getLabels() = parsed_->labels;
 
   // Set batch size to given max_batch_size_
   slog::info << "Batch size is set to  " << max_batch_size_ << slog::endl;
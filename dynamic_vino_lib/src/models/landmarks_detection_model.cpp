@@ -24,39 +24,36 @@ Models::LandmarksDetectionModel::LandmarksDetectionModel(
   const std::string & model_loc, int max_batch_size)
 : BaseModel(model_loc, max_batch_size) {}
 
-void Models::LandmarksDetectionModel::setLayerProperty(
+bool Models::LandmarksDetectionModel::updateLayerProperty(
   InferenceEngine::CNNNetwork& net_reader)
 {
+  slog::info << "Checking INPUTs for model " << getModelName() << slog::endl;
   // set input property
-  InferenceEngine::InputsDataMap input_info_map(
-    net_reader.getInputsInfo());
+  InferenceEngine::InputsDataMap input_info_map(net_reader.getInputsInfo());
+  if (input_info_map.size() != 1) {
+    slog::warn << "This model seems not Landmarks-like, which should have"
+      " only one input, but we got " << std::to_string(input_info_map.size()) << " inputs"
+      << slog::endl;
+    return false;
+  }
   InferenceEngine::InputInfo::Ptr input_info = input_info_map.begin()->second;
   input_info->setPrecision(InferenceEngine::Precision::U8);
   input_info->getInputData()->setLayout(InferenceEngine::Layout::NCHW);
   // set output property
-  InferenceEngine::OutputsDataMap output_info_map(
-    net_reader.getOutputsInfo());
+  InferenceEngine::OutputsDataMap output_info_map(net_reader.getOutputsInfo());
+  if (output_info_map.size() != 1) {
+    slog::warn << "This model seems not Landmarks-like, which should have"
+      " only one output, but we got " << std::to_string(output_info_map.size()) << " outputs"
+      << slog::endl;
+    return false;
+  }
   InferenceEngine::DataPtr & output_data_ptr = output_info_map.begin()->second;
   output_data_ptr->setPrecision(InferenceEngine::Precision::FP32);
   output_data_ptr->setLayout(InferenceEngine::Layout::NCHW);
   // set input and output layer name
   input_ = input_info_map.begin()->first;
   output_ = output_info_map.begin()->first;
-}
-
-void Models::LandmarksDetectionModel::checkLayerProperty(
-  const InferenceEngine::CNNNetReader::Ptr & net_reader)
-{
-  InferenceEngine::InputsDataMap input_info_map(
-    net_reader->getNetwork().getInputsInfo());
-  if (input_info_map.size() != 1) {
-    throw std::logic_error("Landmarks Detection topology should have only one input");
-  }
-  InferenceEngine::OutputsDataMap output_info_map(
-    net_reader->getNetwork().getOutputsInfo());
-  if (output_info_map.size() != 1) {
-    throw std::logic_error("Landmarks Detection Network expects networks having one output");
-  }
+  return true;
 }
 
 const std::string Models::LandmarksDetectionModel::getModelCategory() const
@@ -0,0 +1,129 @@
+// Copyright (c) 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @brief An implementation file with implementation for ModelRegistry Class
+ * @file model_registry.cpp
+ */
+
+#include <sys/stat.h>
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#ifdef USE_NGRAPH
+#include <ngraph/graph_util.hpp>
+#endif
+
+#include "dynamic_vino_lib/models/model_registry.hpp"
+#include "dynamic_vino_lib/engines/engine_manager.hpp"
+#include "dynamic_vino_lib/slog.hpp"
+
+namespace
+{
+std::string getModifiedTime(const std::string & path)
+{
+  struct stat info;
+  return stat(path.c_str(), &info) == 0 ? std::to_string(info.st_mtime) : "";
+}
+}  // namespace
+
+Models::ModelRegistry & Models::ModelRegistry::getInstance()
+{
+  static ModelRegistry registry;
+  return registry;
+}
+
+std::string Models::ModelRegistry::getKey(const std::string & model_loc)
+{
+  std::string raw_name = model_loc.substr(0, model_loc.find_last_of("."));
+  return model_loc + "|" + getModifiedTime(model_loc) + "|" +
+         getModifiedTime(raw_name + ".bin") + "|" + getModifiedTime(raw_name + ".labels");
+}
+
+std::shared_ptr<const Models::ModelRegistry::Entry>
+Models::ModelRegistry::get(const std::string & model_loc)
+{
+  std::string key = getKey(model_loc);
+  std::shared_ptr<std::mutex> read_mutex;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto found = entries_.find(key);
+    if (found != entries_.end()) {
+      auto entry = found->second.lock();
+      if (entry != nullptr) {
+        slog::info << "Reusing the network files of " << model_loc << slog::endl;
+        return entry;
+      }
+    }
+    auto & slot = read_mutexes_[key];
+    if (slot == nullptr) {
+      slot = std::make_shared<std::mutex>();
+    }
+    read_mutex = slot;
+  }
+
+  // the models of the same files wait for the first one to read them
+  std::lock_guard<std::mutex> read_lock(*read_mutex);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto entry = entries_[key].lock();
+    if (entry != nullptr) {
+      return entry;
+    }
+  }
+  slog::info << "Loading network files" << slog::endl;
+  auto entry = std::make_shared<Entry>();
+  entry->network = Engines::EngineManager::getCore().ReadNetwork(model_loc);
+  std::string raw_name = model_loc.substr(0, model_loc.find_last_of("."));
+  std::ifstream label_file(raw_name + ".labels");
+  std::copy(std::istream_iterator<std::string>(label_file),
+    std::istream_iterator<std::string>(),
+    std::back_inserter(entry->labels));
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  // the keys of the files changed since are dropped along with their entries
+  for (auto it = entries_.begin(); it != entries_.end(); ) {
+    if (it->second.expired() && it->first != key) {
+      read_mutexes_.erase(it->first);
+      it = entries_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  entries_[key] = entry;
+  return entry;
+}
+
+bool Models::ModelRegistry::canCloneNetwork(const Entry & entry)
+{
+#ifdef USE_NGRAPH
+  return entry.network.getFunction() != nullptr;
+#else
+  return false;
+#endif
+}
+
+InferenceEngine::CNNNetwork Models::ModelRegistry::cloneNetwork(const Entry & entry)
+{
+#ifdef USE_NGRAPH
+  // the constants of the copy share the weights of the original
+  return InferenceEngine::CNNNetwork(ngraph::clone_function(*entry.network.getFunction()));
+#else
+  throw std::logic_error("Networks can't be copied without nGraph");
+#endif
+}
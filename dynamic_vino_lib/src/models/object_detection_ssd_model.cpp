@@ -16,6 +16,9 @@
  * @brief a header file with declaration of ObjectDetectionSSDModel class
  * @file object_detection_ssd_model.cpp
  */
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
 #include <string>
 #include <memory>
 #include <vector>
@@ -24,13 +27,14 @@
 #include "dynamic_vino_lib/slog.hpp"
 #include "dynamic_vino_lib/engines/engine.hpp"
 #include "dynamic_vino_lib/models/attributes/base_attribute.hpp"
+#include "dynamic_vino_lib/utils/nv12.hpp"
 
 // Validated Object Detection Network
 Models::ObjectDetectionSSDModel::ObjectDetectionSSDModel(
   const std::string & model_loc, int max_batch_size)
 : ObjectDetectionModel(model_loc, max_batch_size)
 {
-  slog::debug << "TESTING: in ObjectDetectionSSDModel" << slog::endl;
+  SLOG_DEBUG << "TESTING: in ObjectDetectionSSDModel" << slog::endl;
   //addCandidatedAttr(std::make_shared<Models::SSDModelAttr>());
 }
 
@@ -44,11 +48,51 @@ bool Models::ObjectDetectionSSDModel::enqueue(
   const cv::Mat & frame,
   const cv::Rect & input_frame_loc)
 {
-  if (!this->matToBlob(frame, input_frame_loc, 1, 0, engine)) {
+  return enqueue(engine, frame, input_frame_loc, 0);
+}
+
+bool Models::ObjectDetectionSSDModel::enqueue(
+  const std::shared_ptr<Engines::Engine> & engine,
+  const cv::Mat & frame,
+  const cv::Rect & input_frame_loc,
+  int batch_index)
+{
+  if (!this->matToBlob(frame, input_frame_loc, 1, batch_index, engine)) {
     return false;
   }
 
-  setFrameSize(frame.cols, frame.rows);
+  // frame sizes are kept per request, which may be in flight concurrently
+  setFrameSize(frame.cols, frame.rows,
+    engine->getBoundRequest() * getMaxBatchSize() + batch_index);
+  return true;
+}
+
+bool Models::ObjectDetectionSSDModel::enqueueNV12(
+  const std::shared_ptr<Engines::Engine> & engine, const cv::Mat & nv12, int batch_index)
+{
+  if (engine == nullptr) {
+    slog::err << "A frame is trying to be enqueued in a NULL Engine." << slog::endl;
+    return false;
+  }
+  std::string input_name = getInputName();
+  cv::Size size = getNV12Size(nv12);
+  if (engine->isPluginPreprocessEnabled()) {
+    if (batch_index != 0 || !engine->setInputNV12(input_name, nv12)) {
+      return false;
+    }
+  } else {
+    const Engines::InputBinding & binding = engine->getInputBinding(input_name);
+    auto & dims = binding.dims;
+    cv::Mat resized;
+    resizeNV12ToBGR(nv12, cv::Rect(cv::Point(), size),
+      cv::Size(static_cast<int>(dims[3]), static_cast<int>(dims[2])), resized);
+    if (resized.empty()) {
+      return false;
+    }
+    matU8ToBlob<u_int8_t>(resized, binding, 1, batch_index);
+  }
+  setFrameSize(size.width, size.height,
+    engine->getBoundRequest() * getMaxBatchSize() + batch_index);
   return true;
 }
 
@@ -62,68 +106,74 @@ bool Models::ObjectDetectionSSDModel::matToBlob(
   }
 
   std::string input_name = getInputName();
-  slog::debug << "add input image to blob: " << input_name << slog::endl;
-  InferenceEngine::Blob::Ptr input_blob =
-    engine->getRequest()->GetBlob(input_name);
-
-  InferenceEngine::SizeVector blob_size = input_blob->getTensorDesc().getDims();
-  const int width = blob_size[3];
-  const int height = blob_size[2];
-  const int channels = blob_size[1];
-  u_int8_t * blob_data = input_blob->buffer().as<u_int8_t *>();
-
-  cv::Mat resized_image(orig_image);
-  if (width != orig_image.size().width || height != orig_image.size().height) {
-    cv::resize(orig_image, resized_image, cv::Size(width, height));
-  }
-  int batchOffset = batch_index * width * height * channels;
-
-  for (int c = 0; c < channels; c++) {
-    for (int h = 0; h < height; h++) {
-      for (int w = 0; w < width; w++) {
-        blob_data[batchOffset + c * width * height + h * width + w] =
-          resized_image.at<cv::Vec3b>(h, w)[c] * scale_factor;
-      }
-    }
+  SLOG_DEBUG << "add input image to blob: " << input_name << slog::endl;
+  if (engine->isPluginPreprocessEnabled()) {
+    return batch_index == 0 && engine->setInputFrame(input_name, orig_image);
   }
+  // the resized frame is shared with the sibling inferences of the same size
+  matU8ToBlob<u_int8_t>(orig_image, engine->getInputBinding(input_name), scale_factor,
+    batch_index, engine->getPreprocessCache());
 
-  slog::debug << "Convert input image to blob: DONE!" << slog::endl;
+  SLOG_DEBUG << "Convert input image to blob: DONE!" << slog::endl;
   return true;
 }
 
 bool Models::ObjectDetectionSSDModel::fetchResults(
   const std::shared_ptr<Engines::Engine> & engine,
-  std::vector<dynamic_vino_lib::ObjectDetectionResult> & results,
+  dynamic_vino_lib::ObjectDetectionArena & detections_arena,
   const float & confidence_thresh,
   const bool & enable_roi_constraint)
 {
-  slog::debug << "fetching Infer Resulsts from the given SSD model" << slog::endl;
+  SLOG_DEBUG << "fetching Infer Resulsts from the given SSD model" << slog::endl;
   if (engine == nullptr) {
     slog::err << "Trying to fetch results from <null> Engines." << slog::endl;
     return false;
   }
 
-  slog::debug << "Fetching Detection Results ..." << slog::endl;
-  InferenceEngine::InferRequest::Ptr request = engine->getRequest();
+  SLOG_DEBUG << "Fetching Detection Results ..." << slog::endl;
   std::string output = getOutputName();
-  const float * detections = request->GetBlob(output)->buffer().as<float *>();
+  const float * detections = engine->getOutput(output)->cbuffer().as<const float *>();
 
-  slog::debug << "Analyzing Detection results..." << slog::endl;
+  SLOG_DEBUG << "Analyzing Detection results..." << slog::endl;
   auto max_proposal_count = getMaxProposalCount();
   auto object_size = getObjectSize();
-  slog::debug << "MaxProprosalCount=" << max_proposal_count
+  SLOG_DEBUG << "MaxProprosalCount=" << max_proposal_count
     << ", ObjectSize=" << object_size << slog::endl;
+  frame_sizes_.resize(getMaxBatchSize());
+  for (size_t batch_index = 0; batch_index < frame_sizes_.size(); batch_index++) {
+    frame_sizes_[batch_index] =
+      getFrameSize(engine->getBoundRequest() * getMaxBatchSize() + batch_index);
+  }
+  decodeDetections(detections, max_proposal_count, object_size, frame_sizes_, confidence_thresh,
+    enable_roi_constraint, detections_arena);
+
+  return true;
+}
+
+void Models::ObjectDetectionSSDModel::decodeDetections(
+  const float * detections, int max_proposal_count, int object_size,
+  const std::vector<cv::Size> & frame_sizes, float confidence_thresh,
+  bool enable_roi_constraint, dynamic_vino_lib::ObjectDetectionArena & detections_arena)
+{
   for (int i = 0; i < max_proposal_count; i++) {
     float image_id = detections[i * object_size + 0];
     if (image_id < 0) {
-      //slog::info << "Found objects: " << i << "|" << results.size() << slog::endl;
       break;
     }
 
+    float confidence = detections[i * object_size + 2];
+    if (confidence <= confidence_thresh) {
+      continue;
+    }
+
     cv::Rect r;
     auto label_num = static_cast<int>(detections[i * object_size + 1]);
-    std::vector<std::string> & labels = getLabels();
-    auto frame_size = getFrameSize();
+    /**< image_id is the batch slot of the frame the object is detected in >**/
+    int batch_index = static_cast<int>(image_id);
+    if (batch_index >= static_cast<int>(frame_sizes.size())) {
+      continue;
+    }
+    auto frame_size = frame_sizes[batch_index];
     r.x = static_cast<int>(detections[i * object_size + 3] * frame_size.width);
     r.y = static_cast<int>(detections[i * object_size + 4] * frame_size.height);
     r.width = static_cast<int>(detections[i * object_size + 5] * frame_size.width - r.x);
@@ -131,20 +181,8 @@ bool Models::ObjectDetectionSSDModel::fetchResults(
 
     if (enable_roi_constraint) {r &= cv::Rect(0, 0, frame_size.width, frame_size.height);}
 
-    dynamic_vino_lib::ObjectDetectionResult result(r);
-    std::string label = label_num < labels.size() ? labels[label_num] :
-      std::string("label #") + std::to_string(label_num);
-    result.setLabel(label);
-    float confidence = detections[i * object_size + 2];
-    if (confidence <= confidence_thresh /* || r.x == 0 */) {   // why r.x needs to be checked?
-      continue;
-    }
-    result.setConfidence(confidence);
-
-    results.emplace_back(result);
+    detections_arena.add(r, confidence, label_num, batch_index);
   }
-
-  return true;
 }
 
 bool Models::ObjectDetectionSSDModel::updateLayerProperty(
@@ -159,11 +197,31 @@ bool Models::ObjectDetectionSSDModel::updateLayerProperty(
     return false;
   }
   
+  std::string input_name = input_info_map.begin()->first;
+  InferenceEngine::SizeVector input_dims =
+    input_info_map.begin()->second->getTensorDesc().getDims();
+  cv::Size native(input_dims[3], input_dims[2]);
+  cv::Size shape = getReshapeSize(native, input_shape_);
+  if (shape != native) {
+    // the frames are then resized without stretching, the boxes stay normalized
+    slog::info << "Reshaping the input of " << getModelName() << " from " << native.width <<
+      "x" << native.height << " to " << shape.width << "x" << shape.height << slog::endl;
+    input_dims[2] = shape.height;
+    input_dims[3] = shape.width;
+    try {
+      net_reader.reshape({{input_name, input_dims}});
+    } catch (const std::exception & e) {
+      slog::warn << "Failed to reshape " << getModelName() << ", keeping its input size: " <<
+        e.what() << slog::endl;
+    }
+    input_info_map = net_reader.getInputsInfo();
+  }
+
   InferenceEngine::InputInfo::Ptr input_info = input_info_map.begin()->second;
   input_info->setPrecision(InferenceEngine::Precision::U8);
-  addInputInfo("input", input_info_map.begin()->first);
+  addInputInfo("input", input_name);
 
-  const InferenceEngine::SizeVector input_dims = input_info->getTensorDesc().getDims();
+  input_dims = input_info->getTensorDesc().getDims();
   setInputHeight(input_dims[2]);
   setInputWidth(input_dims[3]);
 
@@ -232,3 +290,29 @@ bool Models::ObjectDetectionSSDModel::updateLayerProperty(
   slog::info << "This model is SSDNet-like, Layer Property updated!" << slog::endl;
   return true;
 }
+
+cv::Size Models::ObjectDetectionSSDModel::getReshapeSize(
+  const cv::Size & native, const std::string & shape)
+{
+  int width = 0;
+  int height = 0;
+  char separator = 0;
+  if (shape.empty() || native.area() <= 0 ||
+    std::sscanf(shape.c_str(), "%d%c%d", &width, &separator, &height) != 3 ||
+    width <= 0 || height <= 0)
+  {
+    return native;
+  }
+  if (separator == 'x') {
+    return cv::Size(width, height);
+  }
+  if (separator != ':') {
+    return native;
+  }
+  // the aspect of the frames for about the pixels of the IR's input
+  const int stride = 32;
+  double scale = std::sqrt(static_cast<double>(native.area()) / (width * height));
+  int reshaped_width = static_cast<int>(std::round(width * scale / stride)) * stride;
+  int reshaped_height = static_cast<int>(std::round(height * scale / stride)) * stride;
+  return cv::Size(std::max(reshaped_width, stride), std::max(reshaped_height, stride));
+}
@@ -22,9 +22,21 @@
 #include <memory>
 #include <vector>
 #include <algorithm>
+#include <cmath>
 #include "dynamic_vino_lib/slog.hpp"
 #include "dynamic_vino_lib/engines/engine.hpp"
 #include "dynamic_vino_lib/inferences/object_detection.hpp"
+#include "dynamic_vino_lib/utils/opencl_preprocess.hpp"
+#ifdef USE_NGRAPH
+#include <ngraph/ngraph.hpp>
+#include <ngraph/op/region_yolo.hpp>
+#endif
+
+namespace
+{
+// the padding of a letterbox, 0.5 once normalized
+const uint8_t kLetterboxGray = 128;
+}  // namespace
 
 // Validated Object Detection Network
 Models::ObjectDetectionYolov2Model::ObjectDetectionYolov2Model(
@@ -36,21 +48,10 @@ Models::ObjectDetectionYolov2Model::ObjectDetectionYolov2Model(
 bool Models::ObjectDetectionYolov2Model::updateLayerProperty(
   InferenceEngine::CNNNetwork& net_reader)
 {
-  slog::info << "Checking INPUTs for model " << getModelName() << slog::endl;
-
-  InferenceEngine::InputsDataMap input_info_map(net_reader.getInputsInfo());
-  if (input_info_map.size() != 1) {
-    slog::warn << "This model seems not Yolo-like, which has only one input, but we got "
-      << std::to_string(input_info_map.size()) << "inputs" << slog::endl;
+  if (!updateInputProperty(net_reader)) {
     return false;
   }
 
-  InferenceEngine::InputInfo::Ptr input_info = input_info_map.begin()->second;
-  input_info->setPrecision(InferenceEngine::Precision::FP32);
-  input_info->getInputData()->setLayout(InferenceEngine::Layout::NCHW);
-  input_info_ = input_info;
-  addInputInfo("input", input_info_map.begin()->first);
-
   // set output property
   InferenceEngine::OutputsDataMap output_info_map(net_reader.getOutputsInfo());
   if (output_info_map.size() != 1) {
@@ -65,55 +66,102 @@ bool Models::ObjectDetectionYolov2Model::updateLayerProperty(
   slog::info << "Checking Object Detection output ... Name=" << output_info_map.begin()->first
     << slog::endl;
 
-#if(0) /// 
-  const InferenceEngine::CNNLayerPtr output_layer =
-    net_reader->getNetwork().getLayerByName(output_info_map.begin()->first.c_str());
-  // output layer should have attribute called num_classes
-  slog::info << "Checking Object Detection num_classes" << slog::endl;
-  if (output_layer == nullptr ||
-    output_layer->params.find("classes") == output_layer->params.end()) {
-    slog::warn << "This model's output layer (" << output_info_map.begin()->first
-      << ") should have num_classes integer attribute" << slog::endl;
-    return false;
+  readRegion(net_reader);
+  const InferenceEngine::SizeVector output_dims = output_data_ptr->getTensorDesc().getDims();
+  const int entries = region_.coords + region_.classes + 1;
+  size_t output_size = 1;
+  for (size_t i = 1; i < output_dims.size(); i++) {
+    output_size *= output_dims[i];
   }
-  // class number should be equal to size of label vector
-  // if network has default "background" class, fake is used
-  const int num_classes = output_layer->GetParamAsInt("classes");
-  slog::info << "Checking Object Detection output ... num_classes=" << num_classes << slog::endl;
-  if (getLabels().size() != num_classes) {
-    if (getLabels().size() == (num_classes - 1)) {
-      getLabels().insert(getLabels().begin(), "fake");
-    } else {
-      getLabels().clear();
-    }
+  // either [N, num * entries, side, side] or flattened [N, num * entries * side * side]
+  if (output_dims.size() == 4) {
+    region_.side = static_cast<int>(output_dims[2]);
+  } else {
+    region_.side = static_cast<int>(std::round(
+        std::sqrt(static_cast<double>(output_size) / (region_.num * entries))));
   }
-#endif
-
-  // last dimension of output layer should be 7
-  const InferenceEngine::SizeVector output_dims = output_data_ptr->getTensorDesc().getDims();
-  setMaxProposalCount(static_cast<int>(output_dims[2]));
-  slog::info << "max proposal count is: " << getMaxProposalCount() << slog::endl;
-
-  auto object_size = static_cast<int>(output_dims[3]);
-  if (object_size != 33) {
-    slog::warn << "This model is NOT Yolo-like, whose output data for each detected object"
-      << "should have 7 dimensions, but was " << std::to_string(object_size)
-      << slog::endl;
+  if (static_cast<size_t>(region_.side * region_.side * region_.num * entries) != output_size) {
+    slog::warn << "This model is NOT Yolo-like, the output size " << output_size <<
+      " doesn't match " << region_.num << " regions of " << entries << " entries" << slog::endl;
     return false;
   }
-  setObjectSize(object_size);
+  setMaxProposalCount(region_.side * region_.side * region_.num);
+  slog::info << "max proposal count is: " << getMaxProposalCount() << slog::endl;
+  setObjectSize(entries);
 
-  if (output_dims.size() != 2) {
-    slog::warn << "This model is not Yolo-like, output dimensions shoulld be 2, but was"
-      << std::to_string(output_dims.size()) << slog::endl;
+  printAttribute();
+  slog::info << "This model is Yolo-like, Layer Property updated!" << slog::endl;
+  return true;
+}
+
+bool Models::ObjectDetectionYolov2Model::updateInputProperty(
+  InferenceEngine::CNNNetwork & net_reader)
+{
+  slog::info << "Checking INPUTs for model " << getModelName() << slog::endl;
+
+  InferenceEngine::InputsDataMap input_info_map(net_reader.getInputsInfo());
+  if (input_info_map.size() != 1) {
+    slog::warn << "This model seems not Yolo-like, which has only one input, but we got "
+      << std::to_string(input_info_map.size()) << "inputs" << slog::endl;
     return false;
   }
 
-  printAttribute();
-  slog::info << "This model is Yolo-like, Layer Property updated!" << slog::endl;
+  InferenceEngine::InputInfo::Ptr input_info = input_info_map.begin()->second;
+  // the frame is packed as U8, the plugin converts and normalizes it to [0, 1]
+  input_info->setPrecision(InferenceEngine::Precision::U8);
+  input_info->getInputData()->setLayout(InferenceEngine::Layout::NCHW);
+  size_t channels = input_info->getTensorDesc().getDims()[1];
+  auto & preprocess = input_info->getPreProcess();
+  preprocess.init(channels);
+  for (size_t c = 0; c < channels; c++) {
+    preprocess[c]->meanValue = 0;
+    preprocess[c]->stdScale = 255;
+  }
+  preprocess.setVariant(InferenceEngine::MEAN_VALUE);
+  input_info_ = input_info;
+  addInputInfo("input", input_info_map.begin()->first);
   return true;
 }
 
+void Models::ObjectDetectionYolov2Model::readRegion(InferenceEngine::CNNNetwork & network)
+{
+#ifdef USE_NGRAPH
+  auto function = network.getFunction();
+  if (function != nullptr) {
+    for (auto & op : function->get_ops()) {
+      auto region = std::dynamic_pointer_cast<ngraph::op::RegionYolo>(op);
+      if (region == nullptr) {
+        continue;
+      }
+      if (!region->get_do_softmax()) {
+        slog::warn << "RegionYolo without softmax (YOLOv3-like) is decoded as YOLOv2" <<
+          slog::endl;
+      }
+      region_.coords = static_cast<int>(region->get_num_coords());
+      region_.classes = static_cast<int>(region->get_num_classes());
+      region_.num = static_cast<int>(region->get_num_regions());
+      std::vector<float> anchors = region->get_anchors();
+      auto mask = region->get_mask();
+      if (!mask.empty()) {
+        region_.num = static_cast<int>(mask.size());
+        region_.anchors.clear();
+        for (auto index : mask) {
+          region_.anchors.push_back(anchors[2 * index]);
+          region_.anchors.push_back(anchors[2 * index + 1]);
+        }
+      } else if (anchors.size() >= static_cast<size_t>(2 * region_.num)) {
+        region_.anchors = anchors;
+      }
+      slog::info << "RegionYolo: num=" << region_.num << ", coords=" << region_.coords <<
+        ", classes=" << region_.classes << slog::endl;
+      return;
+    }
+  }
+#endif
+  slog::warn << "No RegionYolo parameters found in " << getModelName() <<
+    ", using the YOLOv2 VOC ones" << slog::endl;
+}
+
 const std::string Models::ObjectDetectionYolov2Model::getModelCategory() const
 {
   return "Object Detection Yolo v2";
@@ -124,8 +172,6 @@ bool Models::ObjectDetectionYolov2Model::enqueue(
   const cv::Mat & frame,
   const cv::Rect & input_frame_loc)
 {
-  setFrameSize(frame.cols, frame.rows);
-
   if (!matToBlob(frame, input_frame_loc, 1, 0, engine)) {
     return false;
   }
@@ -142,76 +188,75 @@ bool Models::ObjectDetectionYolov2Model::matToBlob(
   }
 
   std::string input_name = getInputName();
-  InferenceEngine::Blob::Ptr input_blob =
-    engine->getRequest()->GetBlob(input_name);
-
-  InferenceEngine::SizeVector blob_size = input_blob->getTensorDesc().getDims();
-  const int width = blob_size[3];
-  const int height = blob_size[2];
-  const int channels = blob_size[1];
-  float * blob_data = input_blob->buffer().as<float *>();
-
-
-  int dx = 0;
-  int dy = 0;
-  int srcw = 0;
-  int srch = 0;
-
-  int IH = height;
-  int IW = width;
-
-  cv::Mat image = orig_image.clone();
-  cv::cvtColor(image, image, cv::COLOR_BGR2RGB);
-
-  image.convertTo(image, CV_32F, 1.0 / 255.0, 0);
-  srcw = image.size().width;
-  srch = image.size().height;
-
-  cv::Mat resizedImg(IH, IW, CV_32FC3);
-  resizedImg = cv::Scalar(0.5, 0.5, 0.5);
-  int imw = image.size().width;
-  int imh = image.size().height;
-  float resize_ratio = static_cast<float>(IH) / static_cast<float>(std::max(imw, imh));
-  cv::resize(image, image, cv::Size(imw * resize_ratio, imh * resize_ratio));
-
-  int new_w = imw;
-  int new_h = imh;
-  if ((static_cast<float>(IW) / imw) < (static_cast<float>(IH) / imh)) {
-    new_w = IW;
-    new_h = (imh * IW) / imw;
-  } else {
-    new_h = IH;
-    new_w = (imw * IW) / imh;
-  }
-  dx = (IW - new_w) / 2;
-  dy = (IH - new_h) / 2;
+  Letterbox letterbox = letterboxToBlob(orig_image, batch_index,
+      engine->getInputBinding(input_name), engine->getPreprocessCache());
 
-  imh = image.size().height;
-  imw = image.size().width;
+  const int slot = engine->getBoundRequest() * getMaxBatchSize() + batch_index;
+  if (slot >= static_cast<int>(letterboxes_.size())) {
+    letterboxes_.resize(slot + 1);
+  }
+  letterboxes_[slot] = letterbox;
+  setFrameSize(orig_image.cols, orig_image.rows, slot);
+  return true;
+}
 
-  for (int row = 0; row < imh; row++) {
-    for (int col = 0; col < imw; col++) {
-      for (int ch = 0; ch < 3; ch++) {
-        resizedImg.at<cv::Vec3f>(dy + row, dx + col)[ch] = image.at<cv::Vec3f>(row, col)[ch];
-      }
+Models::ObjectDetectionYolov2Model::Letterbox
+Models::ObjectDetectionYolov2Model::letterboxToBlob(
+  const cv::Mat & orig_image, int batch_index, const Engines::InputBinding & binding,
+  PreprocessCache * cache)
+{
+  const int width = binding.dims[3];
+  const int height = binding.dims[2];
+  const int channels = binding.dims[1];
+  const int area = width * height;
+  uint8_t * blob_data =
+    binding.blob->buffer().as<uint8_t *>() + batch_index * binding.strides[0];
+
+  // letterbox: keep the aspect ratio and center the frame, padded with gray
+  Letterbox letterbox;
+  letterbox.scale = std::min(
+    static_cast<float>(width) / orig_image.cols, static_cast<float>(height) / orig_image.rows);
+  const int new_w = std::max(1, std::min(width,
+      static_cast<int>(std::round(orig_image.cols * letterbox.scale))));
+  const int new_h = std::max(1, std::min(height,
+      static_cast<int>(std::round(orig_image.rows * letterbox.scale))));
+  letterbox.dx = (width - new_w) / 2;
+  letterbox.dy = (height - new_h) / 2;
+
+  if (OpenCLPreprocess::isEnabled() && channels == 3) {
+    cv::UMat source = cache != nullptr ? cache->getUMat(orig_image) : cv::UMat();
+    if (source.empty()) {
+      source = OpenCLPreprocess::upload(orig_image);
     }
+    OpenCLPreprocess::letterboxToPlanar(source, cv::Size(width, height),
+      cv::Rect(letterbox.dx, letterbox.dy, new_w, new_h), kLetterboxGray, blob_data);
+    return letterbox;
   }
+  ScratchArena::Scope scratch;
+  cv::Mat resized = scratch.getMat(cv::Size(new_w, new_h), orig_image.type());
+  cv::resize(orig_image, resized, cv::Size(new_w, new_h));
 
-  for (int c = 0; c < channels; c++) {
-    for (int h = 0; h < height; h++) {
-      for (int w = 0; w < width; w++) {
-        blob_data[c * width * height + h * width + w] = resizedImg.at<cv::Vec3f>(h, w)[c];
+  // single pass: BGR->RGB and HWC->CHW, written into the blob
+  if (new_w != width || new_h != height) {
+    std::fill(blob_data, blob_data + channels * area, kLetterboxGray);
+  }
+  for (int h = 0; h < new_h; h++) {
+    const uint8_t * row = resized.ptr<uint8_t>(h);
+    const int offset = (letterbox.dy + h) * width + letterbox.dx;
+    for (int c = 0; c < channels; c++) {
+      uint8_t * dst = blob_data + c * area + offset;
+      const uint8_t * src = row + (2 - c);
+      for (int w = 0; w < new_w; w++) {
+        dst[w] = src[w * 3];
       }
     }
   }
-
-  setFrameSize(srcw, srch);
-  return true;
+  return letterbox;
 }
 
 bool Models::ObjectDetectionYolov2Model::fetchResults(
   const std::shared_ptr<Engines::Engine> & engine,
-  std::vector<dynamic_vino_lib::ObjectDetectionResult> & results,
+  dynamic_vino_lib::ObjectDetectionArena & detections_arena,
   const float & confidence_thresh,
   const bool & enable_roi_constraint)
 {
@@ -221,117 +266,19 @@ bool Models::ObjectDetectionYolov2Model::fetchResults(
       return false;
     }
 
-    InferenceEngine::InferRequest::Ptr request = engine->getRequest();
-
     std::string output = getOutputName();
-    std::vector<std::string> & labels = getLabels();
     const float * detections =
-      request->GetBlob(output)->buffer().as<InferenceEngine::PrecisionTrait
-        <InferenceEngine::Precision::FP32>::value_type *>();
-    ///InferenceEngine::CNNLayerPtr layer =
-    ///  getNetReader()->getNetwork().getLayerByName(output.c_str());
+      engine->getOutput(output)->cbuffer().as<const float *>();
     int input_height = input_info_->getTensorDesc().getDims()[2];
     int input_width = input_info_->getTensorDesc().getDims()[3];
-
-    // --------------------------- Validating output parameters --------------------------------
-    ///if (layer != nullptr && layer->type != "RegionYolo") {
-    ///  throw std::runtime_error("Invalid output type: " + layer->type + ". RegionYolo expected");
-    ///}
-    // --------------------------- Extracting layer parameters --------------------------------
-    const int num = 3; ///layer->GetParamAsInt("num");
-    const int coords = 9; ///layer->GetParamAsInt("coords");
-    const int classes = 21; ///layer->GetParamAsInt("classes");
-    auto blob = request->GetBlob(output);
-    const int out_blob_h = static_cast<int>(blob->getTensorDesc().getDims()[2]);;
-
-    std::vector<float> anchors = {
-      0.572730, 0.677385,
-      1.874460, 2.062530,
-      3.338430, 5.474340,
-      7.882820, 3.527780,
-      9.770520, 9.168280
-    };
-    auto side = out_blob_h;
-
-    auto side_square = side * side;
-    // --------------------------- Parsing YOLO Region output -------------------------------------
-    std::vector<Result> raw_results;
-    for (int i = 0; i < side_square; ++i) {
-      int row = i / side;
-      int col = i % side;
-
-      for (int n = 0; n < num; ++n) {
-        int obj_index = getEntryIndex(side, coords, classes, n * side * side + i, coords);
-        int box_index = getEntryIndex(side, coords, classes, n * side * side + i, 0);
-
-        float scale = detections[obj_index];
-
-        if (scale < confidence_thresh) {
-          continue;
-        }
-
-        float x = (col + detections[box_index + 0 * side_square]) / side * input_width;
-        float y = (row + detections[box_index + 1 * side_square]) / side * input_height;
-        float height = std::exp(detections[box_index + 3 * side_square]) * anchors[2 * n + 1] /
-          side * input_height;
-        float width = std::exp(detections[box_index + 2 * side_square]) * anchors[2 * n] / side *
-          input_width;
-
-        for (int j = 0; j < classes; ++j) {
-          int class_index =
-            getEntryIndex(side, coords, classes, n * side_square + i, coords + 1 + j);
-
-          float prob = scale * detections[class_index];
-          if (prob < confidence_thresh) {
-            continue;
-          }
-
-          float x_min = x - width / 2;
-          float y_min = y - height / 2;
-
-          auto frame_size = getFrameSize();
-          float x_min_resized = x_min / input_width * frame_size.width;
-          float y_min_resized = y_min / input_height * frame_size.height;
-          float width_resized = width / input_width * frame_size.width;
-          float height_resized = height / input_height * frame_size.height;
-
-          cv::Rect r(x_min_resized, y_min_resized, width_resized, height_resized);
-          Result result(r);
-          // result.label_ = j;
-          std::string label = j <
-            labels.size() ? labels[j] : std::string("label #") + std::to_string(j);
-          result.setLabel(label);
-
-          result.setConfidence(prob);
-          raw_results.emplace_back(result);
-        }
-      }
-    }
-
-    std::sort(raw_results.begin(), raw_results.end());
-    for (unsigned int i = 0; i < raw_results.size(); ++i) {
-      if (raw_results[i].getConfidence() == 0) {
-        continue;
-      }
-      for (unsigned int j = i + 1; j < raw_results.size(); ++j) {
-        auto iou = dynamic_vino_lib::ObjectDetection::calcIoU(
-          raw_results[i].getLocation(), raw_results[j].getLocation());
-        if (iou >= 0.45) {
-          raw_results[j].setConfidence(0);
-        }
-      }
+    const int slot = engine->getBoundRequest() * getMaxBatchSize();
+    Letterbox letterbox;
+    if (slot < static_cast<int>(letterboxes_.size())) {
+      letterbox = letterboxes_[slot];
     }
 
-    for (auto & raw_result : raw_results) {
-      if (raw_result.getConfidence() < confidence_thresh) {
-        continue;
-      }
-
-      results.push_back(raw_result);
-    }
-
-    raw_results.clear();
-
+    decodeRegion(detections, region_, cv::Size(input_width, input_height), letterbox,
+      confidence_thresh, nms_threshold_, top_k_, detections_arena);
     return true;
   } catch (const std::exception & error) {
     slog::err << error.what() << slog::endl;
@@ -342,11 +289,107 @@ bool Models::ObjectDetectionYolov2Model::fetchResults(
   }
 }
 
-int Models::ObjectDetectionYolov2Model::getEntryIndex(
-  int side, int lcoords, int lclasses,
-  int location, int entry)
+void Models::ObjectDetectionYolov2Model::decodeRegion(
+  const float * detections, const Region & region, const cv::Size & input_size,
+  const Letterbox & letterbox, float confidence_thresh, float nms_threshold, int top_k,
+  dynamic_vino_lib::ObjectDetectionArena & detections_arena)
 {
-  int n = location / (side * side);
-  int loc = location % (side * side);
-  return n * side * side * (lcoords + lclasses + 1) + entry * side * side + loc;
+  const int input_width = input_size.width;
+  const int input_height = input_size.height;
+  const int num = region.num;
+  const int coords = region.coords;
+  const int classes = region.classes;
+  const int side = region.side;
+  const int side_square = side * side;
+  const int entries = coords + classes + 1;
+  const auto & anchors = region.anchors;
+
+  // --------------------------- Parsing YOLO Region output -------------------------------------
+  ScratchArena::Scope scratch;
+  ScratchVector<Candidate> candidates;
+  candidates.reserve(num * side_square);
+  cv::Mat passed = scratch.getMat(cv::Size(side_square, 1), CV_8U);
+  std::vector<cv::Point> cells;
+  for (int n = 0; n < num; ++n) {
+    // the entries of a region are planes of side * side cells
+    const float * cell_entries = detections + n * entries * side_square;
+    const float * objectness = cell_entries + coords * side_square;
+    // threshold the whole objectness plane at once, only the cells passing it are decoded
+    cv::compare(cv::Mat(1, side_square, CV_32F, const_cast<float *>(objectness)),
+      confidence_thresh, passed, cv::CMP_GE);
+    cells.clear();
+    if (cv::countNonZero(passed) > 0) {
+      cv::findNonZero(passed, cells);
+    }
+    for (auto & cell : cells) {
+      const int i = cell.x;
+      const int row = i / side;
+      const int col = i % side;
+      const float scale = objectness[i];
+
+      float x = (col + cell_entries[i]) / side * input_width;
+      float y = (row + cell_entries[side_square + i]) / side * input_height;
+      float width = std::exp(cell_entries[2 * side_square + i]) * anchors[2 * n] / side *
+        input_width;
+      float height = std::exp(cell_entries[3 * side_square + i]) * anchors[2 * n + 1] / side *
+        input_height;
+
+      // undo the letterbox of matToBlob
+      cv::Rect2f box(
+        (x - width / 2 - letterbox.dx) / letterbox.scale,
+        (y - height / 2 - letterbox.dy) / letterbox.scale,
+        width / letterbox.scale, height / letterbox.scale);
+
+      const float * class_probs = cell_entries + (coords + 1) * side_square + i;
+      for (int j = 0; j < classes; ++j) {
+        float prob = scale * class_probs[j * side_square];
+        if (prob >= confidence_thresh) {
+          candidates.push_back({box, prob, j});
+        }
+      }
+    }
+  }
+
+  suppressCandidates(candidates, nms_threshold, top_k, detections_arena);
+}
+
+void Models::ObjectDetectionYolov2Model::suppressCandidates(
+  ScratchVector<Candidate> & candidates, float nms_threshold, int top_k,
+  dynamic_vino_lib::ObjectDetectionArena & detections_arena)
+{
+  ScratchArena::Scope scratch;
+  std::sort(candidates.begin(), candidates.end(),
+    [](const Candidate & a, const Candidate & b) {
+      return a.class_id != b.class_id ? a.class_id < b.class_id : a.confidence > b.confidence;
+    });
+  ScratchVector<Candidate> kept;
+  kept.reserve(candidates.size());
+  for (size_t begin = 0; begin < candidates.size(); ) {
+    size_t end = begin;
+    const size_t class_begin = kept.size();
+    for (; end < candidates.size() && candidates[end].class_id == candidates[begin].class_id;
+      ++end)
+    {
+      auto & box = candidates[end].box;
+      bool suppressed = false;
+      for (size_t k = class_begin; k < kept.size() && !suppressed; ++k) {
+        float intersection = (box & kept[k].box).area();
+        float union_area = box.area() + kept[k].box.area() - intersection;
+        suppressed = union_area > 0 && intersection / union_area >= nms_threshold;
+      }
+      if (!suppressed) {
+        kept.push_back(candidates[end]);
+      }
+    }
+    begin = end;
+  }
+  std::sort(kept.begin(), kept.end(),
+    [](const Candidate & a, const Candidate & b) {return a.confidence > b.confidence;});
+  if (top_k > 0 && kept.size() > static_cast<size_t>(top_k)) {
+    kept.resize(top_k);
+  }
+
+  for (auto & candidate : kept) {
+    detections_arena.add(cv::Rect(candidate.box), candidate.confidence, candidate.class_id);
+  }
 }
@@ -0,0 +1,294 @@
+// Copyright (c) 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @brief An implementation file with implementation for ObjectDetectionYolov3Model Class
+ * @file object_detection_yolov3_model.cpp
+ */
+
+#include "dynamic_vino_lib/models/object_detection_yolov3_model.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+#include "dynamic_vino_lib/slog.hpp"
+#include "dynamic_vino_lib/engines/engine.hpp"
+#include "dynamic_vino_lib/inferences/object_detection.hpp"
+#ifdef USE_NGRAPH
+#include <ngraph/ngraph.hpp>
+#include <ngraph/op/region_yolo.hpp>
+#endif
+
+namespace
+{
+// the anchors of YOLOv3 COCO, three per head from the finest scale
+const std::vector<float> kDefaultAnchors = {
+  10, 13, 16, 30, 33, 23,
+  30, 61, 62, 45, 59, 119,
+  116, 90, 156, 198, 373, 326
+};
+
+inline float sigmoid(float x)
+{
+  return 1.0f / (1.0f + std::exp(-x));
+}
+
+/**
+ * @brief The logit a sigmoid passes the probability from, so that the raw
+ * values are thresholded before any sigmoid is computed.
+ */
+inline float logit(float probability)
+{
+  if (probability <= 0) {
+    return std::numeric_limits<float>::lowest();
+  }
+  if (probability >= 1) {
+    return std::numeric_limits<float>::max();
+  }
+  return std::log(probability / (1 - probability));
+}
+}  // namespace
+
+Models::ObjectDetectionYolov3Model::ObjectDetectionYolov3Model(
+  const std::string & model_loc, int max_batch_size)
+: ObjectDetectionYolov2Model(model_loc, max_batch_size)
+{
+}
+
+const std::string Models::ObjectDetectionYolov3Model::getModelCategory() const
+{
+  return "Object Detection Yolo v3";
+}
+
+bool Models::ObjectDetectionYolov3Model::updateLayerProperty(
+  InferenceEngine::CNNNetwork & net_reader)
+{
+  if (!updateInputProperty(net_reader) || !readHeads(net_reader)) {
+    return false;
+  }
+  int proposals = 0;
+  for (size_t h = 0; h < heads_.size(); h++) {
+    addOutputInfo("output" + std::to_string(h), heads_[h].output);
+    proposals += heads_[h].width * heads_[h].height * heads_[h].num;
+  }
+  setMaxProposalCount(proposals);
+  slog::info << "max proposal count is: " << getMaxProposalCount() << slog::endl;
+  setObjectSize(heads_.front().coords + heads_.front().classes + 1);
+
+  printAttribute();
+  slog::info << "This model is Yolo-like with " << heads_.size() <<
+    " heads, Layer Property updated!" << slog::endl;
+  return true;
+}
+
+bool Models::ObjectDetectionYolov3Model::readHeads(InferenceEngine::CNNNetwork & network)
+{
+  heads_.clear();
+  InferenceEngine::OutputsDataMap output_info_map(network.getOutputsInfo());
+  for (auto & output : output_info_map) {
+    output.second->setPrecision(InferenceEngine::Precision::FP32);
+    const InferenceEngine::SizeVector dims = output.second->getTensorDesc().getDims();
+    if (dims.size() != 4) {
+      slog::warn << "The output " << output.first << " is not a YOLO head, its dims are not " <<
+        "[N, C, H, W]" << slog::endl;
+      return false;
+    }
+    Head head;
+    head.output = output.first;
+    head.height = static_cast<int>(dims[2]);
+    head.width = static_cast<int>(dims[3]);
+    head.raw = true;
+#ifdef USE_NGRAPH
+    auto function = network.getFunction();
+    if (function != nullptr) {
+      for (auto & op : function->get_ops()) {
+        auto region = std::dynamic_pointer_cast<ngraph::op::RegionYolo>(op);
+        if (region == nullptr || region->get_friendly_name() != output.first) {
+          continue;
+        }
+        if (region->get_do_softmax()) {
+          slog::warn << "The RegionYolo of " << output.first << " is YOLOv2-like, use " <<
+            "model_type yolov2" << slog::endl;
+          return false;
+        }
+        head.raw = false;
+        head.coords = static_cast<int>(region->get_num_coords());
+        head.classes = static_cast<int>(region->get_num_classes());
+        std::vector<float> anchors = region->get_anchors();
+        auto mask = region->get_mask();
+        head.num = static_cast<int>(mask.size());
+        for (auto index : mask) {
+          head.anchors.push_back(anchors[2 * index]);
+          head.anchors.push_back(anchors[2 * index + 1]);
+        }
+        break;
+      }
+    }
+#endif
+    if (head.raw) {
+      head.classes = static_cast<int>(dims[1]) / head.num - head.coords - 1;
+    }
+    if (head.classes <= 0 ||
+      static_cast<int>(dims[1]) != head.num * (head.coords + 1 + head.classes))
+    {
+      slog::warn << "The output " << output.first << " of " << dims[1] << " channels doesn't " <<
+        "match " << head.num << " anchors of " << head.classes << " classes" << slog::endl;
+      return false;
+    }
+    heads_.push_back(head);
+  }
+  if (heads_.empty()) {
+    slog::warn << "This model has no YOLO head" << slog::endl;
+    return false;
+  }
+
+  // the finest heads detect the smallest objects
+  std::sort(heads_.begin(), heads_.end(),
+    [](const Head & a, const Head & b) {return a.width > b.width;});
+  for (size_t h = 0; h < heads_.size(); h++) {
+    auto & head = heads_[h];
+    if (!head.anchors.empty()) {
+      continue;
+    }
+    size_t first = std::min(h, kDefaultAnchors.size() / 6 - 1) * 6;
+    head.anchors.assign(kDefaultAnchors.begin() + first, kDefaultAnchors.begin() + first + 6);
+    slog::warn << "No RegionYolo for " << head.output << ", decoding its logits with the " <<
+      "YOLOv3 COCO anchors" << slog::endl;
+  }
+  for (auto & head : heads_) {
+    slog::info << "YOLO head " << head.output << ": " << head.width << "x" << head.height <<
+      ", num=" << head.num << ", classes=" << head.classes << (head.raw ? ", raw" : "") <<
+      slog::endl;
+  }
+  return true;
+}
+
+bool Models::ObjectDetectionYolov3Model::fetchResults(
+  const std::shared_ptr<Engines::Engine> & engine,
+  dynamic_vino_lib::ObjectDetectionArena & detections_arena,
+  const float & confidence_thresh,
+  const bool & enable_roi_constraint)
+{
+  try {
+    if (engine == nullptr) {
+      slog::err << "Trying to fetch results from <null> Engines." << slog::endl;
+      return false;
+    }
+
+    int input_height = input_info_->getTensorDesc().getDims()[2];
+    int input_width = input_info_->getTensorDesc().getDims()[3];
+    const int slot = engine->getBoundRequest() * getMaxBatchSize();
+    Letterbox letterbox;
+    if (slot < static_cast<int>(letterboxes_.size())) {
+      letterbox = letterboxes_[slot];
+    }
+    ScratchArena::Scope scratch;
+    ScratchVector<const float *> outputs;
+    outputs.reserve(heads_.size());
+    for (auto & head : heads_) {
+      outputs.push_back(engine->getOutput(head.output)->cbuffer().as<const float *>());
+    }
+
+    // each head decodes into its own part of the candidates, without locking, on
+    // the threads of OpenCV: the parts are not taken from the arena of this one
+    std::vector<std::vector<Candidate>> head_candidates(heads_.size());
+    const float threshold = confidence_thresh;
+    cv::parallel_for_(cv::Range(0, static_cast<int>(heads_.size())),
+      [&](const cv::Range & range) {
+        for (int h = range.start; h < range.end; h++) {
+          decodeHead(outputs[h], heads_[h], cv::Size(input_width, input_height), letterbox,
+            threshold, head_candidates[h]);
+        }
+      });
+    size_t total = 0;
+    for (auto & candidates : head_candidates) {
+      total += candidates.size();
+    }
+    ScratchVector<Candidate> candidates;
+    candidates.reserve(total);
+    for (auto & part : head_candidates) {
+      candidates.insert(candidates.end(), part.begin(), part.end());
+    }
+    suppressCandidates(candidates, nms_threshold_, top_k_, detections_arena);
+    return true;
+  } catch (const std::exception & error) {
+    slog::err << error.what() << slog::endl;
+    return false;
+  } catch (...) {
+    slog::err << "Unknown/internal exception happened." << slog::endl;
+    return false;
+  }
+}
+
+void Models::ObjectDetectionYolov3Model::decodeHead(
+  const float * data, const Head & head, const cv::Size & input_size,
+  const Letterbox & letterbox, float confidence_thresh, std::vector<Candidate> & candidates)
+{
+  const int area = head.width * head.height;
+  const int entries = head.coords + 1 + head.classes;
+  // the logits of a raw head are thresholded as they are, sigmoid being monotonic
+  const float objectness_thresh = head.raw ? logit(confidence_thresh) : confidence_thresh;
+  ScratchArena::Scope scratch;
+  cv::Mat passed = scratch.getMat(cv::Size(area, 1), CV_8U);
+  std::vector<cv::Point> cells;
+  for (int n = 0; n < head.num; ++n) {
+    // the entries of an anchor are planes of width * height cells
+    const float * cell_entries = data + n * entries * area;
+    const float * objectness = cell_entries + head.coords * area;
+    // threshold the whole objectness plane at once, only the cells passing it are decoded
+    cv::compare(cv::Mat(1, area, CV_32F, const_cast<float *>(objectness)),
+      objectness_thresh, passed, cv::CMP_GE);
+    cells.clear();
+    if (cv::countNonZero(passed) > 0) {
+      cv::findNonZero(passed, cells);
+    }
+    for (auto & cell : cells) {
+      const int i = cell.x;
+      const int row = i / head.width;
+      const int col = i % head.width;
+      const float scale = head.raw ? sigmoid(objectness[i]) : objectness[i];
+      float tx = cell_entries[i];
+      float ty = cell_entries[area + i];
+      if (head.raw) {
+        tx = sigmoid(tx);
+        ty = sigmoid(ty);
+      }
+
+      float x = (col + tx) / head.width * input_size.width;
+      float y = (row + ty) / head.height * input_size.height;
+      float width = std::exp(cell_entries[2 * area + i]) * head.anchors[2 * n];
+      float height = std::exp(cell_entries[3 * area + i]) * head.anchors[2 * n + 1];
+
+      // undo the letterbox of matToBlob
+      cv::Rect2f box(
+        (x - width / 2 - letterbox.dx) / letterbox.scale,
+        (y - height / 2 - letterbox.dy) / letterbox.scale,
+        width / letterbox.scale, height / letterbox.scale);
+
+      // the class probability a cell needs to pass the threshold with its objectness
+      float needed = confidence_thresh <= 0 ? 0 :
+        scale > 0 ? confidence_thresh / scale : std::numeric_limits<float>::max();
+      const float class_thresh = head.raw ? logit(needed) : needed;
+      const float * class_probs = cell_entries + (head.coords + 1) * area + i;
+      for (int j = 0; j < head.classes; ++j) {
+        float value = class_probs[j * area];
+        if (value >= class_thresh) {
+          candidates.push_back({box, scale * (head.raw ? sigmoid(value) : value), j});
+        }
+      }
+    }
+  }
+}
@@ -44,7 +44,7 @@ bool Models::ObjectSegmentationModel::enqueue(
   for (const auto &inputInfoItem : input_info_)
   {
     // Fill first input tensor with images. First b channel, then g and r channels
-    slog::debug<<"first tensor"<<inputInfoItem.second->getTensorDesc().getDims().size()<<slog::endl;
+    SLOG_DEBUG << "first tensor"<<inputInfoItem.second->getTensorDesc().getDims().size()<<slog::endl;
     if (inputInfoItem.second->getTensorDesc().getDims().size()==4)
     {
       matToBlob(frame, input_frame_loc, 1.0, 0, engine);
@@ -53,7 +53,7 @@ bool Models::ObjectSegmentationModel::enqueue(
     // Fill second input tensor with image info
     if (inputInfoItem.second->getTensorDesc().getDims().size() == 2)
     {
-      InferenceEngine::Blob::Ptr input = engine->getRequest()->GetBlob(inputInfoItem.first);
+      InferenceEngine::Blob::Ptr input = engine->getInput(inputInfoItem.first);
       auto data = input->buffer().as<InferenceEngine::PrecisionTrait<InferenceEngine::Precision::FP32>::value_type *>();
       data[0] = static_cast<float>(frame.rows); // height
       data[1] = static_cast<float>(frame.cols);  // width
@@ -98,11 +98,39 @@ bool Models::ObjectSegmentationModel::matToBlob(
                                     InferenceEngine::Layout::NHWC);
 
   auto shared_blob = InferenceEngine::make_shared_blob<uint8_t>(tDesc, orig_image.data);
-  engine->getRequest()->SetBlob(getInputName(), shared_blob);
+  engine->setInput(getInputName(), shared_blob);
 
   return true;
 }
 
+bool Models::ObjectSegmentationModel::updateInstanceOutputs(
+  InferenceEngine::OutputsDataMap & outputs)
+{
+  std::string detection;
+  std::string masks;
+  for (auto & output : outputs) {
+    output.second->setPrecision(InferenceEngine::Precision::FP32);
+    const InferenceEngine::SizeVector & dims = output.second->getTensorDesc().getDims();
+    // [N, 7] or [1, 1, N, 7] boxes, [N, classes, height, width] masks
+    if (dims.back() == 7) {
+      detection = output.first;
+    } else if (dims.size() == 4) {
+      masks = output.first;
+    }
+  }
+  if (detection.empty() || masks.empty()) {
+    slog::warn << "This model is not Mask R-CNN-like, it needs a detection output of 7 " <<
+      "values per box and a masks output" << slog::endl;
+    return false;
+  }
+  instance_ = true;
+  addOutputInfo("detection", detection);
+  addOutputInfo("masks", masks);
+  printAttribute();
+  slog::info << "This model is Mask R-CNN-like, Layer Property updated!" << slog::endl;
+  return true;
+}
+
 const std::string Models::ObjectSegmentationModel::getModelCategory() const
 {
   return "Object Segmentation";
@@ -117,17 +145,28 @@ bool Models::ObjectSegmentationModel::updateLayerProperty(
   input_info_ = InferenceEngine::InputsDataMap(network.getInputsInfo());
 
   InferenceEngine::ICNNNetwork:: InputShapes inputShapes = network.getInputShapes();
-  slog::debug<<"input size"<<inputShapes.size()<<slog::endl;
-  if (inputShapes.size() != 1) {
+  SLOG_DEBUG << "input size"<<inputShapes.size()<<slog::endl;
+  // the image, and for Mask R-CNN-like models the image info (height, width, scale) besides
+  auto image_input = inputShapes.begin();
+  int image_inputs = 0;
+  for (auto it = inputShapes.begin(); it != inputShapes.end(); ++it) {
+    if (it->second.size() == 4) {
+      image_input = it;
+      image_inputs++;
+    } else if (it->second.size() == 2) {
+      network.getInputsInfo()[it->first]->setPrecision(InferenceEngine::Precision::FP32);
+    }
+  }
+  if (image_inputs != 1 || inputShapes.size() > 2) {
     // throw std::runtime_error("Demo supports topologies only with 1 input");
-    slog::warn << "This inference sample should have only one input, but we got"
+    slog::warn << "This inference sample should have only one image input, but we got"
       << std::to_string(inputShapes.size()) << "inputs"
       << slog::endl;
     return false;
   }
 
-  InferenceEngine::SizeVector &in_size_vector = inputShapes.begin()->second;
-  slog::debug<<"channel size"<<in_size_vector[1]<<"dimensional"<<in_size_vector.size()<<slog::endl;
+  InferenceEngine::SizeVector &in_size_vector = image_input->second;
+  SLOG_DEBUG << "channel size"<<in_size_vector[1]<<"dimensional"<<in_size_vector.size()<<slog::endl;
   if (in_size_vector.size() != 4 || in_size_vector[1] != 3) {
     //throw std::runtime_error("3-channel 4-dimensional model's input is expected");
     slog::warn << "3-channel 4-dimensional model's input is expected, but we got "
@@ -138,16 +177,20 @@ bool Models::ObjectSegmentationModel::updateLayerProperty(
   in_size_vector[0] = 1;
   network.reshape(inputShapes);
 
-  InferenceEngine:: InputInfo &inputInfo = *network.getInputsInfo().begin()->second;
+  InferenceEngine:: InputInfo &inputInfo = *network.getInputsInfo()[image_input->first];
   inputInfo.getPreProcess().setResizeAlgorithm(InferenceEngine::ResizeAlgorithm::RESIZE_BILINEAR);
   inputInfo.setLayout(InferenceEngine::Layout::NHWC);
   inputInfo.setPrecision(InferenceEngine::Precision::U8);
 
   //InferenceEngine::InputInfo::Ptr input_info = input_info_map.begin()->second;
   //addInputInfo("input", input_info_map.begin()->first.c_str());
-  addInputInfo("input", inputShapes.begin()->first);
+  addInputInfo("input", image_input->first);
 
   InferenceEngine::OutputsDataMap outputsDataMap = network.getOutputsInfo();
+  if (outputsDataMap.size() == 2) {
+    return updateInstanceOutputs(outputsDataMap);
+  }
+  instance_ = false;
   if (outputsDataMap.size() != 1) {
     //throw std::runtime_error("Demo supports topologies only with 1 output");
     slog::warn << "This inference sample should have only one output, but we got"
@@ -161,7 +204,7 @@ bool Models::ObjectSegmentationModel::updateLayerProperty(
 
   const InferenceEngine::SizeVector& outSizeVector = data.getTensorDesc().getDims();
   int outChannels, outHeight, outWidth;
-  slog::debug << "output size vector " << outSizeVector.size() << slog::endl;
+  SLOG_DEBUG << "output size vector " << outSizeVector.size() << slog::endl;
   switch(outSizeVector.size()){
     case 3:
       outChannels = 0;
@@ -185,9 +228,9 @@ bool Models::ObjectSegmentationModel::updateLayerProperty(
     return false;
   }
 
-  slog::debug << "output width " << outWidth<< slog::endl;
-  slog::debug << "output hEIGHT " << outHeight<< slog::endl;
-  slog::debug << "output CHANNALS " << outChannels<< slog::endl;
+  SLOG_DEBUG << "output width " << outWidth<< slog::endl;
+  SLOG_DEBUG << "output hEIGHT " << outHeight<< slog::endl;
+  SLOG_DEBUG << "output CHANNALS " << outChannels<< slog::endl;
   addOutputInfo("masks", (outputsDataMap.begin()++)->first);
   addOutputInfo("detection", outputsDataMap.begin()->first);
 
@@ -218,7 +261,7 @@ bool Models::ObjectSegmentationModel::updateLayerProperty(
   auto object_size = static_cast<int>(output_dims[3]);
   setObjectSize(object_size);
 
-  slog::debug << "model size" << output_dims.size() << slog::endl;*/
+  SLOG_DEBUG << "model size" << output_dims.size() << slog::endl;*/
   printAttribute();
   slog::info << "This model is SSDNet-like, Layer Property updated!" << slog::endl;
   return true;
@@ -0,0 +1,117 @@
+// Copyright (c) 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @brief An implementation file with implementation for AsyncOutput Class
+ * @file async_output.cpp
+ */
+
+#include <algorithm>
+#include <exception>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "dynamic_vino_lib/outputs/async_output.hpp"
+#include "dynamic_vino_lib/pipeline.hpp"
+#include "dynamic_vino_lib/slog.hpp"
+
+Outputs::AsyncOutput::AsyncOutput(
+  const std::string & output_name, std::shared_ptr<BaseOutput> output, size_t capacity)
+: BaseOutput(output_name), output_(output), capacity_(std::max<size_t>(capacity, 1)),
+  dropped_frames_(0)
+{
+  worker_ = std::thread(&AsyncOutput::run, this);
+}
+
+Outputs::AsyncOutput::~AsyncOutput()
+{
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    stopped_ = true;
+  }
+  cond_.notify_all();
+  if (worker_.joinable()) {
+    worker_.join();
+  }
+}
+
+void Outputs::AsyncOutput::feedFrame(const cv::Mat & frame)
+{
+  std::lock_guard<std::mutex> lk(mutex_);
+  // shared with the pipeline, the wrapped output copies it if it draws on it
+  pending_.frame = frame;
+  pending_.results.clear();
+}
+
+void Outputs::AsyncOutput::handleOutput()
+{
+  auto header = getFrameHeader();
+  auto times = getFrameTimes();
+  float scale = getFrameScale();
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    pending_.header = header;
+    pending_.times = times;
+    pending_.scale = scale;
+    if (queue_.size() >= capacity_) {
+      queue_.pop_front();
+      dropped_frames_++;
+    }
+    queue_.push_back(std::move(pending_));
+    pending_ = Job();
+  }
+  cond_.notify_one();
+}
+
+void Outputs::AsyncOutput::clearData()
+{
+  std::lock_guard<std::mutex> lk(mutex_);
+  pending_.results.clear();
+}
+
+void Outputs::AsyncOutput::run()
+{
+  while (true) {
+    Job job;
+    {
+      std::unique_lock<std::mutex> lk(mutex_);
+      cond_.wait(lk, [this] {return stopped_ || !queue_.empty();});
+      if (stopped_) {
+        return;
+      }
+      job = std::move(queue_.front());
+      queue_.pop_front();
+    }
+    output_->setPipeline(getPipeline());
+    output_->setFrameHeader(job.header);
+    output_->setFrameTimes(job.times);
+    output_->setFrameScale(job.scale);
+    output_->feedFrame(job.frame);
+    for (auto & results : job.results) {
+      output_->acceptView(results);
+    }
+    try {
+      output_->handleOutput();
+    } catch (const std::exception & e) {
+      slog::err << "Failed to handle output: " << e.what() << slog::endl;
+    }
+  }
+}
+
+void Outputs::AsyncOutput::acceptView(const dynamic_vino_lib::ResultView & view)
+{
+  std::lock_guard<std::mutex> lk(mutex_);
+  pending_.results.push_back(view.share());
+}
@@ -14,6 +14,7 @@
 
 #include "dynamic_vino_lib/outputs/base_output.hpp"
 #include "dynamic_vino_lib/pipeline.hpp"
+#include "dynamic_vino_lib/tracing.hpp"
 
 void Outputs::BaseOutput::setPipeline(Pipeline * const pipeline)
 {
@@ -25,7 +26,73 @@ Pipeline * Outputs::BaseOutput::getPipeline() const
   return pipeline_;
 }
 
+void Outputs::BaseOutput::tracePublish(const std::string & topic) const
+{
+  DYNAMIC_VINO_LIB_TRACE(publish, pipeline_ == nullptr ? std::string() : pipeline_->getName(),
+    topic, pipeline_ == nullptr && !has_times_ ? 0 : getFrameTimes().frame_id, 0);
+}
+
 cv::Mat Outputs::BaseOutput::getFrame() const
 {
   return frame_;
 }
+
+void Outputs::BaseOutput::setFrameHeader(const std_msgs::msg::Header & header)
+{
+  header_ = header;
+  has_header_ = true;
+}
+
+std_msgs::msg::Header Outputs::BaseOutput::getFrameHeader() const
+{
+  return has_header_ ? header_ : pipeline_->getFrameHeader();
+}
+
+void Outputs::BaseOutput::setFrameTimes(const FrameTimes & times)
+{
+  times_ = times;
+  has_times_ = true;
+}
+
+FrameTimes Outputs::BaseOutput::getFrameTimes() const
+{
+  return has_times_ ? times_ : pipeline_->getFrameTimes();
+}
+
+void Outputs::BaseOutput::setFrameScale(float scale)
+{
+  scale_ = scale;
+  has_scale_ = true;
+}
+
+float Outputs::BaseOutput::getFrameScale() const
+{
+  return has_scale_ || pipeline_ == nullptr ? scale_ : pipeline_->getFrameScale();
+}
+
+cv::Rect Outputs::BaseOutput::toNative(const cv::Rect & rect) const
+{
+  float scale = getFrameScale();
+  if (scale == 1) {
+    return rect;
+  }
+  return cv::Rect(cvRound(rect.x * scale), cvRound(rect.y * scale),
+           cvRound(rect.width * scale), cvRound(rect.height * scale));
+}
+
+cv::Point Outputs::BaseOutput::toNative(const cv::Point & point) const
+{
+  float scale = getFrameScale();
+  return scale == 1 ? point : cv::Point(cvRound(point.x * scale), cvRound(point.y * scale));
+}
+
+void Outputs::BaseOutput::setRate(const OutputRate & rate)
+{
+  rate_gate_.setRate(rate);
+}
+
+bool Outputs::BaseOutput::admitFrame()
+{
+  skipping_ = !rate_gate_.isDue();
+  return !skipping_;
+}
@@ -0,0 +1,427 @@
+// Copyright (c) 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @brief a header file with declaration of OverlayRenderer class
+ * @file overlay_renderer.cpp
+ */
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "dynamic_vino_lib/outputs/overlay_renderer.hpp"
+#include "dynamic_vino_lib/pipeline.hpp"
+#include "dynamic_vino_lib/utils/frame_pool.hpp"
+
+Outputs::OverlayRenderer::OverlayRenderer(int focal_length)
+: focal_length_(focal_length)
+{
+}
+
+void Outputs::OverlayRenderer::feedFrame(const cv::Mat & frame)
+{
+  // shared, copied by getCanvas() only when drawn on
+  frame_ = frame;
+  canvas_.release();
+  if (camera_matrix_.empty()) {
+    int cx = frame.cols / 2;
+    int cy = frame.rows / 2;
+    camera_matrix_ = cv::Mat::zeros(3, 3, CV_32F);
+    camera_matrix_.at<float>(0) = focal_length_;
+    camera_matrix_.at<float>(2) = static_cast<float>(cx);
+    camera_matrix_.at<float>(4) = focal_length_;
+    camera_matrix_.at<float>(5) = static_cast<float>(cy);
+    camera_matrix_.at<float>(8) = 1;
+  }
+}
+
+cv::Mat & Outputs::OverlayRenderer::getCanvas()
+{
+  if (canvas_.empty() && !frame_.empty()) {
+    // into a recycled buffer
+    if (scale_ == 1) {
+      canvas_ = FramePool::clone(frame_);
+    } else {
+      cv::Size size(std::max(1, cvRound(frame_.cols * scale_)),
+        std::max(1, cvRound(frame_.rows * scale_)));
+      canvas_ = FramePool::create(size, frame_.type());
+      cv::resize(frame_, canvas_, size, 0, 0, cv::INTER_AREA);
+    }
+  }
+  return canvas_;
+}
+
+void Outputs::OverlayRenderer::clearData()
+{
+  outputs_.clear();
+  output_index_.clear();
+  colored_mask_.release();
+  instance_masks_.clear();
+  canvas_.release();
+}
+
+unsigned Outputs::OverlayRenderer::findOutput(
+  const cv::Rect & result_rect)
+{
+  auto iter = output_index_.find(result_rect);
+  if (iter != output_index_.end()) {
+    return iter->second;
+  }
+  OutputData output;
+  output.scalar = cv::Scalar(255, 0, 0);
+  outputs_.push_back(output);
+  output_index_.emplace(result_rect, outputs_.size() - 1);
+  return outputs_.size() - 1;
+}
+
+std::string Outputs::OverlayRenderer::describe(const OutputData & output)
+{
+  std::ostringstream ostream;
+  for (auto & tag : output.tags) {
+    switch (tag.kind) {
+      case DescTag::Confidence:
+        ostream << "[" << std::fixed << std::setprecision(3) << tag.value << "]";
+        break;
+      case DescTag::Age:
+        ostream << "[Y" << std::fixed << std::setprecision(0) << tag.value << "]";
+        break;
+      case DescTag::TrackId:
+        ostream << "[#" << static_cast<int>(tag.value) << "]";
+        break;
+      default:
+        ostream << "[" << tag.text << "]";
+        break;
+    }
+  }
+  return ostream.str();
+}
+
+void Outputs::OverlayRenderer::accept(
+  const std::vector<dynamic_vino_lib::LicensePlateDetectionResult> & results)
+{
+  for (unsigned i = 0; i < results.size(); i++) {
+    cv::Rect result_rect = results[i].getLocation();
+    unsigned target_index = findOutput(result_rect);
+    outputs_[target_index].rect = result_rect;
+    outputs_[target_index].tags.push_back({DescTag::Text, 0, results[i].getLicense()});
+  }
+}
+
+void Outputs::OverlayRenderer::accept(
+  const std::vector<dynamic_vino_lib::VehicleAttribsDetectionResult> & results)
+{
+  for (unsigned i = 0; i < results.size(); i++) {
+    cv::Rect result_rect = results[i].getLocation();
+    unsigned target_index = findOutput(result_rect);
+    outputs_[target_index].rect = result_rect;
+    outputs_[target_index].tags.push_back(
+      {DescTag::Text, 0, results[i].getColor() + "," + results[i].getType()});
+  }
+}
+
+void Outputs::OverlayRenderer::accept(
+  const std::vector<dynamic_vino_lib::FaceReidentificationResult> & results)
+{
+  for (unsigned i = 0; i < results.size(); i++) {
+    cv::Rect result_rect = results[i].getLocation();
+    unsigned target_index = findOutput(result_rect);
+    outputs_[target_index].rect = result_rect;
+    outputs_[target_index].tags.push_back({DescTag::Text, 0, results[i].getFaceID()});
+  }
+}
+
+void Outputs::OverlayRenderer::accept(
+  const std::vector<dynamic_vino_lib::LandmarksDetectionResult> & results)
+{
+  for (unsigned i = 0; i < results.size(); i++) {
+    cv::Rect result_rect = results[i].getLocation();
+    unsigned target_index = findOutput(result_rect);
+    std::vector<cv::Point> landmark_points = results[i].getLandmarks();
+    for (int j = 0; j < landmark_points.size(); j++) {
+      outputs_[target_index].landmarks.push_back(landmark_points[j]);
+    }
+  }
+}
+
+void Outputs::OverlayRenderer::accept(
+  const std::vector<dynamic_vino_lib::PersonAttribsDetectionResult> & results)
+{
+  for (unsigned i = 0; i < results.size(); i++) {
+    cv::Rect result_rect = results[i].getLocation();
+    unsigned target_index = findOutput(result_rect);
+    if (results[i].getMaleProbability() < 0.5) {
+      outputs_[target_index].scalar = cv::Scalar(0, 0, 255);
+    }
+    else{
+      outputs_[target_index].scalar = cv::Scalar(0, 255, 0);
+    }
+    outputs_[target_index].pa_top.x = results[i].getTopLocation().x*result_rect.width + result_rect.x;
+    outputs_[target_index].pa_top.y = results[i].getTopLocation().y*result_rect.height + result_rect.y;
+    outputs_[target_index].pa_bottom.x = results[i].getBottomLocation().x*result_rect.width + result_rect.x;
+    outputs_[target_index].pa_bottom.y = results[i].getBottomLocation().y*result_rect.height + result_rect.y;
+
+    outputs_[target_index].rect = result_rect;
+    outputs_[target_index].tags.push_back({DescTag::Text, 0, results[i].getAttributes()});
+  }
+}
+
+void Outputs::OverlayRenderer::accept(
+  const std::vector<dynamic_vino_lib::PersonReidentificationResult> & results)
+{
+  for (unsigned i = 0; i < results.size(); i++) {
+    cv::Rect result_rect = results[i].getLocation();
+    unsigned target_index = findOutput(result_rect);
+    outputs_[target_index].rect = result_rect;
+    outputs_[target_index].tags.push_back({DescTag::Text, 0, results[i].getPersonID()});
+  }
+}
+
+void Outputs::OverlayRenderer::mergeMask(cv::Mat & canvas)
+{
+  const float alpha = 0.5f;
+  cv::Mat colored_mask = colored_mask_;
+  if (colored_mask.size() != canvas.size()) {
+    cv::resize(colored_mask, mask_, canvas.size(), 0, 0, cv::INTER_NEAREST);
+    colored_mask = mask_;
+  }
+  cv::addWeighted(colored_mask, alpha, canvas, 1.0f - alpha, 0.0f, canvas);
+}
+
+void Outputs::OverlayRenderer::accept(
+  const std::vector<dynamic_vino_lib::ObjectSegmentationResult> & results)
+{
+  for (unsigned i = 0; i < results.size(); i++) {
+    cv::Rect result_rect = results[i].getLocation();
+    unsigned target_index = findOutput(result_rect);
+    outputs_[target_index].rect = result_rect;
+    auto fd_conf = results[i].getConfidence();
+    if (fd_conf >= 0) {
+      outputs_[target_index].tags.push_back({DescTag::Confidence, fd_conf, ""});
+    }
+    outputs_[target_index].tags.push_back({DescTag::Text, 0, results[i].getLabel()});
+  }
+  // colorized at the resolution of the network output, upscaled once when rendered
+  if (!results.empty() && !results[0].isInstance()) {
+    colored_mask_ = results[0].getMask();
+  }
+  for (auto & result : results) {
+    if (result.isInstance()) {
+      instance_masks_.push_back(
+        {result.getLocation(), result.getMask(), result.getClassMap() != 0});
+    }
+  }
+}
+
+void Outputs::OverlayRenderer::accept(
+  const std::vector<dynamic_vino_lib::FaceDetectionResult> & results)
+{
+  for (unsigned i = 0; i < results.size(); i++) {
+    cv::Rect result_rect = results[i].getLocation();
+    unsigned target_index = findOutput(result_rect);
+    outputs_[target_index].rect = result_rect;
+    auto fd_conf = results[i].getConfidence();
+    if (fd_conf >= 0) {
+      outputs_[target_index].tags.push_back({DescTag::Confidence, fd_conf, ""});
+    }
+  }
+}
+
+void Outputs::OverlayRenderer::accept(
+  const std::vector<dynamic_vino_lib::ObjectDetectionResult> & results)
+{
+  for (unsigned i = 0; i < results.size(); i++) {
+    cv::Rect result_rect = results[i].getLocation();
+    unsigned target_index = findOutput(result_rect);
+    outputs_[target_index].rect = result_rect;
+    auto fd_conf = results[i].getConfidence();
+    if (fd_conf >= 0) {
+      outputs_[target_index].tags.push_back({DescTag::Confidence, fd_conf, ""});
+    }
+    outputs_[target_index].tags.push_back({DescTag::Text, 0, results[i].getLabel()});
+    if (results[i].getTrackId() >= 0) {
+      outputs_[target_index].tags.push_back(
+        {DescTag::TrackId, static_cast<float>(results[i].getTrackId()), ""});
+    }
+  }
+}
+
+void Outputs::OverlayRenderer::accept(
+  const std::vector<dynamic_vino_lib::EmotionsResult> & results)
+{
+  for (unsigned i = 0; i < results.size(); i++) {
+    cv::Rect result_rect = results[i].getLocation();
+    unsigned target_index = findOutput(result_rect);
+    outputs_[target_index].rect = result_rect;
+    outputs_[target_index].tags.push_back({DescTag::Text, 0, results[i].getLabel()});
+  }
+}
+
+void Outputs::OverlayRenderer::accept(
+  const std::vector<dynamic_vino_lib::AgeGenderResult> & results)
+{
+  for (unsigned i = 0; i < results.size(); i++) {
+    cv::Rect result_rect = results[i].getLocation();
+    unsigned target_index = findOutput(result_rect);
+    outputs_[target_index].rect = result_rect;
+    outputs_[target_index].tags.push_back(
+      {DescTag::Age, static_cast<float>(results[i].getAge()), ""});
+
+    auto male_prob = results[i].getMaleProbability();
+    if (male_prob < 0.5) {
+      outputs_[target_index].scalar = cv::Scalar(0, 0, 255);
+    }
+  }
+}
+
+cv::Point Outputs::OverlayRenderer::calcAxis(
+  cv::Mat r, double cx, double cy, double cz,
+  cv::Point cp)
+{
+  cv::Mat Axis(3, 1, CV_32F);
+  Axis.at<float>(0) = cx;
+  Axis.at<float>(1) = cy;
+  Axis.at<float>(2) = cz;
+  cv::Mat o(3, 1, CV_32F, cv::Scalar(0));
+  o.at<float>(2) = camera_matrix_.at<float>(0);
+  Axis = r * Axis + o;
+  cv::Point point;
+  point.x = static_cast<int>((Axis.at<float>(0) / Axis.at<float>(2) * camera_matrix_.at<float>(0)) +
+    cp.x);
+  point.y = static_cast<int>((Axis.at<float>(1) / Axis.at<float>(2) * camera_matrix_.at<float>(4)) +
+    cp.y);
+  return point;
+}
+
+cv::Mat Outputs::OverlayRenderer::getRotationTransform(double yaw, double pitch, double roll)
+{
+  pitch *= CV_PI / 180.0;
+  yaw *= CV_PI / 180.0;
+  roll *= CV_PI / 180.0;
+  cv::Matx33f Rx(1, 0, 0, 0, cos(pitch), -sin(pitch), 0, sin(pitch), cos(pitch));
+  cv::Matx33f Ry(cos(yaw), 0, -sin(yaw), 0, 1, 0, sin(yaw), 0, cos(yaw));
+  cv::Matx33f Rz(cos(roll), -sin(roll), 0, sin(roll), cos(roll), 0, 0, 0, 1);
+  auto r = cv::Mat(Rz * Ry * Rx);
+  return r;
+}
+
+void Outputs::OverlayRenderer::accept(
+  const std::vector<dynamic_vino_lib::HeadPoseResult> & results)
+{
+  for (unsigned i = 0; i < results.size(); i++) {
+    auto result = results[i];
+    cv::Rect result_rect = result.getLocation();
+    unsigned target_index = findOutput(result_rect);
+    outputs_[target_index].rect = result_rect;
+    double yaw = result.getAngleY();
+    double pitch = result.getAngleP();
+    double roll = result.getAngleR();
+    double scale = 50;
+    cv::Mat r = getRotationTransform(yaw, pitch, roll);
+    cv::Rect location = result.getLocation();
+    auto cp = cv::Point(location.x + location.width / 2, location.y + location.height / 2);
+    outputs_[target_index].hp_cp = cp;
+    outputs_[target_index].hp_x = calcAxis(r, scale, 0, 0, cp);
+    outputs_[target_index].hp_y = calcAxis(r, 0, -scale, 0, cp);
+    outputs_[target_index].hp_ze = calcAxis(r, 0, 0, -scale, cp);
+    outputs_[target_index].hp_zs = calcAxis(r, 0, 0, scale, cp);
+  }
+}
+
+void Outputs::OverlayRenderer::mergeInstanceMasks(cv::Mat & canvas)
+{
+  const float alpha = 0.5f;
+  const cv::Rect bounds(cv::Point(), canvas.size());
+  cv::Mat colored;
+  cv::Mat object;
+  cv::Mat blended;
+  for (auto & instance : instance_masks_) {
+    if (instance.colored.empty()) {
+      continue;
+    }
+    cv::Rect rect(toCanvas(instance.rect.tl()), toCanvas(instance.rect.br()));
+    cv::Rect visible = rect & bounds;
+    if (visible.area() == 0) {
+      continue;
+    }
+    colored = instance.colored;
+    object = instance.object;
+    if (rect.size() != colored.size()) {
+      cv::resize(instance.colored, colored, rect.size(), 0, 0, cv::INTER_NEAREST);
+      cv::resize(instance.object, object, rect.size(), 0, 0, cv::INTER_NEAREST);
+    }
+    const cv::Rect crop(visible.tl() - rect.tl(), visible.size());
+    cv::Mat target = canvas(visible);
+    // only the pixels of the object are blended, the rest of the box is kept
+    cv::addWeighted(colored(crop), alpha, target, 1.0f - alpha, 0.0f, blended);
+    blended.copyTo(target, object(crop));
+  }
+  instance_masks_.clear();
+}
+
+void Outputs::OverlayRenderer::render(Pipeline * pipeline)
+{
+  if (frame_.empty()) {
+    return;
+  }
+  cv::Mat & canvas = getCanvas();
+  if (!colored_mask_.empty()) {
+    mergeMask(canvas);
+    colored_mask_.release();
+  }
+  if (!instance_masks_.empty()) {
+    mergeInstanceMasks(canvas);
+  }
+  if (pipeline != nullptr && pipeline->getParameters()->isGetFps()) {
+    int fps = pipeline->getFPS();
+    int dropped_fps = pipeline->getDroppedFPS();
+    std::stringstream ss;
+    ss << "FPS: " << fps;
+    if (dropped_fps > 0) {
+      ss << " (dropped: " << dropped_fps << ")";
+    }
+    cv::putText(canvas, ss.str(), cv::Point2f(0, 65), cv::FONT_HERSHEY_TRIPLEX, 0.5,
+      cv::Scalar(255, 0, 0));
+  }
+  // the text is shrunk with the canvas, down to a readable size
+  double font_scale = 0.8 * std::max(scale_, 0.5f);
+  for (auto & o : outputs_) {
+    cv::Rect rect(toCanvas(o.rect.tl()), toCanvas(o.rect.br()));
+    auto new_y = std::max(15, rect.y - 15);
+    cv::putText(canvas, describe(o), cv::Point2f(rect.x, new_y), cv::FONT_HERSHEY_COMPLEX_SMALL,
+      font_scale, o.scalar);
+    cv::rectangle(canvas, rect, o.scalar, 1);
+    if (o.pa_top != o.pa_bottom) {
+      cv::circle(canvas, toCanvas(o.pa_top), 3, cv::Scalar(255, 0, 0), 2);
+      cv::circle(canvas, toCanvas(o.pa_bottom), 3, cv::Scalar(0, 255, 0), 2);
+    }
+    if (o.hp_cp != o.hp_x) {
+      cv::line(canvas, toCanvas(o.hp_cp), toCanvas(o.hp_x), cv::Scalar(0, 0, 255), 2);
+    }
+    if (o.hp_cp != o.hp_y) {
+      cv::line(canvas, toCanvas(o.hp_cp), toCanvas(o.hp_y), cv::Scalar(0, 255, 0), 2);
+    }
+    if (o.hp_zs != o.hp_ze) {
+      cv::line(canvas, toCanvas(o.hp_zs), toCanvas(o.hp_ze), cv::Scalar(255, 0, 0), 2);
+      cv::circle(canvas, toCanvas(o.hp_ze), 3, cv::Scalar(255, 0, 0), 2);
+    }
+    for (auto & landmark : o.landmarks) {
+      cv::circle(canvas, toCanvas(landmark), 3, cv::Scalar(255, 0, 0), 2);
+    }
+  }
+  outputs_.clear();
+  output_index_.clear();
+}
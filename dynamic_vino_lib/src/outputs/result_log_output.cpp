@@ -0,0 +1,365 @@
+// Copyright (c) 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @brief An implementation file with implementation for ResultLogOutput Class
+ * @file result_log_output.cpp
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "dynamic_vino_lib/outputs/result_log_output.hpp"
+#include "dynamic_vino_lib/pipeline.hpp"
+#include "dynamic_vino_lib/slog.hpp"
+
+// the batches waiting for the worker at most, the oldest is dropped beyond
+static const size_t kResultLogQueueCapacity = 16;
+
+void Outputs::ResultLogOutput::Columns::reserve(size_t rows)
+{
+  frame.reserve(rows);
+  stamp_ns.reserve(rows);
+  kind.reserve(rows);
+  x.reserve(rows);
+  y.reserve(rows);
+  width.reserve(rows);
+  height.reserve(rows);
+  label_id.reserve(rows);
+  confidence.reserve(rows);
+  track_id.reserve(rows);
+  text_offsets.reserve(rows + 1);
+}
+
+void Outputs::ResultLogOutput::Columns::truncate(size_t rows)
+{
+  if (rows >= size()) {
+    return;
+  }
+  frame.resize(rows);
+  stamp_ns.resize(rows);
+  kind.resize(rows);
+  x.resize(rows);
+  y.resize(rows);
+  width.resize(rows);
+  height.resize(rows);
+  label_id.resize(rows);
+  confidence.resize(rows);
+  track_id.resize(rows);
+  text.resize(text_offsets[rows]);
+  text_offsets.resize(rows + 1);
+}
+
+Outputs::ResultLogOutput::ResultLogOutput(const std::string & output_name)
+: BaseOutput(output_name)
+{
+  columns_.reserve(batch_rows_);
+  worker_ = std::thread(&ResultLogOutput::run, this);
+}
+
+Outputs::ResultLogOutput::~ResultLogOutput()
+{
+  // the rows of the frames handled so far are written, not those of a frame
+  // being accepted
+  columns_.truncate(frame_rows_);
+  if (columns_.frames > 0) {
+    push();
+  }
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    stopped_ = true;
+  }
+  cond_.notify_all();
+  if (worker_.joinable()) {
+    worker_.join();
+  }
+}
+
+void Outputs::ResultLogOutput::setLogging(
+  const std::string & directory, int batch_rows, float flush)
+{
+  directory_ = directory.empty() ? "." : directory;
+  batch_rows_ = static_cast<size_t>(std::max(batch_rows, 1));
+  flush_ = std::chrono::duration_cast<Clock::duration>(
+    std::chrono::duration<double>(std::max(flush, 0.0f)));
+  columns_.reserve(batch_rows_);
+}
+
+void Outputs::ResultLogOutput::clearData()
+{
+  columns_.truncate(frame_rows_);
+}
+
+void Outputs::ResultLogOutput::addRow(
+  ResultLog::RowKind kind, const cv::Rect & location, int label_id, float confidence,
+  int track_id, const std::string & text)
+{
+  // in the pixels of the native frame, like the topics
+  cv::Rect native = toNative(location);
+  // stamped with the frame by handleOutput
+  columns_.frame.push_back(0);
+  columns_.stamp_ns.push_back(0);
+  columns_.kind.push_back(kind);
+  columns_.x.push_back(static_cast<float>(native.x));
+  columns_.y.push_back(static_cast<float>(native.y));
+  columns_.width.push_back(static_cast<float>(native.width));
+  columns_.height.push_back(static_cast<float>(native.height));
+  columns_.label_id.push_back(label_id);
+  columns_.confidence.push_back(confidence);
+  columns_.track_id.push_back(track_id);
+  columns_.text += text;
+  columns_.text_offsets.push_back(static_cast<uint32_t>(columns_.text.size()));
+}
+
+void Outputs::ResultLogOutput::handleOutput()
+{
+  auto now = Clock::now();
+  if (columns_.frames == 0) {
+    batch_start_ = now;
+  }
+  auto stamp = getFrameHeader().stamp;
+  int64_t stamp_ns = static_cast<int64_t>(stamp.sec) * 1000000000LL + stamp.nanosec;
+  for (size_t row = frame_rows_; row < columns_.size(); row++) {
+    columns_.frame[row] = frame_index_;
+    columns_.stamp_ns[row] = stamp_ns;
+  }
+  frame_index_++;
+  columns_.frames++;
+  frame_rows_ = columns_.size();
+  if (columns_.size() >= batch_rows_ ||
+    (flush_.count() > 0 && now - batch_start_ >= flush_))
+  {
+    push();
+  }
+}
+
+void Outputs::ResultLogOutput::push()
+{
+  Columns batch;
+  batch.reserve(batch_rows_);
+  std::swap(batch, columns_);
+  frame_rows_ = 0;
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    if (queue_.size() >= kResultLogQueueCapacity) {
+      slog::warn << "The result log " << output_name_ << " is behind, dropping " <<
+        queue_.front().size() << " rows" << slog::endl;
+      queue_.pop_front();
+    }
+    queue_.push_back(std::move(batch));
+  }
+  cond_.notify_one();
+}
+
+void Outputs::ResultLogOutput::run()
+{
+  while (true) {
+    Columns batch;
+    {
+      std::unique_lock<std::mutex> lk(mutex_);
+      cond_.wait(lk, [this] {return stopped_ || !queue_.empty();});
+      if (queue_.empty()) {
+        // stopped, with the queued batches written
+        break;
+      }
+      batch = std::move(queue_.front());
+      queue_.pop_front();
+    }
+    if (file_ == nullptr && !failed_) {
+      failed_ = !openFile();
+    }
+    if (file_ != nullptr && !writeBatch(batch)) {
+      slog::err << "Failed to write the result log " << output_name_ << ": " <<
+        std::strerror(errno) << slog::endl;
+    }
+  }
+  if (file_ != nullptr) {
+    std::fclose(file_);
+    file_ = nullptr;
+  }
+}
+
+bool Outputs::ResultLogOutput::openFile()
+{
+  std::time_t now = std::time(nullptr);
+  std::tm local_time;
+  localtime_r(&now, &local_time);
+  std::ostringstream path;
+  path << directory_ << "/" << output_name_ << "_" <<
+    std::put_time(&local_time, "%Y%m%d_%H%M%S") << ".ovrl";
+  file_ = std::fopen(path.str().c_str(), "wb");
+  if (file_ == nullptr) {
+    slog::err << "Failed to open result log " << path.str() << ": " << std::strerror(errno) <<
+      slog::endl;
+    return false;
+  }
+  ResultLog::FileHeader header{};
+  header.magic = ResultLog::kMagic;
+  header.version = ResultLog::kVersion;
+  if (std::fwrite(&header, sizeof(header), 1, file_) != 1) {
+    std::fclose(file_);
+    file_ = nullptr;
+    return false;
+  }
+  slog::info << "Logging results into " << path.str() << slog::endl;
+  return true;
+}
+
+namespace
+{
+template<typename T>
+bool writeColumn(FILE * file, const T * values, size_t count)
+{
+  static const char padding[8] = {};
+  size_t bytes = count * sizeof(T);
+  size_t padded = Outputs::ResultLog::align(bytes) - bytes;
+  return (bytes == 0 || std::fwrite(values, 1, bytes, file) == bytes) &&
+         (padded == 0 || std::fwrite(padding, 1, padded, file) == padded);
+}
+}  // namespace
+
+bool Outputs::ResultLogOutput::writeBatch(const Columns & columns)
+{
+  ResultLog::BatchHeader header{};
+  header.magic = ResultLog::kBatchMagic;
+  header.rows = static_cast<uint32_t>(columns.size());
+  header.frames = columns.frames;
+  header.text_bytes = columns.text.size();
+  header.bytes = ResultLog::getBatchBytes(header.rows, header.text_bytes);
+  bool written = std::fwrite(&header, sizeof(header), 1, file_) == 1 &&
+    writeColumn(file_, columns.frame.data(), columns.frame.size()) &&
+    writeColumn(file_, columns.stamp_ns.data(), columns.stamp_ns.size()) &&
+    writeColumn(file_, columns.kind.data(), columns.kind.size()) &&
+    writeColumn(file_, columns.x.data(), columns.x.size()) &&
+    writeColumn(file_, columns.y.data(), columns.y.size()) &&
+    writeColumn(file_, columns.width.data(), columns.width.size()) &&
+    writeColumn(file_, columns.height.data(), columns.height.size()) &&
+    writeColumn(file_, columns.label_id.data(), columns.label_id.size()) &&
+    writeColumn(file_, columns.confidence.data(), columns.confidence.size()) &&
+    writeColumn(file_, columns.track_id.data(), columns.track_id.size()) &&
+    writeColumn(file_, columns.text_offsets.data(), columns.text_offsets.size()) &&
+    writeColumn(file_, columns.text.data(), columns.text.size());
+  // a batch is complete in the file once flushed, for the readers of a live log
+  return written && std::fflush(file_) == 0;
+}
+
+void Outputs::ResultLogOutput::accept(
+  const std::vector<dynamic_vino_lib::LicensePlateDetectionResult> & results)
+{
+  for (auto & r : results) {
+    addRow(ResultLog::kKindLicensePlate, r.getLocation(), -1, 1, -1, r.getLicense());
+  }
+}
+
+void Outputs::ResultLogOutput::accept(
+  const std::vector<dynamic_vino_lib::VehicleAttribsDetectionResult> & results)
+{
+  for (auto & r : results) {
+    addRow(ResultLog::kKindVehicleAttributes, r.getLocation(), -1, 1, -1,
+      "color=" + r.getColor() + ";type=" + r.getType());
+  }
+}
+
+void Outputs::ResultLogOutput::accept(
+  const std::vector<dynamic_vino_lib::FaceReidentificationResult> & results)
+{
+  for (auto & r : results) {
+    addRow(ResultLog::kKindFaceReidentification, r.getLocation(), -1, 1, -1, r.getFaceID());
+  }
+}
+
+void Outputs::ResultLogOutput::accept(
+  const std::vector<dynamic_vino_lib::LandmarksDetectionResult> & results)
+{
+  for (auto & r : results) {
+    std::ostringstream points;
+    for (auto & point : r.getLandmarks()) {
+      cv::Point native = toNative(point);
+      points << (points.tellp() > 0 ? ";" : "") << native.x << "," << native.y;
+    }
+    addRow(ResultLog::kKindLandmarks, r.getLocation(), -1, 1, -1, points.str());
+  }
+}
+
+void Outputs::ResultLogOutput::accept(
+  const std::vector<dynamic_vino_lib::PersonAttribsDetectionResult> & results)
+{
+  for (auto & r : results) {
+    addRow(ResultLog::kKindPersonAttributes, r.getLocation(), -1, 1, -1, r.getAttributes());
+  }
+}
+
+void Outputs::ResultLogOutput::accept(
+  const std::vector<dynamic_vino_lib::PersonReidentificationResult> & results)
+{
+  for (auto & r : results) {
+    addRow(ResultLog::kKindPersonReidentification, r.getLocation(), -1, 1, -1,
+      r.getPersonID());
+  }
+}
+
+void Outputs::ResultLogOutput::accept(
+  const std::vector<dynamic_vino_lib::ObjectSegmentationResult> & results)
+{
+  for (auto & r : results) {
+    addRow(ResultLog::kKindSegmentation, r.getLocation(), -1, r.getConfidence(), -1,
+      r.getLabel());
+  }
+}
+
+void Outputs::ResultLogOutput::accept(
+  const std::vector<dynamic_vino_lib::ObjectDetectionResult> & results)
+{
+  addDetections(results, ResultLog::kKindObject);
+}
+
+void Outputs::ResultLogOutput::accept(
+  const std::vector<dynamic_vino_lib::FaceDetectionResult> & results)
+{
+  addDetections(results, ResultLog::kKindFace);
+}
+
+void Outputs::ResultLogOutput::accept(
+  const std::vector<dynamic_vino_lib::EmotionsResult> & results)
+{
+  for (auto & r : results) {
+    addRow(ResultLog::kKindEmotion, r.getLocation(), -1, 1, -1, r.getLabel());
+  }
+}
+
+void Outputs::ResultLogOutput::accept(
+  const std::vector<dynamic_vino_lib::AgeGenderResult> & results)
+{
+  for (auto & r : results) {
+    std::ostringstream text;
+    text << "age=" << r.getAge() << ";male=" << r.getMaleProbability();
+    addRow(ResultLog::kKindAgeGender, r.getLocation(), -1, 1, -1, text.str());
+  }
+}
+
+void Outputs::ResultLogOutput::accept(
+  const std::vector<dynamic_vino_lib::HeadPoseResult> & results)
+{
+  for (auto & r : results) {
+    std::ostringstream text;
+    text << "yaw=" << r.getAngleY() << ";pitch=" << r.getAngleP() << ";roll=" << r.getAngleR();
+    addRow(ResultLog::kKindHeadPose, r.getLocation(), -1, 1, -1, text.str());
+  }
+}
@@ -0,0 +1,239 @@
+// Copyright (c) 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @brief An implementation file with implementation for RosAggregateOutput Class
+ * @file ros_aggregate_output.cpp
+ */
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "dynamic_vino_lib/outputs/ros_aggregate_output.hpp"
+#include "dynamic_vino_lib/pipeline.hpp"
+
+void Outputs::FrameResultsMerge::add(
+  FrameResultsPtr frame_results, std::vector<FrameResultsPtr> & ready)
+{
+  const std::string & frame_id = frame_results->header.frame_id;
+  auto hash = frame_id.rfind('#');
+  std::lock_guard<std::mutex> lk(mutex_);
+  // a frame without a position is published as soon as it is done
+  uint64_t position = next_;
+  try {
+    if (hash != std::string::npos) {
+      position = std::stoull(frame_id.substr(hash + 1));
+    }
+  } catch (const std::exception &) {
+  }
+  held_[position] = std::move(frame_results);
+  while (!held_.empty() && held_.begin()->first <= next_) {
+    next_ = held_.begin()->first + 1;
+    ready.push_back(std::move(held_.begin()->second));
+    held_.erase(held_.begin());
+  }
+}
+
+void Outputs::FrameResultsMerge::flush(std::vector<FrameResultsPtr> & ready)
+{
+  std::lock_guard<std::mutex> lk(mutex_);
+  for (auto & held : held_) {
+    next_ = held.first + 1;
+    ready.push_back(std::move(held.second));
+  }
+  held_.clear();
+}
+
+Outputs::RosAggregateOutput::RosAggregateOutput(
+  std::string output_name, const rclcpp::Node::SharedPtr node, int batch_frames)
+: RosTopicOutput(output_name, node), batch_frames_(std::max(batch_frames, 1))
+{
+  if (batch_frames_ > 1) {
+    pub_frame_results_array_ = node_->create_publisher<people_msgs::msg::FrameResultsArray>(
+      "/openvino_toolkit/" + output_name_ + "/frame_results_array", 16);
+  } else {
+    pub_frame_results_ = node_->create_publisher<people_msgs::msg::FrameResults>(
+      "/openvino_toolkit/" + output_name_ + "/frame_results", 16);
+  }
+}
+
+Outputs::RosAggregateOutput::~RosAggregateOutput()
+{
+  // the frames of later segments held for the gaps of the earlier ones
+  if (merge_ != nullptr && rclcpp::ok()) {
+    std::vector<FrameResultsMerge::FrameResultsPtr> ready;
+    merge_->flush(ready);
+    for (auto & frame_results : ready) {
+      publishFrame(std::move(frame_results));
+    }
+  }
+  // the last frames of an offline run, fewer than a batch
+  if (batch_ != nullptr && !batch_->frames.empty() && rclcpp::ok()) {
+    publishBatch();
+  }
+}
+
+people_msgs::msg::RoiResults & Outputs::RosAggregateOutput::getRoiResults(
+  const sensor_msgs::msg::RegionOfInterest & roi)
+{
+  RoiKey key(roi.x_offset, roi.y_offset, roi.width, roi.height);
+  auto found = roi_index_.find(key);
+  if (found != roi_index_.end()) {
+    return frame_results_->rois[found->second];
+  }
+  roi_index_.emplace(key, frame_results_->rois.size());
+  frame_results_->rois.emplace_back();
+  frame_results_->rois.back().roi = roi;
+  return frame_results_->rois.back();
+}
+
+void Outputs::RosAggregateOutput::accept(
+  const std::vector<dynamic_vino_lib::ObjectDetectionResult> & results)
+{
+  RosTopicOutput::accept(results);
+  keepPositions(results);
+}
+
+void Outputs::RosAggregateOutput::accept(
+  const std::vector<dynamic_vino_lib::FaceDetectionResult> & results)
+{
+  RosTopicOutput::accept(results);
+  keepPositions(results);
+}
+
+void Outputs::RosAggregateOutput::handleOutput()
+{
+  frame_results_ = std::make_unique<people_msgs::msg::FrameResults>();
+  frame_results_->header = getFrameHeader();
+  roi_index_.clear();
+  // the detections first, the regions of the other results are theirs
+  for (auto * boxes : {faces_topic_.get(), detected_objects_topic_.get()}) {
+    if (boxes == nullptr) {
+      continue;
+    }
+    for (auto & box : boxes->objects_vector) {
+      getRoiResults(box.roi).detections.push_back(box.object);
+    }
+  }
+  for (auto & position : positions_) {
+    sensor_msgs::msg::RegionOfInterest roi;
+    roi.x_offset = position.first.x;
+    roi.y_offset = position.first.y;
+    roi.width = position.first.width;
+    roi.height = position.first.height;
+    auto & roi_results = getRoiResults(roi);
+    roi_results.has_position = true;
+    roi_results.position.x = position.second.x;
+    roi_results.position.y = position.second.y;
+    roi_results.position.z = position.second.z;
+  }
+  positions_.clear();
+  if (emotions_topic_ != nullptr) {
+    for (auto & emotion : emotions_topic_->emotions) {
+      getRoiResults(emotion.roi).emotions.push_back(emotion);
+    }
+  }
+  if (age_gender_topic_ != nullptr) {
+    for (auto & age_gender : age_gender_topic_->objects) {
+      getRoiResults(age_gender.roi).agegenders.push_back(age_gender);
+    }
+  }
+  if (headpose_topic_ != nullptr) {
+    for (auto & headpose : headpose_topic_->headposes) {
+      getRoiResults(headpose.roi).headposes.push_back(headpose);
+    }
+  }
+  if (landmarks_topic_ != nullptr) {
+    for (auto & landmark : landmarks_topic_->landmarks) {
+      getRoiResults(landmark.roi).landmarks.push_back(landmark);
+    }
+  }
+  if (person_attribs_topic_ != nullptr) {
+    for (auto & attribute : person_attribs_topic_->attributes) {
+      getRoiResults(attribute.roi).attributes.push_back(attribute);
+    }
+  }
+  for (auto * reids : {face_reid_topic_.get(), person_reid_topic_.get()}) {
+    if (reids == nullptr) {
+      continue;
+    }
+    for (auto & reid : reids->reidentified_vector) {
+      getRoiResults(reid.roi).reidentifications.push_back(reid);
+    }
+  }
+  if (vehicle_attribs_topic_ != nullptr) {
+    for (auto & vehicle : vehicle_attribs_topic_->vehicles) {
+      getRoiResults(vehicle.roi).vehicles.push_back(vehicle);
+    }
+  }
+  if (license_plate_topic_ != nullptr) {
+    for (auto & license : license_plate_topic_->licenses) {
+      getRoiResults(license.roi).licenses.push_back(license);
+    }
+  }
+  if (segmented_objects_topic_ != nullptr) {
+    frame_results_->segmented_objects = std::move(segmented_objects_topic_->objects_vector);
+  }
+
+  // each built once per frame, by the results of the frame
+  license_plate_topic_ = nullptr;
+  vehicle_attribs_topic_ = nullptr;
+  landmarks_topic_ = nullptr;
+  face_reid_topic_ = nullptr;
+  person_attribs_topic_ = nullptr;
+  person_reid_topic_ = nullptr;
+  segmented_objects_topic_ = nullptr;
+  detected_objects_topic_ = nullptr;
+  faces_topic_ = nullptr;
+  emotions_topic_ = nullptr;
+  age_gender_topic_ = nullptr;
+  headpose_topic_ = nullptr;
+
+  if (merge_ != nullptr) {
+    std::vector<FrameResultsMerge::FrameResultsPtr> ready;
+    merge_->add(std::move(frame_results_), ready);
+    for (auto & frame_results : ready) {
+      publishFrame(std::move(frame_results));
+    }
+  } else {
+    publishFrame(std::move(frame_results_));
+  }
+  publishLatency();
+}
+
+void Outputs::RosAggregateOutput::publishFrame(
+  std::unique_ptr<people_msgs::msg::FrameResults> frame_results)
+{
+  if (pub_frame_results_ != nullptr) {
+    publishMessage(pub_frame_results_, std::move(frame_results));
+    tracePublish("frame_results");
+    return;
+  }
+  if (batch_ == nullptr) {
+    batch_ = std::make_unique<people_msgs::msg::FrameResultsArray>();
+    batch_->frames.reserve(batch_frames_);
+  }
+  batch_->frames.push_back(std::move(*frame_results));
+  if (batch_->frames.size() >= batch_frames_) {
+    publishBatch();
+  }
+}
+
+void Outputs::RosAggregateOutput::publishBatch()
+{
+  publishMessage(pub_frame_results_array_, std::move(batch_));
+  tracePublish("frame_results_array");
+}
@@ -17,12 +17,17 @@
  * @file ros_topic_output.cpp
  */
 
+#include <algorithm>
+#include <chrono>
 #include <vector>
 #include <string>
 #include <memory>
+#include <utility>
 #include "dynamic_vino_lib/outputs/ros_topic_output.hpp"
 #include "dynamic_vino_lib/pipeline_params.hpp"
 #include "dynamic_vino_lib/pipeline.hpp"
+#include "dynamic_vino_lib/slog.hpp"
+#include "dynamic_vino_lib/utils/mask_codec.hpp"
 #include "cv_bridge/cv_bridge.h"
 
 Outputs::RosTopicOutput::RosTopicOutput(std::string output_name,
@@ -38,33 +43,7 @@ Outputs::RosTopicOutput::RosTopicOutput(std::string output_name,
   } else {
     node_ = rclcpp::Node::make_shared(output_name + "_topic_publisher");
   }
-  pub_license_plate_ = node_->create_publisher<people_msgs::msg::LicensePlateStamped>(
-    "/openvino_toolkit/" + output_name_ + "/detected_license_plates", 16);
-  pub_vehicle_attribs_ = node_->create_publisher<people_msgs::msg::VehicleAttribsStamped>(
-    "/openvino_toolkit/" + output_name_ + "/detected_vehicles_attribs", 16);
-  pub_landmarks_ = node_->create_publisher<people_msgs::msg::LandmarkStamped>(
-    "/openvino_toolkit/" + output_name_ + "/detected_landmarks", 16);
-  pub_face_reid_ = node_->create_publisher<people_msgs::msg::ReidentificationStamped>(
-    "/openvino_toolkit/" + output_name_ + "/reidentified_faces", 16);
-  pub_person_attribs_ = node_->create_publisher<people_msgs::msg::PersonAttributeStamped>(
-    "/openvino_toolkit/" + output_name_ + "/person_attributes", 16);
-  pub_person_reid_ = node_->create_publisher<people_msgs::msg::ReidentificationStamped>(
-    "/openvino_toolkit/" + output_name_ + "/reidentified_persons", 16);
-  pub_segmented_object_ = node_->create_publisher<people_msgs::msg::ObjectsInMasks>(
-    "/openvino_toolkit/" + output_name_ + "/segmented_obejcts", 16);
-  pub_detected_object_ = node_->create_publisher<object_msgs::msg::ObjectsInBoxes>(
-    "/openvino_toolkit/" + output_name_ + "/detected_objects", 16);
-  pub_face_ =
-    node_->create_publisher<object_msgs::msg::ObjectsInBoxes>(
-    "/openvino_toolkit/" + output_name_ + "/faces", 16);
-  pub_emotion_ =
-    node_->create_publisher<people_msgs::msg::EmotionsStamped>(
-    "/openvino_toolkit/" + output_name_ + "/emotions", 16);
-  pub_age_gender_ = node_->create_publisher<people_msgs::msg::AgeGenderStamped>(
-    "/openvino_toolkit/" + output_name_ + "/age_genders", 16);
-  pub_headpose_ =
-    node_->create_publisher<people_msgs::msg::HeadPoseStamped>(
-    "/openvino_toolkit/" + output_name_ + "/headposes", 16);
+  // the publishers are created by the first results of their type
   emotions_topic_ = nullptr;
   detected_objects_topic_ = nullptr;
   faces_topic_ = nullptr;
@@ -81,17 +60,25 @@ Outputs::RosTopicOutput::RosTopicOutput(std::string output_name,
 
 void Outputs::RosTopicOutput::feedFrame(const cv::Mat & frame)
 {
-  frame_ = frame.clone();
+  // only read, borrow the frame instead of copying it
+  frame_ = frame;
+  for (auto & state : topic_states_) {
+    state.second.decided = false;
+  }
 }
 
 void Outputs::RosTopicOutput::accept(
   const std::vector<dynamic_vino_lib::VehicleAttribsDetectionResult> & results)
 {
-  vehicle_attribs_topic_ = std::make_shared<people_msgs::msg::VehicleAttribsStamped>();
+  if (!isWanted(pub_vehicle_attribs_, "detected_vehicles_attribs")) {
+    return;
+  }
+  vehicle_attribs_topic_ = std::make_unique<people_msgs::msg::VehicleAttribsStamped>();
+  vehicle_attribs_topic_->vehicles.reserve(results.size());
   people_msgs::msg::VehicleAttribs attribs;
   for (auto & r : results) {
     // slog::info << ">";
-    auto loc = r.getLocation();
+    auto loc = toNative(r.getLocation());
     attribs.roi.x_offset = loc.x;
     attribs.roi.y_offset = loc.y;
     attribs.roi.width = loc.width;
@@ -105,11 +92,15 @@ void Outputs::RosTopicOutput::accept(
 void Outputs::RosTopicOutput::accept(
   const std::vector<dynamic_vino_lib::LicensePlateDetectionResult> & results)
 {
-  license_plate_topic_ = std::make_shared<people_msgs::msg::LicensePlateStamped>();
+  if (!isWanted(pub_license_plate_, "detected_license_plates")) {
+    return;
+  }
+  license_plate_topic_ = std::make_unique<people_msgs::msg::LicensePlateStamped>();
+  license_plate_topic_->licenses.reserve(results.size());
   people_msgs::msg::LicensePlate plate;
   for (auto & r : results) {
     // slog::info << ">";
-    auto loc = r.getLocation();
+    auto loc = toNative(r.getLocation());
     plate.roi.x_offset = loc.x;
     plate.roi.y_offset = loc.y;
     plate.roi.width = loc.width;
@@ -122,11 +113,15 @@ void Outputs::RosTopicOutput::accept(
 void Outputs::RosTopicOutput::accept(
   const std::vector<dynamic_vino_lib::FaceReidentificationResult> & results)
 {
-  face_reid_topic_ = std::make_shared<people_msgs::msg::ReidentificationStamped>();
+  if (!isWanted(pub_face_reid_, "reidentified_faces")) {
+    return;
+  }
+  face_reid_topic_ = std::make_unique<people_msgs::msg::ReidentificationStamped>();
+  face_reid_topic_->reidentified_vector.reserve(results.size());
   people_msgs::msg::Reidentification face;
   for (auto & r : results) {
     // slog::info << ">";
-    auto loc = r.getLocation();
+    auto loc = toNative(r.getLocation());
     face.roi.x_offset = loc.x;
     face.roi.y_offset = loc.y;
     face.roi.width = loc.width;
@@ -139,20 +134,27 @@ void Outputs::RosTopicOutput::accept(
 void Outputs::RosTopicOutput::accept(
   const std::vector<dynamic_vino_lib::LandmarksDetectionResult> & results)
 {
-  landmarks_topic_ = std::make_shared<people_msgs::msg::LandmarkStamped>();
+  if (!isWanted(pub_landmarks_, "detected_landmarks")) {
+    return;
+  }
+  landmarks_topic_ = std::make_unique<people_msgs::msg::LandmarkStamped>();
+  landmarks_topic_->landmarks.reserve(results.size());
   people_msgs::msg::Landmark landmark;
   for (auto & r : results) {
     // slog::info << ">";
-    auto loc = r.getLocation();
+    auto loc = toNative(r.getLocation());
     landmark.roi.x_offset = loc.x;
     landmark.roi.y_offset = loc.y;
     landmark.roi.width = loc.width;
     landmark.roi.height = loc.height;
     std::vector<cv::Point> landmark_points = r.getLandmarks();
+    landmark.landmark_points.clear();
+    landmark.landmark_points.reserve(landmark_points.size());
     for (auto pt : landmark_points) {
       geometry_msgs::msg::Point point;
-      point.x = pt.x;
-      point.y = pt.y;
+      auto native = toNative(pt);
+      point.x = native.x;
+      point.y = native.y;
       landmark.landmark_points.push_back(point);
     }
     landmarks_topic_->landmarks.push_back(landmark);
@@ -162,11 +164,15 @@ void Outputs::RosTopicOutput::accept(
 void Outputs::RosTopicOutput::accept(
   const std::vector<dynamic_vino_lib::PersonAttribsDetectionResult> & results)
 {
-  person_attribs_topic_ = std::make_shared<people_msgs::msg::PersonAttributeStamped>();
+  if (!isWanted(pub_person_attribs_, "person_attributes")) {
+    return;
+  }
+  person_attribs_topic_ = std::make_unique<people_msgs::msg::PersonAttributeStamped>();
+  person_attribs_topic_->attributes.reserve(results.size());
   people_msgs::msg::PersonAttribute person_attrib;
   for (auto & r : results) {
     // slog::info << ">";
-    auto loc = r.getLocation();
+    auto loc = toNative(r.getLocation());
     person_attrib.roi.x_offset = loc.x;
     person_attrib.roi.y_offset = loc.y;
     person_attrib.roi.width = loc.width;
@@ -179,11 +185,15 @@ void Outputs::RosTopicOutput::accept(
 void Outputs::RosTopicOutput::accept(
   const std::vector<dynamic_vino_lib::PersonReidentificationResult> & results)
 {
-  person_reid_topic_ = std::make_shared<people_msgs::msg::ReidentificationStamped>();
+  if (!isWanted(pub_person_reid_, "reidentified_persons")) {
+    return;
+  }
+  person_reid_topic_ = std::make_unique<people_msgs::msg::ReidentificationStamped>();
+  person_reid_topic_->reidentified_vector.reserve(results.size());
   people_msgs::msg::Reidentification person;
   for (auto & r : results) {
     // slog::info << ">";
-    auto loc = r.getLocation();
+    auto loc = toNative(r.getLocation());
     person.roi.x_offset = loc.x;
     person.roi.y_offset = loc.y;
     person.roi.width = loc.width;
@@ -196,23 +206,46 @@ void Outputs::RosTopicOutput::accept(
 void Outputs::RosTopicOutput::accept(
   const std::vector<dynamic_vino_lib::ObjectSegmentationResult> & results)
 {
-  segmented_objects_topic_ = std::make_shared<people_msgs::msg::ObjectsInMasks>();
+  if (!isWanted(pub_segmented_object_, "segmented_obejcts")) {
+    return;
+  }
+  segmented_objects_topic_ = std::make_unique<people_msgs::msg::ObjectsInMasks>();
+  segmented_objects_topic_->objects_vector.reserve(results.size());
+  // a keyframe when due, or when the objects do not match the previous ones
+  bool keyframe = masks_since_keyframe_ == 0 || last_masks_.size() != results.size();
+  if (rle_masks_) {
+    masks_since_keyframe_ = (keyframe ? 1 : masks_since_keyframe_ + 1) % mask_keyframe_interval_;
+    last_masks_.resize(results.size());
+  }
   people_msgs::msg::ObjectInMask object;
-  for (auto & r : results) {
+  for (size_t i = 0; i < results.size(); i++) {
+    auto & r = results[i];
     // slog::info << ">";
-    auto loc = r.getLocation();
+    auto loc = toNative(r.getLocation());
     object.roi.x_offset = loc.x;
     object.roi.y_offset = loc.y;
     object.roi.width = loc.width;
     object.roi.height = loc.height;
     object.object_name = r.getLabel();
     object.probability = r.getConfidence();
-    cv::Mat mask = r.getMask();
-    for (int h = 0; h < mask.size().height; ++h) {
-      for (int w = 0; w < mask.size().width; ++w) {
-        object.mask_array.push_back(mask.at<float>(h, w));
-      }
+    if (rle_masks_) {
+      cv::Mat class_map = r.getClassMap();
+      encodeMaskRuns(class_map, keyframe ? cv::Mat() : last_masks_[i], object.mask_runs);
+      bool delta = !keyframe && last_masks_[i].size() == class_map.size();
+      object.mask_encoding = delta ? kMaskEncoding_RleDelta : kMaskEncoding_Rle;
+      object.mask_width = class_map.cols;
+      object.mask_height = class_map.rows;
+      // copied, into the same buffer from a frame to the next
+      class_map.copyTo(last_masks_[i]);
+      segmented_objects_topic_->objects_vector.push_back(object);
+      continue;
     }
+    // the class id of each pixel
+    cv::Mat class_map;
+    r.getClassMap().convertTo(class_map, CV_32F);
+    object.mask_width = class_map.cols;
+    object.mask_height = class_map.rows;
+    object.mask_array.assign(class_map.begin<float>(), class_map.end<float>());
     segmented_objects_topic_->objects_vector.push_back(object);
   }
 }
@@ -220,11 +253,15 @@ void Outputs::RosTopicOutput::accept(
 void Outputs::RosTopicOutput::accept(
   const std::vector<dynamic_vino_lib::ObjectDetectionResult> & results)
 {
-  detected_objects_topic_ = std::make_shared<object_msgs::msg::ObjectsInBoxes>();
+  if (!isWanted(pub_detected_object_, "detected_objects")) {
+    return;
+  }
+  detected_objects_topic_ = std::make_unique<object_msgs::msg::ObjectsInBoxes>();
+  detected_objects_topic_->objects_vector.reserve(results.size());
   object_msgs::msg::ObjectInBox object;
   for (auto & r : results) {
     // slog::info << ">";
-    auto loc = r.getLocation();
+    auto loc = toNative(r.getLocation());
     object.roi.x_offset = loc.x;
     object.roi.y_offset = loc.y;
     object.roi.width = loc.width;
@@ -238,12 +275,16 @@ void Outputs::RosTopicOutput::accept(
 void Outputs::RosTopicOutput::accept(
   const std::vector<dynamic_vino_lib::FaceDetectionResult> & results)
 {
-  faces_topic_ = std::make_shared<object_msgs::msg::ObjectsInBoxes>();
+  if (!isWanted(pub_face_, "faces")) {
+    return;
+  }
+  faces_topic_ = std::make_unique<object_msgs::msg::ObjectsInBoxes>();
+  faces_topic_->objects_vector.reserve(results.size());
 
   object_msgs::msg::ObjectInBox face;
   for (auto r : results) {
     // slog::info << ">";
-    auto loc = r.getLocation();
+    auto loc = toNative(r.getLocation());
     face.roi.x_offset = loc.x;
     face.roi.y_offset = loc.y;
     face.roi.width = loc.width;
@@ -251,18 +292,24 @@ void Outputs::RosTopicOutput::accept(
     face.object.object_name = r.getLabel();
     face.object.probability = r.getConfidence();
     faces_topic_->objects_vector.push_back(face);
-    detected_objects_topic_->objects_vector.push_back(face);
+    if (detected_objects_topic_ != nullptr) {
+      detected_objects_topic_->objects_vector.push_back(face);
+    }
   }
 }
 
 void Outputs::RosTopicOutput::accept(const std::vector<dynamic_vino_lib::EmotionsResult> & results)
 {
-  emotions_topic_ = std::make_shared<people_msgs::msg::EmotionsStamped>();
+  if (!isWanted(pub_emotion_, "emotions")) {
+    return;
+  }
+  emotions_topic_ = std::make_unique<people_msgs::msg::EmotionsStamped>();
+  emotions_topic_->emotions.reserve(results.size());
 
   people_msgs::msg::Emotion emotion;
   for (auto r : results) {
     // slog::info << ">";
-    auto loc = r.getLocation();
+    auto loc = toNative(r.getLocation());
     emotion.roi.x_offset = loc.x;
     emotion.roi.y_offset = loc.y;
     emotion.roi.width = loc.width;
@@ -274,12 +321,16 @@ void Outputs::RosTopicOutput::accept(const std::vector<dynamic_vino_lib::Emotion
 
 void Outputs::RosTopicOutput::accept(const std::vector<dynamic_vino_lib::AgeGenderResult> & results)
 {
-  age_gender_topic_ = std::make_shared<people_msgs::msg::AgeGenderStamped>();
+  if (!isWanted(pub_age_gender_, "age_genders")) {
+    return;
+  }
+  age_gender_topic_ = std::make_unique<people_msgs::msg::AgeGenderStamped>();
+  age_gender_topic_->objects.reserve(results.size());
 
   people_msgs::msg::AgeGender ag;
   for (auto r : results) {
     // slog::info << ">";
-    auto loc = r.getLocation();
+    auto loc = toNative(r.getLocation());
     ag.roi.x_offset = loc.x;
     ag.roi.y_offset = loc.y;
     ag.roi.width = loc.width;
@@ -299,11 +350,15 @@ void Outputs::RosTopicOutput::accept(const std::vector<dynamic_vino_lib::AgeGend
 
 void Outputs::RosTopicOutput::accept(const std::vector<dynamic_vino_lib::HeadPoseResult> & results)
 {
-  headpose_topic_ = std::make_shared<people_msgs::msg::HeadPoseStamped>();
+  if (!isWanted(pub_headpose_, "headposes")) {
+    return;
+  }
+  headpose_topic_ = std::make_unique<people_msgs::msg::HeadPoseStamped>();
+  headpose_topic_->headposes.reserve(results.size());
 
   people_msgs::msg::HeadPose hp;
   for (auto r : results) {
-    auto loc = r.getLocation();
+    auto loc = toNative(r.getLocation());
     hp.roi.x_offset = loc.x;
     hp.roi.y_offset = loc.y;
     hp.roi.width = loc.width;
@@ -317,77 +372,65 @@ void Outputs::RosTopicOutput::accept(const std::vector<dynamic_vino_lib::HeadPos
 
 void Outputs::RosTopicOutput::handleOutput()
 {
-  auto header = getPipeline()->getInputDevice()->getLockedHeader();
-  if (vehicle_attribs_topic_ != nullptr) {
-    // slog::info << "publishing landmarks detection outputs." << slog::endl;
-    vehicle_attribs_topic_->header = header;
-    pub_vehicle_attribs_->publish(*vehicle_attribs_topic_);
-    vehicle_attribs_topic_ = nullptr;
-  }
-  if (license_plate_topic_ != nullptr) {
-    // slog::info << "publishing face reidentification outputs." << slog::endl;
-    license_plate_topic_->header = header;
-    pub_license_plate_->publish(*license_plate_topic_);
-    license_plate_topic_ = nullptr;
-  }
-  if (landmarks_topic_ != nullptr) {
-    // slog::info << "publishing landmarks detection outputs." << slog::endl;
-    landmarks_topic_->header = header;
-    pub_landmarks_->publish(*landmarks_topic_);
-    landmarks_topic_ = nullptr;
-  }
-  if (face_reid_topic_ != nullptr) {
-    // slog::info << "publishing face reidentification outputs." << slog::endl;
-    face_reid_topic_->header = header;
-    pub_face_reid_->publish(*face_reid_topic_);
-    face_reid_topic_ = nullptr;
-  }
-  if (person_attribs_topic_ != nullptr) {
-    // slog::info << "publishing person attributes outputs." << slog::endl;
-    person_attribs_topic_->header = header;
-    pub_person_attribs_->publish(*person_attribs_topic_);
-    person_attribs_topic_ = nullptr;
-  }
-  if (person_reid_topic_ != nullptr) {
-    // slog::info << "publishing preson reidentification outputs." << slog::endl;
-    person_reid_topic_->header = header;
-    pub_person_reid_->publish(*person_reid_topic_);
-    person_reid_topic_ = nullptr;
-  }
-  if (segmented_objects_topic_ != nullptr) {
-    // slog::info << "publishing segmented objects outputs." << slog::endl;
-    segmented_objects_topic_->header = header;
-    pub_segmented_object_->publish(*segmented_objects_topic_);
-    segmented_objects_topic_ = nullptr;
-  }
-  if (detected_objects_topic_ != nullptr) {
-    // slog::info << "publishing detected objects outputs." << slog::endl;
-    detected_objects_topic_->header = header;
-    pub_detected_object_->publish(*detected_objects_topic_);
-    detected_objects_topic_ = nullptr;
-  }
-  if (faces_topic_ != nullptr) {
-    // slog::info << "publishing faces outputs." << slog::endl;
-    faces_topic_->header = header;
-    pub_face_->publish(*faces_topic_);
-    faces_topic_ = nullptr;
+  auto header = getFrameHeader();
+  publishTopic(pub_vehicle_attribs_, vehicle_attribs_topic_, "detected_vehicles_attribs", header);
+  publishTopic(pub_license_plate_, license_plate_topic_, "detected_license_plates", header);
+  publishTopic(pub_landmarks_, landmarks_topic_, "detected_landmarks", header);
+  publishTopic(pub_face_reid_, face_reid_topic_, "reidentified_faces", header);
+  publishTopic(pub_person_attribs_, person_attribs_topic_, "person_attributes", header);
+  publishTopic(pub_person_reid_, person_reid_topic_, "reidentified_persons", header);
+  publishTopic(pub_segmented_object_, segmented_objects_topic_, "segmented_obejcts", header);
+  publishTopic(pub_detected_object_, detected_objects_topic_, "detected_objects", header);
+  publishTopic(pub_face_, faces_topic_, "faces", header);
+  publishTopic(pub_emotion_, emotions_topic_, "emotions", header);
+  publishTopic(pub_age_gender_, age_gender_topic_, "age_genders", header);
+  publishTopic(pub_headpose_, headpose_topic_, "headposes", header);
+  publishLatency();
+}
+
+void Outputs::RosTopicOutput::publishLatency()
+{
+  if (!latency_topic_) {
+    return;
   }
-  if (emotions_topic_ != nullptr) {
-    // slog::info << "publishing emotions outputs." << slog::endl;
-    emotions_topic_->header = header;
-    pub_emotion_->publish(*emotions_topic_);
-    emotions_topic_ = nullptr;
+  if (pub_latency_ == nullptr) {
+    pub_latency_ = node_->create_publisher<people_msgs::msg::FrameLatency>(
+      "/openvino_toolkit/" + output_name_ + "/latency", 16);
   }
-  if (age_gender_topic_ != nullptr) {
-    // slog::info << "publishing age gender outputs." << slog::endl;
-    age_gender_topic_->header = header;
-    pub_age_gender_->publish(*age_gender_topic_);
-    age_gender_topic_ = nullptr;
+  if (pub_latency_->get_subscription_count() == 0) {
+    return;
   }
-  if (headpose_topic_ != nullptr) {
-    headpose_topic_->header = header;
-    pub_headpose_->publish(*headpose_topic_);
-    headpose_topic_ = nullptr;
+  // the steady times, immune to clock jumps, are taken back from now on the node clock
+  auto steady_now = std::chrono::steady_clock::now();
+  rclcpp::Time now = node_->now();
+  auto toTime = [&](const std::chrono::steady_clock::time_point & time) {
+      return builtin_interfaces::msg::Time(now - rclcpp::Duration(
+               std::chrono::duration_cast<std::chrono::nanoseconds>(steady_now - time)));
+    };
+  auto times = getFrameTimes();
+  auto message = std::make_unique<people_msgs::msg::FrameLatency>();
+  message->header = getFrameHeader();
+  message->frame_id = times.frame_id;
+  message->capture = toTime(times.capture);
+  message->dequeue = toTime(times.dequeue);
+  message->inference_done = toTime(times.inference_done);
+  message->publish = now;
+  publishMessage(pub_latency_, std::move(message));
+}
+
+void Outputs::RosTopicOutput::setTopicRate(const std::string & topic, const OutputRate & rate)
+{
+  topic_states_[topic].gate.setRate(rate);
+}
+
+void Outputs::RosTopicOutput::setMaskEncoding(const std::string & encoding, int keyframe_interval)
+{
+  rle_masks_ = encoding == kMaskEncoding_Rle;
+  if (!rle_masks_ && encoding != "raw") {
+    slog::warn << "Unknown mask encoding " << encoding << ", publishing raw masks." << slog::endl;
   }
+  mask_keyframe_interval_ = std::max(keyframe_interval, 1);
+  masks_since_keyframe_ = 0;
+  last_masks_.clear();
 }
 
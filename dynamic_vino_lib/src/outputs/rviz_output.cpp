@@ -21,9 +21,11 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <utility>
 #include "cv_bridge/cv_bridge.h"
 #include "dynamic_vino_lib/pipeline.hpp"
 #include "dynamic_vino_lib/outputs/rviz_output.hpp"
+#include "dynamic_vino_lib/slog.hpp"
 
 Outputs::RvizOutput::RvizOutput(std::string output_name, const rclcpp::Node::SharedPtr node)
 : BaseOutput(output_name)
@@ -33,82 +35,120 @@ Outputs::RvizOutput::RvizOutput(std::string output_name, const rclcpp::Node::Sha
   } else {
     node_ = rclcpp::Node::make_shared(output_name + "_image_publisher");
   }
-  image_topic_ = nullptr;
   pub_image_ = node_->create_publisher<sensor_msgs::msg::Image>(
     "/openvino_toolkit/" + output_name_ + "/images", 16);
-  image_window_output_ = std::make_shared<Outputs::ImageWindowOutput>(output_name_, 950);
 }
 
 void Outputs::RvizOutput::feedFrame(const cv::Mat & frame)
 {
-  image_window_output_->feedFrame(frame);
+  renderer_.feedFrame(frame);
 }
 
 void Outputs::RvizOutput::accept(
   const std::vector<dynamic_vino_lib::FaceReidentificationResult> & results)
 {
-  image_window_output_->accept(results);
+  renderer_.accept(results);
 }
 
 void Outputs::RvizOutput::accept(
   const std::vector<dynamic_vino_lib::LandmarksDetectionResult> & results)
 {
-  image_window_output_->accept(results);
+  renderer_.accept(results);
 }
 
 void Outputs::RvizOutput::accept(
   const std::vector<dynamic_vino_lib::PersonAttribsDetectionResult> & results)
 {
-  image_window_output_->accept(results);
+  renderer_.accept(results);
 }
 
 void Outputs::RvizOutput::accept(
   const std::vector<dynamic_vino_lib::PersonReidentificationResult> & results)
 {
-  image_window_output_->accept(results);
+  renderer_.accept(results);
 }
 
 void Outputs::RvizOutput::accept(const std::vector<dynamic_vino_lib::FaceDetectionResult> & results)
 {
-  image_window_output_->accept(results);
+  renderer_.accept(results);
 }
 
 void Outputs::RvizOutput::accept(
   const std::vector<dynamic_vino_lib::ObjectDetectionResult> & results)
 {
-  image_window_output_->accept(results);
+  renderer_.accept(results);
 }
 
 void Outputs::RvizOutput::accept(
   const std::vector<dynamic_vino_lib::ObjectSegmentationResult> & results)
 {
-  image_window_output_->accept(results);
+  renderer_.accept(results);
 }
 
 void Outputs::RvizOutput::accept(const std::vector<dynamic_vino_lib::EmotionsResult> & results)
 {
-  image_window_output_->accept(results);
+  renderer_.accept(results);
 }
 
 void Outputs::RvizOutput::accept(const std::vector<dynamic_vino_lib::AgeGenderResult> & results)
 {
-  image_window_output_->accept(results);
+  renderer_.accept(results);
 }
 
 void Outputs::RvizOutput::accept(const std::vector<dynamic_vino_lib::HeadPoseResult> & results)
 {
-  image_window_output_->accept(results);
+  renderer_.accept(results);
+}
+
+void Outputs::RvizOutput::setImageEncoding(
+  const std::string & transport, int quality, float scale, float max_rate)
+{
+  jpeg_quality_ = std::min(std::max(quality, 0), 100);
+  // drawn on the downscaled frame
+  renderer_.setScale(scale);
+  min_interval_ = max_rate > 0 ?
+    std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+    std::chrono::duration<double>(1.0 / max_rate)) : std::chrono::steady_clock::duration(0);
+  if (transport == "compressed") {
+    if (pub_compressed_image_ == nullptr) {
+      pub_compressed_image_ = node_->create_publisher<sensor_msgs::msg::CompressedImage>(
+        "/openvino_toolkit/" + output_name_ + "/images/compressed", 16);
+    }
+    pub_image_ = nullptr;
+  } else if (transport != "raw") {
+    slog::warn << "Unknown image transport " << transport << ", publishing raw images." <<
+      slog::endl;
+  }
 }
 
 void Outputs::RvizOutput::handleOutput()
 {
-  image_window_output_->setPipeline(getPipeline());
-  image_window_output_->decorateFrame();
-  cv::Mat frame = image_window_output_->getFrame();
-  std_msgs::msg::Header header =
-    getPipeline()->getInputDevice()->getLockedHeader();
-  std::shared_ptr<cv_bridge::CvImage> cv_ptr =
-    std::make_shared<cv_bridge::CvImage>(header, "bgr8", frame);
-  image_topic_ = cv_ptr->toImageMsg();
-  pub_image_->publish(*image_topic_);
+  auto now = std::chrono::steady_clock::now();
+  if (min_interval_.count() > 0 && now - last_published_ < min_interval_) {
+    // not drawn, nor converted, at all
+    renderer_.clearData();
+    return;
+  }
+  last_published_ = now;
+  renderer_.render(getPipeline());
+  cv::Mat frame = renderer_.getCanvas();
+  if (frame.empty()) {
+    return;
+  }
+  std_msgs::msg::Header header = getFrameHeader();
+  if (pub_compressed_image_ != nullptr) {
+    auto message = std::make_unique<sensor_msgs::msg::CompressedImage>();
+    message->header = header;
+    // the format image_transport's compressed plugin decodes
+    message->format = "bgr8; jpeg compressed bgr8";
+    std::vector<int> encoding = {cv::IMWRITE_JPEG_QUALITY, jpeg_quality_};
+    cv::imencode(".jpg", frame, message->data, encoding);
+    publishMessage(pub_compressed_image_, std::move(message));
+    tracePublish("images/compressed");
+    return;
+  }
+  auto message = std::make_unique<sensor_msgs::msg::Image>();
+  cv_bridge::CvImage(header, "bgr8", frame).toImageMsg(*message);
+  publishMessage(pub_image_, std::move(message));
+  tracePublish("images");
 }
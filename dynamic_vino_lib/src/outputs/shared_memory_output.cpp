@@ -0,0 +1,164 @@
+// Copyright (c) 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @brief An implementation file with implementation for SharedMemoryOutput Class
+ * @file shared_memory_output.cpp
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "dynamic_vino_lib/outputs/shared_memory_output.hpp"
+#include "dynamic_vino_lib/pipeline.hpp"
+#include "dynamic_vino_lib/slog.hpp"
+
+Outputs::SharedMemoryOutput::SharedMemoryOutput(
+  const std::string & output_name, int slots, int max_objects, bool frames)
+: BaseOutput(output_name), shm_name_(ShmRing::getShmName(output_name)),
+  slot_count_(static_cast<uint32_t>(std::max(slots, 1))),
+  max_objects_(static_cast<uint32_t>(std::max(max_objects, 1))), frames_(frames)
+{
+  objects_.reserve(max_objects_);
+}
+
+Outputs::SharedMemoryOutput::~SharedMemoryOutput()
+{
+  if (base_ != nullptr) {
+    munmap(base_, size_);
+    shm_unlink(shm_name_.c_str());
+  }
+}
+
+void Outputs::SharedMemoryOutput::feedFrame(const cv::Mat & frame)
+{
+  frame_ = frame;
+  objects_.clear();
+}
+
+void Outputs::SharedMemoryOutput::clearData()
+{
+  objects_.clear();
+}
+
+void Outputs::SharedMemoryOutput::accept(
+  const std::vector<dynamic_vino_lib::ObjectDetectionResult> & results)
+{
+  addObjects(results, ShmRing::kKindObject);
+}
+
+void Outputs::SharedMemoryOutput::accept(
+  const std::vector<dynamic_vino_lib::FaceDetectionResult> & results)
+{
+  addObjects(results, ShmRing::kKindFace);
+}
+
+bool Outputs::SharedMemoryOutput::createRing(const cv::Mat & frame)
+{
+  uint64_t frame_bytes = frames_ ? frame.step[0] * frame.rows : 0;
+  uint64_t slot_size = ShmRing::getSlotSize(max_objects_, frame_bytes);
+  size_ = ShmRing::getHeaderSize() + slot_count_ * slot_size;
+  // a ring left by a previous run is replaced, its readers open the new one
+  shm_unlink(shm_name_.c_str());
+  int fd = shm_open(shm_name_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+  if (fd < 0) {
+    slog::err << "Failed to create shared memory " << shm_name_ << ": " <<
+      std::strerror(errno) << slog::endl;
+    return false;
+  }
+  if (ftruncate(fd, size_) != 0) {
+    slog::err << "Failed to size shared memory " << shm_name_ << ": " <<
+      std::strerror(errno) << slog::endl;
+    ::close(fd);
+    shm_unlink(shm_name_.c_str());
+    return false;
+  }
+  void * base = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (base == MAP_FAILED) {
+    slog::err << "Failed to map shared memory " << shm_name_ << ": " <<
+      std::strerror(errno) << slog::endl;
+    shm_unlink(shm_name_.c_str());
+    return false;
+  }
+  base_ = static_cast<uint8_t *>(base);
+  // ftruncate zeroes the memory, the sequences and the written count start at 0
+  auto header = reinterpret_cast<ShmRing::RingHeader *>(base_);
+  header->version = ShmRing::kVersion;
+  header->slot_count = slot_count_;
+  header->max_objects = max_objects_;
+  header->slot_size = slot_size;
+  header->frame_bytes = frame_bytes;
+  std::atomic_thread_fence(std::memory_order_release);
+  // the magic last, a reader checking it sees a complete header
+  header->magic = ShmRing::kMagic;
+  slog::info << "Writing results into shared memory " << shm_name_ << ", " << slot_count_ <<
+    " slots of " << slot_size << " bytes" << slog::endl;
+  return true;
+}
+
+void Outputs::SharedMemoryOutput::handleOutput()
+{
+  if (base_ == nullptr) {
+    if (failed_ || frame_.empty()) {
+      return;
+    }
+    failed_ = !createRing(frame_);
+    if (failed_) {
+      return;
+    }
+  }
+  auto header = reinterpret_cast<ShmRing::RingHeader *>(base_);
+  uint64_t index = header->written.load(std::memory_order_relaxed);
+  uint8_t * slot = base_ + ShmRing::getHeaderSize() + (index % slot_count_) * header->slot_size;
+  auto slot_header = reinterpret_cast<ShmRing::SlotHeader *>(slot);
+
+  // odd while written, the readers copying the slot meanwhile read it again
+  uint64_t sequence = slot_header->sequence.load(std::memory_order_relaxed);
+  slot_header->sequence.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  auto stamp = getFrameHeader().stamp;
+  slot_header->index = index;
+  slot_header->stamp_ns = static_cast<int64_t>(stamp.sec) * 1000000000LL + stamp.nanosec;
+  uint32_t count = std::min(static_cast<uint32_t>(objects_.size()), max_objects_);
+  slot_header->object_count = count;
+  std::memcpy(slot + sizeof(ShmRing::SlotHeader), objects_.data(),
+    count * sizeof(ShmRing::Object));
+  uint64_t frame_bytes = static_cast<uint64_t>(frame_.cols) * frame_.elemSize() * frame_.rows;
+  if (frames_ && !frame_.empty() && frame_bytes <= header->frame_bytes) {
+    uint8_t * pixels = slot + sizeof(ShmRing::SlotHeader) +
+      max_objects_ * sizeof(ShmRing::Object);
+    size_t row_bytes = frame_.cols * frame_.elemSize();
+    for (int row = 0; row < frame_.rows; row++) {
+      std::memcpy(pixels + row * row_bytes, frame_.ptr(row), row_bytes);
+    }
+    slot_header->frame_width = frame_.cols;
+    slot_header->frame_height = frame_.rows;
+    slot_header->frame_type = frame_.type();
+    slot_header->frame_step = static_cast<uint32_t>(row_bytes);
+  } else {
+    // no frames, or a frame larger than the first one
+    slot_header->frame_width = 0;
+    slot_header->frame_height = 0;
+    slot_header->frame_step = 0;
+  }
+
+  slot_header->sequence.store(sequence + 2, std::memory_order_release);
+  header->written.store(index + 1, std::memory_order_release);
+  tracePublish(shm_name_);
+  objects_.clear();
+}
@@ -0,0 +1,266 @@
+// Copyright (c) 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @brief An implementation file with implementation for VideoWriterOutput Class
+ * @file video_writer_output.cpp
+ */
+
+#include <algorithm>
+#include <ctime>
+#include <iomanip>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "dynamic_vino_lib/outputs/video_writer_output.hpp"
+#include "dynamic_vino_lib/pipeline.hpp"
+#include "dynamic_vino_lib/slog.hpp"
+
+// the frames waiting for the encoder at most, the oldest is dropped beyond
+static const size_t kVideoQueueCapacity = 64;
+
+Outputs::VideoWriterOutput::VideoWriterOutput(const std::string & output_name)
+: BaseOutput(output_name), dropped_frames_(0)
+{
+  worker_ = std::thread(&VideoWriterOutput::run, this);
+}
+
+Outputs::VideoWriterOutput::~VideoWriterOutput()
+{
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    stopped_ = true;
+  }
+  cond_.notify_all();
+  if (worker_.joinable()) {
+    worker_.join();
+  }
+}
+
+void Outputs::VideoWriterOutput::setRecording(
+  const std::string & directory, float fps, float segment, bool annotated,
+  const std::string & trigger, float hold)
+{
+  directory_ = directory.empty() ? "." : directory;
+  fps_ = fps > 0 ? fps : 30;
+  segment_ = std::chrono::duration_cast<Clock::duration>(
+    std::chrono::duration<double>(std::max(segment, 0.0f)));
+  annotated_ = annotated;
+  hold_ = std::chrono::duration_cast<Clock::duration>(
+    std::chrono::duration<double>(std::max(hold, 0.0f)));
+  on_detections_ = trigger == "detections";
+  if (!on_detections_ && trigger != "always") {
+    slog::warn << "Unknown video trigger " << trigger << ", recording every frame." <<
+      slog::endl;
+  }
+}
+
+void Outputs::VideoWriterOutput::feedFrame(const cv::Mat & frame)
+{
+  frame_ = frame;
+  detected_ = false;
+  if (annotated_) {
+    renderer_.feedFrame(frame);
+  }
+}
+
+void Outputs::VideoWriterOutput::clearData()
+{
+  detected_ = false;
+  renderer_.clearData();
+}
+
+void Outputs::VideoWriterOutput::handleOutput()
+{
+  auto now = Clock::now();
+  if (detected_) {
+    last_detected_ = now;
+  }
+  bool triggered = !on_detections_ || detected_ ||
+    (recording_ && now - last_detected_ <= hold_);
+  if (!triggered) {
+    renderer_.clearData();
+    if (recording_) {
+      // each event in its own file
+      push(Job());
+      recording_ = false;
+    }
+    return;
+  }
+  recording_ = true;
+  Job job;
+  job.time = now;
+  if (annotated_) {
+    renderer_.render(getPipeline());
+    // the canvas is drawn for this frame only, the worker keeps its handle
+    job.frame = renderer_.getCanvas();
+  } else {
+    // shared and read only, no copy
+    job.frame = frame_;
+  }
+  if (!job.frame.empty()) {
+    push(std::move(job));
+  }
+}
+
+void Outputs::VideoWriterOutput::push(Job job)
+{
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    if (queue_.size() >= kVideoQueueCapacity) {
+      queue_.pop_front();
+      dropped_frames_++;
+    }
+    queue_.push_back(std::move(job));
+  }
+  cond_.notify_one();
+}
+
+void Outputs::VideoWriterOutput::run()
+{
+  while (true) {
+    Job job;
+    {
+      std::unique_lock<std::mutex> lk(mutex_);
+      cond_.wait(lk, [this] {return stopped_ || !queue_.empty();});
+      if (queue_.empty()) {
+        // stopped, with the queued frames written
+        break;
+      }
+      job = std::move(queue_.front());
+      queue_.pop_front();
+    }
+    if (job.frame.empty()) {
+      writer_.release();
+      continue;
+    }
+    bool rotate = writer_.isOpened() && segment_.count() > 0 &&
+      job.time - segment_start_ >= segment_;
+    if (rotate) {
+      writer_.release();
+    }
+    if (!writer_.isOpened()) {
+      if (!openWriter(job.frame.size())) {
+        continue;
+      }
+      segment_start_ = job.time;
+    }
+    writer_.write(job.frame);
+  }
+  writer_.release();
+}
+
+bool Outputs::VideoWriterOutput::openWriter(const cv::Size & size)
+{
+  std::time_t now = std::time(nullptr);
+  std::tm local_time;
+  localtime_r(&now, &local_time);
+  std::ostringstream path;
+  path << directory_ << "/" << output_name_ << "_" <<
+    std::put_time(&local_time, "%Y%m%d_%H%M%S") << "_" << file_index_++ << ".mp4";
+
+#if CV_VERSION_MAJOR > 4 || \
+  (CV_VERSION_MAJOR == 4 && (CV_VERSION_MINOR > 5 || \
+  (CV_VERSION_MINOR == 5 && CV_VERSION_REVISION >= 2)))
+  // H.264 on the VAAPI or QSV encoder of the GPU
+  std::vector<int> hw_params = {cv::VIDEOWRITER_PROP_HW_ACCELERATION, cv::VIDEO_ACCELERATION_ANY};
+  if (writer_.open(path.str(), cv::CAP_FFMPEG, cv::VideoWriter::fourcc('H', '2', '6', '4'),
+    fps_, size, hw_params))
+  {
+    slog::info << "Recording " << path.str() << " with hardware acceleration " <<
+      writer_.get(cv::VIDEOWRITER_PROP_HW_ACCELERATION) << slog::endl;
+    return true;
+  }
+#endif
+  if (writer_.open(path.str(), cv::VideoWriter::fourcc('m', 'p', '4', 'v'), fps_, size)) {
+    slog::warn << "Recording " << path.str() << " with the software encoder." << slog::endl;
+    return true;
+  }
+  slog::err << "Failed to open video file " << path.str() << slog::endl;
+  return false;
+}
+
+void Outputs::VideoWriterOutput::accept(
+  const std::vector<dynamic_vino_lib::LicensePlateDetectionResult> & results)
+{
+  record(results);
+}
+
+void Outputs::VideoWriterOutput::accept(
+  const std::vector<dynamic_vino_lib::VehicleAttribsDetectionResult> & results)
+{
+  record(results);
+}
+
+void Outputs::VideoWriterOutput::accept(
+  const std::vector<dynamic_vino_lib::FaceReidentificationResult> & results)
+{
+  record(results);
+}
+
+void Outputs::VideoWriterOutput::accept(
+  const std::vector<dynamic_vino_lib::LandmarksDetectionResult> & results)
+{
+  record(results);
+}
+
+void Outputs::VideoWriterOutput::accept(
+  const std::vector<dynamic_vino_lib::PersonAttribsDetectionResult> & results)
+{
+  record(results);
+}
+
+void Outputs::VideoWriterOutput::accept(
+  const std::vector<dynamic_vino_lib::PersonReidentificationResult> & results)
+{
+  record(results);
+}
+
+void Outputs::VideoWriterOutput::accept(
+  const std::vector<dynamic_vino_lib::ObjectSegmentationResult> & results)
+{
+  record(results);
+}
+
+void Outputs::VideoWriterOutput::accept(
+  const std::vector<dynamic_vino_lib::ObjectDetectionResult> & results)
+{
+  record(results);
+}
+
+void Outputs::VideoWriterOutput::accept(
+  const std::vector<dynamic_vino_lib::FaceDetectionResult> & results)
+{
+  record(results);
+}
+
+void Outputs::VideoWriterOutput::accept(
+  const std::vector<dynamic_vino_lib::EmotionsResult> & results)
+{
+  record(results);
+}
+
+void Outputs::VideoWriterOutput::accept(
+  const std::vector<dynamic_vino_lib::AgeGenderResult> & results)
+{
+  record(results);
+}
+
+void Outputs::VideoWriterOutput::accept(
+  const std::vector<dynamic_vino_lib::HeadPoseResult> & results)
+{
+  record(results);
+}
@@ -18,6 +18,8 @@
  */
 
 #include <vino_param_lib/param_manager.hpp>
+#include <algorithm>
+#include <cstdio>
 #include <memory>
 #include <string>
 #include <utility>
@@ -27,13 +29,33 @@
 #include "dynamic_vino_lib/inputs/base_input.hpp"
 #include "dynamic_vino_lib/inputs/image_input.hpp"
 #include "dynamic_vino_lib/pipeline.hpp"
+#include "dynamic_vino_lib/tracing.hpp"
+#include "dynamic_vino_lib/utils/nv12.hpp"
+#include "dynamic_vino_lib/utils/scratch_arena.hpp"
 
 Pipeline::Pipeline(const std::string & name)
 {
   if (!name.empty()) {
     params_ = std::make_shared<PipelineParams>(name);
   }
-  counter_ = 0;
+  capture_running_ = false;
+  capture_paused_ = false;
+  draining_ = false;
+  dropped_frames_ = 0;
+  deadline_misses_ = 0;
+  deadline_skips_ = 0;
+  request_failures_ = 0;
+  rate_limit_ = 0;
+  power_limit_ = 0;
+  gated_frames_ = 0;
+  still_frames_ = 0;
+}
+
+Pipeline::~Pipeline()
+{
+  stopCapture();
+  dispatcher_ = nullptr;
+  preprocess_pool_ = nullptr;
 }
 
 bool Pipeline::add(const std::string & name, std::shared_ptr<Input::BaseInputDevice> input_device)
@@ -43,8 +65,18 @@ bool Pipeline::add(const std::string & name, std::shared_ptr<Input::BaseInputDev
     return false;
   }
   slog::info << "Adding Input Device into Pipeline: " << name << slog::endl;
-  input_device_name_ = name;
-  input_device_ = input_device;
+  auto it = std::find(input_device_names_.begin(), input_device_names_.end(), name);
+  if (it != input_device_names_.end()) {
+    slog::warn << "input device [" << name <<
+      "] already exists, update it with new instance." << slog::endl;
+    input_devices_[it - input_device_names_.begin()] = input_device;
+  } else {
+    input_device_names_.push_back(name);
+    input_devices_.push_back(input_device);
+  }
+  input_device_name_ = input_device_names_.front();
+  input_device_ = input_devices_.front();
+  graph_dirty_ = true;
 
   addConnect("", name);
   return true;
@@ -93,12 +125,30 @@ bool Pipeline::add(const std::string & name, std::shared_ptr<Outputs::BaseOutput
   }
   name_to_output_map_[name] = output;
   output_names_.insert(name);
+  graph_dirty_ = true;
   /**< Add pipeline instance to Output instance >**/
   output->setPipeline(this);
 
   return true;
 }
 
+bool Pipeline::addOutputForInput(
+  const std::string & input_name, const std::string & name,
+  std::shared_ptr<Outputs::BaseOutput> output)
+{
+  if (input_name.empty() || name.empty() || output == nullptr) {
+    slog::err << "ARGuments ERROR when adding output instance for input!" << slog::endl;
+    return false;
+  }
+
+  slog::info << "Adding Output [" << name << "] for Input Device: " << input_name << slog::endl;
+  input_to_outputs_[input_name][name] = output;
+  graph_dirty_ = true;
+  output->setPipeline(this);
+
+  return true;
+}
+
 void Pipeline::addConnect(const std::string & parent, const std::string & name)
 {
   std::pair<std::multimap<std::string, std::string>::iterator,
@@ -116,6 +166,7 @@ void Pipeline::addConnect(const std::string & parent, const std::string & name)
   slog::info << "Adding connection into pipeline:[" << parent << "<-->" << name << "]" <<
     slog::endl;
   next_.insert({parent, name});
+  graph_dirty_ = true;
 }
 
 bool Pipeline::add(
@@ -153,10 +204,81 @@ bool Pipeline::add(
     ++total_inference_;
   }
   name_to_detection_map_[name] = inference;
+  graph_dirty_ = true;
 
   return true;
 }
 
+bool Pipeline::replaceInference(
+  const std::string & name, std::shared_ptr<dynamic_vino_lib::BaseInference> inference)
+{
+  std::lock_guard<std::mutex> lock(replacements_mutex_);
+  // the map itself is only changed by the pipeline thread, in applyReplacements
+  if (inference == nullptr || name_to_detection_map_.count(name) == 0) {
+    slog::warn << "No inference named " << name << " in the pipeline." << slog::endl;
+    return false;
+  }
+  replacements_[name] = inference;
+  return true;
+}
+
+void Pipeline::joinInference(
+  const std::string & name, std::shared_ptr<dynamic_vino_lib::BaseInference> inference,
+  const std::vector<std::pair<std::string, std::string>> & connects)
+{
+  if (name.empty() || inference == nullptr) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(replacements_mutex_);
+  joins_.push_back({name, inference, connects});
+}
+
+void Pipeline::applyReplacements()
+{
+  std::map<std::string, std::shared_ptr<dynamic_vino_lib::BaseInference>> replacements;
+  std::vector<JoiningInference> joins;
+  {
+    std::lock_guard<std::mutex> lock(replacements_mutex_);
+    if (replacements_.empty() && joins_.empty()) {
+      return;
+    }
+    replacements.swap(replacements_);
+    joins.swap(joins_);
+  }
+  // the frames dispatched are done on the graph they were dispatched to, and
+  // their callbacks may still use it after the frames are done
+  flush();
+  if (dispatcher_ != nullptr) {
+    dispatcher_->waitIdle();
+  }
+  for (auto & replacement : replacements) {
+    name_to_detection_map_[replacement.first] = replacement.second;
+    slog::info << "Inference " << replacement.first << " of pipeline " << getName() <<
+      " is replaced" << slog::endl;
+  }
+  for (auto & join : joins) {
+    add(join.name, join.inference);
+    pending_connects_.insert(pending_connects_.end(), join.connects.begin(),
+      join.connects.end());
+    slog::info << "Inference " << join.name << " joined pipeline " << getName() << slog::endl;
+  }
+  // a connection to an inference still loading waits for it to join too
+  std::vector<std::pair<std::string, std::string>> waiting;
+  for (auto & connect : pending_connects_) {
+    if (getCatagoryOrder(connect.first) == kCatagoryOrder_Unknown ||
+      getCatagoryOrder(connect.second) == kCatagoryOrder_Unknown)
+    {
+      waiting.push_back(connect);
+    } else if (!add(connect.first, connect.second)) {
+      slog::warn << "Failed to connect " << connect.first << " to " << connect.second <<
+        " in pipeline " << getName() << slog::endl;
+    }
+  }
+  pending_connects_.swap(waiting);
+  // recompiles the graph and binds the completion callbacks of the new requests
+  setCallback();
+}
+
 bool Pipeline::isLegalConnect(const std::string parent, const std::string child)
 {
   int parent_order = getCatagoryOrder(parent);
@@ -171,7 +293,9 @@ bool Pipeline::isLegalConnect(const std::string parent, const std::string child)
 int Pipeline::getCatagoryOrder(const std::string name)
 {
   int order = kCatagoryOrder_Unknown;
-  if (name == input_device_name_) {
+  if (std::find(input_device_names_.begin(), input_device_names_.end(), name) !=
+    input_device_names_.end())
+  {
     order = kCatagoryOrder_Input;
   } else if (name_to_detection_map_.find(name) != name_to_detection_map_.end()) {
     order = kCatagoryOrder_Inference;
@@ -184,44 +308,578 @@ int Pipeline::getCatagoryOrder(const std::string name)
 
 void Pipeline::runOnce()
 {
-  initInferenceCounter();
-
-  if (!input_device_->read(&frame_)) {
+  applyReplacements();
+  // with frames dispatched, a frame is read only once it's ready, meanwhile
+  // the oldest dispatched frames are output
+  std::vector<std::shared_ptr<FrameContext>> contexts;
+  if (dispatched_frames_.empty() || isFrameReady()) {
+    contexts = readFrames();
+  }
+  if (contexts.empty()) {
     // throw std::logic_error("Failed to get frame from cv::VideoCapture");
     // slog::warn << "Failed to get frame from input_device." << slog::endl;
+    if (!dispatched_frames_.empty()) {
+      outputDispatchedFrames(dispatched_frames_.size() - 1);
+    }
     return; //do nothing if now frame read out
   }
-  width_ = frame_.cols;
-  height_ = frame_.rows;
-  slog::debug << "DEBUG: in Pipeline run process..." << slog::endl;
-  // auto t0 = std::chrono::high_resolution_clock::now();
-  for (auto pos = next_.equal_range(input_device_name_); pos.first != pos.second; ++pos.first) {
-    std::string detection_name = pos.first->second;
-    slog::debug << "DEBUG: Enqueue for detection: " << detection_name << slog::endl;
-    auto detection_ptr = name_to_detection_map_[detection_name];
-    detection_ptr->enqueue(frame_, cv::Rect(width_ / 2, height_ / 2, width_, height_));
-    increaseInferenceCounter();
-    slog::debug << "DEBUG: Submit Infer request for detection: " << detection_name << slog::endl;
-    detection_ptr->submitRequest();
+  if (graph_dirty_) {
+    // the frames dispatched are done on the graph they were dispatched to
+    flush();
+    compileGraph();
+  }
+  if (!dispatched_frames_.empty() && isOrderSensitive()) {
+    // the frames go on from the results of the frames before them
+    for (auto & frames : dispatched_frames_) {
+      waitFramesInferred(frames, true);
+    }
+  }
+  current_context_ = contexts.front();
+  SLOG_DEBUG << "DEBUG: in Pipeline run process..." << slog::endl;
+  float deadline = params_ == nullptr ? 0 : params_->getFrameDeadline();
+  auto now = LatencyStats::Clock::now();
+  for (auto & context : contexts) {
+    context->markDequeued();
+    context->setInferenceRegion(selectInputRegion(*context));
+    if (deadline > 0) {
+      context->setDeadline(context->getCaptureTime() +
+        std::chrono::duration_cast<LatencyStats::Clock::duration>(
+          std::chrono::duration<double, std::milli>(deadline)));
+    }
+    // the inferences with an execution rate reuse their results on the frames they skip
+    for (size_t n = 0; n < graph_nodes_.size(); n++) {
+      auto & inference = graph_nodes_[n].inference;
+      if (inference != nullptr && inference->hasExecutionRate()) {
+        int node_id = static_cast<int>(n);
+        context->setResultAge(node_id, updateResultAge(node_id, context->getInputId(), now));
+      }
+    }
   }
 
-  for (auto &pair : name_to_output_map_)
-  {
-    pair.second->feedFrame(frame_);
+  // the outputs of overlapping frames are fed once the frames before are output
+  if (!overlapsFrames()) {
+    feedOutputs(contexts);
+  }
+
+  // auto t0 = std::chrono::high_resolution_clock::now();
+  // the frames of all the inputs connected to an inference are dispatched together
+  std::map<int, std::vector<std::shared_ptr<FrameContext>>> stage_frames;
+  std::set<std::shared_ptr<FrameContext>> still_frames;
+  for (auto & context : contexts) {
+    if (isStillFrame(context)) {
+      still_frames.insert(context);
+    }
+    for (auto & edge : graph_nodes_[graph_input_ids_[context->getInputId()]].inference_edges) {
+      stage_frames[edge.to].push_back(context);
+    }
   }
+  std::vector<int> first_stages;
+  for (auto & pair : stage_frames) {
+    SLOG_DEBUG << "DEBUG: Submit Infer request for detection: " <<
+      graph_nodes_[pair.first].name << slog::endl;
+    // frames served by propagating tracked, still or skipped results skip the inference
+    std::vector<std::shared_ptr<FrameContext>> inferred;
+    for (auto & context : pair.second) {
+      bool reuse = still_frames.count(context) > 0 || context->getResultAge(pair.first) > 0;
+      if (!propagateFrame(pair.first, context, reuse, first_stages)) {
+        // e.g. the first frame of an input, or an inference which can't reuse its results
+        context->setResultAge(pair.first, 0);
+        inferred.push_back(context);
+      }
+    }
+    if (dispatchFrames(pair.first, inferred)) {
+      first_stages.push_back(pair.first);
+    }
+  }
+  std::sort(first_stages.begin(), first_stages.end());
+  first_stages.erase(std::unique(first_stages.begin(), first_stages.end()), first_stages.end());
+  submitConcurrently(first_stages);
   countFPS();
 
-  slog::debug << "DEBUG: align inference process, waiting until all inferences done!" << slog::endl;
-  std::unique_lock<std::mutex> lock(counter_mutex_);
-  cv_.wait(lock, [self = this]() {return self->counter_ == 0;});
+  DispatchedFrames frames;
+  frames.contexts = std::move(contexts);
+  dispatched_frames_.push_back(std::move(frames));
+  // the frames done are output, the oldest ones are waited for once
+  // frames_in_flight frames are dispatched
+  SLOG_DEBUG << "DEBUG: align inference process, waiting until all inferences done!" << slog::endl;
+  outputDispatchedFrames(static_cast<size_t>(std::max(1, getFramesInFlight())) - 1);
+  // the temporaries of the frame are all given back, the arena of the pipeline
+  // thread is merged into one block if it grew
+  ScratchArena::getThreadArena().reset();
+}
+
+bool Pipeline::overlapsFrames() const
+{
+  return getFramesInFlight() > 1;
+}
+
+bool Pipeline::isOrderSensitive() const
+{
+  if (params_ != nullptr && params_->getMotionThreshold() > 0) {
+    return true;
+  }
+  for (auto & region : input_regions_) {
+    if (region.dynamic) {
+      return true;
+    }
+  }
+  for (auto & node : graph_nodes_) {
+    auto & inference = node.inference;
+    if (inference != nullptr && (inference->dependsOnFrameOrder() ||
+      inference->hasExecutionRate() || inference->isResultCacheEnabled()))
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool Pipeline::isFrameReady()
+{
+  if (!useCaptureThread()) {
+    // inputs read by the pipeline thread are read when asked for
+    return true;
+  }
+  std::lock_guard<std::mutex> lock(inflight_mutex_);
+  return !inflight_frames_.empty();
+}
 
+void Pipeline::feedOutputs(const std::vector<std::shared_ptr<FrameContext>> & contexts)
+{
+  for (auto & context : contexts) {
+    for (auto & output : getOutputs(context->getInputId())) {
+      if (output->admitFrame()) {
+        // an NV12 frame is only converted for the outputs showing it
+        output->feedFrame(output->needsFrame() ? context->getFrame() : cv::Mat());
+      }
+    }
+  }
+}
+
+bool Pipeline::waitFramesInferred(DispatchedFrames & frames, bool block)
+{
+  if (frames.inferred) {
+    return true;
+  }
+  for (auto & context : frames.contexts) {
+    if (!block && context->getInferenceCounter() > 0) {
+      return false;
+    }
+  }
+  auto poll = std::chrono::milliseconds(std::max(1, static_cast<int>(batch_wait_ / 2)));
+  for (auto & context : frames.contexts) {
+    // the batches held for the ROIs of the other frames are submitted once their wait is over
+    while (batch_wait_ > 0 && !context->waitInferenceDone(poll)) {
+      flushHeldBatches();
+    }
+    context->waitInferenceDone();
+    context->markInferenceDone();
+    updateInputRegion(*context);
+  }
+  frames.inferred = true;
+  return true;
+}
+
+void Pipeline::outputDispatchedFrames(size_t max_dispatched)
+{
+  while (!dispatched_frames_.empty()) {
+    auto & frames = dispatched_frames_.front();
+    if (!waitFramesInferred(frames, dispatched_frames_.size() > max_dispatched)) {
+      break;
+    }
+    outputFrames(frames.contexts);
+    dispatched_frames_.pop_front();
+  }
+}
+
+void Pipeline::outputFrames(const std::vector<std::shared_ptr<FrameContext>> & contexts)
+{
   //auto t1 = std::chrono::high_resolution_clock::now();
   //typedef std::chrono::duration<double, std::ratio<1, 1000>> ms;
 
-  slog::debug << "DEBUG: in Pipeline run process...handleOutput" << slog::endl;
-  for (auto & pair : name_to_output_map_) {
-    // slog::info << "Handling Output ..." << pair.first << slog::endl;
-    pair.second->handleOutput();
+  SLOG_DEBUG << "DEBUG: in Pipeline run process...handleOutput" << slog::endl;
+  bool deferred = overlapsFrames();
+  if (deferred) {
+    feedOutputs(contexts);
+  }
+  FrameContext::DeferredResults results;
+  for (auto & context : contexts) {
+    // outputs take the header of the frame from the current context
+    current_context_ = context;
+    auto t_output = LatencyStats::Clock::now();
+    if (deferred) {
+      context->takeDeferredResults(results);
+      std::lock_guard<std::mutex> lk(outputs_mutex_);
+      for (auto & result : results) {
+        if (!result.first->isSkippingFrame()) {
+          result.first->acceptView(result.second);
+        }
+      }
+    }
+    for (auto & output : getOutputs(context->getInputId())) {
+      if (!output->isSkippingFrame()) {
+        output->handleOutput();
+      }
+    }
+    stats_.add("output", t_output);
+    stats_.add("frame", context->getCaptureTime());
+    if (context->hasDeadline() && LatencyStats::Clock::now() > context->getDeadline()) {
+      ++deadline_misses_;
+    }
+  }
+}
+
+void Pipeline::flush()
+{
+  outputDispatchedFrames(0);
+}
+
+std::vector<std::shared_ptr<Outputs::BaseOutput>> Pipeline::getOutputs(int input_id) const
+{
+  std::vector<std::shared_ptr<Outputs::BaseOutput>> outputs;
+  for (auto & node : graph_nodes_) {
+    if (input_id < static_cast<int>(node.outputs.size()) && node.outputs[input_id] != nullptr) {
+      outputs.push_back(node.outputs[input_id]);
+    }
+  }
+  return outputs;
+}
+
+bool Pipeline::waitForFrame(const std::chrono::milliseconds & timeout)
+{
+  if (!dispatched_frames_.empty()) {
+    // runOnce outputs them if no frame is ready
+    return true;
+  }
+  if (!useCaptureThread()) {
+    if (input_devices_.size() <= 1) {
+      return input_device_->waitForFrame(timeout);
+    }
+    // inputs are read in lock-step, go on as soon as any of them is ready
+    auto slice = timeout / static_cast<int>(input_devices_.size());
+    for (auto & device : input_devices_) {
+      if (device->waitForFrame(slice)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  if (capture_thread_ == nullptr && !draining_) {
+    startCapture();
+  }
+  std::unique_lock<std::mutex> lock(inflight_mutex_);
+  return inflight_cv_.wait_for(lock, timeout, [self = this]() {
+             return !self->inflight_frames_.empty();
+           });
+}
+
+bool Pipeline::isExhausted()
+{
+  if (input_devices_.empty()) {
+    return false;
+  }
+  for (auto & device : input_devices_) {
+    if (!device->isExhausted()) {
+      return false;
+    }
+  }
+  std::lock_guard<std::mutex> lock(inflight_mutex_);
+  return inflight_frames_.empty() && dispatched_frames_.empty();
+}
+
+std::shared_ptr<FrameContext> Pipeline::readFrame()
+{
+  if (!useCaptureThread()) {
+    cv::Mat frame;
+    FramePool::attach(frame);  // pixels are recycled once all the outputs are done
+    auto t_capture = LatencyStats::Clock::now();
+    if (!input_device_->read(&frame) || dropFrame()) {
+      return nullptr;
+    }
+    stats_.add("capture", t_capture);
+    auto context = context_pool_.acquire();
+    setFrame(context, frame, *input_device_);
+    DYNAMIC_VINO_LIB_TRACE(read, getName(), input_device_name_, context->getFrameId(), 0);
+    return context;
+  }
+
+  if (capture_thread_ == nullptr && !draining_) {
+    startCapture();
+  }
+  std::unique_lock<std::mutex> lock(inflight_mutex_);
+  inflight_cv_.wait_for(lock, std::chrono::milliseconds(100), [self = this]() {
+      return !self->inflight_frames_.empty() || !self->capture_running_;
+    });
+  if (inflight_frames_.empty()) {
+    return nullptr;
+  }
+  auto context = inflight_frames_.front();
+  inflight_frames_.pop_front();
+  inflight_cv_.notify_all();
+  return context;
+}
+
+void Pipeline::setFrame(
+  const std::shared_ptr<FrameContext> & context, cv::Mat & frame,
+  Input::BaseInputDevice & device)
+{
+  bool nv12 = device.isNV12();
+  auto depth = device.getDepth();
+  cv::Size size = nv12 ? getNV12Size(frame) : frame.size();
+  // even, so that the chroma of an NV12 frame keeps its 2x2 blocks
+  int width = (params_ == nullptr ? 0 : params_->getWorkingWidth()) & ~1;
+  if (width >= 2 && size.width > width) {
+    auto t_scale = LatencyStats::Clock::now();
+    int height = std::max(2, static_cast<int>(
+          static_cast<int64_t>(size.height) * width / size.width) & ~1);
+    cv::Mat scaled;
+    if (nv12) {
+      scaled = FramePool::create(cv::Size(width, height * 3 / 2), CV_8UC1);
+      cv::Mat luma = getNV12Luma(scaled);
+      cv::Mat chroma = getNV12Chroma(scaled);
+      cv::resize(getNV12Luma(frame), luma, luma.size(), 0, 0, cv::INTER_AREA);
+      cv::resize(getNV12Chroma(frame), chroma, chroma.size(), 0, 0, cv::INTER_AREA);
+    } else {
+      scaled = FramePool::create(cv::Size(width, height), frame.type());
+      cv::resize(frame, scaled, scaled.size(), 0, 0, cv::INTER_AREA);
+    }
+    frame = scaled;
+    stats_.add("scale", t_scale);
+    float scale = static_cast<float>(size.width) / width;
+    context->setFrame(frame, device.getLockedHeader(), nv12);
+    context->setFrameScale(scale);
+    context->setDepth(depth == nullptr ? nullptr :
+      std::make_shared<Input::ScaledDepthLookup>(depth, scale));
+    return;
+  }
+  context->setFrame(frame, device.getLockedHeader(), nv12);
+  context->setDepth(depth);
+}
+
+std::vector<std::shared_ptr<FrameContext>> Pipeline::readFrames()
+{
+  std::vector<std::shared_ptr<FrameContext>> contexts;
+  if (input_devices_.size() <= 1) {
+    auto context = readFrame();
+    if (context != nullptr) {
+      contexts.push_back(context);
+    }
+    return contexts;
+  }
+
+  for (size_t i = 0; i < input_devices_.size(); i++) {
+    cv::Mat frame;
+    FramePool::attach(frame);  // pixels are recycled once all the outputs are done
+    auto t_capture = LatencyStats::Clock::now();
+    if (!input_devices_[i]->read(&frame) || frame.empty()) {
+      continue;
+    }
+    stats_.add("capture", t_capture);
+    auto context = context_pool_.acquire();
+    setFrame(context, frame, *input_devices_[i]);
+    context->setInputId(static_cast<int>(i));
+    DYNAMIC_VINO_LIB_TRACE(read, getName(), input_device_names_[i], context->getFrameId(), i);
+    contexts.push_back(context);
+  }
+  // the frame policy applies to the frames of all the inputs together
+  if (!contexts.empty() && dropFrame()) {
+    contexts.clear();
+  }
+  return contexts;
+}
+
+int Pipeline::getFramesInFlight() const
+{
+  return params_ == nullptr ? 1 : params_->getFramesInFlight();
+}
+
+std::vector<std::pair<std::string, size_t>> Pipeline::getQueueDepths()
+{
+  std::vector<std::pair<std::string, size_t>> depths;
+  {
+    std::lock_guard<std::mutex> lk(inflight_mutex_);
+    depths.emplace_back("frames", inflight_frames_.size());
+  }
+  for (auto & node : graph_nodes_) {
+    if (node.state == nullptr) {
+      continue;
+    }
+    std::lock_guard<std::mutex> lk(node.state->mtx);
+    depths.emplace_back(node.name + "/pending", node.state->pending.size());
+    depths.emplace_back(node.name + "/running", static_cast<size_t>(node.state->running));
+  }
+  for (auto & output : name_to_output_map_) {
+    depths.emplace_back(output.first + "/output", output.second->getQueueDepth());
+  }
+  return depths;
+}
+
+std::vector<std::pair<std::string, uint64_t>> Pipeline::getMemoryUsage()
+{
+  std::vector<std::pair<std::string, uint64_t>> usage;
+  for (auto & detection : name_to_detection_map_) {
+    auto engine = detection.second->getEngine();
+    if (engine != nullptr) {
+      usage.emplace_back(detection.first + "/network", engine->getNetworkBytes());
+      usage.emplace_back(detection.first + "/blobs", engine->getBlobBytes());
+    }
+    size_t gallery = detection.second->getGalleryBytes();
+    if (gallery > 0) {
+      usage.emplace_back(detection.first + "/gallery", gallery);
+    }
+  }
+  for (auto & output : name_to_output_map_) {
+    usage.emplace_back(output.first + "/queue", output.second->getQueueBytes());
+  }
+  return usage;
+}
+
+bool Pipeline::useCaptureThread() const
+{
+  // several inputs are read in lock-step by the pipeline thread
+  return input_devices_.size() <= 1 && (getFramesInFlight() > 1 ||
+         (params_ != nullptr && params_->getFramePolicy() == kFramePolicy_Latest));
+}
+
+bool Pipeline::dropFrame()
+{
+  if (params_ == nullptr) {
+    return false;
+  }
+  bool drop = false;
+  const std::string & policy = params_->getFramePolicy();
+  if (policy == kFramePolicy_Decimation) {
+    int decimation = std::max(1, params_->getFrameDecimation());
+    drop = (read_frame_cnt_++ % decimation) != 0;
+  }
+  float fps = policy == kFramePolicy_TargetFps ? params_->getTargetFps() : 0;
+  for (float limit : {rate_limit_.load(), power_limit_.load()}) {
+    if (limit > 0 && (fps <= 0 || limit < fps)) {
+      fps = limit;
+    }
+  }
+  if (!drop && fps > 0) {
+    auto now = std::chrono::steady_clock::now();
+    auto interval = std::chrono::duration<double>(1.0 / fps);
+    if (now - last_accepted_frame_ < interval) {
+      drop = true;
+    } else {
+      last_accepted_frame_ = now;
+    }
+  }
+  if (drop) {
+    ++dropped_frames_;
+  }
+  return drop;
+}
+
+void Pipeline::startCapture()
+{
+  slog::info << "Start capturing thread for pipeline, frames in flight: " <<
+    getFramesInFlight() << slog::endl;
+  capture_running_ = true;
+  capture_thread_ = std::make_shared<std::thread>(&Pipeline::threadCapture, this);
+}
+
+void Pipeline::stopCapture()
+{
+  if (capture_thread_ == nullptr) {
+    return;
+  }
+  capture_running_ = false;
+  inflight_cv_.notify_all();
+  if (capture_thread_->joinable()) {
+    capture_thread_->join();
+  }
+  capture_thread_ = nullptr;
+}
+
+void Pipeline::pause()
+{
+  capture_paused_ = true;
+  inflight_cv_.notify_all();
+  flush();
+}
+
+void Pipeline::resume()
+{
+  {
+    std::lock_guard<std::mutex> lock(inflight_mutex_);
+    if (!capture_paused_) {
+      return;
+    }
+    // captured before the pause, the first frame processed is a fresh one
+    dropped_frames_ += inflight_frames_.size();
+    inflight_frames_.clear();
+    capture_paused_ = false;
+  }
+  inflight_cv_.notify_all();
+}
+
+void Pipeline::drain()
+{
+  draining_ = true;
+  stopCapture();
+  while (true) {
+    {
+      std::lock_guard<std::mutex> lock(inflight_mutex_);
+      if (inflight_frames_.empty()) {
+        break;
+      }
+    }
+    runOnce();
+  }
+  flush();
+  if (dispatcher_ != nullptr) {
+    dispatcher_->waitIdle();
+  }
+}
+
+void Pipeline::threadCapture()
+{
+  /**< one frame waits for the pipeline thread, the others are dispatched >**/
+  const size_t queue_size = 1;
+  /**< with the latest-frame policy the capturing never waits, stale frames are dropped >**/
+  const bool keep_latest = params_->getFramePolicy() == kFramePolicy_Latest;
+  while (capture_running_) {
+    {
+      // a paused pipeline does not capture either
+      std::unique_lock<std::mutex> lock(inflight_mutex_);
+      inflight_cv_.wait(lock, [self = this, queue_size, keep_latest]() {
+          return !self->capture_running_ || (!self->capture_paused_ &&
+                 (keep_latest || self->inflight_frames_.size() < queue_size));
+        });
+    }
+    if (!capture_running_) {
+      break;
+    }
+
+    if (!input_device_->waitForFrame(std::chrono::milliseconds(100))) {
+      continue;
+    }
+    cv::Mat frame;
+    FramePool::attach(frame);  // pixels are recycled once all the outputs are done
+    auto t_capture = LatencyStats::Clock::now();
+    if (!input_device_->read(&frame) || frame.empty()) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      continue;
+    }
+    stats_.add("capture", t_capture);
+    if (dropFrame()) {
+      continue;
+    }
+    auto context = context_pool_.acquire();
+    setFrame(context, frame, *input_device_);
+    DYNAMIC_VINO_LIB_TRACE(read, getName(), input_device_name_, context->getFrameId(), 0);
+
+    std::lock_guard<std::mutex> lock(inflight_mutex_);
+    while (keep_latest && inflight_frames_.size() >= queue_size) {
+      inflight_frames_.pop_front();
+      ++dropped_frames_;
+    }
+    inflight_frames_.push_back(context);
+    inflight_cv_.notify_all();
   }
 }
 
@@ -232,78 +890,883 @@ void Pipeline::printPipeline()
   }
 }
 
-void Pipeline::setCallback()
+void Pipeline::compileGraph()
 {
+  std::vector<GraphNode> nodes;
+  std::map<std::string, int> ids;
+  auto add_node = [&nodes, &ids](const std::string & name, int category) {
+      GraphNode node;
+      node.name = name;
+      node.category = category;
+      ids[name] = static_cast<int>(nodes.size());
+      nodes.push_back(node);
+      return ids[name];
+    };
+
+  std::vector<int> input_ids;
+  for (auto & name : input_device_names_) {
+    input_ids.push_back(add_node(name, kCatagoryOrder_Input));
+  }
   for (auto & pair : name_to_detection_map_) {
-    std::string detection_name = pair.first;
-    std::function<void(void)> callb;
-    callb = [detection_name, self = this]()
-      {
-        self->callback(detection_name);
-        return;
-      };
-    pair.second->getEngine()->getRequest()->SetCompletionCallback(callb);
+    int id = add_node(pair.first, kCatagoryOrder_Inference);
+    nodes[id].inference = pair.second;
+    nodes[id].state = std::make_shared<InferenceState>();
+    int requests = pair.second->getEngine() == nullptr ? 1 :
+      pair.second->getEngine()->getRequestNum();
+    nodes[id].state->requests.resize(requests);
+    nodes[id].state->max_running =
+      pair.second->supportsConcurrentRequests() ? requests : 1;
+  }
+  for (auto & pair : name_to_output_map_) {
+    int id = add_node(pair.first, kCatagoryOrder_Output);
+    // one instance per input, the default instance serves the first input
+    nodes[id].outputs.resize(std::max<size_t>(1, input_device_names_.size()));
+    nodes[id].outputs[0] = pair.second;
+    for (size_t i = 0; i < input_device_names_.size(); i++) {
+      auto input = input_to_outputs_.find(input_device_names_[i]);
+      if (input == input_to_outputs_.end()) {
+        continue;
+      }
+      auto output = input->second.find(pair.first);
+      if (output != input->second.end()) {
+        nodes[id].outputs[i] = output->second;
+      }
+    }
+  }
+
+  for (auto & connect : next_) {
+    if (connect.first.empty()) {
+      continue;
+    }
+    auto from = ids.find(connect.first);
+    auto to = ids.find(connect.second);
+    if (from == ids.end() || to == ids.end()) {
+      slog::warn << "Skip the connect [" << connect.first << "<-->" << connect.second <<
+        "] with unknown items." << slog::endl;
+      continue;
+    }
+    GraphEdge edge;
+    edge.to = to->second;
+    edge.filter_conditions = findFilterConditions(connect.first, connect.second);
+    if (nodes[from->second].inference != nullptr) {
+      nodes[from->second].inference->compileFilterConditions(edge.filter_conditions);
+    }
+    if (nodes[to->second].category == kCatagoryOrder_Output) {
+      nodes[from->second].output_edges.push_back(edge);
+    } else if (nodes[to->second].category == kCatagoryOrder_Inference) {
+      nodes[from->second].inference_edges.push_back(edge);
+    }
+  }
+  // the ROIs of a frame are routed to the inferences of higher priority first
+  for (auto & node : nodes) {
+    std::stable_sort(node.inference_edges.begin(), node.inference_edges.end(),
+      [&nodes](const GraphEdge & a, const GraphEdge & b) {
+        return nodes[a.to].inference->getPriority() > nodes[b.to].inference->getPriority();
+      });
+  }
+  // the cascaded inferences holding their partial batches for the ROIs of other frames
+  std::vector<int> coalescing;
+  float batch_wait = 0;
+  for (size_t id = 0; id < nodes.size(); id++) {
+    auto & inference = nodes[id].inference;
+    nodes[id].coalesce = inference != nullptr && inference->getBatchWait() > 0 &&
+      inference->supportsSlotSelection() && inference->getMaxBatchSize() > 1;
+    if (nodes[id].coalesce) {
+      coalescing.push_back(static_cast<int>(id));
+      batch_wait = batch_wait == 0 ? inference->getBatchWait() :
+        std::min(batch_wait, inference->getBatchWait());
+    }
   }
+  for (int id : coalescing) {
+    std::vector<bool> upstream(nodes.size(), false);
+    upstream[id] = true;
+    for (bool grown = true; grown; ) {
+      grown = false;
+      for (size_t from = 0; from < nodes.size(); from++) {
+        for (auto & edge : nodes[from].inference_edges) {
+          if (upstream[edge.to] && !upstream[from]) {
+            upstream[from] = true;
+            grown = true;
+          }
+        }
+      }
+    }
+    for (size_t from = 0; from < nodes.size(); from++) {
+      if (upstream[from] && static_cast<int>(from) != id && nodes[from].state != nullptr) {
+        nodes[id].ancestors.push_back(static_cast<int>(from));
+        nodes[from].coalescing_descendants.push_back(id);
+      }
+    }
+  }
+
+  graph_nodes_.swap(nodes);
+  graph_node_ids_.swap(ids);
+  graph_input_ids_.swap(input_ids);
+  coalescing_nodes_.swap(coalescing);
+  batch_wait_ = batch_wait;
+  compileInputRegions();
+  graph_dirty_ = false;
+}
+
+void Pipeline::compileInputRegions()
+{
+  input_regions_.assign(input_device_names_.size(), InputRegion());
+  if (params_ == nullptr) {
+    return;
+  }
+  for (size_t i = 0; i < input_device_names_.size(); i++) {
+    const std::string & roi = params_->getInputRoi(input_device_names_[i]);
+    if (roi.empty()) {
+      continue;
+    }
+    if (roi == "auto") {
+      input_regions_[i].dynamic = true;
+      continue;
+    }
+    int x, y, width, height;
+    if (std::sscanf(roi.c_str(), "%d,%d,%d,%d", &x, &y, &width, &height) != 4 ||
+      width <= 0 || height <= 0)
+    {
+      slog::warn << "Invalid input roi " << roi << " for " << input_device_names_[i] <<
+        ", the whole frames are inferred." << slog::endl;
+      continue;
+    }
+    input_regions_[i].fixed = cv::Rect(x, y, width, height);
+  }
+}
+
+cv::Rect Pipeline::selectInputRegion(const FrameContext & context)
+{
+  int input_id = context.getInputId();
+  if (input_id >= static_cast<int>(input_regions_.size())) {
+    return cv::Rect();
+  }
+  auto & region = input_regions_[input_id];
+  if (!region.dynamic) {
+    // given in the pixels of the native frame
+    float scale = context.getFrameScale();
+    auto & fixed = region.fixed;
+    return scale == 1 ? fixed : cv::Rect(cvRound(fixed.x / scale), cvRound(fixed.y / scale),
+             cvRound(fixed.width / scale), cvRound(fixed.height / scale));
+  }
+  // the whole frame is inferred from time to time, for the objects entering it
+  int refresh = std::max(1, params_->getRoiRefreshInterval());
+  if (region.frames++ % refresh == 0) {
+    return cv::Rect();
+  }
+  return region.extent;
+}
+
+void Pipeline::updateInputRegion(FrameContext & context)
+{
+  int input_id = context.getInputId();
+  if (input_id >= static_cast<int>(input_regions_.size()) || !input_regions_[input_id].dynamic) {
+    return;
+  }
+  cv::Rect extent;
+  for (auto & edge : graph_nodes_[graph_input_ids_[input_id]].inference_edges) {
+    for (auto & location : context.getResults(graph_nodes_[edge.to].name)) {
+      extent = extent.area() > 0 ? (extent | location) : location;
+    }
+  }
+  if (extent.area() <= 0) {
+    // nothing detected, the next frame is inferred as a whole
+    input_regions_[input_id].extent = cv::Rect();
+    return;
+  }
+  // the margin covers the motion until the next frame and keeps some context
+  // around small objects
+  int margin_x = std::max(extent.width / 4, 32);
+  int margin_y = std::max(extent.height / 4, 32);
+  extent -= cv::Point(margin_x, margin_y);
+  extent += cv::Size(2 * margin_x, 2 * margin_y);
+  input_regions_[input_id].extent = extent & context.getFrameRect();
+}
+
+void Pipeline::setCallback()
+{
+  compileGraph();
+  if (dispatcher_ == nullptr) {
+    size_t threads = std::max<size_t>(1, std::min<size_t>(
+        total_inference_, std::thread::hardware_concurrency()));
+    slog::info << "Creating " << threads << " dispatcher threads for pipeline" << slog::endl;
+    dispatcher_ = std::make_shared<ThreadPool>(threads);
+  }
+  int preprocess_threads = params_ == nullptr ? 0 : params_->getPreprocessThreads();
+  if (preprocess_pool_ == nullptr && preprocess_threads > 0) {
+    slog::info << "Creating " << preprocess_threads << " preprocessing threads for pipeline" <<
+      slog::endl;
+    preprocess_pool_ = std::make_shared<ThreadPool>(preprocess_threads);
+  }
+
+  for (size_t id = 0; id < graph_nodes_.size(); id++) {
+    auto & node = graph_nodes_[id];
+    if (node.inference == nullptr) {
+      continue;
+    }
+    int node_id = static_cast<int>(id);
+    node.inference->setTraceNames(getName(), node.name);
+    auto engine = node.inference->getEngine();
+    for (int request_id = 0; request_id < engine->getRequestNum(); request_id++) {
+      Engines::Engine * raw_engine = engine.get();
+      auto callb = [node_id, request_id, raw_engine, self = this](bool succeeded)
+        {
+          DYNAMIC_VINO_LIB_TRACE(completion, self->getName(), self->graph_nodes_[node_id].name,
+            self->getRequestFrameId(node_id, request_id), request_id);
+          // the device is free for the next admitted request before the results are fetched
+          raw_engine->finishRequest(request_id);
+          bool failed = !succeeded;
+          raw_engine->recordResult(request_id, succeeded);
+          self->dispatcher_->post([node_id, request_id, failed, self]() {
+              self->callback(node_id, request_id, failed);
+            });
+          return;
+        };
+      engine->setCompletionCallback(request_id, callb);
+    }
+  }
+}
+
+uint64_t Pipeline::getRequestFrameId(int node_id, int request_id)
+{
+  auto & state = graph_nodes_[node_id].state;
+  std::lock_guard<std::mutex> lk(state->mtx);
+  auto & contexts = state->requests[request_id].contexts;
+  return contexts.empty() ? 0 : contexts.front()->getFrameId();
+}
+
+double Pipeline::getRequestMs(const std::string & name)
+{
+  auto it = graph_node_ids_.find(name);
+  if (it == graph_node_ids_.end()) {
+    return 0;
+  }
+  auto & state = graph_nodes_[it->second].state;
+  std::lock_guard<std::mutex> lk(state->mtx);
+  return state->request_ms;
 }
 
 void Pipeline::callback(const std::string & detection_name)
 {
-  slog::debug <<"Hello callback ----> " << detection_name <<slog::endl;
-  auto detection_ptr = name_to_detection_map_[detection_name];
-  detection_ptr->fetchResults();
-  // set output
-  for (auto pos = next_.equal_range(detection_name); pos.first != pos.second; ++pos.first) {
-    std::string next_name = pos.first->second;
+  auto it = graph_node_ids_.find(detection_name);
+  if (it == graph_node_ids_.end()) {
+    slog::warn << "No inference named " << detection_name << " in the pipeline." << slog::endl;
+    return;
+  }
+  callback(it->second, 0);
+}
+
+void Pipeline::callback(int node_id, int request_id, bool failed)
+{
+  auto & node = graph_nodes_[node_id];
+  SLOG_DEBUG << "Hello callback ----> " << node.name <<slog::endl;
+  auto state = node.state;
+  std::vector<std::shared_ptr<FrameContext>> contexts;
+  std::vector<std::shared_ptr<FrameContext>> slots;
+  std::vector<int64_t> slot_track_keys;
+  LatencyStats::Clock::time_point submit_time;
+  {
+    std::lock_guard<std::mutex> lk(state->mtx);
+    auto & request = state->requests[request_id];
+    contexts = request.contexts;
+    slots = request.slots;
+    slot_track_keys.swap(request.slot_track_keys);
+    submit_time = request.submit_time;
+  }
+  if (contexts.empty()) {
+    slog::warn << "No frame context bound to the request of " << node.name << slog::endl;
+    return;
+  }
+  auto detection_ptr = node.inference;
+  auto engine = detection_ptr->getEngine();
+  if (failed) {
+    // the frames go on without the results of this inference
+    ++request_failures_;
+    slog::warn << "An infer request of " << node.name << " failed, " <<
+      engine->getConsecutiveErrors() << " in a row" << slog::endl;
+    {
+      std::lock_guard<std::mutex> lk(state->mtx);
+      state->running--;
+      state->requests[request_id] = RequestState();
+    }
+    engine->releaseRequest(request_id);
+    releaseContexts(contexts);
+    submitConcurrently(node.coalescing_descendants);
+    submitPending(node_id);
+    return;
+  }
+  double request_ms = LatencyStats::elapsed(submit_time);
+  stats_.add(node.name + "/inference", request_ms);
 
-    std::string filter_conditions = findFilterConditions(detection_name, next_name);
+  // queue ROIs to all downstream inferences, then run the sibling branches concurrently
+  std::vector<int> next_stages;
+  {
+    std::lock_guard<std::mutex> lk(state->inference_mtx);
+    engine->bindRequest(request_id);
+    if (engine->isPerfCountEnabled()) {
+      perf_counters_.add(node.name, engine->getRequest()->getPerformanceCounts());
+    }
+    auto t_postprocess = LatencyStats::Clock::now();
+    detection_ptr->setTraceFrame(contexts.front()->getFrameId());
+    detection_ptr->fetchResults();
+    if (!slot_track_keys.empty()) {
+      detection_ptr->cacheResults(slot_track_keys);
+    }
+    stats_.add(node.name + "/postprocess", t_postprocess);
 
-    if (output_names_.find(next_name) != output_names_.end()) {
-      detection_ptr->observeOutput(name_to_output_map_[next_name]);
+    bool mixed = std::any_of(slots.begin(), slots.end(),
+        [&slots](const std::shared_ptr<FrameContext> & slot) {
+          return slot != slots.front();
+        });
+    if (!mixed) {
+      auto & context = contexts.front();
+      detection_ptr->trackResults(context->getInputId(), context->getGrayFrame());
+      routeResults(node_id, context, next_stages);
     } else {
-      auto detection_ptr_iter = name_to_detection_map_.find(next_name);
-      if (detection_ptr_iter != name_to_detection_map_.end()) {
-        auto next_detection_ptr = detection_ptr_iter->second;
-        size_t batch_size = next_detection_ptr->getMaxBatchSize();
-        std::vector<cv::Rect> next_rois = detection_ptr->getFilteredROIs(filter_conditions);
-        for (size_t i = 0; i < next_rois.size(); i++) {
-          auto roi = next_rois[i];
-          auto clippedRect = roi & cv::Rect(0, 0, width_, height_);
-          cv::Mat next_input = frame_(clippedRect);
-          next_detection_ptr->enqueue(next_input, roi);
-          if ((i + 1) == next_rois.size() || (i + 1) % batch_size == 0) {
-            increaseInferenceCounter();
-            next_detection_ptr->submitRequest();
-            auto request = next_detection_ptr->getEngine()->getRequest();
-            request->Wait(InferenceEngine::IInferRequest::WaitMode::RESULT_READY);
-          }
+      // a batch of the frames of several inputs, or of the ROIs of several frames,
+      // split the results by the batch slots of each frame
+      for (size_t first = 0; first < slots.size(); ) {
+        size_t last = first + 1;
+        while (last < slots.size() && slots[last] == slots[first]) {
+          last++;
+        }
+        detection_ptr->selectBatchSlots(static_cast<int>(first), static_cast<int>(last - first));
+        detection_ptr->trackResults(slots[first]->getInputId(), slots[first]->getGrayFrame());
+        routeResults(node_id, slots[first], next_stages);
+        first = last;
+      }
+      detection_ptr->selectBatchSlots(-1, 0);
+    }
+  }
+  // once this request is done the batches held downstream may be complete
+  next_stages.insert(next_stages.end(), node.coalescing_descendants.begin(),
+    node.coalescing_descendants.end());
+  std::sort(next_stages.begin(), next_stages.end());
+  next_stages.erase(std::unique(next_stages.begin(), next_stages.end()), next_stages.end());
+
+  {
+    std::lock_guard<std::mutex> lk(state->mtx);
+    state->running--;
+    state->requests[request_id] = RequestState();
+    state->request_ms = state->request_ms == 0 ? request_ms :
+      0.9 * state->request_ms + 0.1 * request_ms;
+  }
+  engine->releaseRequest(request_id);
+  submitConcurrently(next_stages);
+  releaseContexts(contexts);
+  submitPending(node_id);
+}
+
+void Pipeline::routeResults(
+  int node_id, std::shared_ptr<FrameContext> context,
+  std::vector<int> & next_stages)
+{
+  // the work already routed for the frame, which the next inferences wait for
+  LatencyStats::Clock::duration routed(0);
+  auto & node = graph_nodes_[node_id];
+  auto detection_ptr = node.inference;
+
+  auto & result_locations = node.state->result_locations;
+  result_locations.clear();
+  for (int i = 0; i < detection_ptr->getResultsLength(); i++) {
+    result_locations.push_back(detection_ptr->getLocationResult(i)->getLocation());
+  }
+  context->addResults(node.name, result_locations);
+  // the positions of the results published, from the depth of their regions
+  if (context->getDepth() != nullptr && !node.output_edges.empty()) {
+    detection_ptr->locateResults(*context->getDepth());
+  }
+
+  // set output, the results are handed to all the outputs as one view
+  int input_id = context->getInputId();
+  // with overlapping frames the outputs may still be busy with an earlier frame
+  bool deferred = overlapsFrames();
+  dynamic_vino_lib::ResultView results;
+  for (auto & edge : node.output_edges) {
+    auto & outputs = graph_nodes_[edge.to].outputs;
+    if (input_id >= static_cast<int>(outputs.size()) || outputs[input_id] == nullptr ||
+      (!deferred && outputs[input_id]->isSkippingFrame()))
+    {
+      continue;
+    }
+    DYNAMIC_VINO_LIB_TRACE(accept, getName(), graph_nodes_[edge.to].name, context->getFrameId(),
+      detection_ptr->getResultsLength());
+    if (!results.isValid()) {
+      results = detection_ptr->getResultView();
+      results.setAge(context->getResultAge(node_id));
+    }
+    if (deferred) {
+      context->deferResults(outputs[input_id], results.share());
+      continue;
+    }
+    std::lock_guard<std::mutex> lk(outputs_mutex_);
+    outputs[input_id]->acceptView(results);
+  }
+
+  for (auto & edge : node.inference_edges) {
+    auto t_filter = LatencyStats::Clock::now();
+    auto & next_rois = node.state->rois;
+    detection_ptr->fillFilteredROIs(edge.filter_conditions, next_rois);
+    auto & next = graph_nodes_[edge.to];
+    auto & track_keys = node.state->track_keys;
+    track_keys.clear();
+    bool cached = next.inference != nullptr && next.inference->isResultCacheEnabled();
+    // an inference skipping frames keeps the last results of the tracks in between
+    int age = next.inference != nullptr ? context->getResultAge(edge.to) : 0;
+    if (cached || (next.inference != nullptr && next.inference->hasExecutionRate())) {
+      auto & track_ids = node.state->track_ids;
+      detection_ptr->fillFilteredTrackIds(edge.filter_conditions, track_ids);
+      for (auto track_id : track_ids) {
+        track_keys.push_back(dynamic_vino_lib::makeTrackKey(input_id, track_id));
+      }
+    }
+    // the ROIs not worth inferring are dropped before anything is enqueued
+    if (next.inference != nullptr && next.inference->isRoiGateEnabled()) {
+      auto & scores = node.state->roi_scores;
+      detection_ptr->fillFilteredRoiScores(edge.filter_conditions, scores);
+      dynamic_vino_lib::applyRoiGate(
+        next.inference->getRoiGatePolicy(), next_rois, scores, track_keys);
+    }
+    // each region is inferred once, whichever of the parents routes it first
+    if (next.inference != nullptr && next.inference->isRoiMergeEnabled()) {
+      auto & merge = next.inference->getRoiMergePolicy();
+      if (merge.isFitting()) {
+        for (auto & roi : next_rois) {
+          roi = dynamic_vino_lib::fitRoi(merge, roi, context->getFrameRect());
         }
       }
+      if (merge.iou > 0) {
+        context->claimRois(next.name, merge.iou, next_rois, track_keys);
+      }
+    }
+    stats_.add(node.name + "/filter", t_filter);
+    DYNAMIC_VINO_LIB_TRACE(filter, getName(), next.name, context->getFrameId(), next_rois.size());
+    context->setRois(node.name, next.name, next_rois);
+    if (age > 0) {
+      // the inference doesn't run on the frame, the ROIs without a result are dropped
+      serveCachedResults(edge.to, context, next_rois, track_keys, age);
+      continue;
+    }
+    if (cached) {
+      serveCachedResults(edge.to, context, next_rois, track_keys);
+    }
+    if (context->hasDeadline() && !next_rois.empty() && next.inference != nullptr) {
+      routed += estimateInferenceTime(edge.to, next_rois.size());
+      if (LatencyStats::Clock::now() + routed > context->getDeadline()) {
+        ++deadline_skips_;
+        continue;
+      }
+    }
+    if (next.inference != nullptr && next.inference->observesUpstream() && !next_rois.empty()) {
+      std::lock_guard<std::mutex> lk(next.state->inference_mtx);
+      next.inference->observeUpstream(*detection_ptr);
+    }
+    if (dispatch(edge.to, context, next_rois, true, track_keys)) {
+      next_stages.push_back(edge.to);
+    }
+  }
+}
+
+void Pipeline::serveCachedResults(
+  int node_id, std::shared_ptr<FrameContext> context,
+  std::vector<cv::Rect> & rois, std::vector<int64_t> & track_keys, int age)
+{
+  if (track_keys.size() != rois.size()) {
+    track_keys.clear();
+    return;
+  }
+  auto & node = graph_nodes_[node_id];
+  std::lock_guard<std::mutex> lk(node.state->inference_mtx);
+  std::vector<size_t> stale;
+  node.inference->loadCachedResults(rois, track_keys, stale, age > 0);
+  if (stale.size() == rois.size()) {
+    return;
+  }
+
+  // the cached results are published like fetched ones, the stale ROIs stay
+  std::vector<cv::Rect> cached_locations;
+  size_t kept = 0;
+  for (size_t i = 0, s = 0; i < rois.size(); i++) {
+    if (s < stale.size() && stale[s] == i) {
+      rois[kept] = rois[i];
+      track_keys[kept] = track_keys[i];
+      kept++;
+      s++;
+    } else {
+      cached_locations.push_back(rois[i]);
     }
   }
+  rois.resize(kept);
+  track_keys.resize(kept);
+  context->addResults(node.name, cached_locations);
 
-  decreaseInferenceCounter();
-  cv_.notify_all();
+  int input_id = context->getInputId();
+  auto results = node.inference->getCachedResultView();
+  results.setAge(age);
+  bool deferred = overlapsFrames();
+  for (auto & edge : node.output_edges) {
+    auto & outputs = graph_nodes_[edge.to].outputs;
+    if (!results.isValid() || input_id >= static_cast<int>(outputs.size()) ||
+      outputs[input_id] == nullptr || (!deferred && outputs[input_id]->isSkippingFrame()))
+    {
+      continue;
+    }
+    if (deferred) {
+      context->deferResults(outputs[input_id], results.share());
+      continue;
+    }
+    std::lock_guard<std::mutex> lk(outputs_mutex_);
+    outputs[input_id]->acceptView(results);
+  }
 }
 
-void Pipeline::initInferenceCounter()
+bool Pipeline::propagateFrame(
+  int node_id, std::shared_ptr<FrameContext> context, bool reuse,
+  std::vector<int> & next_stages)
 {
-  std::lock_guard<std::mutex> lk(counter_mutex_);
-  counter_ = 0;
-  cv_.notify_all();
+  auto & node = graph_nodes_[node_id];
+  std::lock_guard<std::mutex> lk(node.state->inference_mtx);
+  int input_id = context->getInputId();
+  if (!node.inference->propagateResults(input_id, context->getGrayFrame()) &&
+    !(reuse && node.inference->reuseResults(input_id)))
+  {
+    return false;
+  }
+  routeResults(node_id, context, next_stages);
+  return true;
 }
 
-void Pipeline::increaseInferenceCounter()
+bool Pipeline::isStillFrame(const std::shared_ptr<FrameContext> & context)
 {
-  std::lock_guard<std::mutex> lk(counter_mutex_);
-  ++counter_;
-  // slog::info << "counter = " << counter_ << slog::endl;
+  if (params_ == nullptr || params_->getMotionThreshold() <= 0) {
+    return false;
+  }
+  bool still = motion_gate_.isStill(context->getInputId(), context->getGrayFrame(),
+      params_->getMotionThreshold(), params_->getMotionMaxSkip());
+  gated_frames_++;
+  if (still) {
+    still_frames_++;
+  }
+  return still;
 }
 
-void Pipeline::decreaseInferenceCounter()
+int Pipeline::updateResultAge(int node_id, int input_id, LatencyStats::Clock::time_point now)
 {
-  std::lock_guard<std::mutex> lk(counter_mutex_);
-  --counter_;
-  // slog::info << "counter = " << counter_ << slog::endl;
+  auto & node = graph_nodes_[node_id];
+  if (node.state == nullptr) {
+    return 0;
+  }
+  auto & last_runs = node.state->last_runs;
+  auto iter = last_runs.find(input_id);
+  if (iter == last_runs.end()) {
+    // the first frame of an input is always inferred
+    last_runs[input_id] = std::make_pair(0, now);
+    return 0;
+  }
+  auto & run = iter->second;
+  bool due = run.first + 1 >= node.inference->getEveryNFrames();
+  float max_hz = node.inference->getMaxHz();
+  auto period = LatencyStats::Clock::duration(0);
+  if (due && max_hz > 0) {
+    period = std::chrono::duration_cast<LatencyStats::Clock::duration>(
+      std::chrono::duration<double>(1.0 / max_hz));
+    due = now - run.second >= period;
+  }
+  if (!due) {
+    return ++run.first;
+  }
+  // the runs keep their phase, unless the frames came late
+  run.first = 0;
+  run.second = period.count() > 0 && now - run.second < period * 2 ? run.second + period : now;
+  return 0;
+}
+
+LatencyStats::Clock::duration Pipeline::estimateInferenceTime(int node_id, size_t rois)
+{
+  auto & node = graph_nodes_[node_id];
+  size_t batch_size = std::max(1, node.inference->getMaxBatchSize());
+  size_t batches = (rois + batch_size - 1) / batch_size;
+  double request_ms;
+  int max_running;
+  {
+    std::lock_guard<std::mutex> lk(node.state->mtx);
+    request_ms = node.state->request_ms;
+    max_running = std::max(1, node.state->max_running);
+  }
+  // the batches run max_running at a time
+  size_t rounds = (batches + max_running - 1) / max_running;
+  return std::chrono::duration_cast<LatencyStats::Clock::duration>(
+    std::chrono::duration<double, std::milli>(request_ms * rounds));
+}
+
+bool Pipeline::dispatch(
+  int node_id, std::shared_ptr<FrameContext> context,
+  const std::vector<cv::Rect> & rois, bool crop,
+  const std::vector<int64_t> & track_keys)
+{
+  auto & node = graph_nodes_[node_id];
+  if (node.state == nullptr || rois.empty()) {
+    return false;
+  }
+  auto state = node.state;
+  size_t batch_size = std::max(1, node.inference->getMaxBatchSize());
+  bool tracked = track_keys.size() == rois.size();
+  std::lock_guard<std::mutex> lk(state->mtx);
+  size_t i = 0;
+  if (crop && node.coalesce && !state->pending.empty()) {
+    // the ROIs fill the partial batch held for them, after those of the other frames
+    auto & held = state->pending.back();
+    if (held.crop && held.rois.size() < batch_size &&
+      (held.track_keys.size() == held.rois.size()) == tracked)
+    {
+      i = std::min(batch_size - held.rois.size(), rois.size());
+      held.rois.insert(held.rois.end(), rois.begin(), rois.begin() + i);
+      if (tracked) {
+        held.track_keys.insert(held.track_keys.end(), track_keys.begin(), track_keys.begin() + i);
+      }
+      if (std::find(held.contexts.begin(), held.contexts.end(), context) == held.contexts.end()) {
+        context->increaseInferenceCounter();
+      }
+      held.contexts.insert(held.contexts.end(), i, context);
+    }
+  }
+  for (; i < rois.size(); i += batch_size) {
+    PendingBatch batch;
+    batch.crop = crop;
+    batch.rois.assign(rois.begin() + i, rois.begin() + std::min(i + batch_size, rois.size()));
+    if (tracked) {
+      batch.track_keys.assign(
+        track_keys.begin() + i, track_keys.begin() + std::min(i + batch_size, rois.size()));
+    }
+    batch.contexts.assign(batch.rois.size(), context);
+    batch.queued_time = LatencyStats::Clock::now();
+    context->increaseInferenceCounter();
+    state->pending.push_back(batch);
+  }
+  return true;
+}
+
+bool Pipeline::dispatchFrames(
+  int node_id, const std::vector<std::shared_ptr<FrameContext>> & contexts)
+{
+  auto & node = graph_nodes_[node_id];
+  if (node.state == nullptr || contexts.empty()) {
+    return false;
+  }
+  auto state = node.state;
+  size_t batch_size = node.inference->isFrameBatchable() ?
+    std::max(1, node.inference->getMaxBatchSize()) : 1;
+  std::lock_guard<std::mutex> lk(state->mtx);
+  for (size_t i = 0; i < contexts.size(); i += batch_size) {
+    PendingBatch batch;
+    batch.crop = false;
+    for (size_t j = i; j < std::min(i + batch_size, contexts.size()); j++) {
+      auto & context = contexts[j];
+      int width = context->getWidth();
+      int height = context->getHeight();
+      batch.contexts.push_back(context);
+      batch.rois.push_back(node.inference->supportsFrameRegions() ?
+        context->getInferenceRegion() : cv::Rect(width / 2, height / 2, width, height));
+      context->increaseInferenceCounter();
+    }
+    state->pending.push_back(batch);
+  }
+  return true;
+}
+
+void Pipeline::releaseContexts(const std::vector<std::shared_ptr<FrameContext>> & contexts)
+{
+  // the counter of a frame is increased once per batch it takes part in
+  std::set<FrameContext *> released;
+  for (auto & context : contexts) {
+    if (released.insert(context.get()).second) {
+      context->decreaseInferenceCounter();
+    }
+  }
+}
+
+void Pipeline::submitConcurrently(const std::vector<int> & node_ids)
+{
+  if (node_ids.empty()) {
+    return;
+  }
+  // sibling branches are preprocessed and submitted by the dispatcher threads,
+  // the last one is done by the current thread
+  for (size_t i = 0; i + 1 < node_ids.size(); i++) {
+    int node_id = node_ids[i];
+    dispatcher_->post([node_id, self = this]() {
+        self->submitPending(node_id);
+      });
+  }
+  submitPending(node_ids.back());
+}
+
+void Pipeline::submitPending(int node_id)
+{
+  auto & node = graph_nodes_[node_id];
+  auto state = node.state;
+  auto detection_ptr = node.inference;
+  auto engine = detection_ptr->getEngine();
+  size_t batch_size = std::max(1, detection_ptr->getMaxBatchSize());
+  auto batch_wait = std::chrono::duration_cast<LatencyStats::Clock::duration>(
+    std::chrono::duration<double, std::milli>(detection_ptr->getBatchWait()));
+  while (true) {
+    PendingBatch batch;
+    int request_id = -1;
+    std::vector<PendingBatch> expired;
+    bool upstream_busy = node.coalesce && isUpstreamBusy(node_id);
+    {
+      std::lock_guard<std::mutex> lk(state->mtx);
+      // the ROIs of the frames past their deadline are not worth inferring anymore
+      auto now = LatencyStats::Clock::now();
+      while (!state->pending.empty() && state->pending.front().crop &&
+        state->pending.front().contexts.front()->hasDeadline() &&
+        now > state->pending.front().contexts.front()->getDeadline())
+      {
+        expired.push_back(state->pending.front());
+        state->pending.pop_front();
+        ++deadline_skips_;
+      }
+    }
+    // each batch holds its frame once
+    for (auto & expired_batch : expired) {
+      releaseContexts(expired_batch.contexts);
+    }
+    {
+      std::lock_guard<std::mutex> lk(state->mtx);
+      if (state->pending.empty() || state->running >= state->max_running) {
+        return;
+      }
+      auto & front = state->pending.front();
+      if (upstream_busy && front.crop && front.rois.size() < batch_size &&
+        LatencyStats::Clock::now() - front.queued_time < batch_wait)
+      {
+        // held for the ROIs the upstream inferences are still to route
+        return;
+      }
+      request_id = engine->acquireRequest();
+      if (request_id < 0) {
+        return;
+      }
+      batch = state->pending.front();
+      state->pending.pop_front();
+      state->running++;
+      state->requests[request_id].contexts = batch.contexts;
+    }
+
+    bool submitted = false;
+    {
+      std::lock_guard<std::mutex> lk(state->inference_mtx);
+      engine->bindRequest(request_id);
+      auto t_preprocess = LatencyStats::Clock::now();
+      std::vector<std::shared_ptr<FrameContext>> slots;
+      std::vector<int64_t> slot_track_keys;
+      bool tracked = batch.track_keys.size() == batch.rois.size();
+      // the ROIs are packed into their batch slots concurrently once all are enqueued
+      bool deferred = batch.crop && preprocess_pool_ != nullptr;
+      detection_ptr->setDeferredPacking(deferred);
+      for (size_t i = 0; i < batch.rois.size(); i++) {
+        auto & context = batch.contexts[i];
+        auto & roi = batch.rois[i];
+        if (!batch.crop) {
+          bool enqueued = false;
+          if (context->isNV12() && roi == context->getFrameRect() &&
+            detection_ptr->supportsNV12())
+          {
+            // the NV12 frame as it is read, it is not converted to BGR for the inference
+            enqueued = detection_ptr->enqueueNV12(context->getNV12Frame());
+          } else if (detection_ptr->supportsFrameRegions() && roi != context->getFrameRect()) {
+            const cv::Mat & frame = context->getFrame();
+            // a region is inferred once per frame, not worth caching
+            enqueued = detection_ptr->enqueueRegion(frame, roi);
+          } else {
+            const cv::Mat & frame = context->getFrame();
+            engine->setPreprocessCache(&context->getPreprocessCache());
+            enqueued = detection_ptr->enqueue(frame, roi);
+            engine->setPreprocessCache(nullptr);
+          }
+          if (enqueued) {
+            DYNAMIC_VINO_LIB_TRACE(enqueue, getName(), node.name, context->getFrameId(),
+              slots.size());
+            slots.push_back(context);
+          }
+          continue;
+        }
+        auto clippedRect = roi & context->getFrameRect();
+        if (clippedRect.area() <= 0) {
+          continue;
+        }
+        const cv::Mat & frame = context->getFrame();
+        // the ROI resized once for the sibling inferences of the same input size
+        engine->setPreprocessCache(&context->getPreprocessCache());
+        bool enqueued = detection_ptr->enqueue(frame(clippedRect), roi);
+        engine->setPreprocessCache(nullptr);
+        if (enqueued) {
+          DYNAMIC_VINO_LIB_TRACE(enqueue, getName(), node.name, context->getFrameId(),
+            slots.size());
+          slots.push_back(context);
+          if (tracked) {
+            slot_track_keys.push_back(batch.track_keys[i]);
+          }
+        }
+      }
+      if (deferred) {
+        detection_ptr->setDeferredPacking(false);
+        detection_ptr->packDeferred(preprocess_pool_.get());
+      }
+      stats_.add(node.name + "/preprocess", t_preprocess);
+      {
+        std::lock_guard<std::mutex> lk(state->mtx);
+        state->requests[request_id].slots = slots;
+        state->requests[request_id].slot_track_keys = slot_track_keys;
+        state->requests[request_id].submit_time = LatencyStats::Clock::now();
+      }
+      if (!slots.empty()) {
+        detection_ptr->setTraceFrame(slots.front()->getFrameId());
+      }
+      try {
+        submitted = detection_ptr->submitRequest();
+      } catch (const std::exception & e) {
+        // e.g. a device removed, the request is counted as failed
+        slog::warn << "Failed to start a request of " << node.name << ": " << e.what() <<
+          slog::endl;
+        engine->finishRequest(request_id);
+        engine->recordResult(request_id, false);
+        ++request_failures_;
+        submitted = false;
+      }
+    }
+
+    if (!submitted) {
+      slog::warn << "Nothing submitted for " << node.name << ", skip the batch." << slog::endl;
+      {
+        std::lock_guard<std::mutex> lk(state->mtx);
+        state->running--;
+        state->requests[request_id] = RequestState();
+      }
+      engine->releaseRequest(request_id);
+      releaseContexts(batch.contexts);
+    }
+  }
+}
+
+bool Pipeline::isUpstreamBusy(int node_id)
+{
+  for (int ancestor : graph_nodes_[node_id].ancestors) {
+    auto & state = graph_nodes_[ancestor].state;
+    std::lock_guard<std::mutex> lk(state->mtx);
+    if (state->running > 0 || !state->pending.empty()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void Pipeline::flushHeldBatches()
+{
+  for (int node_id : coalescing_nodes_) {
+    submitPending(node_id);
+  }
 }
 
 void Pipeline::countFPS()
@@ -315,6 +1778,9 @@ void Pipeline::countFPS()
   if (secondDetection.count() > 1000) {  
     setFPS(frame_cnt_);
     frame_cnt_ = 0;
+    uint64_t dropped = getDroppedFrames();
+    dropped_fps_ = static_cast<int>(dropped - dropped_frames_last_second_);
+    dropped_frames_last_second_ = dropped;
     t_start_ = t_end;
   }
 }
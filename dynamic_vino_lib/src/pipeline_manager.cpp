@@ -18,17 +18,22 @@
  */
 
 #include <vino_param_lib/param_manager.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <future>
 #include <memory>
 #include <string>
 #include <utility>
 #include <map>
+#include <set>
+#include <thread>
+#include <vector>
 
-#if 0
 #include "dynamic_vino_lib/inferences/landmarks_detection.hpp"
 #include "dynamic_vino_lib/inferences/face_reidentification.hpp"
 #include "dynamic_vino_lib/models/face_reidentification_model.hpp"
 #include "dynamic_vino_lib/models/landmarks_detection_model.hpp"
-#endif
 
 #include "dynamic_vino_lib/models/vehicle_attribs_detection_model.hpp"
 #include "dynamic_vino_lib/models/license_plate_detection_model.hpp"
@@ -47,25 +52,43 @@
 #include "dynamic_vino_lib/inferences/head_pose_detection.hpp"
 #include "dynamic_vino_lib/models/head_pose_detection_model.hpp"
 #include "dynamic_vino_lib/models/object_detection_yolov2_model.hpp"
+#include "dynamic_vino_lib/models/object_detection_yolov3_model.hpp"
 #include "dynamic_vino_lib/models/object_detection_ssd_model.hpp"
+#include "dynamic_vino_lib/inferences/object_detection.hpp"
 #include "dynamic_vino_lib/inferences/object_segmentation.hpp"
 #include "dynamic_vino_lib/models/object_segmentation_model.hpp"
 #include "dynamic_vino_lib/inputs/base_input.hpp"
+#include "dynamic_vino_lib/inputs/frame_replay.hpp"
+#include "dynamic_vino_lib/inputs/image_directory.hpp"
 #include "dynamic_vino_lib/inputs/image_input.hpp"
 #include "dynamic_vino_lib/inputs/realsense_camera.hpp"
 #include "dynamic_vino_lib/inputs/realsense_camera_topic.hpp"
 #include "dynamic_vino_lib/inputs/standard_camera.hpp"
 #include "dynamic_vino_lib/inputs/ip_camera.hpp"
 #include "dynamic_vino_lib/inputs/video_input.hpp"
+#ifdef DYNAMIC_VINO_LIB_GSTREAMER
+#include "dynamic_vino_lib/inputs/gstreamer_input.hpp"
+#endif
+#include "dynamic_vino_lib/outputs/async_output.hpp"
 #include "dynamic_vino_lib/outputs/image_window_output.hpp"
 #include "dynamic_vino_lib/outputs/ros_topic_output.hpp"
+#include "dynamic_vino_lib/outputs/ros_aggregate_output.hpp"
 #include "dynamic_vino_lib/outputs/rviz_output.hpp"
 #include "dynamic_vino_lib/outputs/ros_service_output.hpp"
+#include "dynamic_vino_lib/outputs/result_log_output.hpp"
+#include "dynamic_vino_lib/outputs/shared_memory_output.hpp"
+#include "dynamic_vino_lib/outputs/video_writer_output.hpp"
 #include "dynamic_vino_lib/pipeline.hpp"
 #include "dynamic_vino_lib/pipeline_manager.hpp"
 #include "dynamic_vino_lib/pipeline_params.hpp"
 #include "dynamic_vino_lib/services/pipeline_processing_server.hpp"
+#include "dynamic_vino_lib/engines/device_scheduler.hpp"
 #include "dynamic_vino_lib/engines/engine_manager.hpp"
+#include "dynamic_vino_lib/utils/opencl_preprocess.hpp"
+#include "dynamic_vino_lib/utils/process_memory.hpp"
+#include "dynamic_vino_lib/utils/simd_kernels.hpp"
+#include "dynamic_vino_lib/utils/thread_affinity.hpp"
+
 std::shared_ptr<Pipeline>
 PipelineManager::createPipeline(const Params::ParamManager::PipelineRawData & params,
   rclcpp::Node::SharedPtr node)
@@ -73,80 +96,281 @@ PipelineManager::createPipeline(const Params::ParamManager::PipelineRawData & pa
   if (params.name == "") {
     throw std::logic_error("The name of pipeline won't be empty!");
   }
+  auto cascades = getCascades(params);
+  auto pipeline = createPipeline(params, node, parseInference(params, cascades));
+  if (pipeline != nullptr) {
+    joinCascades(params.name, pipeline, cascades);
+  }
+  return pipeline;
+}
 
+std::vector<std::shared_ptr<Pipeline>>
+PipelineManager::createPipelines(
+  const std::vector<Params::ParamManager::PipelineRawData> & params,
+  rclcpp::Node::SharedPtr node)
+{
+  auto & common = Params::ParamManager::getInstance().getCommon();
+  if (battery_sub_ == nullptr && node != nullptr && !common.battery_topic.empty()) {
+    battery_sub_ = node->create_subscription<sensor_msgs::msg::BatteryState>(
+      common.battery_topic, rclcpp::SensorDataQoS(),
+      [this](const sensor_msgs::msg::BatteryState::SharedPtr msg) {
+        // NaN when the battery doesn't report its charge
+        battery_level_ = std::isnan(msg->percentage) ? -1.0f : msg->percentage;
+      });
+    slog::info << "Reading the battery level from " << common.battery_topic << slog::endl;
+  }
+  if (common.opencl_preprocess && !OpenCLPreprocess::isEnabled()) {
+    if (OpenCLPreprocess::enable()) {
+      slog::info << "Preprocessing on the OpenCL device " << OpenCLPreprocess::getDeviceName() <<
+        slog::endl;
+    } else {
+      slog::warn << "No OpenCL device, preprocessing on the CPU" << slog::endl;
+    }
+  }
+  std::vector<std::future<std::map<std::string,
+    std::shared_ptr<dynamic_vino_lib::BaseInference>>>> loading;
+  std::vector<std::set<std::string>> cascades;
+  for (auto & p : params) {
+    if (p.name == "") {
+      throw std::logic_error("The name of pipeline won't be empty!");
+    }
+    cascades.push_back(getCascades(p));
+    if (p.lazy) {
+      loading.emplace_back();
+      continue;
+    }
+    auto skipped = cascades.back();
+    loading.push_back(std::async(std::launch::async, [this, &p, skipped]() {
+        return parseInference(p, skipped);
+      }));
+  }
+  // wait until all the engines are ready before wiring any pipeline
+  std::vector<std::map<std::string, std::shared_ptr<dynamic_vino_lib::BaseInference>>> infers;
+  for (auto & future : loading) {
+    infers.push_back(future.valid() ? future.get() :
+      std::map<std::string, std::shared_ptr<dynamic_vino_lib::BaseInference>>());
+  }
+
+  std::vector<std::shared_ptr<Pipeline>> pipelines;
+  for (size_t i = 0; i < params.size(); i++) {
+    if (params[i].lazy) {
+      // registered paused, created by the first RUN_PIPELINE
+      PipelineData data;
+      data.parent_node = node;
+      data.params = params[i];
+      data.state = PipelineState_ThreadPasued;
+      pipelines_.insert({params[i].name, data});
+      slog::info << "Pipeline " << params[i].name << " is registered, it is loaded by the " <<
+        "first RUN_PIPELINE" << slog::endl;
+      pipelines.push_back(nullptr);
+      continue;
+    }
+    pipelines.push_back(createPipeline(params[i], node, infers[i]));
+    if (pipelines.back() != nullptr) {
+      joinCascades(params[i].name, pipelines.back(), cascades[i]);
+    }
+  }
+  return pipelines;
+}
+
+std::shared_ptr<Pipeline>
+PipelineManager::createPipeline(const Params::ParamManager::PipelineRawData & params,
+  rclcpp::Node::SharedPtr node,
+  const std::map<std::string, std::shared_ptr<dynamic_vino_lib::BaseInference>> & infers)
+{
+  auto log_level = Params::ParamManager::getInstance().getCommon().log_level;
+  if (!slog::setLevel(log_level)) {
+    slog::warn << "Unknown log_level " << log_level << ", keeping the current one." << slog::endl;
+  }
+  getCpuIsa();  // logs the SIMD kernels picked for this CPU, once
   std::shared_ptr<Pipeline> pipeline = std::make_shared<Pipeline>(params.name);
   pipeline->getParameters()->update(params);
+  // the threads of the inputs and outputs inherit the CPUs of the pipeline
+  ScopedThreadAffinity affinity(pipeline->getParameters()->getAffinityCpus());
 
   PipelineData data;
   data.parent_node = node;
   data.pipeline = pipeline;
   data.params = params;
   data.state = PipelineState_ThreadNotCreated;
+  // the same variants as parseInference, reloaded by the model updates
+  for (auto & infer : data.params.infers) {
+    selectVariant(infer);
+  }
 
   auto inputs = parseInputDevice(data);
-  if (inputs.size() != 1) {
-    slog::err << "currently one pipeline only supports ONE input." << slog::endl;
+  if (inputs.empty()) {
+    slog::err << "No valid input device for pipeline " << params.name << slog::endl;
     return nullptr;
   }
-  for (auto it = inputs.begin(); it != inputs.end(); ++it) {
+  // keep the order of the configuration, the first input serves as the default one
+  std::vector<std::string> input_names;
+  /**< the configured input of each input name, differs for the lanes of a device >**/
+  std::map<std::string, std::string> configured_inputs;
+  /**< the results of the lanes of a segmented video, merged back into its order >**/
+  std::map<std::string, std::shared_ptr<Outputs::FrameResultsMerge>> merges;
+  for (auto & name : params.inputs) {
+    auto it = inputs.find(name);
+    if (it == inputs.end() || configured_inputs.count(name) > 0) {
+      continue;
+    }
+    input_names.push_back(name);
+    configured_inputs[name] = name;
     pipeline->add(it->first, it->second);
     auto node = it->second->getHandler();
     if (node != nullptr) {
       data.spin_nodes.emplace_back(node);
     }
+    // a device read several frames at a time is added once per lane, the lanes
+    // are read in lock-step so that their frames share the first-stage batch
+    size_t lanes = it->second->getLanes();
+    if (lanes > 1 && std::dynamic_pointer_cast<Input::Video>(it->second) != nullptr) {
+      merges[name] = std::make_shared<Outputs::FrameResultsMerge>();
+    }
+    for (size_t lane = 1; lane < lanes; lane++) {
+      auto lane_name = name + "#" + std::to_string(lane);
+      input_names.push_back(lane_name);
+      configured_inputs[lane_name] = name;
+      pipeline->add(lane_name, it->second);
+    }
   }
 
-  auto outputs = parseOutput(data);
-  for (auto it = outputs.begin(); it != outputs.end(); ++it) {
-    pipeline->add(it->first, it->second);
+  if (input_names.size() == 1) {
+    auto outputs = parseOutput(data);
+    for (auto it = outputs.begin(); it != outputs.end(); ++it) {
+      pipeline->add(it->first, it->second);
+    }
+  } else {
+    // each input gets its own output instances, named after the pipeline and the input
+    bool single_device = inputs.size() == 1;
+    for (size_t i = 0; i < input_names.size(); i++) {
+      auto merge = merges.find(configured_inputs[input_names[i]]);
+      auto outputs = parseOutput(data, single_device ? params.name :
+          params.name + "_" + configured_inputs[input_names[i]],
+          merge == merges.end() ? nullptr : merge->second);
+      for (auto it = outputs.begin(); it != outputs.end(); ++it) {
+        if (i == 0) {
+          pipeline->add(it->first, it->second);
+        } else {
+          pipeline->addOutputForInput(input_names[i], it->first, it->second);
+        }
+      }
+    }
   }
 
-  auto infers = parseInference(params);
   for (auto it = infers.begin(); it != infers.end(); ++it) {
     pipeline->add(it->first, it->second);
   }
+  // the requests of the pipeline share each device with the other pipelines
+  Engines::DeviceScheduler::setClientWeight(params.name, params.priority);
+  for (auto & infer : params.infers) {
+    auto it = infers.find(infer.name);
+    if (it != infers.end() && it->second->getEngine() != nullptr) {
+      it->second->getEngine()->setScheduler(params.name);
+    }
+  }
 
+  // the inferences not loaded, e.g. the cascades joining later, are connected once they join
+  std::set<std::string> missing;
+  for (auto & infer : params.infers) {
+    if (infers.count(infer.name) == 0) {
+      missing.insert(infer.name);
+    }
+  }
   slog::info << "Updating connections ..." << slog::endl;
   for (auto it = params.connects.begin(); it != params.connects.end(); ++it) {
+    if (missing.count(it->first) > 0 || missing.count(it->second) > 0) {
+      continue;
+    }
     pipeline->add(it->first, it->second);
+    for (auto & lane : configured_inputs) {
+      if (lane.second == it->first && lane.first != lane.second) {
+        pipeline->add(lane.first, it->second);
+      }
+    }
   }
 
   // slog::info << "Updateing filters ..." << slog::endl;
   // pipeline->addFilters(params.filters);
 
-  pipelines_.insert({params.name, data});
+  auto registered = pipelines_.find(params.name);
+  if (registered != pipelines_.end() && registered->second.pipeline == nullptr) {
+    // a lazy or unloaded pipeline, loaded by loadPipeline
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    registered->second.pipeline = pipeline;
+    registered->second.spin_nodes = data.spin_nodes;
+  } else {
+    pipelines_.insert({params.name, data});
+  }
 
   pipeline->setCallback();
   slog::info << "One Pipeline Created!" << slog::endl;
   pipeline->printPipeline();
+  logMemoryUsage(params.name, *pipeline);
   return pipeline;
 }
 
+void PipelineManager::logMemoryUsage(const std::string & name, Pipeline & pipeline)
+{
+  uint64_t total = 0;
+  slog::info << "Memory of pipeline " << name << ":" << slog::endl;
+  for (auto & usage : pipeline.getMemoryUsage()) {
+    if (usage.second == 0) {
+      continue;
+    }
+    slog::info << "\t" << usage.first << ": " << formatBytes(usage.second) << slog::endl;
+    total += usage.second;
+  }
+  slog::info << "\ttotal: " << formatBytes(total) << ", process resident: " <<
+    formatBytes(readProcessMemory("VmRSS")) << slog::endl;
+}
+
 std::map<std::string, std::shared_ptr<Input::BaseInputDevice>>
 PipelineManager::parseInputDevice(const PipelineData & pdata)
 {
   std::map<std::string, std::shared_ptr<Input::BaseInputDevice>> inputs;
   for (auto & name : pdata.params.inputs) {
     slog::info << "Parsing InputDvice: " << name << slog::endl;
+    if (inputs.find(name) != inputs.end()) {
+      continue;
+    }
+    const std::string type = PipelineParams::getInputType(name);
+    const std::string & meta = pdata.pipeline->getParameters()->getInputMeta(name);
     std::shared_ptr<Input::BaseInputDevice> device = nullptr;
-    if (name == kInputType_RealSenseCamera) {
-      device = std::make_shared<Input::RealSenseCamera>();
-    } else if (name == kInputType_StandardCamera) {
-      device = std::make_shared<Input::StandardCamera>();
-    } else if (name == kInputType_IpCamera) {
-      if (pdata.params.input_meta != "") {
-        device = std::make_shared<Input::IpCamera>(pdata.params.input_meta);
-      }
-    } else if (name == kInputType_CameraTopic || name == kInputType_ImageTopic) {
-      device = std::make_shared<Input::RealSenseCameraTopic>(pdata.parent_node);
-    } else if (name == kInputType_Video) {
-      if (pdata.params.input_meta != "") {
-        device = std::make_shared<Input::Video>(pdata.params.input_meta);
-      }
-    } else if (name == kInputType_Image) {
-      if (pdata.params.input_meta != "") {
-        device = std::make_shared<Input::Image>(pdata.params.input_meta);
+    if (type == kInputType_RealSenseCamera) {
+      device = std::make_shared<Input::RealSenseCamera>(meta);
+    } else if (type == kInputType_StandardCamera) {
+      device = std::make_shared<Input::StandardCamera>(meta);
+    } else if (type == kInputType_IpCamera) {
+      if (meta != "") {
+        device = std::make_shared<Input::IpCamera>(meta);
+      }
+    } else if (type == kInputType_CameraTopic || type == kInputType_ImageTopic) {
+      device = std::make_shared<Input::RealSenseCameraTopic>(pdata.parent_node, meta);
+    } else if (type == kInputType_Video) {
+      if (meta != "") {
+        device = std::make_shared<Input::Video>(meta);
+      }
+    } else if (type == kInputType_Image) {
+      if (meta != "") {
+        device = std::make_shared<Input::Image>(meta);
+      }
+    } else if (type == kInputType_ImageDirectory) {
+      if (meta != "") {
+        device = std::make_shared<Input::ImageDirectory>(meta);
+      }
+    } else if (type == kInputType_FrameReplay) {
+      if (meta != "") {
+        device = std::make_shared<Input::FrameReplay>(meta);
       }
+    } else if (type == kInputType_GStreamer) {
+#ifdef DYNAMIC_VINO_LIB_GSTREAMER
+      if (meta != "") {
+        device = std::make_shared<Input::GStreamerInput>(meta);
+      }
+#else
+      slog::err << "Built without the GStreamer input (DYNAMIC_VINO_LIB_GSTREAMER)" << slog::endl;
+#endif
     } else {
       slog::err << "Invalid input device name: " << name << slog::endl;
     }
@@ -163,23 +387,82 @@ PipelineManager::parseInputDevice(const PipelineData & pdata)
 
 
 std::map<std::string, std::shared_ptr<Outputs::BaseOutput>>
-PipelineManager::parseOutput(const PipelineData & pdata)
+PipelineManager::parseOutput(
+  const PipelineData & pdata, const std::string & output_name,
+  std::shared_ptr<Outputs::FrameResultsMerge> merge)
 {
   std::map<std::string, std::shared_ptr<Outputs::BaseOutput>> outputs;
+  const std::string name_prefix = output_name.empty() ? pdata.params.name : output_name;
   for (auto & name : pdata.params.outputs) {
     slog::info << "Parsing Output: " << name << slog::endl;
     std::shared_ptr<Outputs::BaseOutput> object = nullptr;
     if (name == kOutputTpye_RosTopic) {
-      object = std::make_shared<Outputs::RosTopicOutput>(pdata.params.name, pdata.parent_node);
+      auto topic = std::make_shared<Outputs::RosTopicOutput>(name_prefix, pdata.parent_node);
+      // "RosTopic/faces" limits the "faces" topic only
+      for (auto & rate : pdata.params.output_rates) {
+        if (rate.first.compare(0, name.size() + 1, name + "/") == 0) {
+          topic->setTopicRate(rate.first.substr(name.size() + 1),
+            Outputs::OutputRate::parse(rate.second));
+        }
+      }
+      topic->setMaskEncoding(pdata.params.mask_encoding, pdata.params.mask_keyframe_interval);
+      topic->setLatencyTopic(pdata.params.latency_topic);
+      object = topic;
     } else if (name == kOutputTpye_ImageWindow) {
-      object = std::make_shared<Outputs::ImageWindowOutput>(pdata.params.name);
+      auto window = std::make_shared<Outputs::ImageWindowOutput>(name_prefix);
+      window->setPreviewScale(pdata.params.preview_scale);
+      object = window;
     } else if (name == kOutputTpye_RViz) {
-      object = std::make_shared<Outputs::RvizOutput>(pdata.params.name, pdata.parent_node);
+      auto rviz = std::make_shared<Outputs::RvizOutput>(name_prefix, pdata.parent_node);
+      rviz->setImageEncoding(pdata.params.image_transport, pdata.params.image_quality,
+        pdata.params.image_scale, pdata.params.image_rate);
+      object = rviz;
     } else if (name == kOutputTpye_RosService) {
-      object = std::make_shared<Outputs::RosServiceOutput>(pdata.params.name);
+      object = std::make_shared<Outputs::RosServiceOutput>(name_prefix);
+    } else if (name == kOutputTpye_VideoWriter) {
+      auto video = std::make_shared<Outputs::VideoWriterOutput>(name_prefix);
+      video->setRecording(pdata.params.video_directory, pdata.params.video_fps,
+        pdata.params.video_segment, pdata.params.video_annotated,
+        pdata.params.video_trigger, pdata.params.video_hold);
+      video->setPreviewScale(pdata.params.preview_scale);
+      object = video;
+    } else if (name == kOutputTpye_RosAggregate) {
+      auto aggregate = std::make_shared<Outputs::RosAggregateOutput>(
+        name_prefix, pdata.parent_node, pdata.params.aggregate_frames);
+      aggregate->setMaskEncoding(pdata.params.mask_encoding, pdata.params.mask_keyframe_interval);
+      aggregate->setLatencyTopic(pdata.params.latency_topic);
+      if (merge != nullptr) {
+        aggregate->setMerge(merge);
+      }
+      object = aggregate;
+    } else if (name == kOutputTpye_SharedMemory) {
+      object = std::make_shared<Outputs::SharedMemoryOutput>(name_prefix,
+        pdata.params.shm_slots, pdata.params.shm_max_objects, pdata.params.shm_frames);
+    } else if (name == kOutputTpye_ResultLog) {
+      auto log = std::make_shared<Outputs::ResultLogOutput>(name_prefix);
+      log->setLogging(pdata.params.result_log_directory, pdata.params.result_log_batch,
+        pdata.params.result_log_flush);
+      object = log;
     } else {
       slog::err << "Invalid output name: " << name << slog::endl;
     }
+    // a service answers from the results of its request, it stays synchronous,
+    // and the video writer and the result log already write on their own thread
+    int output_queue = pdata.params.output_queue;
+    if (name == kOutputTpye_RViz) {
+      // the overlay is drawn and converted off the pipeline thread anyway
+      output_queue = std::max(output_queue, 1);
+    }
+    if (object != nullptr && output_queue > 0 &&
+      name != kOutputTpye_RosService && name != kOutputTpye_VideoWriter &&
+      name != kOutputTpye_ResultLog)
+    {
+      object = std::make_shared<Outputs::AsyncOutput>(name_prefix, object, output_queue);
+    }
+    auto rate = pdata.params.output_rates.find(name);
+    if (object != nullptr && rate != pdata.params.output_rates.end()) {
+      object->setRate(Outputs::OutputRate::parse(rate->second));
+    }
     if (object != nullptr) {
       outputs.insert({name, object});
       slog::info << " ... Adding one Output: " << name << slog::endl;
@@ -189,54 +472,206 @@ PipelineManager::parseOutput(const PipelineData & pdata)
   return outputs;
 }
 
+void PipelineManager::addAffinityHints(
+  const Params::ParamManager::PipelineRawData & params, const std::vector<int> & cpus,
+  Params::ParamManager::InferenceRawData & infer)
+{
+  if (infer.engine != "CPU" || cpus.empty()) {
+    return;
+  }
+  // the plugin threads stay on the CPUs of the pipeline, unless configured otherwise
+  if (infer.config.count(InferenceEngine::PluginConfigParams::KEY_CPU_BIND_THREAD) == 0) {
+    infer.config[InferenceEngine::PluginConfigParams::KEY_CPU_BIND_THREAD] =
+      params.numa_node >= 0 ? InferenceEngine::PluginConfigParams::NUMA :
+      InferenceEngine::PluginConfigParams::YES;
+  }
+  if (infer.config.count(InferenceEngine::PluginConfigParams::KEY_CPU_THREADS_NUM) == 0) {
+    infer.config[InferenceEngine::PluginConfigParams::KEY_CPU_THREADS_NUM] =
+      std::to_string(cpus.size());
+  }
+  // no more streams than CPUs for the requests
+  auto streams = infer.config.find(InferenceEngine::PluginConfigParams::KEY_CPU_THROUGHPUT_STREAMS);
+  if (streams != infer.config.end() &&
+    streams->second == InferenceEngine::PluginConfigParams::CPU_THROUGHPUT_AUTO)
+  {
+    streams->second = std::to_string(std::max<size_t>(1, std::min<size_t>(
+        cpus.size(), std::max(1, infer.infer_requests))));
+  }
+}
+
 std::map<std::string, std::shared_ptr<dynamic_vino_lib::BaseInference>>
-PipelineManager::parseInference(const Params::ParamManager::PipelineRawData & params)
+PipelineManager::parseInference(
+  const Params::ParamManager::PipelineRawData & params, const std::set<std::string> & skipped)
 {
-  std::map<std::string, std::shared_ptr<dynamic_vino_lib::BaseInference>> inferences;
-  for (auto & infer : params.infers) {
-    if (infer.name.empty() || infer.model.empty()) {
+  // networks are independent from each other, read and load them concurrently
+  std::vector<std::pair<std::string,
+    std::future<std::shared_ptr<dynamic_vino_lib::BaseInference>>>> loading;
+  auto cpus = PipelineParams(params).getAffinityCpus();
+  ScopedThreadAffinity affinity(cpus);
+  auto infers = params.infers;
+  for (auto & infer : infers) {
+    selectVariant(infer);
+    addAffinityHints(params, cpus, infer);
+  }
+  for (auto & infer : infers) {
+    if (infer.name.empty() || infer.model.empty() || skipped.count(infer.name) > 0) {
       continue;
     }
     slog::info << "Parsing Inference: " << infer.name << slog::endl;
-    std::shared_ptr<dynamic_vino_lib::BaseInference> object = nullptr;
-
-    if (infer.name == kInferTpye_FaceDetection) {
-      object = createFaceDetection(infer);
-    } else if (infer.name == kInferTpye_AgeGenderRecognition) {
-      object = createAgeGenderRecognition(infer);
-    } else if (infer.name == kInferTpye_EmotionRecognition) {
-      object = createEmotionRecognition(infer);
-    } else if (infer.name == kInferTpye_HeadPoseEstimation) {
-      object = createHeadPoseEstimation(infer);
-    } else if (infer.name == kInferTpye_ObjectDetection) {
-      object = createObjectDetection(infer);
-    } else if (infer.name == kInferTpye_ObjectSegmentation) {
-      object = createObjectSegmentation(infer);
-    } else if (infer.name == kInferTpye_PersonReidentification) {
-      object = createPersonReidentification(infer);
-    } else if (infer.name == kInferTpye_PersonAttribsDetection) {
-      object = createPersonAttribsDetection(infer);
-    } /*else if (infer.name == kInferTpye_LandmarksDetection) {
-      object = createLandmarksDetection(infer);
-    } else if (infer.name == kInferTpye_FaceReidentification) {
-      object = createFaceReidentification(infer);
-    } */ else if (infer.name == kInferTpye_VehicleAttribsDetection) {
-      object = createVehicleAttribsDetection(infer);
-    } else if (infer.name == kInferTpye_LicensePlateDetection) {
-      object = createLicensePlateDetection(infer);
-    }else {
-      slog::err << "Invalid inference name: " << infer.name << slog::endl;
-    }
+    loading.emplace_back(infer.name, std::async(std::launch::async, [this, &infer]() {
+        return createInference(infer);
+      }));
+  }
 
+  std::map<std::string, std::shared_ptr<dynamic_vino_lib::BaseInference>> inferences;
+  for (auto & pair : loading) {
+    auto object = pair.second.get();
     if (object != nullptr) {
-      inferences.insert({infer.name, object});
-      slog::info << " ... Adding one Inference: " << infer.name << slog::endl;
+      inferences.insert({pair.first, object});
+      slog::info << " ... Adding one Inference: " << pair.first << slog::endl;
     }
   }
 
   return inferences;
 }
 
+std::set<std::string>
+PipelineManager::getCascades(const Params::ParamManager::PipelineRawData & params)
+{
+  std::set<std::string> cascades;
+  if (!params.staged_startup) {
+    return cascades;
+  }
+  std::set<std::string> first_stage;
+  for (auto & input : params.inputs) {
+    auto range = params.connects.equal_range(input);
+    for (auto it = range.first; it != range.second; ++it) {
+      first_stage.insert(it->second);
+    }
+  }
+  for (auto & infer : params.infers) {
+    if (first_stage.count(infer.name) == 0) {
+      cascades.insert(infer.name);
+    }
+  }
+  if (cascades.size() == params.infers.size()) {
+    // no inference is connected from an input, nothing to start with
+    cascades.clear();
+  }
+  return cascades;
+}
+
+void PipelineManager::joinCascades(
+  const std::string & name, std::shared_ptr<Pipeline> pipeline,
+  const std::set<std::string> & cascades)
+{
+  if (cascades.empty()) {
+    return;
+  }
+  auto & data = pipelines_[name];
+  slog::info << "Pipeline " << name << " starts with its first-stage inferences, " <<
+    cascades.size() << " cascades join once loaded" << slog::endl;
+  auto cpus = PipelineParams(data.params).getAffinityCpus();
+  for (auto infer : data.params.infers) {
+    if (cascades.count(infer.name) == 0 || infer.model.empty()) {
+      continue;
+    }
+    selectVariant(infer);
+    addAffinityHints(data.params, cpus, infer);
+    // connected from its parents, and to its children but the other cascades,
+    // whose own connections name it
+    std::vector<std::pair<std::string, std::string>> connects;
+    for (auto & connect : data.params.connects) {
+      if (connect.second == infer.name ||
+        (connect.first == infer.name && cascades.count(connect.second) == 0))
+      {
+        connects.push_back(connect);
+      }
+    }
+    data.joining.push_back(std::async(std::launch::async,
+      [this, pipeline, infer, connects, name, cpus]() {
+        setThreadAffinity(cpus);
+        slog::info << "Loading the cascade " << name << "/" << infer.name << slog::endl;
+        std::shared_ptr<dynamic_vino_lib::BaseInference> object;
+        try {
+          object = createInference(infer);
+        } catch (const std::exception & e) {
+          slog::err << "Failed to load " << infer.model << ": " << e.what() << slog::endl;
+        }
+        if (object == nullptr) {
+          slog::err << name << "/" << infer.name << " stays out of the pipeline" << slog::endl;
+          return;
+        }
+        if (object->getEngine() != nullptr) {
+          object->getEngine()->setScheduler(name);
+        }
+        pipeline->joinInference(infer.name, object, connects);
+      }).share());
+  }
+}
+
+std::shared_ptr<dynamic_vino_lib::BaseInference>
+PipelineManager::createInference(const Params::ParamManager::InferenceRawData & infer)
+{
+  std::shared_ptr<dynamic_vino_lib::BaseInference> object = nullptr;
+
+  if (infer.name == kInferTpye_FaceDetection) {
+    object = createFaceDetection(infer);
+  } else if (infer.name == kInferTpye_AgeGenderRecognition) {
+    object = createAgeGenderRecognition(infer);
+  } else if (infer.name == kInferTpye_EmotionRecognition) {
+    object = createEmotionRecognition(infer);
+  } else if (infer.name == kInferTpye_HeadPoseEstimation) {
+    object = createHeadPoseEstimation(infer);
+  } else if (infer.name == kInferTpye_ObjectDetection) {
+    object = createObjectDetection(infer);
+  } else if (infer.name == kInferTpye_ObjectSegmentation) {
+    object = createObjectSegmentation(infer);
+  } else if (infer.name == kInferTpye_PersonReidentification) {
+    object = createPersonReidentification(infer);
+  } else if (infer.name == kInferTpye_PersonAttribsDetection) {
+    object = createPersonAttribsDetection(infer);
+  } else if (infer.name == kInferTpye_LandmarksDetection) {
+    object = createLandmarksDetection(infer);
+  } else if (infer.name == kInferTpye_FaceReidentification) {
+    object = createFaceReidentification(infer);
+  } else if (infer.name == kInferTpye_VehicleAttribsDetection) {
+    object = createVehicleAttribsDetection(infer);
+  } else if (infer.name == kInferTpye_LicensePlateDetection) {
+    object = createLicensePlateDetection(infer);
+  }else {
+    slog::err << "Invalid inference name: " << infer.name << slog::endl;
+  }
+
+  if (object != nullptr && infer.cache_interval > 1) {
+    dynamic_vino_lib::ResultCachePolicy policy;
+    policy.refresh_interval = infer.cache_interval;
+    policy.min_iou = infer.cache_iou;
+    policy.min_confidence = infer.cache_confidence;
+    object->setResultCachePolicy(policy);
+  }
+  if (object != nullptr) {
+    dynamic_vino_lib::RoiGatePolicy gate;
+    gate.min_area = infer.min_roi_area;
+    gate.min_aspect = infer.min_roi_aspect;
+    gate.max_aspect = infer.max_roi_aspect;
+    gate.min_confidence = infer.min_roi_confidence;
+    gate.min_track_age = infer.min_track_age;
+    gate.max_rois = infer.max_rois;
+    gate.by_confidence = infer.roi_priority == "confidence";
+    object->setRoiGatePolicy(gate);
+    dynamic_vino_lib::RoiMergePolicy merge;
+    merge.iou = infer.roi_merge_iou;
+    merge.padding = infer.roi_padding;
+    merge.shift = infer.roi_fit == "shift";
+    object->setRoiMergePolicy(merge);
+    object->setPriority(infer.priority);
+    object->setBatchWait(infer.batch_wait);
+    object->setExecutionRate(infer.every_n_frames, infer.max_hz);
+  }
+  return object;
+}
+
 
 std::shared_ptr<dynamic_vino_lib::BaseInference>
 PipelineManager::createFaceDetection(
@@ -250,7 +685,7 @@ PipelineManager::createAgeGenderRecognition(const Params::ParamManager::Inferenc
 {
   auto model = std::make_shared<Models::AgeGenderDetectionModel>(param.model, param.batch);
   model->modelInit();
-  auto engine = engine_manager_.createEngine(param.engine, model);
+  auto engine = engine_manager_.createEngine(param, model);
   auto infer = std::make_shared<dynamic_vino_lib::AgeGenderDetection>();
   infer->loadNetwork(model);
   infer->loadEngine(engine);
@@ -263,7 +698,7 @@ PipelineManager::createEmotionRecognition(const Params::ParamManager::InferenceR
 {
   auto model = std::make_shared<Models::EmotionDetectionModel>(param.model, param.batch);
   model->modelInit();
-  auto engine = engine_manager_.createEngine(param.engine, model);
+  auto engine = engine_manager_.createEngine(param, model);
   auto infer = std::make_shared<dynamic_vino_lib::EmotionsDetection>();
   infer->loadNetwork(model);
   infer->loadEngine(engine);
@@ -276,7 +711,7 @@ PipelineManager::createHeadPoseEstimation(const Params::ParamManager::InferenceR
 {
   auto model = std::make_shared<Models::HeadPoseDetectionModel>(param.model, param.batch);
   model->modelInit();
-  auto engine = engine_manager_.createEngine(param.engine, model);
+  auto engine = engine_manager_.createEngine(param, model);
   auto infer = std::make_shared<dynamic_vino_lib::HeadPoseDetection>();
   infer->loadNetwork(model);
   infer->loadEngine(engine);
@@ -291,27 +726,45 @@ PipelineManager::createObjectDetection(
 {
   std::shared_ptr<Models::ObjectDetectionModel> object_detection_model;
   std::shared_ptr<dynamic_vino_lib::ObjectDetection> object_inference_ptr;
-  slog::debug << "for test in createObjectDetection()" << slog::endl;
+  SLOG_DEBUG << "for test in createObjectDetection()" << slog::endl;
   if (infer.model_type == kInferTpye_ObjectDetectionTypeSSD) {
-    object_detection_model =
-      std::make_shared<Models::ObjectDetectionSSDModel>(infer.model, infer.batch);
+    auto ssd_model = std::make_shared<Models::ObjectDetectionSSDModel>(infer.model, infer.batch);
+    // "auto" is reshaped by checkInferences, once the size of the frames is known
+    if (infer.input_shape != "auto") {
+      ssd_model->setInputShape(infer.input_shape);
+    }
+    object_detection_model = ssd_model;
   }
   if (infer.model_type == kInferTpye_ObjectDetectionTypeYolov2) {
     object_detection_model =
       std::make_shared<Models::ObjectDetectionYolov2Model>(infer.model, infer.batch);
   }
+  if (infer.model_type == kInferTpye_ObjectDetectionTypeYolov3) {
+    object_detection_model =
+      std::make_shared<Models::ObjectDetectionYolov3Model>(infer.model, infer.batch);
+  }
 
-  slog::debug << "for test in createObjectDetection(), Created SSDModel" << slog::endl;
+  SLOG_DEBUG << "for test in createObjectDetection(), Created SSDModel" << slog::endl;
   object_inference_ptr = std::make_shared<dynamic_vino_lib::ObjectDetection>(
     infer.enable_roi_constraint, infer.confidence_threshold);  // To-do theshold configuration
-  slog::debug << "for test in createObjectDetection(), before modelInit()" << slog::endl;
+  SLOG_DEBUG << "for test in createObjectDetection(), before modelInit()" << slog::endl;
+  object_detection_model->setNms(infer.nms_threshold, infer.top_k);
   object_detection_model->modelInit();
-  auto object_detection_engine = engine_manager_.createEngine(
-    infer.engine, object_detection_model);
-  slog::debug << "for test in createObjectDetection(), before loadNetwork" << slog::endl;
+  auto object_detection_engine = engine_manager_.createEngine(infer, object_detection_model);
+  SLOG_DEBUG << "for test in createObjectDetection(), before loadNetwork" << slog::endl;
   object_inference_ptr->loadNetwork(object_detection_model);
   object_inference_ptr->loadEngine(object_detection_engine);
-  slog::debug << "for test in createObjectDetection(), OK" << slog::endl;
+  if (infer.tracker == "sort") {
+    object_inference_ptr->enableTracking(infer.detect_interval, infer.track_iou,
+      infer.optical_flow);
+  } else if (infer.tracker != "none") {
+    slog::warn << "Unknown tracker " << infer.tracker << ", detections are not tracked." <<
+      slog::endl;
+  }
+  if (infer.tile_size > 0) {
+    object_inference_ptr->enableTiling(infer.tile_size, infer.tile_overlap, infer.nms_threshold);
+  }
+  SLOG_DEBUG << "for test in createObjectDetection(), OK" << slog::endl;
   return object_inference_ptr;
 }
 
@@ -322,11 +775,12 @@ PipelineManager::createObjectSegmentation(const Params::ParamManager::InferenceR
     std::make_shared<Models::ObjectSegmentationModel>(infer.model, infer.batch);
   model->modelInit();
   slog::info << "Segmentation model initialized." << slog::endl;
-  auto engine = engine_manager_.createEngine(infer.engine, model);
+  auto engine = engine_manager_.createEngine(infer, model);
   slog::info << "Segmentation Engine initialized." << slog::endl;
   auto segmentation_inference_ptr = std::make_shared<dynamic_vino_lib::ObjectSegmentation>(
     infer.confidence_threshold);
     slog::info << "Segmentation Inference instanced." << slog::endl;
+  segmentation_inference_ptr->setColorizeMask(infer.mask_type != "class_id");
   segmentation_inference_ptr->loadNetwork(model);
   segmentation_inference_ptr->loadEngine(engine);
 
@@ -339,22 +793,62 @@ PipelineManager::createPersonReidentification(
 {
   std::shared_ptr<Models::PersonReidentificationModel> person_reidentification_model;
   std::shared_ptr<dynamic_vino_lib::PersonReidentification> reidentification_inference_ptr;
-  slog::debug << "for test in createPersonReidentification()"<<slog::endl;
+  SLOG_DEBUG << "for test in createPersonReidentification()"<<slog::endl;
   person_reidentification_model =
     std::make_shared<Models::PersonReidentificationModel>(infer.model, infer.batch);
   person_reidentification_model->modelInit();
   slog::info << "Reidentification model initialized" << slog::endl;
-  auto person_reidentification_engine = engine_manager_.createEngine(infer.engine, person_reidentification_model);
-  reidentification_inference_ptr =
-    std::make_shared<dynamic_vino_lib::PersonReidentification>(infer.confidence_threshold);
-  slog::debug<< "for test in createPersonReidentification(), before loadNetwork"<<slog::endl;
+  auto person_reidentification_engine = engine_manager_.createEngine(infer, person_reidentification_model);
+  auto gallery_index = dynamic_vino_lib::createGalleryIndex(
+    infer.gallery_index, infer.gallery_lists, infer.gallery_probes, infer.gallery_precision);
+  reidentification_inference_ptr = std::make_shared<dynamic_vino_lib::PersonReidentification>(
+    infer.confidence_threshold, gallery_index, infer.gallery_size, infer.shared_gallery);
+  reidentification_inference_ptr->getTracker()->enableSnapshots(
+    infer.gallery_file, infer.gallery_snapshot_interval * 1000, infer.gallery_fp16);
+  SLOG_DEBUG << "for test in createPersonReidentification(), before loadNetwork"<<slog::endl;
   reidentification_inference_ptr->loadNetwork(person_reidentification_model);
   reidentification_inference_ptr->loadEngine(person_reidentification_engine);
-  slog::debug<< "for test in createPersonReidentification(), OK"<<slog::endl;
+  SLOG_DEBUG << "for test in createPersonReidentification(), OK"<<slog::endl;
 
   return reidentification_inference_ptr;
 }
 
+std::shared_ptr<dynamic_vino_lib::BaseInference>
+PipelineManager::createLandmarksDetection(
+  const Params::ParamManager::InferenceRawData & infer)
+{
+  auto model =
+    std::make_shared<Models::LandmarksDetectionModel>(infer.model, infer.batch);
+  model->modelInit();
+  auto engine = engine_manager_.createEngine(infer, model);
+  auto landmarks_inference_ptr =
+    std::make_shared<dynamic_vino_lib::LandmarksDetection>();
+  landmarks_inference_ptr->loadNetwork(model);
+  landmarks_inference_ptr->loadEngine(engine);
+
+  return landmarks_inference_ptr;
+}
+
+std::shared_ptr<dynamic_vino_lib::BaseInference>
+PipelineManager::createFaceReidentification(
+  const Params::ParamManager::InferenceRawData & infer)
+{
+  auto model =
+    std::make_shared<Models::FaceReidentificationModel>(infer.model, infer.batch);
+  model->modelInit();
+  auto engine = engine_manager_.createEngine(infer, model);
+  auto gallery_index = dynamic_vino_lib::createGalleryIndex(
+    infer.gallery_index, infer.gallery_lists, infer.gallery_probes, infer.gallery_precision);
+  auto face_reid_ptr = std::make_shared<dynamic_vino_lib::FaceReidentification>(
+    infer.confidence_threshold, gallery_index, infer.gallery_size, infer.shared_gallery);
+  face_reid_ptr->getTracker()->enableSnapshots(
+    infer.gallery_file, infer.gallery_snapshot_interval * 1000, infer.gallery_fp16);
+  face_reid_ptr->loadNetwork(model);
+  face_reid_ptr->loadEngine(engine);
+
+  return face_reid_ptr;
+}
+
 std::shared_ptr<dynamic_vino_lib::BaseInference>
 PipelineManager::createVehicleAttribsDetection(
   const Params::ParamManager::InferenceRawData & infer)
@@ -362,7 +856,7 @@ PipelineManager::createVehicleAttribsDetection(
   auto model =
     std::make_shared<Models::VehicleAttribsDetectionModel>(infer.model, infer.batch);
   model->modelInit();
-  auto engine = engine_manager_.createEngine(infer.engine, model);
+  auto engine = engine_manager_.createEngine(infer, model);
   auto vehicle_attribs_ptr =
     std::make_shared<dynamic_vino_lib::VehicleAttribsDetection>();
   vehicle_attribs_ptr->loadNetwork(model);
@@ -378,7 +872,7 @@ PipelineManager::createLicensePlateDetection(
   auto model =
     std::make_shared<Models::LicensePlateDetectionModel>(infer.model, infer.batch);
   model->modelInit();
-  auto engine = engine_manager_.createEngine(infer.engine, model);
+  auto engine = engine_manager_.createEngine(infer, model);
   auto license_plate_ptr =
     std::make_shared<dynamic_vino_lib::LicensePlateDetection>();
   license_plate_ptr->loadNetwork(model);
@@ -393,9 +887,9 @@ PipelineManager::createPersonAttribsDetection(
 {
   auto model =
     std::make_shared<Models::PersonAttribsDetectionModel>(infer.model, infer.batch);
-  slog::debug << "for test in createPersonAttributesDetection()"<<slog::endl;
+  SLOG_DEBUG << "for test in createPersonAttributesDetection()"<<slog::endl;
   model->modelInit();
-  auto engine = engine_manager_.createEngine(infer.engine, model);
+  auto engine = engine_manager_.createEngine(infer, model);
   auto attribs_inference_ptr =
     std::make_shared<dynamic_vino_lib::PersonAttribsDetection>(infer.confidence_threshold);
   attribs_inference_ptr->loadNetwork(model);
@@ -412,7 +906,7 @@ PipelineManager::createPersonReidentification(
   auto model =
     std::make_shared<Models::PersonReidentificationModel>(infer.model, infer.batch);
   model->modelInit();
-  auto engine = engine_manager_.createEngine(infer.engine, model);
+  auto engine = engine_manager_.createEngine(infer, model);
   auto reidentification_inference_ptr =
     std::make_shared<dynamic_vino_lib::PersonReidentification>(infer.confidence_threshold);
   reidentification_inference_ptr->loadNetwork(model);
@@ -429,7 +923,7 @@ PipelineManager::createPersonAttribsDetection(
     std::make_shared<Models::PersonAttribsDetectionModel>(infer.model, infer.batch);
   
   model->modelInit();
-  auto engine = engine_manager_.createEngine(infer.engine, model);
+  auto engine = engine_manager_.createEngine(infer, model);
   auto attribs_inference_ptr =
     std::make_shared<dynamic_vino_lib::PersonAttribsDetection>(infer.confidence_threshold);
   attribs_inference_ptr->loadNetwork(model);
@@ -438,38 +932,6 @@ PipelineManager::createPersonAttribsDetection(
   return attribs_inference_ptr;
 }
 
-std::shared_ptr<dynamic_vino_lib::BaseInference>
-PipelineManager::createLandmarksDetection(
-  const Params::ParamManager::InferenceRawData & infer)
-{
-  auto model =
-    std::make_shared<Models::LandmarksDetectionModel>(infer.model, infer.batch);
-  model->modelInit();
-  auto engine = engine_manager_.createEngine(infer.engine, model);
-  auto landmarks_inference_ptr =
-    std::make_shared<dynamic_vino_lib::LandmarksDetection>();
-  landmarks_inference_ptr->loadNetwork(model);
-  landmarks_inference_ptr->loadEngine(engine);
-
-  return landmarks_inference_ptr;
-}
-
-std::shared_ptr<dynamic_vino_lib::BaseInference>
-PipelineManager::createFaceReidentification(
-  const Params::ParamManager::InferenceRawData & infer)
-{
-  auto model =
-    std::make_shared<Models::FaceReidentificationModel>(infer.model, infer.batch);
-  model->modelInit();
-  auto engine = engine_manager_.createEngine(infer.engine, model);
-  auto face_reid_ptr =
-    std::make_shared<dynamic_vino_lib::FaceReidentification>(infer.confidence_threshold);
-  face_reid_ptr->loadNetwork(model);
-  face_reid_ptr->loadEngine(engine);
-
-  return face_reid_ptr;
-}
-
 std::shared_ptr<dynamic_vino_lib::BaseInference>
 PipelineManager::createVehicleAttribsDetection(
   const Params::ParamManager::InferenceRawData & infer)
@@ -477,7 +939,7 @@ PipelineManager::createVehicleAttribsDetection(
   auto model =
     std::make_shared<Models::VehicleAttribsDetectionModel>(infer.model, infer.batch);
   model->modelInit();
-  auto engine = engine_manager_.createEngine(infer.engine, model);
+  auto engine = engine_manager_.createEngine(infer, model);
   auto vehicle_attribs_ptr =
     std::make_shared<dynamic_vino_lib::VehicleAttribsDetection>();
   vehicle_attribs_ptr->loadNetwork(model);
@@ -493,7 +955,7 @@ PipelineManager::createLicensePlateDetection(
   auto model =
     std::make_shared<Models::LicensePlateDetectionModel>(infer.model, infer.batch);
   model->modelInit();
-  auto engine = engine_manager_.createEngine(infer.engine, model);
+  auto engine = engine_manager_.createEngine(infer, model);
   auto license_plate_ptr =
     std::make_shared<dynamic_vino_lib::LicensePlateDetection>();
   license_plate_ptr->loadNetwork(model);
@@ -506,27 +968,543 @@ PipelineManager::createLicensePlateDetection(
 void PipelineManager::threadPipeline(const char * name)
 {
   PipelineData & p = pipelines_[name];
+  if (p.pipeline != nullptr &&
+    !setThreadAffinity(p.pipeline->getParameters()->getAffinityCpus()))
+  {
+    slog::warn << "Failed to pin the threads of pipeline " << name << slog::endl;
+  }
   while (p.state != PipelineState_ThreadStopped && p.pipeline != nullptr) {
-    if (p.state == PipelineState_ThreadRunning) {
+    if (p.state != PipelineState_ThreadRunning) {
+      p.pipeline->pause();
+      {
+        // sleep until the pipeline is resumed or stopped, without any timeout
+        std::unique_lock<std::mutex> lock(state_mutex_);
+        state_cv_.wait(lock, [&p]() {
+            return p.state == PipelineState_ThreadRunning ||
+                   p.state == PipelineState_ThreadStopped;
+          });
+      }
+      p.pipeline->resume();
+      continue;
+    }
+    if (p.pipeline->isExhausted()) {
+      slog::info << "All the input frames of pipeline " << name << " are processed" << slog::endl;
+      setPipelineState(name, PipelineState_ThreadStopped);
+      break;
+    }
+    // the timeout bounds the reaction time to state changes
+    if (p.pipeline->waitForFrame(std::chrono::milliseconds(100))) {
       p.pipeline->runOnce();
     }
-    std::this_thread::sleep_for(std::chrono::microseconds(1));
+    checkInferences(name, p);
+    governPower(name, p);
+  }
+  // the frames already captured are output before the thread exits
+  if (p.pipeline != nullptr) {
+    p.pipeline->drain();
   }
 }
 void PipelineManager::threadSpinNodes(const char * name)
 {
   PipelineData & p = pipelines_[name];
+  rclcpp::executors::SingleThreadedExecutor executor;
+  for (auto & node : p.spin_nodes) {
+    executor.add_node(node);
+  }
   while (p.state != PipelineState_ThreadStopped && p.pipeline != nullptr) {
-    for (auto & node : p.spin_nodes) {
-      rclcpp::spin_some(node);
+    // blocks until some work is ready instead of polling
+    executor.spin_once(std::chrono::milliseconds(100));
+  }
+}
+
+void PipelineManager::setPipelineState(const std::string & name, PipelineState state)
+{
+  auto it = pipelines_.find(name);
+  if (it == pipelines_.end()) {
+    slog::warn << "No pipeline named " << name << slog::endl;
+    return;
+  }
+  if (state == PipelineState_ThreadRunning && it->second.pipeline == nullptr) {
+    // lazy or unloaded, runs once loaded
+    loadPipeline(name);
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lk(state_mutex_);
+    it->second.state = state;
+    if (state == PipelineState_ThreadPasued || state == PipelineState_ThreadStopped) {
+      it->second.idle_since = std::chrono::steady_clock::now();
+    }
+  }
+  state_cv_.notify_all();
+}
+
+bool PipelineManager::loadPipeline(const std::string & name)
+{
+  std::lock_guard<std::mutex> lifecycle(lifecycle_mutex_);
+  auto & data = pipelines_[name];
+  if (data.pipeline != nullptr) {
+    return true;
+  }
+  // the thread of the pipeline before it was unloaded, if any, is done
+  if (data.thread != nullptr && data.thread->joinable()) {
+    data.thread->join();
+  }
+  slog::info << "Loading pipeline " << name << slog::endl;
+  std::shared_ptr<Pipeline> pipeline;
+  try {
+    pipeline = createPipeline(data.params, data.parent_node);
+  } catch (const std::exception & e) {
+    slog::err << "Failed to load pipeline " << name << ": " << e.what() << slog::endl;
+  }
+  if (pipeline == nullptr) {
+    return false;
+  }
+  if (executor_ != nullptr) {
+    for (auto & node : data.spin_nodes) {
+      try {
+        executor_->add_node(node);
+      } catch (const std::exception & e) {
+        slog::warn << "Failed to spin a node of pipeline " << name << ": " << e.what() <<
+          slog::endl;
+      }
+    }
+  }
+  {
+    std::lock_guard<std::mutex> lk(state_mutex_);
+    data.state = PipelineState_ThreadRunning;
+  }
+  state_cv_.notify_all();
+  data.thread = std::make_shared<std::thread>(&PipelineManager::threadPipeline, this,
+      data.params.name.c_str());
+  return true;
+}
+
+void PipelineManager::unloadPipeline(const std::string & name)
+{
+  std::lock_guard<std::mutex> lifecycle(lifecycle_mutex_);
+  auto & data = pipelines_[name];
+  if (data.pipeline == nullptr) {
+    return;
+  }
+  PipelineState state = data.state;
+  setPipelineState(name, PipelineState_ThreadStopped);
+  if (data.thread != nullptr && data.thread->joinable()) {
+    data.thread->join();
+  }
+  if (data.thread_spin_nodes != nullptr && data.thread_spin_nodes->joinable()) {
+    data.thread_spin_nodes->join();
+  }
+  if (data.reload.valid()) {
+    data.reload.wait();
+  }
+  for (auto & joining : data.joining) {
+    joining.wait();
+  }
+  data.joining.clear();
+  if (executor_ != nullptr) {
+    for (auto & node : data.spin_nodes) {
+      try {
+        executor_->remove_node(node);
+      } catch (const std::exception &) {
+        // not spun by the executor
+      }
+    }
+  }
+  {
+    std::lock_guard<std::mutex> lk(state_mutex_);
+    // releases the inferences, their networks, the inputs and the outputs
+    data.pipeline = nullptr;
+    data.spin_nodes.clear();
+    data.thread = nullptr;
+    data.thread_spin_nodes = nullptr;
+    // still paused or stopped, the next RUN_PIPELINE loads the pipeline again
+    data.state = state;
+  }
+  slog::info << "Pipeline " << name << " is unloaded after " << data.params.idle_unload <<
+    "s idle" << slog::endl;
+}
+
+void PipelineManager::unloadIdlePipelines()
+{
+  auto now = std::chrono::steady_clock::now();
+  std::vector<std::string> idle;
+  {
+    std::lock_guard<std::mutex> lk(state_mutex_);
+    for (auto & pipeline : pipelines_) {
+      auto & data = pipeline.second;
+      bool stopped = data.state == PipelineState_ThreadPasued ||
+        data.state == PipelineState_ThreadStopped;
+      if (data.pipeline != nullptr && stopped && data.params.idle_unload > 0 &&
+        now - data.idle_since > std::chrono::duration<double>(data.params.idle_unload))
+      {
+        idle.push_back(pipeline.first);
+      }
+    }
+  }
+  for (auto & name : idle) {
+    unloadPipeline(name);
+  }
+}
+
+void PipelineManager::removePipeline(const std::string & name)
+{
+  auto it = pipelines_.find(name);
+  if (it == pipelines_.end()) {
+    slog::warn << "No pipeline named " << name << slog::endl;
+    return;
+  }
+  setPipelineState(name, PipelineState_ThreadStopped);
+  // the threads refer to the data of the pipeline, joined before it is erased
+  if (it->second.thread != nullptr && it->second.thread->joinable()) {
+    it->second.thread->join();
+  }
+  if (it->second.thread_spin_nodes != nullptr && it->second.thread_spin_nodes->joinable()) {
+    it->second.thread_spin_nodes->join();
+  }
+  if (it->second.reload.valid()) {
+    it->second.reload.wait();
+  }
+  for (auto & joining : it->second.joining) {
+    joining.wait();
+  }
+  pipelines_.erase(it);
+}
+
+bool PipelineManager::reloadInference(
+  const std::string & name, const std::string & inference, const std::string & model)
+{
+  auto it = pipelines_.find(name);
+  if (it == pipelines_.end() || it->second.pipeline == nullptr) {
+    slog::warn << "No pipeline named " << name << slog::endl;
+    return false;
+  }
+  auto & data = it->second;
+  auto infer = std::find_if(data.params.infers.begin(), data.params.infers.end(),
+      [&inference](const Params::ParamManager::InferenceRawData & infer) {
+        return infer.name == inference;
+      });
+  if (infer == data.params.infers.end()) {
+    slog::warn << "No inference named " << inference << " in pipeline " << name << slog::endl;
+    return false;
+  }
+  auto params = *infer;
+  if (!model.empty()) {
+    params.model = model;
+  }
+  return loadInference(name, params, false);
+}
+
+bool PipelineManager::loadInference(
+  const std::string & name, Params::ParamManager::InferenceRawData params, bool fallback)
+{
+  auto & data = pipelines_[name];
+  if (data.reload.valid() &&
+    data.reload.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+  {
+    slog::warn << "A model of pipeline " << name << " is already being loaded" << slog::endl;
+    return false;
+  }
+  auto cpus = PipelineParams(data.params).getAffinityCpus();
+  addAffinityHints(data.params, cpus, params);
+  // the first frames of the new network are not slowed down by its first requests
+  params.warmup = std::max(1, params.warmup);
+  auto pipeline = data.pipeline;
+  data.reload = std::async(std::launch::async, [this, pipeline, params, name, cpus, fallback]() {
+      setThreadAffinity(cpus);
+      slog::info << "Loading " << params.model << " for " << name << "/" << params.name <<
+        slog::endl;
+      std::shared_ptr<dynamic_vino_lib::BaseInference> object;
+      try {
+        object = createInference(params);
+      } catch (const std::exception & e) {
+        slog::err << "Failed to load " << params.model << ": " << e.what() << slog::endl;
+      }
+      if (object == nullptr) {
+        slog::err << "Keeping the running model of " << name << "/" << params.name << slog::endl;
+        return;
+      }
+      if (object->getEngine() != nullptr) {
+        object->getEngine()->setScheduler(name);
+      }
+      if (!pipeline->replaceInference(params.name, object)) {
+        return;
+      }
+      if (fallback) {
+        pipeline->setFallback(params.name);
+        if (params.fallback_fps > 0) {
+          pipeline->setRateLimit(params.fallback_fps);
+        }
+        slog::warn << name << "/" << params.name << " runs degraded on " << params.engine <<
+          slog::endl;
+      }
+      // a pipeline created again from its parameters gets the new model
+      std::lock_guard<std::mutex> lock(state_mutex_);
+      auto found = pipelines_.find(name);
+      if (found != pipelines_.end()) {
+        for (auto & infer : found->second.params.infers) {
+          if (infer.name == params.name) {
+            infer.model = params.model;
+            infer.engine = params.engine;
+            infer.input_shape = params.input_shape;
+          }
+        }
+      }
+    }).share();
+  return true;
+}
+
+void PipelineManager::selectVariant(Params::ParamManager::InferenceRawData & infer)
+{
+  for (auto & variant : infer.variants) {
+    if (Engines::EngineManager::supportsModel(infer.engine, variant)) {
+      if (variant != infer.model) {
+        slog::info << "Selected the variant " << variant << " of " << infer.name << " for " <<
+          infer.engine << slog::endl;
+      }
+      infer.model = variant;
+      return;
     }
-    std::this_thread::sleep_for(std::chrono::microseconds(1));
+  }
+  if (!infer.variants.empty()) {
+    slog::warn << "No variant of " << infer.name << " is optimized for " << infer.engine <<
+      ", loading " << infer.model << slog::endl;
+  }
+}
+
+void PipelineManager::checkInferences(const std::string & name, PipelineData & data)
+{
+  // a variant runs for a while before it is measured against the budget again
+  const std::chrono::seconds variant_hold(10);
+  bool reloading = data.reload.valid() &&
+    data.reload.wait_for(std::chrono::seconds(0)) != std::future_status::ready;
+  std::vector<Params::ParamManager::InferenceRawData> failing;
+  std::vector<Params::ParamManager::InferenceRawData> switching;
+  std::vector<Params::ParamManager::InferenceRawData> reshaping;
+  {
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    for (auto & infer : data.params.infers) {
+      auto inference = data.pipeline->getInference(infer.name);
+      auto engine = inference == nullptr ? nullptr : inference->getEngine();
+      if (engine == nullptr) {
+        continue;
+      }
+      if (infer.request_timeout > 0) {
+        int cancelled = engine->cancelStalledRequests(std::chrono::milliseconds(
+            static_cast<int64_t>(infer.request_timeout)));
+        if (cancelled > 0) {
+          slog::warn << "Cancelled " << cancelled << " requests of " << name << "/" <<
+            infer.name << " running for over " << infer.request_timeout << "ms" << slog::endl;
+        }
+      }
+      if (infer.max_errors > 0 && engine->getConsecutiveErrors() >= infer.max_errors &&
+        data.failed_inferences.count(infer.name) == 0)
+      {
+        data.failed_inferences.insert(infer.name);
+        failing.push_back(infer);
+        continue;
+      }
+      auto input = data.pipeline->getInputDevice();
+      if (!reloading && reshaping.empty() && infer.input_shape == "auto" &&
+        data.reshaped_inferences.count(infer.name) == 0 && input != nullptr &&
+        input->getWidth() > 0 && input->getHeight() > 0)
+      {
+        // reshaped once, to the aspect ratio of the frames of the input
+        data.reshaped_inferences.insert(infer.name);
+        reshaping.push_back(infer);
+        reshaping.back().input_shape = std::to_string(input->getWidth()) + ":" +
+          std::to_string(input->getHeight());
+        continue;
+      }
+      // the variants are the governor's while it saves energy
+      if (reloading || infer.variant_budget <= 0 || infer.variants.size() < 2 ||
+        data.failed_inferences.count(infer.name) > 0 ||
+        (data.params.saving_variants && data.governor.isSaving()))
+      {
+        continue;
+      }
+      auto now = std::chrono::steady_clock::now();
+      auto switched = data.variant_switched.find(infer.name);
+      if (switched != data.variant_switched.end() && now - switched->second < variant_hold) {
+        continue;
+      }
+      auto & supported = getSupportedVariants(data, infer);
+      auto current = std::find(supported.begin(), supported.end(), infer.model);
+      double request_ms = data.pipeline->getRequestMs(infer.name);
+      if (current == supported.end() || request_ms <= 0) {
+        continue;
+      }
+      auto next = current;
+      if (request_ms > infer.variant_budget && current + 1 != supported.end()) {
+        ++next;
+      } else if (request_ms < infer.variant_budget / 2 && current != supported.begin()) {
+        --next;
+      } else {
+        continue;
+      }
+      slog::info << name << "/" << infer.name << " takes " << request_ms << "ms per request " <<
+        "for a budget of " << infer.variant_budget << "ms, switching to " << *next << slog::endl;
+      data.variant_switched[infer.name] = now;
+      switching.push_back(infer);
+      switching.back().model = *next;
+    }
+  }
+  for (auto & infer : reshaping) {
+    slog::info << "Reshaping " << name << "/" << infer.name << " to the frames of " <<
+      infer.input_shape << slog::endl;
+    if (loadInference(name, infer, false)) {
+      switching.clear();
+    }
+  }
+  for (auto & infer : switching) {
+    // one load at a time, the other switches wait for the next checks
+    if (loadInference(name, infer, false)) {
+      break;
+    }
+  }
+  for (auto & infer : failing) {
+    slog::err << "The engine of " << name << "/" << infer.name << " on " << infer.engine <<
+      " failed " << infer.max_errors << " requests in a row" << slog::endl;
+    if (infer.fallback_engine.empty() || infer.fallback_engine == infer.engine) {
+      slog::err << "No fallback device for " << name << "/" << infer.name <<
+        ", its frames get no results" << slog::endl;
+      continue;
+    }
+    auto params = infer;
+    params.engine = infer.fallback_engine;
+    if (!infer.fallback_model.empty()) {
+      params.model = infer.fallback_model;
+    } else {
+      selectVariant(params);
+    }
+    // no device list or config of the failed engine on the fallback device
+    params.config.clear();
+    params.infer_requests = 0;
+    if (!loadInference(name, params, true)) {
+      // retried by the next check
+      data.failed_inferences.erase(infer.name);
+    }
+  }
+}
+
+const std::vector<std::string> & PipelineManager::getSupportedVariants(
+  PipelineData & data, const Params::ParamManager::InferenceRawData & infer)
+{
+  auto & supported = data.variants[infer.name];
+  if (supported.empty()) {
+    for (auto & variant : infer.variants) {
+      if (Engines::EngineManager::supportsModel(infer.engine, variant)) {
+        supported.push_back(variant);
+      }
+    }
+  }
+  return supported;
+}
+
+void PipelineManager::governPower(const std::string & name, PipelineData & data)
+{
+  auto & common = Params::ParamManager::getInstance().getCommon();
+  PowerGovernor::Policy policy;
+  policy.idle_activity = data.params.idle_activity;
+  policy.battery_low = common.battery_low;
+  policy.temperature_high = common.temperature_high;
+  auto now = std::chrono::steady_clock::now();
+  // the signals change slowly, they are sampled once a second
+  if (!policy.isEnabled() || data.pipeline == nullptr ||
+    now - data.governed_at < std::chrono::seconds(1))
+  {
+    return;
+  }
+  data.governed_at = now;
+
+  PowerGovernor::Signals signals;
+  uint64_t gated = data.pipeline->getGatedFrames();
+  uint64_t still = data.pipeline->getStillFrames();
+  if (gated > data.gated_frames) {
+    signals.activity = 1.0f - static_cast<float>(still - data.still_frames) /
+      (gated - data.gated_frames);
+  }
+  data.gated_frames = gated;
+  data.still_frames = still;
+  signals.battery = battery_level_;
+  if (!common.temperature_file.empty()) {
+    signals.temperature = PowerGovernor::readTemperature(common.temperature_file);
+  }
+  bool saving = data.governor.isSaving();
+  if (data.governor.update(policy, signals, now)) {
+    saving = data.governor.isSaving();
+    std::string reasons;
+    for (auto & reason : data.governor.getReasons()) {
+      reasons += (reasons.empty() ? "" : ", ") + reason;
+    }
+    if (saving) {
+      slog::info << "Pipeline " << name << " saves energy (" << reasons << ")" << slog::endl;
+    } else {
+      slog::info << "Pipeline " << name << " runs at full rate again" << slog::endl;
+    }
+  }
+  data.pipeline->setPowerSaving(saving ? data.params.saving_fps : 0, data.governor.getReasons());
+
+  // set again each time, the inferences loaded since start from their parameters
+  for (auto & infer : data.params.infers) {
+    if (data.params.saving_detect_interval <= 0 || infer.tracker != "sort") {
+      continue;
+    }
+    auto detection = std::dynamic_pointer_cast<dynamic_vino_lib::ObjectDetection>(
+      data.pipeline->getInference(infer.name));
+    if (detection != nullptr) {
+      detection->setDetectInterval(saving ?
+        std::max(infer.detect_interval, data.params.saving_detect_interval) :
+        infer.detect_interval);
+    }
+  }
+
+  if (!data.params.saving_variants ||
+    (data.reload.valid() &&
+    data.reload.wait_for(std::chrono::seconds(0)) != std::future_status::ready))
+  {
+    return;
+  }
+  Params::ParamManager::InferenceRawData switching;
+  {
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    for (auto & infer : data.params.infers) {
+      if (infer.variants.size() < 2 || data.failed_inferences.count(infer.name) > 0) {
+        continue;
+      }
+      auto & supported = getSupportedVariants(data, infer);
+      auto saved = data.saved_models.find(infer.name);
+      if (saving && saved == data.saved_models.end() && !supported.empty() &&
+        infer.model != supported.back())
+      {
+        data.saved_models[infer.name] = infer.model;
+        switching = infer;
+        switching.model = supported.back();
+        break;
+      }
+      if (!saving && saved != data.saved_models.end()) {
+        switching = infer;
+        switching.model = saved->second;
+        data.saved_models.erase(saved);
+        break;
+      }
+    }
+  }
+  if (!switching.name.empty()) {
+    // one load at a time, the other inferences switch by the next samples
+    slog::info << "Loading " << switching.model << " for " << name << "/" << switching.name <<
+      (saving ? " to save energy" : " at full rate") << slog::endl;
+    data.variant_switched[switching.name] = now;
+    loadInference(name, switching, false);
   }
 }
 
 void PipelineManager::runAll()
 {
   for (auto it = pipelines_.begin(); it != pipelines_.end(); ++it) {
+    if (it->second.pipeline == nullptr) {
+      continue;  // lazy, loaded by the first RUN_PIPELINE
+    }
     if (it->second.state != PipelineState_ThreadRunning) {
       it->second.state = PipelineState_ThreadRunning;
     }
@@ -553,6 +1531,49 @@ void PipelineManager::runAll()
   }
 }
 
+void PipelineManager::spinAll(const std::vector<rclcpp::Node::SharedPtr> & nodes, size_t threads)
+{
+  rclcpp::executors::MultiThreadedExecutor executor(rclcpp::ExecutorOptions(), threads);
+  // a node is added to one executor once, the inputs may share the given ones
+  std::set<rclcpp::Node *> added;
+  auto add = [&executor, &added](const rclcpp::Node::SharedPtr & node) {
+      if (node != nullptr && added.insert(node.get()).second) {
+        executor.add_node(node);
+      }
+    };
+  for (auto & node : nodes) {
+    add(node);
+  }
+  for (auto & pipeline : pipelines_) {
+    for (auto & node : pipeline.second.spin_nodes) {
+      add(node);
+    }
+  }
+  slog::info << "Spinning " << added.size() << " nodes on " <<
+    executor.get_number_of_threads() << " threads" << slog::endl;
+
+  {
+    // the pipelines loaded later spin their nodes on it too
+    std::lock_guard<std::mutex> lifecycle(lifecycle_mutex_);
+    executor_ = &executor;
+  }
+  std::thread spinner([&executor] {executor.spin();});
+  // finite inputs (e.g. ImageDirectory) stop their pipeline once processed
+  while (rclcpp::ok() && isAnyRunning()) {
+    {
+      std::unique_lock<std::mutex> lk(state_mutex_);
+      state_cv_.wait_for(lk, std::chrono::milliseconds(100));
+    }
+    unloadIdlePipelines();
+  }
+  {
+    std::lock_guard<std::mutex> lifecycle(lifecycle_mutex_);
+    executor_ = nullptr;
+  }
+  executor.cancel();
+  spinner.join();
+}
+
 void PipelineManager::runService()
 {
   auto node = std::make_shared<vino_service::PipelineProcessingServer
@@ -563,11 +1584,26 @@ void PipelineManager::runService()
   }
 }
 
+bool PipelineManager::isAnyRunning()
+{
+  std::lock_guard<std::mutex> lk(state_mutex_);
+  for (auto & pipeline : pipelines_) {
+    if (pipeline.second.state == PipelineState_ThreadRunning ||
+      pipeline.second.state == PipelineState_ThreadPasued)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
 void PipelineManager::stopAll()
 {
   for (auto it = pipelines_.begin(); it != pipelines_.end(); ++it) {
-    if (it->second.state == PipelineState_ThreadRunning) {
-      it->second.state = PipelineState_ThreadStopped;
+    if (it->second.state == PipelineState_ThreadRunning ||
+      it->second.state == PipelineState_ThreadPasued)
+    {
+      setPipelineState(it->first, PipelineState_ThreadStopped);
     }
   }
   if (service_.state == PipelineState_ThreadRunning) {
@@ -582,12 +1618,17 @@ void PipelineManager::joinAll()
   }
 
   for (auto it = pipelines_.begin(); it != pipelines_.end(); ++it) {
-    if (it->second.thread != nullptr && it->second.state == PipelineState_ThreadRunning) {
+    if (it->second.reload.valid()) {
+      it->second.reload.wait();
+    }
+    for (auto & joining : it->second.joining) {
+      joining.wait();
+    }
+    // the threads of the pipelines stopped meanwhile are joined as well
+    if (it->second.thread != nullptr && it->second.thread->joinable()) {
       it->second.thread->join();
     }
-    if (it->second.thread_spin_nodes != nullptr &&
-      it->second.state == PipelineState_ThreadRunning)
-    {
+    if (it->second.thread_spin_nodes != nullptr && it->second.thread_spin_nodes->joinable()) {
       it->second.thread_spin_nodes->join();
     }
   }
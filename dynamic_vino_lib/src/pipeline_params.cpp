@@ -18,10 +18,15 @@
  */
 
 #include <vino_param_lib/param_manager.hpp>
+#include <algorithm>
+#include <iterator>
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 #include "dynamic_vino_lib/pipeline_params.hpp"
+#include "dynamic_vino_lib/slog.hpp"
+#include "dynamic_vino_lib/utils/thread_affinity.hpp"
 
 PipelineParams::PipelineParams(const std::string & name)
 {
@@ -40,6 +45,17 @@ PipelineParams & PipelineParams::operator=(const Params::ParamManager::PipelineR
   params_.inputs = params.inputs;
   params_.outputs = params.outputs;
   params_.connects = params.connects;
+  params_.frames_in_flight = params.frames_in_flight;
+  params_.frame_policy = params.frame_policy;
+  params_.frame_decimation = params.frame_decimation;
+  params_.target_fps = params.target_fps;
+  params_.preprocess_threads = params.preprocess_threads;
+  params_.motion_threshold = params.motion_threshold;
+  params_.motion_max_skip = params.motion_max_skip;
+  params_.input_rois = params.input_rois;
+  params_.roi_refresh_interval = params.roi_refresh_interval;
+  params_.frame_deadline = params.frame_deadline;
+  params_.priority = params.priority;
 
   return *this;
 }
@@ -75,8 +91,45 @@ bool PipelineParams::isGetFps()
   if (params_.inputs.size() == 0) {
     return false;
   }
-  return std::find(params_.inputs.begin(), params_.inputs.end(), kInputType_Image) ==
-         params_.inputs.end();
+  for (auto & input : params_.inputs) {
+    if (getInputType(input) == kInputType_Image) {
+      return false;
+    }
+  }
+  return true;
+}
+
+std::string PipelineParams::getInputType(const std::string & input)
+{
+  static const std::set<std::string> types = {
+    kInputType_Image, kInputType_Video, kInputType_StandardCamera, kInputType_IpCamera,
+    kInputType_CameraTopic, kInputType_ImageTopic, kInputType_RealSenseCamera,
+    kInputType_ServiceImage, kInputType_ImageDirectory, kInputType_FrameReplay,
+    kInputType_GStreamer};
+  if (types.count(input) > 0) {
+    return input;
+  }
+  auto pos = input.find('_');
+  if (pos != std::string::npos && types.count(input.substr(0, pos)) > 0) {
+    return input.substr(0, pos);
+  }
+  return input;
+}
+
+const std::string & PipelineParams::getInputMeta(const std::string & input) const
+{
+  auto it = params_.input_metas.find(input);
+  if (it != params_.input_metas.end()) {
+    return it->second;
+  }
+  return params_.input_meta;
+}
+
+const std::string & PipelineParams::getInputRoi(const std::string & input) const
+{
+  static const std::string none;
+  auto it = params_.input_rois.find(input);
+  return it != params_.input_rois.end() ? it->second : none;
 }
 
 std::string PipelineParams::findFilterConditions(
@@ -89,3 +142,33 @@ std::string PipelineParams::findFilterConditions(
   }
   return "";
 }
+
+std::vector<int> PipelineParams::getAffinityCpus() const
+{
+  auto cpus = parseCpuList(params_.cpu_set);
+  if (!params_.cpu_set.empty() && cpus.empty()) {
+    slog::warn << "Invalid cpu_set " << params_.cpu_set << " of pipeline " << params_.name <<
+      slog::endl;
+  }
+  if (params_.numa_node < 0) {
+    return cpus;
+  }
+  auto node_cpus = getNumaNodeCpus(params_.numa_node);
+  if (node_cpus.empty()) {
+    slog::warn << "No NUMA node " << params_.numa_node << ", pipeline " << params_.name <<
+      " is not placed on it" << slog::endl;
+    return cpus;
+  }
+  if (cpus.empty()) {
+    return node_cpus;
+  }
+  std::vector<int> placed;
+  std::set_intersection(cpus.begin(), cpus.end(), node_cpus.begin(), node_cpus.end(),
+    std::back_inserter(placed));
+  if (placed.empty()) {
+    slog::warn << "The cpu_set of pipeline " << params_.name << " has no CPU on NUMA node " <<
+      params_.numa_node << ", only the cpu_set is applied" << slog::endl;
+    return cpus;
+  }
+  return placed;
+}
@@ -0,0 +1,88 @@
+// Copyright (c) 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @brief An implementation file with implementation for PowerGovernor Class
+ * @file power_governor.cpp
+ */
+
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "dynamic_vino_lib/power_governor.hpp"
+
+namespace
+{
+// the time a saving mode is held at least before the pipeline runs at full rate again
+const std::chrono::seconds kSavingHold(10);
+// the margins a signal has to be back past for its reason to end
+const float kActivityMargin = 0.05f;
+const float kBatteryMargin = 0.05f;
+const float kTemperatureMargin = 5;
+}  // namespace
+
+bool PowerGovernor::update(const Policy & policy, const Signals & signals, Clock::time_point now)
+{
+  std::vector<std::string> reasons;
+  if (policy.idle_activity > 0 && signals.activity >= 0) {
+    float threshold = policy.idle_activity + (hasReason("idle") ? kActivityMargin : 0);
+    if (signals.activity < threshold) {
+      reasons.push_back("idle");
+    }
+  }
+  if (policy.battery_low > 0 && signals.battery >= 0) {
+    float threshold = policy.battery_low + (hasReason("battery") ? kBatteryMargin : 0);
+    if (signals.battery < threshold) {
+      reasons.push_back("battery");
+    }
+  }
+  if (policy.temperature_high > 0 && signals.temperature >= 0) {
+    float threshold = policy.temperature_high -
+      (hasReason("temperature") ? kTemperatureMargin : 0);
+    if (signals.temperature > threshold) {
+      reasons.push_back("temperature");
+    }
+  }
+
+  bool saving = !reasons.empty();
+  if (!saving && saving_ && now - changed_ < kSavingHold) {
+    // held with the last reasons
+    return false;
+  }
+  reasons_ = reasons;
+  if (saving == saving_) {
+    return false;
+  }
+  saving_ = saving;
+  changed_ = now;
+  return true;
+}
+
+bool PowerGovernor::hasReason(const std::string & reason) const
+{
+  return std::find(reasons_.begin(), reasons_.end(), reason) != reasons_.end();
+}
+
+float PowerGovernor::readTemperature(const std::string & path)
+{
+  std::ifstream file(path);
+  float temperature = -1;
+  if (!(file >> temperature)) {
+    return -1;
+  }
+  // no device runs at a thousand degrees, it is in millidegrees
+  return temperature >= 1000 ? temperature / 1000 : temperature;
+}
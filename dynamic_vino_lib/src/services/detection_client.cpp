@@ -0,0 +1,205 @@
+// Copyright (c) 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @brief An implementation file with implementation for DetectionClient Class
+ * @file detection_client.cpp
+ */
+
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "dynamic_vino_lib/services/detection_client.hpp"
+#include "dynamic_vino_lib/slog.hpp"
+
+namespace vino_service
+{
+template<typename T>
+DetectionClient<T>::DetectionClient(
+  const rclcpp::Node::SharedPtr & node, const std::string & service_name,
+  size_t max_in_flight, std::chrono::milliseconds timeout, int retries)
+: node_(node), max_in_flight_(std::max<size_t>(max_in_flight, 1)),
+  timeout_(std::max(timeout, std::chrono::milliseconds(1))), retries_(std::max(retries, 0))
+{
+  client_ = node_->create_client<T>(service_name);
+  // checked a few times per timeout, a late request is sent again soon after
+  auto period = std::min(std::chrono::milliseconds(100),
+      std::max(std::chrono::milliseconds(1), timeout_ / 4));
+  timer_ = node_->create_wall_timer(period, [this]() {checkTimeouts();});
+}
+
+template<typename T>
+DetectionClient<T>::~DetectionClient()
+{
+  timer_->cancel();
+  std::vector<std::shared_ptr<Call>> calls;
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    calls.assign(queue_.begin(), queue_.end());
+    for (auto & call : in_flight_) {
+      calls.push_back(call.second);
+    }
+    queue_.clear();
+    in_flight_.clear();
+  }
+  for (auto & call : calls) {
+    call->promise.set_exception(std::make_exception_ptr(
+        std::runtime_error("The detection client was destroyed.")));
+  }
+}
+
+template<typename T>
+bool DetectionClient<T>::waitForService(std::chrono::nanoseconds timeout)
+{
+  return client_->wait_for_service(timeout);
+}
+
+template<typename T>
+typename DetectionClient<T>::ResponseFuture DetectionClient<T>::send(
+  const std::shared_ptr<Request> & request, Callback callback)
+{
+  auto call = std::make_shared<Call>();
+  call->request = request;
+  call->callback = std::move(callback);
+  ResponseFuture future = call->promise.get_future().share();
+  std::lock_guard<std::mutex> lk(mutex_);
+  queue_.push_back(call);
+  dispatch();
+  return future;
+}
+
+template<typename T>
+std::vector<typename DetectionClient<T>::ResponseFuture> DetectionClient<T>::sendBatch(
+  const std::vector<std::shared_ptr<Request>> & requests, Callback callback)
+{
+  std::vector<ResponseFuture> futures;
+  futures.reserve(requests.size());
+  for (auto & request : requests) {
+    futures.push_back(send(request, callback));
+  }
+  return futures;
+}
+
+template<typename T>
+size_t DetectionClient<T>::getInFlight()
+{
+  std::lock_guard<std::mutex> lk(mutex_);
+  return in_flight_.size();
+}
+
+template<typename T>
+size_t DetectionClient<T>::getQueued()
+{
+  std::lock_guard<std::mutex> lk(mutex_);
+  return queue_.size();
+}
+
+template<typename T>
+uint64_t DetectionClient<T>::getRetries()
+{
+  std::lock_guard<std::mutex> lk(mutex_);
+  return retried_;
+}
+
+template<typename T>
+void DetectionClient<T>::dispatch()
+{
+  while (!queue_.empty() && in_flight_.size() < max_in_flight_) {
+    auto call = queue_.front();
+    queue_.pop_front();
+    sendAttempt(call);
+  }
+}
+
+template<typename T>
+void DetectionClient<T>::sendAttempt(const std::shared_ptr<Call> & call)
+{
+  uint64_t attempt = next_attempt_++;
+  call->attempts++;
+  call->sent = std::chrono::steady_clock::now();
+  in_flight_[attempt] = call;
+  client_->async_send_request(call->request,
+    [this, attempt](typename rclcpp::Client<T>::SharedFuture future) {
+      onResponse(attempt, future.get());
+    });
+}
+
+template<typename T>
+void DetectionClient<T>::onResponse(uint64_t attempt, std::shared_ptr<Response> response)
+{
+  std::shared_ptr<Call> call;
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    auto found = in_flight_.find(attempt);
+    if (found == in_flight_.end()) {
+      // an attempt timed out and sent again, or failed
+      return;
+    }
+    call = found->second;
+    in_flight_.erase(found);
+    dispatch();
+  }
+  // out of the lock, a callback may send other requests
+  if (call->callback) {
+    call->callback(call->request, response);
+  }
+  call->promise.set_value(response);
+}
+
+template<typename T>
+void DetectionClient<T>::checkTimeouts()
+{
+  std::vector<std::shared_ptr<Call>> failed;
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    auto now = std::chrono::steady_clock::now();
+    std::vector<std::shared_ptr<Call>> late;
+    for (auto it = in_flight_.begin(); it != in_flight_.end(); ) {
+      if (now - it->second->sent < timeout_) {
+        ++it;
+        continue;
+      }
+      late.push_back(it->second);
+      it = in_flight_.erase(it);
+    }
+    for (auto & call : late) {
+      if (call->attempts > retries_) {
+        failed.push_back(call);
+        continue;
+      }
+      slog::warn << "[DetectionClient] No response in " << timeout_.count() <<
+        " ms, sending the request again" << slog::endl;
+      retried_++;
+      sendAttempt(call);
+    }
+    dispatch();
+  }
+  for (auto & call : failed) {
+    slog::err << "[DetectionClient] No response after " << call->attempts << " attempts" <<
+      slog::endl;
+    if (call->callback) {
+      call->callback(call->request, nullptr);
+    }
+    call->promise.set_exception(std::make_exception_ptr(
+        std::runtime_error("No response from the detection service.")));
+  }
+}
+
+template class DetectionClient<object_msgs::srv::DetectObject>;
+template class DetectionClient<people_msgs::srv::People>;
+}  // namespace vino_service
@@ -19,10 +19,15 @@
 #include <ament_index_cpp/get_resource.hpp>
 #include <vino_param_lib/param_manager.hpp>
 #include <rclcpp/rclcpp.hpp>
+#include <cv_bridge/cv_bridge.h>
+#include <sys/stat.h>
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <map>
 #include <chrono>
+#include <fstream>
+#include <iterator>
 #include <thread>
 
 #include "dynamic_vino_lib/pipeline_manager.hpp"
@@ -30,9 +35,80 @@
 #include "dynamic_vino_lib/inputs/base_input.hpp"
 #include "dynamic_vino_lib/inputs/image_input.hpp"
 #include "dynamic_vino_lib/slog.hpp"
+#include "dynamic_vino_lib/utils/frame_pool.hpp"
 
 namespace vino_service
 {
+namespace
+{
+/**
+ * @brief Get the image carried by a request, empty if it only names a file.
+ */
+cv::Mat getRequestImage(std::shared_ptr<people_msgs::srv::People::Request> request)
+{
+  cv::Mat image;
+  try {
+    if (!request->image.data.empty()) {
+      // shares the request buffer when it is already bgr8
+      cv_bridge::CvImageConstPtr shared = cv_bridge::toCvShare(request->image, request, "bgr8");
+      image = FramePool::wrap(shared->image, shared);
+    } else if (!request->compressed_image.data.empty()) {
+      auto & data = request->compressed_image.data;
+      FramePool::attach(image);
+      cv::imdecode(cv::Mat(1, static_cast<int>(data.size()), CV_8UC1, data.data()),
+        cv::IMREAD_COLOR, &image);
+    }
+  } catch (const cv_bridge::Exception & e) {
+    slog::err << "Failed to convert the request image: " << e.what() << slog::endl;
+  }
+  return image;
+}
+
+cv::Mat getRequestImage(std::shared_ptr<object_msgs::srv::DetectObject::Request>)
+{
+  return cv::Mat();
+}
+
+/**
+ * @brief Get the key of an image file in the response cache, its path,
+ * modification time and size. Empty if the file can't be read.
+ */
+std::string getFileKey(const std::string & path)
+{
+  struct stat status;
+  if (path.empty() || stat(path.c_str(), &status) != 0) {
+    return "";
+  }
+  return "file:" + path + "@" + std::to_string(status.st_mtim.tv_sec) + "." +
+         std::to_string(status.st_mtim.tv_nsec) + ":" + std::to_string(status.st_size);
+}
+
+/**
+ * @brief Get the key of the image of a request in the response cache: the hash
+ * of the image it carries, or the key of the file it names.
+ */
+std::string getRequestKey(std::shared_ptr<people_msgs::srv::People::Request> request)
+{
+  if (!request->image.data.empty()) {
+    auto & image = request->image;
+    uint64_t hash = hashBytes(image.data.data(), image.data.size());
+    hash = hashBytes(image.encoding.data(), image.encoding.size(), hash);
+    return "image:" + std::to_string(image.width) + "x" + std::to_string(image.height) + ":" +
+           std::to_string(hash);
+  }
+  if (!request->compressed_image.data.empty()) {
+    auto & data = request->compressed_image.data;
+    return "compressed:" + std::to_string(hashBytes(data.data(), data.size()));
+  }
+  return getFileKey(request->image_path);
+}
+
+std::string getRequestKey(std::shared_ptr<object_msgs::srv::DetectObject::Request> request)
+{
+  return getFileKey(request->image_path);
+}
+}  // namespace
+
 template<typename T>
 FrameProcessingServer<T>::FrameProcessingServer(
   const std::string & service_name,
@@ -56,13 +132,59 @@ void FrameProcessingServer<T>::initService(
     throw std::logic_error("1 and only 1 pipeline can be set to FrameProcessServer!");
   }
 
-  for (auto & p : pipelines) {
-    PipelineManager::getInstance().createPipeline(p);
+  // each instance serves one request at a time, the requests run concurrently
+  // on as many instances as configured
+  auto & params = pipelines.front();
+  int instances = std::max(params.instances, 1);
+  for (int i = 0; i < instances; i++) {
+    auto instance_params = params;
+    if (i > 0) {
+      instance_params.name = params.name + "_" + std::to_string(i);
+    }
+    auto pipeline = PipelineManager::getInstance().createPipeline(instance_params);
+    if (pipeline != nullptr) {
+      free_pipelines_.push_back(pipeline);
+    }
+  }
+  if (free_pipelines_.empty()) {
+    throw std::logic_error("No pipeline could be created for FrameProcessServer!");
+  }
+  slog::info << "Serving with " << free_pipelines_.size() << " pipeline instances" << slog::endl;
+  if (params.response_cache > 0) {
+    std::ifstream file(config_path, std::ios::binary);
+    std::string config((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    config_key_ = std::to_string(hashBytes(config.data(), config.size()));
+    response_cache_ = std::make_unique<LruCache<std::string, typename T::Response>>(
+      params.response_cache, std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(std::max(0.0f, params.response_cache_ttl))));
+    slog::info << "Memoizing up to " << params.response_cache << " responses" << slog::endl;
   }
 
+  callback_group_ = create_callback_group(rclcpp::CallbackGroupType::Reentrant);
   service_ = create_service<T>("/openvino_toolkit/service",
       std::bind(&FrameProcessingServer::cbService, this,
-      std::placeholders::_1, std::placeholders::_2));
+      std::placeholders::_1, std::placeholders::_2),
+      rmw_qos_profile_services_default, callback_group_);
+}
+
+template<typename T>
+std::shared_ptr<Pipeline> FrameProcessingServer<T>::acquirePipeline()
+{
+  std::unique_lock<std::mutex> lk(pool_mutex_);
+  pool_cv_.wait(lk, [this] {return !free_pipelines_.empty();});
+  auto pipeline = free_pipelines_.front();
+  free_pipelines_.pop_front();
+  return pipeline;
+}
+
+template<typename T>
+void FrameProcessingServer<T>::releasePipeline(std::shared_ptr<Pipeline> pipeline)
+{
+  {
+    std::lock_guard<std::mutex> lk(pool_mutex_);
+    free_pipelines_.push_back(pipeline);
+  }
+  pool_cv_.notify_one();
 }
 
 template<typename T>
@@ -70,25 +192,44 @@ void FrameProcessingServer<T>::cbService(
   const std::shared_ptr<typename T::Request> request,
   std::shared_ptr<typename T::Response> response)
 {
-  std::map<std::string, PipelineManager::PipelineData> pipelines_ =
-    PipelineManager::getInstance().getPipelines();
-  for (auto it = pipelines_.begin(); it != pipelines_.end(); ++it) {
-    PipelineManager::PipelineData & p = pipelines_[it->second.params.name.c_str()];
-    auto input = p.pipeline->getInputDevice();
+  // a repeated image is answered without being decoded nor inferred
+  std::string key;
+  if (response_cache_ != nullptr) {
+    key = getRequestKey(request);
+    if (!key.empty()) {
+      key = config_key_ + "/" + key;
+      if (response_cache_->get(key, *response)) {
+        slog::info << "[FrameProcessingServer] Served from the response cache" << slog::endl;
+        return;
+      }
+    }
+  }
+  auto pipeline = acquirePipeline();
+  auto input = pipeline->getInputDevice();
+  cv::Mat image = getRequestImage(request);
+  auto image_input = std::dynamic_pointer_cast<Input::Image>(input);
+  if (!image.empty() && image_input != nullptr) {
+    // decoded in memory, nothing is read from the disk
+    image_input->setImage(image);
+  } else {
     Input::Config config;
     config.path = request->image_path;
     input->config(config);
-    p.pipeline->runOnce();
-    auto output_handle = p.pipeline->getOutputHandle();
-
-    for (auto & pair : output_handle) {
-      if (!pair.first.compare(kOutputTpye_RosService)) {
-        pair.second->setServiceResponse(response);
-        pair.second->clearData();
-        return;  // TODO(weizhi) , return directly, suppose only 1 pipeline dealing with 1 request.
-      }
+  }
+  pipeline->runOnce();
+  // a frame dispatched without waiting is output before the response is read
+  pipeline->flush();
+  for (auto & pair : pipeline->getOutputHandle()) {
+    if (!pair.first.compare(kOutputTpye_RosService)) {
+      pair.second->setServiceResponse(response);
+      pair.second->clearData();
+      break;
     }
   }
+  releasePipeline(pipeline);
+  if (!key.empty()) {
+    response_cache_->put(key, *response);
+  }
   slog::info << "[FrameProcessingServer] Callback finished!" << slog::endl;
 }
 
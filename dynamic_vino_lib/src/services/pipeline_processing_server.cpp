@@ -17,15 +17,22 @@
 #include <ament_index_cpp/get_resource.hpp>
 #include <vino_param_lib/param_manager.hpp>
 #include <rclcpp/rclcpp.hpp>
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <map>
 #include <chrono>
+#include <cstdlib>
 #include <thread>
+#include <utility>
 
+#include "dynamic_vino_lib/engines/device_scheduler.hpp"
 #include "dynamic_vino_lib/pipeline_manager.hpp"
 #include "dynamic_vino_lib/pipeline.hpp"
 #include "dynamic_vino_lib/slog.hpp"
+#include "dynamic_vino_lib/utils/frame_pool.hpp"
+#include "dynamic_vino_lib/utils/process_memory.hpp"
+#include "dynamic_vino_lib/utils/simd_kernels.hpp"
 
 namespace vino_service
 {
@@ -37,24 +44,126 @@ PipelineProcessingServer<T>::PipelineProcessingServer(
 {
   pipelines_ = PipelineManager::getInstance().getPipelinesPtr();
   initPipelineService();
+  initStatsTopic(Params::ParamManager::getInstance().getCommon().stats_period);
 }
 
 template<typename T>
 void PipelineProcessingServer<T>::initPipelineService()
 {
+  // a slow request does not hold the image callbacks of a multi-threaded executor
+  callback_group_ = create_callback_group(rclcpp::CallbackGroupType::MutuallyExclusive);
   service_ = create_service<T>("/openvino_toolkit/pipeline_service",
       std::bind(&PipelineProcessingServer::cbService, this,
-      std::placeholders::_1, std::placeholders::_2));
+      std::placeholders::_1, std::placeholders::_2),
+      rmw_qos_profile_services_default, callback_group_);
+}
+
+template<typename T>
+void PipelineProcessingServer<T>::initStatsTopic(double period)
+{
+  if (period <= 0) {
+    return;
+  }
+  stats_pub_ = create_publisher<pipeline_srv_msgs::msg::PipelinesStats>(
+    "/openvino_toolkit/pipelines/stats", 10);
+  last_busy_times_ = Engines::DeviceScheduler::getBusyTimes();
+  last_stats_time_ = std::chrono::steady_clock::now();
+  // in the group of the service, the two don't read the pipelines at the same time
+  stats_timer_ = create_wall_timer(
+    std::chrono::duration<double>(period),
+    std::bind(&PipelineProcessingServer::publishStats, this), callback_group_);
+  slog::info << "Publishing the pipeline stats every " << period << "s" << slog::endl;
+}
+
+template<typename T>
+void PipelineProcessingServer<T>::publishStats()
+{
+  auto msg = std::make_unique<pipeline_srv_msgs::msg::PipelinesStats>();
+  msg->header.stamp = now();
+  for (auto it = pipelines_->begin(); it != pipelines_->end(); ++it) {
+    auto & pipeline = it->second.pipeline;
+    if (pipeline == nullptr) {
+      continue;
+    }
+    pipeline_srv_msgs::msg::PipelineStats pipeline_msg;
+    pipeline_msg.name = it->first;
+    pipeline_msg.running_status = std::to_string(it->second.state);
+    pipeline_msg.fps = pipeline->getFPS();
+    pipeline_msg.dropped_fps = pipeline->getDroppedFPS();
+    pipeline_msg.dropped_frames = pipeline->getDroppedFrames();
+    pipeline_msg.late_frames = pipeline->getLateFrames();
+    pipeline_msg.deadline_misses = pipeline->getDeadlineMisses();
+    pipeline_msg.deadline_skips = pipeline->getDeadlineSkips();
+    pipeline_msg.request_failures = pipeline->getRequestFailures();
+    for (auto & fallback : pipeline->getFallbacks()) {
+      pipeline_msg.fallbacks.push_back(fallback);
+    }
+    for (auto & reason : pipeline->getPowerReasons()) {
+      pipeline_msg.power_saving.push_back(reason);
+    }
+    for (auto & summary : pipeline->getLatencyStats()) {
+      pipeline_srv_msgs::msg::StageStats stats;
+      stats.stage = summary.stage;
+      stats.count = summary.count;
+      stats.mean = summary.mean;
+      stats.p50 = summary.p50;
+      stats.p95 = summary.p95;
+      stats.p99 = summary.p99;
+      pipeline_msg.stats.push_back(stats);
+    }
+    for (auto & depth : pipeline->getQueueDepths()) {
+      pipeline_srv_msgs::msg::QueueDepth queue;
+      queue.queue = depth.first;
+      queue.depth = depth.second;
+      pipeline_msg.queues.push_back(queue);
+    }
+    for (auto & usage : pipeline->getMemoryUsage()) {
+      pipeline_srv_msgs::msg::MemoryUsage memory;
+      memory.name = usage.first;
+      memory.bytes = usage.second;
+      pipeline_msg.memory.push_back(memory);
+    }
+    msg->pipelines.push_back(pipeline_msg);
+  }
+
+  auto stats_time = std::chrono::steady_clock::now();
+  double elapsed = std::chrono::duration<double>(stats_time - last_stats_time_).count();
+  auto busy_times = Engines::DeviceScheduler::getBusyTimes();
+  for (auto & busy : busy_times) {
+    pipeline_srv_msgs::msg::DeviceUsage device;
+    device.device = busy.first;
+    device.busy_seconds = busy.second;
+    auto last = last_busy_times_.find(busy.first);
+    double last_busy = last == last_busy_times_.end() ? 0 : last->second;
+    device.utilization = elapsed > 0 ?
+      std::min(1.0, std::max(0.0, (busy.second - last_busy) / elapsed)) : 0;
+    msg->devices.push_back(device);
+  }
+  last_busy_times_ = busy_times;
+  last_stats_time_ = stats_time;
+
+  msg->memory_rss = readProcessMemory("VmRSS");
+  msg->memory_peak = readProcessMemory("VmHWM");
+  msg->frame_pool_bytes = FramePool::getInstance().getAllocatedBytes();
+  msg->frame_pool_free_bytes = FramePool::getInstance().getFreeBytes();
+  msg->cpu_isa = getCpuIsaName(getCpuIsa());
+  stats_pub_->publish(std::move(msg));
 }
 
 template<typename T>
 void PipelineProcessingServer<T>::setResponse(
-  std::shared_ptr<typename T::Response> response)
+  std::shared_ptr<typename T::Response> response,
+  bool with_stats, const std::string & detail_pipeline, bool with_perf_counts)
 {
   for (auto it = pipelines_->begin(); it != pipelines_->end(); ++it) {
     pipeline_srv_msgs::msg::Pipeline pipeline_msg;
     pipeline_msg.name = it->first;
     pipeline_msg.running_status = std::to_string(it->second.state);
+    if (it->second.pipeline == nullptr) {
+      // lazy or unloaded, loaded by the next RUN_PIPELINE
+      response->pipelines.push_back(pipeline_msg);
+      continue;
+    }
 
     auto connection_map = it->second.pipeline->getPipelineDetail();
     for (auto & current_pipe : connection_map) {
@@ -63,9 +172,118 @@ void PipelineProcessingServer<T>::setResponse(
       connection.output = current_pipe.second.c_str();
       pipeline_msg.connections.push_back(connection);
     }
+    bool detailed = detail_pipeline.empty() || detail_pipeline == it->first;
+    if (with_stats && detailed) {
+      pipeline_msg.dropped_frames = it->second.pipeline->getDroppedFrames();
+      pipeline_msg.late_frames = it->second.pipeline->getLateFrames();
+      pipeline_msg.deadline_misses = it->second.pipeline->getDeadlineMisses();
+      pipeline_msg.deadline_skips = it->second.pipeline->getDeadlineSkips();
+      pipeline_msg.request_failures = it->second.pipeline->getRequestFailures();
+      for (auto & summary : it->second.pipeline->getLatencyStats()) {
+        pipeline_srv_msgs::msg::StageStats stats;
+        stats.stage = summary.stage;
+        stats.count = summary.count;
+        stats.mean = summary.mean;
+        stats.p50 = summary.p50;
+        stats.p95 = summary.p95;
+        stats.p99 = summary.p99;
+        pipeline_msg.stats.push_back(stats);
+      }
+      for (auto & usage : it->second.pipeline->getMemoryUsage()) {
+        pipeline_srv_msgs::msg::MemoryUsage memory;
+        memory.name = usage.first;
+        memory.bytes = usage.second;
+        pipeline_msg.memory.push_back(memory);
+      }
+    }
+    if (with_perf_counts && detailed) {
+      for (auto & summary : it->second.pipeline->getPerfCounts()) {
+        pipeline_srv_msgs::msg::LayerPerf perf;
+        perf.inference = summary.inference;
+        perf.layer = summary.layer;
+        perf.layer_type = summary.layer_type;
+        perf.exec_type = summary.exec_type;
+        perf.count = summary.count;
+        perf.real_time_us = summary.real_time_us;
+        perf.cpu_time_us = summary.cpu_time_us;
+        pipeline_msg.perf_counts.push_back(perf);
+      }
+    }
     response->pipelines.push_back(pipeline_msg);
   }
 }
+template<typename T>
+void PipelineProcessingServer<T>::dumpPerfCounts(const std::string & value)
+{
+  std::string pipeline_name = value;
+  std::string path;
+  auto pos = value.find(':');
+  if (pos != std::string::npos) {
+    pipeline_name = value.substr(0, pos);
+    path = value.substr(pos + 1);
+  }
+  if (path.empty()) {
+    path = pipeline_name + "_perf_counts.csv";
+  }
+  auto it = pipelines_->find(pipeline_name);
+  if (it == pipelines_->end() || it->second.pipeline == nullptr) {
+    slog::warn << "No loaded pipeline named " << pipeline_name << slog::endl;
+    return;
+  }
+  if (it->second.pipeline->dumpPerfCounts(path)) {
+    slog::info << "Performance counts of " << pipeline_name << " are dumped to " << path <<
+      slog::endl;
+  } else {
+    slog::err << "Failed to write the performance counts to " << path << slog::endl;
+  }
+}
+
+template<typename T>
+void PipelineProcessingServer<T>::setPriority(const std::string & value)
+{
+  auto pos = value.find(':');
+  if (pos == std::string::npos) {
+    slog::warn << "SET_PRIORITY expects <pipeline>:<weight>, got " << value << slog::endl;
+    return;
+  }
+  std::string pipeline_name = value.substr(0, pos);
+  if (pipelines_->find(pipeline_name) == pipelines_->end()) {
+    slog::warn << "No pipeline named " << pipeline_name << slog::endl;
+    return;
+  }
+  double weight = std::atof(value.substr(pos + 1).c_str());
+  if (weight <= 0) {
+    slog::warn << "Invalid priority " << value.substr(pos + 1) << " for " << pipeline_name <<
+      slog::endl;
+    return;
+  }
+  Engines::DeviceScheduler::setClientWeight(pipeline_name, weight);
+  slog::info << "Priority of " << pipeline_name << " set to " << weight << slog::endl;
+}
+
+template<typename T>
+void PipelineProcessingServer<T>::reloadInference(const std::string & value, bool with_model)
+{
+  // <pipeline>:<inference>, followed by :<model path> for SET_MODEL
+  auto pos = value.find(':');
+  auto model_pos = pos == std::string::npos ? pos : value.find(':', pos + 1);
+  if (pos == std::string::npos || (with_model && model_pos == std::string::npos)) {
+    slog::warn << (with_model ? "SET_MODEL expects <pipeline>:<inference>:<model path>" :
+      "RELOAD_INFERENCE expects <pipeline>:<inference>") << ", got " << value << slog::endl;
+    return;
+  }
+  std::string pipeline_name = value.substr(0, pos);
+  std::string inference = value.substr(pos + 1, model_pos == std::string::npos ?
+      std::string::npos : model_pos - pos - 1);
+  std::string model = with_model ? value.substr(model_pos + 1) : "";
+  if (with_model && model.empty()) {
+    slog::warn << "SET_MODEL got an empty model path" << slog::endl;
+    return;
+  }
+  // the load runs in the background, the service answers at once
+  PipelineManager::getInstance().reloadInference(pipeline_name, inference, model);
+}
+
 template<typename T>
 void PipelineProcessingServer<T>::setPipelineByRequest(
   std::string pipeline_name,
@@ -74,7 +292,7 @@ void PipelineProcessingServer<T>::setPipelineByRequest(
   for (auto it = pipelines_->begin(); it != pipelines_->end(); ++it) {
     if (pipeline_name == it->first) {
       std::cout << pipeline_name << "set :" << state << std::endl;
-      it->second.state = state;
+      PipelineManager::getInstance().setPipelineState(pipeline_name, state);
     }
   }
 }
@@ -88,6 +306,29 @@ void PipelineProcessingServer<T>::cbService(
   std::string req_val = request->pipeline_request.value;
   slog::info << "[PipelineProcessingServer] Pipeline Service get request cmd: " << req_cmd <<
     " val:" << req_val << slog::endl;
+  if (req_cmd == "GET_STATS") {
+    setResponse(response, true, req_val);
+    return;
+  }
+  if (req_cmd == "GET_PERF_COUNTS") {
+    setResponse(response, false, req_val, true);
+    return;
+  }
+  if (req_cmd == "DUMP_PERF_COUNTS") {
+    dumpPerfCounts(req_val);
+    setResponse(response);
+    return;
+  }
+  if (req_cmd == "SET_PRIORITY") {
+    setPriority(req_val);
+    setResponse(response);
+    return;
+  }
+  if (req_cmd == "RELOAD_INFERENCE" || req_cmd == "SET_MODEL") {
+    reloadInference(req_val, req_cmd == "SET_MODEL");
+    setResponse(response);
+    return;
+  }
   // Todo set initial state by current state
   PipelineManager::PipelineState state = PipelineManager::PipelineState_ThreadRunning;
   if (req_cmd != "GET_PIPELINE") {
@@ -0,0 +1,354 @@
+// Copyright (c) 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @brief An implementation file with implementation for VideoProcessingServer Class
+ * @file video_processing_server.cpp
+ */
+
+#include <object_msgs/msg/object_in_box.hpp>
+#include <object_msgs/msg/objects_in_boxes.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "dynamic_vino_lib/services/video_processing_server.hpp"
+#include "dynamic_vino_lib/inferences/face_detection.hpp"
+#include "dynamic_vino_lib/inferences/object_detection.hpp"
+#include "dynamic_vino_lib/inputs/video_decoder.hpp"
+#include "dynamic_vino_lib/outputs/base_output.hpp"
+#include "dynamic_vino_lib/pipeline.hpp"
+#include "dynamic_vino_lib/pipeline_manager.hpp"
+#include "dynamic_vino_lib/pipeline_params.hpp"
+#include "dynamic_vino_lib/slog.hpp"
+
+namespace vino_service
+{
+namespace
+{
+const char kJobOutputName[] = "ProcessVideo";
+
+/**
+ * @brief The output of a job, counting the frames processed and gathering
+ * their detections until the next feedback.
+ */
+class JobOutput : public Outputs::BaseOutput
+{
+public:
+  explicit JobOutput(bool keep_results)
+  : BaseOutput(kJobOutputName), keep_results_(keep_results)
+  {
+  }
+
+  bool needsFrame() const override
+  {
+    return false;
+  }
+
+  void accept(const std::vector<dynamic_vino_lib::ObjectDetectionResult> & results) override
+  {
+    addObjects(results);
+  }
+
+  void accept(const std::vector<dynamic_vino_lib::FaceDetectionResult> & results) override
+  {
+    addObjects(results);
+  }
+
+  void handleOutput() override
+  {
+    frames_++;
+    if (!keep_results_) {
+      return;
+    }
+    current_.header = getFrameHeader();
+    std::lock_guard<std::mutex> lk(mutex_);
+    results_.push_back(std::move(current_));
+    current_ = object_msgs::msg::ObjectsInBoxes();
+  }
+
+  void clearData() override
+  {
+    current_.objects_vector.clear();
+  }
+
+  uint64_t getFrames() const
+  {
+    return frames_;
+  }
+
+  /**
+   * @brief Take the results gathered since the last call (Thread Safe).
+   */
+  std::vector<object_msgs::msg::ObjectsInBoxes> takeResults()
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    std::vector<object_msgs::msg::ObjectsInBoxes> results;
+    results.swap(results_);
+    return results;
+  }
+
+private:
+  template<typename T>
+  void addObjects(const std::vector<T> & results)
+  {
+    if (!keep_results_) {
+      return;
+    }
+    object_msgs::msg::ObjectInBox object;
+    for (auto & r : results) {
+      auto loc = toNative(r.getLocation());
+      object.roi.x_offset = loc.x;
+      object.roi.y_offset = loc.y;
+      object.roi.width = loc.width;
+      object.roi.height = loc.height;
+      object.object.object_name = r.getLabel();
+      object.object.probability = r.getConfidence();
+      current_.objects_vector.push_back(object);
+    }
+  }
+
+  bool keep_results_;
+  std::atomic<uint64_t> frames_{0};
+  /**< the detections of the frame being output >**/
+  object_msgs::msg::ObjectsInBoxes current_;
+  std::mutex mutex_;
+  std::vector<object_msgs::msg::ObjectsInBoxes> results_;
+};
+}  // namespace
+
+VideoProcessingServer::VideoProcessingServer(const std::string & config_path)
+: Node("video_processing_server")
+{
+  Params::ParamManager::getInstance().parse(config_path);
+  Params::ParamManager::getInstance().print();
+  for (auto & params : Params::ParamManager::getInstance().getPipelines()) {
+    pipelines_[params.name] = params;
+  }
+  if (pipelines_.empty()) {
+    throw std::logic_error("No pipeline is set to VideoProcessingServer!");
+  }
+
+  using namespace std::placeholders;
+  server_ = rclcpp_action::create_server<ProcessVideo>(this, "/openvino_toolkit/process_video",
+      std::bind(&VideoProcessingServer::handleGoal, this, _1, _2),
+      std::bind(&VideoProcessingServer::handleCancel, this, _1),
+      std::bind(&VideoProcessingServer::handleAccepted, this, _1));
+  slog::info << "Processing the videos with " << pipelines_.size() << " pipelines" << slog::endl;
+}
+
+VideoProcessingServer::~VideoProcessingServer()
+{
+  std::vector<std::thread> jobs;
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    stopping_ = true;
+    jobs.swap(jobs_);
+  }
+  for (auto & job : jobs) {
+    job.join();
+  }
+}
+
+rclcpp_action::GoalResponse VideoProcessingServer::handleGoal(
+  const rclcpp_action::GoalUUID &, std::shared_ptr<const ProcessVideo::Goal> goal)
+{
+  if (pipelines_.find(goal->pipeline) == pipelines_.end()) {
+    slog::err << "[VideoProcessingServer] Unknown pipeline: " << goal->pipeline << slog::endl;
+    return rclcpp_action::GoalResponse::REJECT;
+  }
+  if (goal->uri.empty()) {
+    slog::err << "[VideoProcessingServer] No video to process" << slog::endl;
+    return rclcpp_action::GoalResponse::REJECT;
+  }
+  std::lock_guard<std::mutex> lk(mutex_);
+  if (stopping_) {
+    return rclcpp_action::GoalResponse::REJECT;
+  }
+  return rclcpp_action::GoalResponse::ACCEPT_AND_EXECUTE;
+}
+
+rclcpp_action::CancelResponse VideoProcessingServer::handleCancel(
+  const std::shared_ptr<GoalHandle>)
+{
+  // the job stops before its next frame
+  return rclcpp_action::CancelResponse::ACCEPT;
+}
+
+void VideoProcessingServer::handleAccepted(const std::shared_ptr<GoalHandle> goal_handle)
+{
+  // a job runs for the whole video, it can't hold the executor thread
+  std::lock_guard<std::mutex> lk(mutex_);
+  jobs_.emplace_back(&VideoProcessingServer::execute, this, goal_handle);
+}
+
+Params::ParamManager::PipelineRawData VideoProcessingServer::getJobParams(
+  const Params::ParamManager::PipelineRawData & params, const ProcessVideo::Goal & goal)
+{
+  auto job = params;
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    job.name = params.name + "_job_" + std::to_string(next_job_++);
+  }
+  std::multimap<std::string, std::string> connects;
+  for (auto & connect : params.connects) {
+    bool from_input = std::find(params.inputs.begin(), params.inputs.end(), connect.first) !=
+      params.inputs.end();
+    bool to_output = std::find(params.outputs.begin(), params.outputs.end(), connect.second) !=
+      params.outputs.end();
+    if (to_output) {
+      continue;
+    }
+    std::string left = from_input ? kInputType_Video : connect.first;
+    bool found = std::any_of(connects.begin(), connects.end(),
+        [&left, &connect](const std::pair<const std::string, std::string> & existing) {
+          return existing.first == left && existing.second == connect.second;
+        });
+    if (!found) {
+      connects.emplace(left, connect.second);
+    }
+  }
+  job.connects = connects;
+  job.inputs = {kInputType_Video};
+  job.input_metas.clear();
+  // no realtime pacing, the frames are processed as fast as they are decoded
+  job.input_meta = goal.uri + ",pacing=fast";
+  if (goal.segments > 1) {
+    job.input_meta += ",segments=" + std::to_string(goal.segments);
+  }
+  job.input_rois.clear();
+  job.outputs.clear();
+  job.output_rates.clear();
+  job.frame_policy = kFramePolicy_All;
+  job.instances = 1;
+  job.lazy = false;
+  job.idle_unload = 0;
+  return job;
+}
+
+void VideoProcessingServer::execute(const std::shared_ptr<GoalHandle> goal_handle)
+{
+  auto goal = goal_handle->get_goal();
+  auto & params = pipelines_.at(goal->pipeline);
+  auto job_params = getJobParams(params, *goal);
+  auto result = std::make_shared<ProcessVideo::Result>();
+  slog::info << "[VideoProcessingServer] Processing " << goal->uri << " with " <<
+    job_params.name << slog::endl;
+
+  std::shared_ptr<Pipeline> pipeline;
+  {
+    std::lock_guard<std::mutex> lk(lifecycle_mutex_);
+    pipeline = PipelineManager::getInstance().createPipeline(job_params);
+  }
+  if (pipeline == nullptr) {
+    result->message = "Failed to create the pipeline " + goal->pipeline + " for " + goal->uri;
+    slog::err << "[VideoProcessingServer] " << result->message << slog::endl;
+    goal_handle->abort(result);
+    return;
+  }
+
+  // the results are taken from the inferences which fed the configured outputs
+  auto output = std::make_shared<JobOutput>(goal->stream_results);
+  pipeline->add(kJobOutputName, output);
+  for (auto & connect : params.connects) {
+    bool to_output = std::find(params.outputs.begin(), params.outputs.end(), connect.second) !=
+      params.outputs.end();
+    bool from_input = std::find(params.inputs.begin(), params.inputs.end(), connect.first) !=
+      params.inputs.end();
+    if (to_output && !from_input) {
+      pipeline->add(connect.first, kJobOutputName);
+    }
+  }
+
+  uint64_t total_frames = Input::VideoDecoder::countFrames(goal->uri);
+  if (goal->max_frames > 0 && (total_frames == 0 || goal->max_frames < total_frames)) {
+    total_frames = goal->max_frames;
+  }
+  auto feedback = std::make_shared<ProcessVideo::Feedback>();
+  feedback->total_frames = total_frames;
+  auto start = std::chrono::steady_clock::now();
+  auto getSeconds = [&start]() {
+      return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+  auto publishFeedback = [&]() {
+      double seconds = getSeconds();
+      feedback->frames = output->getFrames();
+      feedback->progress = total_frames > 0 ?
+        std::min(1.0f, static_cast<float>(feedback->frames) / total_frames) : 0.0f;
+      feedback->fps = seconds > 0 ? static_cast<float>(feedback->frames / seconds) : 0.0f;
+      feedback->results = output->takeResults();
+      goal_handle->publish_feedback(feedback);
+    };
+
+  bool canceled = false;
+  bool stopped = false;
+  auto last_feedback = start;
+  const auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+    std::chrono::duration<double>(feedback_period_));
+  while (rclcpp::ok()) {
+    if (goal_handle->is_canceling()) {
+      canceled = true;
+      break;
+    }
+    {
+      std::lock_guard<std::mutex> lk(mutex_);
+      stopped = stopping_;
+    }
+    if (stopped || pipeline->isExhausted() ||
+      (goal->max_frames > 0 && output->getFrames() >= goal->max_frames))
+    {
+      break;
+    }
+    if (pipeline->waitForFrame(std::chrono::milliseconds(100))) {
+      pipeline->runOnce();
+    }
+    if (std::chrono::steady_clock::now() - last_feedback >= period) {
+      publishFeedback();
+      last_feedback = std::chrono::steady_clock::now();
+    }
+  }
+  // the frames in flight are output before the last feedback
+  pipeline->drain();
+  publishFeedback();
+  {
+    std::lock_guard<std::mutex> lk(lifecycle_mutex_);
+    PipelineManager::getInstance().removePipeline(job_params.name);
+  }
+
+  result->frames = output->getFrames();
+  result->seconds = getSeconds();
+  result->fps = result->seconds > 0 ? result->frames / result->seconds : 0;
+  slog::info << "[VideoProcessingServer] " << job_params.name << " processed " <<
+    result->frames << " frames in " << result->seconds << " s (" << result->fps << " fps)" <<
+    slog::endl;
+  if (canceled) {
+    result->message = "Canceled";
+    goal_handle->canceled(result);
+  } else if (stopped || !rclcpp::ok()) {
+    result->message = "The server is shutting down";
+    goal_handle->abort(result);
+  } else {
+    goal_handle->succeed(result);
+  }
+}
+}  // namespace vino_service
@@ -0,0 +1,220 @@
+// Copyright (c) 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @brief a source file with the SIMD kernels and their dispatch
+ * @file simd_kernels.cpp
+ */
+
+#include <cstdlib>
+#include <string>
+#include "dynamic_vino_lib/utils/simd_kernels.hpp"
+#include "dynamic_vino_lib/slog.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define DYNAMIC_VINO_LIB_SIMD_X86
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define DYNAMIC_VINO_LIB_SIMD_NEON
+#endif
+
+namespace
+{
+using DotProductInt8 = int32_t (*)(const int8_t *, const int8_t *, int);
+
+int32_t dotProductInt8Generic(const int8_t * a, const int8_t * b, int size)
+{
+  int32_t dot = 0;
+  for (int i = 0; i < size; i++) {
+    dot += static_cast<int16_t>(a[i]) * static_cast<int16_t>(b[i]);
+  }
+  return dot;
+}
+
+#ifdef DYNAMIC_VINO_LIB_SIMD_X86
+// the variants are compiled for their instruction set whatever the flags of
+// the build, they are only called once the CPU is known to support it
+
+__attribute__((target("sse4.2")))
+int32_t dotProductInt8Sse42(const int8_t * a, const int8_t * b, int size)
+{
+  __m128i acc = _mm_setzero_si128();
+  int i = 0;
+  for (; i + 16 <= size; i += 16) {
+    __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i));
+    __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i));
+    // sign-extended to int16, then multiplied and added by pairs into int32
+    acc = _mm_add_epi32(acc, _mm_madd_epi16(_mm_cvtepi8_epi16(va), _mm_cvtepi8_epi16(vb)));
+    acc = _mm_add_epi32(acc, _mm_madd_epi16(
+        _mm_cvtepi8_epi16(_mm_srli_si128(va, 8)), _mm_cvtepi8_epi16(_mm_srli_si128(vb, 8))));
+  }
+  acc = _mm_hadd_epi32(acc, acc);
+  acc = _mm_hadd_epi32(acc, acc);
+  return _mm_cvtsi128_si32(acc) + dotProductInt8Generic(a + i, b + i, size - i);
+}
+
+__attribute__((target("avx2")))
+int32_t horizontalAddAvx2(__m256i acc)
+{
+  __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+  sum = _mm_hadd_epi32(sum, sum);
+  sum = _mm_hadd_epi32(sum, sum);
+  return _mm_cvtsi128_si32(sum);
+}
+
+__attribute__((target("avx2")))
+int32_t dotProductInt8Avx2(const int8_t * a, const int8_t * b, int size)
+{
+  __m256i acc = _mm256_setzero_si256();
+  int i = 0;
+  for (; i + 16 <= size; i += 16) {
+    __m256i va = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i)));
+    __m256i vb = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i)));
+    acc = _mm256_add_epi32(acc, _mm256_madd_epi16(va, vb));
+  }
+  return horizontalAddAvx2(acc) + dotProductInt8Generic(a + i, b + i, size - i);
+}
+
+__attribute__((target("avx2,avx512f,avx512bw")))
+int32_t dotProductInt8Avx512(const int8_t * a, const int8_t * b, int size)
+{
+  __m512i acc = _mm512_setzero_si512();
+  int i = 0;
+  for (; i + 32 <= size; i += 32) {
+    __m512i va = _mm512_cvtepi8_epi16(
+      _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i)));
+    __m512i vb = _mm512_cvtepi8_epi16(
+      _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i)));
+    acc = _mm512_add_epi32(acc, _mm512_madd_epi16(va, vb));
+  }
+  // reduced by halves: _mm512_reduce_add_epi32, the cast and the unmasked
+  // extract all warn of an uninitialized variable with GCC 12, the zero-masked
+  // extract does not
+  __m256i sum = _mm256_add_epi32(
+    _mm512_maskz_extracti64x4_epi64(0xF, acc, 0), _mm512_maskz_extracti64x4_epi64(0xF, acc, 1));
+  return horizontalAddAvx2(sum) + dotProductInt8Generic(a + i, b + i, size - i);
+}
+#endif
+
+#ifdef DYNAMIC_VINO_LIB_SIMD_NEON
+int32_t dotProductInt8Neon(const int8_t * a, const int8_t * b, int size)
+{
+  int32x4_t acc = vdupq_n_s32(0);
+  int i = 0;
+  for (; i + 16 <= size; i += 16) {
+    int8x16_t va = vld1q_s8(a + i);
+    int8x16_t vb = vld1q_s8(b + i);
+    // widened to int16 products, then added by pairs into int32
+    acc = vpadalq_s16(acc, vmull_s8(vget_low_s8(va), vget_low_s8(vb)));
+    acc = vpadalq_s16(acc, vmull_s8(vget_high_s8(va), vget_high_s8(vb)));
+  }
+  return vaddvq_s32(acc) + dotProductInt8Generic(a + i, b + i, size - i);
+}
+#endif
+
+CpuIsa detectCpuIsa()
+{
+#ifdef DYNAMIC_VINO_LIB_SIMD_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")) {
+    return CpuIsa::AVX512;
+  }
+  if (__builtin_cpu_supports("avx2")) {
+    return CpuIsa::AVX2;
+  }
+  if (__builtin_cpu_supports("sse4.2")) {
+    return CpuIsa::SSE42;
+  }
+#elif defined(DYNAMIC_VINO_LIB_SIMD_NEON)
+  return CpuIsa::NEON;  // mandatory on ARM64
+#endif
+  return CpuIsa::Generic;
+}
+
+CpuIsa selectCpuIsa()
+{
+  CpuIsa isa = detectCpuIsa();
+  const char * forced = std::getenv("DYNAMIC_VINO_LIB_ISA");
+  if (forced != nullptr) {
+    std::string name = forced;
+    CpuIsa wanted = isa;
+    for (auto candidate : {CpuIsa::Generic, CpuIsa::SSE42, CpuIsa::AVX2, CpuIsa::AVX512,
+        CpuIsa::NEON})
+    {
+      if (name == getCpuIsaName(candidate)) {
+        wanted = candidate;
+      }
+    }
+    // only lowered: a wider set than the CPU's would crash, NEON only stands alone
+    if (wanted == CpuIsa::Generic || (isa != CpuIsa::NEON && wanted < isa)) {
+      isa = wanted;
+    } else if (wanted != isa) {
+      slog::warn << "The CPU does not support " << name << ", DYNAMIC_VINO_LIB_ISA is ignored." <<
+        slog::endl;
+    }
+  }
+  slog::info << "SIMD kernels: " << getCpuIsaName(isa) << " (detected " <<
+    getCpuIsaName(detectCpuIsa()) << ")" << slog::endl;
+  return isa;
+}
+
+DotProductInt8 selectDotProductInt8(CpuIsa isa)
+{
+  switch (isa) {
+#ifdef DYNAMIC_VINO_LIB_SIMD_X86
+    case CpuIsa::AVX512:
+      return dotProductInt8Avx512;
+    case CpuIsa::AVX2:
+      return dotProductInt8Avx2;
+    case CpuIsa::SSE42:
+      return dotProductInt8Sse42;
+#endif
+#ifdef DYNAMIC_VINO_LIB_SIMD_NEON
+    case CpuIsa::NEON:
+      return dotProductInt8Neon;
+#endif
+    default:
+      return dotProductInt8Generic;
+  }
+}
+}  // namespace
+
+CpuIsa getCpuIsa()
+{
+  static const CpuIsa isa = selectCpuIsa();
+  return isa;
+}
+
+const char * getCpuIsaName(CpuIsa isa)
+{
+  switch (isa) {
+    case CpuIsa::SSE42:
+      return "sse4.2";
+    case CpuIsa::AVX2:
+      return "avx2";
+    case CpuIsa::AVX512:
+      return "avx512";
+    case CpuIsa::NEON:
+      return "neon";
+    default:
+      return "generic";
+  }
+}
+
+int32_t dotProductInt8(const int8_t * a, const int8_t * b, int size)
+{
+  static const DotProductInt8 kernel = selectDotProductInt8(getCpuIsa());
+  return kernel(a, b, size);
+}
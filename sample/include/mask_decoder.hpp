@@ -0,0 +1,63 @@
+// Copyright (c) 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MASK_DECODER_HPP_
+#define MASK_DECODER_HPP_
+
+#include <people_msgs/msg/objects_in_masks.hpp>
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+#include "dynamic_vino_lib/utils/mask_codec.hpp"
+
+/**
+* \brief Rebuilds the class maps of the segmentation messages, keyframes or
+* deltas, keeping the last map of each object as the reference of the deltas.
+*/
+class MaskDecoder
+{
+public:
+  /**
+  * \brief Decode the masks of a message into class maps (CV_16UC1).
+  * \return False while waiting for a keyframe, after a lost message.
+  */
+  bool decode(const people_msgs::msg::ObjectsInMasks & message, std::vector<cv::Mat> & class_maps)
+  {
+    const auto & objects = message.objects_vector;
+    maps_.resize(objects.size());
+    bool complete = true;
+    for (size_t i = 0; i < objects.size(); i++) {
+      const auto & object = objects[i];
+      if (object.mask_encoding.empty()) {
+        // raw class ids
+        cv::Mat(object.mask_height, object.mask_width, CV_32F,
+          const_cast<float *>(object.mask_array.data())).convertTo(maps_[i], CV_16U);
+        continue;
+      }
+      if (!decodeMaskRuns(object.mask_encoding, object.mask_width, object.mask_height,
+        object.mask_runs, maps_[i]))
+      {
+        maps_[i].release();
+        complete = false;
+      }
+    }
+    class_maps = maps_;
+    return complete;
+  }
+
+private:
+  std::vector<cv::Mat> maps_;
+};
+
+#endif  // MASK_DECODER_HPP_
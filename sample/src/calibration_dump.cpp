@@ -0,0 +1,317 @@
+// Copyright (c) 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+* \brief An offline tool dumping the calibration data of the INT8 models of
+ * the pipelines of a parameter file. The pipelines are fed by a recorded
+ * video, without any output, and the input tensors of every inference are
+ * recorded as its network sees them (the crops of the cascades included).
+ * A POT config quantizing each model on its samples is written next to them.
+* \file sample/calibration_dump.cpp
+*/
+
+#include <rclcpp/rclcpp.hpp>
+#include <vino_param_lib/param_manager.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "dynamic_vino_lib/pipeline.hpp"
+#include "dynamic_vino_lib/pipeline_manager.hpp"
+#include "dynamic_vino_lib/pipeline_params.hpp"
+#include "dynamic_vino_lib/slog.hpp"
+#include "dynamic_vino_lib/utils/tensor_dump.hpp"
+
+namespace
+{
+struct Options
+{
+  std::string config;
+  std::string video;
+  std::string output = "calibration";  // directory of the samples and the POT configs
+  size_t samples = 300;  // samples recorded per inference at most
+  uint64_t frames = 0;  // frames processed per pipeline at most, 0 for the whole video
+  std::string preset = "performance";  // POT DefaultQuantization preset, or "mixed"
+};
+
+std::atomic<bool> interrupted{false};
+
+void signalHandler(int)
+{
+  interrupted = true;
+}
+
+void showUsage(const std::string & prog)
+{
+  std::cout << std::endl;
+  std::cout << prog << " [OPTION]" << std::endl;
+  std::cout << "Options:" << std::endl;
+  std::cout << std::endl;
+  std::cout << "    -config \"<path>\"         Absolute path of parameter config file." <<
+    std::endl;
+  std::cout << "    -video \"<path>\"          Recorded video fed to all the pipelines." <<
+    std::endl;
+  std::cout << "    -output \"<path>\"         Directory of the calibration data, " <<
+    "calibration by default." << std::endl;
+  std::cout << "    -samples <N>             Samples recorded per inference, 300 by default." <<
+    std::endl;
+  std::cout << "    -frames <N>              Stop after N frames per pipeline." << std::endl;
+  std::cout << "    -preset <name>           POT quantization preset, performance " <<
+    "(default) or mixed." << std::endl;
+}
+
+bool parseOptions(int argc, char * argv[], Options & options)
+{
+  for (int i = 1; i + 1 < argc; i += 2) {
+    std::string arg = argv[i];
+    if (arg.size() > 2 && arg[0] == '-' && arg[1] == '-') {
+      arg = arg.substr(1);
+    }
+    std::string value = argv[i + 1];
+    if (arg == "-config") {
+      options.config = value;
+    } else if (arg == "-video") {
+      options.video = value;
+    } else if (arg == "-output") {
+      options.output = value;
+    } else if (arg == "-samples") {
+      options.samples = std::stoul(value);
+    } else if (arg == "-frames") {
+      options.frames = std::stoull(value);
+    } else if (arg == "-preset") {
+      options.preset = value;
+    } else {
+      return false;
+    }
+  }
+  return argc % 2 == 1 && !options.config.empty() && !options.video.empty();
+}
+
+/**
+ * @brief Feed the pipeline by the video and drop its outputs. Every frame and
+ * every ROI is inferred by the configured model, preprocessed by OpenCV so
+ * that the recorded blobs hold the resized tensors.
+ */
+void configureForCalibration(Params::ParamManager::PipelineRawData & params)
+{
+  std::multimap<std::string, std::string> connects;
+  for (auto & connect : params.connects) {
+    bool from_input = std::find(params.inputs.begin(), params.inputs.end(), connect.first) !=
+      params.inputs.end();
+    bool to_output = std::find(params.outputs.begin(), params.outputs.end(), connect.second) !=
+      params.outputs.end();
+    if (to_output) {
+      continue;
+    }
+    std::string left = from_input ? kInputType_Video : connect.first;
+    bool found = std::any_of(connects.begin(), connects.end(),
+        [&left, &connect](const std::pair<const std::string, std::string> & existing) {
+          return existing.first == left && existing.second == connect.second;
+        });
+    if (!found) {
+      connects.emplace(left, connect.second);
+    }
+  }
+  params.connects = connects;
+  params.inputs = {kInputType_Video};
+  params.input_metas.clear();
+  params.input_rois.clear();
+  params.outputs.clear();
+  params.output_rates.clear();
+  params.instances = 1;
+  params.lazy = false;
+  params.idle_unload = 0;
+  for (auto & infer : params.infers) {
+    infer.preprocess = "opencv";
+    infer.cache_interval = 0;
+    infer.detect_interval = 1;
+    infer.variants.clear();
+    infer.fallback_engine.clear();
+  }
+}
+
+std::string quote(const std::string & value)
+{
+  std::string quoted = "\"";
+  for (char c : value) {
+    if (c == '"' || c == '\\') {
+      quoted += '\\';
+    }
+    quoted += c;
+  }
+  return quoted + "\"";
+}
+
+std::string getDevice(const std::string & engine)
+{
+  if (engine.compare(0, 3, "CPU") == 0) {
+    return "CPU";
+  }
+  if (engine.compare(0, 3, "GPU") == 0) {
+    return "GPU";
+  }
+  return "ANY";
+}
+
+/**
+ * @brief Write the POT config quantizing the model of an inference on its
+ * samples, read by the simplified engine of POT when they are images.
+ */
+void writePotConfig(
+  const std::string & path, const Params::ParamManager::InferenceRawData & infer,
+  const std::string & data_source, size_t samples, const Options & options)
+{
+  std::string model = infer.model;
+  std::string stem = model.substr(model.find_last_of('/') + 1);
+  stem = stem.substr(0, stem.find_last_of('.'));
+  std::string weights = model.substr(0, model.find_last_of('.')) + ".bin";
+
+  std::ofstream out(path);
+  if (!out) {
+    throw std::runtime_error("Failed to write the POT config into " + path);
+  }
+  out << "{" << std::endl;
+  out << "  \"model\": {" << std::endl;
+  out << "    \"model_name\": " << quote(stem + "_int8") << "," << std::endl;
+  out << "    \"model\": " << quote(model) << "," << std::endl;
+  out << "    \"weights\": " << quote(weights) << std::endl;
+  out << "  }," << std::endl;
+  out << "  \"engine\": {" << std::endl;
+  out << "    \"type\": \"simplified\"," << std::endl;
+  out << "    \"data_source\": " << quote(data_source) << std::endl;
+  out << "  }," << std::endl;
+  out << "  \"compression\": {" << std::endl;
+  out << "    \"target_device\": " << quote(getDevice(infer.engine)) << "," << std::endl;
+  out << "    \"algorithms\": [" << std::endl;
+  out << "      {" << std::endl;
+  out << "        \"name\": \"DefaultQuantization\"," << std::endl;
+  out << "        \"params\": {\"preset\": " << quote(options.preset) <<
+    ", \"stat_subset_size\": " << samples << "}" << std::endl;
+  out << "      }" << std::endl;
+  out << "    ]" << std::endl;
+  out << "  }" << std::endl;
+  out << "}" << std::endl;
+}
+
+/**
+ * @brief Whether every inference of the pipelines recorded all its samples.
+ */
+bool isDumpFull(
+  const std::vector<Params::ParamManager::PipelineRawData> & params, TensorDump & dump,
+  const Options & options)
+{
+  for (auto & pipeline : params) {
+    for (auto & infer : pipeline.infers) {
+      if (dump.getSamples(pipeline.name + "/" + infer.name) < options.samples) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+}  // namespace
+
+int main(int argc, char * argv[])
+{
+  rclcpp::init(argc, argv);
+  rclcpp::Node::SharedPtr main_node = rclcpp::Node::make_shared("openvino_calibration_dump");
+  signal(SIGINT, signalHandler);
+
+  try {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+      showUsage(argv[0]);
+      throw std::runtime_error("Config File and Video are not correctly set.");
+    }
+    Params::ParamManager::getInstance().parse(options.config);
+    auto params = Params::ParamManager::getInstance().getPipelines();
+    if (params.size() < 1) {
+      throw std::logic_error("Pipeline parameters should be set!");
+    }
+    for (auto & pipeline : params) {
+      configureForCalibration(pipeline);
+      pipeline.input_meta = options.video + ",pacing=fast";
+    }
+
+    auto dump = std::make_shared<TensorDump>(options.output, options.samples);
+    auto pipelines = PipelineManager::getInstance().createPipelines(params, main_node);
+    pipelines.erase(std::remove(pipelines.begin(), pipelines.end(), nullptr), pipelines.end());
+    if (pipelines.size() != params.size()) {
+      throw std::runtime_error("Not all the pipelines are created.");
+    }
+    for (size_t p = 0; p < pipelines.size(); p++) {
+      for (auto & infer : params[p].infers) {
+        auto inference = pipelines[p]->getInference(infer.name);
+        if (inference != nullptr) {
+          inference->setTensorDump(dump, params[p].name + "/" + infer.name);
+        }
+      }
+    }
+
+    PipelineManager::getInstance().runAll();
+    while (PipelineManager::getInstance().isAnyRunning() && !interrupted) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      bool done = options.samples > 0 && isDumpFull(params, *dump, options);
+      if (options.frames > 0) {
+        done = done || std::all_of(pipelines.begin(), pipelines.end(),
+            [&options](const std::shared_ptr<Pipeline> & pipeline) {
+              for (auto & stats : pipeline->getLatencyStats()) {
+                if (stats.stage == "frame") {
+                  return stats.count >= options.frames;
+                }
+              }
+              return false;
+            });
+      }
+      if (done) {
+        break;
+      }
+    }
+    PipelineManager::getInstance().stopAll();
+    PipelineManager::getInstance().joinAll();
+
+    for (size_t p = 0; p < pipelines.size(); p++) {
+      for (auto & infer : params[p].infers) {
+        std::string name = params[p].name + "/" + infer.name;
+        size_t samples = dump->getSamples(name);
+        if (samples == 0) {
+          slog::warn << "No sample recorded for " << name << ", e.g. no ROI reached it." <<
+            slog::endl;
+          continue;
+        }
+        std::string directory = dump->getDirectory(name);
+        writePotConfig(directory + ".json", infer, directory, samples, options);
+        slog::info << name << ": " << samples << " samples in " << directory <<
+          ", POT config " << directory << ".json" << slog::endl;
+      }
+    }
+    rclcpp::shutdown();
+  } catch (const std::exception & error) {
+    slog::err << error.what() << slog::endl;
+    return -2;
+  } catch (...) {
+    slog::err << "Unknown/internal exception happened." << slog::endl;
+    return -3;
+  }
+
+  return 0;
+}
@@ -0,0 +1,356 @@
+// Copyright (c) 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+* \brief The engine daemon of a host, running the inferences of the pipelines
+ * of the worker processes (see pipeline_workers) whose engine is SHM:<device>.
+ * Each network is loaded once for all the workers using it, their requests
+ * run on the streams of the same executable network; the tensors are in
+ * memory shared with the workers. A crashed worker only closes its requests.
+* \file sample/engine_daemon.cpp
+*/
+
+#include <inference_engine.hpp>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <atomic>
+#include <condition_variable>
+#include <csignal>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+
+#include "dynamic_vino_lib/engines/engine_manager.hpp"
+#include "dynamic_vino_lib/engines/request_backend.hpp"
+#include "dynamic_vino_lib/engines/shm_channel.hpp"
+#include "dynamic_vino_lib/slog.hpp"
+
+namespace
+{
+namespace ShmChannel = Engines::ShmChannel;
+
+struct Options
+{
+  std::string socket = ShmChannel::kDefaultSocket;
+  std::string streams = "CPU_THROUGHPUT_AUTO";  // CPU_THROUGHPUT_STREAMS of the CPU networks
+};
+
+std::atomic<bool> interrupted{false};
+
+void signalHandler(int)
+{
+  interrupted = true;
+}
+
+void showUsage(const std::string & prog)
+{
+  std::cout << std::endl;
+  std::cout << prog << " [OPTION]" << std::endl;
+  std::cout << "Options:" << std::endl;
+  std::cout << std::endl;
+  std::cout << "    -socket \"<path>\"         Unix socket listened on, " <<
+    ShmChannel::kDefaultSocket << " by default." << std::endl;
+  std::cout << "    -streams <N>             Streams of the networks loaded on CPU, " <<
+    "CPU_THROUGHPUT_AUTO by default." << std::endl;
+}
+
+bool parseOptions(int argc, char * argv[], Options & options)
+{
+  for (int i = 1; i + 1 < argc; i += 2) {
+    std::string arg = argv[i];
+    if (arg.size() > 2 && arg[0] == '-' && arg[1] == '-') {
+      arg = arg.substr(1);
+    }
+    std::string value = argv[i + 1];
+    if (arg == "-socket") {
+      options.socket = value;
+    } else if (arg == "-streams") {
+      options.streams = value;
+    } else {
+      return false;
+    }
+  }
+  return argc % 2 == 1;
+}
+
+/**
+ * @brief The networks loaded, shared by the requests of all the workers for
+ * the same model, device and tensors, and unloaded with the last one.
+ */
+class NetworkCache
+{
+public:
+  explicit NetworkCache(const Options & options)
+  : options_(options) {}
+
+  std::shared_ptr<InferenceEngine::ExecutableNetwork> get(
+    const ShmChannel::Hello & hello, const ShmChannel::SegmentHeader & header)
+  {
+    std::string model = hello.model;
+    std::string device = hello.device;
+    std::string key = model + "|" + device;
+    for (uint32_t i = 0; i < header.tensor_count; i++) {
+      auto & tensor = header.tensors[i];
+      key += "|" + std::string(tensor.name) + ":" + std::to_string(tensor.precision) + ":" +
+        std::to_string(tensor.layout);
+      for (uint32_t d = 0; d < tensor.rank; d++) {
+        key += "," + std::to_string(tensor.dims[d]);
+      }
+    }
+    // the workers asking for a network being loaded wait for it
+    std::lock_guard<std::mutex> lk(mutex_);
+    auto network = networks_[key].lock();
+    if (network == nullptr) {
+      network = load(model, device, header);
+      networks_[key] = network;
+    }
+    return network;
+  }
+
+private:
+  std::shared_ptr<InferenceEngine::ExecutableNetwork> load(
+    const std::string & model, const std::string & device,
+    const ShmChannel::SegmentHeader & header)
+  {
+    auto & core = Engines::EngineManager::getCore();
+    auto network = core.ReadNetwork(model);
+    auto inputs = network.getInputsInfo();
+    auto outputs = network.getOutputsInfo();
+    InferenceEngine::ICNNNetwork::InputShapes shapes = network.getInputShapes();
+    bool reshape = false;
+    for (uint32_t i = 0; i < header.tensor_count; i++) {
+      auto & tensor = header.tensors[i];
+      auto precision = InferenceEngine::Precision(
+        static_cast<InferenceEngine::Precision::ePrecision>(tensor.precision));
+      auto layout = static_cast<InferenceEngine::Layout>(tensor.layout);
+      InferenceEngine::SizeVector dims(tensor.dims, tensor.dims + tensor.rank);
+      if (tensor.input) {
+        auto input = inputs.find(tensor.name);
+        if (input == inputs.end()) {
+          throw std::logic_error("No input " + std::string(tensor.name) + " in " + model);
+        }
+        input->second->setPrecision(precision);
+        input->second->setLayout(layout);
+        if (shapes[tensor.name] != dims) {
+          shapes[tensor.name] = dims;
+          reshape = true;
+        }
+      } else {
+        auto output = outputs.find(tensor.name);
+        if (output == outputs.end()) {
+          throw std::logic_error("No output " + std::string(tensor.name) + " in " + model);
+        }
+        output->second->setPrecision(precision);
+        output->second->setLayout(layout);
+      }
+    }
+    // e.g. the batch size set by the worker
+    if (reshape) {
+      network.reshape(shapes);
+    }
+    std::map<std::string, std::string> config;
+    if (device == "CPU") {
+      config[InferenceEngine::PluginConfigParams::KEY_CPU_THROUGHPUT_STREAMS] = options_.streams;
+    }
+    auto loaded = std::make_shared<InferenceEngine::ExecutableNetwork>(
+      core.LoadNetwork(network, device, config));
+    slog::info << "Loaded " << model << " on " << device << slog::endl;
+    return loaded;
+  }
+
+  const Options & options_;
+  std::mutex mutex_;
+  std::map<std::string, std::weak_ptr<InferenceEngine::ExecutableNetwork>> networks_;
+};
+
+/**
+ * @brief Serve the request of a worker until it closes the connection.
+ */
+void serve(int fd, NetworkCache & cache)
+{
+  ShmChannel::Hello hello;
+  int segment_fd = -1;
+  if (!ShmChannel::receiveWithFd(fd, &hello, sizeof(hello), segment_fd) || segment_fd < 0) {
+    return;
+  }
+  hello.model[sizeof(hello.model) - 1] = '\0';
+  hello.device[sizeof(hello.device) - 1] = '\0';
+  ShmChannel::Message reply = {ShmChannel::kFailed, 0};
+  struct stat status;
+  void * segment = MAP_FAILED;
+  if (hello.magic == ShmChannel::kMagic && hello.version == ShmChannel::kVersion &&
+    ::fstat(segment_fd, &status) == 0 &&
+    static_cast<uint64_t>(status.st_size) >= hello.segment_bytes &&
+    hello.segment_bytes >= ShmChannel::getDataOffset())
+  {
+    segment = ::mmap(nullptr, hello.segment_bytes, PROT_READ | PROT_WRITE, MAP_SHARED,
+        segment_fd, 0);
+  }
+  ::close(segment_fd);
+  if (segment == MAP_FAILED) {
+    slog::warn << "Refused a worker with an invalid segment" << slog::endl;
+    ShmChannel::sendAll(fd, &reply, sizeof(reply));
+    return;
+  }
+
+  std::shared_ptr<InferenceEngine::ExecutableNetwork> network;
+  InferenceEngine::InferRequest request;
+  try {
+    // a copy, the worker can't change the tensors once validated
+    auto header = std::make_shared<ShmChannel::SegmentHeader>(
+      *static_cast<ShmChannel::SegmentHeader *>(segment));
+    if (header->magic != ShmChannel::kMagic || header->tensor_count > ShmChannel::kMaxTensors) {
+      throw std::logic_error("invalid segment header");
+    }
+    for (uint32_t i = 0; i < header->tensor_count; i++) {
+      auto & tensor = header->tensors[i];
+      tensor.name[sizeof(tensor.name) - 1] = '\0';
+      if (tensor.rank > ShmChannel::kMaxDims || tensor.offset < ShmChannel::getDataOffset() ||
+        tensor.offset + tensor.bytes > hello.segment_bytes)
+      {
+        throw std::logic_error("the tensor " + std::string(tensor.name) + " is out of the segment");
+      }
+    }
+    network = cache.get(hello, *header);
+    request = network->CreateInferRequest();
+    for (uint32_t i = 0; i < header->tensor_count; i++) {
+      auto & tensor = header->tensors[i];
+      InferenceEngine::TensorDesc desc(
+        InferenceEngine::Precision(
+          static_cast<InferenceEngine::Precision::ePrecision>(tensor.precision)),
+        InferenceEngine::SizeVector(tensor.dims, tensor.dims + tensor.rank),
+        static_cast<InferenceEngine::Layout>(tensor.layout));
+      uint64_t bytes = desc.getPrecision().size();
+      for (auto dim : desc.getDims()) {
+        bytes *= dim;
+      }
+      if (bytes != tensor.bytes) {
+        throw std::logic_error("the tensor " + std::string(tensor.name) + " has a wrong size");
+      }
+      auto memory = static_cast<uint8_t *>(segment) + tensor.offset;
+      request.SetBlob(tensor.name, Engines::RequestBackend::wrapBlob(desc, memory));
+    }
+    reply.type = ShmChannel::kDone;
+  } catch (const std::exception & e) {
+    slog::err << "Failed to run " << hello.model << " on " << hello.device << ": " << e.what() <<
+      slog::endl;
+  }
+
+  bool connected = ShmChannel::sendAll(fd, &reply, sizeof(reply));
+  ShmChannel::Message message;
+  while (connected && reply.type == ShmChannel::kDone &&
+    ShmChannel::receiveAll(fd, &message, sizeof(message)))
+  {
+    if (message.type != ShmChannel::kRun) {
+      break;
+    }
+    try {
+      request.Infer();
+      reply.type = ShmChannel::kDone;
+    } catch (const std::exception & e) {
+      slog::warn << "Inference of " << hello.model << " failed: " << e.what() << slog::endl;
+      reply.type = ShmChannel::kFailed;
+    }
+    reply.batch = message.batch;
+    connected = ShmChannel::sendAll(fd, &reply, sizeof(reply));
+  }
+  // the request goes before the network it belongs to
+  request = InferenceEngine::InferRequest();
+  network.reset();
+  ::munmap(segment, hello.segment_bytes);
+}
+}  // namespace
+
+int main(int argc, char * argv[])
+{
+  signal(SIGINT, signalHandler);
+  signal(SIGTERM, signalHandler);
+
+  int listener = -1;
+  Options options;
+  try {
+    if (!parseOptions(argc, argv, options)) {
+      showUsage(argv[0]);
+      throw std::runtime_error("The options are not correctly set.");
+    }
+    struct sockaddr_un address;
+    if (!ShmChannel::makeAddress(options.socket, address)) {
+      throw std::runtime_error("The socket path " + options.socket + " is too long.");
+    }
+    listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    // the socket left by a daemon which did not stop
+    ::unlink(options.socket.c_str());
+    if (listener < 0 ||
+      ::bind(listener, reinterpret_cast<struct sockaddr *>(&address), sizeof(address)) != 0 ||
+      ::listen(listener, 64) != 0)
+    {
+      throw std::runtime_error("Failed to listen on " + options.socket + ": " +
+              std::strerror(errno));
+    }
+    slog::info << "Engine daemon listening on " << options.socket << slog::endl;
+
+    NetworkCache cache(options);
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::set<int> clients;
+    while (!interrupted) {
+      struct pollfd ready = {listener, POLLIN, 0};
+      if (::poll(&ready, 1, 200) <= 0) {
+        continue;
+      }
+      int fd = ::accept(listener, nullptr, nullptr);
+      if (fd < 0) {
+        continue;
+      }
+      {
+        std::lock_guard<std::mutex> lk(mutex);
+        clients.insert(fd);
+      }
+      std::thread([fd, &cache, &mutex, &cv, &clients]() {
+          serve(fd, cache);
+          std::lock_guard<std::mutex> lk(mutex);
+          clients.erase(fd);
+          ::close(fd);
+          cv.notify_all();
+        }).detach();
+    }
+    {
+      // the requests waiting for the workers end
+      std::unique_lock<std::mutex> lk(mutex);
+      for (int fd : clients) {
+        ::shutdown(fd, SHUT_RDWR);
+      }
+      cv.wait(lk, [&clients]() {return clients.empty();});
+    }
+    ::close(listener);
+    ::unlink(options.socket.c_str());
+  } catch (const std::exception & error) {
+    slog::err << error.what() << slog::endl;
+    return -2;
+  } catch (...) {
+    slog::err << "Unknown/internal exception happened." << slog::endl;
+    return -3;
+  }
+
+  return 0;
+}
@@ -18,27 +18,85 @@
 #include <rclcpp/rclcpp.hpp>
 #include <string>
 #include <memory>
+#include <vector>
 
+#include "dynamic_vino_lib/services/detection_client.hpp"
 #include "dynamic_vino_lib/services/frame_processing_server.hpp"
 
+namespace
+{
+void showObjects(
+  const rclcpp::Node::SharedPtr & node, const std::string & image_path,
+  const object_msgs::srv::DetectObject::Response & srv, bool display)
+{
+  RCLCPP_INFO(node->get_logger(), "%s: %zu objects", image_path.c_str(),
+    srv.objects.objects_vector.size());
+  cv::Mat image = display ? cv::imread(image_path) : cv::Mat();
+  int width = image.cols;
+  int height = image.rows;
+
+  for (unsigned int i = 0; i < srv.objects.objects_vector.size(); i++) {
+    std::stringstream ss;
+    ss << srv.objects.objects_vector[i].object.object_name << ": " <<
+      srv.objects.objects_vector[i].object.probability * 100 << "%";
+    RCLCPP_INFO(node->get_logger(), "%d: object: %s", i,
+      srv.objects.objects_vector[i].object.object_name.c_str());
+    RCLCPP_INFO(node->get_logger(), "prob: %f",
+      srv.objects.objects_vector[i].object.probability);
+    RCLCPP_INFO(
+      node->get_logger(), "location: (%d, %d, %d, %d)",
+      srv.objects.objects_vector[i].roi.x_offset, srv.objects.objects_vector[i].roi.y_offset,
+      srv.objects.objects_vector[i].roi.width, srv.objects.objects_vector[i].roi.height);
+    if (image.empty()) {
+      continue;
+    }
+
+    int xmin = srv.objects.objects_vector[i].roi.x_offset;
+    int ymin = srv.objects.objects_vector[i].roi.y_offset;
+    int w = srv.objects.objects_vector[i].roi.width;
+    int h = srv.objects.objects_vector[i].roi.height;
+
+    int xmax = ((xmin + w) < width) ? (xmin + w) : width;
+    int ymax = ((ymin + h) < height) ? (ymin + h) : height;
+
+    cv::Point left_top = cv::Point(xmin, ymin);
+    cv::Point right_bottom = cv::Point(xmax, ymax);
+    cv::rectangle(image, left_top, right_bottom, cv::Scalar(0, 255, 0), 1, 8, 0);
+    cv::rectangle(image, cv::Point(xmin, ymin), cv::Point(xmax, ymin + 20), cv::Scalar(0, 255, 0),
+      -1);
+    cv::putText(image, ss.str(), cv::Point(xmin + 5, ymin + 20), cv::FONT_HERSHEY_PLAIN, 1,
+      cv::Scalar(0, 0, 255), 1);
+  }
+  if (!image.empty()) {
+    cv::imshow("image_detection", image);
+    cv::waitKey(0);
+  }
+}
+}  // namespace
+
 int main(int argc, char ** argv)
 {
   rclcpp::init(argc, argv);
 
   auto node = rclcpp::Node::make_shared("service_example_for_object");
-  if (argc != 2) {
+  if (argc < 2) {
     RCLCPP_INFO(node->get_logger(), "Usage: ros2 run dynamic_vino_sample image_object_client"
-      "<image_path>");
+      " <image_path> [<image_path> ...]");
     return -1;
   }
 
-  std::string image_path = argv[1];
-  auto client = node->create_client<object_msgs::srv::DetectObject>("/openvino_toolkit/service");
-  auto request = std::make_shared<object_msgs::srv::DetectObject::Request>();
-
-  request->image_path = image_path;
+  // the images are all sent at once, the server processes them concurrently
+  vino_service::DetectionClient<object_msgs::srv::DetectObject> client(
+    node, "/openvino_toolkit/service");
+  std::vector<std::string> image_paths(argv + 1, argv + argc);
+  std::vector<std::shared_ptr<object_msgs::srv::DetectObject::Request>> requests;
+  for (auto & image_path : image_paths) {
+    auto request = std::make_shared<object_msgs::srv::DetectObject::Request>();
+    request->image_path = image_path;
+    requests.push_back(request);
+  }
 
-  while (!client->wait_for_service(std::chrono::seconds(1))) {
+  while (!client.waitForService(std::chrono::seconds(1))) {
     if (!rclcpp::ok()) {
       RCLCPP_ERROR(node->get_logger(), "Interrupted while waiting for the service. Exiting.");
       return 1;
@@ -46,46 +104,18 @@ int main(int argc, char ** argv)
     RCLCPP_INFO(node->get_logger(), "service not available, waiting again...");
   }
 
-  auto result = client->async_send_request(request);
-  if (rclcpp::spin_until_future_complete(node, result) ==
-    rclcpp::FutureReturnCode::SUCCESS)
-  {
-    auto srv = result.get();
-
-    cv::Mat image = cv::imread(image_path);
-    int width = image.cols;
-    int height = image.rows;
-
-    for (unsigned int i = 0; i < srv->objects.objects_vector.size(); i++) {
-      std::stringstream ss;
-      ss << srv->objects.objects_vector[i].object.object_name << ": " <<
-        srv->objects.objects_vector[i].object.probability * 100 << "%";
-      RCLCPP_INFO(node->get_logger(), "%d: object: %s", i,
-        srv->objects.objects_vector[i].object.object_name.c_str());
-      RCLCPP_INFO(node->get_logger(), "prob: %f",
-        srv->objects.objects_vector[i].object.probability);
-      RCLCPP_INFO(
-        node->get_logger(), "location: (%d, %d, %d, %d)",
-        srv->objects.objects_vector[i].roi.x_offset, srv->objects.objects_vector[i].roi.y_offset,
-        srv->objects.objects_vector[i].roi.width, srv->objects.objects_vector[i].roi.height);
-
-      int xmin = srv->objects.objects_vector[i].roi.x_offset;
-      int ymin = srv->objects.objects_vector[i].roi.y_offset;
-      int w = srv->objects.objects_vector[i].roi.width;
-      int h = srv->objects.objects_vector[i].roi.height;
-
-      int xmax = ((xmin + w) < width) ? (xmin + w) : width;
-      int ymax = ((ymin + h) < height) ? (ymin + h) : height;
-
-      cv::Point left_top = cv::Point(xmin, ymin);
-      cv::Point right_bottom = cv::Point(xmax, ymax);
-      cv::rectangle(image, left_top, right_bottom, cv::Scalar(0, 255, 0), 1, 8, 0);
-      cv::rectangle(image, cv::Point(xmin, ymin), cv::Point(xmax, ymin + 20), cv::Scalar(0, 255, 0),
-        -1);
-      cv::putText(image, ss.str(), cv::Point(xmin + 5, ymin + 20), cv::FONT_HERSHEY_PLAIN, 1,
-        cv::Scalar(0, 0, 255), 1);
+  auto results = client.sendBatch(requests);
+  for (size_t i = 0; i < results.size(); i++) {
+    if (rclcpp::spin_until_future_complete(node, results[i]) !=
+      rclcpp::FutureReturnCode::SUCCESS)
+    {
+      RCLCPP_WARN(node->get_logger(), "Interrupted while waiting for the responses.");
+      return 1;
+    }
+    try {
+      showObjects(node, image_paths[i], *results[i].get(), image_paths.size() == 1);
+    } catch (const std::exception & error) {
+      RCLCPP_WARN(node->get_logger(), "%s: %s", image_paths[i].c_str(), error.what());
     }
-    cv::imshow("image_detection", image);
-    cv::waitKey(0);
   }
 }
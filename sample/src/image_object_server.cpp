@@ -40,7 +40,10 @@ int main(int argc, char ** argv)
     std::string service_name = "frame_processing_server";
     auto node = std::make_shared<vino_service::FrameProcessingServer
         <object_msgs::srv::DetectObject>>(service_name, config_path);
-    rclcpp::spin(node);
+    // the requests are served concurrently by the instances of the pipeline
+    rclcpp::executors::MultiThreadedExecutor executor;
+    executor.add_node(node);
+    executor.spin();
   } catch (std::exception & e) {
     std::cout << e.what() << std::endl;
   } catch (...) {
@@ -21,27 +21,69 @@
 #include <string>
 #include <memory>
 #include <iomanip>
+#include <vector>
 
+#include "dynamic_vino_lib/services/detection_client.hpp"
 #include "dynamic_vino_lib/services/frame_processing_server.hpp"
 
+namespace
+{
+void showPersons(
+  const rclcpp::Node::SharedPtr & node, const std::string & image_path,
+  const people_msgs::srv::People::Response & people)
+{
+  if (people.persons.emotions.size() == 0 && people.persons.agegenders.size() == 0 &&
+    people.persons.headposes.size() == 0)
+  {
+    RCLCPP_INFO(node->get_logger(), "%s: Get response, but no any person found.",
+      image_path.c_str());
+    return;
+  }
+  RCLCPP_INFO(node->get_logger(), "%s: Found persons...", image_path.c_str());
+
+  for (unsigned int i = 0; i < people.persons.faces.size(); i++) {
+    RCLCPP_INFO(node->get_logger(), "%d: object: %s", i,
+      people.persons.faces[i].object.object_name.c_str());
+    RCLCPP_INFO(node->get_logger(), "prob: %f",
+      people.persons.faces[i].object.probability);
+    RCLCPP_INFO(
+      node->get_logger(), "location: (%d, %d, %d, %d)",
+      people.persons.faces[i].roi.x_offset, people.persons.faces[i].roi.y_offset,
+      people.persons.faces[i].roi.width, people.persons.faces[i].roi.height);
+    RCLCPP_INFO(node->get_logger(), "Emotions: %s",
+      people.persons.emotions[i].emotion.c_str());
+    RCLCPP_INFO(node->get_logger(), "Age: %f, Gender: %s",
+      people.persons.agegenders[i].age, people.persons.agegenders[i].gender.c_str());
+    RCLCPP_INFO(node->get_logger(), "Yaw, Pitch and Roll for head pose is: (%f, %f, %f),",
+      people.persons.headposes[i].yaw, people.persons.headposes[i].pitch,
+      people.persons.headposes[i].roll);
+  }
+}
+}  // namespace
+
 int main(int argc, char ** argv)
 {
   rclcpp::init(argc, argv);
 
   auto node = rclcpp::Node::make_shared("service_example_for_face");
-  if (argc != 2) {
-    RCLCPP_INFO(node->get_logger(), "Usage: ros2 run dynamic_vino_sample image_object_client"
-      "<image_path>");
+  if (argc < 2) {
+    RCLCPP_INFO(node->get_logger(), "Usage: ros2 run dynamic_vino_sample image_people_client"
+      " <image_path> [<image_path> ...]");
     return -1;
   }
 
-  std::string image_path = argv[1];
-
-  auto client = node->create_client<people_msgs::srv::People>("/openvino_toolkit/service");
-  auto request = std::make_shared<people_msgs::srv::People::Request>();
-  request->image_path = image_path;
+  // the images are all sent at once, the server processes them concurrently
+  vino_service::DetectionClient<people_msgs::srv::People> client(
+    node, "/openvino_toolkit/service");
+  std::vector<std::string> image_paths(argv + 1, argv + argc);
+  std::vector<std::shared_ptr<people_msgs::srv::People::Request>> requests;
+  for (auto & image_path : image_paths) {
+    auto request = std::make_shared<people_msgs::srv::People::Request>();
+    request->image_path = image_path;
+    requests.push_back(request);
+  }
 
-  while (!client->wait_for_service(std::chrono::seconds(1))) {
+  while (!client.waitForService(std::chrono::seconds(1))) {
     if (!rclcpp::ok()) {
       RCLCPP_ERROR(node->get_logger(), "Interrupted while waiting for the service. Exiting.");
       return 1;
@@ -49,38 +91,19 @@ int main(int argc, char ** argv)
     RCLCPP_INFO(node->get_logger(), "service not available, waiting again...");
   }
 
-  auto result = client->async_send_request(request);
-
-  if (rclcpp::spin_until_future_complete(node, result) ==
-    rclcpp::FutureReturnCode::SUCCESS)
-  {
-    auto people = result.get();
-    if (people->persons.emotions.size() == 0 && people->persons.agegenders.size() == 0 &&
-      people->persons.headposes.size() == 0)
+  auto results = client.sendBatch(requests);
+  for (size_t i = 0; i < results.size(); i++) {
+    if (rclcpp::spin_until_future_complete(node, results[i]) !=
+      rclcpp::FutureReturnCode::SUCCESS)
     {
-      RCLCPP_INFO(node->get_logger(), "Get response, but no any person found.");
-      return 0;
+      RCLCPP_WARN(node->get_logger(), "Interrupted while waiting for the responses.");
+      return 1;
     }
-    RCLCPP_INFO(node->get_logger(), "Found persons...");
-
-    for (unsigned int i = 0; i < people->persons.faces.size(); i++) {
-      RCLCPP_INFO(node->get_logger(), "%d: object: %s", i,
-        people->persons.faces[i].object.object_name.c_str());
-      RCLCPP_INFO(node->get_logger(), "prob: %f",
-        people->persons.faces[i].object.probability);
-      RCLCPP_INFO(
-        node->get_logger(), "location: (%d, %d, %d, %d)",
-        people->persons.faces[i].roi.x_offset, people->persons.faces[i].roi.y_offset,
-        people->persons.faces[i].roi.width, people->persons.faces[i].roi.height);
-      RCLCPP_INFO(node->get_logger(), "Emotions: %s",
-        people->persons.emotions[i].emotion.c_str());
-      RCLCPP_INFO(node->get_logger(), "Age: %f, Gender: %s",
-        people->persons.agegenders[i].age, people->persons.agegenders[i].gender.c_str());
-      RCLCPP_INFO(node->get_logger(), "Yaw, Pitch and Roll for head pose is: (%f, %f, %f),",
-        people->persons.headposes[i].yaw, people->persons.headposes[i].pitch,
-        people->persons.headposes[i].roll);
+    try {
+      showPersons(node, image_paths[i], *results[i].get());
+    } catch (const std::exception & error) {
+      RCLCPP_WARN(node->get_logger(), "%s: NO response received!! %s", image_paths[i].c_str(),
+        error.what());
     }
-  } else {
-    RCLCPP_WARN(node->get_logger(), "NO response received!!");
   }
 }
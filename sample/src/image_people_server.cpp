@@ -40,7 +40,10 @@ int main(int argc, char ** argv)
   try {
     auto node = std::make_shared<vino_service::FrameProcessingServer
         <people_msgs::srv::People>>("service_people_detection", config_path);
-    rclcpp::spin(node);
+    // the requests are served concurrently by the instances of the pipeline
+    rclcpp::executors::MultiThreadedExecutor executor;
+    executor.add_node(node);
+    executor.spin();
   } catch (std::exception & e) {
     std::cout << e.what() << std::endl;
   } catch (...) {
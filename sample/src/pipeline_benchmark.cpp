@@ -0,0 +1,1123 @@
+// Copyright (c) 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+* \brief An offline benchmark of the pipelines of a parameter file. The
+ * pipelines are fed by a video file, without any output, and their throughput,
+ * stage latencies, CPU usage and inference counts are reported as JSON.
+ * With -tune the batch, streams and infer requests of every inference are
+ * swept instead, and the parameter file is written back with the fastest ones.
+ * With -scale the pipelines are run in 1..N copies, optionally spread over
+ * processes, and the scaling curve of the throughput is reported.
+* \file sample/pipeline_benchmark.cpp
+*/
+
+#include <rclcpp/rclcpp.hpp>
+#include <vino_param_lib/param_manager.hpp>
+#include <yaml-cpp/yaml.h>
+#include <sys/resource.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "dynamic_vino_lib/engines/device_scheduler.hpp"
+#include "dynamic_vino_lib/pipeline.hpp"
+#include "dynamic_vino_lib/pipeline_manager.hpp"
+#include "dynamic_vino_lib/pipeline_params.hpp"
+#include "dynamic_vino_lib/slog.hpp"
+#include "dynamic_vino_lib/utils/process_memory.hpp"
+
+namespace
+{
+struct Options
+{
+  std::string config;
+  std::string video;
+  std::string output = "pipeline_benchmark.json";  // the JSON report file
+  double fps = 0;  // frames processed per second at most, 0 as fast as possible
+  bool realtime = false;  // decode the video at its own rate, like a camera
+  size_t replay = 0;  // frames preloaded and replayed, 0 to decode the video while running
+  size_t loops = 1;  // times the preloaded frames are replayed
+  uint64_t frames = 0;  // frames processed per pipeline at most, 0 for the whole video
+  double duration = 0;  // seconds run at most, 0 for the whole video
+  std::string tune;  // parameter file written with the tuned inferences, empty not to tune
+  std::vector<int> batches = {1, 2, 4};  // swept with -tune
+  std::vector<int> streams = {1, 2, 4};  // swept with -tune, on the CPU and GPU only
+  std::vector<int> requests = {0, 2, 4};  // swept with -tune, 0 for the device's optimal number
+  double max_latency = 0;  // with -tune: bound of the frame p95 in milliseconds, 0 for none
+  std::vector<int> scale;  // copies of the pipelines run at each step, empty not to scale
+  int processes = 1;  // with -scale: processes the copies of a step are spread over
+};
+
+std::atomic<bool> interrupted{false};
+
+void signalHandler(int)
+{
+  interrupted = true;
+}
+
+void showUsage(const std::string & prog)
+{
+  std::cout << std::endl;
+  std::cout << prog << " [OPTION]" << std::endl;
+  std::cout << "Options:" << std::endl;
+  std::cout << std::endl;
+  std::cout << "    -config \"<path>\"         Absolute path of parameter config file." <<
+    std::endl;
+  std::cout << "    -video \"<path>\"          Video file fed to all the pipelines." << std::endl;
+  std::cout << "    -fps <N>                 Frames processed per second at most, " <<
+    "0 (default) as fast as possible." << std::endl;
+  std::cout << "    -realtime                Decode the video at its own rate." << std::endl;
+  std::cout << "    -replay <N>              Preload N frames and replay them, " <<
+    "decoding is not measured." << std::endl;
+  std::cout << "    -loops <N>               Times the preloaded frames are replayed." <<
+    std::endl;
+  std::cout << "    -frames <N>              Stop after N frames per pipeline." << std::endl;
+  std::cout << "    -duration <seconds>      Stop after the given time." << std::endl;
+  std::cout << "    -output \"<path>\"         JSON report file, " <<
+    "pipeline_benchmark.json by default." << std::endl;
+  std::cout << "    -tune \"<path>\"           Sweep the settings of the inferences and " <<
+    "write the config file with the fastest ones." << std::endl;
+  std::cout << "    -batches <N,...>         Batch sizes swept, 1,2,4 by default." << std::endl;
+  std::cout << "    -streams <N,...>         Streams swept on CPU and GPU, 1,2,4 by default." <<
+    std::endl;
+  std::cout << "    -requests <N,...>        Infer requests swept, 0,2,4 by default " <<
+    "(0 for the optimal number)." << std::endl;
+  std::cout << "    -max_latency <ms>        Reject the settings whose frame p95 " <<
+    "exceeds this bound." << std::endl;
+  std::cout << "    -scale <N|N,...>         Run 1..N copies of the pipelines, or the " <<
+    "listed numbers of copies, and report the scaling curve." << std::endl;
+  std::cout << "    -processes <N>           With -scale: spread the copies over N " <<
+    "processes, 1 by default." << std::endl;
+}
+
+std::vector<int> parseList(const std::string & value)
+{
+  std::vector<int> list;
+  std::stringstream stream(value);
+  std::string item;
+  while (std::getline(stream, item, ',')) {
+    if (!item.empty()) {
+      list.push_back(std::stoi(item));
+    }
+  }
+  return list;
+}
+
+bool parseOptions(int argc, char * argv[], Options & options)
+{
+  std::set<std::string> given;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg.size() > 2 && arg[0] == '-' && arg[1] == '-') {
+      arg = arg.substr(1);
+    }
+    if (arg == "-realtime") {
+      options.realtime = true;
+      continue;
+    }
+    if (i + 1 >= argc) {
+      return false;
+    }
+    std::string value = argv[++i];
+    given.insert(arg);
+    if (arg == "-config") {
+      options.config = value;
+    } else if (arg == "-video") {
+      options.video = value;
+    } else if (arg == "-output") {
+      options.output = value;
+    } else if (arg == "-fps") {
+      options.fps = std::stod(value);
+    } else if (arg == "-tune") {
+      options.tune = value;
+    } else if (arg == "-batches") {
+      options.batches = parseList(value);
+    } else if (arg == "-streams") {
+      options.streams = parseList(value);
+    } else if (arg == "-requests") {
+      options.requests = parseList(value);
+    } else if (arg == "-max_latency") {
+      options.max_latency = std::stod(value);
+    } else if (arg == "-replay") {
+      options.replay = std::stoul(value);
+    } else if (arg == "-loops") {
+      options.loops = std::stoul(value);
+    } else if (arg == "-frames") {
+      options.frames = std::stoull(value);
+    } else if (arg == "-duration") {
+      options.duration = std::stod(value);
+    } else if (arg == "-scale") {
+      options.scale = parseList(value);
+      if (options.scale.size() == 1) {
+        int copies = options.scale[0];
+        options.scale.clear();
+        for (int n = 1; n <= copies; n++) {
+          options.scale.push_back(n);
+        }
+      }
+    } else if (arg == "-processes") {
+      options.processes = std::max(1, std::stoi(value));
+    } else {
+      return false;
+    }
+  }
+  if (!options.scale.empty()) {
+    // each step replays the frames from memory for a fixed time, unless told otherwise
+    if (!given.count("-replay")) {
+      options.replay = 100;
+    }
+    if (!given.count("-loops")) {
+      options.loops = 0;
+    }
+    if (!given.count("-duration") && !given.count("-frames")) {
+      options.duration = 10;
+    }
+  }
+  return !options.config.empty() && !options.video.empty();
+}
+
+/**
+ * @brief Feed the pipeline by the video only and drop its outputs, so that
+ * neither decoding other sources nor displaying or publishing is measured.
+ * With 'replay' the frames are decoded before the run and replayed from memory.
+ */
+void configureForBenchmark(Params::ParamManager::PipelineRawData & params, const Options & options)
+{
+  const std::string input = options.replay > 0 ? kInputType_FrameReplay : kInputType_Video;
+  std::multimap<std::string, std::string> connects;
+  for (auto & connect : params.connects) {
+    bool from_input = std::find(params.inputs.begin(), params.inputs.end(), connect.first) !=
+      params.inputs.end();
+    bool to_output = std::find(params.outputs.begin(), params.outputs.end(), connect.second) !=
+      params.outputs.end();
+    if (to_output) {
+      continue;
+    }
+    std::string left = from_input ? input : connect.first;
+    bool found = std::any_of(connects.begin(), connects.end(),
+        [&left, &connect](const std::pair<const std::string, std::string> & existing) {
+          return existing.first == left && existing.second == connect.second;
+        });
+    if (!found) {
+      connects.emplace(left, connect.second);
+    }
+  }
+  params.connects = connects;
+  params.inputs = {input};
+  params.input_metas.clear();
+  if (options.replay > 0) {
+    // the replay paces the frames itself, at the target rate or as fast as read
+    params.input_meta = options.video + ",frames=" + std::to_string(options.replay) +
+      ",loops=" + std::to_string(options.loops) +
+      (options.fps > 0 ? ",fps=" + std::to_string(options.fps) : std::string());
+  } else {
+    params.input_meta = options.video + (options.realtime ? ",pacing=realtime" : ",pacing=fast");
+  }
+  params.input_rois.clear();
+  params.outputs.clear();
+  params.output_rates.clear();
+  params.filters.clear();
+  params.instances = 1;
+  params.lazy = false;
+  params.idle_unload = 0;
+  if (options.fps > 0) {
+    params.frame_policy = kFramePolicy_TargetFps;
+    params.target_fps = static_cast<float>(options.fps);
+  }
+}
+
+LatencyStats::Summary getFrameStats(const std::shared_ptr<Pipeline> & pipeline)
+{
+  for (auto & stats : pipeline->getLatencyStats()) {
+    if (stats.stage == "frame") {
+      return stats;
+    }
+  }
+  return LatencyStats::Summary();
+}
+
+uint64_t getFrameCount(const std::shared_ptr<Pipeline> & pipeline)
+{
+  return getFrameStats(pipeline).count;
+}
+
+double getCpuSeconds(const timeval & time)
+{
+  return time.tv_sec + time.tv_usec / 1e6;
+}
+
+std::string quote(const std::string & value)
+{
+  std::string quoted = "\"";
+  for (char c : value) {
+    if (c == '"' || c == '\\') {
+      quoted += '\\';
+    }
+    quoted += c;
+  }
+  return quoted + "\"";
+}
+
+void writeReport(
+  std::ostream & out, const Options & options,
+  const std::vector<std::shared_ptr<Pipeline>> & pipelines, double seconds,
+  const rusage & usage)
+{
+  double user = getCpuSeconds(usage.ru_utime);
+  double system = getCpuSeconds(usage.ru_stime);
+  out << "{" << std::endl;
+  out << "  \"config\": " << quote(options.config) << "," << std::endl;
+  out << "  \"video\": " << quote(options.video) << "," << std::endl;
+  out << "  \"target_fps\": " << options.fps << "," << std::endl;
+  out << "  \"realtime\": " << (options.realtime ? "true" : "false") << "," << std::endl;
+  out << "  \"replay\": " << options.replay << "," << std::endl;
+  out << "  \"seconds\": " << seconds << "," << std::endl;
+  out << "  \"cpu\": {\"user_seconds\": " << user << ", \"system_seconds\": " << system <<
+    ", \"cores_used\": " << (seconds > 0 ? (user + system) / seconds : 0) <<
+    ", \"cores\": " << std::thread::hardware_concurrency() << "}," << std::endl;
+  out << "  \"memory\": {\"resident\": " << readProcessMemory("VmRSS") <<
+    ", \"peak\": " << readProcessMemory("VmHWM") << "}," << std::endl;
+  out << "  \"pipelines\": [";
+  for (size_t i = 0; i < pipelines.size(); i++) {
+    auto & pipeline = pipelines[i];
+    uint64_t frames = getFrameCount(pipeline);
+    out << (i == 0 ? "" : ",") << std::endl;
+    out << "    {" << std::endl;
+    out << "      \"name\": " << quote(pipeline->getName()) << "," << std::endl;
+    out << "      \"frames\": " << frames << "," << std::endl;
+    out << "      \"fps\": " << (seconds > 0 ? frames / seconds : 0) << "," << std::endl;
+    out << "      \"dropped_frames\": " << pipeline->getDroppedFrames() << "," << std::endl;
+    out << "      \"deadline_misses\": " << pipeline->getDeadlineMisses() << "," << std::endl;
+    // in milliseconds, the percentiles over the last frames of the run
+    out << "      \"stages\": [";
+    std::map<std::string, uint64_t> inferences;
+    auto stats = pipeline->getLatencyStats();
+    for (size_t j = 0; j < stats.size(); j++) {
+      auto & stage = stats[j];
+      out << (j == 0 ? "" : ",") << std::endl;
+      out << "        {\"stage\": " << quote(stage.stage) << ", \"count\": " << stage.count <<
+        ", \"mean\": " << stage.mean << ", \"p50\": " << stage.p50 << ", \"p95\": " <<
+        stage.p95 << ", \"p99\": " << stage.p99 << "}";
+      const std::string suffix = "/inference";
+      if (stage.stage.size() > suffix.size() &&
+        stage.stage.compare(stage.stage.size() - suffix.size(), suffix.size(), suffix) == 0)
+      {
+        inferences[stage.stage.substr(0, stage.stage.size() - suffix.size())] = stage.count;
+      }
+    }
+    out << std::endl << "      ]," << std::endl;
+    out << "      \"inferences\": {";
+    bool first = true;
+    for (auto & inference : inferences) {
+      out << (first ? "" : ", ") << quote(inference.first) << ": " << inference.second;
+      first = false;
+    }
+    out << "}" << std::endl;
+    out << "    }";
+  }
+  out << std::endl << "  ]" << std::endl;
+  out << "}" << std::endl;
+}
+
+/**
+ * @brief The pipelines of a run, and the time their frames were processed for.
+ */
+struct Run
+{
+  std::vector<std::shared_ptr<Pipeline>> pipelines;
+  size_t failed = 0;  // pipelines not created
+  double seconds = 0;
+  rusage usage{};
+  std::map<std::string, double> busy;  // seconds each device had a request running
+};
+
+/**
+ * @brief Create the pipelines, run them until the end of the video or the
+ * limits of the options, then stop them. The networks are loaded before the
+ * run, only the processing of the frames is measured. 'before_start' is
+ * called once they are loaded, right before the run.
+ */
+Run runPipelines(
+  const std::vector<Params::ParamManager::PipelineRawData> & params,
+  const rclcpp::Node::SharedPtr & node, const Options & options,
+  const std::function<void()> & before_start = nullptr)
+{
+  Run run;
+  run.pipelines = PipelineManager::getInstance().createPipelines(params, node);
+  auto created = std::remove(run.pipelines.begin(), run.pipelines.end(), nullptr);
+  run.failed = std::distance(created, run.pipelines.end());
+  run.pipelines.erase(created, run.pipelines.end());
+  if (run.pipelines.empty()) {
+    throw std::runtime_error("No pipeline is created.");
+  }
+  if (before_start) {
+    before_start();
+  }
+
+  auto start_busy = Engines::DeviceScheduler::getBusyTimes();
+  rusage start_usage;
+  getrusage(RUSAGE_SELF, &start_usage);
+  auto start = std::chrono::steady_clock::now();
+  auto elapsed = [&start]() {
+      return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+  PipelineManager::getInstance().runAll();
+  while (PipelineManager::getInstance().isAnyRunning() && !interrupted) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    bool done = options.duration > 0 && elapsed() >= options.duration;
+    if (options.frames > 0) {
+      done = done || std::all_of(run.pipelines.begin(), run.pipelines.end(),
+          [&options](const std::shared_ptr<Pipeline> & pipeline) {
+            return getFrameCount(pipeline) >= options.frames;
+          });
+    }
+    if (done) {
+      break;
+    }
+  }
+  run.seconds = elapsed();
+  rusage end_usage;
+  getrusage(RUSAGE_SELF, &end_usage);
+  timersub(&end_usage.ru_utime, &start_usage.ru_utime, &run.usage.ru_utime);
+  timersub(&end_usage.ru_stime, &start_usage.ru_stime, &run.usage.ru_stime);
+  for (auto & busy : Engines::DeviceScheduler::getBusyTimes()) {
+    run.busy[busy.first] = busy.second - start_busy[busy.first];
+  }
+
+  PipelineManager::getInstance().stopAll();
+  PipelineManager::getInstance().joinAll();
+  return run;
+}
+
+/**
+ * @brief The settings of an inference swept by -tune.
+ */
+struct Setting
+{
+  int batch = 1;
+  int streams = 0;  // 0 leaves the streams of the config as they are
+  int requests = 0;
+
+  bool operator==(const Setting & other) const
+  {
+    return batch == other.batch && streams == other.streams && requests == other.requests;
+  }
+};
+
+/**
+ * @brief The measures of the pipelines with a setting of an inference, the
+ * settings of the parameter file for the first one.
+ */
+struct Trial
+{
+  std::string pipeline;
+  std::string inference;
+  Setting setting;
+  bool valid = false;  // all the pipelines created and processing frames
+  double fps = 0;  // total of the pipelines
+  double latency = 0;  // highest frame p95 of the pipelines, in milliseconds
+};
+
+/**
+ * @brief Get the config key of the streams of a device, empty for the devices
+ * without streams (e.g. MYRIAD, HDDL) or running on several ones.
+ */
+std::string getStreamsKey(const std::string & engine)
+{
+  if (engine.compare(0, 3, "CPU") == 0) {
+    return "CPU_THROUGHPUT_STREAMS";
+  }
+  if (engine.compare(0, 3, "GPU") == 0) {
+    return "GPU_THROUGHPUT_STREAMS";
+  }
+  return "";
+}
+
+Setting getSetting(const Params::ParamManager::InferenceRawData & infer)
+{
+  Setting setting;
+  setting.batch = infer.batch;
+  setting.requests = infer.infer_requests;
+  auto found = infer.config.find(getStreamsKey(infer.engine));
+  if (found != infer.config.end()) {
+    try {
+      setting.streams = std::stoi(found->second);
+    } catch (const std::exception &) {
+      // e.g. CPU_THROUGHPUT_AUTO, kept unless a number of streams is faster
+    }
+  }
+  return setting;
+}
+
+void applySetting(const Setting & setting, Params::ParamManager::InferenceRawData & infer)
+{
+  infer.batch = setting.batch;
+  infer.infer_requests = setting.requests;
+  auto key = getStreamsKey(infer.engine);
+  if (setting.streams > 0 && !key.empty()) {
+    infer.config[key] = std::to_string(setting.streams);
+  }
+}
+
+/**
+ * @brief Remove all the pipelines, so that their networks are released.
+ */
+void removePipelines()
+{
+  std::vector<std::string> names;
+  for (auto & pipeline : *PipelineManager::getInstance().getPipelinesPtr()) {
+    names.push_back(pipeline.first);
+  }
+  for (auto & name : names) {
+    PipelineManager::getInstance().removePipeline(name);
+  }
+}
+
+/**
+ * @brief Run the pipelines of the parameters once, then remove them so that
+ * their networks are released before the next trial.
+ */
+Trial runTrial(
+  const std::vector<Params::ParamManager::PipelineRawData> & params,
+  const rclcpp::Node::SharedPtr & node, const Options & options)
+{
+  Trial trial;
+  try {
+    auto run = runPipelines(params, node, options);
+    trial.valid = run.failed == 0 && run.seconds > 0;
+    for (auto & pipeline : run.pipelines) {
+      auto stats = getFrameStats(pipeline);
+      trial.valid = trial.valid && stats.count > 0;
+      trial.fps += run.seconds > 0 ? stats.count / run.seconds : 0;
+      trial.latency = std::max(trial.latency, stats.p95);
+    }
+  } catch (const std::exception & error) {
+    slog::warn << "Trial failed: " << error.what() << slog::endl;
+  }
+  removePipelines();
+  return trial;
+}
+
+/**
+ * @brief Whether a trial is better than the best one so far: within the
+ * latency bound first, then of a higher throughput. Out of the bound, the
+ * lower latency is better.
+ */
+bool isBetter(const Trial & trial, const Trial & best, const Options & options)
+{
+  if (!trial.valid) {
+    return false;
+  }
+  if (!best.valid) {
+    return true;
+  }
+  bool fits = options.max_latency <= 0 || trial.latency <= options.max_latency;
+  bool best_fits = options.max_latency <= 0 || best.latency <= options.max_latency;
+  if (fits != best_fits) {
+    return fits;
+  }
+  return fits ? trial.fps > best.fps : trial.latency < best.latency;
+}
+
+/**
+ * @brief Sweep the settings of the inferences one after the other, each one
+ * with the best settings found for the previous ones, and keep the best.
+ * Every trial runs all the pipelines, as they share the devices.
+ */
+std::vector<Trial> tune(
+  std::vector<Params::ParamManager::PipelineRawData> & params,
+  const rclcpp::Node::SharedPtr & node, const Options & options)
+{
+  std::vector<Trial> trials;
+  Trial best = runTrial(params, node, options);
+  slog::info << "Configured settings: " << best.fps << " fps, frame p95 " << best.latency <<
+    " ms" << slog::endl;
+  trials.push_back(best);
+  for (size_t p = 0; p < params.size(); p++) {
+    for (size_t j = 0; j < params[p].infers.size() && !interrupted; j++) {
+      auto initial = getSetting(params[p].infers[j]);
+      auto streams = options.streams;
+      if (getStreamsKey(params[p].infers[j].engine).empty()) {
+        streams = {0};
+      }
+      for (int batch : options.batches) {
+        for (int stream : streams) {
+          for (int requests : options.requests) {
+            Setting setting;
+            setting.batch = std::max(1, batch);
+            setting.streams = stream;
+            setting.requests = requests;
+            if (setting == initial || interrupted) {
+              continue;
+            }
+            auto candidate = params;
+            applySetting(setting, candidate[p].infers[j]);
+            Trial trial = runTrial(candidate, node, options);
+            trial.pipeline = params[p].name;
+            trial.inference = params[p].infers[j].name;
+            trial.setting = setting;
+            slog::info << trial.pipeline << "/" << trial.inference << " batch " << batch <<
+              ", streams " << stream << ", requests " << requests << ": " <<
+              (trial.valid ? std::to_string(trial.fps) + " fps, frame p95 " +
+              std::to_string(trial.latency) + " ms" : std::string("failed")) << slog::endl;
+            trials.push_back(trial);
+            if (isBetter(trial, best, options)) {
+              best = trial;
+              params = candidate;
+            }
+          }
+        }
+      }
+      auto tuned = getSetting(params[p].infers[j]);
+      slog::info << "Tuned " << params[p].name << "/" << params[p].infers[j].name <<
+        ": batch " << tuned.batch << ", streams " << tuned.streams << ", requests " <<
+        tuned.requests << slog::endl;
+    }
+  }
+  return trials;
+}
+
+/**
+ * @brief Write the parameter file with the tuned settings of the inferences.
+ * The file is emitted again from its YAML tree, so its comments are not kept.
+ */
+void writeTunedConfig(
+  const Options & options,
+  const std::vector<Params::ParamManager::PipelineRawData> & configured,
+  const std::vector<Params::ParamManager::PipelineRawData> & tuned)
+{
+  YAML::Node doc = YAML::LoadFile(options.config);
+  YAML::Node pipelines = doc["Pipelines"];
+  for (size_t p = 0; p < tuned.size(); p++) {
+    YAML::Node infers = pipelines[p]["infers"];
+    for (size_t j = 0; j < tuned[p].infers.size(); j++) {
+      auto setting = getSetting(tuned[p].infers[j]);
+      if (setting == getSetting(configured[p].infers[j])) {
+        continue;
+      }
+      YAML::Node infer = infers[j];
+      infer["batch"] = setting.batch;
+      infer["infer_requests"] = setting.requests;
+      auto key = getStreamsKey(tuned[p].infers[j].engine);
+      if (setting.streams > 0 && !key.empty()) {
+        infer["config"][key] = std::to_string(setting.streams);
+      }
+    }
+  }
+  std::ofstream out(options.tune);
+  if (!out) {
+    throw std::runtime_error("Failed to write the tuned config into " + options.tune);
+  }
+  out << doc << std::endl;
+}
+
+void writeTuneReport(std::ostream & out, const Options & options, const std::vector<Trial> & trials)
+{
+  out << "{" << std::endl;
+  out << "  \"config\": " << quote(options.config) << "," << std::endl;
+  out << "  \"tuned_config\": " << quote(options.tune) << "," << std::endl;
+  out << "  \"max_latency\": " << options.max_latency << "," << std::endl;
+  out << "  \"trials\": [";
+  for (size_t i = 0; i < trials.size(); i++) {
+    auto & trial = trials[i];
+    out << (i == 0 ? "" : ",") << std::endl;
+    out << "    {\"pipeline\": " << quote(trial.pipeline) << ", \"inference\": " <<
+      quote(trial.inference) << ", \"batch\": " << trial.setting.batch << ", \"streams\": " <<
+      trial.setting.streams << ", \"requests\": " << trial.setting.requests <<
+      ", \"valid\": " << (trial.valid ? "true" : "false") << ", \"fps\": " << trial.fps <<
+      ", \"frame_p95\": " << trial.latency << "}";
+  }
+  out << std::endl << "  ]" << std::endl;
+  out << "}" << std::endl;
+}
+
+/**
+ * @brief The measures of a pipeline in a step of -scale.
+ */
+struct PipelineMeasure
+{
+  std::string name;
+  uint64_t dropped = 0;
+  double fps = 0;
+  LatencyStats::Summary frame;  // in milliseconds
+};
+
+/**
+ * @brief The measures of the copies run in a process, or of all the processes
+ * of a step once merged.
+ */
+struct Measure
+{
+  size_t failed = 0;  // copies of pipelines not created or not run
+  double seconds = 0;  // the longest run of the processes
+  double cpu_seconds = 0;  // user and system, of all the processes
+  uint64_t memory = 0;  // resident memory, of all the processes
+  std::map<std::string, double> busy;  // seconds each device had a request running
+  std::vector<PipelineMeasure> pipelines;
+
+  void merge(const Measure & other)
+  {
+    failed += other.failed;
+    seconds = std::max(seconds, other.seconds);
+    cpu_seconds += other.cpu_seconds;
+    memory += other.memory;
+    for (auto & busy_time : other.busy) {
+      busy[busy_time.first] += busy_time.second;
+    }
+    pipelines.insert(pipelines.end(), other.pipelines.begin(), other.pipelines.end());
+  }
+};
+
+Measure measureRun(const Run & run)
+{
+  Measure measure;
+  measure.failed = run.failed;
+  measure.seconds = run.seconds;
+  measure.cpu_seconds = getCpuSeconds(run.usage.ru_utime) + getCpuSeconds(run.usage.ru_stime);
+  measure.memory = readProcessMemory("VmRSS");
+  measure.busy = run.busy;
+  for (auto & pipeline : run.pipelines) {
+    PipelineMeasure pipeline_measure;
+    pipeline_measure.name = pipeline->getName();
+    pipeline_measure.dropped = pipeline->getDroppedFrames();
+    pipeline_measure.frame = getFrameStats(pipeline);
+    pipeline_measure.fps = run.seconds > 0 ? pipeline_measure.frame.count / run.seconds : 0;
+    measure.pipelines.push_back(pipeline_measure);
+  }
+  return measure;
+}
+
+/**
+ * @brief Write the measure of a worker process for the launcher, one record
+ * per line, the names last as they end the line.
+ */
+void writeMeasure(std::ostream & out, const Measure & measure)
+{
+  out << "run " << measure.failed << " " << measure.seconds << " " << measure.cpu_seconds <<
+    " " << measure.memory << std::endl;
+  for (auto & busy : measure.busy) {
+    out << "device " << busy.second << " " << busy.first << std::endl;
+  }
+  for (auto & pipeline : measure.pipelines) {
+    out << "pipeline " << pipeline.frame.count << " " << pipeline.dropped << " " <<
+      pipeline.fps << " " << pipeline.frame.mean << " " << pipeline.frame.p50 << " " <<
+      pipeline.frame.p95 << " " << pipeline.frame.p99 << " " << pipeline.name << std::endl;
+  }
+}
+
+Measure readMeasure(std::istream & in)
+{
+  Measure measure;
+  std::string line;
+  while (std::getline(in, line)) {
+    std::istringstream record(line);
+    std::string kind;
+    record >> kind;
+    if (kind == "run") {
+      record >> measure.failed >> measure.seconds >> measure.cpu_seconds >> measure.memory;
+    } else if (kind == "device") {
+      double busy = 0;
+      std::string device;
+      record >> busy >> std::ws;
+      std::getline(record, device);
+      measure.busy[device] = busy;
+    } else if (kind == "pipeline") {
+      PipelineMeasure pipeline;
+      pipeline.frame.stage = "frame";
+      record >> pipeline.frame.count >> pipeline.dropped >> pipeline.fps >> pipeline.frame.mean >>
+        pipeline.frame.p50 >> pipeline.frame.p95 >> pipeline.frame.p99 >> std::ws;
+      std::getline(record, pipeline.name);
+      measure.pipelines.push_back(pipeline);
+    }
+  }
+  return measure;
+}
+
+/**
+ * @brief Copy the pipelines of the parameter file, each copy named after its
+ * index, e.g. "people_2".
+ */
+std::vector<Params::ParamManager::PipelineRawData> copyPipelines(
+  const std::vector<Params::ParamManager::PipelineRawData> & params, size_t copies)
+{
+  std::vector<Params::ParamManager::PipelineRawData> copied;
+  for (size_t c = 0; c < copies; c++) {
+    for (auto pipeline : params) {
+      pipeline.name += "_" + std::to_string(c);
+      copied.push_back(pipeline);
+    }
+  }
+  return copied;
+}
+
+/**
+ * @brief Run the copies of a step in this process, then remove them.
+ */
+Measure runCopies(
+  const std::vector<Params::ParamManager::PipelineRawData> & params,
+  const rclcpp::Node::SharedPtr & node, const Options & options,
+  const std::function<void()> & before_start = nullptr)
+{
+  Measure measure;
+  try {
+    measure = measureRun(runPipelines(params, node, options, before_start));
+  } catch (const std::exception & error) {
+    slog::warn << "Step failed: " << error.what() << slog::endl;
+    measure.failed = params.size();
+  }
+  removePipelines();
+  return measure;
+}
+
+bool writeAll(int fd, const std::string & data)
+{
+  size_t written = 0;
+  while (written < data.size()) {
+    ssize_t size = ::write(fd, data.data() + written, data.size() - written);
+    if (size <= 0) {
+      return false;
+    }
+    written += size;
+  }
+  return true;
+}
+
+/**
+ * @brief Read a line of a worker, without the '\n', false at its end.
+ */
+bool readLine(int fd, std::string & line)
+{
+  line.clear();
+  char c;
+  while (::read(fd, &c, 1) == 1) {
+    if (c == '\n') {
+      return true;
+    }
+    line += c;
+  }
+  return !line.empty();
+}
+
+/**
+ * @brief Run some copies of a step in a worker process. Once its networks are
+ * loaded, the worker reports "ready" and waits for the start pipe to be closed,
+ * so that all the workers of the step measure the same time.
+ */
+int runWorker(
+  const std::vector<Params::ParamManager::PipelineRawData> & params, const Options & options,
+  size_t index, int start_fd, int result_fd)
+{
+  rclcpp::init(0, nullptr);
+  auto node = rclcpp::Node::make_shared("openvino_benchmark_" + std::to_string(index));
+  auto measure = runCopies(params, node, options,
+      [start_fd, result_fd]() {
+        writeAll(result_fd, "ready\n");
+        char c;
+        while (::read(start_fd, &c, 1) > 0) {
+        }
+      });
+  std::ostringstream out;
+  writeMeasure(out, measure);
+  bool written = writeAll(result_fd, out.str());
+  rclcpp::shutdown();
+  return written ? 0 : 2;
+}
+
+/**
+ * @brief Run the copies of a step spread over worker processes, round-robin,
+ * and merge their measures. Every worker loads its own networks.
+ */
+Measure runProcesses(
+  const std::vector<Params::ParamManager::PipelineRawData> & params, const Options & options)
+{
+  size_t processes = std::min(static_cast<size_t>(options.processes), params.size());
+  std::vector<std::vector<Params::ParamManager::PipelineRawData>> parts(processes);
+  for (size_t i = 0; i < params.size(); i++) {
+    parts[i % processes].push_back(params[i]);
+  }
+
+  int start_pipe[2];
+  if (::pipe(start_pipe) != 0) {
+    throw std::runtime_error("Failed to create the start pipe of the workers.");
+  }
+  Measure measure;
+  std::vector<std::pair<pid_t, int>> workers;
+  for (size_t p = 0; p < processes; p++) {
+    int result_pipe[2];
+    if (::pipe(result_pipe) != 0) {
+      measure.failed += parts[p].size();
+      continue;
+    }
+    pid_t pid = ::fork();
+    if (pid == 0) {
+      ::close(start_pipe[1]);
+      ::close(result_pipe[0]);
+      for (auto & worker : workers) {
+        ::close(worker.second);
+      }
+      ::_exit(runWorker(parts[p], options, p, start_pipe[0], result_pipe[1]));
+    }
+    ::close(result_pipe[1]);
+    if (pid < 0) {
+      slog::err << "Failed to start the worker " << p << slog::endl;
+      ::close(result_pipe[0]);
+      measure.failed += parts[p].size();
+      continue;
+    }
+    workers.emplace_back(pid, result_pipe[0]);
+  }
+
+  // the workers start together once all of them loaded their networks
+  std::vector<std::string> first_lines;
+  for (auto & worker : workers) {
+    std::string line;
+    readLine(worker.second, line);
+    first_lines.push_back(line == "ready" ? "" : line + "\n");
+  }
+  ::close(start_pipe[1]);
+  ::close(start_pipe[0]);
+
+  for (size_t w = 0; w < workers.size(); w++) {
+    std::string output = first_lines[w];
+    std::string line;
+    while (readLine(workers[w].second, line)) {
+      output += line + "\n";
+    }
+    ::close(workers[w].second);
+    int status = 0;
+    ::waitpid(workers[w].first, &status, 0);
+    std::istringstream in(output);
+    Measure worker_measure = readMeasure(in);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0 || output.empty()) {
+      slog::warn << "The worker " << workers[w].first << " failed" << slog::endl;
+      worker_measure = Measure();
+      worker_measure.failed = parts[w].size();
+    }
+    measure.merge(worker_measure);
+  }
+  return measure;
+}
+
+/**
+ * @brief A step of -scale: the copies of the pipelines run together.
+ */
+struct Step
+{
+  size_t copies = 0;
+  size_t processes = 1;
+  Measure measure;
+
+  double getFps() const
+  {
+    double fps = 0;
+    for (auto & pipeline : measure.pipelines) {
+      fps += pipeline.fps;
+    }
+    return fps;
+  }
+  double getFrameP50() const
+  {
+    double p50 = 0;
+    for (auto & pipeline : measure.pipelines) {
+      p50 += pipeline.frame.p50;
+    }
+    return measure.pipelines.empty() ? 0 : p50 / measure.pipelines.size();
+  }
+  double getFrameP95() const
+  {
+    double p95 = 0;
+    for (auto & pipeline : measure.pipelines) {
+      p95 = std::max(p95, pipeline.frame.p95);
+    }
+    return p95;
+  }
+};
+
+/**
+ * @brief Run each step of -scale with its number of copies of the pipelines,
+ * in this process or spread over worker processes.
+ */
+std::vector<Step> scale(
+  const std::vector<Params::ParamManager::PipelineRawData> & params,
+  const rclcpp::Node::SharedPtr & node, const Options & options)
+{
+  std::vector<Step> steps;
+  for (int copies : options.scale) {
+    if (interrupted) {
+      break;
+    }
+    Step step;
+    step.copies = static_cast<size_t>(std::max(copies, 1));
+    auto copied = copyPipelines(params, step.copies);
+    if (options.processes > 1) {
+      step.processes = std::min(static_cast<size_t>(options.processes), copied.size());
+      step.measure = runProcesses(copied, options);
+    } else {
+      step.measure = runCopies(copied, node, options);
+    }
+    double base = steps.empty() ? 0 : steps.front().getFps() / steps.front().copies;
+    slog::info << step.copies << " copies in " << step.processes << " processes: " <<
+      step.getFps() << " fps" <<
+      (base > 0 ? " (" + std::to_string(step.getFps() / (base * step.copies)) +
+      " of linear)" : std::string()) << ", frame p50 " << step.getFrameP50() <<
+      " ms, frame p95 " << step.getFrameP95() << " ms, " <<
+      (step.measure.seconds > 0 ? step.measure.cpu_seconds / step.measure.seconds : 0) <<
+      " cores" << slog::endl;
+    steps.push_back(step);
+  }
+  return steps;
+}
+
+void writeScaleReport(std::ostream & out, const Options & options, const std::vector<Step> & steps)
+{
+  const unsigned int cores = std::thread::hardware_concurrency();
+  out << "{" << std::endl;
+  out << "  \"config\": " << quote(options.config) << "," << std::endl;
+  out << "  \"video\": " << quote(options.video) << "," << std::endl;
+  out << "  \"target_fps\": " << options.fps << "," << std::endl;
+  out << "  \"replay\": " << options.replay << "," << std::endl;
+  out << "  \"processes\": " << options.processes << "," << std::endl;
+  out << "  \"cores\": " << cores << "," << std::endl;
+  out << "  \"steps\": [";
+  for (size_t i = 0; i < steps.size(); i++) {
+    auto & step = steps[i];
+    auto & measure = step.measure;
+    double seconds = measure.seconds;
+    double fps = step.getFps();
+    // the throughput of a copy alone, scaled linearly
+    double base = steps.front().getFps() / steps.front().copies;
+    double cores_used = seconds > 0 ? measure.cpu_seconds / seconds : 0;
+    out << (i == 0 ? "" : ",") << std::endl;
+    out << "    {" << std::endl;
+    out << "      \"copies\": " << step.copies << "," << std::endl;
+    out << "      \"processes\": " << step.processes << "," << std::endl;
+    out << "      \"failed\": " << measure.failed << "," << std::endl;
+    out << "      \"seconds\": " << seconds << "," << std::endl;
+    out << "      \"fps\": " << fps << "," << std::endl;
+    out << "      \"fps_per_pipeline\": " <<
+      (measure.pipelines.empty() ? 0 : fps / measure.pipelines.size()) << "," << std::endl;
+    out << "      \"efficiency\": " << (base > 0 ? fps / (base * step.copies) : 0) << "," <<
+      std::endl;
+    out << "      \"frame_p50\": " << step.getFrameP50() << "," << std::endl;
+    out << "      \"frame_p95\": " << step.getFrameP95() << "," << std::endl;
+    out << "      \"cpu\": {\"seconds\": " << measure.cpu_seconds << ", \"cores_used\": " <<
+      cores_used << ", \"utilization\": " << (cores > 0 ? cores_used / cores : 0) << "}," <<
+      std::endl;
+    out << "      \"memory\": " << measure.memory << "," << std::endl;
+    out << "      \"devices\": {";
+    bool first = true;
+    for (auto & busy : measure.busy) {
+      out << (first ? "" : ", ") << quote(busy.first) << ": " <<
+        (seconds > 0 ? busy.second / seconds : 0);
+      first = false;
+    }
+    out << "}," << std::endl;
+    out << "      \"pipelines\": [";
+    for (size_t j = 0; j < measure.pipelines.size(); j++) {
+      auto & pipeline = measure.pipelines[j];
+      out << (j == 0 ? "" : ",") << std::endl;
+      out << "        {\"name\": " << quote(pipeline.name) << ", \"frames\": " <<
+        pipeline.frame.count << ", \"fps\": " << pipeline.fps << ", \"dropped_frames\": " <<
+        pipeline.dropped << ", \"frame_mean\": " << pipeline.frame.mean << ", \"frame_p50\": " <<
+        pipeline.frame.p50 << ", \"frame_p95\": " << pipeline.frame.p95 << ", \"frame_p99\": " <<
+        pipeline.frame.p99 << "}";
+    }
+    out << std::endl << "      ]" << std::endl;
+    out << "    }";
+  }
+  out << std::endl << "  ]" << std::endl;
+  out << "}" << std::endl;
+}
+}  // namespace
+
+int main(int argc, char * argv[])
+{
+  signal(SIGINT, signalHandler);
+
+  try {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+      showUsage(argv[0]);
+      throw std::runtime_error("Config File and Video are not correctly set.");
+    }
+    if (!options.scale.empty() && !options.tune.empty()) {
+      throw std::runtime_error("-scale and -tune can't be used together.");
+    }
+    // the worker processes of -scale are forked before any ROS or OpenVINO thread starts
+    bool forking = !options.scale.empty() && options.processes > 1;
+    rclcpp::Node::SharedPtr main_node;
+    if (!forking) {
+      rclcpp::init(argc, argv);
+      main_node = rclcpp::Node::make_shared("openvino_benchmark");
+    }
+    Params::ParamManager::getInstance().parse(options.config);
+    auto params = Params::ParamManager::getInstance().getPipelines();
+    if (params.size() < 1) {
+      throw std::logic_error("Pipeline parameters should be set!");
+    }
+    for (auto & pipeline : params) {
+      configureForBenchmark(pipeline, options);
+    }
+
+    // the logs go to the standard output, the report into its own file
+    std::ofstream out(options.output);
+    if (!out) {
+      throw std::runtime_error("Failed to write the report into " + options.output);
+    }
+    if (!options.tune.empty()) {
+      if (options.frames == 0 && options.duration == 0) {
+        options.frames = 200;  // per trial, the whole video would make the sweep too long
+      }
+      auto trials = tune(params, main_node, options);
+      // only the inferences are written back, not the inputs and outputs of the benchmark
+      writeTunedConfig(options, Params::ParamManager::getInstance().getPipelines(), params);
+      writeTuneReport(out, options, trials);
+      slog::info << "Tuned config written into " << options.tune << slog::endl;
+    } else if (!options.scale.empty()) {
+      auto steps = scale(params, main_node, options);
+      writeScaleReport(out, options, steps);
+    } else {
+      auto run = runPipelines(params, main_node, options);
+      writeReport(out, options, run.pipelines, run.seconds, run.usage);
+    }
+    slog::info << "Benchmark report written into " << options.output << slog::endl;
+    if (!forking) {
+      rclcpp::shutdown();
+    }
+  } catch (const std::exception & error) {
+    slog::err << error.what() << slog::endl;
+    return -2;
+  } catch (...) {
+    slog::err << "Unknown/internal exception happened." << slog::endl;
+    return -3;
+  }
+
+  return 0;
+}
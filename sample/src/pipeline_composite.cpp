@@ -24,7 +24,6 @@
 #include <unistd.h>
 #include <algorithm>
 #include <chrono>
-#include <csignal>
 #include <fstream>
 #include <functional>
 #include <iostream>
@@ -48,16 +47,13 @@
 #include "opencv2/opencv.hpp"
 //#include "utility.hpp"
 
-void signalHandler(int signum)
-{
-  slog::warn << "!!!!!!!!!!!Interrupt signal (" << signum << ") received!!!!!!!!!!!!" << slog::endl;
-
-  // cleanup and close up stuff here
-  // terminate program
-  PipelineManager::getInstance().stopAll();
-  // exit(signum);
-}
-
+/**
+ * The pipeline runtime as a component: loaded into a container with the camera
+ * driver and the consumers of the results, with use_intra_process_comms the
+ * ImageTopic input and the published results are handed over in process.
+ * The container owns the process, so the component neither handles signals
+ * nor spins: its pipelines stop when it is unloaded.
+ */
 class ComposablePipeline : public rclcpp::Node
 {
 public:
@@ -66,14 +62,15 @@ public:
   {
     initPipeline();
   }
-  virtual ~ComposablePipeline() = default;
+  virtual ~ComposablePipeline()
+  {
+    PipelineManager::getInstance().stopAll();
+    PipelineManager::getInstance().joinAll();
+  }
 
 private:
   void initPipeline()
   {
-    // register signal SIGINT and signal handler
-    signal(SIGINT, signalHandler);
-
     std::string config = getConfigPath();
     slog::info << "Config File Path =" << config << slog::endl;
 
@@ -84,11 +81,10 @@ private:
       throw std::logic_error("Pipeline parameters should be set!");
     }
 
-    std::shared_ptr<rclcpp::Node> node_handler(this);
-    // auto createPipeline = PipelineManager::getInstance().createPipeline;
-    for (auto & p : pipelines) {
-      PipelineManager::getInstance().createPipeline(p, node_handler);
-    }
+    // the container owns the node, the inputs and outputs only borrow it
+    std::shared_ptr<rclcpp::Node> node_handler(this, [](rclcpp::Node *) {});
+    // networks of all the pipelines are loaded concurrently
+    PipelineManager::getInstance().createPipelines(pipelines, node_handler);
 
     PipelineManager::getInstance().runAll();
     //PipelineManager::getInstance().joinAll();
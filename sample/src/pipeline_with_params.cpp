@@ -62,10 +62,7 @@ void signalHandler(int signum)
 int main(int argc, char * argv[])
 {
   rclcpp::init(argc, argv);
-  rclcpp::executors::SingleThreadedExecutor exec;
   rclcpp::Node::SharedPtr main_node = rclcpp::Node::make_shared("openvino_pipeline");
-  rclcpp::Node::SharedPtr service_node = std::make_shared<vino_service::PipelineProcessingServer
-      <pipeline_srv_msgs::srv::PipelineSrv>>("pipeline_service");
   // register signal SIGINT and signal handler
   //signal(SIGINT, signalHandler);
 
@@ -82,22 +79,25 @@ int main(int argc, char * argv[])
 
     Params::ParamManager::getInstance().parse(config);
     Params::ParamManager::getInstance().print();
+    // created once the parameters are parsed, it publishes the stats by stats_period
+    rclcpp::Node::SharedPtr service_node = std::make_shared<vino_service::PipelineProcessingServer
+        <pipeline_srv_msgs::srv::PipelineSrv>>("pipeline_service");
     auto pipelines = Params::ParamManager::getInstance().getPipelines();
     if (pipelines.size() < 1) {
       throw std::logic_error("Pipeline parameters should be set!");
     }
-    // auto createPipeline = PipelineManager::getInstance().createPipeline;
-    for (auto & p : pipelines) {
-      PipelineManager::getInstance().createPipeline(p, main_node);
-    }
+    // networks of all the pipelines are loaded concurrently
+    PipelineManager::getInstance().createPipelines(pipelines, main_node);
 
     PipelineManager::getInstance().runAll();
 
     //rclcpp::spin(main_node);
-    exec.add_node(main_node);
-    exec.add_node(service_node);
-    exec.spin();
+    // returns once every pipeline stopped, e.g. the ImageDirectory ones once processed
+    auto threads = Params::ParamManager::getInstance().getCommon().executor_threads;
+    PipelineManager::getInstance().spinAll({main_node, service_node},
+      static_cast<size_t>(std::max(threads, 0)));
     PipelineManager::getInstance().stopAll();
+    PipelineManager::getInstance().joinAll();
     rclcpp::shutdown();
 
   } catch (const std::exception & error) {
@@ -0,0 +1,244 @@
+// Copyright (c) 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+* \brief A launcher running each pipeline of a parameter file in a worker
+ * process of its own, so that a crashing pipeline neither stops the others
+ * nor the daemon. With -engine_socket the inferences of all the workers are
+ * run by the engine daemon (see engine_daemon), which loads each network
+ * once. The crashed workers are started again.
+* \file sample/pipeline_workers.cpp
+*/
+
+#include <rclcpp/rclcpp.hpp>
+#include <vino_param_lib/param_manager.hpp>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <csignal>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "dynamic_vino_lib/pipeline_manager.hpp"
+#include "dynamic_vino_lib/slog.hpp"
+
+namespace
+{
+struct Options
+{
+  std::string config;
+  std::string engine_socket;  // socket of the engine daemon, empty to load the networks locally
+  int restart_delay = 1000;  // ms a crashed worker is started again after
+  int max_restarts = 10;  // restarts of a worker at most, -1 for no limit
+};
+
+std::atomic<int> interrupted{0};
+
+void signalHandler(int signum)
+{
+  interrupted = signum;
+}
+
+void showUsage(const std::string & prog)
+{
+  std::cout << std::endl;
+  std::cout << prog << " [OPTION]" << std::endl;
+  std::cout << "Options:" << std::endl;
+  std::cout << std::endl;
+  std::cout << "    -config \"<path>\"         Absolute path of parameter config file." <<
+    std::endl;
+  std::cout << "    -engine_socket \"<path>\"  Run the inferences by the engine daemon " <<
+    "listening on the socket." << std::endl;
+  std::cout << "    -restart_delay <ms>      Delay before a crashed worker is started " <<
+    "again, 1000 by default." << std::endl;
+  std::cout << "    -max_restarts <N>        Restarts of a worker at most, 10 by default, " <<
+    "-1 for no limit." << std::endl;
+}
+
+bool parseOptions(int argc, char * argv[], Options & options)
+{
+  for (int i = 1; i + 1 < argc; i += 2) {
+    std::string arg = argv[i];
+    if (arg.size() > 2 && arg[0] == '-' && arg[1] == '-') {
+      arg = arg.substr(1);
+    }
+    std::string value = argv[i + 1];
+    if (arg == "-config") {
+      options.config = value;
+    } else if (arg == "-engine_socket") {
+      options.engine_socket = value;
+    } else if (arg == "-restart_delay") {
+      options.restart_delay = std::stoi(value);
+    } else if (arg == "-max_restarts") {
+      options.max_restarts = std::stoi(value);
+    } else {
+      return false;
+    }
+  }
+  return argc % 2 == 1 && !options.config.empty();
+}
+
+/**
+ * @brief Get the engine run by the daemon for a device, the remote and mock
+ * engines and those already run by a daemon being kept.
+ */
+std::string getShmEngine(const std::string & engine, const std::string & socket)
+{
+  for (auto prefix : {"REMOTE:", "MOCK", "SHM:"}) {
+    if (engine.compare(0, std::string(prefix).size(), prefix) == 0) {
+      return engine;
+    }
+  }
+  return "SHM:" + engine + "@" + socket;
+}
+
+/**
+ * @brief Run a pipeline in the worker process, until it stops or is interrupted.
+ */
+int runWorker(Params::ParamManager::PipelineRawData params, const Options & options)
+{
+  // the signals forwarded by the launcher shut the context down, which ends spinAll
+  rclcpp::init(0, nullptr);
+  int code = 0;
+  try {
+    if (!options.engine_socket.empty()) {
+      for (auto & infer : params.infers) {
+        infer.engine = getShmEngine(infer.engine, options.engine_socket);
+        if (!infer.fallback_engine.empty()) {
+          infer.fallback_engine = getShmEngine(infer.fallback_engine, options.engine_socket);
+        }
+      }
+    }
+    std::string node_name = "openvino_worker_" + params.name;
+    std::replace_if(node_name.begin(), node_name.end(),
+      [](char c) {return !std::isalnum(static_cast<unsigned char>(c)) && c != '_';}, '_');
+    auto node = rclcpp::Node::make_shared(node_name);
+    auto pipelines = PipelineManager::getInstance().createPipelines({params}, node);
+    if (pipelines.empty() || pipelines[0] == nullptr) {
+      throw std::runtime_error("The pipeline " + params.name + " is not created.");
+    }
+    PipelineManager::getInstance().runAll();
+    auto threads = Params::ParamManager::getInstance().getCommon().executor_threads;
+    PipelineManager::getInstance().spinAll({node}, static_cast<size_t>(std::max(threads, 0)));
+    PipelineManager::getInstance().stopAll();
+    PipelineManager::getInstance().joinAll();
+  } catch (const std::exception & error) {
+    slog::err << params.name << ": " << error.what() << slog::endl;
+    code = 2;
+  }
+  rclcpp::shutdown();
+  return code;
+}
+
+pid_t startWorker(const Params::ParamManager::PipelineRawData & params, const Options & options)
+{
+  pid_t pid = ::fork();
+  if (pid == 0) {
+    ::_exit(runWorker(params, options));
+  }
+  if (pid < 0) {
+    slog::err << "Failed to start the worker of " << params.name << slog::endl;
+  } else {
+    slog::info << "Started the worker " << pid << " of " << params.name << slog::endl;
+  }
+  return pid;
+}
+}  // namespace
+
+int main(int argc, char * argv[])
+{
+  signal(SIGINT, signalHandler);
+  signal(SIGTERM, signalHandler);
+
+  try {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+      showUsage(argv[0]);
+      throw std::runtime_error("Config File is not correctly set.");
+    }
+    // parsed before the workers are forked, which inherit it
+    Params::ParamManager::getInstance().parse(options.config);
+    auto params = Params::ParamManager::getInstance().getPipelines();
+    if (params.size() < 1) {
+      throw std::logic_error("Pipeline parameters should be set!");
+    }
+
+    std::map<pid_t, size_t> workers;
+    std::vector<int> restarts(params.size(), 0);
+    for (size_t p = 0; p < params.size(); p++) {
+      pid_t pid = startWorker(params[p], options);
+      if (pid > 0) {
+        workers[pid] = p;
+      }
+    }
+    bool forwarded = false;
+    while (!workers.empty()) {
+      if (interrupted && !forwarded) {
+        for (auto & worker : workers) {
+          ::kill(worker.first, interrupted.load());
+        }
+        forwarded = true;
+      }
+      int status = 0;
+      pid_t pid = ::waitpid(-1, &status, WNOHANG);
+      if (pid <= 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        continue;
+      }
+      auto worker = workers.find(pid);
+      if (worker == workers.end()) {
+        continue;
+      }
+      size_t p = worker->second;
+      workers.erase(worker);
+      bool crashed = WIFSIGNALED(status) || (WIFEXITED(status) && WEXITSTATUS(status) != 0);
+      if (!crashed || interrupted) {
+        slog::info << "The worker of " << params[p].name << " stopped" << slog::endl;
+        continue;
+      }
+      if (options.max_restarts >= 0 && restarts[p] >= options.max_restarts) {
+        slog::err << "The worker of " << params[p].name << " crashed " << restarts[p] + 1 <<
+          " times, it is not started again" << slog::endl;
+        continue;
+      }
+      slog::warn << "The worker of " << params[p].name << " crashed, starting it again" <<
+        slog::endl;
+      restarts[p]++;
+      std::this_thread::sleep_for(std::chrono::milliseconds(options.restart_delay));
+      if (interrupted) {
+        continue;
+      }
+      pid = startWorker(params[p], options);
+      if (pid > 0) {
+        workers[pid] = p;
+      }
+    }
+  } catch (const std::exception & error) {
+    slog::err << error.what() << slog::endl;
+    return -2;
+  } catch (...) {
+    slog::err << "Unknown/internal exception happened." << slog::endl;
+    return -3;
+  }
+
+  return 0;
+}
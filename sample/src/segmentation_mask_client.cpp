@@ -0,0 +1,54 @@
+// Copyright (c) 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <people_msgs/msg/objects_in_masks.hpp>
+#include <opencv2/opencv.hpp>
+#include <rclcpp/rclcpp.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mask_decoder.hpp"
+
+int main(int argc, char ** argv)
+{
+  rclcpp::init(argc, argv);
+
+  auto node = rclcpp::Node::make_shared("segmentation_mask_client");
+  if (argc != 2) {
+    RCLCPP_INFO(node->get_logger(), "Usage: ros2 run dynamic_vino_sample "
+      "segmentation_mask_client <pipeline_name>");
+    return -1;
+  }
+
+  MaskDecoder decoder;
+  std::vector<cv::Mat> class_maps;
+  auto sub = node->create_subscription<people_msgs::msg::ObjectsInMasks>(
+    "/openvino_toolkit/" + std::string(argv[1]) + "/segmented_obejcts", 16,
+    [&](const people_msgs::msg::ObjectsInMasks::SharedPtr message) {
+      if (!decoder.decode(*message, class_maps)) {
+        RCLCPP_INFO(node->get_logger(), "Waiting for a keyframe...");
+        return;
+      }
+      for (size_t i = 0; i < class_maps.size(); i++) {
+        RCLCPP_INFO(node->get_logger(), "%zu: %s, mask %dx%d, %d labeled pixels", i,
+          message->objects_vector[i].object_name.c_str(), class_maps[i].cols,
+          class_maps[i].rows, cv::countNonZero(class_maps[i]));
+      }
+    });
+
+  rclcpp::spin(node);
+  rclcpp::shutdown();
+  return 0;
+}
@@ -0,0 +1,42 @@
+// Copyright (c) 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rclcpp/rclcpp.hpp>
+#include <memory>
+#include <string>
+
+#include "dynamic_vino_lib/services/video_processing_server.hpp"
+#include "utility.hpp"
+
+int main(int argc, char ** argv)
+{
+  rclcpp::init(argc, argv);
+
+  std::string config_path = getConfigPath(argc, argv);
+
+  try {
+    auto node = std::make_shared<vino_service::VideoProcessingServer>(config_path);
+    // the jobs run on threads of their own, the executor serves the goals and cancels
+    rclcpp::executors::MultiThreadedExecutor executor;
+    executor.add_node(node);
+    executor.spin();
+  } catch (std::exception & e) {
+    std::cout << e.what() << std::endl;
+  } catch (...) {
+    std::cout << "[ERROR] [video_processing_server]: " <<
+      "exception caught" << std::endl;
+  }
+
+  return 0;
+}
@@ -0,0 +1,319 @@
+// Copyright (c) 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @brief Microbenchmarks of the preprocessing and postprocessing kernels of
+ * the pipelines. The network outputs are generated with a fixed seed, shaped
+ * like the outputs of the sample models, so no model nor device is needed.
+ * @file benchmark_kernels.cpp
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "dynamic_vino_lib/inferences/base_inference.hpp"
+#include "dynamic_vino_lib/inferences/base_reidentification.hpp"
+#include "dynamic_vino_lib/inferences/gallery_index.hpp"
+#include "dynamic_vino_lib/inferences/object_detection.hpp"
+#include "dynamic_vino_lib/inferences/object_segmentation.hpp"
+#include "dynamic_vino_lib/models/object_detection_ssd_model.hpp"
+#include "dynamic_vino_lib/models/object_detection_yolov2_model.hpp"
+#include "inference_engine.hpp"
+#include "opencv2/opencv.hpp"
+
+namespace
+{
+const cv::Size kFrameSize(1280, 720);
+
+cv::Mat makeFrame(const cv::Size & size = kFrameSize)
+{
+  cv::Mat frame(size, CV_8UC3);
+  cv::randu(frame, cv::Scalar::all(0), cv::Scalar::all(255));
+  return frame;
+}
+
+template<typename T>
+InferenceEngine::Blob::Ptr makeBlob(
+  InferenceEngine::Precision precision, size_t batch, size_t channels, size_t height,
+  size_t width)
+{
+  auto blob = InferenceEngine::make_shared_blob<T>(InferenceEngine::TensorDesc(
+        precision, {batch, channels, height, width}, InferenceEngine::Layout::NCHW));
+  blob->allocate();
+  return blob;
+}
+
+/**
+ * @brief A DetectionOutput blob of 'proposals' rows, the first 'objects' of
+ * them detected, then terminated by a negative image_id.
+ */
+std::vector<float> makeSsdOutput(int proposals, int objects, int batch)
+{
+  const int object_size = 7;
+  std::mt19937 rng(7);
+  std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+  std::vector<float> output(proposals * object_size, 0.0f);
+  for (int i = 0; i < std::min(objects, proposals); i++) {
+    float * row = output.data() + i * object_size;
+    float x = unit(rng) * 0.8f;
+    float y = unit(rng) * 0.8f;
+    row[0] = static_cast<float>(i % batch);
+    row[1] = static_cast<float>(rng() % 20 + 1);
+    row[2] = unit(rng);
+    row[3] = x;
+    row[4] = y;
+    row[5] = x + unit(rng) * 0.2f;
+    row[6] = y + unit(rng) * 0.2f;
+  }
+  if (objects < proposals) {
+    output[objects * object_size] = -1;
+  }
+  return output;
+}
+
+/**
+ * @brief A RegionYolo output where 'objects_percent' of the cells of each
+ * anchor are confident, the others are background.
+ */
+std::vector<float> makeRegionOutput(
+  const Models::ObjectDetectionYolov2Model::Region & region, int objects_percent)
+{
+  const int side_square = region.side * region.side;
+  const int entries = region.coords + region.classes + 1;
+  std::mt19937 rng(13);
+  std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+  std::vector<float> output(region.num * entries * side_square);
+  for (int n = 0; n < region.num; n++) {
+    float * planes = output.data() + n * entries * side_square;
+    for (int i = 0; i < side_square; i++) {
+      planes[i] = unit(rng);
+      planes[side_square + i] = unit(rng);
+      planes[2 * side_square + i] = unit(rng) - 0.5f;
+      planes[3 * side_square + i] = unit(rng) - 0.5f;
+      bool object = static_cast<int>(rng() % 100) < objects_percent;
+      planes[region.coords * side_square + i] = object ? 0.6f + 0.4f * unit(rng) : 0.01f;
+      for (int j = 0; j < region.classes; j++) {
+        planes[(region.coords + 1 + j) * side_square + i] = unit(rng) / region.classes;
+      }
+      if (object) {
+        planes[(region.coords + 1 + rng() % region.classes) * side_square + i] = 0.9f;
+      }
+    }
+  }
+  return output;
+}
+
+cv::Mat makeFeatures(int rows, int cols, unsigned seed)
+{
+  cv::Mat features(rows, cols, CV_32F);
+  cv::theRNG().state = seed;
+  cv::randn(features, 0, 1);
+  for (int i = 0; i < rows; i++) {
+    cv::Mat row = features.row(i);
+    row /= cv::norm(row, cv::NORM_L2);
+  }
+  return features;
+}
+}  // namespace
+
+// args: network input width, height
+template<typename T>
+static void BM_MatU8ToBlob(benchmark::State & state)
+{
+  cv::Mat frame = makeFrame();
+  auto precision = std::is_same<T, float>::value ?
+    InferenceEngine::Precision::FP32 : InferenceEngine::Precision::U8;
+  // bound once, as by the engine
+  Engines::InputBinding binding(makeBlob<T>(precision, 1, 3, state.range(1), state.range(0)));
+  for (auto _ : state) {
+    matU8ToBlob<T>(frame, binding);
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_MatU8ToBlob, uint8_t)
+->Args({300, 300})->Args({672, 384})->Args({544, 320})->Args({128, 256})->Args({62, 62})
+->Args({64, 64})->Args({60, 60});
+// FP32 as the age-gender (62x62) and emotions (64x64) inputs were, U8 now
+BENCHMARK_TEMPLATE(BM_MatU8ToBlob, float)
+->Args({300, 300})->Args({672, 384})->Args({62, 62})->Args({64, 64});
+
+// args: network input side
+static void BM_Yolov2MatToBlob(benchmark::State & state)
+{
+  cv::Mat frame = makeFrame();
+  Engines::InputBinding binding(makeBlob<uint8_t>(
+      InferenceEngine::Precision::U8, 1, 3, state.range(0), state.range(0)));
+  for (auto _ : state) {
+    auto letterbox = Models::ObjectDetectionYolov2Model::letterboxToBlob(frame, 0, binding);
+    benchmark::DoNotOptimize(letterbox);
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Yolov2MatToBlob)->Arg(416)->Arg(608);
+
+// args: proposals, detected objects, batch
+static void BM_SsdFetchResults(benchmark::State & state)
+{
+  const int proposals = state.range(0);
+  auto output = makeSsdOutput(proposals, state.range(1), state.range(2));
+  std::vector<cv::Size> frame_sizes(state.range(2), kFrameSize);
+  dynamic_vino_lib::ObjectDetectionArena arena;
+  for (auto _ : state) {
+    arena.clear();
+    Models::ObjectDetectionSSDModel::decodeDetections(
+      output.data(), proposals, 7, frame_sizes, 0.5f, true, arena);
+    benchmark::DoNotOptimize(arena.size());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SsdFetchResults)->Args({200, 20, 1})->Args({200, 200, 1})->Args({800, 400, 4});
+
+// args: percent of the cells holding an object
+static void BM_Yolov2FetchResults(benchmark::State & state)
+{
+  Models::ObjectDetectionYolov2Model::Region region;
+  auto output = makeRegionOutput(region, state.range(0));
+  Models::ObjectDetectionYolov2Model::Letterbox letterbox;
+  letterbox.scale = 416.0f / kFrameSize.width;
+  letterbox.dy = (416 - static_cast<int>(kFrameSize.height * letterbox.scale)) / 2;
+  dynamic_vino_lib::ObjectDetectionArena arena;
+  for (auto _ : state) {
+    arena.clear();
+    Models::ObjectDetectionYolov2Model::decodeRegion(
+      output.data(), region, cv::Size(416, 416), letterbox, 0.5f, 0.45f, 0, arena);
+    benchmark::DoNotOptimize(arena.size());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Yolov2FetchResults)->Arg(1)->Arg(10)->Arg(50);
+
+// args: classes, output height, output width
+static void BM_SegmentationArgmax(benchmark::State & state)
+{
+  const int channels = state.range(0);
+  const int height = state.range(1);
+  const int width = state.range(2);
+  std::vector<float> scores(static_cast<size_t>(channels) * height * width);
+  cv::Mat(1, static_cast<int>(scores.size()), CV_32F, scores.data()).forEach<float>(
+    [](float & value, const int * position) {
+      value = static_cast<float>((position[1] * 2654435761u) % 1000) / 1000.0f;
+    });
+  cv::Mat class_map, max_prob;
+  for (auto _ : state) {
+    dynamic_vino_lib::ObjectSegmentation::argmax(
+      scores.data(), channels, height, width, CV_8U, class_map, max_prob);
+    benchmark::DoNotOptimize(class_map.data);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SegmentationArgmax)->Args({21, 320, 320})->Args({20, 512, 1024})
+->Args({1, 1024, 2048});
+
+// args: class map depth (8 or 16), whether it is upsampled to the frame
+static void BM_SegmentationColorize(benchmark::State & state)
+{
+  const int type = state.range(0) == 16 ? CV_16UC1 : CV_8UC1;
+  cv::Mat class_map(512, 1024, type);
+  cv::randu(class_map, cv::Scalar(0), cv::Scalar(21));
+  cv::Mat confident = makeFrame(class_map.size()) > 64;
+  cv::extractChannel(confident, confident, 0);
+  cv::Mat palette(1, 256, CV_8UC3);
+  cv::randu(palette, cv::Scalar::all(0), cv::Scalar::all(255));
+  cv::Size size = state.range(1) ? kFrameSize : class_map.size();
+  for (auto _ : state) {
+    cv::Mat mask = dynamic_vino_lib::ObjectSegmentationResult::colorize(
+      class_map, confident, palette, size);
+    benchmark::DoNotOptimize(mask.data);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SegmentationColorize)->Args({8, 0})->Args({8, 1})->Args({16, 1});
+
+// args: detections filtered
+static void BM_BaseFilter(benchmark::State & state)
+{
+  const std::vector<std::string> labels = {"person", "vehicle", "license", "bicycle"};
+  std::vector<dynamic_vino_lib::ObjectDetectionResult> results;
+  std::mt19937 rng(3);
+  for (int i = 0; i < state.range(0); i++) {
+    dynamic_vino_lib::ObjectDetectionResult result(cv::Rect(i, i, 32, 64));
+    result.setLabel(labels[rng() % labels.size()]);
+    result.setConfidence(static_cast<float>(rng() % 100) / 100.0f);
+    results.push_back(result);
+  }
+  dynamic_vino_lib::ObjectDetectionResultFilter filter;
+  filter.init();
+  const std::string conditions = "label == person && confidence >= 0.8 || label == vehicle";
+  std::vector<cv::Rect> locations;
+  for (auto _ : state) {
+    filter.getFilteredLocations(results, conditions, locations);
+    benchmark::DoNotOptimize(locations.data());
+  }
+  state.SetItemsProcessed(state.iterations() * results.size());
+}
+BENCHMARK(BM_BaseFilter)->Arg(16)->Arg(256);
+
+// args: recorded tracks, queries per search; 'lists' of an ivf index, 0 for the exact one
+static void BM_GallerySearch(benchmark::State & state, int lists)
+{
+  const int feature_size = 256;
+  std::shared_ptr<dynamic_vino_lib::GalleryIndex> index;
+  if (lists > 0) {
+    index = std::make_shared<dynamic_vino_lib::IvfGalleryIndex>(lists, 4);
+  } else {
+    index = std::make_shared<dynamic_vino_lib::ExactGalleryIndex>();
+  }
+  cv::Mat gallery = makeFeatures(state.range(0), feature_size, 1);
+  for (int i = 0; i < gallery.rows; i++) {
+    index->upsert(i, gallery.row(i));
+  }
+  cv::Mat queries = makeFeatures(state.range(1), feature_size, 2);
+  std::vector<int> ids;
+  std::vector<double> similarities;
+  for (auto _ : state) {
+    index->search(queries, ids, similarities);
+    benchmark::DoNotOptimize(ids.data());
+  }
+  state.SetItemsProcessed(state.iterations() * queries.rows);
+}
+BENCHMARK_CAPTURE(BM_GallerySearch, exact, 0)
+->Args({100, 8})->Args({1000, 8})->Args({10000, 8})->Args({50000, 8});
+BENCHMARK_CAPTURE(BM_GallerySearch, ivf, 64)->Args({1000, 8})->Args({10000, 8})->Args({50000, 8});
+
+// args: recorded tracks, persons per frame
+static void BM_TrackerMatch(benchmark::State & state)
+{
+  const int feature_size = 256;
+  const int tracks = state.range(0);
+  dynamic_vino_lib::Tracker tracker(tracks, 0.9, 0.3);
+  cv::Mat gallery = makeFeatures(tracks, feature_size, 1);
+  tracker.processNewTracks(gallery);
+  // persons seen before, matched and updated, the gallery size is steady
+  cv::Mat persons = gallery.rowRange(0, std::min<int>(state.range(1), tracks)).clone();
+  for (auto _ : state) {
+    auto ids = tracker.processNewTracks(persons);
+    benchmark::DoNotOptimize(ids.data());
+  }
+  state.SetItemsProcessed(state.iterations() * persons.rows);
+}
+BENCHMARK(BM_TrackerMatch)->Args({100, 8})->Args({1000, 8})->Args({10000, 8});
+
+BENCHMARK_MAIN();
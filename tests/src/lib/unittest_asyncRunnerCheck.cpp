@@ -0,0 +1,224 @@
+// Copyright (c) 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "dynamic_vino_lib/engines/async_runner.hpp"
+#include "dynamic_vino_lib/engines/engine.hpp"
+#include "dynamic_vino_lib/engines/request_backend.hpp"
+
+namespace
+{
+/**
+ * @brief A request completing on its own thread shortly after being started,
+ * with a tag the jobs write and read instead of blobs.
+ */
+class StubRequest : public Engines::RequestBackend
+{
+public:
+  StubRequest()
+  {
+    thread_ = std::thread(&StubRequest::work, this);
+  }
+  ~StubRequest()
+  {
+    {
+      std::lock_guard<std::mutex> lk(mutex_);
+      stopping_ = true;
+    }
+    cv_.notify_all();
+    thread_.join();
+  }
+
+  InferenceEngine::Blob::Ptr getInput(const std::string & name) override
+  {
+    throw std::logic_error("No input " + name + " in the stub request");
+  }
+  void setInput(const std::string & name, const InferenceEngine::Blob::Ptr &) override
+  {
+    throw std::logic_error("No input " + name + " in the stub request");
+  }
+  InferenceEngine::Blob::CPtr getOutput(const std::string & name) override
+  {
+    throw std::logic_error("No output " + name + " in the stub request");
+  }
+  void setBatch(int) override
+  {
+  }
+  void startAsync() override
+  {
+    {
+      std::lock_guard<std::mutex> lk(mutex_);
+      started_ = true;
+    }
+    cv_.notify_all();
+  }
+  void infer() override
+  {
+  }
+  void cancel() override
+  {
+  }
+  void setCompletionCallback(const std::function<void(bool)> & callback) override
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    callback_ = callback;
+  }
+
+  int tag = -1;
+
+private:
+  void work()
+  {
+    std::unique_lock<std::mutex> lk(mutex_);
+    while (true) {
+      cv_.wait(lk, [this]() {return started_ || stopping_;});
+      if (stopping_) {
+        return;
+      }
+      started_ = false;
+      lk.unlock();
+      std::this_thread::sleep_for(std::chrono::microseconds(200));
+      // the callback is run unlocked, as by a device, and may be replaced meanwhile
+      lk.lock();
+      auto callback = callback_;
+      lk.unlock();
+      if (callback) {
+        callback(true);
+      }
+      lk.lock();
+    }
+  }
+
+  std::function<void(bool)> callback_;
+  bool started_ = false;
+  bool stopping_ = false;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::thread thread_;
+};
+
+std::shared_ptr<Engines::Engine> createStubEngine(int requests)
+{
+  std::vector<Engines::RequestBackend::Ptr> pool;
+  for (int i = 0; i < requests; i++) {
+    pool.push_back(std::make_shared<StubRequest>());
+  }
+  return std::make_shared<Engines::Engine>(pool);
+}
+}  // namespace
+
+TEST(UnitTestAsyncRunner, testJobsShareThePool)
+{
+  const int jobs = 150;
+  auto engine = createStubEngine(3);
+  Engines::AsyncRunner runner(engine);
+  std::atomic<int> running{0};
+  std::atomic<int> max_running{0};
+  std::atomic<int> continued{0};
+  std::vector<int> tags(jobs, -1);
+  std::mutex tags_mutex;
+
+  for (int job = 0; job < jobs; job++) {
+    runner.submit(
+      [&, job](Engines::RequestBackend & request) {
+        int now = ++running;
+        int max = max_running;
+        while (now > max && !max_running.compare_exchange_weak(max, now)) {
+        }
+        static_cast<StubRequest &>(request).tag = job;
+      },
+      [&](Engines::RequestBackend & request, bool succeeded) {
+        EXPECT_TRUE(succeeded);
+        int tag = static_cast<StubRequest &>(request).tag;
+        {
+          std::lock_guard<std::mutex> lk(tags_mutex);
+          ASSERT_GE(tag, 0);
+          ASSERT_LT(tag, jobs);
+          tags[tag] = tag;
+        }
+        --running;
+        ++continued;
+      });
+  }
+  runner.waitIdle();
+
+  EXPECT_EQ(continued, jobs);
+  EXPECT_EQ(runner.getActiveJobs(), 0u);
+  EXPECT_LE(max_running, 3);
+  // each job read the outputs of its own run
+  for (int job = 0; job < jobs; job++) {
+    EXPECT_EQ(tags[job], job);
+  }
+  // all the requests went back to the pool
+  for (int i = 0; i < 3; i++) {
+    EXPECT_GE(engine->acquireRequest(), 0);
+  }
+  EXPECT_LT(engine->acquireRequest(), 0);
+}
+
+TEST(UnitTestAsyncRunner, testInferFutures)
+{
+  auto engine = createStubEngine(3);
+  Engines::AsyncRunner runner(engine);
+  std::vector<std::future<int>> results;
+  for (int job = 0; job < 150; job++) {
+    results.push_back(runner.infer<int>(
+        [job](Engines::RequestBackend & request) {
+          static_cast<StubRequest &>(request).tag = job;
+        },
+        [](Engines::RequestBackend & request) {
+          return static_cast<StubRequest &>(request).tag * 2;
+        }));
+  }
+  for (int job = 0; job < 150; job++) {
+    EXPECT_EQ(results[job].get(), job * 2);
+  }
+}
+
+TEST(UnitTestAsyncRunner, testDestroyedWhileCompleting)
+{
+  // the runner is destroyed right after its last job is continued, while the
+  // completion of that job may still be returning on the thread of the request
+  auto engine = createStubEngine(3);
+  for (int round = 0; round < 50; round++) {
+    std::atomic<int> continued{0};
+    {
+      Engines::AsyncRunner runner(engine);
+      for (int job = 0; job < 150; job++) {
+        runner.submit(nullptr, [&continued](Engines::RequestBackend &, bool) {++continued;});
+      }
+    }
+    EXPECT_EQ(continued, 150);
+  }
+}
+
+int main(int argc, char * argv[])
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,119 @@
+// Copyright (c) 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "dynamic_vino_lib/engines/device_scheduler.hpp"
+
+namespace
+{
+void waitForWaiting(Engines::DeviceScheduler & scheduler, size_t waiting)
+{
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  while (scheduler.getWaiting() < waiting && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  ASSERT_EQ(scheduler.getWaiting(), waiting);
+}
+}  // namespace
+
+TEST(UnitTestDeviceScheduler, testWeightedShares)
+{
+  // one request at a time, held while the requests of both clients queue up
+  Engines::DeviceScheduler scheduler(1);
+  scheduler.setWeight("critical", 3);
+  scheduler.setWeight("background", 1);
+  scheduler.admit("holder");
+
+  const int requests = 8;
+  std::mutex order_mutex;
+  std::vector<std::string> order;
+  std::vector<std::thread> threads;
+  for (const std::string client : {"critical", "background"}) {
+    for (int i = 0; i < requests; i++) {
+      threads.emplace_back([&scheduler, &order_mutex, &order, client]() {
+          scheduler.admit(client);
+          {
+            std::lock_guard<std::mutex> lk(order_mutex);
+            order.push_back(client);
+          }
+          scheduler.release();
+        });
+    }
+  }
+  waitForWaiting(scheduler, 2 * requests);
+  scheduler.release();
+  for (auto & thread : threads) {
+    thread.join();
+  }
+
+  ASSERT_EQ(order.size(), 2u * requests);
+  // while both are backlogged the admissions follow the weights, 3 to 1
+  EXPECT_EQ(std::count(order.begin(), order.begin() + requests, "critical"), 6);
+  EXPECT_EQ(std::count(order.begin(), order.begin() + 4, "critical"), 3);
+  // then the critical client is done, the background one gets the device alone
+  EXPECT_EQ(std::count(order.begin() + requests, order.end(), "background"), 6);
+  EXPECT_EQ(scheduler.getWaiting(), 0u);
+}
+
+TEST(UnitTestDeviceScheduler, testReleaseOnCompletion)
+{
+  Engines::DeviceScheduler scheduler(2);
+  scheduler.admit("first");
+  scheduler.admit("first");
+  // the device is full, the third request waits for one to complete
+  auto third = std::async(std::launch::async, [&scheduler]() {scheduler.admit("second");});
+  waitForWaiting(scheduler, 1);
+  EXPECT_EQ(third.wait_for(std::chrono::milliseconds(50)), std::future_status::timeout);
+
+  scheduler.release();
+  ASSERT_EQ(third.wait_for(std::chrono::seconds(10)), std::future_status::ready);
+  EXPECT_EQ(scheduler.getWaiting(), 0u);
+
+  // once every request is released, the next ones are admitted at once
+  scheduler.release();
+  scheduler.release();
+  scheduler.admit("second");
+  scheduler.admit("first");
+  scheduler.release();
+  scheduler.release();
+  EXPECT_GT(scheduler.getBusySeconds(), 0);
+}
+
+TEST(UnitTestDeviceScheduler, testNoLimit)
+{
+  Engines::DeviceScheduler scheduler(0);
+  // no admission control, nothing blocks
+  for (int i = 0; i < 16; i++) {
+    scheduler.admit("client");
+  }
+  EXPECT_EQ(scheduler.getWaiting(), 0u);
+  for (int i = 0; i < 16; i++) {
+    scheduler.release();
+  }
+}
+
+int main(int argc, char * argv[])
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
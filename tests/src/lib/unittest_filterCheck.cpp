@@ -0,0 +1,144 @@
+// Copyright (c) 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "dynamic_vino_lib/inferences/object_detection.hpp"
+
+using dynamic_vino_lib::ObjectDetectionResult;
+using dynamic_vino_lib::ObjectDetectionResultFilter;
+
+namespace
+{
+/**
+ * @brief Results of every label and confidence of the conditions below, each
+ * at its own location so that the filtered ones can be told apart.
+ */
+std::vector<ObjectDetectionResult> makeResults()
+{
+  const std::vector<std::string> labels = {"person", "car", "dog", "per son"};
+  const std::vector<float> confidences = {0.1f, 0.5f, 0.7f, 0.8f, 0.95f};
+  std::vector<ObjectDetectionResult> results;
+  for (auto & label : labels) {
+    for (auto confidence : confidences) {
+      ObjectDetectionResult result(cv::Rect(static_cast<int>(results.size()) * 10, 0, 10, 10));
+      result.setLabel(label);
+      result.setConfidence(confidence);
+      results.push_back(result);
+    }
+  }
+  return results;
+}
+
+/**
+ * @brief Filter the results the way of the filters before the predicates were
+ * compiled: the suffix conditions evaluated for each result by ISVALIDRESULT.
+ */
+std::vector<cv::Rect> filterByMacro(
+  const std::vector<ObjectDetectionResult> & results, const std::string & conditions)
+{
+  ObjectDetectionResultFilter filter;
+  filter.init();
+  filter.acceptFilterConditions(conditions);
+  filter.acceptResults(results);
+  return filter.getFilteredLocations();
+}
+
+std::vector<cv::Rect> filterByPredicate(
+  const std::vector<ObjectDetectionResult> & results, const std::string & conditions)
+{
+  ObjectDetectionResultFilter filter;
+  filter.init();
+  std::vector<cv::Rect> locations;
+  filter.getFilteredLocations(results, conditions, locations);
+  return locations;
+}
+
+size_t countLabel(
+  const std::vector<ObjectDetectionResult> & results, const std::vector<cv::Rect> & locations,
+  const std::string & label)
+{
+  size_t count = 0;
+  for (auto & result : results) {
+    if (result.getLabel() == label &&
+      std::find(locations.begin(), locations.end(), result.getLocation()) != locations.end())
+    {
+      count++;
+    }
+  }
+  return count;
+}
+}  // namespace
+
+TEST(UnitTestFilter, testCompiledMatchesMacro)
+{
+  auto results = makeResults();
+  const std::vector<std::string> conditions = {
+    "label == person",
+    "label != person",
+    "label==car",
+    "confidence >= 0.7",
+    "confidence > 0.7",
+    "confidence <= 0.5",
+    "confidence < 0.5",
+    "label == person && confidence >= 0.8",
+    "label == person || label == car",
+    "label == person || label == car && confidence > 0.6",
+    "(label == person || label == car) && confidence > 0.6",
+    "label == dog && (confidence < 0.2 || confidence > 0.9)",
+    "((label == car))",
+    "label != dog && label != car && confidence >= 0.5",
+  };
+  for (auto & condition : conditions) {
+    auto expected = filterByMacro(results, condition);
+    auto compiled = filterByPredicate(results, condition);
+    EXPECT_EQ(expected, compiled) << condition;
+  }
+}
+
+TEST(UnitTestFilter, testCompiledResults)
+{
+  auto results = makeResults();
+  auto locations = filterByPredicate(results, "label == person && confidence >= 0.8");
+  EXPECT_EQ(locations.size(), 2u);
+  EXPECT_EQ(countLabel(results, locations, "person"), 2u);
+
+  locations = filterByPredicate(results, "(label == person || label == car) && confidence > 0.6");
+  EXPECT_EQ(locations.size(), 6u);
+  EXPECT_EQ(countLabel(results, locations, "person"), 3u);
+  EXPECT_EQ(countLabel(results, locations, "car"), 3u);
+
+  // the spaces are stripped from the conditions, as they always were
+  locations = filterByPredicate(results, "label == per son");
+  EXPECT_EQ(locations.size(), 5u);
+  EXPECT_EQ(countLabel(results, locations, "person"), 5u);
+}
+
+TEST(UnitTestFilter, testMalformedConditionsAcceptAll)
+{
+  auto results = makeResults();
+  EXPECT_EQ(filterByPredicate(results, "").size(), results.size());
+  EXPECT_EQ(filterByPredicate(results, "label ==").size(), results.size());
+  EXPECT_EQ(filterByPredicate(results, "color == red").size(), results.size());
+}
+
+int main(int argc, char * argv[])
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,100 @@
+// Copyright (c) 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <vector>
+
+#include "dynamic_vino_lib/utils/frame_pool.hpp"
+
+// the pool is process-wide: each test uses sizes of its own and checks deltas
+
+TEST(UnitTestFramePool, testBufferIsReused)
+{
+  auto & pool = FramePool::getInstance();
+  cv::Mat frame = FramePool::create(cv::Size(641, 481), CV_8UC3);
+  const uchar * data = frame.data;
+  size_t allocated = pool.getAllocatedBytes();
+  size_t free_bytes = pool.getFreeBytes();
+
+  frame.release();
+  EXPECT_EQ(pool.getFreeBytes(), free_bytes + 641 * 481 * 3);
+  // the next frame of the size takes the same buffer, nothing is allocated
+  frame = FramePool::create(cv::Size(641, 481), CV_8UC3);
+  EXPECT_EQ(frame.data, data);
+  EXPECT_EQ(pool.getAllocatedBytes(), allocated);
+  EXPECT_EQ(pool.getFreeBytes(), free_bytes);
+}
+
+TEST(UnitTestFramePool, testSharedBufferGoesBackOnLastRelease)
+{
+  auto & pool = FramePool::getInstance();
+  cv::Mat frame = FramePool::create(cv::Size(643, 483), CV_8UC3);
+  size_t free_bytes = pool.getFreeBytes();
+  cv::Mat borrowed = frame;
+  frame.release();
+  EXPECT_EQ(pool.getFreeBytes(), free_bytes);
+  borrowed.release();
+  EXPECT_EQ(pool.getFreeBytes(), free_bytes + 643 * 483 * 3);
+}
+
+TEST(UnitTestFramePool, testClone)
+{
+  cv::Mat source(47, 61, CV_8UC3);
+  cv::randu(source, cv::Scalar::all(0), cv::Scalar::all(255));
+  cv::Mat copy = FramePool::clone(source);
+  EXPECT_NE(copy.data, source.data);
+  EXPECT_EQ(copy.allocator, &FramePool::getInstance());
+  EXPECT_EQ(cv::norm(copy, source, cv::NORM_INF), 0);
+}
+
+TEST(UnitTestFramePool, testWrapKeepsOwnerAlive)
+{
+  auto pixels = std::make_shared<std::vector<uchar>>(32 * 24 * 3, 7);
+  std::weak_ptr<std::vector<uchar>> owner = pixels;
+  cv::Mat wrapped = FramePool::wrap(
+    cv::Mat(24, 32, CV_8UC3, pixels->data()), pixels);
+  pixels.reset();
+  EXPECT_FALSE(owner.expired());
+  EXPECT_EQ(wrapped.at<cv::Vec3b>(23, 31)[2], 7);
+
+  cv::Mat borrowed = wrapped;
+  wrapped.release();
+  EXPECT_FALSE(owner.expired());
+  borrowed.release();
+  EXPECT_TRUE(owner.expired());
+}
+
+TEST(UnitTestFramePool, testMaxFreeBuffers)
+{
+  auto & pool = FramePool::getInstance();
+  pool.setMaxFreeBuffers(1);
+  cv::Mat first = FramePool::create(cv::Size(645, 485), CV_8UC3);
+  cv::Mat second = FramePool::create(cv::Size(645, 485), CV_8UC3);
+  size_t allocated = pool.getAllocatedBytes();
+  size_t free_bytes = pool.getFreeBytes();
+  first.release();
+  second.release();
+  // one buffer is kept, the other is freed
+  EXPECT_EQ(pool.getFreeBytes(), free_bytes + 645 * 485 * 3);
+  EXPECT_EQ(pool.getAllocatedBytes(), allocated - 645 * 485 * 3);
+  pool.setMaxFreeBuffers(32);
+}
+
+int main(int argc, char * argv[])
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,134 @@
+// Copyright (c) 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "dynamic_vino_lib/utils/mask_codec.hpp"
+
+// encodes the map as a keyframe, decodes it and compares it pixel by pixel
+static void expectRoundTrip(const cv::Mat & class_map)
+{
+  std::vector<uint32_t> runs;
+  encodeMaskRuns(class_map, cv::Mat(), runs);
+  cv::Mat decoded;
+  ASSERT_TRUE(decodeMaskRuns(kMaskEncoding_Rle, class_map.cols, class_map.rows, runs, decoded));
+  ASSERT_EQ(decoded.size(), class_map.size());
+  ASSERT_EQ(decoded.type(), CV_16UC1);
+  cv::Mat expected;
+  class_map.convertTo(expected, CV_16U);
+  EXPECT_EQ(cv::countNonZero(decoded != expected), 0);
+}
+
+TEST(UnitTestMaskCodec, testEmptyMask)
+{
+  std::vector<uint32_t> runs;
+  encodeMaskRuns(cv::Mat(), cv::Mat(), runs);
+  EXPECT_TRUE(runs.empty());
+  cv::Mat decoded;
+  EXPECT_TRUE(decodeMaskRuns(kMaskEncoding_Rle, 0, 0, runs, decoded));
+  EXPECT_TRUE(decoded.empty());
+}
+
+TEST(UnitTestMaskCodec, testAllOnes)
+{
+  cv::Mat class_map(48, 64, CV_8UC1, cv::Scalar(1));
+  std::vector<uint32_t> runs;
+  encodeMaskRuns(class_map, cv::Mat(), runs);
+  // a single run across the rows
+  EXPECT_EQ(runs, std::vector<uint32_t>({1, 48 * 64}));
+  expectRoundTrip(class_map);
+}
+
+TEST(UnitTestMaskCodec, testAlternatingRuns)
+{
+  // runs of 1, 2, 3... pixels of alternating classes, some spanning rows
+  cv::Mat class_map(16, 20, CV_16UC1);
+  uint16_t * pixels = class_map.ptr<uint16_t>();
+  std::vector<uint32_t> expected;
+  size_t offset = 0;
+  for (uint32_t length = 1; offset < class_map.total(); length++) {
+    uint16_t value = expected.size() / 2 % 2 ? 300 : 2;
+    length = std::min<uint32_t>(length, class_map.total() - offset);
+    std::fill(pixels + offset, pixels + offset + length, value);
+    expected.push_back(value);
+    expected.push_back(length);
+    offset += length;
+  }
+  std::vector<uint32_t> runs;
+  encodeMaskRuns(class_map, cv::Mat(), runs);
+  EXPECT_EQ(runs, expected);
+  expectRoundTrip(class_map);
+
+  // a checkerboard of odd width, every run is one pixel long, across the rows too
+  cv::Mat checkerboard(10, 9, CV_8UC1);
+  for (int row = 0; row < checkerboard.rows; row++) {
+    for (int col = 0; col < checkerboard.cols; col++) {
+      checkerboard.at<uint8_t>(row, col) = (row + col) % 2;
+    }
+  }
+  encodeMaskRuns(checkerboard, cv::Mat(), runs);
+  EXPECT_EQ(runs.size(), 2u * 10 * 9);
+  expectRoundTrip(checkerboard);
+}
+
+TEST(UnitTestMaskCodec, testOddWidths)
+{
+  for (int width : {1, 3, 7, 33, 641}) {
+    cv::Mat class_map(5, width, CV_8UC1);
+    cv::randu(class_map, cv::Scalar(0), cv::Scalar(4));
+    SCOPED_TRACE(width);
+    expectRoundTrip(class_map);
+    // a region of interest, its rows are not contiguous
+    cv::Mat wide(5, width + 2, CV_8UC1);
+    cv::randu(wide, cv::Scalar(0), cv::Scalar(4));
+    expectRoundTrip(wide(cv::Rect(1, 0, width, 5)));
+  }
+}
+
+TEST(UnitTestMaskCodec, testDelta)
+{
+  cv::Mat previous(7, 13, CV_8UC1);
+  cv::randu(previous, cv::Scalar(0), cv::Scalar(3));
+  cv::Mat current = previous.clone();
+  current(cv::Rect(2, 3, 5, 2)).setTo(9);
+  std::vector<uint32_t> runs;
+  encodeMaskRuns(current, previous, runs);
+
+  cv::Mat decoded;
+  previous.convertTo(decoded, CV_16U);
+  ASSERT_TRUE(decodeMaskRuns(kMaskEncoding_RleDelta, 13, 7, runs, decoded));
+  cv::Mat expected;
+  current.convertTo(expected, CV_16U);
+  EXPECT_EQ(cv::countNonZero(decoded != expected), 0);
+
+  // without the previous map the delta can't be applied
+  cv::Mat missing;
+  EXPECT_FALSE(decodeMaskRuns(kMaskEncoding_RleDelta, 13, 7, runs, missing));
+}
+
+TEST(UnitTestMaskCodec, testRunsNotCoveringTheMap)
+{
+  cv::Mat decoded;
+  EXPECT_FALSE(decodeMaskRuns(kMaskEncoding_Rle, 4, 4, {1, 15}, decoded));
+  EXPECT_FALSE(decodeMaskRuns(kMaskEncoding_Rle, 4, 4, {1, 10, 2, 7}, decoded));
+}
+
+int main(int argc, char * argv[])
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,110 @@
+// Copyright (c) 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "dynamic_vino_lib/utils/scratch_arena.hpp"
+
+TEST(UnitTestScratchArena, testScopeGivesBack)
+{
+  ScratchArena arena;
+  void * first = nullptr;
+  {
+    ScratchArena::Scope scope(arena);
+    first = arena.allocate(100);
+    {
+      ScratchArena::Scope inner(arena);
+      EXPECT_NE(arena.allocate(100), first);
+    }
+    // the inner scope gave back its memory only
+    void * second = arena.allocate(100);
+    EXPECT_NE(second, first);
+    ScratchArena::Scope again(arena);
+    EXPECT_NE(arena.allocate(100), second);
+  }
+  ScratchArena::Scope scope(arena);
+  EXPECT_EQ(arena.allocate(100), first);
+}
+
+TEST(UnitTestScratchArena, testAlignment)
+{
+  ScratchArena arena;
+  arena.allocate(3, 1);
+  for (size_t alignment : {8, 16, 64, 256}) {
+    auto address = reinterpret_cast<uintptr_t>(arena.allocate(5, alignment));
+    EXPECT_EQ(address % alignment, 0u) << alignment;
+  }
+}
+
+TEST(UnitTestScratchArena, testResetMergesBlocks)
+{
+  ScratchArena arena;
+  // more than the first block, across several of them
+  for (int i = 0; i < 8; i++) {
+    arena.allocate(48 * 1024);
+  }
+  size_t capacity = arena.getCapacity();
+  EXPECT_GE(capacity, 8u * 48 * 1024);
+
+  // the next frame fits in the merged block and allocates nothing
+  arena.reset();
+  EXPECT_EQ(arena.getCapacity(), capacity);
+  for (int i = 0; i < 8; i++) {
+    arena.allocate(48 * 1024);
+  }
+  EXPECT_EQ(arena.getCapacity(), capacity);
+}
+
+TEST(UnitTestScratchArena, testScratchVector)
+{
+  ScratchArena arena;
+  {
+    ScratchArena::Scope scope(arena);
+    ScratchVector<int> values{ScratchAllocator<int>(arena)};
+    for (int i = 0; i < 1000; i++) {
+      values.push_back(i);
+    }
+    for (int i = 0; i < 1000; i++) {
+      ASSERT_EQ(values[i], i);
+    }
+  }
+  // the capacity of the scope is reused by the next one
+  size_t capacity = arena.getCapacity();
+  {
+    ScratchArena::Scope scope(arena);
+    ScratchVector<int> values{ScratchAllocator<int>(arena)};
+    values.resize(1000);
+    EXPECT_EQ(arena.getCapacity(), capacity);
+  }
+}
+
+TEST(UnitTestScratchArena, testThreadArenas)
+{
+  ScratchArena * main_arena = &ScratchArena::getThreadArena();
+  ScratchArena * other_arena = nullptr;
+  std::thread thread([&other_arena]() {other_arena = &ScratchArena::getThreadArena();});
+  thread.join();
+  EXPECT_NE(main_arena, other_arena);
+  EXPECT_EQ(main_arena, &ScratchArena::getThreadArena());
+}
+
+int main(int argc, char * argv[])
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,116 @@
+// Copyright (c) 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "dynamic_vino_lib/inferences/base_reidentification.hpp"
+
+namespace
+{
+const int kFeatureSize = 16;
+
+/**
+ * @brief The feature of a person, orthogonal to the features of the others.
+ */
+std::vector<float> getFeature(int person)
+{
+  std::vector<float> feature(kFeatureSize, 0.0f);
+  feature[person] = 1.0f;
+  return feature;
+}
+}  // namespace
+
+TEST(UnitTestTracker, testMatchedTrackKeepsItsId)
+{
+  dynamic_vino_lib::Tracker tracker(3, 0.9, 0.3);
+  int a = tracker.processNewTrack(getFeature(0));
+  int b = tracker.processNewTrack(getFeature(1));
+  EXPECT_NE(a, b);
+  EXPECT_EQ(tracker.processNewTrack(getFeature(0)), a);
+  EXPECT_EQ(tracker.processNewTrack(getFeature(1)), b);
+}
+
+TEST(UnitTestTracker, testEvictsLeastRecentlyUpdated)
+{
+  dynamic_vino_lib::Tracker tracker(3, 0.9, 0.3);
+  int p0 = tracker.processNewTrack(getFeature(0));
+  int p1 = tracker.processNewTrack(getFeature(1));
+  int p2 = tracker.processNewTrack(getFeature(2));
+  // p0 is the oldest track, but the most recently updated once matched again
+  EXPECT_EQ(tracker.processNewTrack(getFeature(0)), p0);
+
+  // p1, the least recently updated, is evicted by the new track: [p2, p0, p3]
+  int p3 = tracker.processNewTrack(getFeature(3));
+  EXPECT_EQ(tracker.processNewTrack(getFeature(0)), p0);
+  EXPECT_EQ(tracker.processNewTrack(getFeature(2)), p2);
+  // p1 comes back as a new track, evicting p3: [p0, p2, p1]
+  int p1_again = tracker.processNewTrack(getFeature(1));
+  EXPECT_NE(p1_again, p1);
+
+  EXPECT_EQ(tracker.processNewTrack(getFeature(0)), p0);
+  EXPECT_EQ(tracker.processNewTrack(getFeature(2)), p2);
+  // p3 comes back as a new track, evicting p1: [p0, p2, p3]
+  EXPECT_NE(tracker.processNewTrack(getFeature(3)), p3);
+  EXPECT_NE(tracker.processNewTrack(getFeature(1)), p1_again);
+}
+
+TEST(UnitTestTracker, testBatchUpdatesBeforeAdding)
+{
+  // a batch updates its matched tracks before adding the new ones, so that a
+  // track matched in the batch is never evicted by it
+  dynamic_vino_lib::Tracker tracker(2, 0.9, 0.3);
+  int p0 = tracker.processNewTrack(getFeature(0));
+  int p1 = tracker.processNewTrack(getFeature(1));
+  cv::Mat features(2, kFeatureSize, CV_32F, cv::Scalar(0));
+  features.at<float>(0, 2) = 1.0f;
+  features.at<float>(1, 0) = 1.0f;
+  auto ids = tracker.processNewTracks(features);
+  ASSERT_EQ(ids.size(), 2u);
+  EXPECT_EQ(ids[1], p0);
+  EXPECT_NE(ids[0], p1);
+  EXPECT_EQ(tracker.processNewTrack(getFeature(0)), p0);
+  EXPECT_NE(tracker.processNewTrack(getFeature(1)), p1);
+}
+
+TEST(UnitTestTracker, testSavedGalleryKeepsEvictionOrder)
+{
+  std::string path = "/tmp/dynamic_vino_unittest_tracker.bin";
+  int p0, p1, p2;
+  {
+    dynamic_vino_lib::Tracker tracker(3, 0.9, 0.3);
+    p0 = tracker.processNewTrack(getFeature(0));
+    p1 = tracker.processNewTrack(getFeature(1));
+    p2 = tracker.processNewTrack(getFeature(2));
+    EXPECT_EQ(tracker.processNewTrack(getFeature(0)), p0);
+    ASSERT_TRUE(tracker.saveTracksToFile(path));
+  }
+  dynamic_vino_lib::Tracker tracker(3, 0.9, 0.3);
+  ASSERT_TRUE(tracker.loadTracksFromFile(path));
+  std::remove(path.c_str());
+  // [p1, p2, p0] as saved: the next new track evicts p1
+  tracker.processNewTrack(getFeature(3));
+  EXPECT_EQ(tracker.processNewTrack(getFeature(0)), p0);
+  EXPECT_EQ(tracker.processNewTrack(getFeature(2)), p2);
+  EXPECT_NE(tracker.processNewTrack(getFeature(1)), p1);
+}
+
+int main(int argc, char * argv[])
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,132 @@
+// Copyright (c) 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "dynamic_vino_lib/inferences/object_detection.hpp"
+#include "dynamic_vino_lib/models/object_detection_yolov2_model.hpp"
+#include "dynamic_vino_lib/utils/scratch_arena.hpp"
+
+namespace
+{
+/**
+ * @brief Exposes the NMS of the YOLO models, which needs no network.
+ */
+class YoloNms : public Models::ObjectDetectionYolov2Model
+{
+public:
+  using Models::ObjectDetectionYolov2Model::Candidate;
+  using Models::ObjectDetectionYolov2Model::suppressCandidates;
+};
+
+YoloNms::Candidate makeCandidate(float x, float y, float size, float confidence, int class_id)
+{
+  YoloNms::Candidate candidate;
+  candidate.box = cv::Rect2f(x, y, size, size);
+  candidate.confidence = confidence;
+  candidate.class_id = class_id;
+  return candidate;
+}
+
+void suppress(
+  const std::vector<YoloNms::Candidate> & input, float nms_threshold, int top_k,
+  dynamic_vino_lib::ObjectDetectionArena & detections)
+{
+  ScratchArena::Scope scratch;
+  ScratchVector<YoloNms::Candidate> candidates(input.begin(), input.end());
+  YoloNms::suppressCandidates(candidates, nms_threshold, top_k, detections);
+}
+}  // namespace
+
+TEST(UnitTestYoloNms, testSuppressesOverlapsOfAClass)
+{
+  std::vector<YoloNms::Candidate> candidates = {
+    // two overlapping boxes of class 1 (IoU 0.82), the less confident one suppressed
+    makeCandidate(0, 0, 100, 0.6f, 1),
+    makeCandidate(5, 5, 100, 0.9f, 1),
+    // a box of class 1 apart from them
+    makeCandidate(300, 300, 50, 0.5f, 1),
+    // the same place in class 2 is kept: the NMS is per class
+    makeCandidate(0, 0, 100, 0.7f, 2),
+  };
+  dynamic_vino_lib::ObjectDetectionArena detections;
+  suppress(candidates, 0.5f, 0, detections);
+
+  ASSERT_EQ(detections.size(), 3u);
+  // the most confident first
+  EXPECT_FLOAT_EQ(detections.getConfidences()[0], 0.9f);
+  EXPECT_EQ(detections.getLabelIds()[0], 1);
+  EXPECT_EQ(detections.getLocations()[0], cv::Rect(5, 5, 100, 100));
+  EXPECT_FLOAT_EQ(detections.getConfidences()[1], 0.7f);
+  EXPECT_EQ(detections.getLabelIds()[1], 2);
+  EXPECT_FLOAT_EQ(detections.getConfidences()[2], 0.5f);
+  EXPECT_EQ(detections.getLabelIds()[2], 1);
+}
+
+TEST(UnitTestYoloNms, testThreshold)
+{
+  // IoU of 50x50 boxes shifted by 25: 1250 / 3750 = 0.33
+  std::vector<YoloNms::Candidate> candidates = {
+    makeCandidate(0, 0, 50, 0.9f, 0),
+    makeCandidate(25, 0, 50, 0.8f, 0),
+  };
+  dynamic_vino_lib::ObjectDetectionArena kept;
+  suppress(candidates, 0.4f, 0, kept);
+  EXPECT_EQ(kept.size(), 2u);
+
+  dynamic_vino_lib::ObjectDetectionArena suppressed;
+  suppress(candidates, 0.3f, 0, suppressed);
+  ASSERT_EQ(suppressed.size(), 1u);
+  EXPECT_FLOAT_EQ(suppressed.getConfidences()[0], 0.9f);
+}
+
+TEST(UnitTestYoloNms, testTopK)
+{
+  std::vector<YoloNms::Candidate> candidates;
+  for (int i = 0; i < 10; i++) {
+    // apart from each other, in two classes, in no particular order of confidence
+    candidates.push_back(makeCandidate(i * 100.0f, 0, 50, 0.1f + 0.08f * ((i * 7) % 10), i % 2));
+  }
+  dynamic_vino_lib::ObjectDetectionArena all;
+  suppress(candidates, 0.5f, 0, all);
+  EXPECT_EQ(all.size(), 10u);
+
+  dynamic_vino_lib::ObjectDetectionArena top;
+  suppress(candidates, 0.5f, 3, top);
+  ASSERT_EQ(top.size(), 3u);
+  // the 3 most confident of all the classes, in order
+  for (size_t i = 0; i < top.size(); i++) {
+    EXPECT_FLOAT_EQ(top.getConfidences()[i], all.getConfidences()[i]);
+    EXPECT_EQ(top.getLocations()[i], all.getLocations()[i]);
+  }
+  EXPECT_FLOAT_EQ(top.getConfidences()[0], 0.1f + 0.08f * 9);
+  EXPECT_GT(top.getConfidences()[0], top.getConfidences()[1]);
+  EXPECT_GT(top.getConfidences()[1], top.getConfidences()[2]);
+}
+
+TEST(UnitTestYoloNms, testNoCandidate)
+{
+  std::vector<YoloNms::Candidate> candidates;
+  dynamic_vino_lib::ObjectDetectionArena detections;
+  suppress(candidates, 0.5f, 5, detections);
+  EXPECT_EQ(detections.size(), 0u);
+}
+
+int main(int argc, char * argv[])
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
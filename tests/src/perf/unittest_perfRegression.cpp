@@ -0,0 +1,283 @@
+// Copyright (c) 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <ament_index_cpp/get_package_prefix.hpp>
+#include <ament_index_cpp/get_package_share_directory.hpp>
+#include <yaml-cpp/yaml.h>
+
+#include <unistd.h>
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+static YAML::Node baselines;
+static YAML::Node recorded;
+static double tolerance = 0.15;
+
+static std::string getExecutable(const std::string & package, const std::string & name)
+{
+  std::string path;
+  try {
+    path = ament_index_cpp::get_package_prefix(package) + "/lib/" + package + "/" + name;
+  } catch (...) {
+    return "";
+  }
+  return access(path.c_str(), X_OK) == 0 ? path : "";
+}
+
+static std::string getCpuModel()
+{
+  std::ifstream cpuinfo("/proc/cpuinfo");
+  std::string line;
+  while (std::getline(cpuinfo, line)) {
+    if (line.compare(0, 10, "model name") == 0) {
+      auto colon = line.find(':');
+      return colon == std::string::npos ? "" : line.substr(line.find_first_not_of(' ', colon + 1));
+    }
+  }
+  return "";
+}
+
+/**
+ * @brief Whether the baselines were recorded on this machine, else why not.
+ */
+static bool isReferenceMachine(std::string & reason)
+{
+  auto reference = baselines["reference_cpu"];
+  if (!reference || reference.IsNull()) {
+    reason = "no reference machine is recorded in perf_baselines.yaml";
+    return false;
+  }
+  std::string cpu = getCpuModel();
+  if (cpu != reference.as<std::string>()) {
+    reason = "the baselines were recorded on '" + reference.as<std::string>() +
+      "', not on '" + cpu + "'";
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Get the baseline of a measure, false if none is recorded.
+ */
+static bool getBaseline(const YAML::Node & node, double & baseline)
+{
+  if (!node || node.IsNull()) {
+    return false;
+  }
+  baseline = node.as<double>();
+  return baseline > 0;
+}
+
+/**
+ * @brief Whether the measures are recorded (DYNAMIC_VINO_PERF_RECORD), they
+ * are then run even where they can't be checked.
+ */
+static bool isRecording()
+{
+  return std::getenv("DYNAMIC_VINO_PERF_RECORD") != nullptr;
+}
+
+static std::string join(const std::vector<std::string> & names)
+{
+  std::string joined;
+  for (auto & name : names) {
+    joined += (joined.empty() ? "" : ", ") + name;
+  }
+  return joined;
+}
+
+static double toNanoseconds(double time, const std::string & unit)
+{
+  if (unit == "us") {
+    return time * 1e3;
+  } else if (unit == "ms") {
+    return time * 1e6;
+  } else if (unit == "s") {
+    return time * 1e9;
+  }
+  return time;
+}
+
+TEST(UnitTestPerfRegression, testKernels)
+{
+  // nothing is run unless it can be checked, or recorded
+  std::string reason;
+  bool reference = isReferenceMachine(reason);
+  if (!reference && !isRecording()) {
+    GTEST_SKIP() << "The kernels are not checked: " << reason;
+  }
+  std::string executable = getExecutable("dynamic_vino_test", "benchmark_kernels");
+  if (executable.empty()) {
+    GTEST_SKIP() << "benchmark_kernels is not built (Google Benchmark not found), " <<
+      "the kernels are not checked";
+  }
+  std::vector<std::string> names;
+  std::vector<std::string> missing;
+  double baseline = 0;
+  for (auto kernel : baselines["kernels"]) {
+    std::string name = kernel.first.as<std::string>();
+    if (isRecording() || getBaseline(kernel.second, baseline)) {
+      names.push_back(name);
+    } else {
+      missing.push_back(name);
+    }
+  }
+  if (names.empty()) {
+    GTEST_SKIP() << "No baseline for " << join(missing);
+  }
+  std::string report = "/tmp/dynamic_vino_perf_kernels.json";
+  // only the kernels listed are run
+  std::string filter;
+  for (auto & name : names) {
+    filter += (filter.empty() ? "^" : "$|^") + name;
+  }
+  std::string command = executable + " --benchmark_filter='" + filter + "$'" +
+    " --benchmark_out=" + report + " --benchmark_out_format=json > /dev/null";
+  ASSERT_EQ(0, std::system(command.c_str())) << command;
+
+  YAML::Node results = YAML::LoadFile(report);
+  std::map<std::string, double> measured;
+  for (auto result : results["benchmarks"]) {
+    measured[result["name"].as<std::string>()] = toNanoseconds(
+      result["cpu_time"].as<double>(), result["time_unit"].as<std::string>());
+  }
+  for (auto & name : names) {
+    auto found = measured.find(name);
+    ASSERT_NE(found, measured.end()) << "No result for " << name;
+    recorded["kernels"][name] = static_cast<int64_t>(found->second);
+    if (!getBaseline(baselines["kernels"][name], baseline)) {
+      std::cout << name << ": " << found->second << " ns, no baseline" << std::endl;
+      continue;
+    }
+    std::cout << name << ": " << found->second << " ns, baseline " << baseline << " ns" <<
+      std::endl;
+    if (reference) {
+      EXPECT_LE(found->second, baseline * (1 + tolerance)) << name <<
+        " is slower than its baseline";
+    }
+  }
+  if (!missing.empty()) {
+    std::cout << "Not checked, no baseline: " << join(missing) << std::endl;
+  }
+  if (!reference) {
+    GTEST_SKIP() << "The kernels are recorded, not checked: " << reason;
+  }
+}
+
+TEST(UnitTestPerfRegression, testPipelines)
+{
+  // nothing is run unless it can be checked, or recorded
+  std::string reason;
+  bool reference = isReferenceMachine(reason);
+  if (!reference && !isRecording()) {
+    GTEST_SKIP() << "The pipelines are not checked: " << reason;
+  }
+  std::string executable = getExecutable("dynamic_vino_sample", "pipeline_benchmark");
+  if (executable.empty()) {
+    GTEST_SKIP() << "pipeline_benchmark is not installed, the pipelines are not checked";
+  }
+  std::string param_dir = ament_index_cpp::get_package_share_directory("dynamic_vino_test") +
+    "/param/";
+  std::vector<std::string> missing;
+  int index = 0;
+  for (auto pipeline : baselines["pipelines"]) {
+    std::string config = pipeline["config"].as<std::string>();
+    std::string video = pipeline["video"].as<std::string>();
+    double baseline_fps = 0;
+    double baseline_p95 = 0;
+    bool checked = getBaseline(pipeline["fps"], baseline_fps) &&
+      getBaseline(pipeline["frame_p95"], baseline_p95);
+    if (!checked && !isRecording()) {
+      missing.push_back(config);
+      index++;
+      continue;
+    }
+    if (access(video.c_str(), R_OK) != 0) {
+      missing.push_back(config + " (no video " + video + ")");
+      index++;
+      continue;
+    }
+    std::string report = "/tmp/dynamic_vino_perf_pipeline_" + std::to_string(index) + ".json";
+    std::string command = executable + " -config " + param_dir + config + " -video " + video +
+      " -output " + report + " > /dev/null";
+    ASSERT_EQ(0, std::system(command.c_str())) << command;
+
+    YAML::Node results = YAML::LoadFile(report);
+    ASSERT_GT(results["pipelines"].size(), 0u) << "No pipeline run by " << config;
+    // the slowest of the pipelines, they all run on the same video
+    double fps = -1;
+    double frame_p95 = 0;
+    for (auto result : results["pipelines"]) {
+      double pipeline_fps = result["fps"].as<double>();
+      fps = fps < 0 ? pipeline_fps : std::min(fps, pipeline_fps);
+      for (auto stage : result["stages"]) {
+        if (stage["stage"].as<std::string>() == "frame") {
+          frame_p95 = std::max(frame_p95, stage["p95"].as<double>());
+        }
+      }
+    }
+    YAML::Node measured;
+    measured["config"] = config;
+    measured["video"] = video;
+    measured["fps"] = fps;
+    measured["frame_p95"] = frame_p95;
+    recorded["pipelines"].push_back(measured);
+    std::cout << config << ": " << fps << " fps, p95 frame latency " << frame_p95 << " ms" <<
+      std::endl;
+
+    EXPECT_GT(fps, 0) << config << " processed no frame";
+    if (checked && reference) {
+      EXPECT_GE(fps, baseline_fps * (1 - tolerance)) << config << " is slower than its baseline";
+      EXPECT_LE(frame_p95, baseline_p95 * (1 + tolerance)) << config <<
+        " has a higher latency than its baseline";
+    }
+    index++;
+  }
+  if (!missing.empty()) {
+    std::cout << "Not checked: " << join(missing) << std::endl;
+  }
+  if (!reference) {
+    GTEST_SKIP() << "The pipelines are recorded, not checked: " << reason;
+  }
+  if (missing.size() == baselines["pipelines"].size()) {
+    GTEST_SKIP() << "No pipeline checked: " << join(missing);
+  }
+}
+
+int main(int argc, char * argv[])
+{
+  testing::InitGoogleTest(&argc, argv);
+  std::string path = ament_index_cpp::get_package_share_directory("dynamic_vino_test") +
+    "/param/perf_baselines.yaml";
+  baselines = YAML::LoadFile(path);
+  tolerance = baselines["tolerance"].as<double>(tolerance);
+  int ret = RUN_ALL_TESTS();
+
+  // the measures as a baseline file, to record the baselines of a machine
+  const char * record = std::getenv("DYNAMIC_VINO_PERF_RECORD");
+  if (record != nullptr) {
+    recorded["reference_cpu"] = getCpuModel();
+    recorded["tolerance"] = tolerance;
+    std::ofstream out(record);
+    out << recorded << std::endl;
+    std::cout << "Measures recorded into " << record << std::endl;
+  }
+  return ret;
+}
@@ -68,6 +68,54 @@ public:
     int batch;
     float confidence_threshold = 0.5;
     bool enable_roi_constraint = false;
+    std::map<std::string, std::string> config;  // plugin config passed to LoadNetwork
+    int infer_requests = 0;  // size of the request pool, 0 for the device's optimal number
+    int input_buffers = 1;  // input/output blob sets per request, filled while it runs
+    float batch_wait = 0;  // ms a partial batch of ROIs waits for those of other frames
+    int warmup = 0;  // dummy inferences run per request when the engine is created
+    std::string preprocess = "opencv";  // "plugin" to resize/convert inside the plugin
+    float nms_threshold = 0.45;  // IoU above which overlapping detections are suppressed
+    int top_k = 0;  // maximum number of detections kept per frame, 0 for no limit
+    std::string mask_type = "colored";  // "class_id" to skip colorizing segmentation masks
+    std::string gallery_index = "exact";  // "ivf" for an approximate search of the reid tracks
+    int gallery_size = 1000;  // maximum number of reid tracks recorded
+    int gallery_lists = 64;  // partitions of the "ivf" gallery index
+    int gallery_probes = 4;  // partitions searched per query by the "ivf" gallery index
+    std::string gallery_precision = "fp32";  // "fp16" or "int8" to quantize the reid features
+    std::string gallery_file;  // binary file the reid tracks are loaded from and saved into
+    int gallery_snapshot_interval = 0;  // seconds between snapshots, 0 to save on exit only
+    bool gallery_fp16 = false;  // store the features of the gallery file as float16
+    std::string shared_gallery;  // name of the reid tracker shared across the pipelines
+    std::string tracker = "none";  // "sort" to track the detections across frames
+    int detect_interval = 1;  // with a tracker, frames between two detections
+    float track_iou = 0.3;  // IoU from which a detection matches a track
+    bool optical_flow = false;  // propagate the tracks by the optical flow between detections
+    int cache_interval = 0;  // frames a tracked ROI's result is reused for, 0 to always infer
+    float cache_iou = 0.5;  // refresh a reused result when its ROI moved below this IoU
+    float cache_confidence = 0;  // refresh the reused results less confident than this
+    int tile_size = 0;  // side of the tiles a frame is detected in, 0 for whole frames
+    float tile_overlap = 0.2;  // fraction of a tile overlapping its neighbours
+    int min_roi_area = 0;  // smallest ROI in pixels routed to this inference
+    float min_roi_aspect = 0;  // bounds of the width / height ratio of the ROIs, 0 for none
+    float max_roi_aspect = 0;
+    float min_roi_confidence = 0;  // smallest detection confidence of the ROIs
+    int min_track_age = 0;  // detection rounds a track is seen before its ROI is routed
+    int max_rois = 0;  // ROIs inferred at most per frame, 0 for no budget
+    std::string roi_priority = "area";  // "confidence" to keep the most confident within max_rois
+    float roi_merge_iou = 0;  // IoU above which a ROI of another parent is not inferred again
+    float roi_padding = 0;  // fraction of its size a ROI is enlarged by on each side
+    std::string roi_fit = "clip";  // "shift" to move the ROIs crossing the frame edge inside
+    int priority = 0;  // inferences of higher priority get the ROIs of a frame first
+    int every_n_frames = 1;  // the inference runs once every that many frames of an input
+    float max_hz = 0;  // runs of the inference per second at most, 0 for no limit
+    float request_timeout = 0;  // milliseconds before a request is cancelled, 0 for none
+    int max_errors = 3;  // consecutive failed requests before the fallback is loaded
+    std::string fallback_engine;  // device the network is loaded on when the engine fails
+    std::string fallback_model;  // lighter model loaded with the fallback, empty for the same
+    float fallback_fps = 0;  // frame rate of the pipeline once fallen back, 0 to keep it
+    std::vector<std::string> variants;  // models from the most accurate to the lightest
+    float variant_budget = 0;  // ms per request over which a lighter variant is loaded
+    std::string input_shape;  // SSD input reshaped to "WxH", "W:H" or "auto", empty for the IR's
   };
 
   struct FilterRawData
@@ -85,7 +133,55 @@ public:
     std::vector<std::string> outputs;
     std::multimap<std::string, std::string> connects;
     std::string input_meta;
+    std::map<std::string, std::string> input_metas;
     std::vector<FilterRawData> filters;
+    int frames_in_flight = 1;
+    std::string frame_policy = "all";
+    int frame_decimation = 1;
+    float target_fps = 0;
+    int preprocess_threads = 0;
+    int working_width = 0;  // width the frames are downscaled to when read, 0 for native
+    float motion_threshold = 0;
+    int motion_max_skip = 30;
+    std::map<std::string, std::string> input_rois;
+    int roi_refresh_interval = 10;
+    float frame_deadline = 0;  // milliseconds from capture to output, 0 for no deadline
+    float priority = 1;  // share of the shared devices given to the pipeline
+    int instances = 1;  // copies of the pipeline serving the image services concurrently
+    int response_cache = 0;  // responses of the image services memoized, 0 for none
+    float response_cache_ttl = 0;  // seconds a memoized response is served, 0 for ever
+    int output_queue = 0;  // frames queued per output thread, 0 to output on the pipeline thread
+    std::string image_transport = "raw";  // how RViz images are published, raw or compressed
+    int image_quality = 90;
+    float image_scale = 1;
+    float image_rate = 0;  // RViz images published per second at most, 0 for all
+    float preview_scale = 1;  // factor the ImageWindow and VideoWriter frames are drawn at
+    std::map<std::string, std::string> output_rates;  // output or output/topic -> rate
+    std::string video_directory = ".";
+    float video_fps = 30;
+    float video_segment = 0;  // seconds per video file at most, 0 for no bound
+    bool video_annotated = true;
+    std::string video_trigger = "always";  // always, or detections
+    float video_hold = 2;  // seconds recorded after the last detections
+    int shm_slots = 16;  // records kept in the shared memory ring
+    int shm_max_objects = 64;
+    bool shm_frames = false;
+    std::string result_log_directory = ".";
+    int result_log_batch = 4096;  // rows per batch of the result log
+    float result_log_flush = 1;  // seconds a batch is written after at most, 0 for no bound
+    std::string mask_encoding = "raw";  // how segmentation masks are published, raw or rle
+    int mask_keyframe_interval = 30;
+    int aggregate_frames = 1;  // frames per RosAggregate message
+    bool latency_topic = false;  // publish the times of each frame along with its results
+    bool lazy = false;  // load the networks on the first RUN_PIPELINE instead of at startup
+    bool staged_startup = false;  // run once the first-stage networks are loaded, cascades join later
+    float idle_unload = 0;  // seconds paused or stopped before the networks are unloaded
+    std::string cpu_set;  // CPUs the threads of the pipeline run on, e.g. "0-7,16-23"
+    int numa_node = -1;  // NUMA node the threads of the pipeline run on, -1 for any
+    float idle_activity = 0;  // fraction of the frames changed under which the scene is idle
+    float saving_fps = 0;  // frame rate while saving energy, 0 to keep it
+    int saving_detect_interval = 0;  // tracked frames between detections while saving, 0 to keep
+    bool saving_variants = false;  // load the lightest variant of the inferences while saving
   };
 
   struct CommonRawData
@@ -94,6 +190,16 @@ public:
     std::string custom_cldnn_library;
     bool enable_performance_count = false;
     std::string camera_topic;
+    std::string network_cache_dir;
+    int device_requests = 0;  // requests admitted at a time per device, 0 for no admission control
+    bool opencl_preprocess = false;  // resize and convert the inputs on the OpenCL device
+    int executor_threads = 0;  // threads spinning the nodes of the pipelines, 0 for one per core
+    float stats_period = 0;  // seconds between the pipeline stats messages, 0 for none
+    std::string log_level = "info";  // lowest level logged: debug, info, warn or error
+    std::string battery_topic;  // sensor_msgs/BatteryState topic of the robot, empty for none
+    float battery_low = 0;  // battery fraction under which the pipelines save energy, 0 for none
+    std::string temperature_file;  // device temperature, e.g. a sysfs thermal zone
+    float temperature_high = 0;  // degrees Celsius over which the pipelines save energy
   };
 
   /**
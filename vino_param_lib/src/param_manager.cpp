@@ -27,6 +27,17 @@ void operator>>(const YAML::Node & node, ParamManager::PipelineRawData & pipelin
 void operator>>(const YAML::Node & node, std::vector<ParamManager::InferenceRawData> & list);
 void operator>>(const YAML::Node & node, ParamManager::InferenceRawData & infer);
 void operator>>(const YAML::Node & node, std::vector<std::string> & list);
+void operator>>(const YAML::Node & node, std::map<std::string, std::string> & config);
+void operator>>(const YAML::Node & node, std::map<std::string, std::string> & config)
+{
+  if (!node.IsMap()) {
+    return;
+  }
+  for (auto it = node.begin(); it != node.end(); ++it) {
+    config[it->first.as<std::string>()] = it->second.as<std::string>();
+  }
+}
+
 void operator>>(const YAML::Node & node, std::multimap<std::string, std::string> & connect);
 void operator>>(const YAML::Node & node, std::vector<ParamManager::FilterRawData> & filters);
 void operator>>(const YAML::Node & node, std::string & str);
@@ -65,6 +76,16 @@ void operator>>(const YAML::Node & node, ParamManager::CommonRawData & common)
   YAML_PARSE(node, "custom_cpu_library", common.custom_cpu_library)
   YAML_PARSE(node, "custom_cldnn_library", common.custom_cldnn_library)
   YAML_PARSE(node, "enable_performance_count", common.enable_performance_count)
+  YAML_PARSE(node, "network_cache_dir", common.network_cache_dir)
+  YAML_PARSE(node, "device_requests", common.device_requests)
+  YAML_PARSE(node, "opencl_preprocess", common.opencl_preprocess)
+  YAML_PARSE(node, "executor_threads", common.executor_threads)
+  YAML_PARSE(node, "stats_period", common.stats_period)
+  YAML_PARSE(node, "log_level", common.log_level)
+  YAML_PARSE(node, "battery_topic", common.battery_topic)
+  YAML_PARSE(node, "battery_low", common.battery_low)
+  YAML_PARSE(node, "temperature_file", common.temperature_file)
+  YAML_PARSE(node, "temperature_high", common.temperature_high)
 }
 
 void operator>>(const YAML::Node & node, ParamManager::PipelineRawData & pipeline)
@@ -76,6 +97,54 @@ void operator>>(const YAML::Node & node, ParamManager::PipelineRawData & pipelin
   YAML_PARSE(node, "connects", pipeline.connects)
   YAML_PARSE(node, "connects", pipeline.filters)
   YAML_PARSE(node, "input_path", pipeline.input_meta)
+  YAML_PARSE(node, "input_meta", pipeline.input_metas)
+  YAML_PARSE(node, "frames_in_flight", pipeline.frames_in_flight)
+  YAML_PARSE(node, "frame_policy", pipeline.frame_policy)
+  YAML_PARSE(node, "frame_decimation", pipeline.frame_decimation)
+  YAML_PARSE(node, "target_fps", pipeline.target_fps)
+  YAML_PARSE(node, "preprocess_threads", pipeline.preprocess_threads)
+  YAML_PARSE(node, "working_width", pipeline.working_width)
+  YAML_PARSE(node, "motion_threshold", pipeline.motion_threshold)
+  YAML_PARSE(node, "motion_max_skip", pipeline.motion_max_skip)
+  YAML_PARSE(node, "input_roi", pipeline.input_rois)
+  YAML_PARSE(node, "roi_refresh_interval", pipeline.roi_refresh_interval)
+  YAML_PARSE(node, "frame_deadline", pipeline.frame_deadline)
+  YAML_PARSE(node, "priority", pipeline.priority)
+  YAML_PARSE(node, "output_queue", pipeline.output_queue)
+  YAML_PARSE(node, "instances", pipeline.instances)
+  YAML_PARSE(node, "response_cache", pipeline.response_cache)
+  YAML_PARSE(node, "response_cache_ttl", pipeline.response_cache_ttl)
+  YAML_PARSE(node, "image_transport", pipeline.image_transport)
+  YAML_PARSE(node, "image_quality", pipeline.image_quality)
+  YAML_PARSE(node, "image_scale", pipeline.image_scale)
+  YAML_PARSE(node, "image_rate", pipeline.image_rate)
+  YAML_PARSE(node, "preview_scale", pipeline.preview_scale)
+  YAML_PARSE(node, "output_rate", pipeline.output_rates)
+  YAML_PARSE(node, "video_directory", pipeline.video_directory)
+  YAML_PARSE(node, "video_fps", pipeline.video_fps)
+  YAML_PARSE(node, "video_segment", pipeline.video_segment)
+  YAML_PARSE(node, "video_annotated", pipeline.video_annotated)
+  YAML_PARSE(node, "video_trigger", pipeline.video_trigger)
+  YAML_PARSE(node, "video_hold", pipeline.video_hold)
+  YAML_PARSE(node, "shm_slots", pipeline.shm_slots)
+  YAML_PARSE(node, "shm_max_objects", pipeline.shm_max_objects)
+  YAML_PARSE(node, "shm_frames", pipeline.shm_frames)
+  YAML_PARSE(node, "result_log_directory", pipeline.result_log_directory)
+  YAML_PARSE(node, "result_log_batch", pipeline.result_log_batch)
+  YAML_PARSE(node, "result_log_flush", pipeline.result_log_flush)
+  YAML_PARSE(node, "mask_encoding", pipeline.mask_encoding)
+  YAML_PARSE(node, "mask_keyframe_interval", pipeline.mask_keyframe_interval)
+  YAML_PARSE(node, "aggregate_frames", pipeline.aggregate_frames)
+  YAML_PARSE(node, "latency_topic", pipeline.latency_topic)
+  YAML_PARSE(node, "lazy", pipeline.lazy)
+  YAML_PARSE(node, "staged_startup", pipeline.staged_startup)
+  YAML_PARSE(node, "idle_unload", pipeline.idle_unload)
+  YAML_PARSE(node, "cpu_set", pipeline.cpu_set)
+  YAML_PARSE(node, "numa_node", pipeline.numa_node)
+  YAML_PARSE(node, "idle_activity", pipeline.idle_activity)
+  YAML_PARSE(node, "saving_fps", pipeline.saving_fps)
+  YAML_PARSE(node, "saving_detect_interval", pipeline.saving_detect_interval)
+  YAML_PARSE(node, "saving_variants", pipeline.saving_variants)
   slog::info << "Pipeline Params:name=" << pipeline.name << slog::endl;
 }
 
@@ -99,6 +168,54 @@ void operator>>(const YAML::Node & node, ParamManager::InferenceRawData & infer)
   YAML_PARSE(node, "batch", infer.batch)
   YAML_PARSE(node, "confidence_threshold", infer.confidence_threshold)
   YAML_PARSE(node, "enable_roi_constraint", infer.enable_roi_constraint)
+  YAML_PARSE(node, "config", infer.config)
+  YAML_PARSE(node, "infer_requests", infer.infer_requests)
+  YAML_PARSE(node, "input_buffers", infer.input_buffers)
+  YAML_PARSE(node, "batch_wait", infer.batch_wait)
+  YAML_PARSE(node, "warmup", infer.warmup)
+  YAML_PARSE(node, "preprocess", infer.preprocess)
+  YAML_PARSE(node, "nms_threshold", infer.nms_threshold)
+  YAML_PARSE(node, "top_k", infer.top_k)
+  YAML_PARSE(node, "mask_type", infer.mask_type)
+  YAML_PARSE(node, "gallery_index", infer.gallery_index)
+  YAML_PARSE(node, "gallery_size", infer.gallery_size)
+  YAML_PARSE(node, "gallery_lists", infer.gallery_lists)
+  YAML_PARSE(node, "gallery_probes", infer.gallery_probes)
+  YAML_PARSE(node, "gallery_precision", infer.gallery_precision)
+  YAML_PARSE(node, "gallery_file", infer.gallery_file)
+  YAML_PARSE(node, "gallery_snapshot_interval", infer.gallery_snapshot_interval)
+  YAML_PARSE(node, "gallery_fp16", infer.gallery_fp16)
+  YAML_PARSE(node, "shared_gallery", infer.shared_gallery)
+  YAML_PARSE(node, "tracker", infer.tracker)
+  YAML_PARSE(node, "detect_interval", infer.detect_interval)
+  YAML_PARSE(node, "track_iou", infer.track_iou)
+  YAML_PARSE(node, "optical_flow", infer.optical_flow)
+  YAML_PARSE(node, "cache_interval", infer.cache_interval)
+  YAML_PARSE(node, "cache_iou", infer.cache_iou)
+  YAML_PARSE(node, "cache_confidence", infer.cache_confidence)
+  YAML_PARSE(node, "tile_size", infer.tile_size)
+  YAML_PARSE(node, "tile_overlap", infer.tile_overlap)
+  YAML_PARSE(node, "min_roi_area", infer.min_roi_area)
+  YAML_PARSE(node, "min_roi_aspect", infer.min_roi_aspect)
+  YAML_PARSE(node, "max_roi_aspect", infer.max_roi_aspect)
+  YAML_PARSE(node, "min_roi_confidence", infer.min_roi_confidence)
+  YAML_PARSE(node, "min_track_age", infer.min_track_age)
+  YAML_PARSE(node, "max_rois", infer.max_rois)
+  YAML_PARSE(node, "roi_priority", infer.roi_priority)
+  YAML_PARSE(node, "roi_merge_iou", infer.roi_merge_iou)
+  YAML_PARSE(node, "roi_padding", infer.roi_padding)
+  YAML_PARSE(node, "roi_fit", infer.roi_fit)
+  YAML_PARSE(node, "priority", infer.priority)
+  YAML_PARSE(node, "every_n_frames", infer.every_n_frames)
+  YAML_PARSE(node, "max_hz", infer.max_hz)
+  YAML_PARSE(node, "request_timeout", infer.request_timeout)
+  YAML_PARSE(node, "max_errors", infer.max_errors)
+  YAML_PARSE(node, "fallback_engine", infer.fallback_engine)
+  YAML_PARSE(node, "fallback_model", infer.fallback_model)
+  YAML_PARSE(node, "fallback_fps", infer.fallback_fps)
+  YAML_PARSE(node, "variants", infer.variants)
+  YAML_PARSE(node, "variant_budget", infer.variant_budget)
+  YAML_PARSE(node, "input_shape", infer.input_shape)
   if (infer.model_type.size() == 0) {
     infer.model_type = "SSD";
   }
@@ -196,6 +313,120 @@ void ParamManager::print() const
       slog::info << "\t\tBatch: " << infer.batch << slog::endl;
       slog::info << "\t\tConfidence_threshold: " << infer.confidence_threshold << slog::endl;
       slog::info << "\t\tEnable_roi_constraint: " << infer.enable_roi_constraint << slog::endl;
+      slog::info << "\t\tInfer_requests: " << infer.infer_requests << ", input_buffers: " <<
+        infer.input_buffers << slog::endl;
+      slog::info << "\t\tBatch_wait: " << infer.batch_wait << slog::endl;
+      slog::info << "\t\tWarmup: " << infer.warmup << slog::endl;
+      slog::info << "\t\tPreprocess: " << infer.preprocess << slog::endl;
+      slog::info << "\t\tNms_threshold: " << infer.nms_threshold << ", top_k: " << infer.top_k <<
+        slog::endl;
+      slog::info << "\t\tMask_type: " << infer.mask_type << slog::endl;
+      slog::info << "\t\tGallery_index: " << infer.gallery_index << ", size: " <<
+        infer.gallery_size << ", lists: " << infer.gallery_lists << ", probes: " <<
+        infer.gallery_probes << ", precision: " << infer.gallery_precision << slog::endl;
+      if (!infer.shared_gallery.empty()) {
+        slog::info << "\t\tShared_gallery: " << infer.shared_gallery << slog::endl;
+      }
+      if (infer.tracker != "none") {
+        slog::info << "\t\tTracker: " << infer.tracker << ", detect_interval: " <<
+          infer.detect_interval << ", track_iou: " << infer.track_iou << ", optical_flow: " <<
+          infer.optical_flow << slog::endl;
+      }
+      if (infer.cache_interval > 1) {
+        slog::info << "\t\tCache_interval: " << infer.cache_interval << ", iou: " <<
+          infer.cache_iou << ", confidence: " << infer.cache_confidence << slog::endl;
+      }
+      if (infer.tile_size > 0) {
+        slog::info << "\t\tTile_size: " << infer.tile_size << ", overlap: " <<
+          infer.tile_overlap << slog::endl;
+      }
+      if (infer.max_rois > 0 || infer.min_roi_area > 0 || infer.min_roi_confidence > 0 ||
+        infer.min_track_age > 0 || infer.min_roi_aspect > 0 || infer.max_roi_aspect > 0)
+      {
+        slog::info << "\t\tRoi gate: area >= " << infer.min_roi_area << ", aspect in [" <<
+          infer.min_roi_aspect << ", " << infer.max_roi_aspect << "], confidence >= " <<
+          infer.min_roi_confidence << ", track age >= " << infer.min_track_age <<
+          ", max rois: " << infer.max_rois << " by " << infer.roi_priority << slog::endl;
+      }
+      if (infer.roi_merge_iou > 0 || infer.roi_padding > 0 || infer.roi_fit != "clip") {
+        slog::info << "\t\tRoi merge: iou > " << infer.roi_merge_iou << ", padding: " <<
+          infer.roi_padding << ", fit: " << infer.roi_fit << slog::endl;
+      }
+      if (infer.every_n_frames > 1 || infer.max_hz > 0) {
+        slog::info << "\t\tRate: every " << infer.every_n_frames << " frames, max " <<
+          infer.max_hz << " Hz" << slog::endl;
+      }
+      if (!infer.gallery_file.empty()) {
+        slog::info << "\t\tGallery_file: " << infer.gallery_file << ", snapshot interval: " <<
+          infer.gallery_snapshot_interval << "s, fp16: " << infer.gallery_fp16 << slog::endl;
+      }
+      if (!infer.fallback_engine.empty() || infer.request_timeout > 0) {
+        slog::info << "\t\tRequest_timeout: " << infer.request_timeout << "ms, max_errors: " <<
+          infer.max_errors << ", fallback: " << infer.fallback_engine << " " <<
+          infer.fallback_model << ", fps: " << infer.fallback_fps << slog::endl;
+      }
+      for (auto & variant : infer.variants) {
+        slog::info << "\t\tVariant: " << variant << slog::endl;
+      }
+      if (infer.variant_budget > 0) {
+        slog::info << "\t\tVariant_budget: " << infer.variant_budget << "ms" << slog::endl;
+      }
+      if (!infer.input_shape.empty()) {
+        slog::info << "\t\tInput_shape: " << infer.input_shape << slog::endl;
+      }
+      for (auto & config : infer.config) {
+        slog::info << "\t\tConfig: " << config.first << "=" << config.second << slog::endl;
+      }
+    }
+
+    for (auto & meta : pipeline.input_metas) {
+      slog::info << "\tInput meta: " << meta.first << "=" << meta.second << slog::endl;
+    }
+
+    slog::info << "\tFrames in flight: " << pipeline.frames_in_flight << slog::endl;
+    slog::info << "\tFrame policy: " << pipeline.frame_policy << ", decimation: " <<
+      pipeline.frame_decimation << ", target fps: " << pipeline.target_fps << slog::endl;
+    slog::info << "\tPreprocess threads: " << pipeline.preprocess_threads << slog::endl;
+    if (pipeline.working_width > 0) {
+      slog::info << "\tWorking width: " << pipeline.working_width << slog::endl;
+    }
+    slog::info << "\tMotion threshold: " << pipeline.motion_threshold << ", max skip: " <<
+      pipeline.motion_max_skip << slog::endl;
+    slog::info << "\tFrame deadline: " << pipeline.frame_deadline << "ms" << slog::endl;
+    slog::info << "\tPriority: " << pipeline.priority << slog::endl;
+    slog::info << "\tOutput queue: " << pipeline.output_queue << slog::endl;
+    slog::info << "\tInstances: " << pipeline.instances << slog::endl;
+    slog::info << "\tResponse cache: " << pipeline.response_cache << ", ttl: " <<
+      pipeline.response_cache_ttl << "s" << slog::endl;
+    slog::info << "\tImage transport: " << pipeline.image_transport << ", quality: " <<
+      pipeline.image_quality << ", scale: " << pipeline.image_scale << ", rate: " <<
+      pipeline.image_rate << slog::endl;
+    slog::info << "\tPreview scale: " << pipeline.preview_scale << slog::endl;
+    for (auto & roi : pipeline.input_rois) {
+      slog::info << "\tInput roi: " << roi.first << "=" << roi.second << slog::endl;
+    }
+    slog::info << "\tVideo: " << pipeline.video_directory << ", fps: " << pipeline.video_fps <<
+      ", segment: " << pipeline.video_segment << "s, annotated: " << pipeline.video_annotated <<
+      ", trigger: " << pipeline.video_trigger << ", hold: " << pipeline.video_hold << "s" <<
+      slog::endl;
+    slog::info << "\tShared memory slots: " << pipeline.shm_slots << ", max objects: " <<
+      pipeline.shm_max_objects << ", frames: " << pipeline.shm_frames << slog::endl;
+    slog::info << "\tResult log: " << pipeline.result_log_directory << ", batch: " <<
+      pipeline.result_log_batch << ", flush: " << pipeline.result_log_flush << "s" << slog::endl;
+    slog::info << "\tMask encoding: " << pipeline.mask_encoding << ", keyframe interval: " <<
+      pipeline.mask_keyframe_interval << slog::endl;
+    slog::info << "\tAggregate frames: " << pipeline.aggregate_frames << slog::endl;
+    slog::info << "\tLatency topic: " << pipeline.latency_topic << slog::endl;
+    slog::info << "\tLazy: " << pipeline.lazy << ", idle unload: " << pipeline.idle_unload <<
+      slog::endl;
+    slog::info << "\tStaged startup: " << pipeline.staged_startup << slog::endl;
+    slog::info << "\tCPU set: " << pipeline.cpu_set << ", NUMA node: " << pipeline.numa_node <<
+      slog::endl;
+    slog::info << "\tIdle activity: " << pipeline.idle_activity << ", saving fps: " <<
+      pipeline.saving_fps << ", detect interval: " << pipeline.saving_detect_interval <<
+      ", variants: " << pipeline.saving_variants << slog::endl;
+    for (auto & rate : pipeline.output_rates) {
+      slog::info << "\tOutput rate: " << rate.first << "=" << rate.second << slog::endl;
     }
 
     slog::info << "\tConnections: " << slog::endl;
@@ -210,6 +441,16 @@ void ParamManager::print() const
   slog::info << "\tcustom_cpu_library: " << common_.custom_cpu_library << slog::endl;
   slog::info << "\tcustom_cldnn_library: " << common_.custom_cldnn_library << slog::endl;
   slog::info << "\tenable_performance_count: " << common_.enable_performance_count << slog::endl;
+  slog::info << "\tnetwork_cache_dir: " << common_.network_cache_dir << slog::endl;
+  slog::info << "\tdevice_requests: " << common_.device_requests << slog::endl;
+  slog::info << "\topencl_preprocess: " << common_.opencl_preprocess << slog::endl;
+  slog::info << "\texecutor_threads: " << common_.executor_threads << slog::endl;
+  slog::info << "\tstats_period: " << common_.stats_period << slog::endl;
+  slog::info << "\tlog_level: " << common_.log_level << slog::endl;
+  slog::info << "\tbattery_topic: " << common_.battery_topic << ", low: " <<
+    common_.battery_low << slog::endl;
+  slog::info << "\ttemperature_file: " << common_.temperature_file << ", high: " <<
+    common_.temperature_high << slog::endl;
 }
 
 void ParamManager::parse(std::string path)